@@ -57,6 +57,7 @@
 
 #include "erhe_commands/commands.hpp"
 #include "erhe_commands/commands_log.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_configuration/configuration.hpp"
 #include "erhe_file/file.hpp"
 #include "erhe_file/file_log.hpp"
@@ -104,6 +105,8 @@
 
 #include <taskflow/taskflow.hpp>
 
+#include <algorithm>
+
 #if defined(ERHE_PROFILE_LIBRARY_NVTX)
 #   include <nvtx3/nvToolsExt.h>
 #endif
@@ -199,6 +202,10 @@ public:
         }
 #endif
 
+        // When physics runs on simulation thread, UI, commands and operations
+        // may access physics worlds only until physics updates are applied
+        m_editor_scenes->begin_physics_access();
+
         // - Update all ImGui hosts. glfw window host processes input events, converting them to ImGui inputs events
         //   This may consume some input events, so that they will not get processed by m_commands.tick() below
         // - Call all ImGui code (Imgui_window)
@@ -222,6 +229,8 @@ public:
         // Apply physics updates
         m_editor_scenes->after_physics_simulation_steps();
 
+        m_editor_scenes->end_physics_access();
+
         m_fly_camera_tool->on_frame_end();
 
         // Rendering
@@ -319,12 +328,19 @@ public:
 
     Editor()
     {
-        int init_thread_count = 1;
+        int init_thread_count = 0;
         auto& erhe_ini = erhe::configuration::get_ini_file("erhe.ini");
         const auto& threading_section = erhe_ini.get_section("threading");
         threading_section.get("init_thread_count", init_thread_count);
 
-        m_executor = std::make_unique<tf::Executor>(init_thread_count);
+        // Taskflow cannot run on the engine thread pool. It is only used for
+        // the initialization task graph and is destroyed after it completes;
+        // runtime work runs on the engine thread pool.
+        const std::size_t pool_thread_count = erhe::concurrency::Thread_pool::get_instance().get_thread_count();
+        const std::size_t executor_thread_count = (init_thread_count > 0)
+            ? std::min(static_cast<std::size_t>(init_thread_count), pool_thread_count)
+            : pool_thread_count;
+        m_executor = std::make_unique<tf::Executor>(executor_thread_count);
 
         try {
             tf::Taskflow taskflow;
@@ -336,6 +352,7 @@ public:
             m_editor_settings    = std::make_unique<Editor_settings               >();
             m_input_state        = std::make_unique<Input_state                   >();
             m_time               = std::make_unique<Time                          >();
+            read_physics_settings(); // Needed before scene roots create physics worlds
             auto& commands           = *m_commands          .get();
             auto& editor_message_bus = *m_editor_message_bus.get();
             auto& time               = *m_time              .get();
@@ -367,7 +384,7 @@ public:
             );
 
             m_clipboard            = std::make_unique<Clipboard     >(commands, m_editor_context);
-            m_editor_scenes        = std::make_unique<Editor_scenes >(m_editor_context, time);
+            m_editor_scenes        = std::make_unique<Editor_scenes >(m_editor_context, time, m_editor_settings->physics);
             m_editor_windows       = std::make_unique<Editor_windows>(m_editor_context);
             m_viewport_scene_views = std::make_unique<Scene_views   >(commands, m_editor_context, editor_message_bus);
             m_selection            = std::make_unique<Selection     >(commands, m_editor_context, editor_message_bus);
@@ -463,7 +480,7 @@ public:
                 .succeed(mesh_memory_task);
 
             auto some_windows_task = taskflow.emplace([this](){
-                m_operation_stack        = std::make_unique<Operation_stack                 >(*m_executor.get(),       *m_commands.get(),       *m_imgui_renderer.get(), *m_imgui_windows.get(), m_editor_context);
+                m_operation_stack        = std::make_unique<Operation_stack                 >(erhe::concurrency::Thread_pool::get_instance(), *m_commands.get(),       *m_imgui_renderer.get(), *m_imgui_windows.get(), m_editor_context);
                 m_asset_browser          = std::make_unique<Asset_browser                   >(*m_imgui_renderer.get(), *m_imgui_windows.get(),  m_editor_context);
                 m_composer_window        = std::make_unique<Composer_window                 >(*m_imgui_renderer.get(), *m_imgui_windows.get(),  m_editor_context);
                 m_selection_window       = std::make_unique<Selection_window                >(*m_imgui_renderer.get(), *m_imgui_windows.get(),  m_editor_context);
@@ -744,6 +761,7 @@ public:
             std::string graph_dump = taskflow.dump();
             erhe::file::write_file("erhe_init_graph.dot", graph_dump);
             m_executor->run(taskflow).wait();
+            m_executor.reset();
         } catch (std::runtime_error& e) {
             log_startup->error("exception: {}", e.what());
         }
@@ -762,11 +780,8 @@ public:
 
         fill_editor_context();
 
-        const auto& physics_section = erhe::configuration::get_ini_file_section("erhe.ini", "physics");
-        physics_section.get("static_enable",  m_editor_settings->physics.static_enable);
-        physics_section.get("dynamic_enable", m_editor_settings->physics.dynamic_enable);
-        if (!m_editor_settings->physics.static_enable) {
-            m_editor_settings->physics.dynamic_enable = false;
+        if (m_editor_settings->physics.simulation_thread) {
+            m_editor_scenes->start_simulation_thread();
         }
 
         {
@@ -825,9 +840,34 @@ public:
 
     ~Editor()
     {
+        if (m_editor_scenes) {
+            m_editor_scenes->stop_simulation_thread();
+        }
         m_default_scene_browser.reset();
         m_default_scene.reset();
     }
+
+    void read_physics_settings()
+    {
+        Physics_settings& physics = m_editor_settings->physics;
+        const auto& physics_section = erhe::configuration::get_ini_file_section("erhe.ini", "physics");
+        physics_section.get("static_enable",        physics.static_enable);
+        physics_section.get("dynamic_enable",       physics.dynamic_enable);
+        physics_section.get("simulation_thread",    physics.simulation_thread);
+        physics_section.get("simulation_step_rate", physics.simulation_step_rate);
+        if (!physics.static_enable) {
+            physics.dynamic_enable = false;
+        }
+        physics.simulation_step_rate = std::max(physics.simulation_step_rate, 1);
+
+        erhe::physics::World_create_info& world = physics.world_create_info;
+        int temp_allocator_mb = static_cast<int>(world.temp_allocator_size / (1024 * 1024));
+        physics_section.get("job_thread_count",  world.job_thread_count);
+        physics_section.get("temp_allocator_mb", temp_allocator_mb);
+        physics_section.get("collision_steps",   world.collision_steps);
+        physics_section.get("sub_steps",         world.sub_steps);
+        world.temp_allocator_size = static_cast<std::size_t>(std::max(temp_allocator_mb, 1)) * 1024 * 1024;
+    }
     void fill_editor_context()
     {
         ERHE_PROFILE_FUNCTION();
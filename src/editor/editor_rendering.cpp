@@ -23,6 +23,7 @@
 
 #include "erhe_commands/command.hpp"
 #include "erhe_commands/commands.hpp"
+#include "erhe_configuration/configuration.hpp"
 #include "erhe_gl/wrapper_functions.hpp"
 #include "erhe_gl/enum_bit_mask_operators.hpp"
 #include "erhe_graphics/debug.hpp"
@@ -87,6 +88,9 @@ Editor_rendering::Editor_rendering(
     commands.bind_command_to_key(&m_capture_frame_command, erhe::window::Key_f10);
     commands.bind_command_to_menu(&m_capture_frame_command, "View.Frame");
 
+    const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "renderer");
+    ini.get("frustum_culling", frustum_culling);
+
     using Item_filter = erhe::Item_filter;
     using Item_flags  = erhe::Item_flags;
     using namespace erhe::primitive;
@@ -627,6 +631,8 @@ void Editor_rendering::imgui()
         ImGuiTreeNodeFlags_SpanFullWidth
     };
 
+    ImGui::Checkbox("Frustum Culling", &frustum_culling);
+
     if (ImGui::TreeNodeEx("Skin Debug", flags)) {
         int index = static_cast<int>(debug_joint_indices.x);
         ImGui::SliderInt("Debug Joint Index", &index, 0, 200); // TODO correct range
@@ -109,6 +109,7 @@ public:
     void imgui();
     void request_renderdoc_capture();
 
+    bool                        frustum_culling{false}; // CPU culling of content meshes for views and shadow maps
     glm::uvec4                  debug_joint_indices{0, 0, 0, 0};
     std::vector<glm::vec4>      debug_joint_colors;
     std::shared_ptr<Renderpass> selection_outline;
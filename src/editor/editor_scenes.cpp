@@ -7,19 +7,27 @@
 #include "scene/scene_root.hpp"
 
 #include "erhe_physics/iworld.hpp"
+#include "erhe_physics/simulation_thread.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_scene/scene.hpp"
+#include "erhe_verify/verify.hpp"
 
 #include <imgui/imgui.h>
 
 namespace editor {
 
-Editor_scenes::Editor_scenes(Editor_context& editor_context, Time& time)
-    : Update_time_base{time}
-    , m_context       {editor_context}
+Editor_scenes::Editor_scenes(Editor_context& editor_context, Time& time, const Physics_settings& physics_settings)
+    : Update_time_base  {time}
+    , m_context         {editor_context}
+    , m_physics_settings{physics_settings}
 {
 }
 
+Editor_scenes::~Editor_scenes() noexcept
+{
+    stop_simulation_thread();
+}
+
 void Editor_scenes::register_scene_root(Scene_root* scene_root)
 {
     const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
@@ -29,6 +37,9 @@ void Editor_scenes::register_scene_root(Scene_root* scene_root)
         log_scene->error("Scene '{}' is already in registered in Editor_scenes", scene_root->get_name());
     } else {
         m_scene_roots.push_back(scene_root);
+        if (m_simulation_thread) {
+            m_simulation_thread->add_world(&scene_root->get_physics_world());
+        }
     }
 }
 
@@ -41,7 +52,65 @@ void Editor_scenes::unregister_scene_root(Scene_root* scene_root)
         log_scene->error("Scene '{}' not registered in Editor_scenes", scene_root->get_name());
     } else {
         m_scene_roots.erase(i, m_scene_roots.end());
+        if (m_simulation_thread) {
+            m_simulation_thread->remove_world(&scene_root->get_physics_world());
+        }
+    }
+}
+
+void Editor_scenes::start_simulation_thread()
+{
+    if (m_simulation_thread) {
+        return;
+    }
+
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+
+    m_simulation_thread = std::make_unique<erhe::physics::Simulation_thread>(
+        1.0 / static_cast<double>(m_physics_settings.simulation_step_rate)
+    );
+    for (Scene_root* scene_root : m_scene_roots) {
+        m_simulation_thread->add_world(&scene_root->get_physics_world());
+    }
+    m_simulation_thread->start();
+}
+
+void Editor_scenes::stop_simulation_thread()
+{
+    if (!m_simulation_thread) {
+        return;
     }
+    ERHE_VERIFY(!m_physics_access);
+    m_simulation_thread->stop();
+    m_simulation_thread.reset();
+}
+
+void Editor_scenes::begin_physics_access()
+{
+    ERHE_VERIFY(!m_physics_access);
+    if (m_simulation_thread) {
+        m_simulation_thread->lock();
+    }
+    m_physics_access = true;
+}
+
+void Editor_scenes::end_physics_access()
+{
+    ERHE_VERIFY(m_physics_access);
+    if (m_simulation_thread) {
+        m_simulation_thread->unlock();
+    }
+    m_physics_access = false;
+}
+
+auto Editor_scenes::get_simulation_thread() -> erhe::physics::Simulation_thread*
+{
+    return m_simulation_thread.get();
+}
+
+auto Editor_scenes::get_physics_world_create_info() const -> const erhe::physics::World_create_info&
+{
+    return m_physics_settings.world_create_info;
 }
 
 void Editor_scenes::imgui()
@@ -57,7 +126,8 @@ void Editor_scenes::update_physics_simulation_fixed_step(const Time_context& tim
 
     if (
         !m_context.editor_settings->physics.static_enable ||
-        !m_context.editor_settings->physics.dynamic_enable
+        !m_context.editor_settings->physics.dynamic_enable ||
+        m_simulation_thread
     ) {
         return;
     }
@@ -71,7 +141,17 @@ void Editor_scenes::before_physics_simulation_steps()
 {
     ERHE_PROFILE_FUNCTION();
 
-    if (!m_context.editor_settings->physics.static_enable || !m_context.editor_settings->physics.dynamic_enable) {
+    // Bodies are added to physics worlds also when simulation is disabled
+    for (const auto& scene_root : m_scene_roots) {
+        scene_root->flush_pending_rigid_bodies();
+    }
+    m_context.tools->get_tool_scene_root()->flush_pending_rigid_bodies();
+
+    const bool enabled = m_context.editor_settings->physics.static_enable && m_context.editor_settings->physics.dynamic_enable;
+    if (m_simulation_thread) {
+        m_simulation_thread->set_paused(!enabled);
+    }
+    if (!enabled) {
         return;
     }
 
@@ -110,8 +190,13 @@ void Editor_scenes::after_physics_simulation_steps()
         return;
     }
 
+    // Simulation thread state is one step ahead of frame time; show
+    // bodies between previous and latest step
+    const float interpolation_alpha = m_simulation_thread
+        ? m_simulation_thread->get_interpolation_alpha()
+        : 1.0f;
     for (const auto& scene_root : m_scene_roots) {
-        scene_root->after_physics_simulation_steps();
+        scene_root->after_physics_simulation_steps(interpolation_alpha);
     }
 }
 
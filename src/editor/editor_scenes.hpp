@@ -7,17 +7,24 @@
 #include <mutex>
 #include <vector>
 
+namespace erhe::physics {
+    class Simulation_thread;
+    class World_create_info;
+}
+
 namespace editor
 {
 
 class Editor_context;
+class Physics_settings;
 class Scene_root;
 class Time;
 
 class Editor_scenes : public Update_fixed_step
 {
 public:
-    Editor_scenes(Editor_context& editor_context, Time& time);
+    Editor_scenes(Editor_context& editor_context, Time& time, const Physics_settings& physics_settings);
+    ~Editor_scenes() noexcept;
 
     void register_scene_root                 (Scene_root* scene_root);
     void unregister_scene_root               (Scene_root* scene_root);
@@ -28,6 +35,15 @@ public:
     void after_physics_simulation_steps      ();
     void update_node_transforms              ();
 
+    // Physics simulation thread; when not started, physics is stepped
+    // from update_fixed_step()
+    void start_simulation_thread             ();
+    void stop_simulation_thread              ();
+    void begin_physics_access                ();
+    void end_physics_access                  ();
+    [[nodiscard]] auto get_simulation_thread        () -> erhe::physics::Simulation_thread*;
+    [[nodiscard]] auto get_physics_world_create_info() const -> const erhe::physics::World_create_info&;
+
     void update_fixed_step    (const Time_context&) override;
 
     [[nodiscard]] auto get_scene_roots() -> const std::vector<Scene_root*>&;
@@ -36,9 +52,12 @@ public:
     void imgui();
 
 private:
-    Editor_context&                m_context;
-    ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
-    std::vector<Scene_root*>       m_scene_roots;
+    Editor_context&                                   m_context;
+    const Physics_settings&                           m_physics_settings;
+    ERHE_PROFILE_MUTEX(std::mutex,                    m_mutex);
+    std::vector<Scene_root*>                          m_scene_roots;
+    std::unique_ptr<erhe::physics::Simulation_thread> m_simulation_thread;
+    bool                                              m_physics_access{false};
 };
 
 } // namespace editor
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "erhe_imgui/imgui_renderer.hpp"
+#include "erhe_physics/iworld.hpp"
 
 #include <string>
 
@@ -26,6 +27,13 @@ public:
     // Physics
     bool static_enable {true};
     bool dynamic_enable{true};
+
+    // When enabled, scenes are stepped at simulation_step_rate on a
+    // dedicated thread, and nodes follow interpolated body transforms
+    bool simulation_thread   {false};
+    int  simulation_step_rate{240};
+
+    erhe::physics::World_create_info world_create_info;
 };
 
 class Graphics_preset
@@ -162,18 +162,14 @@ public:
         auto& tail  = erhe::log::get_tail_store_log();
         //auto& frame = erhe::log::get_frame_store_log();
 
-        auto& tail_entries = tail->get_log();
+        const auto tail_lock    = tail.lock();
+        auto&      tail_entries = tail.get_log();
         const auto visible_count = (std::min)(
             static_cast<size_t>(10),
             tail_entries.size()
         );
-        for (
-            auto i = tail_entries.rbegin(),
-            end = tail_entries.rbegin() + visible_count;
-            i != end;
-            ++i
-        ) {
-            auto& entry = *i;
+        for (size_t i = 0; i < visible_count; ++i) {
+            auto& entry = tail_entries[tail_entries.size() - 1 - i];
             s.append(Term::color_fg(Term::Color::Name::Blue));
             s.append(entry.timestamp.c_str());
             s.append(Term::color_fg(Term::Color::Name::Gray));
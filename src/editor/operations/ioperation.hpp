@@ -2,6 +2,7 @@
 
 #include "erhe_item/unique_id.hpp"
 
+#include <cstddef>
 #include <string>
 
 namespace editor {
@@ -17,6 +18,17 @@ public:
     virtual void undo    (Editor_context& context) = 0;
     virtual auto describe() const -> std::string = 0;
 
+    // Approximate bytes of CPU memory held for undo and redo
+    virtual auto get_memory_usage() const -> std::size_t { return 0; }
+
+    // Bytes of GPU buffer ranges held for undo and redo. Mesh buffers are
+    // sub-allocated without free, so compact() does not reduce these.
+    virtual auto get_gpu_memory_usage() const -> std::size_t { return 0; }
+
+    // Compresses or releases data which can be rebuilt when the operation
+    // is executed or undone again. Returns approximate bytes released.
+    virtual auto compact() -> std::size_t { return 0; }
+
     [[nodiscard]] inline auto get_serial() const -> std::size_t { return m_id.get_id(); }
 
 private:
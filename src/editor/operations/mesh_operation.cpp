@@ -3,14 +3,24 @@
 #include "editor_context.hpp"
 #include "editor_log.hpp"
 #include "editor_settings.hpp"
+#include "operations/operation_progress.hpp"
+#include "operations/operation_stack.hpp"
 #include "scene/node_physics.hpp"
 #include "scene/scene_root.hpp"
 #include "tools/selection_tool.hpp"
 
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_geometry/compressed_geometry.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_physics/icollision_shape.hpp"
+#include "erhe_primitive/material.hpp"
+#include "erhe_profile/profile.hpp"
 #include "erhe_scene/scene.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
 namespace editor {
 
 Mesh_operation::Mesh_operation(Mesh_operation_parameters&& parameters)
@@ -50,7 +60,7 @@ void Mesh_operation::execute(Editor_context&)
     ERHE_VERIFY(item_host != nullptr);
     std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
 
-    for (const auto& entry : m_entries) {
+    for (auto& entry : m_entries) {
         auto* node = entry.mesh->get_node();
 
         // TODO Improve physics RAII and remove this workaround
@@ -65,6 +75,7 @@ void Mesh_operation::execute(Editor_context&)
         if (old_node_physics) {
             node->detach(old_node_physics.get());
         }
+        restore(entry.after);
         entry.mesh->set_primitives(entry.after.primitives);
         if (entry.after.node_physics) {
             node->attach(entry.after.node_physics);
@@ -88,7 +99,7 @@ void Mesh_operation::undo(Editor_context&)
     ERHE_VERIFY(item_host != nullptr);
     std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
 
-    for (const auto& entry : m_entries) {
+    for (auto& entry : m_entries) {
         auto* node = entry.mesh->get_node();
 
         // TODO Improve physics RAII and remove this workaround
@@ -103,6 +114,7 @@ void Mesh_operation::undo(Editor_context&)
         if (old_node_physics) {
             node->detach(old_node_physics.get());
         }
+        restore(entry.before);
         entry.mesh->set_primitives(entry.before.primitives);
         if (entry.before.node_physics) {
             node->attach(entry.before.node_physics);
@@ -112,92 +124,318 @@ void Mesh_operation::undo(Editor_context&)
     }
 }
 
-void Mesh_operation::make_entries(
-    const std::function<
-        erhe::geometry::Geometry(erhe::geometry::Geometry&)
-    > operation
-)
+void Mesh_operation::restore(Version& version)
 {
-    Selection& selection = *m_parameters.context.selection;
-    const auto& selected_items = selection.get_selection();
-    if (selected_items.empty()) {
+    if (!version.compacted) {
         return;
     }
+    for (erhe::primitive::Primitive& primitive : version.primitives) {
+        erhe::primitive::Primitive_render_shape* render_shape    = primitive.render_shape.get();
+        erhe::primitive::Primitive_shape*        collision_shape = primitive.collision_shape.get();
+        const bool shared_geometry =
+            (render_shape != nullptr) &&
+            (collision_shape != nullptr) &&
+            render_shape->get_compressed_geometry() &&
+            (render_shape->get_compressed_geometry() == collision_shape->get_compressed_geometry());
+        bool decompressed = false;
+        if ((render_shape != nullptr) && render_shape->get_compressed_geometry()) {
+            const bool geometry_ok = render_shape->make_geometry();
+            ERHE_VERIFY(geometry_ok);
+            decompressed = true;
+        }
+        if (shared_geometry) {
+            // Decompress once, collision shape shares geometry with render shape
+            collision_shape->share_geometry(*render_shape);
+        } else if ((collision_shape != nullptr) && collision_shape->get_compressed_geometry()) {
+            const bool geometry_ok = collision_shape->make_geometry();
+            ERHE_VERIFY(geometry_ok);
+            decompressed = true;
+        }
+        if (decompressed) {
+            const bool raytrace_ok = primitive.make_raytrace();
+            ERHE_VERIFY(raytrace_ok);
+        }
+    }
+    version.compacted = false;
+}
 
-    const auto first_mesh = selection.get<erhe::scene::Mesh>();
-    const auto first_node = selection.get<erhe::scene::Node>();
-    if (!first_mesh && !first_node) {
-        return;
+auto Mesh_operation::get_memory_usage() const -> std::size_t
+{
+    // Before versions are attributed to the operation (or scene content)
+    // which created them, so only after versions are counted here.
+    std::size_t result = 0;
+    for (const Entry& entry : m_entries) {
+        for (const erhe::primitive::Primitive& primitive : entry.after.primitives) {
+            // Collision shape may share geometry, or compressed geometry,
+            // with render shape
+            const erhe::geometry::Geometry*            counted_geometry            = nullptr;
+            const erhe::geometry::Compressed_geometry* counted_compressed_geometry = nullptr;
+            const erhe::primitive::Primitive_shape*    shapes[]                    = { primitive.render_shape.get(), primitive.collision_shape.get() };
+            for (const erhe::primitive::Primitive_shape* shape : shapes) {
+                if (shape == nullptr) {
+                    continue;
+                }
+                const std::shared_ptr<erhe::geometry::Geometry>&                  geometry            = shape->get_geometry_const();
+                const std::shared_ptr<const erhe::geometry::Compressed_geometry>& compressed_geometry = shape->get_compressed_geometry();
+                if (geometry) {
+                    if (geometry.get() != counted_geometry) {
+                        result += geometry->get_memory_usage();
+                        counted_geometry = geometry.get();
+                    }
+                } else if (compressed_geometry) {
+                    if (compressed_geometry.get() != counted_compressed_geometry) {
+                        result += compressed_geometry->get_memory_usage();
+                        counted_compressed_geometry = compressed_geometry.get();
+                    }
+                }
+                result += shape->get_raytrace().get_memory_usage(); // zero when released
+            }
+        }
     }
+    return result;
+}
 
+auto Mesh_operation::get_gpu_memory_usage() const -> std::size_t
+{
+    std::size_t result = 0;
+    for (const Entry& entry : m_entries) {
+        for (const erhe::primitive::Primitive& primitive : entry.after.primitives) {
+            if (primitive.render_shape) {
+                const erhe::primitive::Buffer_mesh& buffer_mesh = primitive.render_shape->get_renderable_mesh();
+                result += buffer_mesh.vertex_buffer_range.get_byte_size() + buffer_mesh.index_buffer_range.get_byte_size();
+            }
+        }
+    }
+    return result;
+}
+
+auto Mesh_operation::compact() -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (m_entries.empty()) {
+        return 0;
+    }
+
+    erhe::scene::Node* first_node = m_entries.front().mesh->get_node();
+    if (first_node == nullptr) {
+        return 0;
+    }
     erhe::Item_host* item_host = first_node->get_item_host();
-    ERHE_VERIFY(item_host != nullptr);
+    if (item_host == nullptr) {
+        return 0;
+    }
     std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
 
-    auto* const first_node_raw = first_node ? first_node.get() : first_mesh->get_node();
-    if (first_node_raw == nullptr) {
-        // TODO Can this limitation be lifted?
-        log_operations->error("First selected mesh does not have scene, cannot perform geometry operation");
-        return;
+    // Shapes may be shared with the scene or other operations, so geometry
+    // is compressed into private copies of shapes, and restore() rebuilds
+    // geometry and raytrace when the version is used again. GPU buffer
+    // ranges are kept; the mesh memory allocator does not release them,
+    // and rebuilding them would only allocate more.
+    const auto compact_shape = [](auto& shape) -> std::size_t {
+        using Shape = typename std::remove_reference_t<decltype(shape)>::element_type;
+        if (!shape || !shape->get_geometry_const()) {
+            return 0;
+        }
+        const std::size_t used = shape->get_geometry_const()->get_memory_usage() + shape->get_raytrace().get_memory_usage();
+        auto compact_copy = std::make_shared<Shape>(*shape.get());
+        compact_copy->compress_geometry();
+        shape = compact_copy;
+        return used - std::min(used, compact_copy->get_compressed_geometry()->get_memory_usage());
+    };
+
+    std::size_t released = 0;
+    for (Entry& entry : m_entries) {
+        const std::vector<erhe::primitive::Primitive>& current_primitives = entry.mesh->get_primitives();
+        const auto is_in_scene = [&current_primitives](const Version& version) -> bool {
+            for (const erhe::primitive::Primitive& primitive : version.primitives) {
+                for (const erhe::primitive::Primitive& current_primitive : current_primitives) {
+                    if (primitive.render_shape == current_primitive.render_shape) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+        for (Version* version : { &entry.before, &entry.after }) {
+            if (version->compacted || is_in_scene(*version)) {
+                continue;
+            }
+            for (erhe::primitive::Primitive& primitive : version->primitives) {
+                // Geometry shared by render and collision shapes is
+                // compressed once, and both copies use the same compressed
+                // geometry, so that it is counted once
+                const bool shared_geometry =
+                    primitive.render_shape &&
+                    primitive.collision_shape &&
+                    primitive.render_shape->get_geometry_const() &&
+                    (primitive.render_shape->get_geometry_const() == primitive.collision_shape->get_geometry_const());
+                const bool shared_shape = primitive.collision_shape && (primitive.collision_shape == primitive.render_shape);
+                released += compact_shape(primitive.render_shape);
+                if (shared_shape) {
+                    primitive.collision_shape = primitive.render_shape;
+                } else if (shared_geometry) {
+                    released += primitive.collision_shape->get_raytrace().get_memory_usage();
+                    auto compact_copy = std::make_shared<erhe::primitive::Primitive_shape>(*primitive.collision_shape.get());
+                    compact_copy->share_geometry(*primitive.render_shape.get());
+                    primitive.collision_shape = compact_copy;
+                } else {
+                    released += compact_shape(primitive.collision_shape);
+                }
+            }
+            version->compacted = true;
+        }
     }
+    return released;
+}
 
-    auto* scene_root = static_cast<Scene_root*>(first_node_raw->node_data.host);
-    if (scene_root == nullptr) {
-        log_operations->error("First selected mesh does node not have item (scene) host");
-        return;
-    }
+void Mesh_operation::make_entries(
+    const std::function<
+        erhe::geometry::Geometry(erhe::geometry::Geometry&)
+    > operation
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    class Source_primitive
+    {
+    public:
+        std::shared_ptr<erhe::geometry::Geometry>  geometry;
+        std::shared_ptr<erhe::primitive::Material> material;
+        erhe::primitive::Normal_style              normal_style;
+    };
+
+    // Source primitives for each entry
+    std::vector<std::vector<Source_primitive>> sources;
+
+    {
+        Selection& selection = *m_parameters.context.selection;
+        const auto& selected_items = selection.get_selection();
+        if (selected_items.empty()) {
+            return;
+        }
+
+        const auto first_mesh = selection.get<erhe::scene::Mesh>();
+        const auto first_node = selection.get<erhe::scene::Node>();
+        if (!first_mesh && !first_node) {
+            return;
+        }
+
+        auto* const first_node_raw = first_node ? first_node.get() : first_mesh->get_node();
+        if (first_node_raw == nullptr) {
+            // TODO Can this limitation be lifted?
+            log_operations->error("First selected mesh does not have scene, cannot perform geometry operation");
+            return;
+        }
+
+        erhe::Item_host* item_host = first_node_raw->get_item_host();
+        ERHE_VERIFY(item_host != nullptr);
+        std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
+
+        auto* scene_root = static_cast<Scene_root*>(first_node_raw->node_data.host);
+        if (scene_root == nullptr) {
+            log_operations->error("First selected mesh does node not have item (scene) host");
+            return;
+        }
 
 #if !defined(NDEBUG)
-    const auto& scene = scene_root->get_scene();
-    scene.sanity_check();
+        const auto& scene = scene_root->get_scene();
+        scene.sanity_check();
 #endif
 
-    for (auto& item : selected_items) {
-        auto  node_shared = std::dynamic_pointer_cast<erhe::scene::Node>(item);
-        auto* node        = node_shared.get();
-        auto  mesh        = std::dynamic_pointer_cast<erhe::scene::Mesh>(item);
+        for (auto& item : selected_items) {
+            auto  node_shared = std::dynamic_pointer_cast<erhe::scene::Node>(item);
+            auto* node        = node_shared.get();
+            auto  mesh        = std::dynamic_pointer_cast<erhe::scene::Mesh>(item);
 
-        // If we have node selected, get mesh from node
-        if (!mesh) {
-            if (node != nullptr) {
-                mesh = erhe::scene::get_mesh(node);
+            // If we have node selected, get mesh from node
+            if (!mesh) {
+                if (node != nullptr) {
+                    mesh = erhe::scene::get_mesh(node);
+                }
             }
+            if (!mesh) {
+                continue;
+            }
+            // If we have mesh selected, get node from mesh
+            if (node == nullptr) {
+                node = mesh->get_node();
+                node_shared = std::dynamic_pointer_cast<erhe::scene::Node>(node->shared_from_this());
+            }
+
+            std::vector<Source_primitive>& entry_sources = sources.emplace_back();
+            for (const auto& primitive : mesh->get_primitives()) {
+                const auto& render_shape = primitive.render_shape;
+                const std::shared_ptr<erhe::geometry::Geometry>& geometry = render_shape->get_geometry();
+                if (!geometry) {
+                    continue;
+                }
+                entry_sources.push_back(
+                    Source_primitive{
+                        .geometry     = geometry,
+                        .material     = primitive.material,
+                        .normal_style = render_shape->get_normal_style()
+                    }
+                );
+            }
+
+            add_entry(
+                Entry{
+                    // TODO consider keeping node alive always .node   = node_shared,
+                    .mesh   = mesh,
+                    .before = {
+                        .node_physics = get_node_physics(node),
+                        .primitives   = mesh->get_primitives()
+                    },
+                }
+            );
         }
-        if (!mesh) {
-            continue;
-        }
-        // If we have mesh selected, get node from mesh
-        if (node == nullptr) {
-            node = mesh->get_node();
-            node_shared = std::dynamic_pointer_cast<erhe::scene::Node>(node->shared_from_this());
-        }
+    }
 
-        Entry entry{
-            // TODO consider keeping node alive always .node   = node_shared,
-            .mesh   = mesh,
-            .before = {
-                .node_physics = get_node_physics(node),
-                .primitives   = mesh->get_primitives()
-            },
-        };
+    if (m_entries.empty()) {
+        return;
+    }
 
-        for (auto& primitive : mesh->get_mutable_primitives()) {
-            const auto& render_shape = primitive.render_shape;
-            const std::shared_ptr<erhe::geometry::Geometry>& geometry = render_shape->get_geometry();
-            if (!geometry) {
-                continue;
+    // Progress and cancel are per primitive, so that a single large mesh
+    // does not hold back either
+    Operation_progress* const progress = m_parameters.progress.get();
+    if (progress != nullptr) {
+        std::size_t primitive_count = 0;
+        for (const std::vector<Source_primitive>& entry_sources : sources) {
+            primitive_count += entry_sources.size();
+        }
+        progress->set_total(primitive_count);
+    }
+
+    const bool        make_physics = m_parameters.context.editor_settings->physics.static_enable;
+    std::atomic<bool> cancelled{false};
+    const auto is_cancelled = [&]() -> bool {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if ((progress != nullptr) && progress->is_cancel_requested()) {
+            cancelled.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    };
+    const auto make_entry = [&](const std::size_t entry_index) {
+        Entry& entry = m_entries[entry_index];
+        for (const Source_primitive& source : sources[entry_index]) {
+            if (is_cancelled()) {
+                return;
             }
             auto after_geometry = std::make_shared<erhe::geometry::Geometry>(
-                operation(*geometry.get())
+                operation(*source.geometry.get())
             );
 
-            erhe::primitive::Primitive after_primitive{after_geometry, primitive.material};
-            const bool renderable_ok = after_primitive.make_renderable_mesh(m_parameters.build_info, render_shape->get_normal_style());
+            erhe::primitive::Primitive after_primitive{after_geometry, source.material};
+            const bool renderable_ok = after_primitive.make_renderable_mesh(m_parameters.build_info, source.normal_style);
             const bool raytrace_ok   = after_primitive.make_raytrace();
             ERHE_VERIFY(renderable_ok && raytrace_ok);
             entry.after.primitives.push_back(after_primitive);
 
-            if (m_parameters.context.editor_settings->physics.static_enable) {
+            if (make_physics) {
                 auto collision_shape = erhe::physics::ICollision_shape::create_convex_hull_shape_shared(
                     reinterpret_cast<const float*>(
                         after_geometry->point_attributes().find<glm::vec3>(erhe::geometry::c_point_locations)->values.data()
@@ -213,14 +451,41 @@ void Mesh_operation::make_entries(
 
                 entry.after.node_physics = std::make_shared<Node_physics>(rigid_body_create_info);
             }
-
+            if (progress != nullptr) {
+                progress->add_completed();
+            }
         }
-        add_entry(std::move(entry));
+    };
+
+    // Operations are constructed on pool worker; parallel_for() keeps this
+    // worker processing entries instead of blocking it
+    erhe::concurrency::Thread_pool& thread_pool = m_parameters.context.operation_stack->get_thread_pool();
+    thread_pool.parallel_for(
+        0,
+        m_entries.size(),
+        [&make_entry](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                make_entry(i);
+            }
+        },
+        1
+    );
+
+    if (cancelled.load()) {
+        log_operations->info("Mesh operation cancelled");
+        m_entries.clear();
+        m_cancelled = true;
     }
+}
 
-#if !defined(NDEBUG)
-    scene.sanity_check();
-#endif
+auto Mesh_operation::is_cancelled() const -> bool
+{
+    return m_cancelled;
+}
+
+auto Mesh_operation::has_entries() const -> bool
+{
+    return !m_entries.empty();
 }
 
 void Mesh_operation::add_entry(Entry&& entry)
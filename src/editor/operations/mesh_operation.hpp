@@ -20,12 +20,14 @@ namespace editor {
 
 class Editor_context;
 class Node_physics;
+class Operation_progress;
 
 class Mesh_operation_parameters
 {
 public:
-    Editor_context&             context;
-    erhe::primitive::Build_info build_info;
+    Editor_context&                     context;
+    erhe::primitive::Build_info         build_info;
+    std::shared_ptr<Operation_progress> progress{}; // optional
 };
 
 class Mesh_operation : public Operation
@@ -42,6 +44,7 @@ protected:
         public:
             std::shared_ptr<Node_physics>           node_physics{};
             std::vector<erhe::primitive::Primitive> primitives{};
+            bool                                    compacted{false}; // geometry compressed, raytrace released
         };
         Version before{};
         Version after{};
@@ -51,17 +54,34 @@ protected:
     ~Mesh_operation() noexcept override;
 
     // Implements Operation
-    auto describe() const -> std::string   override;
-    void execute (Editor_context& context) override;
-    void undo    (Editor_context& context) override;
+    auto describe            () const -> std::string override;
+    void execute             (Editor_context& context) override;
+    void undo                (Editor_context& context) override;
+    auto get_memory_usage    () const -> std::size_t override;
+    auto get_gpu_memory_usage() const -> std::size_t override;
+    auto compact             () -> std::size_t       override;
 
     // Public API
     void add_entry   (Entry&& entry);
+
+    // Selected meshes are gathered while holding scene lock. Geometry
+    // operation, buffer and raytrace builds and collision shapes are then
+    // made for each mesh in parallel, without holding the lock. Reports to
+    // and polls cancel from m_parameters.progress, if set.
     void make_entries(const std::function<erhe::geometry::Geometry(erhe::geometry::Geometry&)> operation);
 
+public:
+    // Operation must not be queued if it was cancelled or has no entries
+    [[nodiscard]] auto is_cancelled() const -> bool;
+    [[nodiscard]] auto has_entries () const -> bool;
+
 protected:
     Mesh_operation_parameters m_parameters;
     std::vector<Entry>        m_entries;
+    bool                      m_cancelled{false};
+
+private:
+    static void restore(Version& version);
 };
 
 }
@@ -0,0 +1,55 @@
+#include "operations/operation_progress.hpp"
+
+namespace editor {
+
+Operation_progress::Operation_progress(const std::string& label)
+    : m_label{label}
+{
+}
+
+void Operation_progress::set_total(const std::size_t total)
+{
+    m_total.store(total, std::memory_order_relaxed);
+}
+
+void Operation_progress::add_completed(const std::size_t count)
+{
+    m_completed.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Operation_progress::request_cancel()
+{
+    m_cancel_requested.store(true, std::memory_order_release);
+}
+
+void Operation_progress::set_done()
+{
+    m_done.store(true, std::memory_order_release);
+}
+
+auto Operation_progress::get_label() const -> const std::string&
+{
+    return m_label;
+}
+
+auto Operation_progress::get_fraction() const -> float
+{
+    const std::size_t total = m_total.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return 0.0f;
+    }
+    const std::size_t completed = m_completed.load(std::memory_order_relaxed);
+    return static_cast<float>(completed) / static_cast<float>(total);
+}
+
+auto Operation_progress::is_cancel_requested() const -> bool
+{
+    return m_cancel_requested.load(std::memory_order_acquire);
+}
+
+auto Operation_progress::is_done() const -> bool
+{
+    return m_done.load(std::memory_order_acquire);
+}
+
+} // namespace editor
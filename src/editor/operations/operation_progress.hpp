@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace editor {
+
+// Shared between an operation being prepared on a worker thread and
+// Operation_stack, which shows progress and forwards cancel requests.
+class Operation_progress
+{
+public:
+    explicit Operation_progress(const std::string& label);
+
+    void set_total     (std::size_t total);
+    void add_completed (std::size_t count = 1);
+    void request_cancel();
+    void set_done      ();
+
+    [[nodiscard]] auto get_label          () const -> const std::string&;
+    [[nodiscard]] auto get_fraction       () const -> float;
+    [[nodiscard]] auto is_cancel_requested() const -> bool;
+    [[nodiscard]] auto is_done            () const -> bool;
+
+private:
+    std::string              m_label;
+    std::atomic<std::size_t> m_total           {0};
+    std::atomic<std::size_t> m_completed       {0};
+    std::atomic<bool>        m_cancel_requested{false};
+    std::atomic<bool>        m_done            {false};
+};
+
+} // namespace editor
@@ -1,18 +1,24 @@
 #include "operations/operation_stack.hpp"
 
 #include "editor_context.hpp"
+#include "editor_log.hpp"
 #include "operations/ioperation.hpp"
+#include "operations/operation_progress.hpp"
 #include "tools/tool.hpp"
 
 #include "erhe_imgui/imgui_windows.hpp"
 #include "erhe_commands/commands.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_configuration/configuration.hpp"
 #include "erhe_profile/profile.hpp"
 
 #if defined(ERHE_GUI_LIBRARY_IMGUI)
 #   include <imgui/imgui.h>
 #endif
 
-#include <taskflow/taskflow.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
 
 namespace editor {
 
@@ -55,7 +61,7 @@ auto Redo_command::try_call() -> bool
 #pragma endregion Commands
 
 Operation_stack::Operation_stack(
-    tf::Executor&                executor,
+    erhe::concurrency::Thread_pool& thread_pool,
     erhe::commands::Commands&    commands,
     erhe::imgui::Imgui_renderer& imgui_renderer,
     erhe::imgui::Imgui_windows&  imgui_windows,
@@ -63,7 +69,7 @@ Operation_stack::Operation_stack(
 )
     : erhe::imgui::Imgui_window{imgui_renderer, imgui_windows, "Operation Stack", "operation_stack"}
     , m_context     {editor_context}
-    , m_executor    {executor}
+    , m_thread_pool {thread_pool}
     , m_undo_command{commands, editor_context}
     , m_redo_command{commands, editor_context}
 {
@@ -76,34 +82,157 @@ Operation_stack::Operation_stack(
 
     m_undo_command.set_host(this);
     m_redo_command.set_host(this);
+
+    const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "operation_stack");
+    int memory_budget_mb = 512;
+    ini.get("memory_budget_mb", memory_budget_mb);
+    m_memory_budget = static_cast<std::size_t>(std::max(memory_budget_mb, 0)) * 1024 * 1024;
 }
 
 Operation_stack::~Operation_stack() = default;
 
-auto Operation_stack::get_executor() -> tf::Executor&
+auto Operation_stack::get_thread_pool() -> erhe::concurrency::Thread_pool&
+{
+    return m_thread_pool;
+}
+
+void Operation_stack::queue(const std::shared_ptr<Operation>& operation, const std::shared_ptr<Operation_progress>& progress)
 {
-    return m_executor;
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+    m_queued.push_back(Queued_operation{.operation = operation, .progress = progress});
 }
 
-void Operation_stack::queue(const std::shared_ptr<Operation>& operation)
+auto Operation_stack::make_progress(const std::string& label) -> std::shared_ptr<Operation_progress>
 {
-    m_queued.push_back(operation);
+    auto progress = std::make_shared<Operation_progress>(label);
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+    m_progress.push_back(progress);
+    return progress;
 }
 
 void Operation_stack::update()
 {
     ERHE_PROFILE_FUNCTION();
 
-    if (m_queued.empty()) {
+    {
+        const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+        std::swap(m_queued, m_update_queued);
+        m_progress.erase(
+            std::remove_if(
+                m_progress.begin(),
+                m_progress.end(),
+                [](const std::shared_ptr<Operation_progress>& progress) {
+                    return progress->is_done();
+                }
+            ),
+            m_progress.end()
+        );
+    }
+
+    if (m_update_queued.empty()) {
         return;
     }
 
-    for (const auto& operation : m_queued) {
-        operation->execute(m_context);
-        m_executed.push_back(operation);
+    bool executed = false;
+    for (const Queued_operation& queued : m_update_queued) {
+        if (queued.progress) {
+            queued.progress->set_done();
+            if (queued.progress->is_cancel_requested()) {
+                log_operations->info("Operation '{}' cancelled before execute", queued.progress->get_label());
+                continue;
+            }
+        }
+        queued.operation->execute(m_context);
+        m_executed.push_back(queued.operation);
+        executed = true;
+    }
+    m_update_queued.clear();
+    if (!executed) {
+        return;
     }
-    m_queued.clear();
     m_undone.clear();
+
+    enforce_memory_budget();
+}
+
+void Operation_stack::set_memory_budget(const std::size_t byte_count)
+{
+    m_memory_budget = byte_count;
+    enforce_memory_budget();
+}
+
+auto Operation_stack::get_memory_budget() const -> std::size_t
+{
+    return m_memory_budget;
+}
+
+void Operation_stack::enforce_memory_budget()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const auto sum_memory_usage = [this]() {
+        m_memory_usage     = 0;
+        m_gpu_memory_usage = 0;
+        for (const auto* operations : { &m_executed, &m_undone }) {
+            for (const auto& operation : *operations) {
+                m_memory_usage     += operation->get_memory_usage();
+                m_gpu_memory_usage += operation->get_gpu_memory_usage();
+            }
+        }
+    };
+
+    sum_memory_usage();
+    if (m_memory_usage <= m_memory_budget) {
+        m_over_budget = false;
+        return;
+    }
+
+    // Compact operations furthest away from current state first: oldest
+    // executed, and then most distant redo. Most recent operation in each
+    // direction is kept as is so that a single undo or redo stays fast.
+    for (std::size_t i = 0, end = m_executed.size(); (i + 1 < end) && (m_memory_usage > m_memory_budget); ++i) {
+        m_memory_usage -= std::min(m_memory_usage, m_executed[i]->compact());
+    }
+    for (std::size_t i = 0, end = m_undone.size(); (i + 1 < end) && (m_memory_usage > m_memory_budget); ++i) {
+        m_memory_usage -= std::min(m_memory_usage, m_undone[i]->compact());
+    }
+    sum_memory_usage();
+
+    // Still over budget; drop history furthest away from current state.
+    // Oldest executed operations go first, then most distant redo. Redo
+    // entries are only reachable through the undone operations in front
+    // of them, so they are dropped from the distant end as well.
+    std::size_t evicted_executed_count = 0;
+    while ((m_memory_usage > m_memory_budget) && (evicted_executed_count + 1 < m_executed.size())) {
+        m_memory_usage -= std::min(m_memory_usage, m_executed[evicted_executed_count]->get_memory_usage());
+        ++evicted_executed_count;
+    }
+    std::size_t evicted_undone_count = 0;
+    while ((m_memory_usage > m_memory_budget) && (evicted_undone_count + 1 < m_undone.size())) {
+        m_memory_usage -= std::min(m_memory_usage, m_undone[evicted_undone_count]->get_memory_usage());
+        ++evicted_undone_count;
+    }
+    if ((evicted_executed_count > 0) || (evicted_undone_count > 0)) {
+        m_executed.erase(m_executed.begin(), m_executed.begin() + static_cast<std::ptrdiff_t>(evicted_executed_count));
+        m_undone  .erase(m_undone  .begin(), m_undone  .begin() + static_cast<std::ptrdiff_t>(evicted_undone_count));
+        log_operations->info(
+            "Undo history over {:.1f} MB budget, dropped {} oldest undo and {} most distant redo operations",
+            static_cast<double>(m_memory_budget) / (1024.0 * 1024.0),
+            evicted_executed_count,
+            evicted_undone_count
+        );
+        sum_memory_usage();
+    }
+
+    const bool over_budget = (m_memory_usage > m_memory_budget);
+    if (over_budget && !m_over_budget) {
+        log_operations->warn(
+            "Undo history uses {:.1f} MB after compaction and eviction, over {:.1f} MB budget",
+            static_cast<double>(m_memory_usage)  / (1024.0 * 1024.0),
+            static_cast<double>(m_memory_budget) / (1024.0 * 1024.0)
+        );
+    }
+    m_over_budget = over_budget;
 }
 
 void Operation_stack::undo()
@@ -115,6 +244,7 @@ void Operation_stack::undo()
     m_executed.pop_back();
     operation->undo(m_context);
     m_undone.push_back(operation);
+    enforce_memory_budget();
 }
 
 void Operation_stack::redo()
@@ -126,6 +256,7 @@ void Operation_stack::redo()
     m_undone.pop_back();
     operation->execute(m_context);
     m_executed.push_back(operation);
+    enforce_memory_budget();
 }
 
 auto Operation_stack::can_undo() const -> bool
@@ -154,7 +285,17 @@ void Operation_stack::imgui(const char* stack_label, const std::vector<std::shar
 
     if (ImGui::TreeNodeEx(stack_label, parent_flags)) {
         for (const auto& op : operations) {
-            ImGui::TreeNodeEx(op->describe().c_str(), leaf_flags);
+            const std::size_t memory_usage     = op->get_memory_usage();
+            const std::size_t gpu_memory_usage = op->get_gpu_memory_usage();
+            const std::string label = (memory_usage + gpu_memory_usage > 0)
+                ? fmt::format(
+                    "{} - {:.1f} kB, GPU {:.1f} kB",
+                    op->describe(),
+                    static_cast<double>(memory_usage)     / 1024.0,
+                    static_cast<double>(gpu_memory_usage) / 1024.0
+                )
+                : op->describe();
+            ImGui::TreeNodeEx(label.c_str(), leaf_flags);
         }
         ImGui::TreePop();
     }
@@ -166,6 +307,31 @@ void Operation_stack::imgui()
     ERHE_PROFILE_FUNCTION();
 
 #if defined(ERHE_GUI_LIBRARY_IMGUI)
+    {
+        const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+        for (const auto& progress : m_progress) {
+            ImGui::PushID(progress.get());
+            const bool cancel_requested = progress->is_cancel_requested();
+            ImGui::ProgressBar(progress->get_fraction(), ImVec2{-80.0f, 0.0f}, progress->get_label().c_str());
+            ImGui::SameLine();
+            if (cancel_requested) {
+                ImGui::BeginDisabled();
+            }
+            if (ImGui::Button("Cancel")) {
+                progress->request_cancel();
+            }
+            if (cancel_requested) {
+                ImGui::EndDisabled();
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::Text(
+        "Memory: %.1f / %.1f MB, GPU buffers %.1f MB",
+        static_cast<double>(m_memory_usage)     / (1024.0 * 1024.0),
+        static_cast<double>(m_memory_budget)    / (1024.0 * 1024.0),
+        static_cast<double>(m_gpu_memory_usage) / (1024.0 * 1024.0)
+    );
     imgui("Executed", m_executed);
     imgui("Undone", m_undone);
 #endif
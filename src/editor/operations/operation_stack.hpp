@@ -2,25 +2,29 @@
 
 #include "erhe_commands/command.hpp"
 #include "erhe_imgui/imgui_window.hpp"
+#include "erhe_profile/profile.hpp"
 
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 namespace erhe::commands {
     class CommandS;
 }
+namespace erhe::concurrency {
+    class Thread_pool;
+}
 namespace erhe::imgui {
     class Imgui_windows;
 }
-namespace tf {
-    class Executor;
-}
 
 namespace editor {
 
 class Editor_context;
 class Editor_message_bus;
 class Operation;
+class Operation_progress;
 class Editor_context;
 class Operation_stack;
 class Selection_tool;
@@ -51,7 +55,7 @@ class Operation_stack
 {
 public:
     Operation_stack(
-        tf::Executor&                executor,
+        erhe::concurrency::Thread_pool& thread_pool,
         erhe::commands::Commands&    commands,
         erhe::imgui::Imgui_renderer& imgui_renderer,
         erhe::imgui::Imgui_windows&  imgui_windows,
@@ -61,29 +65,58 @@ public:
 
     [[nodiscard]] auto can_undo() const -> bool;
     [[nodiscard]] auto can_redo() const -> bool;
-    void queue(const std::shared_ptr<Operation>& operation);
+    // Thread safe; operations are executed from update(). With progress,
+    // the operation is dropped if cancel is requested before it executes,
+    // and progress is set done when the operation is executed or dropped.
+    void queue(const std::shared_ptr<Operation>& operation, const std::shared_ptr<Operation_progress>& progress = {});
+
+    // Thread safe; progress is shown until Operation_progress::set_done()
+    [[nodiscard]] auto make_progress(const std::string& label) -> std::shared_ptr<Operation_progress>;
     void undo();
     void redo();
 
     void update();
 
+    // Oldest operations are compacted when CPU memory used by undo history
+    // exceeds budget; compacted operations keep their geometry compressed.
+    // If history is still over budget, oldest undo and most distant redo
+    // operations are dropped, keeping the most recent one in each direction.
+    // GPU buffer memory is only reported.
+    void set_memory_budget(std::size_t byte_count);
+    [[nodiscard]] auto get_memory_budget() const -> std::size_t;
+
     // Implements Window
     void imgui() override;
 
-    [[nodiscard]] auto get_executor() -> tf::Executor&;
+    [[nodiscard]] auto get_thread_pool() -> erhe::concurrency::Thread_pool&;
 
 private:
+    class Queued_operation
+    {
+    public:
+        std::shared_ptr<Operation>          operation;
+        std::shared_ptr<Operation_progress> progress;
+    };
+
     void imgui(const char* stack_label, const std::vector<std::shared_ptr<Operation>>& operations);
+    void enforce_memory_budget();
 
-    Editor_context& m_context;
-    tf::Executor&   m_executor;
+    Editor_context&                 m_context;
+    erhe::concurrency::Thread_pool& m_thread_pool;
 
     Undo_command m_undo_command;
     Redo_command m_redo_command;
 
     std::vector<std::shared_ptr<Operation>> m_executed;
     std::vector<std::shared_ptr<Operation>> m_undone;
-    std::vector<std::shared_ptr<Operation>> m_queued;
+    std::size_t                             m_memory_budget   {512 * 1024 * 1024};
+    std::size_t                             m_memory_usage    {0};
+    std::size_t                             m_gpu_memory_usage{0};
+    bool                                    m_over_budget     {false};
+    ERHE_PROFILE_MUTEX(std::mutex,                   m_mutex);
+    std::vector<Queued_operation>                    m_queued;
+    std::vector<Queued_operation>                    m_update_queued;
+    std::vector<std::shared_ptr<Operation_progress>> m_progress;
 };
 
 } // namespace editor
@@ -84,11 +84,14 @@ void import_gltf(
 
     erhe::gltf::Image_transfer image_transfer{graphics_instance};
     erhe::gltf::Gltf_parse_arguments parse_arguments{
-        .graphics_instance = graphics_instance,
-        .image_transfer    = image_transfer,
-        .root_node         = root_node,
-        .mesh_layer_id     = scene_root.layers().content()->id,
-        .path              = path,
+        .graphics_instance  = &graphics_instance,
+        .image_transfer     = &image_transfer,
+        .root_node          = root_node,
+        .mesh_layer_id      = scene_root.layers().content()->id,
+        .path               = path,
+        .make_geometry      = true,
+        .make_raytrace      = true,
+        .index_optimization = build_info.index_optimization
     };
     erhe::gltf::Gltf_data gltf_data = erhe::gltf::parse_gltf(parse_arguments);
 
@@ -138,6 +141,9 @@ void import_gltf(
 
     std::unordered_map<erhe::scene::Node*, int> node_colors;
 
+    // Render shapes are shared by mesh instances, and by primitives using same accessors
+    std::unordered_set<erhe::primitive::Primitive_render_shape*> processed_render_shapes;
+
     bool add_default_camera = true;
     bool add_default_light = false;
     log_parsers->info("Processing {} nodes", gltf_data.nodes.size());
@@ -179,11 +185,17 @@ void import_gltf(
             // TODO Defer geometry / raytrace / renderable mesh generation
             std::vector<erhe::primitive::Primitive>& primitives = mesh->get_mutable_primitives();
             for (erhe::primitive::Primitive& primitive : primitives) {
-                // Ensure geometry exists
-                ERHE_VERIFY(primitive.make_geometry());
-
-                // Ensure raytrace exists
-                ERHE_VERIFY(primitive.make_raytrace());
+                if (!processed_render_shapes.insert(primitive.render_shape.get()).second) {
+                    continue;
+                }
+
+                // Geometry and raytrace are normally built by parse_gltf() worker threads
+                if (!primitive.render_shape->get_geometry_const()) {
+                    ERHE_VERIFY(primitive.make_geometry());
+                }
+                if (!primitive.has_raytrace_triangles()) {
+                    ERHE_VERIFY(primitive.make_raytrace());
+                }
 
                 // Ensure renderable mesh exists
                 ERHE_VERIFY(primitive.make_renderable_mesh(build_info, erhe::primitive::Normal_style::corner_normals));
@@ -27,20 +27,64 @@ auto Mesh_memory::get_index_buffer_size() const -> std::size_t
     return static_cast<std::size_t>(index_buffer_size) * mega;
 }
 
-Mesh_memory::Mesh_memory(erhe::graphics::Instance& graphics_instance, erhe::scene_renderer::Program_interface& program_interface)
-    : graphics_instance{graphics_instance}
-    , vertex_format{
-        erhe::graphics::Vertex_attribute::position_float3(),
-        erhe::graphics::Vertex_attribute::normal0_float3(),
-        erhe::graphics::Vertex_attribute::normal1_float3(), // editor wireframe bias requires smooth normal attribute
-        erhe::graphics::Vertex_attribute::tangent_float4(),
-        erhe::graphics::Vertex_attribute::texcoord0_float2(),
+auto Mesh_memory::get_index_optimization() const -> erhe::primitive::Index_optimization
+{
+    erhe::primitive::Index_optimization index_optimization{};
+    const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "mesh_memory");
+    ini.get("optimize_vertex_cache",  index_optimization.vertex_cache);
+    ini.get("optimize_overdraw",      index_optimization.overdraw);
+    ini.get("optimize_vertex_fetch",  index_optimization.vertex_fetch);
+    ini.get("overdraw_threshold",     index_optimization.overdraw_threshold);
+    ini.get("log_index_optimization", index_optimization.log_statistics);
+    return index_optimization;
+}
+
+auto Mesh_memory::get_lod_settings() const -> erhe::primitive::Lod_settings
+{
+    erhe::primitive::Lod_settings lod_settings{};
+    const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "mesh_memory");
+    ini.get("lod_level_count",        lod_settings.level_count);
+    ini.get("lod_reduction",          lod_settings.reduction);
+    ini.get("lod_min_triangle_count", lod_settings.min_triangle_count);
+    return lod_settings;
+}
+
+auto Mesh_memory::make_vertex_format(const bool compact) -> erhe::graphics::Vertex_format
+{
+    if (!compact) {
+        return erhe::graphics::Vertex_format{
+            erhe::graphics::Vertex_attribute::position_float3(),
+            erhe::graphics::Vertex_attribute::normal0_float3(),
+            erhe::graphics::Vertex_attribute::normal1_float3(), // editor wireframe bias requires smooth normal attribute
+            erhe::graphics::Vertex_attribute::tangent_float4(),
+            erhe::graphics::Vertex_attribute::texcoord0_float2(),
+            erhe::graphics::Vertex_attribute::color_ubyte4(),
+            erhe::graphics::Vertex_attribute::aniso_control_ubyte2(),
+            erhe::graphics::Vertex_attribute::joint_indices0_ubyte4(),
+            erhe::graphics::Vertex_attribute::joint_weights0_float4(),
+            erhe::graphics::Vertex_attribute::vertex_valency()
+        };
+    }
+
+    // 42 bytes per vertex instead of 92: positions quantized to mesh
+    // bounding box, octahedral normals and tangent, half float texcoord
+    return erhe::graphics::Vertex_format{
+        erhe::graphics::Vertex_attribute::position_unorm16_3(),
+        erhe::graphics::Vertex_attribute::normal0_octahedral_snorm16(),
+        erhe::graphics::Vertex_attribute::normal1_octahedral_snorm16(),
+        erhe::graphics::Vertex_attribute::tangent_octahedral_snorm16(),
+        erhe::graphics::Vertex_attribute::texcoord0_half2(),
         erhe::graphics::Vertex_attribute::color_ubyte4(),
         erhe::graphics::Vertex_attribute::aniso_control_ubyte2(),
         erhe::graphics::Vertex_attribute::joint_indices0_ubyte4(),
-        erhe::graphics::Vertex_attribute::joint_weights0_float4(),
+        erhe::graphics::Vertex_attribute::joint_weights0_ubyte4(),
         erhe::graphics::Vertex_attribute::vertex_valency()
-    }
+    };
+}
+
+Mesh_memory::Mesh_memory(erhe::graphics::Instance& graphics_instance, erhe::scene_renderer::Program_interface& program_interface)
+    : graphics_instance{graphics_instance}
+    , vertex_format{make_vertex_format(program_interface.compact_vertex_format)}
     , gl_vertex_buffer{graphics_instance, gl::Buffer_target::array_buffer, get_vertex_buffer_size(), storage_mask}
     , gl_index_buffer{graphics_instance, gl::Buffer_target::element_array_buffer, get_index_buffer_size(), storage_mask}
     , gl_buffer_sink{gl_buffer_transfer_queue, gl_vertex_buffer, gl_index_buffer}
@@ -49,6 +93,8 @@ Mesh_memory::Mesh_memory(erhe::graphics::Instance& graphics_instance, erhe::scen
         .vertex_format = vertex_format,
         .buffer_sink   = gl_buffer_sink
     }
+    , index_optimization{get_index_optimization()}
+    , lod_settings      {get_lod_settings()}
     //, build_info{
     //    .primitive_types{
     //        .fill_triangles  = true,
@@ -70,6 +116,9 @@ Mesh_memory::Mesh_memory(erhe::graphics::Instance& graphics_instance, erhe::scen
 {
     gl_vertex_buffer.set_debug_label("Mesh Memory Vertex");
     gl_index_buffer .set_debug_label("Mesh Memory Index");
+
+    const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "mesh_memory");
+    ini.get("lod_max_pixel_error", lod_max_pixel_error);
 }
 
 } // namespace editor
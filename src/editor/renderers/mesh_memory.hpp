@@ -36,14 +36,20 @@ public:
     erhe::graphics::Buffer                gl_index_buffer;
     erhe::primitive::Gl_buffer_sink       gl_buffer_sink;
     erhe::primitive::Buffer_info          buffer_info;
+    erhe::primitive::Index_optimization   index_optimization;
+    erhe::primitive::Lod_settings         lod_settings;
+    float                                 lod_max_pixel_error{0.0f};
     //erhe::primitive::Build_info           build_info;
     erhe::graphics::Vertex_input_state    vertex_input;
     //erhe::graphics::Shader_resource       vertex_data_in;   // For SSBO read
     //erhe::graphics::Shader_resource       vertex_data_out;  // For SSBO write
 
 private:
+    [[nodiscard]] static auto make_vertex_format(bool compact) -> erhe::graphics::Vertex_format;
     [[nodiscard]] auto get_vertex_buffer_size() const -> std::size_t;
     [[nodiscard]] auto get_index_buffer_size() const -> std::size_t;
+    [[nodiscard]] auto get_index_optimization() const -> erhe::primitive::Index_optimization;
+    [[nodiscard]] auto get_lod_settings      () const -> erhe::primitive::Lod_settings;
 };
 
 } // namespace editor
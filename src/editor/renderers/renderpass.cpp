@@ -182,6 +182,8 @@ void Renderpass::render(const Render_context& context) const
                         : (render_style != nullptr)
                             ? render_style->get_primitive_settings(this->primitive_mode)
                             : erhe::scene_renderer::Primitive_interface_settings{},
+                .frustum_culling        = context.editor_context.editor_rendering->frustum_culling,
+                .lod_max_pixel_error    = context.editor_context.mesh_memory->lod_max_pixel_error,
                 .shadow_texture         = context.scene_view.get_shadow_texture(),
                 .viewport               = context.viewport,
                 .filter                 = this->filter,
@@ -2,6 +2,7 @@
 
 #include "editor_context.hpp"
 #include "editor_log.hpp"
+#include "editor_rendering.hpp"
 #include "renderers/mesh_memory.hpp"
 
 #include "scene/scene_root.hpp"
@@ -138,7 +139,8 @@ void Shadow_render_node::execute_rendergraph_node()
             .mesh_spans            = { layers.content()->meshes },
             .lights                = layers.light()->lights,
             .skins                 = scene_root->get_scene().get_skins(),
-            .light_projections     = m_light_projections
+            .light_projections     = m_light_projections,
+            .frustum_culling       = m_context.editor_rendering->frustum_culling
         }
     );
 }
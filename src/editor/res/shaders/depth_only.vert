@@ -1,9 +1,12 @@
+#define ERHE_PRIMITIVE_INDEX gl_BaseInstance
+#include "erhe_vertex.glsl"
+
 // Used by Shadow_renderer
 void main() {
     mat4 world_from_node;
 
-    if (primitive.primitives[gl_DrawID].skinning_factor < 0.5) {
-        world_from_node = primitive.primitives[gl_DrawID].world_from_node;
+    if (primitive.primitives[ERHE_PRIMITIVE_INDEX].skinning_factor < 0.5) {
+        world_from_node = primitive.primitives[ERHE_PRIMITIVE_INDEX].world_from_node;
     } else {
         world_from_node =
             a_weights.x * joint.joints[int(a_joints.x)].world_from_bind +
@@ -13,7 +16,7 @@ void main() {
     }
 
     mat4 clip_from_world   = light_block.lights[light_control_block.light_index].clip_from_world;
-    vec4 position_in_world = world_from_node * vec4(a_position, 1.0);
+    vec4 position_in_world = world_from_node * vec4(decode_position(a_position), 1.0);
     gl_Position = clip_from_world * position_in_world;
 }
 
@@ -0,0 +1,50 @@
+#ifndef ERHE_VERTEX_GLSL
+#define ERHE_VERTEX_GLSL
+
+// Vertex attribute decoding for compact vertex formats.
+//
+// Positions are always dequantized with per primitive scale and offset,
+// which are identity for float positions. Normals and tangents are
+// octahedral encoded when ERHE_OCTAHEDRAL_NORMALS is defined; tangent
+// handedness sign is then stored in z.
+//
+// Primitive records are indexed with ERHE_PRIMITIVE_INDEX, gl_DrawID by
+// default. Shaders used with draw lists that skip records (Shadow_renderer
+// with frustum culling) define it as gl_BaseInstance before including.
+
+#if !defined(ERHE_PRIMITIVE_INDEX)
+#   define ERHE_PRIMITIVE_INDEX gl_DrawID
+#endif
+
+vec3 octahedral_decode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * vec2(
+            (v.x >= 0.0) ? 1.0 : -1.0,
+            (v.y >= 0.0) ? 1.0 : -1.0
+        );
+    }
+    return normalize(v);
+}
+
+vec3 decode_position(vec3 position) {
+    return primitive.primitives[ERHE_PRIMITIVE_INDEX].position_offset.xyz + primitive.primitives[ERHE_PRIMITIVE_INDEX].position_scale.xyz * position;
+}
+
+vec3 decode_normal(vec3 normal) {
+#if defined(ERHE_OCTAHEDRAL_NORMALS)
+    return octahedral_decode(normal.xy);
+#else
+    return normal;
+#endif
+}
+
+vec4 decode_tangent(vec4 tangent) {
+#if defined(ERHE_OCTAHEDRAL_NORMALS)
+    return vec4(octahedral_decode(tangent.xy), (tangent.z < 0.0) ? -1.0 : 1.0);
+#else
+    return tangent;
+#endif
+}
+
+#endif // ERHE_VERTEX_GLSL
@@ -1,3 +1,5 @@
+#include "erhe_vertex.glsl"
+
 void main()
 {
     mat4 world_from_node;
@@ -13,6 +15,6 @@ void main()
     }
 
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
-    vec4 position        = world_from_node * vec4(a_position, 1.0);
+    vec4 position        = world_from_node * vec4(decode_position(a_position), 1.0);
     gl_Position          = clip_from_world * position;
 }
@@ -1,3 +1,5 @@
+#include "erhe_vertex.glsl"
+
 out vec3  vs_position;
 out vec4  vs_color;
 out float vs_line_width;
@@ -17,7 +19,7 @@ void main()
     }
 
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
-    vec4 position        = world_from_node * vec4(a_position.xyz, 1.0);
+    vec4 position        = world_from_node * vec4(decode_position(a_position.xyz), 1.0);
 
     gl_Position   = clip_from_world * position;
     vs_position   = position.xyz;
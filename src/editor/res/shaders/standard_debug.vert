@@ -1,3 +1,5 @@
+#include "erhe_vertex.glsl"
+
 out vec2      v_texcoord;
 out vec4      v_position;
 out vec4      v_color;
@@ -39,12 +41,12 @@ void main()
 
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
 
-    vec3 normal          = normalize(vec3(world_from_node_cofactor * vec4(a_normal,        0.0)));
-    vec3 tangent         = normalize(vec3(world_from_node_cofactor * vec4(a_tangent.xyz,   0.0)));
-    vec3 bitangent       = normalize(cross(normal, tangent)) * a_tangent.w;
-    vec4 position        = world_from_node * vec4(a_position, 1.0);
+    vec3 normal          = normalize(vec3(world_from_node_cofactor * vec4(decode_normal(a_normal),       0.0)));
+    vec3 tangent         = normalize(vec3(world_from_node_cofactor * vec4(decode_tangent(a_tangent).xyz, 0.0)));
+    vec3 bitangent       = normalize(cross(normal, tangent)) * decode_tangent(a_tangent).w;
+    vec4 position        = world_from_node * vec4(decode_position(a_position), 1.0);
 
-    v_tangent_scale  = a_tangent.w;
+    v_tangent_scale  = decode_tangent(a_tangent).w;
     v_position       = position;
     v_TBN            = mat3(tangent, bitangent, normal);
     gl_Position      = clip_from_world * position;
@@ -1,3 +1,5 @@
+#include "erhe_vertex.glsl"
+
 out layout(location = 0) vec4  vs_color;
 out layout(location = 1) float vs_line_width;
 
@@ -23,8 +25,8 @@ void main()
     }
 
     mat4 clip_from_world = camera.cameras[0].clip_from_world;
-    vec4 position        = world_from_node * vec4(a_position, 1.0);
-    vec3 normal          = normalize(vec3(world_from_node_cofactor * vec4(a_normal_smooth, 0.0)));
+    vec4 position        = world_from_node * vec4(decode_position(a_position), 1.0);
+    vec3 normal          = normalize(vec3(world_from_node_cofactor * vec4(decode_normal(a_normal_smooth), 0.0)));
 
     vec3 view_position_in_world = vec3(
         camera.cameras[0].world_from_node[3][0],
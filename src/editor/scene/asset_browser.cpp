@@ -86,7 +86,9 @@ void Scene_open_operation::execute(Editor_context& context)
                     .corner_points   = true,
                     .centroid_points = true
                 },
-                .buffer_info = context.mesh_memory->buffer_info
+                .buffer_info        = context.mesh_memory->buffer_info,
+                .index_optimization = context.mesh_memory->index_optimization,
+                .lod                = context.mesh_memory->lod_settings
             },
             *m_scene_root.get(),
             m_path
@@ -287,7 +289,9 @@ auto Asset_browser::try_import(const std::shared_ptr<Asset_file_gltf>& gltf) ->
                     .corner_points   = true,
                     .centroid_points = true
                 },
-                .buffer_info = m_context.mesh_memory->buffer_info
+                .buffer_info        = m_context.mesh_memory->buffer_info,
+                .index_optimization = m_context.mesh_memory->index_optimization,
+                .lod                = m_context.mesh_memory->lod_settings
             },
             *m_context.scene_builder->get_scene_root().get(),
             gltf->get_source_path()
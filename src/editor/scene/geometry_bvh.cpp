@@ -0,0 +1,316 @@
+#include "scene/geometry_bvh.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace editor {
+
+using erhe::geometry::c_point_locations;
+using erhe::geometry::Corner_id;
+using glm::vec3;
+
+auto ray_triangle_intersect(
+    const vec3& origin,
+    const vec3& direction,
+    const vec3& v0,
+    const vec3& v1,
+    const vec3& v2,
+    float& t,
+    float& u,
+    float& v
+) -> bool
+{
+    const vec3 v0v1 = v1 - v0;
+    const vec3 v0v2 = v2 - v0;
+    const vec3 pvec = glm::cross(direction, v0v2);
+    const float det = glm::dot(v0v1, pvec);
+    constexpr float epsilon = 0.00001f;
+
+    // if the determinant is negative the triangle is backfacing
+    // if the determinant is close to 0, the ray misses the triangle
+    if (det < epsilon) {
+        return false;
+    }
+    const float inv_det = 1.0f / det;
+
+    const vec3 tvec = origin - v0;
+    u = glm::dot(tvec, pvec) * inv_det;
+    if ((u < 0.0f) || (u > 1.0f)) {
+        return false;
+    }
+    const vec3 qvec = glm::cross(tvec, v0v1);
+    v = glm::dot(direction, qvec) * inv_det;
+    if ((v < 0.0f) || (u + v > 1.0f)) {
+        return false;
+    }
+
+    t = glm::dot(v0v2, qvec) * inv_det;
+
+    return t >= 0.0f;
+}
+
+Geometry_bvh::Geometry_bvh(const erhe::geometry::Geometry& geometry)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const auto* const point_locations = geometry.point_attributes().find<vec3>(c_point_locations);
+    if (point_locations == nullptr) {
+        return;
+    }
+
+    m_triangles.reserve(geometry.count_polygon_triangles());
+    geometry.for_each_polygon_const([&](auto& i) {
+        const uint32_t corner_count = i.polygon.corner_count;
+        if (corner_count < 3) {
+            return;
+        }
+        const auto location = [&](const uint32_t polygon_corner_offset) -> vec3 {
+            const Corner_id corner_id = geometry.polygon_corners[i.polygon.first_polygon_corner_id + polygon_corner_offset];
+            return point_locations->get(geometry.corners[corner_id].point_id);
+        };
+        const vec3 v0 = location(0);
+        for (uint32_t k = 0; k + 2 < corner_count; ++k) {
+            m_triangles.push_back(
+                Bvh_triangle{
+                    .v0         = v0,
+                    .v1         = location(k + 1),
+                    .v2         = location(k + 2),
+                    .polygon_id = i.polygon_id,
+                    .fan_index  = k
+                }
+            );
+        }
+    });
+
+    if (m_triangles.empty()) {
+        return;
+    }
+
+    std::vector<Bounds> triangle_bounds(m_triangles.size());
+    std::vector<vec3>   centroids      (m_triangles.size());
+    Bounds root_bounds;
+    for (std::size_t i = 0, end = m_triangles.size(); i < end; ++i) {
+        const Bvh_triangle& triangle = m_triangles[i];
+        triangle_bounds[i].include(triangle.v0);
+        triangle_bounds[i].include(triangle.v1);
+        triangle_bounds[i].include(triangle.v2);
+        centroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) / 3.0f;
+        root_bounds.include(triangle_bounds[i]);
+    }
+
+    m_nodes.reserve(2 * (m_triangles.size() / c_leaf_size + 1));
+    m_nodes.push_back(
+        Bvh_node{
+            .bounds = root_bounds,
+            .first  = 0,
+            .count  = static_cast<uint32_t>(m_triangles.size())
+        }
+    );
+
+    // Depth limit bounds both the build work list and traversal stack
+    class Build_item
+    {
+    public:
+        uint32_t node_index;
+        uint32_t depth;
+    };
+    std::vector<Build_item> build_items;
+    build_items.push_back(Build_item{.node_index = 0, .depth = 0});
+    while (!build_items.empty()) {
+        const Build_item item = build_items.back();
+        build_items.pop_back();
+        if ((item.depth < c_max_depth) && split(item.node_index, triangle_bounds, centroids)) {
+            const uint32_t left_index = m_nodes[item.node_index].first;
+            build_items.push_back(Build_item{.node_index = left_index + 1, .depth = item.depth + 1});
+            build_items.push_back(Build_item{.node_index = left_index,     .depth = item.depth + 1});
+        }
+    }
+}
+
+auto Geometry_bvh::split(const uint32_t node_index, std::vector<Bounds>& triangle_bounds, std::vector<vec3>& centroids) -> bool
+{
+    const uint32_t first = m_nodes[node_index].first;
+    const uint32_t count = m_nodes[node_index].count;
+    if (count <= c_leaf_size) {
+        return false;
+    }
+
+    Bounds centroid_bounds;
+    for (uint32_t i = first; i < first + count; ++i) {
+        centroid_bounds.include(centroids[i]);
+    }
+
+    // Find best split among bin boundaries on all axes
+    float    best_cost  = std::numeric_limits<float>::max();
+    int      best_axis  = -1;
+    uint32_t best_split = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float axis_min = centroid_bounds.min[axis];
+        const float extent   = centroid_bounds.max[axis] - axis_min;
+        if (extent <= 0.0f) {
+            continue;
+        }
+        const float scale = static_cast<float>(c_bin_count) / extent;
+
+        std::array<Bounds,   c_bin_count> bin_bounds{};
+        std::array<uint32_t, c_bin_count> bin_counts{};
+        for (uint32_t i = first; i < first + count; ++i) {
+            const uint32_t bin = std::min(c_bin_count - 1, static_cast<uint32_t>((centroids[i][axis] - axis_min) * scale));
+            bin_bounds[bin].include(triangle_bounds[i]);
+            ++bin_counts[bin];
+        }
+
+        std::array<float, c_bin_count - 1> left_costs{};
+        Bounds   left_bounds;
+        uint32_t left_count = 0;
+        for (uint32_t bin = 0; bin < c_bin_count - 1; ++bin) {
+            left_bounds.include(bin_bounds[bin]);
+            left_count += bin_counts[bin];
+            left_costs[bin] = (left_count > 0) ? left_bounds.half_area() * static_cast<float>(left_count) : 0.0f;
+        }
+        Bounds   right_bounds;
+        uint32_t right_count = 0;
+        for (uint32_t bin = c_bin_count - 1; bin > 0; --bin) {
+            right_bounds.include(bin_bounds[bin]);
+            right_count += bin_counts[bin];
+            const float cost = left_costs[bin - 1] + ((right_count > 0) ? right_bounds.half_area() * static_cast<float>(right_count) : 0.0f);
+            if (cost < best_cost) {
+                best_cost  = cost;
+                best_axis  = axis;
+                best_split = bin;
+            }
+        }
+    }
+
+    const float leaf_cost = m_nodes[node_index].bounds.half_area() * static_cast<float>(count);
+    if ((best_axis < 0) || (best_cost >= leaf_cost)) {
+        return false;
+    }
+
+    // Partition triangles, keeping per triangle build data in same order
+    const float axis_min = centroid_bounds.min[best_axis];
+    const float scale    = static_cast<float>(c_bin_count) / (centroid_bounds.max[best_axis] - axis_min);
+    uint32_t i = first;
+    uint32_t j = first + count;
+    while (i < j) {
+        const uint32_t bin = std::min(c_bin_count - 1, static_cast<uint32_t>((centroids[i][best_axis] - axis_min) * scale));
+        if (bin < best_split) {
+            ++i;
+        } else {
+            --j;
+            std::swap(m_triangles    [i], m_triangles    [j]);
+            std::swap(triangle_bounds[i], triangle_bounds[j]);
+            std::swap(centroids      [i], centroids      [j]);
+        }
+    }
+    const uint32_t left_count = i - first;
+    if ((left_count == 0) || (left_count == count)) {
+        return false;
+    }
+
+    const uint32_t left_index = static_cast<uint32_t>(m_nodes.size());
+    Bounds left_bounds;
+    Bounds right_bounds;
+    for (uint32_t k = first; k < i; ++k) {
+        left_bounds.include(triangle_bounds[k]);
+    }
+    for (uint32_t k = i; k < first + count; ++k) {
+        right_bounds.include(triangle_bounds[k]);
+    }
+    m_nodes.push_back(Bvh_node{.bounds = left_bounds,  .first = first, .count = left_count});
+    m_nodes.push_back(Bvh_node{.bounds = right_bounds, .first = i,     .count = count - left_count});
+    m_nodes[node_index].first = left_index;
+    m_nodes[node_index].count = 0;
+    return true;
+}
+
+namespace {
+
+[[nodiscard]] auto ray_bounds_distance(
+    const vec3&   origin,
+    const vec3&   inverse_direction,
+    const Bounds& bounds,
+    const float   t_max
+) -> float
+{
+    float enter = 0.0f;
+    float exit  = t_max;
+    for (glm::length_t axis = 0; axis < 3; ++axis) {
+        // Ray parallel to slab is inside it for all t or for none. Slab
+        // distances would be 0 * inf = NaN for origin on slab plane, which
+        // axis aligned rays of orthographic views make likely.
+        if (std::isinf(inverse_direction[axis])) {
+            if ((origin[axis] < bounds.min[axis]) || (origin[axis] > bounds.max[axis])) {
+                return std::numeric_limits<float>::max();
+            }
+            continue;
+        }
+        const float t0 = (bounds.min[axis] - origin[axis]) * inverse_direction[axis];
+        const float t1 = (bounds.max[axis] - origin[axis]) * inverse_direction[axis];
+        enter = std::max(enter, std::min(t0, t1));
+        exit  = std::min(exit,  std::max(t0, t1));
+    }
+    return (enter <= exit) ? enter : std::numeric_limits<float>::max();
+}
+
+} // anonymous namespace
+
+auto Geometry_bvh::intersect(const vec3& origin, const vec3& direction) const -> Bvh_hit
+{
+    Bvh_hit hit{};
+    if (m_nodes.empty()) {
+        return hit;
+    }
+
+    const vec3 inverse_direction = 1.0f / direction;
+    constexpr float no_hit = std::numeric_limits<float>::max();
+
+    // Popping node at depth d leaves at most one pending far child for each
+    // of levels 1 to d, and pushes two more, so c_max_depth + 1 is enough.
+    std::array<uint32_t, c_max_depth + 1> stack;
+    std::size_t stack_size = 0;
+    if (ray_bounds_distance(origin, inverse_direction, m_nodes[0].bounds, hit.t) == no_hit) {
+        return hit;
+    }
+    stack[stack_size++] = 0;
+    while (stack_size > 0) {
+        const Bvh_node& node = m_nodes[stack[--stack_size]];
+        if (node.count > 0) {
+            for (uint32_t i = node.first, end = node.first + node.count; i < end; ++i) {
+                const Bvh_triangle& triangle = m_triangles[i];
+                float t;
+                float u;
+                float v;
+                if (
+                    ray_triangle_intersect(origin, direction, triangle.v0, triangle.v1, triangle.v2, t, u, v) &&
+                    (t < hit.t)
+                ) {
+                    hit = Bvh_hit{.triangle = &triangle, .t = t, .u = u, .v = v};
+                }
+            }
+            continue;
+        }
+
+        // Visit nearer child first
+        const float left_distance  = ray_bounds_distance(origin, inverse_direction, m_nodes[node.first    ].bounds, hit.t);
+        const float right_distance = ray_bounds_distance(origin, inverse_direction, m_nodes[node.first + 1].bounds, hit.t);
+        const bool  left_first     = left_distance <= right_distance;
+        const float near_distance  = left_first ? left_distance  : right_distance;
+        const float far_distance   = left_first ? right_distance : left_distance;
+        const uint32_t near_child  = left_first ? node.first : node.first + 1;
+        const uint32_t far_child   = left_first ? node.first + 1 : node.first;
+        ERHE_VERIFY(stack_size + 2 <= stack.size());
+        if (far_distance != no_hit) {
+            stack[stack_size++] = far_child;
+        }
+        if (near_distance != no_hit) {
+            stack[stack_size++] = near_child;
+        }
+    }
+    return hit;
+}
+
+} // namespace editor
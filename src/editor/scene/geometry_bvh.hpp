@@ -0,0 +1,98 @@
+#pragma once
+
+#include "erhe_geometry/geometry.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace editor {
+
+// Returns true if ray hits front face of triangle at t >= 0; u and v are
+// barycentric coordinates of hit relative to v1 and v2
+[[nodiscard]] auto ray_triangle_intersect(
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    const glm::vec3& v0,
+    const glm::vec3& v1,
+    const glm::vec3& v2,
+    float& t,
+    float& u,
+    float& v
+) -> bool;
+
+class Bounds
+{
+public:
+    void include(const glm::vec3& p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    void include(const Bounds& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+    [[nodiscard]] auto half_area() const -> float
+    {
+        const glm::vec3 d = glm::max(max - min, glm::vec3{0.0f});
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    glm::vec3 min{ std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+};
+
+// Polygons are fan triangulated from their first corner; triangle k of
+// polygon uses polygon corners 0, k + 1 and k + 2.
+class Bvh_triangle
+{
+public:
+    glm::vec3                         v0;
+    glm::vec3                         v1;
+    glm::vec3                         v2;
+    erhe::geometry::Polygon_id        polygon_id;
+    erhe::geometry::Polygon_corner_id fan_index;
+};
+
+class Bvh_node
+{
+public:
+    Bounds   bounds;
+    uint32_t first{0}; // first triangle for leaf, first child for inner node
+    uint32_t count{0}; // 0 for inner node
+};
+
+class Bvh_hit
+{
+public:
+    const Bvh_triangle* triangle{nullptr};
+    float               t{std::numeric_limits<float>::max()};
+    float               u{0.0f};
+    float               v{0.0f};
+};
+
+// Binned SAH BVH over fan triangulated polygons of a Geometry
+class Geometry_bvh
+{
+public:
+    static constexpr uint32_t c_leaf_size = 4;
+    static constexpr uint32_t c_bin_count = 16;
+    static constexpr uint32_t c_max_depth = 48; // nodes at this depth stay leaves
+
+    explicit Geometry_bvh(const erhe::geometry::Geometry& geometry);
+
+    [[nodiscard]] auto intersect(const glm::vec3& origin, const glm::vec3& direction) const -> Bvh_hit;
+
+private:
+    // Splits leaf node into two children, returns false if node stays leaf
+    [[nodiscard]] auto split(uint32_t node_index, std::vector<Bounds>& triangle_bounds, std::vector<glm::vec3>& centroids) -> bool;
+
+    std::vector<Bvh_triangle> m_triangles;
+    std::vector<Bvh_node>     m_nodes;
+};
+
+} // namespace editor
@@ -1,70 +1,93 @@
 #include "scene/mesh_intersect.hpp"
+#include "scene/geometry_bvh.hpp"
 #include "editor_log.hpp"
+#include "erhe_primitive/primitive.hpp"
+#include "erhe_profile/profile.hpp"
 #include "erhe_scene/mesh.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace editor {
 
-using erhe::geometry::c_point_locations;
-using erhe::geometry::Corner;
 using erhe::geometry::Corner_id;
-using erhe::geometry::Point_id;
-using erhe::geometry::Polygon_id;
 using erhe::geometry::Polygon_corner_id;
 using glm::vec3;
 using glm::vec4;
 
 namespace {
 
-#define CULLING 0
-
-auto ray_triangle_intersect(
-    const vec3& origin,
-    const vec3& direction,
-    const vec3& v0,
-    const vec3& v1,
-    const vec3& v2,
-    float& t,
-    float& u,
-    float& v
-) -> bool
+class Bvh_cache_entry
 {
-    const vec3 v0v1 = v1 - v0;
-    const vec3 v0v2 = v2 - v0;
-    const vec3 pvec = glm::cross(direction, v0v2);
-    const float det = glm::dot(v0v1, pvec);
-#ifdef CULLING
-    constexpr float epsilon = 0.00001f;
-
-    // if the determinant is negative the triangle is backfacing
-    // if the determinant is close to 0, the ray misses the triangle
-    if (det < epsilon) {
-        return false;
-    }
-#else
-    // ray and triangle are parallel if det is close to 0
-    if (std::fabs(det) < epsilon) {
-        return false;
-    }
-#endif
-    const float inv_det = 1.0f / det;
+public:
+    std::weak_ptr<erhe::geometry::Geometry> geometry;
+    uint64_t                                serial       {0};
+    uint32_t                                polygon_count{0};
+    uint32_t                                corner_count {0};
+    std::shared_ptr<const Geometry_bvh>     bvh;
+};
+
+class Bvh_cache
+{
+public:
+    [[nodiscard]] auto get(const std::shared_ptr<erhe::geometry::Geometry>& geometry) -> std::shared_ptr<const Geometry_bvh>
+    {
+        const uint64_t serial        = geometry->get_serial();
+        const uint32_t polygon_count = geometry->get_polygon_count();
+        const uint32_t corner_count  = geometry->get_corner_count();
+        {
+            const std::lock_guard<std::mutex> lock{m_mutex};
+            const auto i = m_entries.find(geometry.get());
+            if (i != m_entries.end()) {
+                const Bvh_cache_entry& entry = i->second;
+                if (
+                    (entry.geometry.lock() == geometry) &&
+                    (entry.serial        == serial)        &&
+                    (entry.polygon_count == polygon_count) &&
+                    (entry.corner_count  == corner_count)
+                ) {
+                    return entry.bvh;
+                }
+            }
+        }
 
-    const vec3 tvec = origin - v0;
-    u = glm::dot(tvec, pvec) * inv_det;
-    if ((u < 0.0f) || (u > 1.0f)) {
-        return false;
+        // Built without holding lock; concurrent builds for same geometry are harmless
+        auto bvh = std::make_shared<const Geometry_bvh>(*geometry.get());
+
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        prune_locked();
+        m_entries[geometry.get()] = Bvh_cache_entry{
+            .geometry      = geometry,
+            .serial        = serial,
+            .polygon_count = polygon_count,
+            .corner_count  = corner_count,
+            .bvh           = bvh
+        };
+        return bvh;
     }
-    const vec3 qvec = glm::cross(tvec, v0v1);
-    v = glm::dot(direction, qvec) * inv_det;
-    if ((v < 0.0f) || (u + v > 1.0f)) {
-        return false;
+
+private:
+    // Entries of destroyed geometries are dropped when new entries are added
+    void prune_locked()
+    {
+        for (auto i = m_entries.begin(); i != m_entries.end();) {
+            if (i->second.geometry.expired()) {
+                i = m_entries.erase(i);
+            } else {
+                ++i;
+            }
+        }
     }
 
-    t = glm::dot(v0v2, qvec) * inv_det;
+    std::mutex                                                          m_mutex;
+    std::unordered_map<const erhe::geometry::Geometry*, Bvh_cache_entry> m_entries;
+};
 
-    return true;
-}
+Bvh_cache s_bvh_cache;
 
 } // namespace
 
@@ -79,6 +102,27 @@ auto intersect(
     float&                      out_v
 ) -> bool
 {
+    Corner_id corner_id{0};
+    return intersect(
+        mesh, origin_in_world, direction_in_world,
+        out_geometry, out_polygon_id, corner_id, out_t, out_u, out_v
+    );
+}
+
+auto intersect(
+    const erhe::scene::Mesh&    mesh,
+    const vec3                  origin_in_world,
+    const vec3                  direction_in_world,
+    erhe::geometry::Geometry*&  out_geometry,
+    erhe::geometry::Polygon_id& out_polygon_id,
+    erhe::geometry::Corner_id&  out_corner_id,
+    float&                      out_t,
+    float&                      out_u,
+    float&                      out_v
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
     const erhe::scene::Node* node = mesh.get_node();
     ERHE_VERIFY(node != nullptr);
     const auto mesh_from_world   = node->node_from_world();
@@ -88,62 +132,38 @@ auto intersect(
     out_t = std::numeric_limits<float>::max();
 
     for (auto& primitive : mesh.get_primitives()) {
-        const std::shared_ptr<erhe::primitive::Primitive_shape>& shape = primitive.get_shape_for_raytrace();
-        if (shape) {
+        const std::shared_ptr<erhe::primitive::Primitive_shape> shape = primitive.get_shape_for_raytrace();
+        if (!shape) {
             continue;
         }
-        erhe::geometry::Geometry* geometry = shape->get_geometry().get();
-        if (geometry == nullptr) {
+        const std::shared_ptr<erhe::geometry::Geometry>& geometry = shape->get_geometry();
+        if (!geometry) {
             continue;
         }
 
-        const auto* const point_locations = geometry->point_attributes().find<vec3>(c_point_locations);
-        if (point_locations == nullptr) {
-            return false;
+        const std::shared_ptr<const Geometry_bvh> bvh = s_bvh_cache.get(geometry);
+        const Bvh_hit hit = bvh->intersect(origin_in_mesh, direction_in_mesh);
+        if ((hit.triangle == nullptr) || (hit.t >= out_t)) {
+            continue;
         }
 
-        //erhe::raytrace::log_geometry.trace("raytrace {}\n", geometry->name);
-        geometry->for_each_polygon_const([&](auto& i) {
-            const Corner_id first_corner_id = geometry->polygon_corners[i.polygon.first_polygon_corner_id];
-            const Corner&   first_corner    = geometry->corners[first_corner_id];
-            const Point_id  first_point_id  = first_corner.point_id;
-            const vec3 v0 = point_locations->get(first_point_id);
-
-            for (Polygon_corner_id j = 0; j < i.polygon.corner_count; ++j) {
-                const std::size_t corner_index      = static_cast<std::size_t>(i.polygon.first_polygon_corner_id) + static_cast<size_t>(j);
-                const std::size_t next_corner_index = static_cast<std::size_t>(i.polygon.first_polygon_corner_id) + (static_cast<size_t>(j) + 1) % static_cast<size_t>(i.polygon.corner_count);
-                const Corner_id   corner_id         = geometry->polygon_corners[corner_index];
-                const Corner_id   next_corner_id    = geometry->polygon_corners[next_corner_index];
-                const Corner&     corner            = geometry->corners[corner_id];
-                const Corner&     next_corner       = geometry->corners[next_corner_id];
-                const Point_id    point_id          = corner.point_id;
-                const Point_id    next_point_id     = next_corner.point_id;
-                const vec3        v1                = point_locations->get(point_id);
-                const vec3        v2                = point_locations->get(next_point_id);
-
-                float hit_t;
-                float hit_u;
-                float hit_v;
-                const bool hit = ray_triangle_intersect(origin_in_mesh, direction_in_mesh, v0, v1, v2, hit_t, hit_u, hit_v);
-                if (hit) {
-                    log_raytrace->trace(
-                        "hit polygon {} {}-{}-{} with t = {}",
-                        i.polygon_id,
-                        first_point_id,
-                        point_id,
-                        next_point_id,
-                        hit_t
-                    );
-                }
-                if (hit && (hit_t < out_t)) {
-                    out_geometry   = geometry;
-                    out_polygon_id = i.polygon_id;
-                    out_t          = hit_t;
-                    out_u          = hit_u;
-                    out_v          = hit_v;
-                }
-            }
-        });
+        // Map hit back to polygon, and to polygon corner nearest to hit
+        // using barycentric coordinates of fan triangle (v0, v1, v2).
+        const Bvh_triangle&          triangle = *hit.triangle;
+        const erhe::geometry::Polygon& polygon = geometry->polygons[triangle.polygon_id];
+        const float w0 = 1.0f - hit.u - hit.v;
+        const Polygon_corner_id fan_offset =
+            ((w0 >= hit.u) && (w0 >= hit.v)) ? 0 :
+            (hit.u >= hit.v)                 ? triangle.fan_index + 1
+                                             : triangle.fan_index + 2;
+
+        out_geometry   = geometry.get();
+        out_polygon_id = triangle.polygon_id;
+        out_corner_id  = geometry->polygon_corners[polygon.first_polygon_corner_id + fan_offset];
+        out_t          = hit.t;
+        out_u          = hit.u;
+        out_v          = hit.v;
+        log_raytrace->trace("hit polygon {} corner {} with t = {}", out_polygon_id, out_corner_id, out_t);
     }
 
     if (out_t != std::numeric_limits<float>::max()) {
@@ -10,6 +10,9 @@ namespace erhe::scene {
 
 namespace editor {
 
+// Intersects ray given in world space with polygons of mesh primitives.
+// Uses BVH over fan triangulated polygons, built on first query and
+// cached per geometry until geometry serial or element counts change.
 [[nodiscard]] auto intersect(
     const erhe::scene::Mesh&    mesh,
     const glm::vec3             origin,
@@ -21,4 +24,17 @@ namespace editor {
     float&                      out_v
 ) -> bool;
 
+// As above, also returns corner of hit polygon closest to hit position
+[[nodiscard]] auto intersect(
+    const erhe::scene::Mesh&    mesh,
+    const glm::vec3             origin,
+    const glm::vec3             direction,
+    erhe::geometry::Geometry*&  out_geometry,
+    erhe::geometry::Polygon_id& out_polygon_id,
+    erhe::geometry::Corner_id&  out_corner_id,
+    float&                      out_t,
+    float&                      out_u,
+    float&                      out_v
+) -> bool;
+
 } // namespace editor
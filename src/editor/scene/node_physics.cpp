@@ -92,19 +92,26 @@ void Node_physics::handle_item_host_update(erhe::Item_host* const old_item_host,
 
 void Node_physics::before_physics_simulation()
 {
+    // Node transform written by after_physics_simulation() can be
+    // interpolated between steps, and must not be fed back to simulation
+    if (
+        m_world_from_node_from_physics_valid &&
+        (get_node()->world_from_node() == m_world_from_node_from_physics)
+    ) {
+        return;
+    }
+    m_world_from_node_from_physics_valid = false;
+
     const erhe::scene::Trs_transform& world_from_node_transform = get_node()->world_from_node_transform();
     erhe::physics::Transform transform{
         glm::mat3_cast(world_from_node_transform.get_rotation()),
         world_from_node_transform.get_translation()
     };
     m_rigid_body->set_world_transform(transform);
-
-    const auto get_transform = m_rigid_body->get_world_transform();
-    const glm::vec3 get_world_position = glm::vec3{get_transform * glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}};
 }
 
 // This is intended to be called from physics backend
-void Node_physics::after_physics_simulation()
+void Node_physics::after_physics_simulation(const float interpolation_alpha)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -116,7 +123,7 @@ void Node_physics::after_physics_simulation()
         return;
     }
 
-    const auto transform = m_rigid_body->get_world_transform();
+    const auto transform = m_rigid_body->get_interpolated_world_transform(interpolation_alpha);
     const glm::vec3 world_position = glm::vec3{transform * glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}};
 
     if (world_position.y < -100.0f) {
@@ -129,6 +136,8 @@ void Node_physics::after_physics_simulation()
     } else {
         get_node()->set_world_from_node(transform);
     }
+    m_world_from_node_from_physics       = get_node()->world_from_node();
+    m_world_from_node_from_physics_valid = true;
 }
 
 auto Node_physics::get_rigid_body() -> IRigid_body*
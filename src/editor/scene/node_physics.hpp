@@ -44,7 +44,7 @@ public:
     [[nodiscard]] auto get_rigid_body() const -> const erhe::physics::IRigid_body*;
 
     void before_physics_simulation();
-    void after_physics_simulation();
+    void after_physics_simulation (float interpolation_alpha);
 
     void set_physics_world(erhe::physics::IWorld* value);
     [[nodiscard]] auto get_physics_world() const -> erhe::physics::IWorld*;
@@ -57,6 +57,11 @@ private:
     erhe::physics::IWorld*                      m_physics_world{nullptr};
     erhe::physics::IRigid_body_create_info      m_create_info;
     std::shared_ptr<erhe::physics::IRigid_body> m_rigid_body;
+
+    // Node transform last written from rigid body; node changes made
+    // elsewhere are detected by comparing against this
+    bool                                        m_world_from_node_from_physics_valid{false};
+    glm::mat4                                   m_world_from_node_from_physics{1.0f};
 };
 
 auto is_physics(const erhe::Item_base* item) -> bool;
@@ -263,7 +263,9 @@ auto Scene_builder::build_info(Mesh_memory& mesh_memory) -> erhe::primitive::Bui
             .corner_points   = true,
             .centroid_points = true
         },
-        .buffer_info = mesh_memory.buffer_info
+        .buffer_info        = mesh_memory.buffer_info,
+        .index_optimization = mesh_memory.index_optimization,
+        .lod                = mesh_memory.lod_settings
     };
 }
 
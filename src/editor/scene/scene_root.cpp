@@ -131,41 +131,27 @@ Scene_root::Scene_root(
 
     //m_scene->enable_flag_bits(erhe::Item_flags::show_in_ui);
     m_scene->get_root_node()->enable_flag_bits(erhe::Item_flags::invisible_parent);
-    m_physics_world  = erhe::physics::IWorld::create_unique();
+    m_physics_world = erhe::physics::IWorld::create_unique(
+        (editor_scenes != nullptr)
+            ? editor_scenes->get_physics_world_create_info()
+            : erhe::physics::World_create_info{}
+    );
+
+    // Activation callbacks are invoked from physics job threads during
+    // simulation steps. Events are queued and applied to nodes in
+    // after_physics_simulation_steps().
     m_physics_world->set_on_body_activated(
         [this](erhe::physics::IRigid_body* rigid_body) {
             ERHE_VERIFY(rigid_body != nullptr);
-            if (rigid_body->get_motion_mode() != erhe::physics::Motion_mode::e_dynamic) {
-                return;
-            }
-            void* owner = rigid_body->get_owner();
-            Node_physics* node_physics = reinterpret_cast<Node_physics*>(owner);
-            if (node_physics == nullptr) {
-                return;
-            }
-            erhe::scene::Node* node = node_physics->get_node();
-            if (node == nullptr) {
-                return;
-            }
-            node->enable_flag_bits(erhe::Item_flags::no_transform_update);
+            const std::lock_guard<std::mutex> lock{m_activation_events_mutex};
+            m_activation_events.push_back(Activation_event{rigid_body, true});
         }
     );
     m_physics_world->set_on_body_deactivated(
         [this](erhe::physics::IRigid_body* rigid_body) {
             ERHE_VERIFY(rigid_body != nullptr);
-            //if (rigid_body->get_motion_mode() != erhe::physics::Motion_mode::e_dynamic) {
-            //    return;
-            //}
-            void* owner = rigid_body->get_owner();
-            Node_physics* node_physics = reinterpret_cast<Node_physics*>(owner);
-            if (node_physics == nullptr) {
-                return;
-            }
-            erhe::scene::Node* node = node_physics->get_node();
-            if (node == nullptr) {
-                return;
-            }
-            node->disable_flag_bits(erhe::Item_flags::no_transform_update);
+            const std::lock_guard<std::mutex> lock{m_activation_events_mutex};
+            m_activation_events.push_back(Activation_event{rigid_body, false});
         }
     );
 
@@ -505,6 +491,9 @@ void Scene_root::register_node_physics(const std::shared_ptr<Node_physics>& node
         return;
     }
 
+    // Scene_builder registers from thread pool workers
+    const std::lock_guard<std::mutex> lock{m_node_physics_mutex};
+
 #ifndef NDEBUG
     const auto i = std::find(m_node_physics.begin(), m_node_physics.end(), node_physics);
     if (i != m_node_physics.end()) {
@@ -518,9 +507,12 @@ void Scene_root::register_node_physics(const std::shared_ptr<Node_physics>& node
     }
 
     node_physics->set_physics_world(m_physics_world.get());
+    // Adding is deferred to flush_pending_rigid_bodies(), so that
+    // bodies of scenes with many nodes are added in one batch
     erhe::physics::IRigid_body* rigid_body = node_physics->get_rigid_body();
     if (rigid_body != nullptr) {
-        m_physics_world->add_rigid_body(node_physics->get_rigid_body());
+        m_pending_rigid_body_indices[rigid_body] = m_pending_rigid_bodies.size();
+        m_pending_rigid_bodies.push_back(rigid_body);
     }
 }
 
@@ -530,6 +522,8 @@ void Scene_root::unregister_node_physics(const std::shared_ptr<Node_physics>& no
         return;
     }
 
+    const std::lock_guard<std::mutex> lock{m_node_physics_mutex};
+
     const auto i = std::remove(
         m_node_physics.begin(),
         m_node_physics.end(),
@@ -545,13 +539,56 @@ void Scene_root::unregister_node_physics(const std::shared_ptr<Node_physics>& no
 
     erhe::physics::IRigid_body* rigid_body = node_physics->get_rigid_body();
     if (rigid_body != nullptr) {
-        m_physics_world->remove_rigid_body(node_physics->get_rigid_body());
+        {
+            const std::lock_guard<std::mutex> lock{m_activation_events_mutex};
+            m_activation_events.erase(
+                std::remove_if(
+                    m_activation_events.begin(),
+                    m_activation_events.end(),
+                    [rigid_body](const Activation_event& event) {
+                        return event.rigid_body == rigid_body;
+                    }
+                ),
+                m_activation_events.end()
+            );
+        }
+        const auto pending = m_pending_rigid_body_indices.find(rigid_body);
+        if (pending != m_pending_rigid_body_indices.end()) {
+            // Swap with last, order of pending bodies does not matter
+            const std::size_t index = pending->second;
+            erhe::physics::IRigid_body* last = m_pending_rigid_bodies.back();
+            m_pending_rigid_bodies[index] = last;
+            m_pending_rigid_body_indices[last] = index;
+            m_pending_rigid_bodies.pop_back();
+            m_pending_rigid_body_indices.erase(rigid_body);
+        } else {
+            m_physics_world->remove_rigid_body(rigid_body);
+        }
     }
     node_physics->set_physics_world(nullptr);
 }
 
+void Scene_root::flush_pending_rigid_bodies()
+{
+    if (!m_physics_world) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock{m_node_physics_mutex};
+    if (m_pending_rigid_bodies.empty()) {
+        return;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    m_physics_world->add_rigid_bodies(m_pending_rigid_bodies);
+    m_pending_rigid_bodies.clear();
+    m_pending_rigid_body_indices.clear();
+}
+
 void Scene_root::before_physics_simulation_steps()
 {
+    const std::lock_guard<std::mutex> lock{m_node_physics_mutex};
     for (const auto& node_physics : m_node_physics) {
         auto* rigid_body = node_physics->get_rigid_body();
         if (rigid_body == nullptr) {
@@ -568,12 +605,45 @@ void Scene_root::update_physics_simulation_fixed_step(const double dt)
     }
 }
 
-void Scene_root::after_physics_simulation_steps()
+void Scene_root::apply_activation_events()
+{
+    {
+        const std::lock_guard<std::mutex> lock{m_activation_events_mutex};
+        std::swap(m_activation_events, m_applied_activation_events);
+    }
+
+    for (const Activation_event& event : m_applied_activation_events) {
+        erhe::physics::IRigid_body* rigid_body = event.rigid_body;
+        if (event.active && (rigid_body->get_motion_mode() != erhe::physics::Motion_mode::e_dynamic)) {
+            continue;
+        }
+        Node_physics* node_physics = reinterpret_cast<Node_physics*>(rigid_body->get_owner());
+        if (node_physics == nullptr) {
+            continue;
+        }
+        erhe::scene::Node* node = node_physics->get_node();
+        if (node == nullptr) {
+            continue;
+        }
+        if (event.active) {
+            node->enable_flag_bits(erhe::Item_flags::no_transform_update);
+        } else {
+            node->disable_flag_bits(erhe::Item_flags::no_transform_update);
+        }
+    }
+    m_applied_activation_events.clear();
+}
+
+void Scene_root::after_physics_simulation_steps(const float interpolation_alpha)
 {
     if (!m_physics_world) {
         return;
     }
 
+    apply_activation_events();
+
+    const std::lock_guard<std::mutex> lock{m_node_physics_mutex};
+
     // Sort nodes, so that parent transforms are updated before child nodes
     if (!m_node_physics_sorted) {
         std::sort(
@@ -595,7 +665,7 @@ void Scene_root::after_physics_simulation_steps()
         auto* rigid_body = node_physics->get_rigid_body();
         if (rigid_body) {
             if (rigid_body->is_active()) {
-                node_physics->after_physics_simulation();
+                node_physics->after_physics_simulation(interpolation_alpha);
             }
         }
     }
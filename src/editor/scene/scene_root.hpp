@@ -20,6 +20,7 @@
 #include <memory>
 #include <mutex>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 class btCollisionShape;
@@ -158,9 +159,12 @@ public:
     void register_node_physics  (const std::shared_ptr<Node_physics>& node_physics);
     void unregister_node_physics(const std::shared_ptr<Node_physics>& node_physics);
 
+    // Adds rigid bodies of newly registered Node_physics to physics world
+    // as one batch. Called once per frame.
+    void flush_pending_rigid_bodies          ();
     void before_physics_simulation_steps     ();
     void update_physics_simulation_fixed_step(double dt);
-    void after_physics_simulation_steps      ();
+    void after_physics_simulation_steps      (float interpolation_alpha);
 
     [[nodiscard]] auto layers            () -> Scene_layers&;
     [[nodiscard]] auto layers            () const -> const Scene_layers&;
@@ -183,7 +187,15 @@ public:
     void sanity_check();
 
 private:
+    class Activation_event
+    {
+    public:
+        erhe::physics::IRigid_body* rigid_body{nullptr};
+        bool                        active    {false};
+    };
+
     [[nodiscard]] auto get_node_rt_mask(erhe::scene::Node* node) -> uint32_t;
+    void apply_activation_events();
 
     // Live longest
     mutable ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
@@ -196,6 +208,12 @@ private:
     // Must live longer than m_scene for example
     bool                                            m_node_physics_sorted{false};
     std::vector<std::shared_ptr<Node_physics>>      m_node_physics;
+    std::mutex                                      m_node_physics_mutex; // m_node_physics and pending rigid bodies
+    std::vector<erhe::physics::IRigid_body*>        m_pending_rigid_bodies;
+    std::unordered_map<erhe::physics::IRigid_body*, std::size_t> m_pending_rigid_body_indices; // index in m_pending_rigid_bodies
+    std::mutex                                      m_activation_events_mutex;
+    std::vector<Activation_event>                   m_activation_events;
+    std::vector<Activation_event>                   m_applied_activation_events;
     std::vector<std::shared_ptr<Rendertarget_mesh>> m_rendertarget_meshes;
 
     std::vector<std::shared_ptr<erhe::Item_base>>   m_physics_disabled_nodes;
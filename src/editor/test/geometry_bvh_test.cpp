@@ -0,0 +1,210 @@
+// Compares Geometry_bvh ray hits against brute force intersection of every
+// fan triangle, which is what editor mesh_intersect did before the BVH.
+//
+// Uses random rays at a torus, a sphere and a box, and axis parallel rays
+// of orthographic views with origins on a grid that includes the planes
+// of the geometry bounding box. Origins exactly on a bounding box plane
+// used to produce NaN slab distances (0 * inf) and miss.
+
+#include "scene/geometry_bvh.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_geometry/shapes/box.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+#include "erhe_geometry/shapes/torus.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+namespace {
+
+using erhe::geometry::Geometry;
+using glm::vec3;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+class Brute_force_hit
+{
+public:
+    bool  hit{false};
+    float t  {std::numeric_limits<float>::max()};
+};
+
+auto brute_force_intersect(const Geometry& geometry, const vec3& origin, const vec3& direction) -> Brute_force_hit
+{
+    Brute_force_hit result;
+    const auto* const point_locations = geometry.point_attributes().find<vec3>(erhe::geometry::c_point_locations);
+    if (point_locations == nullptr) {
+        return result;
+    }
+    geometry.for_each_polygon_const([&](auto& i) {
+        const auto location = [&](const uint32_t polygon_corner_offset) -> vec3 {
+            const erhe::geometry::Corner_id corner_id = geometry.polygon_corners[i.polygon.first_polygon_corner_id + polygon_corner_offset];
+            return point_locations->get(geometry.corners[corner_id].point_id);
+        };
+        for (uint32_t k = 0; k + 2 < i.polygon.corner_count; ++k) {
+            float t;
+            float u;
+            float v;
+            if (editor::ray_triangle_intersect(origin, direction, location(0), location(k + 1), location(k + 2), t, u, v) && (t < result.t)) {
+                result.hit = true;
+                result.t   = t;
+            }
+        }
+    });
+    return result;
+}
+
+class Comparison
+{
+public:
+    std::size_t ray_count     {0};
+    std::size_t hit_count     {0};
+    std::size_t mismatch_count{0};
+};
+
+void compare(const editor::Geometry_bvh& bvh, const Geometry& geometry, const vec3& origin, const vec3& direction, Comparison& comparison)
+{
+    const editor::Bvh_hit bvh_hit     = bvh.intersect(origin, direction);
+    const Brute_force_hit brute_force = brute_force_intersect(geometry, origin, direction);
+    const bool            bvh_hits    = (bvh_hit.triangle != nullptr);
+    const bool            same        =
+        (bvh_hits == brute_force.hit) &&
+        (!bvh_hits || (std::abs(bvh_hit.t - brute_force.t) <= 1.0e-5f * std::max(1.0f, brute_force.t)));
+    ++comparison.ray_count;
+    comparison.hit_count += brute_force.hit ? 1 : 0;
+    if (!same) {
+        ++comparison.mismatch_count;
+        if (comparison.mismatch_count <= 5) {
+            fmt::print(
+                stderr, "mismatch: origin ({}, {}, {}) direction ({}, {}, {}): bvh {} t = {}, brute force {} t = {}\n",
+                origin.x, origin.y, origin.z, direction.x, direction.y, direction.z,
+                bvh_hits, bvh_hit.t, brute_force.hit, brute_force.t
+            );
+        }
+    }
+}
+
+auto get_bounds(const Geometry& geometry) -> editor::Bounds
+{
+    editor::Bounds bounds;
+    const auto* const point_locations = geometry.point_attributes().find<vec3>(erhe::geometry::c_point_locations);
+    for (erhe::geometry::Point_id point_id = 0, end = geometry.get_point_count(); point_id < end; ++point_id) {
+        if (point_locations->has(point_id)) {
+            bounds.include(point_locations->get(point_id));
+        }
+    }
+    return bounds;
+}
+
+void test_random_rays(const Geometry& geometry, const editor::Geometry_bvh& bvh, const char* label)
+{
+    const editor::Bounds bounds = get_bounds(geometry);
+    const vec3           center = 0.5f * (bounds.min + bounds.max);
+    const float          radius = 2.0f * glm::length(bounds.max - bounds.min);
+
+    std::mt19937                          random{1234u};
+    std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+    std::uniform_real_distribution<float> fraction{-0.1f, 1.1f};
+    Comparison comparison;
+    for (int i = 0; i < 2000; ++i) {
+        vec3 from{unit(random), unit(random), unit(random)};
+        if (glm::length(from) < 0.01f) {
+            continue;
+        }
+        const vec3 origin = center + radius * glm::normalize(from);
+        const vec3 target = bounds.min + vec3{fraction(random), fraction(random), fraction(random)} * (bounds.max - bounds.min);
+        compare(bvh, geometry, origin, glm::normalize(target - origin), comparison);
+    }
+    fmt::print("{} random rays: {} rays, {} hits, {} mismatches\n", label, comparison.ray_count, comparison.hit_count, comparison.mismatch_count);
+    check(comparison.hit_count > comparison.ray_count / 10, "random rays: rays hit geometry");
+    check(comparison.mismatch_count == 0,                   "random rays: BVH hits match brute force");
+}
+
+// Axis parallel rays from both sides along each axis. Origins in other two
+// axes are on a grid from bounding box min to max, both included, so some
+// origins lie exactly on slab planes of BVH root and leaf bounds.
+void test_orthographic_rays(const Geometry& geometry, const editor::Geometry_bvh& bvh, const char* label, const bool expect_plane_hits)
+{
+    const editor::Bounds bounds = get_bounds(geometry);
+    constexpr int grid_steps = 16;
+    Comparison comparison;
+    Comparison plane_comparison; // Origins on bounding box planes
+    for (glm::length_t axis = 0; axis < 3; ++axis) {
+        const glm::length_t axis_u = (axis + 1) % 3;
+        const glm::length_t axis_v = (axis + 2) % 3;
+        for (const float sign : { 1.0f, -1.0f }) {
+            vec3 direction{0.0f};
+            direction[axis] = -sign;
+            for (int i = 0; i <= grid_steps; ++i) {
+                for (int j = 0; j <= grid_steps; ++j) {
+                    vec3 origin;
+                    origin[axis]   = (sign > 0.0f) ? bounds.max[axis] + 1.0f : bounds.min[axis] - 1.0f;
+                    origin[axis_u] = (i == grid_steps) ? bounds.max[axis_u] : bounds.min[axis_u] + (bounds.max[axis_u] - bounds.min[axis_u]) * static_cast<float>(i) / grid_steps;
+                    origin[axis_v] = (j == grid_steps) ? bounds.max[axis_v] : bounds.min[axis_v] + (bounds.max[axis_v] - bounds.min[axis_v]) * static_cast<float>(j) / grid_steps;
+                    const bool on_plane = (i == 0) || (i == grid_steps) || (j == 0) || (j == grid_steps);
+                    compare(bvh, geometry, origin, direction, on_plane ? plane_comparison : comparison);
+                }
+            }
+        }
+    }
+    fmt::print(
+        "{} orthographic rays: {} rays, {} hits, {} mismatches; on bounds planes {} rays, {} hits, {} mismatches\n",
+        label,
+        comparison.ray_count, comparison.hit_count, comparison.mismatch_count,
+        plane_comparison.ray_count, plane_comparison.hit_count, plane_comparison.mismatch_count
+    );
+    check(comparison.hit_count > 0,             "orthographic rays: rays hit geometry");
+    check(comparison.mismatch_count == 0,       "orthographic rays: BVH hits match brute force");
+    check(plane_comparison.mismatch_count == 0, "orthographic rays on bounds planes: BVH hits match brute force");
+    if (expect_plane_hits) {
+        check(plane_comparison.hit_count > 0,   "orthographic rays on bounds planes: rays hit geometry edges");
+    }
+}
+
+void test_geometry(const Geometry& geometry, const char* label, const bool expect_plane_hits)
+{
+    const editor::Geometry_bvh bvh{geometry};
+    test_random_rays      (geometry, bvh, label);
+    test_orthographic_rays(geometry, bvh, label, expect_plane_hits);
+
+    // Empty geometry builds empty BVH that hits nothing
+    const Geometry             empty_geometry{"empty"};
+    const editor::Geometry_bvh empty_bvh{empty_geometry};
+    check(empty_bvh.intersect(vec3{0.0f, 0.0f, 5.0f}, vec3{0.0f, 0.0f, -1.0f}).triangle == nullptr, "empty geometry: no hit");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::geometry::initialize_logging();
+
+    // Box faces span whole bounding box, so rays on box planes graze face edges
+    test_geometry(erhe::geometry::shapes::make_box(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f), "box",    true);
+    test_geometry(erhe::geometry::shapes::make_sphere(1.0, 24, 12),                       "sphere", false);
+    test_geometry(erhe::geometry::shapes::make_torus(1.0, 0.35, 32, 16),                  "torus",  false);
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("geometry BVH tests passed\n");
+    return EXIT_SUCCESS;
+}
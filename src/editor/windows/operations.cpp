@@ -1,6 +1,7 @@
 #include "windows/operations.hpp"
 
 #include "editor_context.hpp"
+#include "operations/operation_progress.hpp"
 #include "operations/operation_stack.hpp"
 #include "operations/geometry_operations.hpp"
 #include "operations/merge_operation.hpp"
@@ -10,6 +11,7 @@
 #include "tools/selection_tool.hpp"
 
 #include "erhe_commands/commands.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_imgui/imgui_helpers.hpp"
 #include "erhe_imgui/imgui_renderer.hpp"
 #include "erhe_imgui/imgui_windows.hpp"
@@ -21,7 +23,6 @@
 #   include <imgui/imgui.h>
 #endif
 
-#include <taskflow/taskflow.hpp>  // Taskflow is header-only
 
 namespace editor {
 
@@ -86,7 +87,7 @@ Operations::Operations(
     commands.bind_command_to_menu(&m_gyro_command    , "Geometry.Conway Operations.Gyro");
 }
 
-auto Operations::mesh_context() -> Mesh_operation_parameters
+auto Operations::mesh_context(const std::shared_ptr<Operation_progress>& progress) -> Mesh_operation_parameters
 {
     return Mesh_operation_parameters{
         .context = m_context,
@@ -98,10 +99,29 @@ auto Operations::mesh_context() -> Mesh_operation_parameters
                 .centroid_points = true
             },
             .buffer_info     = m_context.mesh_memory->buffer_info
-        }
+        },
+        .progress = progress
     };
 }
 
+template <typename T>
+void Operations::queue_mesh_operation(const char* const label)
+{
+    erhe::concurrency::Thread_pool& thread_pool = m_context.operation_stack->get_thread_pool();
+    std::shared_ptr<Operation_progress> progress = m_context.operation_stack->make_progress(label);
+    thread_pool.enqueue(
+        [this, progress](){
+            auto operation = std::make_shared<T>(mesh_context(progress));
+            if (!operation->is_cancelled() && operation->has_entries()) {
+                // Cancel remains possible until operation is executed
+                m_context.operation_stack->queue(operation, progress);
+            } else {
+                progress->set_done();
+            }
+        }
+    );
+}
+
 // Special rule to count meshes as selected even when the node that
 // contains the mesh is seletected and mesh itself is not selected.
 auto Operations::count_selected_meshes() const -> size_t
@@ -299,8 +319,8 @@ void Operations::imgui()
 
 void Operations::merge()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async(
+    erhe::concurrency::Thread_pool& thread_pool = m_context.operation_stack->get_thread_pool();
+    thread_pool.enqueue(
         [this](){
             m_context.operation_stack->queue(
                 std::make_shared<Merge_operation>(
@@ -324,80 +344,67 @@ void Operations::merge()
 
 void Operations::triangulate()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){ m_context.operation_stack->queue(std::make_shared<Triangulate_operation>( mesh_context()));});
+    queue_mesh_operation<Triangulate_operation>("Triangulate");
 }
 
 void Operations::normalize()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){ m_context.operation_stack->queue(std::make_shared<Normalize_operation>(mesh_context()));});
+    queue_mesh_operation<Normalize_operation>("Normalize");
 }
 
 void Operations::reverse()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Reverse_operation>(mesh_context()));});
+    queue_mesh_operation<Reverse_operation>("Reverse");
 }
 
 void Operations::catmull_clark()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Catmull_clark_subdivision_operation>(mesh_context()));});
+    queue_mesh_operation<Catmull_clark_subdivision_operation>("Catmull-Clark");
 }
 
 void Operations::sqrt3()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Sqrt3_subdivision_operation>(mesh_context()));});
+    queue_mesh_operation<Sqrt3_subdivision_operation>("Sqrt3");
 }
 
 void Operations::dual()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Dual_operation>(mesh_context()));});
+    queue_mesh_operation<Dual_operation>("Dual");
 }
 
 void Operations::join()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Join_operation>(mesh_context()));});
+    queue_mesh_operation<Join_operation>("Join");
 }
 
 void Operations::kis()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Kis_operation>(mesh_context()));});
+    queue_mesh_operation<Kis_operation>("Kis");
 }
 
 void Operations::meta()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Meta_operation>(mesh_context()));});
+    queue_mesh_operation<Meta_operation>("Meta");
 }
 
 void Operations::ortho()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Subdivide_operation>(mesh_context()));});
+    queue_mesh_operation<Subdivide_operation>("Ortho");
 }
 
 void Operations::ambo()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Ambo_operation>(mesh_context()));});
+    queue_mesh_operation<Ambo_operation>("Ambo");
 }
 
 void Operations::truncate()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Truncate_operation>(mesh_context()));});
+    queue_mesh_operation<Truncate_operation>("Truncate");
 }
 
 void Operations::gyro()
 {
-    tf::Executor& executor = m_context.operation_stack->get_executor();
-    executor.silent_async([this](){m_context.operation_stack->queue(std::make_shared<Gyro_operation>(mesh_context()));});
+    queue_mesh_operation<Gyro_operation>("Gyro");
 }
 
 } // namespace editor
@@ -60,6 +60,7 @@ struct Tool_slot
 };
 
 class Editor_context;
+class Operation_progress;
 
 class Operations : public erhe::imgui::Imgui_window
 {
@@ -95,7 +96,11 @@ public:
 
 private:
     [[nodiscard]] auto count_selected_meshes() const -> size_t;
-    [[nodiscard]] auto mesh_context() -> Mesh_operation_parameters;
+    [[nodiscard]] auto mesh_context(const std::shared_ptr<Operation_progress>& progress = {}) -> Mesh_operation_parameters;
+
+    // Constructs Mesh_operation on executor, reporting progress to operation stack
+    template <typename T>
+    void queue_mesh_operation(const char* label);
 
     Editor_context& m_context;
 
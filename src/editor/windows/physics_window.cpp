@@ -10,6 +10,7 @@
 #include "erhe_imgui/imgui_helpers.hpp"
 #include "erhe_imgui/imgui_windows.hpp"
 #include "erhe_physics/iworld.hpp"
+#include "erhe_physics/simulation_thread.hpp"
 #include "erhe_profile/profile.hpp"
 
 #if defined(ERHE_GUI_LIBRARY_IMGUI)
@@ -63,6 +64,14 @@ void Physics_window::imgui()
         return;
     }
 
+    const erhe::physics::Simulation_thread* simulation_thread = m_context.editor_scenes->get_simulation_thread();
+    if (simulation_thread != nullptr) {
+        const erhe::physics::Simulation_thread_statistics statistics = simulation_thread->get_statistics();
+        ImGui::Text("Simulation thread steps: %llu", static_cast<unsigned long long>(statistics.step_count));
+        ImGui::Text("Dropped steps: %llu",           static_cast<unsigned long long>(statistics.dropped_step_count));
+        ImGui::Text("Step time: %.2f ms (max %.2f ms)", statistics.last_step_time_ms, statistics.max_step_time_ms);
+    }
+
     const auto& scene_roots = m_context.editor_scenes->get_scene_roots();
     for (const auto& scene_root : scene_roots) {
         if (!ImGui::TreeNodeEx(scene_root->get_name().c_str())) {
@@ -374,6 +374,10 @@ void Properties::buffer_mesh_properties(const char* label, const erhe::primitive
     ImGui::Text("Edge Lines: %zu",      buffer_mesh->edge_line_indices.get_line_count());
     ImGui::Text("Corner Points: %zu",   buffer_mesh->corner_point_indices.get_point_count());
     ImGui::Text("Centroid Points: %zu", buffer_mesh->polygon_centroid_indices.get_point_count());
+    for (std::size_t i = 0, end = buffer_mesh->triangle_fill_lods.size(); i < end; ++i) {
+        const erhe::primitive::Buffer_mesh_lod& lod = buffer_mesh->triangle_fill_lods[i];
+        ImGui::Text("LOD %zu Fill Triangles: %zu, Error: %f", i + 1, lod.triangle_fill_indices.get_triangle_count(), lod.error);
+    }
 
     ImGui::Text("Vertices: %zu",     buffer_mesh->vertex_buffer_range.count);
     ImGui::Text("Indices: %zu",      buffer_mesh->index_buffer_range.count);
@@ -0,0 +1,56 @@
+#include "erhe_concurrency/concurrent_queue.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <thread>
+
+namespace erhe::concurrency {
+
+Concurrent_queue::Concurrent_queue(const std::size_t capacity)
+    : m_queue   {capacity}
+    , m_capacity{capacity}
+{
+    ERHE_VERIFY(capacity > 0);
+}
+
+Concurrent_queue::~Concurrent_queue() noexcept = default;
+
+auto Concurrent_queue::try_enqueue(Task&& task) -> bool
+{
+    // Reserve slot first; back off if that overshoots capacity
+    const std::size_t old_size = m_size.fetch_add(1, std::memory_order_acq_rel);
+    if (old_size >= m_capacity) {
+        m_size.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+    const bool ok = m_queue.enqueue(std::move(task));
+    ERHE_VERIFY(ok);
+    return true;
+}
+
+void Concurrent_queue::enqueue(Task&& task)
+{
+    while (!try_enqueue(std::move(task))) {
+        std::this_thread::yield();
+    }
+}
+
+auto Concurrent_queue::try_dequeue(Task& task) -> bool
+{
+    if (!m_queue.try_dequeue(task)) {
+        return false;
+    }
+    m_size.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+auto Concurrent_queue::size_approx() const -> std::size_t
+{
+    return m_size.load(std::memory_order_relaxed);
+}
+
+auto Concurrent_queue::get_capacity() const -> std::size_t
+{
+    return m_capacity;
+}
+
+} // namespace erhe::concurrency
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "concurrentqueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace erhe::concurrency {
+
+using Task = std::function<void()>;
+
+// Bounded multi-producer multi-consumer task queue.
+//
+// Storage is moodycamel::ConcurrentQueue, which itself is unbounded.
+// Capacity is enforced by reserving a slot before enqueueing, so
+// producers never grow the queue past the given capacity.
+class Concurrent_queue
+{
+public:
+    static constexpr std::size_t c_default_capacity = 64 * 1024;
+
+    explicit Concurrent_queue(std::size_t capacity = c_default_capacity);
+    ~Concurrent_queue() noexcept;
+
+    Concurrent_queue(const Concurrent_queue&) = delete;
+    auto operator=  (const Concurrent_queue&) = delete;
+    Concurrent_queue(Concurrent_queue&&)      = delete;
+    auto operator=  (Concurrent_queue&&)      = delete;
+
+    // Returns false if the queue is full. In that case task is left untouched.
+    [[nodiscard]] auto try_enqueue(Task&& task) -> bool;
+
+    // Blocks (yielding) until there is room in the queue.
+    void enqueue(Task&& task);
+
+    [[nodiscard]] auto try_dequeue (Task& task) -> bool;
+    [[nodiscard]] auto size_approx () const -> std::size_t;
+    [[nodiscard]] auto get_capacity() const -> std::size_t;
+
+private:
+    moodycamel::ConcurrentQueue<Task> m_queue;
+    std::atomic<std::size_t>          m_size{0};
+    std::size_t                       m_capacity;
+};
+
+} // namespace erhe::concurrency
@@ -0,0 +1,77 @@
+#include "erhe_concurrency/serial_queue.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+
+#include <chrono>
+
+namespace erhe::concurrency {
+
+Serial_queue::Serial_queue(Thread_pool& thread_pool)
+    : m_thread_pool{thread_pool}
+{
+}
+
+Serial_queue::~Serial_queue() noexcept
+{
+    wait();
+}
+
+void Serial_queue::enqueue(Task&& task)
+{
+    bool start_draining = false;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_tasks.push_back(std::move(task));
+        if (!m_draining) {
+            m_draining     = true;
+            start_draining = true;
+        }
+    }
+    if (start_draining) {
+        m_thread_pool.enqueue([this]() { drain(); });
+    }
+}
+
+void Serial_queue::cancel()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_tasks.clear();
+}
+
+void Serial_queue::drain()
+{
+    // Run a bounded batch, then yield the worker back to the pool
+    for (std::size_t i = 0; i < c_drain_batch_size; ++i) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (m_tasks.empty()) {
+                m_draining = false;
+                m_idle_condition.notify_all();
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+    m_thread_pool.enqueue([this]() { drain(); });
+}
+
+void Serial_queue::wait()
+{
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (!m_draining) {
+                return;
+            }
+        }
+        // Help the pool so that waiting from a worker thread cannot deadlock
+        if (!m_thread_pool.try_run_pending_task()) {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_idle_condition.wait_for(lock, std::chrono::milliseconds{1}, [this]() { return !m_draining; });
+        }
+    }
+}
+
+} // namespace erhe::concurrency
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "erhe_concurrency/concurrent_queue.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace erhe::concurrency {
+
+class Thread_pool;
+
+// Executes tasks one at a time, in submission order, on a Thread_pool.
+// At most one pool task is used for draining the queue at any time.
+class Serial_queue
+{
+public:
+    explicit Serial_queue(Thread_pool& thread_pool);
+    ~Serial_queue() noexcept;
+
+    Serial_queue  (const Serial_queue&) = delete;
+    auto operator=(const Serial_queue&) = delete;
+    Serial_queue  (Serial_queue&&)      = delete;
+    auto operator=(Serial_queue&&)      = delete;
+
+    void enqueue(Task&& task);
+
+    // Drops tasks that have not been started yet
+    void cancel();
+
+    // Blocks until all enqueued tasks have completed
+    void wait();
+
+private:
+    static constexpr std::size_t c_drain_batch_size = 16;
+
+    void drain();
+
+    Thread_pool&            m_thread_pool;
+    std::mutex              m_mutex;
+    std::condition_variable m_idle_condition;
+    std::deque<Task>        m_tasks;
+    bool                    m_draining{false};
+};
+
+} // namespace erhe::concurrency
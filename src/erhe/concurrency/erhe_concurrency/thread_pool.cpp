@@ -0,0 +1,265 @@
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+namespace erhe::concurrency {
+
+namespace {
+
+thread_local const Thread_pool* t_thread_pool {nullptr};
+thread_local std::size_t        t_worker_index{Thread_pool::c_not_a_worker};
+
+}
+
+Task_group::Task_group(Thread_pool& thread_pool)
+    : m_thread_pool{thread_pool}
+{
+}
+
+Task_group::~Task_group() noexcept
+{
+    // Exceptions not collected by wait() are dropped here
+    wait_pending();
+}
+
+void Task_group::run(Task&& task)
+{
+    m_pending.fetch_add(1, std::memory_order_acq_rel);
+    m_thread_pool.enqueue(
+        [this, task = std::move(task)]() {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{m_exception_mutex};
+                if (!m_exception) {
+                    m_exception = std::current_exception();
+                }
+            }
+            m_pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    );
+}
+
+void Task_group::wait_pending()
+{
+    while (m_pending.load(std::memory_order_acquire) > 0) {
+        if (!m_thread_pool.try_run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Task_group::wait()
+{
+    wait_pending();
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock{m_exception_mutex};
+        std::swap(exception, m_exception);
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+auto Task_group::get_thread_pool() -> Thread_pool&
+{
+    return m_thread_pool;
+}
+
+auto Thread_pool::get_instance() -> Thread_pool&
+{
+    static Thread_pool static_instance;
+    return static_instance;
+}
+
+Thread_pool::Thread_pool(std::size_t thread_count)
+{
+    if (thread_count == 0) {
+        const unsigned int hardware_thread_count = std::thread::hardware_concurrency();
+        thread_count = (hardware_thread_count > 1) ? hardware_thread_count - 1 : 1;
+    }
+
+    m_workers.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    // Start threads only after all workers exist, they may steal from each other right away
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        m_workers[i]->thread = std::thread{&Thread_pool::worker_main, this, i};
+    }
+}
+
+Thread_pool::~Thread_pool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{m_sleep_mutex};
+        m_stop.store(true, std::memory_order_release);
+    }
+    m_sleep_condition.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+auto Thread_pool::get_thread_count() const -> std::size_t
+{
+    return m_workers.size();
+}
+
+auto Thread_pool::get_worker_index() const -> std::size_t
+{
+    return (t_thread_pool == this) ? t_worker_index : c_not_a_worker;
+}
+
+auto Thread_pool::is_worker_thread() const -> bool
+{
+    return t_thread_pool == this;
+}
+
+void Thread_pool::enqueue(Task&& task)
+{
+    m_active_count.fetch_add(1, std::memory_order_acq_rel);
+    m_queued_count.fetch_add(1, std::memory_order_seq_cst);
+
+    const std::size_t worker_index = get_worker_index();
+    if (worker_index != c_not_a_worker) {
+        Worker& worker = *m_workers[worker_index].get();
+        std::lock_guard<std::mutex> lock{worker.mutex};
+        worker.tasks.push_back(std::move(task));
+    } else if (!m_injection_queue.try_enqueue(std::move(task))) {
+        // Injection queue is full - apply back pressure by running inline
+        m_queued_count.fetch_sub(1, std::memory_order_seq_cst);
+        run_task(task);
+        return;
+    }
+
+    wake_worker();
+}
+
+void Thread_pool::wake_worker()
+{
+    if (m_sleeping_count.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_sleep_mutex};
+    }
+    m_sleep_condition.notify_one();
+}
+
+void Thread_pool::run_task(Task& task)
+{
+    task();
+    task = nullptr;
+    m_active_count.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+auto Thread_pool::pop_local_task(const std::size_t worker_index, Task& task) -> bool
+{
+    Worker& worker = *m_workers[worker_index].get();
+    std::lock_guard<std::mutex> lock{worker.mutex};
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+auto Thread_pool::steal_task(const std::size_t thief_index, Task& task) -> bool
+{
+    const std::size_t worker_count = m_workers.size();
+    const std::size_t start        = (thief_index == c_not_a_worker) ? 0 : thief_index + 1;
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        const std::size_t victim_index = (start + i) % worker_count;
+        if (victim_index == thief_index) {
+            continue;
+        }
+        Worker& victim = *m_workers[victim_index].get();
+        std::unique_lock<std::mutex> lock{victim.mutex, std::try_to_lock};
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+auto Thread_pool::find_task(const std::size_t worker_index, Task& task) -> bool
+{
+    const bool found =
+        ((worker_index != c_not_a_worker) && pop_local_task(worker_index, task)) ||
+        m_injection_queue.try_dequeue(task) ||
+        steal_task(worker_index, task);
+    if (found) {
+        m_queued_count.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    return found;
+}
+
+auto Thread_pool::try_run_pending_task() -> bool
+{
+    Task task;
+    if (!find_task(get_worker_index(), task)) {
+        return false;
+    }
+    run_task(task);
+    return true;
+}
+
+void Thread_pool::wait_idle()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // A worker waiting here would wait for its own running task
+    ERHE_VERIFY(!is_worker_thread());
+
+    while (m_active_count.load(std::memory_order_acquire) > 0) {
+        if (!try_run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Thread_pool::worker_main(const std::size_t worker_index)
+{
+    t_thread_pool  = this;
+    t_worker_index = worker_index;
+
+    Task task;
+    for (;;) {
+        if (find_task(worker_index, task)) {
+            run_task(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{m_sleep_mutex};
+        m_sleeping_count.fetch_add(1, std::memory_order_seq_cst);
+        m_sleep_condition.wait(
+            lock,
+            [this]() {
+                return
+                    m_stop.load(std::memory_order_acquire) ||
+                    (m_queued_count.load(std::memory_order_seq_cst) > 0);
+            }
+        );
+        m_sleeping_count.fetch_sub(1, std::memory_order_seq_cst);
+        if (
+            m_stop.load(std::memory_order_acquire) &&
+            (m_queued_count.load(std::memory_order_seq_cst) == 0)
+        ) {
+            break;
+        }
+    }
+
+    t_thread_pool  = nullptr;
+    t_worker_index = c_not_a_worker;
+}
+
+} // namespace erhe::concurrency
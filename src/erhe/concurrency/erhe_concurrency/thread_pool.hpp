@@ -0,0 +1,144 @@
+#pragma once
+
+#include "erhe_concurrency/concurrent_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace erhe::concurrency {
+
+class Thread_pool;
+
+// Tracks completion of a set of tasks submitted to a Thread_pool.
+// wait() executes pending pool tasks while waiting, so it is safe
+// to use from within worker threads (nested parallelism).
+// If tasks throw, the first exception is rethrown from wait().
+class Task_group
+{
+public:
+    explicit Task_group(Thread_pool& thread_pool);
+    ~Task_group() noexcept;
+
+    Task_group    (const Task_group&) = delete;
+    auto operator=(const Task_group&) = delete;
+    Task_group    (Task_group&&)      = delete;
+    auto operator=(Task_group&&)      = delete;
+
+    void run (Task&& task);
+    void wait();
+
+    [[nodiscard]] auto get_thread_pool() -> Thread_pool&;
+
+private:
+    void wait_pending();
+
+    Thread_pool&             m_thread_pool;
+    std::atomic<std::size_t> m_pending{0};
+    std::mutex               m_exception_mutex;
+    std::exception_ptr       m_exception;
+};
+
+// Work-stealing thread pool.
+//
+// Each worker owns a deque. Tasks submitted from a worker are pushed to the
+// back of its own deque and popped from the back (LIFO, cache friendly).
+// Idle workers steal from the front of other workers' deques. Tasks submitted
+// from non-worker threads go through a shared bounded injection queue; when
+// that is full the task is executed inline on the submitting thread.
+class Thread_pool
+{
+public:
+    static constexpr std::size_t c_not_a_worker = std::numeric_limits<std::size_t>::max();
+
+    // thread_count 0 uses std::thread::hardware_concurrency() - 1 (at least one)
+    explicit Thread_pool(std::size_t thread_count = 0);
+    ~Thread_pool() noexcept;
+
+    Thread_pool   (const Thread_pool&) = delete;
+    auto operator=(const Thread_pool&) = delete;
+    Thread_pool   (Thread_pool&&)      = delete;
+    auto operator=(Thread_pool&&)      = delete;
+
+    // Engine-wide shared pool
+    [[nodiscard]] static auto get_instance() -> Thread_pool&;
+
+    void enqueue(Task&& task);
+
+    // Executes one queued task on the calling thread.
+    // Returns false if no task was available.
+    auto try_run_pending_task() -> bool;
+
+    // Helps executing tasks until all submitted tasks have completed.
+    void wait_idle();
+
+    [[nodiscard]] auto get_thread_count() const -> std::size_t;
+    [[nodiscard]] auto get_worker_index() const -> std::size_t;
+    [[nodiscard]] auto is_worker_thread() const -> bool;
+
+    // Calls function(range_begin, range_end) for sub ranges of [begin, end).
+    // The calling thread participates; returns when all ranges are done.
+    template <typename Function>
+    void parallel_for(const std::size_t begin, const std::size_t end, Function&& function, std::size_t grain_size = 0)
+    {
+        if (end <= begin) {
+            return;
+        }
+        const std::size_t count = end - begin;
+        if (grain_size == 0) {
+            grain_size = std::max(std::size_t{1}, count / (4 * (get_thread_count() + 1)));
+        }
+        if (count <= grain_size) {
+            function(begin, end);
+            return;
+        }
+
+        Task_group task_group{*this};
+        for (std::size_t range_begin = begin + grain_size; range_begin < end; range_begin += grain_size) {
+            const std::size_t range_end = std::min(end, range_begin + grain_size);
+            task_group.run(
+                [&function, range_begin, range_end]() {
+                    function(range_begin, range_end);
+                }
+            );
+        }
+        function(begin, begin + grain_size);
+        task_group.wait();
+    }
+
+private:
+    class Worker
+    {
+    public:
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+        std::thread      thread;
+    };
+
+    void worker_main   (std::size_t worker_index);
+    auto pop_local_task(std::size_t worker_index, Task& task) -> bool;
+    auto steal_task    (std::size_t thief_index, Task& task) -> bool;
+    auto find_task     (std::size_t worker_index, Task& task) -> bool;
+    void run_task      (Task& task);
+    void wake_worker   ();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    Concurrent_queue                     m_injection_queue;
+    std::mutex                           m_sleep_mutex;
+    std::condition_variable              m_sleep_condition;
+    std::atomic<std::size_t>             m_sleeping_count{0};
+    std::atomic<std::size_t>             m_queued_count  {0}; // submitted, not yet started
+    std::atomic<std::size_t>             m_active_count  {0}; // submitted, not yet completed
+    std::atomic<bool>                    m_stop          {false};
+};
+
+} // namespace erhe::concurrency
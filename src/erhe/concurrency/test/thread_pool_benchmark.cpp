@@ -0,0 +1,167 @@
+// Micro-benchmark for erhe::concurrency::Thread_pool
+//
+// Measures task throughput for external submission, nested submission from
+// workers and parallel_for, and the latency from enqueue() to task start.
+
+#include "erhe_concurrency/serial_queue.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report_throughput(const char* label, const std::size_t task_count, const double seconds)
+{
+    fmt::print(
+        "{:<28} {:>10} tasks {:>9.3f} ms {:>8.2f} M tasks/s\n",
+        label, task_count, seconds * 1000.0, static_cast<double>(task_count) / seconds / 1.0e6
+    );
+}
+
+void benchmark_external_submit(erhe::concurrency::Thread_pool& thread_pool, const std::size_t task_count)
+{
+    std::atomic<std::size_t> counter{0};
+    const auto start = Clock::now();
+    {
+        erhe::concurrency::Task_group task_group{thread_pool};
+        for (std::size_t i = 0; i < task_count; ++i) {
+            task_group.run([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+        }
+        task_group.wait();
+    }
+    const double seconds = seconds_since(start);
+    if (counter.load() != task_count) {
+        fmt::print(stderr, "external submit: expected {} tasks, got {}\n", task_count, counter.load());
+        std::exit(EXIT_FAILURE);
+    }
+    report_throughput("external submit", task_count, seconds);
+}
+
+void benchmark_nested_submit(erhe::concurrency::Thread_pool& thread_pool, const std::size_t task_count)
+{
+    const std::size_t        outer_count = std::max(std::size_t{1}, thread_pool.get_thread_count() * 4);
+    const std::size_t        inner_count = task_count / outer_count;
+    std::atomic<std::size_t> counter{0};
+    const auto start = Clock::now();
+    {
+        erhe::concurrency::Task_group outer_group{thread_pool};
+        for (std::size_t i = 0; i < outer_count; ++i) {
+            outer_group.run(
+                [&thread_pool, &counter, inner_count]() {
+                    erhe::concurrency::Task_group inner_group{thread_pool};
+                    for (std::size_t j = 0; j < inner_count; ++j) {
+                        inner_group.run([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+                    }
+                    inner_group.wait();
+                }
+            );
+        }
+        outer_group.wait();
+    }
+    report_throughput("nested submit (stealing)", outer_count * inner_count, seconds_since(start));
+}
+
+void benchmark_parallel_for(erhe::concurrency::Thread_pool& thread_pool, const std::size_t element_count)
+{
+    std::vector<float> values(element_count, 1.0f);
+    const auto start = Clock::now();
+    thread_pool.parallel_for(
+        0, element_count,
+        [&values](const std::size_t range_begin, const std::size_t range_end) {
+            for (std::size_t i = range_begin; i < range_end; ++i) {
+                values[i] = values[i] * 2.0f + 1.0f;
+            }
+        },
+        1024
+    );
+    const double seconds = seconds_since(start);
+    fmt::print(
+        "{:<28} {:>10} items {:>9.3f} ms {:>8.2f} G items/s\n",
+        "parallel_for", element_count, seconds * 1000.0, static_cast<double>(element_count) / seconds / 1.0e9
+    );
+}
+
+void benchmark_serial_queue(erhe::concurrency::Thread_pool& thread_pool, const std::size_t task_count)
+{
+    erhe::concurrency::Serial_queue serial_queue{thread_pool};
+    std::size_t next_expected{0};
+    bool        in_order{true};
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < task_count; ++i) {
+        serial_queue.enqueue(
+            [&next_expected, &in_order, i]() {
+                in_order = in_order && (next_expected == i);
+                ++next_expected;
+            }
+        );
+    }
+    serial_queue.wait();
+    const double seconds = seconds_since(start);
+    if (!in_order || (next_expected != task_count)) {
+        fmt::print(stderr, "serial queue: tasks ran out of order\n");
+        std::exit(EXIT_FAILURE);
+    }
+    report_throughput("serial queue", task_count, seconds);
+}
+
+void benchmark_latency(erhe::concurrency::Thread_pool& thread_pool, const std::size_t sample_count)
+{
+    std::vector<double> latencies_us;
+    latencies_us.reserve(sample_count);
+    for (std::size_t i = 0; i < sample_count; ++i) {
+        // Spin instead of Task_group::wait() so that a worker, not this thread, picks up the task
+        std::atomic<int64_t> start_ns{-1};
+        const auto enqueue_time = Clock::now();
+        thread_pool.enqueue(
+            [&start_ns, enqueue_time]() {
+                start_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - enqueue_time).count());
+            }
+        );
+        while (start_ns.load() < 0) {
+            std::this_thread::yield();
+        }
+        latencies_us.push_back(static_cast<double>(start_ns.load()) / 1000.0);
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    const auto percentile = [&latencies_us](const double p) -> double {
+        const std::size_t index = std::min(latencies_us.size() - 1, static_cast<std::size_t>(p * static_cast<double>(latencies_us.size())));
+        return latencies_us[index];
+    };
+    fmt::print(
+        "{:<28} {:>10} samples p50 {:.2f} us p90 {:.2f} us p99 {:.2f} us max {:.2f} us\n",
+        "enqueue to start latency", sample_count, percentile(0.50), percentile(0.90), percentile(0.99), latencies_us.back()
+    );
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t task_count = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 1'000'000;
+
+    erhe::concurrency::Thread_pool& thread_pool = erhe::concurrency::Thread_pool::get_instance();
+    fmt::print("Thread_pool with {} worker threads\n", thread_pool.get_thread_count());
+
+    benchmark_external_submit(thread_pool, task_count);
+    benchmark_nested_submit  (thread_pool, task_count);
+    benchmark_parallel_for   (thread_pool, task_count * 16);
+    benchmark_serial_queue   (thread_pool, task_count / 10);
+    benchmark_latency        (thread_pool, 10'000);
+    return EXIT_SUCCESS;
+}
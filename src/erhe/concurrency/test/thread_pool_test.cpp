@@ -0,0 +1,122 @@
+// Functional tests for erhe::concurrency::Thread_pool and Task_group
+
+#include "erhe_concurrency/thread_pool.hpp"
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+void test_task_group_runs_all_tasks(erhe::concurrency::Thread_pool& thread_pool)
+{
+    std::atomic<int> counter{0};
+    erhe::concurrency::Task_group task_group{thread_pool};
+    for (int i = 0; i < 10000; ++i) {
+        task_group.run([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    }
+    task_group.wait();
+    check(counter.load() == 10000, "Task_group::wait() returns after all tasks completed");
+}
+
+void test_task_group_rethrows(erhe::concurrency::Thread_pool& thread_pool)
+{
+    std::atomic<int> counter{0};
+    bool caught{false};
+    erhe::concurrency::Task_group task_group{thread_pool};
+    for (int i = 0; i < 100; ++i) {
+        task_group.run(
+            [&counter, i]() {
+                counter.fetch_add(1, std::memory_order_relaxed);
+                if ((i % 10) == 3) {
+                    throw std::runtime_error{"task failure"};
+                }
+            }
+        );
+    }
+    try {
+        task_group.wait();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    check(caught,                "Task_group::wait() rethrows task exception");
+    check(counter.load() == 100, "Throwing tasks do not prevent other tasks from running");
+
+    // Exception is consumed by the first wait()
+    task_group.run([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    bool caught_again{false};
+    try {
+        task_group.wait();
+    } catch (...) {
+        caught_again = true;
+    }
+    check(!caught_again,         "Task_group exception is only rethrown once");
+    check(counter.load() == 101, "Task_group is reusable after exception");
+}
+
+void test_task_group_destructor_with_exception(erhe::concurrency::Thread_pool& thread_pool)
+{
+    std::atomic<int> counter{0};
+    {
+        erhe::concurrency::Task_group task_group{thread_pool};
+        task_group.run([]() { throw std::runtime_error{"dropped"}; });
+        task_group.run([&counter]() { counter.fetch_add(1); });
+    }
+    check(counter.load() == 1, "Task_group destructor waits without rethrowing");
+}
+
+void test_parallel_for_nested(erhe::concurrency::Thread_pool& thread_pool)
+{
+    std::vector<int> values(4096, 0);
+    thread_pool.parallel_for(
+        0, 64,
+        [&thread_pool, &values](const std::size_t outer_begin, const std::size_t outer_end) {
+            for (std::size_t outer = outer_begin; outer < outer_end; ++outer) {
+                thread_pool.parallel_for(
+                    outer * 64, (outer + 1) * 64,
+                    [&values](const std::size_t begin, const std::size_t end) {
+                        for (std::size_t i = begin; i < end; ++i) {
+                            values[i] += 1;
+                        }
+                    },
+                    8
+                );
+            }
+        },
+        1
+    );
+    check(std::accumulate(values.begin(), values.end(), 0) == 4096, "Nested parallel_for visits each element once");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::concurrency::Thread_pool thread_pool{4};
+
+    test_task_group_runs_all_tasks          (thread_pool);
+    test_task_group_rethrows                (thread_pool);
+    test_task_group_destructor_with_exception(thread_pool);
+    test_parallel_for_nested                (thread_pool);
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("All thread pool tests passed\n");
+    return EXIT_SUCCESS;
+}
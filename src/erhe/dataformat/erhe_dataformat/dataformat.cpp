@@ -1,6 +1,7 @@
 #include "erhe_dataformat/dataformat.hpp"
 #include "erhe_verify/verify.hpp"
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <limits>
 
@@ -74,6 +75,106 @@ float unorm8_to_float(uint8_t v)
     return static_cast<float>(v) / 255.0f;
 }
 
+uint16_t float_to_half(float v)
+{
+    uint32_t f;
+    memcpy(&f, &v, sizeof(float));
+    const uint16_t sign     = static_cast<uint16_t>((f >> 16) & 0x8000u);
+    const uint32_t exponent = (f >> 23) & 0xffu;
+    uint32_t       mantissa = f & 0x7fffffu;
+    if (exponent == 0xffu) { // Inf, NaN
+        return static_cast<uint16_t>(sign | 0x7c00u | ((mantissa != 0) ? (0x0200u | (mantissa >> 13)) : 0u));
+    }
+    const int e = static_cast<int>(exponent) - 127 + 15;
+    if (e >= 0x1f) { // Overflow to Inf
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    if (e <= 0) { // Subnormal or zero
+        if (e < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000u;
+        const uint32_t shift     = static_cast<uint32_t>(14 - e);
+        uint32_t       half      = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        const uint32_t halfway   = 1u << (shift - 1u);
+        if ((remainder > halfway) || ((remainder == halfway) && ((half & 1u) != 0))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    // Round to nearest even, carry may propagate into exponent
+    uint32_t       half      = (static_cast<uint32_t>(e) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1fffu;
+    if ((remainder > 0x1000u) || ((remainder == 0x1000u) && ((half & 1u) != 0))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float half_to_float(uint16_t v)
+{
+    const uint32_t sign     = static_cast<uint32_t>(v & 0x8000u) << 16;
+    const uint32_t exponent = (v >> 10) & 0x1fu;
+    const uint32_t mantissa = v & 0x3ffu;
+    uint32_t f;
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return (sign != 0) ? -magnitude : magnitude;
+    } else if (exponent == 0x1fu) {
+        f = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        f = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+    float result;
+    memcpy(&result, &f, sizeof(float));
+    return result;
+}
+
+namespace {
+
+[[nodiscard]] auto sign_not_zero(float v) -> float
+{
+    return (v >= 0.0f) ? 1.0f : -1.0f;
+}
+
+}
+
+void encode_octahedral(float x, float y, float z, float& u, float& v)
+{
+    const float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+    if (l1 == 0.0f) {
+        u = 0.0f;
+        v = 0.0f;
+        return;
+    }
+    const float px = x / l1;
+    const float py = y / l1;
+    if (z >= 0.0f) {
+        u = px;
+        v = py;
+    } else {
+        u = (1.0f - std::abs(py)) * sign_not_zero(px);
+        v = (1.0f - std::abs(px)) * sign_not_zero(py);
+    }
+}
+
+void decode_octahedral(float u, float v, float& x, float& y, float& z)
+{
+    z = 1.0f - std::abs(u) - std::abs(v);
+    if (z >= 0.0f) {
+        x = u;
+        y = v;
+    } else {
+        x = (1.0f - std::abs(v)) * sign_not_zero(u);
+        y = (1.0f - std::abs(u)) * sign_not_zero(v);
+    }
+    const float length = std::sqrt(x * x + y * y + z * z);
+    x /= length;
+    y /= length;
+    z /= length;
+}
+
 auto c_str(Format format) -> const char*
 {
     switch (format) {
@@ -125,6 +226,10 @@ auto c_str(Format format) -> const char*
         case Format::format_16_vec4_sscaled:          return "format_16_vec4_sscaled";
         case Format::format_16_vec4_uint:             return "format_16_vec4_uint";
         case Format::format_16_vec4_sint:             return "format_16_vec4_sint";
+        case Format::format_16_scalar_float:          return "format_16_scalar_float";
+        case Format::format_16_vec2_float:            return "format_16_vec2_float";
+        case Format::format_16_vec3_float:            return "format_16_vec3_float";
+        case Format::format_16_vec4_float:            return "format_16_vec4_float";
         case Format::format_32_scalar_unorm:          return "format_32_scalar_unorm";
         case Format::format_32_scalar_snorm:          return "format_32_scalar_snorm";
         case Format::format_32_scalar_uscaled:        return "format_32_scalar_uscaled";
@@ -212,6 +317,10 @@ auto get_format_kind(Format format) -> Format_kind
         case Format::format_16_vec4_sscaled:          return Format_kind::format_kind_float;
         case Format::format_16_vec4_uint:             return Format_kind::format_kind_unsigned_integer;
         case Format::format_16_vec4_sint:             return Format_kind::format_kind_signed_integer;
+        case Format::format_16_scalar_float:          return Format_kind::format_kind_float;
+        case Format::format_16_vec2_float:            return Format_kind::format_kind_float;
+        case Format::format_16_vec3_float:            return Format_kind::format_kind_float;
+        case Format::format_16_vec4_float:            return Format_kind::format_kind_float;
         case Format::format_32_scalar_unorm:          return Format_kind::format_kind_float;
         case Format::format_32_scalar_snorm:          return Format_kind::format_kind_float;
         case Format::format_32_scalar_uscaled:        return Format_kind::format_kind_float;
@@ -302,6 +411,10 @@ auto get_component_count(Format format) -> std::size_t
         case Format::format_16_vec4_sscaled:          return 4;
         case Format::format_16_vec4_uint:             return 4;
         case Format::format_16_vec4_sint:             return 4;
+        case Format::format_16_scalar_float:          return 1;
+        case Format::format_16_vec2_float:            return 2;
+        case Format::format_16_vec3_float:            return 3;
+        case Format::format_16_vec4_float:            return 4;
         case Format::format_32_scalar_unorm:          return 1;
         case Format::format_32_scalar_snorm:          return 1;
         case Format::format_32_scalar_uscaled:        return 1;
@@ -392,6 +505,10 @@ auto get_component_byte_size(Format format) -> std::size_t
         case Format::format_16_vec4_sscaled:          return 2;
         case Format::format_16_vec4_uint:             return 2;
         case Format::format_16_vec4_sint:             return 2;
+        case Format::format_16_scalar_float:          return 2;
+        case Format::format_16_vec2_float:            return 2;
+        case Format::format_16_vec3_float:            return 2;
+        case Format::format_16_vec4_float:            return 2;
         case Format::format_32_scalar_unorm:          return 4;
         case Format::format_32_scalar_snorm:          return 4;
         case Format::format_32_scalar_uscaled:        return 4;
@@ -482,6 +599,10 @@ auto get_format_size(Format format) -> std::size_t
         case Format::format_16_vec4_sscaled:          return 4 * 2;
         case Format::format_16_vec4_uint:             return 4 * 2;
         case Format::format_16_vec4_sint:             return 4 * 2;
+        case Format::format_16_scalar_float:          return 1 * 2;
+        case Format::format_16_vec2_float:            return 2 * 2;
+        case Format::format_16_vec3_float:            return 3 * 2;
+        case Format::format_16_vec4_float:            return 4 * 2;
         case Format::format_32_scalar_unorm:          return 1 * 4;
         case Format::format_32_scalar_snorm:          return 1 * 4;
         case Format::format_32_scalar_uscaled:        return 1 * 4;
@@ -784,6 +905,33 @@ void convert(const void* src, Format src_format, void* dst, Format dst_format, f
             break;
         }
 
+        case Format::format_16_scalar_float: {
+            const uint16_t* h_src = reinterpret_cast<const uint16_t*>(src);
+            f_value[0] = half_to_float(h_src[0]);
+            break;
+        }
+        case Format::format_16_vec2_float: {
+            const uint16_t* h_src = reinterpret_cast<const uint16_t*>(src);
+            f_value[0] = half_to_float(h_src[0]);
+            f_value[1] = half_to_float(h_src[1]);
+            break;
+        }
+        case Format::format_16_vec3_float: {
+            const uint16_t* h_src = reinterpret_cast<const uint16_t*>(src);
+            f_value[0] = half_to_float(h_src[0]);
+            f_value[1] = half_to_float(h_src[1]);
+            f_value[2] = half_to_float(h_src[2]);
+            break;
+        }
+        case Format::format_16_vec4_float: {
+            const uint16_t* h_src = reinterpret_cast<const uint16_t*>(src);
+            f_value[0] = half_to_float(h_src[0]);
+            f_value[1] = half_to_float(h_src[1]);
+            f_value[2] = half_to_float(h_src[2]);
+            f_value[3] = half_to_float(h_src[3]);
+            break;
+        }
+
         case Format::format_32_scalar_float: {
             const float* f_src = reinterpret_cast<const float*>(src);
             f_value[0] = f_src[0];
@@ -1368,6 +1516,37 @@ void convert(const void* src, Format src_format, void* dst, Format dst_format, f
             break;
         }
 
+        case Format::format_16_scalar_float: {
+            uint16_t h[1];
+            h[0] = float_to_half(f_value[0] / scale);
+            memcpy(dst, &h[0], 1 * sizeof(uint16_t));
+            break;
+        }
+        case Format::format_16_vec2_float: {
+            uint16_t h[2];
+            h[0] = float_to_half(f_value[0] / scale);
+            h[1] = float_to_half(f_value[1] / scale);
+            memcpy(dst, &h[0], 2 * sizeof(uint16_t));
+            break;
+        }
+        case Format::format_16_vec3_float: {
+            uint16_t h[3];
+            h[0] = float_to_half(f_value[0] / scale);
+            h[1] = float_to_half(f_value[1] / scale);
+            h[2] = float_to_half(f_value[2] / scale);
+            memcpy(dst, &h[0], 3 * sizeof(uint16_t));
+            break;
+        }
+        case Format::format_16_vec4_float: {
+            uint16_t h[4];
+            h[0] = float_to_half(f_value[0] / scale);
+            h[1] = float_to_half(f_value[1] / scale);
+            h[2] = float_to_half(f_value[2] / scale);
+            h[3] = float_to_half(f_value[3] / scale);
+            memcpy(dst, &h[0], 4 * sizeof(uint16_t));
+            break;
+        }
+
         case Format::format_32_scalar_float: {
             memcpy(dst, &f_value[0], 1 * sizeof(float));
             break;
@@ -14,6 +14,15 @@ float unorm16_to_float(uint16_t v);
 uint8_t float_to_unorm8(float v);
 float unorm8_to_float(uint8_t v);
 
+// IEEE 754 binary16, round to nearest even
+uint16_t float_to_half(float v);
+float half_to_float(uint16_t v);
+
+// Octahedral unit vector mapping (Meyer et al. 2010) to [-1, 1] square,
+// suitable for storing normals in two snorm components
+void encode_octahedral(float x, float y, float z, float& u, float& v);
+void decode_octahedral(float u, float v, float& x, float& y, float& z);
+
 enum class Format {
     format_undefined = 0,
     format_8_scalar_unorm,
@@ -64,6 +73,10 @@ enum class Format {
     format_16_vec4_sscaled,
     format_16_vec4_uint,
     format_16_vec4_sint,
+    format_16_scalar_float,
+    format_16_vec2_float,
+    format_16_vec3_float,
+    format_16_vec4_float,
     format_32_scalar_unorm,
     format_32_scalar_snorm,
     format_32_scalar_uscaled,
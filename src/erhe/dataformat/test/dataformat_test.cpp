@@ -0,0 +1,288 @@
+// Tests for half float and octahedral normal conversions.
+//
+// Half: every half bit pattern converts to float and back unchanged
+// (NaN stays NaN with the same sign). Floats across the normal half range
+// convert with relative error within half an ulp and round to the nearer
+// neighbour, floats in the subnormal range with absolute error within
+// 2^-25. Overflow, infinities, NaN and signed zero are checked.
+//
+// Octahedral: unit vectors sweeping the sphere, including poles, axes and
+// points on both sides of the z < 0 fold, decode back within a small
+// angular error, both directly and through snorm16 and snorm8 storage.
+
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_dataformat/dataformat_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+using namespace erhe::dataformat;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+auto float_bits(const float value) -> uint32_t
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(float));
+    return bits;
+}
+
+void test_half_bit_patterns()
+{
+    bool all_round_trip = true;
+    bool nan_preserved  = true;
+    for (uint32_t bits = 0; bits <= 0xffffu; ++bits) {
+        const uint16_t half  = static_cast<uint16_t>(bits);
+        const float    value = half_to_float(half);
+        const bool     nan   = ((half & 0x7c00u) == 0x7c00u) && ((half & 0x03ffu) != 0);
+        if (nan) {
+            const uint16_t back = float_to_half(value);
+            nan_preserved = nan_preserved && std::isnan(value) && ((back & 0x7c00u) == 0x7c00u) && ((back & 0x03ffu) != 0) && ((back & 0x8000u) == (half & 0x8000u));
+        } else {
+            all_round_trip = all_round_trip && (float_to_half(value) == half);
+        }
+    }
+    check(all_round_trip, "half: every non-NaN half converts to float and back unchanged");
+    check(nan_preserved,  "half: NaN converts to NaN with same sign");
+}
+
+void test_half_normal_range()
+{
+    // Walk floats from smallest normal half to largest finite half with a
+    // stride that visits many mantissas per exponent
+    constexpr float c_min_normal = 6.103515625e-05f; // 2^-14
+    constexpr float c_max_finite = 65504.0f;
+    bool  within_half_ulp = true;
+    bool  nearest         = true;
+    float max_relative    = 0.0f;
+    for (uint32_t bits = float_bits(c_min_normal); bits <= float_bits(c_max_finite); bits += 997) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(float));
+        for (const float signed_value : { value, -value }) {
+            const uint16_t half   = float_to_half(signed_value);
+            const float    result = half_to_float(half);
+            const float    error  = std::abs(result - signed_value);
+            const float    relative = error / std::abs(signed_value);
+            max_relative    = std::max(max_relative, relative);
+            within_half_ulp = within_half_ulp && (relative <= 1.0f / 2048.0f);
+
+            // Neighbouring halves are not closer
+            const uint16_t magnitude = half & 0x7fffu;
+            const uint16_t sign      = half & 0x8000u;
+            for (const uint16_t neighbour : { static_cast<uint16_t>(magnitude - 1u), static_cast<uint16_t>(magnitude + 1u) }) {
+                if (neighbour >= 0x7c00u) {
+                    continue;
+                }
+                const float neighbour_value = half_to_float(static_cast<uint16_t>(sign | neighbour));
+                nearest = nearest && (std::abs(neighbour_value - signed_value) >= error);
+            }
+        }
+    }
+    fmt::print("half: max relative error {:.3e}\n", max_relative);
+    check(within_half_ulp, "half: relative error within half ulp in normal range");
+    check(nearest,         "half: rounds to nearest half");
+
+    // Ties round to even mantissa
+    check(float_to_half(1.0f + 1.0f / 2048.0f)                  == 0x3c00u, "half: tie rounds down to even");
+    check(float_to_half(1.0f + 3.0f / 2048.0f)                  == 0x3c02u, "half: tie rounds up to even");
+    check(float_to_half(2047.0f / 1024.0f + 1.0f / 2048.0f)     == 0x4000u, "half: rounding carries into exponent");
+}
+
+void test_half_subnormal_range()
+{
+    constexpr float c_min_subnormal = 5.9604644775390625e-08f; // 2^-24
+    constexpr float c_min_normal    = 6.103515625e-05f;        // 2^-14
+    bool within_bound = true;
+    bool subnormal    = true;
+    for (uint32_t bits = float_bits(c_min_subnormal * 0.25f); bits <= float_bits(c_min_normal); bits += 251) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(float));
+        const uint16_t half   = float_to_half(value);
+        const float    result = half_to_float(half);
+        within_bound = within_bound && (std::abs(result - value) <= 0.5f * c_min_subnormal);
+        if (value < c_min_normal - c_min_subnormal) {
+            subnormal = subnormal && ((half & 0x7c00u) == 0);
+        }
+    }
+    check(within_bound, "half: subnormal absolute error within 2^-25");
+    check(subnormal,    "half: values below normal range are subnormal");
+
+    check(float_to_half( c_min_subnormal) == 0x0001u,              "half: smallest subnormal");
+    check(float_to_half(-c_min_subnormal) == 0x8001u,              "half: smallest negative subnormal");
+    check(float_to_half( 0.5f  * c_min_subnormal) == 0x0000u,      "half: half of smallest subnormal ties to zero");
+    check(float_to_half( 0.51f * c_min_subnormal) == 0x0001u,      "half: over half of smallest subnormal rounds up");
+    check(float_to_half( 1.5f  * c_min_subnormal) == 0x0002u,      "half: subnormal tie rounds to even");
+    check(float_to_half( 0.25f * c_min_subnormal) == 0x0000u,      "half: underflow to zero");
+    check(float_to_half(-0.25f * c_min_subnormal) == 0x8000u,      "half: underflow keeps sign");
+    check(float_to_half(c_min_normal - 0.5f * c_min_subnormal) == 0x0400u, "half: largest subnormal rounds up to smallest normal");
+    check(half_to_float(0x03ffu) == 1023.0f * c_min_subnormal,     "half: largest subnormal to float");
+}
+
+void test_half_special_values()
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+    const float nan      = std::numeric_limits<float>::quiet_NaN();
+    check(float_to_half( 0.0f)      == 0x0000u, "half: zero");
+    check(float_to_half(-0.0f)      == 0x8000u, "half: negative zero");
+    check(std::signbit(half_to_float(0x8000u)), "half: negative zero to float");
+    check(float_to_half( infinity)  == 0x7c00u, "half: infinity");
+    check(float_to_half(-infinity)  == 0xfc00u, "half: negative infinity");
+    check(half_to_float(0x7c00u)    == infinity,  "half: infinity to float");
+    check(half_to_float(0xfc00u)    == -infinity, "half: negative infinity to float");
+    check(float_to_half(65504.0f)   == 0x7bffu, "half: largest finite");
+    check(float_to_half(65519.0f)   == 0x7bffu, "half: below overflow threshold rounds to largest finite");
+    check(float_to_half(65520.0f)   == 0x7c00u, "half: overflow threshold rounds to infinity");
+    check(float_to_half(1.0e6f)     == 0x7c00u, "half: overflow to infinity");
+    check(float_to_half(-1.0e6f)    == 0xfc00u, "half: negative overflow to infinity");
+
+    const uint16_t nan_half = float_to_half(nan);
+    check(((nan_half & 0x7c00u) == 0x7c00u) && ((nan_half & 0x03ffu) != 0), "half: NaN");
+    check(std::isnan(half_to_float(nan_half)),                              "half: NaN to float");
+
+    // Payload bits only below half mantissa must not turn NaN into infinity
+    uint32_t low_payload_bits = 0x7f800001u;
+    float    low_payload_nan;
+    std::memcpy(&low_payload_nan, &low_payload_bits, sizeof(float));
+    check(std::isnan(half_to_float(float_to_half(low_payload_nan))), "half: NaN with low payload stays NaN");
+}
+
+auto angle_between(const float ax, const float ay, const float az, const float bx, const float by, const float bz) -> double
+{
+    // atan2 of cross and dot is accurate for small angles
+    const double cx = static_cast<double>(ay) * bz - static_cast<double>(az) * by;
+    const double cy = static_cast<double>(az) * bx - static_cast<double>(ax) * bz;
+    const double cz = static_cast<double>(ax) * by - static_cast<double>(ay) * bx;
+    const double d  = static_cast<double>(ax) * bx + static_cast<double>(ay) * by + static_cast<double>(az) * bz;
+    return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), d);
+}
+
+class Octahedral_errors
+{
+public:
+    double direct {0.0};
+    double snorm16{0.0};
+    double snorm8 {0.0};
+    bool   in_range{true};
+    bool   unit_length{true};
+};
+
+void check_octahedral(const float x, const float y, const float z, Octahedral_errors& errors)
+{
+    float u;
+    float v;
+    encode_octahedral(x, y, z, u, v);
+    errors.in_range = errors.in_range && (std::abs(u) <= 1.0f) && (std::abs(v) <= 1.0f);
+    // Upper hemisphere maps inside diamond, lower hemisphere outside
+    if (z > 1.0e-6f) {
+        errors.in_range = errors.in_range && (std::abs(u) + std::abs(v) <= 1.0f + 1.0e-6f);
+    } else if (z < -1.0e-6f) {
+        errors.in_range = errors.in_range && (std::abs(u) + std::abs(v) >= 1.0f - 1.0e-6f);
+    }
+
+    float dx;
+    float dy;
+    float dz;
+    decode_octahedral(u, v, dx, dy, dz);
+    errors.unit_length = errors.unit_length && (std::abs(std::sqrt(dx * dx + dy * dy + dz * dz) - 1.0f) < 1.0e-5f);
+    errors.direct = std::max(errors.direct, angle_between(x, y, z, dx, dy, dz));
+
+    decode_octahedral(snorm16_to_float(float_to_snorm16(u)), snorm16_to_float(float_to_snorm16(v)), dx, dy, dz);
+    errors.snorm16 = std::max(errors.snorm16, angle_between(x, y, z, dx, dy, dz));
+
+    decode_octahedral(snorm8_to_float(float_to_snorm8(u)), snorm8_to_float(float_to_snorm8(v)), dx, dy, dz);
+    errors.snorm8 = std::max(errors.snorm8, angle_between(x, y, z, dx, dy, dz));
+}
+
+void test_octahedral()
+{
+    constexpr double pi = 3.14159265358979323846;
+    Octahedral_errors errors;
+
+    // Sphere sweep, rows include both poles and equator
+    constexpr int theta_steps = 180;
+    constexpr int phi_steps   = 360;
+    for (int i = 0; i <= theta_steps; ++i) {
+        const double theta = pi * static_cast<double>(i) / theta_steps;
+        for (int j = 0; j < phi_steps; ++j) {
+            const double phi = 2.0 * pi * (static_cast<double>(j) + 0.25) / phi_steps;
+            check_octahedral(
+                static_cast<float>(std::sin(theta) * std::cos(phi)),
+                static_cast<float>(std::sin(theta) * std::sin(phi)),
+                static_cast<float>(std::cos(theta)),
+                errors
+            );
+        }
+    }
+
+    // Poles, axes and diagonals, including signed zeros on the fold
+    const float s = 1.0f / std::sqrt(2.0f);
+    const float t = 1.0f / std::sqrt(3.0f);
+    const float directions[][3] = {
+        { 0.0f,  0.0f,  1.0f}, { 0.0f,  0.0f, -1.0f}, {-0.0f, -0.0f, -1.0f},
+        { 1.0f,  0.0f,  0.0f}, {-1.0f,  0.0f,  0.0f}, { 0.0f,  1.0f,  0.0f}, { 0.0f, -1.0f,  0.0f},
+        { 1.0f,  0.0f, -0.0f}, {-1.0f,  0.0f, -0.0f}, { 0.0f,  1.0f, -0.0f}, { 0.0f, -1.0f, -0.0f},
+        { s,     0.0f, -s   }, {-s,     0.0f, -s   }, { 0.0f,  s,    -s   }, { 0.0f, -s,    -s   },
+        { t,     t,     t   }, {-t,     t,     t   }, { t,    -t,     t   }, {-t,    -t,     t   },
+        { t,     t,    -t   }, {-t,     t,    -t   }, { t,    -t,    -t   }, {-t,    -t,    -t   }
+    };
+    for (const auto& d : directions) {
+        check_octahedral(d[0], d[1], d[2], errors);
+    }
+
+    // Decoding both sides of the fold edge gives the same direction
+    float ax, ay, az, bx, by, bz;
+    decode_octahedral( 0.5f,  0.5f, ax, ay, az);
+    decode_octahedral( 0.5f,  0.5f + 1.0e-7f, bx, by, bz);
+    check(angle_between(ax, ay, az, bx, by, bz) < 1.0e-5, "octahedral: continuous across fold");
+    decode_octahedral( 1.0f,  1.0f, ax, ay, az);
+    decode_octahedral(-1.0f, -1.0f, bx, by, bz);
+    check((std::abs(az + 1.0f) < 1.0e-6f) && (std::abs(bz + 1.0f) < 1.0e-6f), "octahedral: square corners decode to -z pole");
+
+    fmt::print(
+        "octahedral: max angular error {:.3e} rad float, {:.3e} rad snorm16, {:.3e} rad snorm8\n",
+        errors.direct, errors.snorm16, errors.snorm8
+    );
+    check(errors.in_range,           "octahedral: encoded values in range, z < 0 outside diamond");
+    check(errors.unit_length,        "octahedral: decoded vectors have unit length");
+    check(errors.direct  < 1.0e-5,   "octahedral: float round trip angular error");
+    check(errors.snorm16 < 1.0e-4,   "octahedral: snorm16 round trip angular error");
+    check(errors.snorm8  < 2.0e-2,   "octahedral: snorm8 round trip angular error");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::dataformat::initialize_logging();
+
+    test_half_bit_patterns();
+    test_half_normal_range();
+    test_half_subnormal_range();
+    test_half_special_values();
+    test_octahedral();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("dataformat tests passed\n");
+    return EXIT_SUCCESS;
+}
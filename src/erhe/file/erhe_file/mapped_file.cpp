@@ -0,0 +1,148 @@
+#include "erhe_file/mapped_file.hpp"
+#include "erhe_file/file.hpp"
+#include "erhe_file/file_log.hpp"
+
+#if defined(ERHE_OS_WINDOWS)
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace erhe::file {
+
+Mapped_file::Mapped_file() = default;
+
+Mapped_file::Mapped_file(const std::filesystem::path& path)
+{
+    open(path);
+}
+
+Mapped_file::~Mapped_file() noexcept
+{
+    close();
+}
+
+Mapped_file::Mapped_file(Mapped_file&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+auto Mapped_file::operator=(Mapped_file&& other) noexcept -> Mapped_file&
+{
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#if defined(ERHE_OS_WINDOWS)
+        m_file_handle    = std::exchange(other.m_file_handle,    nullptr);
+        m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+#else
+        m_file_descriptor = std::exchange(other.m_file_descriptor, -1);
+#endif
+    }
+    return *this;
+}
+
+auto Mapped_file::open(const std::filesystem::path& path) -> bool
+{
+    close();
+
+#if defined(ERHE_OS_WINDOWS)
+    HANDLE file_handle = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file_handle, &file_size) || (file_size.QuadPart == 0)) {
+        CloseHandle(file_handle);
+        return false;
+    }
+    HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        log_file->warn("CreateFileMappingW() failed for '{}'", to_string(path));
+        CloseHandle(file_handle);
+        return false;
+    }
+    void* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        log_file->warn("MapViewOfFile() failed for '{}'", to_string(path));
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+    m_file_handle    = file_handle;
+    m_mapping_handle = mapping_handle;
+    m_data           = static_cast<const std::byte*>(data);
+    m_size           = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    const int file_descriptor = ::open(path.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+        return false;
+    }
+    struct stat file_stat{};
+    if ((::fstat(file_descriptor, &file_stat) != 0) || (file_stat.st_size <= 0)) {
+        ::close(file_descriptor);
+        return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(file_stat.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (data == MAP_FAILED) {
+        log_file->warn("mmap() failed for '{}'", to_string(path));
+        ::close(file_descriptor);
+        return false;
+    }
+    m_file_descriptor = file_descriptor;
+    m_data            = static_cast<const std::byte*>(data);
+    m_size            = size;
+#endif
+    return true;
+}
+
+void Mapped_file::close()
+{
+    if (m_data == nullptr) {
+        return;
+    }
+#if defined(ERHE_OS_WINDOWS)
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping_handle));
+    CloseHandle(static_cast<HANDLE>(m_file_handle));
+    m_mapping_handle = nullptr;
+    m_file_handle    = nullptr;
+#else
+    ::munmap(const_cast<std::byte*>(m_data), m_size);
+    ::close(m_file_descriptor);
+    m_file_descriptor = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+auto Mapped_file::is_open() const -> bool
+{
+    return m_data != nullptr;
+}
+
+auto Mapped_file::data() const -> const std::byte*
+{
+    return m_data;
+}
+
+auto Mapped_file::size() const -> std::size_t
+{
+    return m_size;
+}
+
+auto Mapped_file::span() const -> std::span<const std::byte>
+{
+    return std::span<const std::byte>{m_data, m_size};
+}
+
+} // namespace erhe::file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace erhe::file {
+
+// Read-only memory mapping of a whole file
+class Mapped_file
+{
+public:
+    Mapped_file();
+    explicit Mapped_file(const std::filesystem::path& path);
+    ~Mapped_file() noexcept;
+
+    Mapped_file   (const Mapped_file&) = delete;
+    auto operator=(const Mapped_file&) = delete;
+    Mapped_file   (Mapped_file&& other) noexcept;
+    auto operator=(Mapped_file&& other) noexcept -> Mapped_file&;
+
+    auto open (const std::filesystem::path& path) -> bool;
+    void close();
+
+    [[nodiscard]] auto is_open() const -> bool;
+    [[nodiscard]] auto data   () const -> const std::byte*;
+    [[nodiscard]] auto size   () const -> std::size_t;
+    [[nodiscard]] auto span   () const -> std::span<const std::byte>;
+
+private:
+    const std::byte* m_data          {nullptr};
+    std::size_t      m_size          {0};
+#if defined(ERHE_OS_WINDOWS)
+    void*            m_file_handle   {nullptr};
+    void*            m_mapping_handle{nullptr};
+#else
+    int              m_file_descriptor{-1};
+#endif
+};
+
+} // namespace erhe::file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace erhe::geometry {
+
+// Byte stream used by Compressed_geometry. Integers are LEB128 varints.
+// Delta coded integers store zigzag coded difference to the previous
+// value, so runs of consecutive ids take one byte each.
+class Byte_writer
+{
+public:
+    void write_varint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    void write_delta(const uint64_t value, uint64_t& previous)
+    {
+        const int64_t delta = static_cast<int64_t>(value - previous);
+        write_varint((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        previous = value;
+    }
+
+    void write_bytes(const void* data, const std::size_t byte_count)
+    {
+        const std::size_t offset = bytes.size();
+        bytes.resize(offset + byte_count);
+        std::memcpy(bytes.data() + offset, data, byte_count);
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+class Byte_reader
+{
+public:
+    explicit Byte_reader(const std::span<const uint8_t> bytes)
+        : m_bytes{bytes}
+    {
+    }
+
+    [[nodiscard]] auto read_varint(uint64_t& value) -> bool
+    {
+        value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (m_offset >= m_bytes.size()) {
+                return false;
+            }
+            const uint8_t byte = m_bytes[m_offset++];
+            value |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+            if ((byte & 0x80u) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] auto read_delta(uint64_t& value, uint64_t& previous) -> bool
+    {
+        uint64_t zigzag = 0;
+        if (!read_varint(zigzag)) {
+            return false;
+        }
+        const uint64_t delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        value    = previous + delta;
+        previous = value;
+        return true;
+    }
+
+    [[nodiscard]] auto read_bytes(void* data, const std::size_t byte_count) -> bool
+    {
+        if (byte_count > m_bytes.size() - m_offset) {
+            return false;
+        }
+        std::memcpy(data, m_bytes.data() + m_offset, byte_count);
+        m_offset += byte_count;
+        return true;
+    }
+
+    [[nodiscard]] auto at_end() const -> bool
+    {
+        return m_offset == m_bytes.size();
+    }
+
+private:
+    std::span<const uint8_t> m_bytes;
+    std::size_t              m_offset{0};
+};
+
+} // namespace erhe::geometry
@@ -0,0 +1,269 @@
+#include "erhe_geometry/compressed_geometry.hpp"
+#include "erhe_geometry/byte_stream.hpp"
+#include "erhe_verify/verify.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <algorithm>
+
+namespace erhe::geometry {
+
+namespace {
+
+// Element count to store; vectors may have spare elements past the id
+// counter, and point corners may be reserved but not yet made
+template <typename T>
+auto stored_count(const std::vector<T>& elements, const uint32_t next_id) -> std::size_t
+{
+    return std::min(elements.size(), static_cast<std::size_t>(next_id));
+}
+
+template <typename T, typename Field>
+void write_delta_column(Byte_writer& writer, const std::vector<T>& elements, const std::size_t count, Field field)
+{
+    uint64_t previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        writer.write_delta(static_cast<uint64_t>(field(elements[i])), previous);
+    }
+}
+
+template <typename T, typename Field>
+void write_varint_column(Byte_writer& writer, const std::vector<T>& elements, const std::size_t count, Field field)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        writer.write_varint(static_cast<uint64_t>(field(elements[i])));
+    }
+}
+
+template <typename T, typename Field>
+auto read_delta_column(Byte_reader& reader, std::vector<T>& elements, Field field) -> bool
+{
+    uint64_t previous = 0;
+    for (T& element : elements) {
+        uint64_t value = 0;
+        if (!reader.read_delta(value, previous)) {
+            return false;
+        }
+        field(element) = static_cast<uint32_t>(value);
+    }
+    return true;
+}
+
+template <typename T, typename Field>
+auto read_varint_column(Byte_reader& reader, std::vector<T>& elements, Field field) -> bool
+{
+    for (T& element : elements) {
+        uint64_t value = 0;
+        if (!reader.read_varint(value)) {
+            return false;
+        }
+        field(element) = static_cast<uint32_t>(value);
+    }
+    return true;
+}
+
+auto read_count(Byte_reader& reader, std::size_t& count) -> bool
+{
+    uint64_t value = 0;
+    if (!reader.read_varint(value)) {
+        return false;
+    }
+    count = static_cast<std::size_t>(value);
+    return true;
+}
+
+template <typename T>
+auto read_id(Byte_reader& reader, T& id) -> bool
+{
+    uint64_t value = 0;
+    if (!reader.read_varint(value)) {
+        return false;
+    }
+    id = static_cast<T>(value);
+    return true;
+}
+
+} // anonymous namespace
+
+Compressed_geometry::Compressed_geometry(const Geometry& geometry)
+    : m_name              {geometry.name}
+    , m_point_attributes  {geometry.point_attributes  ().clone_empty()}
+    , m_corner_attributes {geometry.corner_attributes ().clone_empty()}
+    , m_polygon_attributes{geometry.polygon_attributes().clone_empty()}
+    , m_edge_attributes   {geometry.edge_attributes   ().clone_empty()}
+{
+    ERHE_PROFILE_FUNCTION();
+
+    Byte_writer writer;
+
+    for (const uint64_t value : {
+        uint64_t{geometry.m_next_corner_id},
+        uint64_t{geometry.m_next_point_id},
+        uint64_t{geometry.m_next_polygon_id},
+        uint64_t{geometry.m_next_edge_id},
+        uint64_t{geometry.m_next_point_corner_reserve},
+        uint64_t{geometry.m_next_polygon_corner_id},
+        uint64_t{geometry.m_next_edge_polygon_id},
+        uint64_t{geometry.m_polygon_corner_polygon},
+        uint64_t{geometry.m_edge_polygon_edge},
+        geometry.m_serial,
+        geometry.m_serial_edges,
+        geometry.m_serial_polygon_normals,
+        geometry.m_serial_polygon_centroids,
+        geometry.m_serial_polygon_tangents,
+        geometry.m_serial_polygon_bitangents,
+        geometry.m_serial_polygon_texture_coordinates,
+        geometry.m_serial_point_normals,
+        geometry.m_serial_point_tangents,
+        geometry.m_serial_point_bitangents,
+        geometry.m_serial_point_texture_coordinates,
+        geometry.m_serial_smooth_point_normals,
+        geometry.m_serial_corner_normals,
+        geometry.m_serial_corner_tangents,
+        geometry.m_serial_corner_bitangents,
+        geometry.m_serial_corner_texture_coordinates
+    }) {
+        writer.write_varint(value);
+    }
+
+    const std::size_t corner_count         = stored_count(geometry.corners,         geometry.m_next_corner_id);
+    const std::size_t point_count          = stored_count(geometry.points,          geometry.m_next_point_id);
+    const std::size_t polygon_count        = stored_count(geometry.polygons,        geometry.m_next_polygon_id);
+    const std::size_t edge_count           = stored_count(geometry.edges,           geometry.m_next_edge_id);
+    const std::size_t point_corner_count   = stored_count(geometry.point_corners,   geometry.m_next_point_corner_reserve);
+    const std::size_t polygon_corner_count = stored_count(geometry.polygon_corners, geometry.m_next_polygon_corner_id);
+    const std::size_t edge_polygon_count   = stored_count(geometry.edge_polygons,   geometry.m_next_edge_polygon_id);
+    for (const std::size_t count : {
+        corner_count, point_count, polygon_count, edge_count, point_corner_count, polygon_corner_count, edge_polygon_count
+    }) {
+        writer.write_varint(count);
+    }
+
+    // Columns rather than elements, so that deltas are taken between like fields
+    write_delta_column (writer, geometry.corners,  corner_count,  [](const Corner& c)  { return c.point_id; });
+    write_delta_column (writer, geometry.corners,  corner_count,  [](const Corner& c)  { return c.polygon_id; });
+    write_delta_column (writer, geometry.points,   point_count,   [](const Point& p)   { return p.first_point_corner_id; });
+    write_varint_column(writer, geometry.points,   point_count,   [](const Point& p)   { return p.corner_count; });
+    write_varint_column(writer, geometry.points,   point_count,   [](const Point& p)   { return p.reserved_corner_count; });
+    write_delta_column (writer, geometry.polygons, polygon_count, [](const Polygon& p) { return p.first_polygon_corner_id; });
+    write_varint_column(writer, geometry.polygons, polygon_count, [](const Polygon& p) { return p.corner_count; });
+    write_delta_column (writer, geometry.edges,    edge_count,    [](const Edge& e)    { return e.a; });
+    write_delta_column (writer, geometry.edges,    edge_count,    [](const Edge& e)    { return e.b; });
+    write_delta_column (writer, geometry.edges,    edge_count,    [](const Edge& e)    { return e.first_edge_polygon_id; });
+    write_varint_column(writer, geometry.edges,    edge_count,    [](const Edge& e)    { return e.polygon_count; });
+    const auto id = [](const uint32_t i) { return i; };
+    write_delta_column(writer, geometry.point_corners,   point_corner_count,   id);
+    write_delta_column(writer, geometry.polygon_corners, polygon_corner_count, id);
+    write_delta_column(writer, geometry.edge_polygons,   edge_polygon_count,   id);
+
+    geometry.point_attributes  ().write_to(writer);
+    geometry.corner_attributes ().write_to(writer);
+    geometry.polygon_attributes().write_to(writer);
+    geometry.edge_attributes   ().write_to(writer);
+
+    m_bytes = std::move(writer.bytes);
+    m_bytes.shrink_to_fit();
+}
+
+auto Compressed_geometry::decompress() const -> Geometry
+{
+    ERHE_PROFILE_FUNCTION();
+
+    Geometry    geometry{m_name};
+    Byte_reader reader{m_bytes};
+
+    bool ok =
+        read_id(reader, geometry.m_next_corner_id                    ) &&
+        read_id(reader, geometry.m_next_point_id                     ) &&
+        read_id(reader, geometry.m_next_polygon_id                   ) &&
+        read_id(reader, geometry.m_next_edge_id                      ) &&
+        read_id(reader, geometry.m_next_point_corner_reserve         ) &&
+        read_id(reader, geometry.m_next_polygon_corner_id            ) &&
+        read_id(reader, geometry.m_next_edge_polygon_id              ) &&
+        read_id(reader, geometry.m_polygon_corner_polygon            ) &&
+        read_id(reader, geometry.m_edge_polygon_edge                 ) &&
+        read_id(reader, geometry.m_serial                            ) &&
+        read_id(reader, geometry.m_serial_edges                      ) &&
+        read_id(reader, geometry.m_serial_polygon_normals            ) &&
+        read_id(reader, geometry.m_serial_polygon_centroids          ) &&
+        read_id(reader, geometry.m_serial_polygon_tangents           ) &&
+        read_id(reader, geometry.m_serial_polygon_bitangents         ) &&
+        read_id(reader, geometry.m_serial_polygon_texture_coordinates) &&
+        read_id(reader, geometry.m_serial_point_normals              ) &&
+        read_id(reader, geometry.m_serial_point_tangents             ) &&
+        read_id(reader, geometry.m_serial_point_bitangents           ) &&
+        read_id(reader, geometry.m_serial_point_texture_coordinates  ) &&
+        read_id(reader, geometry.m_serial_smooth_point_normals       ) &&
+        read_id(reader, geometry.m_serial_corner_normals             ) &&
+        read_id(reader, geometry.m_serial_corner_tangents            ) &&
+        read_id(reader, geometry.m_serial_corner_bitangents          ) &&
+        read_id(reader, geometry.m_serial_corner_texture_coordinates );
+
+    std::size_t corner_count        {0};
+    std::size_t point_count         {0};
+    std::size_t polygon_count       {0};
+    std::size_t edge_count          {0};
+    std::size_t point_corner_count  {0};
+    std::size_t polygon_corner_count{0};
+    std::size_t edge_polygon_count  {0};
+    ok = ok &&
+        read_count(reader, corner_count        ) &&
+        read_count(reader, point_count         ) &&
+        read_count(reader, polygon_count       ) &&
+        read_count(reader, edge_count          ) &&
+        read_count(reader, point_corner_count  ) &&
+        read_count(reader, polygon_corner_count) &&
+        read_count(reader, edge_polygon_count  );
+    ERHE_VERIFY(ok);
+
+    geometry.corners        .resize(corner_count);
+    geometry.points         .resize(point_count);
+    geometry.polygons       .resize(polygon_count);
+    geometry.edges          .resize(edge_count);
+    geometry.point_corners  .resize(point_corner_count);
+    geometry.polygon_corners.resize(polygon_corner_count);
+    geometry.edge_polygons  .resize(edge_polygon_count);
+
+    const auto id = [](uint32_t& i) -> uint32_t& { return i; };
+    ok =
+        read_delta_column (reader, geometry.corners,  [](Corner& c)  -> uint32_t& { return c.point_id; }) &&
+        read_delta_column (reader, geometry.corners,  [](Corner& c)  -> uint32_t& { return c.polygon_id; }) &&
+        read_delta_column (reader, geometry.points,   [](Point& p)   -> uint32_t& { return p.first_point_corner_id; }) &&
+        read_varint_column(reader, geometry.points,   [](Point& p)   -> uint32_t& { return p.corner_count; }) &&
+        read_varint_column(reader, geometry.points,   [](Point& p)   -> uint32_t& { return p.reserved_corner_count; }) &&
+        read_delta_column (reader, geometry.polygons, [](Polygon& p) -> uint32_t& { return p.first_polygon_corner_id; }) &&
+        read_varint_column(reader, geometry.polygons, [](Polygon& p) -> uint32_t& { return p.corner_count; }) &&
+        read_delta_column (reader, geometry.edges,    [](Edge& e)    -> uint32_t& { return e.a; }) &&
+        read_delta_column (reader, geometry.edges,    [](Edge& e)    -> uint32_t& { return e.b; }) &&
+        read_delta_column (reader, geometry.edges,    [](Edge& e)    -> uint32_t& { return e.first_edge_polygon_id; }) &&
+        read_varint_column(reader, geometry.edges,    [](Edge& e)    -> uint32_t& { return e.polygon_count; }) &&
+        read_delta_column (reader, geometry.point_corners,   id) &&
+        read_delta_column (reader, geometry.polygon_corners, id) &&
+        read_delta_column (reader, geometry.edge_polygons,   id);
+    ERHE_VERIFY(ok);
+
+    geometry.m_point_property_map_collection   = m_point_attributes  .clone_empty();
+    geometry.m_corner_property_map_collection  = m_corner_attributes .clone_empty();
+    geometry.m_polygon_property_map_collection = m_polygon_attributes.clone_empty();
+    geometry.m_edge_property_map_collection    = m_edge_attributes   .clone_empty();
+    ok =
+        geometry.m_point_property_map_collection  .read_from(reader) &&
+        geometry.m_corner_property_map_collection .read_from(reader) &&
+        geometry.m_polygon_property_map_collection.read_from(reader) &&
+        geometry.m_edge_property_map_collection   .read_from(reader) &&
+        reader.at_end();
+    ERHE_VERIFY(ok);
+
+    return geometry;
+}
+
+auto Compressed_geometry::get_memory_usage() const -> std::size_t
+{
+    return
+        m_bytes.capacity() +
+        m_point_attributes  .memory_usage() +
+        m_corner_attributes .memory_usage() +
+        m_polygon_attributes.memory_usage() +
+        m_edge_attributes   .memory_usage();
+}
+
+} // namespace erhe::geometry
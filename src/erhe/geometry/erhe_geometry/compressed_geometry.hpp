@@ -0,0 +1,38 @@
+#pragma once
+
+#include "erhe_geometry/geometry.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace erhe::geometry {
+
+// Geometry packed into a byte stream, for geometry which is kept around
+// but rarely used, such as undo history. Connectivity is stored as delta
+// coded varint columns, attributes as runs of equal values. Spare
+// capacity and the edge index are not stored; find_edge() rebuilds the
+// edge index of decompressed geometry when needed.
+class Compressed_geometry
+{
+public:
+    explicit Compressed_geometry(const Geometry& geometry);
+
+    [[nodiscard]] auto decompress      () const -> Geometry;
+    [[nodiscard]] auto get_name        () const -> const std::string& { return m_name; }
+    [[nodiscard]] auto get_byte_count  () const -> std::size_t { return m_bytes.size(); }
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t;
+
+private:
+    std::string                               m_name;
+    std::vector<uint8_t>                      m_bytes;
+
+    // Empty maps which keep descriptors and value types for decompress()
+    Geometry::Point_property_map_collection   m_point_attributes;
+    Geometry::Corner_property_map_collection  m_corner_attributes;
+    Geometry::Polygon_property_map_collection m_polygon_attributes;
+    Geometry::Edge_property_map_collection    m_edge_attributes;
+};
+
+} // namespace erhe::geometry
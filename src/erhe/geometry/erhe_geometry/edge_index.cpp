@@ -0,0 +1,107 @@
+#include "erhe_geometry/edge_index.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace erhe::geometry {
+
+void Edge_index::clear()
+{
+    std::fill(m_slots.begin(), m_slots.end(), Slot{});
+    m_size = 0;
+}
+
+void Edge_index::reserve(const std::size_t edge_count)
+{
+    const std::size_t capacity = std::bit_ceil(std::max(std::size_t{16}, 2 * edge_count));
+    if (capacity > m_slots.size()) {
+        rehash(capacity);
+    }
+}
+
+auto Edge_index::make_key(const Point_id a, const Point_id b) -> uint64_t
+{
+    return (static_cast<uint64_t>(a) << 32u) | static_cast<uint64_t>(b);
+}
+
+auto Edge_index::slot_index(const uint64_t key) const -> std::size_t
+{
+    // Fibonacci hashing; top bits of the product are well mixed
+    return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> m_hash_shift);
+}
+
+void Edge_index::rehash(const std::size_t capacity)
+{
+    ERHE_VERIFY(std::has_single_bit(capacity));
+
+    std::vector<Slot> old_slots = std::move(m_slots);
+    m_slots.assign(capacity, Slot{});
+    m_hash_shift = 64u - static_cast<unsigned int>(std::countr_zero(capacity));
+
+    const std::size_t mask = capacity - 1;
+    for (const Slot& slot : old_slots) {
+        if (slot.key == c_empty_key) {
+            continue;
+        }
+        std::size_t i = slot_index(slot.key);
+        while (m_slots[i].key != c_empty_key) {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = slot;
+    }
+}
+
+void Edge_index::insert(const Point_id a, const Point_id b, const Edge_id edge_id)
+{
+    ERHE_VERIFY(a < b);
+
+    if (2 * (m_size + 1) > m_slots.size()) {
+        rehash(std::max(std::size_t{16}, 2 * m_slots.size()));
+    }
+
+    const uint64_t    key  = make_key(a, b);
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = slot_index(key);; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+        if (slot.key == key) {
+            return;
+        }
+        if (slot.key == c_empty_key) {
+            slot.key     = key;
+            slot.edge_id = edge_id;
+            ++m_size;
+            return;
+        }
+    }
+}
+
+auto Edge_index::find(Point_id a, Point_id b) const -> std::optional<Edge_id>
+{
+    if (b < a) {
+        std::swap(a, b);
+    }
+    if ((a == b) || (m_size == 0)) {
+        return {};
+    }
+
+    const uint64_t    key  = make_key(a, b);
+    const std::size_t mask = m_slots.size() - 1;
+    for (std::size_t i = slot_index(key);; i = (i + 1) & mask) {
+        const Slot& slot = m_slots[i];
+        if (slot.key == key) {
+            return slot.edge_id;
+        }
+        if (slot.key == c_empty_key) {
+            return {};
+        }
+    }
+}
+
+auto Edge_index::memory_usage() const -> std::size_t
+{
+    return m_slots.capacity() * sizeof(Slot);
+}
+
+} // namespace erhe::geometry
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "erhe_geometry/types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace erhe::geometry {
+
+// Maps ordered point pair (a < b) to Edge_id.
+// Open addressing with linear probing, power of two capacity,
+// load factor kept at or below 1/2. When the same point pair is
+// inserted more than once (non-manifold input), the first edge wins.
+class Edge_index
+{
+public:
+    void clear  ();
+    void reserve(std::size_t edge_count);
+    void insert (Point_id a, Point_id b, Edge_id edge_id);
+
+    [[nodiscard]] auto find        (Point_id a, Point_id b) const -> std::optional<Edge_id>;
+    [[nodiscard]] auto size        () const -> std::size_t { return m_size; }
+    [[nodiscard]] auto memory_usage() const -> std::size_t;
+
+private:
+    static constexpr uint64_t c_empty_key = ~uint64_t{0}; // not a valid key since a < b
+
+    class Slot
+    {
+    public:
+        uint64_t key    {c_empty_key};
+        Edge_id  edge_id{0};
+    };
+
+    [[nodiscard]] static auto make_key(Point_id a, Point_id b) -> uint64_t;
+    [[nodiscard]] auto slot_index(uint64_t key) const -> std::size_t;
+    void rehash(std::size_t capacity);
+
+    std::vector<Slot> m_slots;
+    std::size_t       m_size      {0};
+    unsigned int      m_hash_shift{64};
+};
+
+} // namespace erhe::geometry
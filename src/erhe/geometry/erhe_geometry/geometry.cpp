@@ -11,6 +11,7 @@
 #endif
 
 #include <cmath>
+#include <initializer_list>
 #include <sstream>
 
 namespace erhe::geometry
@@ -61,6 +62,8 @@ Geometry::Geometry(Geometry&& other) noexcept
     , m_next_edge_polygon_id              {other.m_next_edge_polygon_id     }
     , m_polygon_corner_polygon            {other.m_polygon_corner_polygon   }
     , m_edge_polygon_edge                 {other.m_edge_polygon_edge        }
+    , m_edge_index                        {std::move(other.m_edge_index)    }
+    , m_edge_index_edge_count             {other.m_edge_index_edge_count    }
     , m_point_property_map_collection     {std::move(other.m_point_property_map_collection)}
     , m_corner_property_map_collection    {std::move(other.m_corner_property_map_collection)}
     , m_polygon_property_map_collection   {std::move(other.m_polygon_property_map_collection)}
@@ -126,6 +129,23 @@ auto Geometry::get_mesh_info() const -> Mesh_info
     };
 }
 
+auto Geometry::get_memory_usage() const -> std::size_t
+{
+    return
+        corners        .capacity() * sizeof(Corner    ) +
+        points         .capacity() * sizeof(Point     ) +
+        polygons       .capacity() * sizeof(Polygon   ) +
+        edges          .capacity() * sizeof(Edge      ) +
+        point_corners  .capacity() * sizeof(Corner_id ) +
+        polygon_corners.capacity() * sizeof(Corner_id ) +
+        edge_polygons  .capacity() * sizeof(Polygon_id) +
+        m_edge_index.memory_usage() +
+        m_point_property_map_collection  .memory_usage() +
+        m_corner_property_map_collection .memory_usage() +
+        m_polygon_property_map_collection.memory_usage() +
+        m_edge_property_map_collection   .memory_usage();
+}
+
 void Geometry::reserve_points(const std::size_t point_count)
 {
     ERHE_PROFILE_FUNCTION();
@@ -253,6 +273,11 @@ void Geometry::build_edges(bool is_manifold)
     edges.clear();
     m_next_edge_id = 0;
 
+    // Each polygon edge is shared by at most two polygons in manifold case
+    m_edge_index.clear();
+    m_edge_index.reserve(m_next_polygon_corner_id / 2 + 1);
+    m_edge_index_edge_count = 0;
+
     log_build_edges->trace("{} build_edges() : {} polygons", name, m_next_polygon_id);
 
     //const erhe::log::Indenter scope_indent;
@@ -312,8 +337,7 @@ void Geometry::build_edges(bool is_manifold)
                     return;
                 }
 
-                auto edge = find_edge(a_, b_);
-                if (!edge) {
+                if (!m_edge_index.find(a_, b_).has_value()) {
                     // ERHE_VERIFY(b < a); This does not hold for non-manifold objects
                     {
                         const Point_id a = std::max(a_, b_);
@@ -346,6 +370,38 @@ void Geometry::build_edges(bool is_manifold)
     m_serial_edges = m_serial;
 }
 
+void Geometry::update_edge_index()
+{
+    if (m_edge_index_edge_count == m_next_edge_id) {
+        return;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    m_edge_index.clear();
+    m_edge_index.reserve(m_next_edge_id);
+    for (Edge_id edge_id = 0; edge_id < m_next_edge_id; ++edge_id) {
+        const Edge& edge = edges[edge_id];
+        m_edge_index.insert(edge.a, edge.b, edge_id);
+    }
+    m_edge_index_edge_count = m_next_edge_id;
+}
+
+auto Geometry::find_edge_id(const Point_id a, const Point_id b) -> std::optional<Edge_id>
+{
+    update_edge_index();
+    return m_edge_index.find(a, b);
+}
+
+auto Geometry::find_edge(const Point_id a, const Point_id b) -> std::optional<Edge>
+{
+    const std::optional<Edge_id> edge_id = find_edge_id(a, b);
+    if (!edge_id.has_value()) {
+        return {};
+    }
+    return edges[edge_id.value()];
+}
+
 void Geometry::debug_trace() const
 {
     ERHE_PROFILE_FUNCTION();
@@ -515,6 +571,8 @@ auto Geometry::transform(const mat4& m) -> Geometry&
 
     //const mat4 it = glm::transpose(glm::inverse(m));
 
+    const uint64_t old_serial = m_serial;
+
     polygon_attributes().transform(m);
     point_attributes  ().transform(m);
     corner_attributes ().transform(m);
@@ -525,6 +583,34 @@ auto Geometry::transform(const mat4& m) -> Geometry&
         reverse_polygons();
     }
 
+    // Serial changes so that caches keyed on it see new point locations.
+    // Derived attributes were transformed with the rest, so those which
+    // were current stay current.
+    ++m_serial;
+    for (
+        uint64_t* derived_serial : {
+            &m_serial_edges,
+            &m_serial_polygon_normals,
+            &m_serial_polygon_centroids,
+            &m_serial_polygon_tangents,
+            &m_serial_polygon_bitangents,
+            &m_serial_polygon_texture_coordinates,
+            &m_serial_point_normals,
+            &m_serial_point_tangents,
+            &m_serial_point_bitangents,
+            &m_serial_point_texture_coordinates,
+            &m_serial_smooth_point_normals,
+            &m_serial_corner_normals,
+            &m_serial_corner_tangents,
+            &m_serial_corner_bitangents,
+            &m_serial_corner_texture_coordinates
+        }
+    ) {
+        if (*derived_serial == old_serial) {
+            *derived_serial = m_serial;
+        }
+    }
+
     return *this;
 }
 
@@ -532,6 +618,8 @@ void Geometry::reverse_polygons()
 {
     ERHE_PROFILE_FUNCTION();
 
+    ++m_serial;
+
     for (Polygon_id polygon_id = 0; polygon_id < m_next_polygon_id; ++polygon_id) {
         polygons[polygon_id].reverse(*this);
     }
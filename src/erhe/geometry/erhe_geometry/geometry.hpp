@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_geometry/edge_index.hpp"
 #include "erhe_geometry/property_map.hpp"
 #include "erhe_geometry/property_map_collection.hpp"
 #include "erhe_geometry/types.hpp"
@@ -8,6 +9,7 @@
 
 #include <functional>
 #include <optional>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -93,10 +95,8 @@ public:
         }
     };
 
-    void for_each_corner(
-        Geometry&                                          geometry,
-        std::function<void(Point_corner_context& context)> callback
-    );
+    template <typename Callback>
+    void for_each_corner(Geometry& geometry, Callback&& callback);
 
     class Point_corner_context_const
     {
@@ -113,10 +113,8 @@ public:
         }
     };
 
-    void for_each_corner_const(
-        const Geometry&                                          geometry,
-        std::function<void(Point_corner_context_const& context)> callback
-    ) const;
+    template <typename Callback>
+    void for_each_corner_const(const Geometry& geometry, Callback&& callback) const;
 
     class Point_corner_neighborhood_context
     {
@@ -160,15 +158,14 @@ public:
         }
     };
 
-    void for_each_corner_neighborhood(
-        Geometry&                                                       geometry,
-        std::function<void(Point_corner_neighborhood_context& context)> callback
-    );
+    template <typename Callback>
+    void for_each_corner_neighborhood(Geometry& geometry, Callback&& callback);
 
-    void for_each_corner_neighborhood_const(
-        const Geometry&                                                       geometry,
-        std::function<void(Point_corner_neighborhood_context_const& context)> callback
-    ) const;
+    template <typename Callback>
+    void for_each_corner_neighborhood_const(const Geometry& geometry, Callback&& callback) const;
+
+    [[nodiscard]] auto corner_ids(const Geometry& geometry) const -> std::span<const Corner_id>;
+    [[nodiscard]] auto corner_ids(Geometry& geometry) const -> std::span<Corner_id>;
 
     Point_corner_id first_point_corner_id{0};
     uint32_t        corner_count{0};
@@ -241,6 +238,8 @@ public:
         const bool                                 overwrite = false
     ) const;
 
+    [[nodiscard]] auto corner_ids (const Geometry& geometry) const -> std::span<const Corner_id>;
+    [[nodiscard]] auto corner_ids (Geometry& geometry) const -> std::span<Corner_id>;
     [[nodiscard]] auto corner     (const Geometry& geometry, const Point_id point_id) const -> Corner_id;
     [[nodiscard]] auto next_corner(const Geometry& geometry, const Corner_id anchor_corner_id) const -> Corner_id;
     [[nodiscard]] auto prev_corner(const Geometry& geometry, const Corner_id corner_id) const -> Corner_id;
@@ -280,9 +279,11 @@ public:
         }
     };
 
-    void for_each_corner(Geometry& geometry, std::function<void(Polygon_corner_context& context)> callback);
+    template <typename Callback>
+    void for_each_corner(Geometry& geometry, Callback&& callback);
 
-    void for_each_corner_const(const Geometry& geometry, std::function<void(Polygon_corner_context_const& context)> callback) const;
+    template <typename Callback>
+    void for_each_corner_const(const Geometry& geometry, Callback&& callback) const;
 
     class Polygon_corner_neighborhood_context
     {
@@ -326,9 +327,11 @@ public:
         }
     };
 
-    void for_each_corner_neighborhood(Geometry& geometry, std::function<void(Polygon_corner_neighborhood_context& context)> callback);
+    template <typename Callback>
+    void for_each_corner_neighborhood(Geometry& geometry, Callback&& callback);
 
-    void for_each_corner_neighborhood_const(const Geometry& geometry, std::function<void(Polygon_corner_neighborhood_context_const& context)> callback) const;
+    template <typename Callback>
+    void for_each_corner_neighborhood_const(const Geometry& geometry, Callback&& callback) const;
 };
 
 class Edge
@@ -339,6 +342,9 @@ public:
     Edge_polygon_id first_edge_polygon_id{0};
     uint32_t        polygon_count{0};
 
+    [[nodiscard]] auto polygon_ids(const Geometry& geometry) const -> std::span<const Polygon_id>;
+    [[nodiscard]] auto polygon_ids(Geometry& geometry) const -> std::span<Polygon_id>;
+
     class Edge_polygon_context
     {
     public:
@@ -369,15 +375,11 @@ public:
         }
     };
 
-    void for_each_polygon(
-        Geometry&                                          geometry,
-        std::function<void(Edge_polygon_context& context)> callback
-    );
+    template <typename Callback>
+    void for_each_polygon(Geometry& geometry, Callback&& callback);
 
-    void for_each_polygon_const(
-        const Geometry&                                          geometry,
-        std::function<void(Edge_polygon_context_const& context)> callback
-    ) const;
+    template <typename Callback>
+    void for_each_polygon_const(const Geometry& geometry, Callback&& callback) const;
 };
 
 class Mesh_info
@@ -467,6 +469,8 @@ public:
         m_serial_corner_texture_coordinates = m_serial;
     }
 
+    // Incremented when connectivity changes; derived data is rebuilt when stale
+    auto get_serial              () const -> uint64_t { return m_serial; }
     auto get_corner_count        () const -> uint32_t { return m_next_corner_id; }
     auto get_point_count         () const -> uint32_t { return m_next_point_id; }
     auto get_point_corner_count  () const -> uint32_t { return m_next_point_corner_reserve; }
@@ -474,18 +478,10 @@ public:
     auto get_polygon_corner_count() const -> uint32_t { return m_next_polygon_corner_id; }
     auto get_edge_count          () const -> uint32_t { return m_next_edge_id; }
 
-    [[nodiscard]] auto find_edge(Point_id a, Point_id b) -> std::optional<Edge>
-    {
-        if (b < a) {
-            std::swap(a, b);
-        }
-        for (const auto& edge : edges) {
-            if (edge.a == a && edge.b == b) {
-                return edge;
-            }
-        }
-        return {};
-    }
+    // Point order does not matter. Uses edge index, which is kept up to
+    // date by make_edge() and rebuilt here if edges were made otherwise.
+    [[nodiscard]] auto find_edge   (Point_id a, Point_id b) -> std::optional<Edge>;
+    [[nodiscard]] auto find_edge_id(Point_id a, Point_id b) -> std::optional<Edge_id>;
 
     // Allocates new Corner / Corner_id
     // - Point must be allocated.
@@ -529,6 +525,9 @@ public:
 
     [[nodiscard]] auto get_mesh_info() const -> Mesh_info;
 
+    // Bytes allocated for connectivity and attributes, excluding name
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t;
+
     [[nodiscard]] auto point_attributes() -> Point_property_map_collection&
     {
         return m_point_property_map_collection;
@@ -783,14 +782,18 @@ public:
         }
     };
 
-    void for_each_corner       (std::function<void(Corner_context&       )> callback);
-    void for_each_corner_const (std::function<void(Corner_context_const& )> callback) const;
-    void for_each_point        (std::function<void(Point_context&        )> callback);
-    void for_each_point_const  (std::function<void(Point_context_const&  )> callback) const;
-    void for_each_polygon      (std::function<void(Polygon_context&      )> callback);
-    void for_each_polygon_const(std::function<void(Polygon_context_const&)> callback) const;
-    void for_each_edge         (std::function<void(Edge_context&         )> callback);
-    void for_each_edge_const   (std::function<void(Edge_context_const&   )> callback) const;
+    // Visitor callbacks are templates so that they can be inlined into
+    // the loop. Call break_iteration() on the context to stop early.
+    template <typename Callback> void for_each_corner       (Callback&& callback);
+    template <typename Callback> void for_each_corner_const (Callback&& callback) const;
+    template <typename Callback> void for_each_point        (Callback&& callback);
+    template <typename Callback> void for_each_point_const  (Callback&& callback) const;
+    template <typename Callback> void for_each_polygon      (Callback&& callback);
+    template <typename Callback> void for_each_polygon_const(Callback&& callback) const;
+    template <typename Callback> void for_each_edge         (Callback&& callback);
+    template <typename Callback> void for_each_edge_const   (Callback&& callback) const;
+
+    void update_edge_index();
 
     constexpr static std::size_t s_grow = 4096;
     Corner_id                       m_next_corner_id           {0};
@@ -802,6 +805,8 @@ public:
     Edge_polygon_id                 m_next_edge_polygon_id     {0};
     Polygon_id                      m_polygon_corner_polygon   {0};
     Edge_id                         m_edge_polygon_edge        {0};
+    Edge_index                      m_edge_index;
+    Edge_id                         m_edge_index_edge_count    {0}; // edges [0, count) are in m_edge_index
     Point_property_map_collection   m_point_property_map_collection;
     Corner_property_map_collection  m_corner_property_map_collection;
     Polygon_property_map_collection m_polygon_property_map_collection;
@@ -826,6 +831,7 @@ public:
 
 } // namespace erhe::geometry
 
+#include "geometry_iterators.inl"
 #include "corner.inl"
 #include "polygon.inl"
 #include "geometry.inl"
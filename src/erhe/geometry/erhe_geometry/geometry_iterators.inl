@@ -1,8 +1,9 @@
-#include "erhe_geometry/geometry.hpp"
+#pragma once
 
 namespace erhe::geometry {
 
-void Geometry::for_each_corner(std::function<void(Corner_context&)> callback)
+template <typename Callback>
+inline void Geometry::for_each_corner(Callback&& callback)
 {
     for (Corner_id corner_id = 0, end = get_corner_count(); corner_id < end; ++corner_id) {
         Corner& corner = corners[corner_id];
@@ -17,7 +18,8 @@ void Geometry::for_each_corner(std::function<void(Corner_context&)> callback)
     }
 }
 
-void Geometry::for_each_corner_const(std::function<void(Corner_context_const&)> callback) const
+template <typename Callback>
+inline void Geometry::for_each_corner_const(Callback&& callback) const
 {
     for (Corner_id corner_id = 0, end = get_corner_count(); corner_id < end; ++corner_id) {
         const Corner& corner = corners[corner_id];
@@ -32,7 +34,8 @@ void Geometry::for_each_corner_const(std::function<void(Corner_context_const&)>
     }
 }
 
-void Geometry::for_each_point(std::function<void(Point_context&)> callback)
+template <typename Callback>
+inline void Geometry::for_each_point(Callback&& callback)
 {
     for (Point_id point_id = 0, end = get_point_count(); point_id < end; ++point_id) {
         Point& point = points[point_id];
@@ -47,7 +50,8 @@ void Geometry::for_each_point(std::function<void(Point_context&)> callback)
     }
 }
 
-void Geometry::for_each_point_const(std::function<void(Point_context_const&)> callback) const
+template <typename Callback>
+inline void Geometry::for_each_point_const(Callback&& callback) const
 {
     for (
         Point_id point_id = 0, end = get_point_count();
@@ -66,7 +70,8 @@ void Geometry::for_each_point_const(std::function<void(Point_context_const&)> ca
     }
 }
 
-void Geometry::for_each_polygon(std::function<void(Polygon_context&)> callback)
+template <typename Callback>
+inline void Geometry::for_each_polygon(Callback&& callback)
 {
     for (Polygon_id polygon_id = 0, end = get_polygon_count(); polygon_id < end; ++polygon_id) {
         Polygon& polygon = polygons[polygon_id];
@@ -81,7 +86,8 @@ void Geometry::for_each_polygon(std::function<void(Polygon_context&)> callback)
     }
 }
 
-void Geometry::for_each_polygon_const(std::function<void(Polygon_context_const&)> callback) const
+template <typename Callback>
+inline void Geometry::for_each_polygon_const(Callback&& callback) const
 {
     for (Polygon_id polygon_id = 0, end = get_polygon_count(); polygon_id < end; ++polygon_id) {
         const Polygon& polygon = polygons[polygon_id];
@@ -96,7 +102,8 @@ void Geometry::for_each_polygon_const(std::function<void(Polygon_context_const&)
     }
 }
 
-void Geometry::for_each_edge(std::function<void(Edge_context&)> callback)
+template <typename Callback>
+inline void Geometry::for_each_edge(Callback&& callback)
 {
     for (Edge_id edge_id = 0, end = get_edge_count(); edge_id < end; ++edge_id) {
         Edge& edge = edges[edge_id];
@@ -111,7 +118,8 @@ void Geometry::for_each_edge(std::function<void(Edge_context&)> callback)
     }
 }
 
-void Geometry::for_each_edge_const(std::function<void(Edge_context_const&)> callback) const
+template <typename Callback>
+inline void Geometry::for_each_edge_const(Callback&& callback) const
 {
     for (Edge_id edge_id = 0, end = get_edge_count(); edge_id < end; ++edge_id) {
         const Edge& edge = edges[edge_id];
@@ -126,7 +134,8 @@ void Geometry::for_each_edge_const(std::function<void(Edge_context_const&)> call
     }
 }
 
-void Point::for_each_corner(Geometry& geometry, std::function<void(Point_corner_context&)> callback)
+template <typename Callback>
+inline void Point::for_each_corner(Geometry& geometry, Callback&& callback)
 {
     for (
         Point_corner_id point_corner_id = first_point_corner_id,
@@ -134,7 +143,7 @@ void Point::for_each_corner(Geometry& geometry, std::function<void(Point_corner_
         point_corner_id < end;
         ++point_corner_id
     ) {
-        Corner_id& corner_id = geometry.point_corners[point_corner_id];
+        const Corner_id corner_id = geometry.point_corners[point_corner_id];
         Point_corner_context context{
             .geometry        = geometry,
             .point_corner_id = point_corner_id,
@@ -148,7 +157,8 @@ void Point::for_each_corner(Geometry& geometry, std::function<void(Point_corner_
     }
 }
 
-void Point::for_each_corner_const(const Geometry& geometry, std::function<void(Point_corner_context_const&)> callback) const
+template <typename Callback>
+inline void Point::for_each_corner_const(const Geometry& geometry, Callback&& callback) const
 {
     for (
         Point_corner_id point_corner_id = first_point_corner_id,
@@ -156,7 +166,7 @@ void Point::for_each_corner_const(const Geometry& geometry, std::function<void(P
         point_corner_id < end;
         ++point_corner_id
     ) {
-        const Corner_id& corner_id = geometry.point_corners[point_corner_id];
+        const Corner_id corner_id = geometry.point_corners[point_corner_id];
         Point_corner_context_const context{
             .geometry        = geometry,
             .point_corner_id = point_corner_id,
@@ -170,7 +180,8 @@ void Point::for_each_corner_const(const Geometry& geometry, std::function<void(P
     }
 }
 
-void Point::for_each_corner_neighborhood(Geometry& geometry, std::function<void(Point_corner_neighborhood_context&)> callback)
+template <typename Callback>
+inline void Point::for_each_corner_neighborhood(Geometry& geometry, Callback&& callback)
 {
     for (uint32_t i = 0; i < corner_count; ++i) {
         const Point_corner_id prev_point_corner_id = first_point_corner_id + (corner_count + i - 1) % corner_count;
@@ -184,9 +195,9 @@ void Point::for_each_corner_neighborhood(Geometry& geometry, std::function<void(
             .prev_point_corner_id = prev_point_corner_id,
             .point_corner_id      = point_corner_id,
             .next_point_corner_id = next_point_corner_id,
-            .prev_corner_id       = geometry.point_corners[prev_point_corner_id],
-            .corner_id            = geometry.point_corners[point_corner_id],
-            .next_corner_id       = geometry.point_corners[next_point_corner_id],
+            .prev_corner_id       = prev_corner_id,
+            .corner_id            = corner_id,
+            .next_corner_id       = next_corner_id,
             .prev_corner          = geometry.corners[prev_corner_id],
             .corner               = geometry.corners[corner_id],
             .next_corner          = geometry.corners[next_corner_id]
@@ -198,7 +209,8 @@ void Point::for_each_corner_neighborhood(Geometry& geometry, std::function<void(
     }
 }
 
-void Point::for_each_corner_neighborhood_const(const Geometry& geometry, std::function<void(Point_corner_neighborhood_context_const&)> callback) const
+template <typename Callback>
+inline void Point::for_each_corner_neighborhood_const(const Geometry& geometry, Callback&& callback) const
 {
     for (uint32_t i = 0; i < corner_count; ++i) {
         const Point_corner_id prev_point_corner_id = first_point_corner_id + (corner_count + i - 1) % corner_count;
@@ -226,7 +238,8 @@ void Point::for_each_corner_neighborhood_const(const Geometry& geometry, std::fu
     }
 }
 
-void Polygon::for_each_corner(Geometry& geometry, std::function<void(Polygon_corner_context&)> callback)
+template <typename Callback>
+inline void Polygon::for_each_corner(Geometry& geometry, Callback&& callback)
 {
     for (
         Polygon_corner_id polygon_corner_id = first_polygon_corner_id,
@@ -248,7 +261,8 @@ void Polygon::for_each_corner(Geometry& geometry, std::function<void(Polygon_cor
     }
 }
 
-void Polygon::for_each_corner_const(const Geometry& geometry, std::function<void(Polygon_corner_context_const&)> callback) const
+template <typename Callback>
+inline void Polygon::for_each_corner_const(const Geometry& geometry, Callback&& callback) const
 {
     for (
         Polygon_corner_id polygon_corner_id = first_polygon_corner_id,
@@ -270,7 +284,8 @@ void Polygon::for_each_corner_const(const Geometry& geometry, std::function<void
     }
 }
 
-void Polygon::for_each_corner_neighborhood(Geometry& geometry, std::function<void(Polygon_corner_neighborhood_context&)> callback)
+template <typename Callback>
+inline void Polygon::for_each_corner_neighborhood(Geometry& geometry, Callback&& callback)
 {
     for (uint32_t i = 0; i < corner_count; ++i) {
         const Polygon_corner_id prev_polygon_corner_id = first_polygon_corner_id + (corner_count + i - 1) % corner_count;
@@ -298,7 +313,8 @@ void Polygon::for_each_corner_neighborhood(Geometry& geometry, std::function<voi
     }
 }
 
-void Polygon::for_each_corner_neighborhood_const(const Geometry& geometry, std::function<void(Polygon_corner_neighborhood_context_const&)> callback) const
+template <typename Callback>
+inline void Polygon::for_each_corner_neighborhood_const(const Geometry& geometry, Callback&& callback) const
 {
     for (uint32_t i = 0; i < corner_count; ++i) {
         const Polygon_corner_id prev_polygon_corner_id = first_polygon_corner_id + (corner_count + i - 1) % corner_count;
@@ -326,7 +342,8 @@ void Polygon::for_each_corner_neighborhood_const(const Geometry& geometry, std::
     }
 }
 
-void Edge::for_each_polygon(Geometry& geometry, std::function<void(Edge_polygon_context&)> callback)
+template <typename Callback>
+inline void Edge::for_each_polygon(Geometry& geometry, Callback&& callback)
 {
     for (
         Edge_polygon_id edge_polygon_id = first_edge_polygon_id,
@@ -348,7 +365,8 @@ void Edge::for_each_polygon(Geometry& geometry, std::function<void(Edge_polygon_
     }
 }
 
-void Edge::for_each_polygon_const(const Geometry& geometry, std::function<void(Edge_polygon_context_const&)> callback) const
+template <typename Callback>
+inline void Edge::for_each_polygon_const(const Geometry& geometry, Callback&& callback) const
 {
     for (
         Edge_polygon_id edge_polygon_id = first_edge_polygon_id,
@@ -356,12 +374,12 @@ void Edge::for_each_polygon_const(const Geometry& geometry, std::function<void(E
         edge_polygon_id < end;
         ++edge_polygon_id
     ) {
-        const Polygon_id polygon_id = geometry.edge_polygons.at(edge_polygon_id);
+        const Polygon_id polygon_id = geometry.edge_polygons[edge_polygon_id];
         Edge_polygon_context_const context{
             .geometry        = geometry,
             .edge_polygon_id = edge_polygon_id,
             .polygon_id      = polygon_id,
-            .polygon         = geometry.polygons.at(polygon_id)
+            .polygon         = geometry.polygons[polygon_id]
         };
         callback(context);
         if (context.break_) {
@@ -370,4 +388,36 @@ void Edge::for_each_polygon_const(const Geometry& geometry, std::function<void(E
     }
 }
 
+// Range accessors
+
+inline auto Point::corner_ids(const Geometry& geometry) const -> std::span<const Corner_id>
+{
+    return std::span<const Corner_id>{geometry.point_corners.data() + first_point_corner_id, corner_count};
+}
+
+inline auto Point::corner_ids(Geometry& geometry) const -> std::span<Corner_id>
+{
+    return std::span<Corner_id>{geometry.point_corners.data() + first_point_corner_id, corner_count};
 }
+
+inline auto Polygon::corner_ids(const Geometry& geometry) const -> std::span<const Corner_id>
+{
+    return std::span<const Corner_id>{geometry.polygon_corners.data() + first_polygon_corner_id, corner_count};
+}
+
+inline auto Polygon::corner_ids(Geometry& geometry) const -> std::span<Corner_id>
+{
+    return std::span<Corner_id>{geometry.polygon_corners.data() + first_polygon_corner_id, corner_count};
+}
+
+inline auto Edge::polygon_ids(const Geometry& geometry) const -> std::span<const Polygon_id>
+{
+    return std::span<const Polygon_id>{geometry.edge_polygons.data() + first_edge_polygon_id, polygon_count};
+}
+
+inline auto Edge::polygon_ids(Geometry& geometry) const -> std::span<Polygon_id>
+{
+    return std::span<Polygon_id>{geometry.edge_polygons.data() + first_edge_polygon_id, polygon_count};
+}
+
+} // namespace erhe::geometry
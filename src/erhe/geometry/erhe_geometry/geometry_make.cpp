@@ -98,6 +98,10 @@ auto Geometry::make_edge(const Point_id a, const Point_id b) -> Edge_id
     edge.b = b;
     edge.first_edge_polygon_id = m_next_edge_polygon_id;
     edge.polygon_count = 0;
+    if (m_edge_index_edge_count == edge_id) {
+        m_edge_index.insert(a, b, edge_id);
+        ++m_edge_index_edge_count;
+    }
     SPDLOG_LOGGER_TRACE(log, "\tmake_edge(a = {}, b = {}) edge_id = {}", a, b, edge_id);
     return edge_id;
 }
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace erhe::geometry {
+
+// Weighted sources for new keys of a geometry operation.
+//
+// Sources are first appended to a flat pending list, then packed by
+// finalize() into compressed rows (offset table + one source array).
+// This avoids one heap allocation per new key. Order of sources for a
+// key is insertion order, also across multiple finalize() calls, so
+// that weighted sums are evaluated in the same order as they were added.
+template <typename Key_type>
+class Interpolation_weights
+{
+public:
+    class Source
+    {
+    public:
+        float    weight;
+        Key_type key;
+    };
+
+    void add(const Key_type new_key, const float weight, const Key_type old_key)
+    {
+        m_pending.push_back(Pending{new_key, Source{weight, old_key}});
+    }
+
+    void reserve(const std::size_t source_count)
+    {
+        m_pending.reserve(source_count);
+    }
+
+    // Sets key count for following finalize() calls. Keys below the
+    // count without sources get empty rows, sources for keys at or
+    // beyond the count are dropped.
+    void set_key_count(const std::size_t key_count)
+    {
+        m_key_count = key_count;
+        m_key_count_set = true;
+    }
+
+    // Number of rows; valid after finalize()
+    [[nodiscard]] auto get_key_count() const -> std::size_t
+    {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+
+    // Packs pending sources into rows. Cheap when nothing is pending.
+    void finalize()
+    {
+        const std::size_t old_key_count = get_key_count();
+        std::size_t       key_count     = old_key_count;
+        if (m_key_count_set) {
+            key_count = m_key_count;
+        } else {
+            for (const Pending& pending : m_pending) {
+                key_count = std::max(key_count, static_cast<std::size_t>(pending.new_key) + 1);
+            }
+        }
+        if (m_pending.empty() && (key_count == old_key_count) && !m_offsets.empty()) {
+            return;
+        }
+
+        std::vector<std::size_t> offsets(key_count + 1, 0);
+        for (std::size_t key = 0, end = std::min(old_key_count, key_count); key < end; ++key) {
+            offsets[key + 1] += m_offsets[key + 1] - m_offsets[key];
+        }
+        for (const Pending& pending : m_pending) {
+            const std::size_t key = static_cast<std::size_t>(pending.new_key);
+            if (key < key_count) {
+                ++offsets[key + 1];
+            }
+        }
+        for (std::size_t key = 0; key < key_count; ++key) {
+            offsets[key + 1] += offsets[key];
+        }
+
+        std::vector<Source>      sources(offsets[key_count]);
+        std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (std::size_t key = 0, end = std::min(old_key_count, key_count); key < end; ++key) {
+            for (std::size_t i = m_offsets[key], i_end = m_offsets[key + 1]; i < i_end; ++i) {
+                sources[cursor[key]++] = m_sources[i];
+            }
+        }
+        for (const Pending& pending : m_pending) {
+            const std::size_t key = static_cast<std::size_t>(pending.new_key);
+            if (key < key_count) {
+                sources[cursor[key]++] = pending.source;
+            }
+        }
+
+        m_offsets = std::move(offsets);
+        m_sources = std::move(sources);
+        m_pending.clear();
+    }
+
+    // Sources for new key. Valid until next add() / finalize()
+    [[nodiscard]] auto get(const Key_type new_key) const -> std::span<const Source>
+    {
+        assert(m_pending.empty());
+        const std::size_t key = static_cast<std::size_t>(new_key);
+        if (key + 1 >= m_offsets.size()) {
+            return {};
+        }
+        return std::span<const Source>{
+            m_sources.data() + m_offsets[key],
+            m_offsets[key + 1] - m_offsets[key]
+        };
+    }
+
+    void clear()
+    {
+        m_key_count     = 0;
+        m_key_count_set = false;
+        m_pending.clear();
+        m_offsets.clear();
+        m_sources.clear();
+    }
+
+private:
+    class Pending
+    {
+    public:
+        Key_type new_key;
+        Source   source;
+    };
+
+    std::size_t              m_key_count    {0};
+    bool                     m_key_count_set{false};
+    std::vector<Pending>     m_pending;
+    std::vector<std::size_t> m_offsets;
+    std::vector<Source>      m_sources;
+};
+
+} // namespace erhe::geometry
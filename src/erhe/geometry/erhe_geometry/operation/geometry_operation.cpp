@@ -348,11 +348,7 @@ void Geometry_operation::add_point_source(const Point_id new_point_id, const flo
     //     new_point_id, weight, old_point_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_point_id);
-    if (new_point_sources.size() <= i) {
-        new_point_sources.resize(i + s_grow_size);
-    }
-    new_point_sources[i].emplace_back(point_weight, old_point_id);
+    new_point_sources.add(new_point_id, point_weight, old_point_id);
 }
 
 void Geometry_operation::add_point_corner_source(const Point_id new_point_id, const float corner_weight, const Corner_id old_corner_id)
@@ -362,11 +358,7 @@ void Geometry_operation::add_point_corner_source(const Point_id new_point_id, co
     //     new_point_id, weight, old_corner_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_point_id);
-    if (new_point_corner_sources.size() <= i) {
-        new_point_corner_sources.resize(i + s_grow_size);
-    }
-    new_point_corner_sources[new_point_id].emplace_back(corner_weight, old_corner_id);
+    new_point_corner_sources.add(new_point_id, corner_weight, old_corner_id);
 }
 
 void Geometry_operation::add_corner_source(const Corner_id new_corner_id, const float corner_weight, const Corner_id old_corner_id)
@@ -376,11 +368,7 @@ void Geometry_operation::add_corner_source(const Corner_id new_corner_id, const
     //     new_corner_id, weight, old_corner_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_corner_id);
-    if (new_corner_sources.size() <= i) {
-        new_corner_sources.resize(i + s_grow_size);
-    }
-    new_corner_sources[i].emplace_back(corner_weight, old_corner_id);
+    new_corner_sources.add(new_corner_id, corner_weight, old_corner_id);
 }
 
 void Geometry_operation::distribute_corner_sources(const Corner_id new_corner_id, const float point_weight, const Point_id new_point_id)
@@ -390,10 +378,12 @@ void Geometry_operation::distribute_corner_sources(const Corner_id new_corner_id
     //     new_corner_id, weight, new_point_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const auto point_corner_sources = new_point_corner_sources[new_point_id];
-    for (const auto& point_corner_source : point_corner_sources) {
-        const float     corner_weight = point_weight * point_corner_source.first;
-        const Corner_id corner_id     = point_corner_source.second;
+    // Point corner sources are complete once corners are being made;
+    // first call packs them, later calls return immediately.
+    new_point_corner_sources.finalize();
+    for (const auto& point_corner_source : new_point_corner_sources.get(new_point_id)) {
+        const float     corner_weight = point_weight * point_corner_source.weight;
+        const Corner_id corner_id     = point_corner_source.key;
         add_corner_source(new_corner_id, corner_weight, corner_id);
     }
 }
@@ -405,11 +395,7 @@ void Geometry_operation::add_polygon_source(const Polygon_id new_polygon_id, con
     //     new_polygon_id, weight, old_polygon_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_polygon_id);
-    if (new_polygon_sources.size() <= i) {
-        new_polygon_sources.resize(i + s_grow_size);
-    }
-    new_polygon_sources[i].emplace_back(polygon_weight, old_polygon_id);
+    new_polygon_sources.add(new_polygon_id, polygon_weight, old_polygon_id);
 }
 
 void Geometry_operation::add_edge_source(const Edge_id new_edge_id, const float edge_weight, const Edge_id old_edge_id)
@@ -419,11 +405,7 @@ void Geometry_operation::add_edge_source(const Edge_id new_edge_id, const float
     //     new_edge_id, weight, old_edge_id
     // );
     // const erhe::log::Indenter scope_indent;
-    const std::size_t i = static_cast<std::size_t>(new_edge_id);
-    if (new_edge_sources.size() <= i) {
-        new_edge_sources.resize(i + s_grow_size);
-    }
-    new_edge_sources[i].emplace_back(edge_weight, old_edge_id);
+    new_edge_sources.add(new_edge_id, edge_weight, old_edge_id);
 }
 
 void Geometry_operation::build_destination_edges_with_sourcing()
@@ -452,10 +434,14 @@ void Geometry_operation::interpolate_all_property_maps()
 {
     ERHE_PROFILE_FUNCTION();
 
-    new_point_sources  .resize(destination.get_point_count());
-    new_polygon_sources.resize(destination.get_polygon_count());
-    new_corner_sources .resize(destination.get_corner_count());
-    new_edge_sources   .resize(destination.get_edge_count());
+    new_point_sources  .set_key_count(destination.get_point_count());
+    new_polygon_sources.set_key_count(destination.get_polygon_count());
+    new_corner_sources .set_key_count(destination.get_corner_count());
+    new_edge_sources   .set_key_count(destination.get_edge_count());
+    new_point_sources  .finalize();
+    new_polygon_sources.finalize();
+    new_corner_sources .finalize();
+    new_edge_sources   .finalize();
     source.point_attributes()  .interpolate(destination.point_attributes(),   new_point_sources);
     source.polygon_attributes().interpolate(destination.polygon_attributes(), new_polygon_sources);
     source.corner_attributes() .interpolate(destination.corner_attributes(),  new_corner_sources);
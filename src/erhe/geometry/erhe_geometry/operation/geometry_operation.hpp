@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_geometry/interpolation_weights.hpp"
 #include "erhe_geometry/types.hpp"
 
 #include <set>
@@ -21,18 +22,18 @@ public:
     }
 
     static constexpr std::size_t s_grow_size = 4096;
-    Geometry&                                              source;
-    Geometry&                                              destination;
-    std::vector<Point_id  >                                point_old_to_new;
-    std::vector<Polygon_id>                                polygon_old_to_new;
-    std::vector<Corner_id >                                corner_old_to_new;
-    std::vector<Edge_id   >                                edge_old_to_new;
-    std::vector<Point_id  >                                old_polygon_centroid_to_new_points;
-    std::vector<std::vector<std::pair<float, Point_id  >>> new_point_sources;
-    std::vector<std::vector<std::pair<float, Corner_id >>> new_point_corner_sources;
-    std::vector<std::vector<std::pair<float, Corner_id >>> new_corner_sources;
-    std::vector<std::vector<std::pair<float, Polygon_id>>> new_polygon_sources;
-    std::vector<std::vector<std::pair<float, Edge_id   >>> new_edge_sources;
+    Geometry&                           source;
+    Geometry&                           destination;
+    std::vector<Point_id  >             point_old_to_new;
+    std::vector<Polygon_id>             polygon_old_to_new;
+    std::vector<Corner_id >             corner_old_to_new;
+    std::vector<Edge_id   >             edge_old_to_new;
+    std::vector<Point_id  >             old_polygon_centroid_to_new_points;
+    Interpolation_weights<Point_id  >   new_point_sources;
+    Interpolation_weights<Corner_id >   new_point_corner_sources;
+    Interpolation_weights<Corner_id >   new_corner_sources;
+    Interpolation_weights<Polygon_id>   new_polygon_sources;
+    Interpolation_weights<Edge_id   >   new_edge_sources;
 
 private:
     static constexpr std::size_t s_max_edge_point_slots = 300;
@@ -20,6 +20,8 @@ Normalize::Normalize(Geometry& source, Geometry& destination)
     destination.m_next_point_id                      = source.m_next_point_id;
     destination.m_next_polygon_id                    = source.m_next_polygon_id;
     destination.m_next_edge_id                       = source.m_next_edge_id;
+    destination.m_edge_index                         = source.m_edge_index;
+    destination.m_edge_index_edge_count              = source.m_edge_index_edge_count;
     destination.m_next_point_corner_reserve          = source.m_next_point_corner_reserve;
     destination.m_next_polygon_corner_id             = source.m_next_polygon_corner_id;
     destination.m_next_edge_polygon_id               = source.m_next_edge_polygon_id;
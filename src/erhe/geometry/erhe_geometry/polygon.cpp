@@ -63,15 +63,12 @@ auto Polygon::compute_centroid(
     vec3 centroid{0.0f, 0.0f, 0.0f};
     int  count{0};
 
-    for_each_corner_const(
-        geometry,
-        [&geometry, &centroid, &count, &point_locations](const Polygon_corner_context_const& i) {
-            const Point_id point_id = geometry.corners[i.corner_id].point_id;
-            const auto     pos0     = point_locations.get(point_id);
-            centroid += pos0;
-            ++count;
-        }
-    );
+    for (const Corner_id corner_id : corner_ids(geometry)) {
+        const Point_id point_id = geometry.corners[corner_id].point_id;
+        const auto     pos0     = point_locations.get(point_id);
+        centroid += pos0;
+        ++count;
+    }
 
     return centroid /= static_cast<float>(count);
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "erhe_geometry/byte_stream.hpp"
+#include "erhe_geometry/interpolation_weights.hpp"
+
 #include <glm/glm.hpp>
 
 #include <algorithm>
@@ -46,19 +49,25 @@ public:
     virtual void clear     () = 0;
     virtual auto empty     () const -> bool = 0;
     virtual auto size      () const -> std::size_t = 0;
+    virtual auto memory_usage() const -> std::size_t = 0; // Allocated bytes
     virtual auto has       (Key_type key) const -> bool = 0;
     virtual void trim      (std::size_t size) = 0;
     virtual void remap_keys(const std::vector<Key_type>& key_old_to_new) = 0;
 
     virtual void interpolate(
-        Property_map_base<Key_type>*                                destination,
-        const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+        Property_map_base<Key_type>*           destination,
+        const Interpolation_weights<Key_type>& key_new_to_olds
     ) const = 0;
 
     virtual void transform  (const glm::mat4 matrix) = 0;
     virtual void import_from(Property_map_base<Key_type>* source) = 0;
     virtual void import_from(Property_map_base<Key_type>* source, const glm::mat4 transform) = 0;
 
+    // Present keys and values, for Compressed_geometry. read_from()
+    // replaces contents and returns false if the stream is malformed.
+    virtual void write_to (Byte_writer& writer) const = 0;
+    virtual auto read_from(Byte_reader& reader) -> bool = 0;
+
 protected:
     Property_map_base() = default;
 };
@@ -85,26 +94,41 @@ public:
     void clear     () final;
     auto empty     () const -> bool final;
     auto size      () const -> std::size_t final;
+    auto memory_usage() const -> std::size_t final;
     void trim      (std::size_t size) final;
     void remap_keys(const std::vector<Key_type>& key_new_to_old) final;
 
     void interpolate(
-        Property_map_base<Key_type>*                                destination,
-        const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+        Property_map_base<Key_type>*           destination,
+        const Interpolation_weights<Key_type>& key_new_to_olds
     ) const final;
 
     void transform  (const glm::mat4 matrix) final;
     void import_from(Property_map_base<Key_type>* source) final;
     void import_from(Property_map_base<Key_type>* source, const glm::mat4 transform) final;
     auto constructor(const Property_map_descriptor& descriptor) const -> Property_map_base<Key_type>* final;
+    void write_to   (Byte_writer& writer) const final;
+    auto read_from  (Byte_reader& reader) -> bool final;
 
     static constexpr std::size_t s_grow_size = 4096;
 
     std::vector<Value_type> values;
-    std::vector<bool>       present; // Yes, I know vector<bool> has limitations
 
 private:
+    // Presence is a bitset packed to 64-bit words. When every key below
+    // m_key_end is present, the map is dense and bit tests are skipped.
+    [[nodiscard]] auto is_dense  () const -> bool { return m_present_count == m_key_end; }
+    [[nodiscard]] auto is_present(std::size_t i) const -> bool;
+    void set_present             (std::size_t i);
+    void clear_present           (std::size_t i);
+    void resize_storage          (std::size_t size);
+    void update_present_summary  ();
+    void import_present          (const Property_map* source, std::size_t offset);
+
     Property_map_descriptor m_descriptor;
+    std::vector<uint64_t>   m_present;
+    std::size_t             m_present_count{0};
+    std::size_t             m_key_end      {0}; // One past largest present key
 };
 
 } // namespace erhe::geometry
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
 #include <type_traits>
 
 #if !defined(ERHE_PROFILE_FUNCTION)
@@ -25,13 +27,72 @@
 
 namespace erhe::geometry {
 
+template <typename Key_type, typename Value_type>
+inline auto Property_map<Key_type, Value_type>::is_present(const std::size_t i) const -> bool
+{
+    if (i >= m_key_end) {
+        return false;
+    }
+    return is_dense() || (((m_present[i >> 6] >> (i & 63)) & 1u) != 0);
+}
+
+template <typename Key_type, typename Value_type>
+inline void Property_map<Key_type, Value_type>::set_present(const std::size_t i)
+{
+    uint64_t&      word = m_present[i >> 6];
+    const uint64_t bit  = uint64_t{1} << (i & 63);
+    if ((word & bit) == 0) {
+        word |= bit;
+        ++m_present_count;
+    }
+    m_key_end = std::max(m_key_end, i + 1);
+}
+
+template <typename Key_type, typename Value_type>
+inline void Property_map<Key_type, Value_type>::clear_present(const std::size_t i)
+{
+    uint64_t&      word = m_present[i >> 6];
+    const uint64_t bit  = uint64_t{1} << (i & 63);
+    if ((word & bit) != 0) {
+        word &= ~bit;
+        --m_present_count;
+    }
+}
+
+template <typename Key_type, typename Value_type>
+inline void Property_map<Key_type, Value_type>::resize_storage(const std::size_t size)
+{
+    values.resize(size);
+    m_present.resize((size + 63) / 64, 0);
+    // Bits past size in the last word must stay clear
+    if ((size & 63) != 0) {
+        m_present.back() &= (uint64_t{1} << (size & 63)) - 1;
+    }
+}
+
+template <typename Key_type, typename Value_type>
+inline void Property_map<Key_type, Value_type>::update_present_summary()
+{
+    m_present_count = 0;
+    m_key_end       = 0;
+    for (std::size_t word_index = 0, end = m_present.size(); word_index < end; ++word_index) {
+        const uint64_t word = m_present[word_index];
+        if (word != 0) {
+            m_present_count += static_cast<std::size_t>(std::popcount(word));
+            m_key_end = word_index * 64 + 64 - static_cast<std::size_t>(std::countl_zero(word));
+        }
+    }
+}
+
 template <typename Key_type, typename Value_type>
 inline void Property_map<Key_type, Value_type>::clear()
 {
     ERHE_PROFILE_FUNCTION();
 
     values.clear();
-    present.clear();
+    m_present.clear();
+    m_present_count = 0;
+    m_key_end       = 0;
 }
 
 template <typename Key_type, typename Value_type>
@@ -46,23 +107,36 @@ inline auto Property_map<Key_type, Value_type>::size() const -> std::size_t
     return values.size();
 }
 
+template <typename Key_type, typename Value_type>
+inline auto Property_map<Key_type, Value_type>::memory_usage() const -> std::size_t
+{
+    return values.capacity() * sizeof(Value_type) + m_present.capacity() * sizeof(uint64_t);
+}
+
 template <typename Key_type, typename Value_type>
 inline void Property_map<Key_type, Value_type>::trim(std::size_t size)
 {
-    values.resize(size);
-    present.resize(size);
+    resize_storage(size);
+    update_present_summary();
 }
 
 template <typename Key_type, typename Value_type>
 inline void Property_map<Key_type, Value_type>::remap_keys(const std::vector<Key_type>& key_new_to_old)
 {
     const auto old_values  = values;
-    const auto old_present = present;
+    const auto old_present = m_present;
+    const auto was_present = [&old_present](const std::size_t i) -> bool {
+        return (i >> 6) < old_present.size() && (((old_present[i >> 6] >> (i & 63)) & 1u) != 0);
+    };
     for (Key_type new_key = 0, end = static_cast<Key_type>(key_new_to_old.size()); new_key < end; ++new_key) {
-        Key_type old_key = key_new_to_old[new_key];
-        values [new_key] = old_values[old_key];
-        present[new_key] = old_present[old_key];
+        const std::size_t i       = static_cast<std::size_t>(new_key);
+        const Key_type    old_key = key_new_to_old[new_key];
+        values[i] = old_values[old_key];
+        uint64_t&      word = m_present[i >> 6];
+        const uint64_t bit  = uint64_t{1} << (i & 63);
+        word = was_present(static_cast<std::size_t>(old_key)) ? (word | bit) : (word & ~bit);
     }
+    update_present_summary();
 }
 
 template <typename Key_type, typename Value_type>
@@ -72,11 +146,10 @@ inline void Property_map<Key_type, Value_type>::put(Key_type key, Value_type val
 
     const std::size_t i = static_cast<std::size_t>(key);
     if (values.size() <= i) {
-        values.resize(i + s_grow_size);
-        present.resize(i + s_grow_size);
+        resize_storage(i + s_grow_size);
     }
     values[i] = value;
-    present[i] = true;
+    set_present(i);
 }
 
 template <typename Key_type, typename Value_type>
@@ -85,7 +158,7 @@ inline auto Property_map<Key_type, Value_type>::get(Key_type key) const -> Value
     ERHE_PROFILE_FUNCTION();
 
     const std::size_t i = static_cast<std::size_t>(key);
-    if ((values.size() <= i) || !present[i]) {
+    if (!is_present(i)) {
         ERHE_FATAL("Value not found");
     }
     return values[i];
@@ -98,10 +171,9 @@ inline void Property_map<Key_type, Value_type>::erase(Key_type key)
 
     const std::size_t i = static_cast<std::size_t>(key);
     if (values.size() <= i) {
-        values.resize(i + s_grow_size);
-        present.resize(i + s_grow_size);
+        resize_storage(i + s_grow_size);
     }
-    present[i] = false;
+    clear_present(i);
 }
 
 template <typename Key_type, typename Value_type>
@@ -110,7 +182,7 @@ inline auto Property_map<Key_type, Value_type>::maybe_get(Key_type key, Value_ty
     ERHE_PROFILE_FUNCTION();
 
     const std::size_t i = static_cast<size_t>(key);
-    if ((values.size() <= i) || !present[i]) {
+    if (!is_present(i)) {
         return false;
     }
     out_value = values[i];
@@ -123,11 +195,7 @@ inline auto Property_map<Key_type, Value_type>::has(Key_type key) const -> bool
 {
     ERHE_PROFILE_FUNCTION();
 
-    const std::size_t i = static_cast<std::size_t>(key);
-    if ((values.size() <= i) || !present[i]) {
-        return false;
-    }
-    return true;
+    return is_present(static_cast<std::size_t>(key));
 }
 
 template <typename Key_type, typename Value_type>
@@ -140,11 +208,77 @@ inline auto Property_map<Key_type, Value_type>::constructor(const Property_map_d
     return base_ptr;
 }
 
+template <typename Key_type, typename Value_type>
+inline void Property_map<Key_type, Value_type>::write_to(Byte_writer& writer) const
+{
+    ERHE_PROFILE_FUNCTION();
+
+    static_assert(std::is_trivially_copyable_v<Value_type>);
+
+    writer.write_varint(m_key_end);
+    writer.write_varint(m_present_count);
+    if (!is_dense()) {
+        writer.write_bytes(m_present.data(), ((m_key_end + 63) / 64) * sizeof(uint64_t));
+    }
+
+    // Runs of equal values, such as corner attributes copied from polygons,
+    // are stored once
+    for (std::size_t i = 0; i < m_key_end;) {
+        std::size_t run_end = i + 1;
+        while ((run_end < m_key_end) && (std::memcmp(&values[run_end], &values[i], sizeof(Value_type)) == 0)) {
+            ++run_end;
+        }
+        writer.write_varint(run_end - i);
+        writer.write_bytes(&values[i], sizeof(Value_type));
+        i = run_end;
+    }
+}
+
+template <typename Key_type, typename Value_type>
+inline auto Property_map<Key_type, Value_type>::read_from(Byte_reader& reader) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    uint64_t key_end       = 0;
+    uint64_t present_count = 0;
+    if (!reader.read_varint(key_end) || !reader.read_varint(present_count) || (present_count > key_end)) {
+        return false;
+    }
+
+    clear();
+    resize_storage(static_cast<std::size_t>(key_end));
+    if (present_count == key_end) {
+        std::fill(m_present.begin(), m_present.end(), ~uint64_t{0});
+        if ((key_end & 63) != 0) {
+            m_present.back() &= (uint64_t{1} << (key_end & 63)) - 1;
+        }
+    } else if (!reader.read_bytes(m_present.data(), m_present.size() * sizeof(uint64_t))) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < key_end;) {
+        uint64_t   run_length = 0;
+        Value_type value;
+        if (
+            !reader.read_varint(run_length) ||
+            (run_length == 0) ||
+            (run_length > key_end - i) ||
+            !reader.read_bytes(&value, sizeof(Value_type))
+        ) {
+            return false;
+        }
+        std::fill_n(values.begin() + i, static_cast<std::size_t>(run_length), value);
+        i += static_cast<std::size_t>(run_length);
+    }
+    update_present_summary();
+    return (m_present_count == present_count) && (m_key_end == key_end);
+}
+
 template <typename Key_type, typename Value_type>
 inline void
 Property_map<Key_type, Value_type>::interpolate(
-    Property_map_base<Key_type>*                                destination_base,
-    const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+    Property_map_base<Key_type>*           destination_base,
+    const Interpolation_weights<Key_type>& key_new_to_olds
 ) const
 {
     ERHE_PROFILE_FUNCTION();
@@ -160,20 +294,19 @@ Property_map<Key_type, Value_type>::interpolate(
         return;
     }
 
-    for (
-        std::size_t new_key = 0, end = key_new_to_olds.size();
-        new_key < end;
-        ++new_key
-    ) {
-        const std::vector<std::pair<float, Key_type>>& old_keys = key_new_to_olds[new_key];
+    const std::size_t end = key_new_to_olds.get_key_count();
+    if (destination->values.size() < end) {
+        destination->resize_storage(end);
+    }
+    for (std::size_t new_key = 0; new_key < end; ++new_key) {
+        const auto old_keys = key_new_to_olds.get(static_cast<Key_type>(new_key));
 
         SPDLOG_LOGGER_TRACE(log_interpolate, "\tkey = {} from", new_key);
         float sum_weights{0.0f};
-        for (auto j : old_keys) {
-            const Key_type old_key = j.second;
-            SPDLOG_LOGGER_TRACE(log_interpolate, "\t\told key {} weight {}", static_cast<unsigned int>(old_key), static_cast<float>(j.first));
-            if (has(old_key)) {
-                sum_weights += j.first;
+        for (const auto& j : old_keys) {
+            SPDLOG_LOGGER_TRACE(log_interpolate, "\t\told key {} weight {}", static_cast<unsigned int>(j.key), j.weight);
+            if (is_present(static_cast<std::size_t>(j.key))) {
+                sum_weights += j.weight;
             }
         }
 
@@ -185,12 +318,12 @@ Property_map<Key_type, Value_type>::interpolate(
         Value_type new_value(0);
         // TODO
         if constexpr (!std::is_same_v<Value_type, glm::uvec4>) {
-            for (auto j : old_keys) {
-                const float    weight  = j.first;
-                const Key_type old_key = j.second;
+            for (const auto& j : old_keys) {
+                const float       weight  = j.weight;
+                const std::size_t old_key = static_cast<std::size_t>(j.key);
 
-                if (has(old_key)) {
-                    const Value_type old_value = get(old_key);
+                if (is_present(old_key)) {
+                    const Value_type old_value = values[old_key];
                     SPDLOG_LOGGER_TRACE(log_interpolate, "\told value {} weight {}", old_value, (weight / sum_weights));
                     new_value += static_cast<Value_type>((weight / sum_weights) * static_cast<Value_type>(old_value));
                 } else {
@@ -254,6 +387,24 @@ template <>           struct transform_properties<glm::vec2> { static const bool
 template <>           struct transform_properties<glm::vec3> { static const bool is_transformable = true;  };
 template <>           struct transform_properties<glm::vec4> { static const bool is_transformable = true;  };
 
+template <typename Key_type, typename Value_type>
+inline void Property_map<Key_type, Value_type>::import_present(const Property_map* source, const std::size_t offset)
+{
+    // Values have already been appended; offset is the old size
+    resize_storage(std::max(values.size(), offset + source->values.size()));
+    if (source->is_dense()) {
+        for (std::size_t i = 0, end = source->m_key_end; i < end; ++i) {
+            set_present(offset + i);
+        }
+    } else {
+        for (std::size_t i = 0, end = source->m_key_end; i < end; ++i) {
+            if (source->is_present(i)) {
+                set_present(offset + i);
+            }
+        }
+    }
+}
+
 template <typename Key_type, typename Value_type>
 inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Key_type>* source_base)
 {
@@ -265,13 +416,9 @@ inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Ke
         return;
     }
 
-    ERHE_VERIFY(values.size() == present.size());
-    ERHE_VERIFY(source->values.size() == source->present.size());
-
-    values .reserve(values.size()  + source->values.size());
-    present.reserve(present.size() + source->present.size());
-    present.insert(present.end(), source->present.begin(), source->present.end());
+    const std::size_t offset = values.size();
     values.insert(values.end(), source->values.begin(), source->values.end());
+    import_present(source, offset);
 }
 
 template <typename Key_type, typename Value_type>
@@ -279,8 +426,6 @@ inline void Property_map<Key_type, Value_type>::transform(const glm::mat4 transf
 {
     ERHE_PROFILE_FUNCTION();
 
-    ERHE_VERIFY(values.size() == present.size());
-
     if constexpr(transform_properties<Value_type>::is_transformable) {
         switch (m_descriptor.transform_mode) {
             //using enum Transform_mode;
@@ -290,8 +435,8 @@ inline void Property_map<Key_type, Value_type>::transform(const glm::mat4 transf
             }
 
             case Transform_mode::position: {
-                for (std::size_t i = 0, end = values.size(); i < end; ++i) {
-                    if (present[i]) {
+                for (std::size_t i = 0, end = m_key_end; i < end; ++i) {
+                    if (is_present(i)) {
                         values[i] = apply_transform(values[i], transform, 1.0f);
                     }
                 }
@@ -302,8 +447,8 @@ inline void Property_map<Key_type, Value_type>::transform(const glm::mat4 transf
             case Transform_mode::direction: {
                 if constexpr (std::is_same_v<Value_type, glm::vec3>) {
                     const glm::mat4 inverse_transpose_transform = glm::inverse(glm::transpose(transform));
-                    for (std::size_t i = 0, end = values.size(); i < end; ++i) {
-                        if (present[i]) {
+                    for (std::size_t i = 0, end = m_key_end; i < end; ++i) {
+                        if (is_present(i)) {
                             values[i] = glm::normalize(
                                 apply_transform(
                                     values[i],
@@ -321,8 +466,8 @@ inline void Property_map<Key_type, Value_type>::transform(const glm::mat4 transf
             case Transform_mode::direction_vec3_float: {
                 if constexpr (std::is_same_v<Value_type, glm::vec4>) {
                     const glm::mat4 inverse_transpose_transform = glm::inverse(glm::transpose(transform));
-                    for (std::size_t i = 0, end = values.size(); i < end; ++i) {
-                        if (present[i]) {
+                    for (std::size_t i = 0, end = m_key_end; i < end; ++i) {
+                        if (is_present(i)) {
                             values[i] = glm::vec4{
                                 glm::normalize(
                                     apply_transform(glm::vec3{values[i]}, inverse_transpose_transform, 0.0f)
@@ -349,14 +494,8 @@ inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Ke
         return;
     }
 
-    ERHE_VERIFY(values.size() == present.size());
-    ERHE_VERIFY(source->values.size() == source->present.size());
-
-    const auto combined_values_size = values.size()  + source->values.size();
-    const auto combined_present_size = present.size() + source->present.size();
-    values .reserve(combined_values_size);
-    present.reserve(combined_present_size);
-    present.insert(present.end(), source->present.begin(), source->present.end());
+    const std::size_t offset = values.size();
+    values.reserve(offset + source->values.size());
     if constexpr(!transform_properties<Value_type>::is_transformable) {
         values.insert(values.end(), source->values.begin(), source->values.end());
     } else {
@@ -371,7 +510,7 @@ inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Ke
             case Transform_mode::position: {
                 for (std::size_t i = 0, end = source->values.size(); i < end; ++i) {
                     const Value_type source_value = source->values[i];
-                    const Value_type result       = present[i] ? apply_transform(source_value, transform, 1.0f) : Value_type{};
+                    const Value_type result       = source->is_present(i) ? apply_transform(source_value, transform, 1.0f) : Value_type{};
                     values.push_back(result);
                 }
                 break;
@@ -383,7 +522,7 @@ inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Ke
                     const glm::mat4 inverse_transpose_transform = glm::inverse(glm::transpose(transform));
                     for (std::size_t i = 0, end = source->values.size(); i < end; ++i) {
                         const Value_type source_value = source->values[i];
-                        const Value_type result       = present[i]
+                        const Value_type result       = source->is_present(i)
                             ? glm::normalize(apply_transform(source_value, inverse_transpose_transform, 0.0f))
                             : Value_type{};
                         values.push_back(result);
@@ -397,7 +536,7 @@ inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Ke
                 if constexpr (std::is_same_v<Value_type, glm::vec4>) {
                     const glm::mat4 inverse_transpose_transform = glm::inverse(glm::transpose(transform));
                     for (std::size_t i = 0, end = source->values.size(); i < end; ++i) {
-                        if (present[i]) {
+                        if (source->is_present(i)) {
                             const Value_type source_value     = source->values[i];
                             const glm::vec3  transformed_vec3 = glm::normalize(apply_transform(glm::vec3{source_value}, inverse_transpose_transform, 0.0f));
                             const Value_type result           = glm::vec4{transformed_vec3, source_value.w};
@@ -411,6 +550,7 @@ inline void Property_map<Key_type, Value_type>::import_from(Property_map_base<Ke
             }
         }
     }
+    import_present(source, offset);
 }
 
 } // namespace erhe::geometry
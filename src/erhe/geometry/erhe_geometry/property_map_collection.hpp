@@ -50,6 +50,8 @@ public:
 
     auto size() const -> size_t;
 
+    auto memory_usage() const -> size_t;
+
     template <typename Value_type>
     auto create( const Property_map_descriptor& descriptor) -> Property_map<Key_type, Value_type>*;
 
@@ -71,8 +73,8 @@ public:
     void trim      (size_t size);
     void remap_keys(const std::vector<Key_type>& key_new_to_old);
     void interpolate(
-        Property_map_collection<Key_type>&                          destination,
-        const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds
+        Property_map_collection<Key_type>&     destination,
+        const Interpolation_weights<Key_type>& key_new_to_olds
     );
 
     void merge_to            (Property_map_collection<Key_type>& source, const glm::mat4 transform);
@@ -80,6 +82,14 @@ public:
     void transform           (const glm::mat4 matrix);
     auto clone_with_transform(const glm::mat4 matrix) -> Property_map_collection<Key_type>;
 
+    // Maps with same descriptors and value types, without values
+    auto clone_empty() const -> Property_map_collection<Key_type>;
+
+    // Values of every map in insertion order. read_from() expects the
+    // maps of the written collection, as made by clone_empty().
+    void write_to (Byte_writer& writer) const;
+    auto read_from(Byte_reader& reader) -> bool;
+
 private:
     Collection_type m_entries;
 };
@@ -35,6 +35,16 @@ inline auto Property_map_collection<Key_type>::size() const -> size_t
     return m_entries.size();
 }
 
+template <typename Key_type>
+inline auto Property_map_collection<Key_type>::memory_usage() const -> size_t
+{
+    size_t result = m_entries.capacity() * sizeof(Entry);
+    for (const auto& entry : m_entries) {
+        result += entry.value->memory_usage();
+    }
+    return result;
+}
+
 template <typename Key_type>
 inline void Property_map_collection<Key_type>::insert(Property_map_base<Key_type>* map)
 {
@@ -176,8 +186,8 @@ inline void Property_map_collection<Key_type>::remap_keys(const std::vector<Key_
 template <typename Key_type>
 inline void
 Property_map_collection<Key_type>::interpolate(
-    Property_map_collection<Key_type>&                          destination,
-    const std::vector<std::vector<std::pair<float, Key_type>>>& key_new_to_olds)
+    Property_map_collection<Key_type>&     destination,
+    const Interpolation_weights<Key_type>& key_new_to_olds)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -256,6 +266,41 @@ inline auto Property_map_collection<Key_type>::clone_with_transform(const glm::m
     return result;
 }
 
+template <typename Key_type>
+inline auto Property_map_collection<Key_type>::clone_empty() const -> Property_map_collection<Key_type>
+{
+    Property_map_collection<Key_type> result;
+    for (const auto& entry : m_entries) {
+        const Property_map_base<Key_type>* this_map = entry.value.get();
+        result.insert(this_map->constructor(this_map->descriptor()));
+    }
+    return result;
+}
+
+template <typename Key_type>
+inline void Property_map_collection<Key_type>::write_to(Byte_writer& writer) const
+{
+    writer.write_varint(m_entries.size());
+    for (const auto& entry : m_entries) {
+        entry.value->write_to(writer);
+    }
+}
+
+template <typename Key_type>
+inline auto Property_map_collection<Key_type>::read_from(Byte_reader& reader) -> bool
+{
+    uint64_t entry_count = 0;
+    if (!reader.read_varint(entry_count) || (entry_count != m_entries.size())) {
+        return false;
+    }
+    for (auto& entry : m_entries) {
+        if (!entry.value->read_from(reader)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace erhe::geometry
 
 #ifdef ERHE_PROFILE_FUNCTION_DUMMY
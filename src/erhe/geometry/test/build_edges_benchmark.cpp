@@ -0,0 +1,126 @@
+// Benchmark for Geometry::build_edges() and edge lookup
+//
+// Builds a triangulated grid of about one million triangles: 708 quads per
+// side by default, two triangles each. The grid has boundary edges, so
+// build_edges() also runs its second pass, which used to scan all edges
+// for every boundary corner. Reports build_edges() with manifold and
+// non-manifold settings, and find_edge_id() for every edge, using the
+// index kept by build_edges() and after a lazy rebuild.
+
+#include "erhe_geometry/compressed_geometry.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace erhe::geometry;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* label, const std::size_t element_count, const double seconds)
+{
+    fmt::print(
+        "{:<28} {:>9.3f} ms {:>8.2f} ns/element\n",
+        label, seconds * 1000.0, seconds * 1.0e9 / static_cast<double>(element_count)
+    );
+}
+
+auto make_grid(const uint32_t side) -> Geometry
+{
+    Geometry geometry{"grid"};
+    for (uint32_t y = 0; y <= side; ++y) {
+        for (uint32_t x = 0; x <= side; ++x) {
+            geometry.make_point(static_cast<float>(x), 0.0f, static_cast<float>(y));
+        }
+    }
+    const uint32_t row = side + 1;
+    for (uint32_t y = 0; y < side; ++y) {
+        for (uint32_t x = 0; x < side; ++x) {
+            const Point_id p00 = y * row + x;
+            const Point_id p10 = p00 + 1;
+            const Point_id p01 = p00 + row;
+            const Point_id p11 = p01 + 1;
+            geometry.make_polygon({p00, p01, p11});
+            geometry.make_polygon({p00, p11, p10});
+        }
+    }
+    geometry.make_point_corners();
+    return geometry;
+}
+
+// Returns number of edges found, to keep lookups from being optimized away
+auto find_all_edges(Geometry& geometry) -> uint32_t
+{
+    uint32_t found_count = 0;
+    for (Edge_id edge_id = 0; edge_id < geometry.get_edge_count(); ++edge_id) {
+        const Edge& edge = geometry.edges[edge_id];
+        const std::optional<Edge_id> found_id = geometry.find_edge_id(edge.b, edge.a);
+        if (found_id == std::optional<Edge_id>{edge_id}) {
+            ++found_count;
+        }
+    }
+    return found_count;
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const uint32_t side = (argc > 1) ? static_cast<uint32_t>(std::stoul(argv[1])) : 708;
+
+    erhe::log::initialize_log_sinks();
+    erhe::geometry::initialize_logging();
+
+    auto start = Clock::now();
+    Geometry geometry = make_grid(side);
+    report("make grid", geometry.get_polygon_count(), seconds_since(start));
+    fmt::print("{} triangles, {} points\n", geometry.get_polygon_count(), geometry.get_point_count());
+
+    start = Clock::now();
+    geometry.build_edges(true);
+    report("build_edges() manifold", geometry.get_corner_count(), seconds_since(start));
+
+    start = Clock::now();
+    geometry.build_edges(false);
+    report("build_edges() non-manifold", geometry.get_corner_count(), seconds_since(start));
+    fmt::print("{} edges\n", geometry.get_edge_count());
+
+    // Expected edge count: horizontal, vertical and diagonal edges
+    const uint32_t expected_edge_count = 2 * side * (side + 1) + side * side;
+    bool ok = (geometry.get_edge_count() == expected_edge_count);
+    if (!ok) {
+        fmt::print(stderr, "edge count {}, expected {}\n", geometry.get_edge_count(), expected_edge_count);
+    }
+
+    start = Clock::now();
+    uint32_t found_count = find_all_edges(geometry);
+    report("find_edge_id()", geometry.get_edge_count(), seconds_since(start));
+    ok = ok && (found_count == geometry.get_edge_count());
+
+    // Decompressed geometry has no edge index; first lookup rebuilds it
+    const Compressed_geometry compressed{geometry};
+    Geometry decompressed = compressed.decompress();
+    start = Clock::now();
+    found_count = find_all_edges(decompressed);
+    report("find_edge_id() lazy rebuild", decompressed.get_edge_count(), seconds_since(start));
+    ok = ok && (found_count == decompressed.get_edge_count());
+
+    if (!ok) {
+        fmt::print(stderr, "edge lookup failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+// Round trip tests for Compressed_geometry.
+//
+// A subdivided sphere with edges, point corners and attributes of several
+// value types, dense and sparse, is compressed and decompressed. Checks
+// that every element, present key and attribute value is restored exactly,
+// that edge lookup works on the decompressed geometry, that derived data
+// serials are kept, and that compressed size is well below the memory used
+// by the geometry.
+
+#include "erhe_geometry/compressed_geometry.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_geometry/operation/catmull_clark_subdivision.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using namespace erhe::geometry;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+template <typename T>
+auto same_elements(const std::vector<T>& a, const std::vector<T>& b, const std::size_t count) -> bool
+{
+    return (a.size() >= count) && (b.size() >= count) && (std::memcmp(a.data(), b.data(), count * sizeof(T)) == 0);
+}
+
+template <typename Value_type, typename Key_type>
+auto same_property_map(
+    const Property_map_collection<Key_type>& a_collection,
+    const Property_map_collection<Key_type>& b_collection,
+    const Property_map_descriptor&           descriptor,
+    const std::size_t                        key_count
+) -> bool
+{
+    const Property_map<Key_type, Value_type>* a = a_collection.template find<Value_type>(descriptor);
+    const Property_map<Key_type, Value_type>* b = b_collection.template find<Value_type>(descriptor);
+    if ((a == nullptr) || (b == nullptr)) {
+        return (a == nullptr) && (b == nullptr);
+    }
+    for (std::size_t i = 0; i < key_count; ++i) {
+        const Key_type key = static_cast<Key_type>(i);
+        if (a->has(key) != b->has(key)) {
+            return false;
+        }
+        if (a->has(key)) {
+            const Value_type a_value = a->get(key);
+            const Value_type b_value = b->get(key);
+            if (std::memcmp(&a_value, &b_value, sizeof(Value_type)) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto make_test_geometry() -> Geometry
+{
+    Geometry sphere = shapes::make_sphere(1.0, 24, 12);
+    Geometry geometry = operation::catmull_clark_subdivision(sphere);
+    geometry.compute_polygon_normals();
+    geometry.compute_polygon_centroids();
+    geometry.build_edges();
+
+    // Flat corner normals, runs of equal values
+    const auto* polygon_normals = geometry.polygon_attributes().find<glm::vec3>(c_polygon_normals);
+    auto*       corner_normals  = geometry.corner_attributes().find_or_create<glm::vec3>(c_corner_normals);
+    geometry.for_each_polygon_const([&](const Geometry::Polygon_context_const& i) {
+        for (const Corner_id corner_id : i.polygon.corner_ids(geometry)) {
+            corner_normals->put(corner_id, polygon_normals->get(i.polygon_id));
+        }
+    });
+
+    // Sparse maps
+    auto* point_colors        = geometry.point_attributes().create<glm::vec4>(c_point_colors);
+    auto* point_joint_indices = geometry.point_attributes().create<glm::uvec4>(c_point_joint_indices);
+    for (Point_id point_id = 0; point_id < geometry.get_point_count(); point_id += 3) {
+        const float f = static_cast<float>(point_id);
+        point_colors->put(point_id, glm::vec4{f, 0.5f * f, 0.25f, 1.0f});
+        if ((point_id % 2) == 0) {
+            point_joint_indices->put(point_id, glm::uvec4{point_id, point_id + 1, 7u, 0u});
+        }
+    }
+    return geometry;
+}
+
+void test_round_trip()
+{
+    Geometry geometry = make_test_geometry();
+    const Compressed_geometry compressed{geometry};
+    Geometry restored = compressed.decompress();
+
+    check(restored.name                       == geometry.name,                       "name");
+    check(restored.get_corner_count        () == geometry.get_corner_count        (), "corner count");
+    check(restored.get_point_count         () == geometry.get_point_count         (), "point count");
+    check(restored.get_polygon_count       () == geometry.get_polygon_count       (), "polygon count");
+    check(restored.get_edge_count          () == geometry.get_edge_count          (), "edge count");
+    check(restored.get_point_corner_count  () == geometry.get_point_corner_count  (), "point corner count");
+    check(restored.get_polygon_corner_count() == geometry.get_polygon_corner_count(), "polygon corner count");
+
+    check(same_elements(restored.corners,         geometry.corners,         geometry.get_corner_count()),         "corners");
+    check(same_elements(restored.points,          geometry.points,          geometry.get_point_count()),          "points");
+    check(same_elements(restored.polygons,        geometry.polygons,        geometry.get_polygon_count()),        "polygons");
+    check(same_elements(restored.edges,           geometry.edges,           geometry.get_edge_count()),           "edges");
+    check(same_elements(restored.point_corners,   geometry.point_corners,   geometry.get_point_corner_count()),   "point corners");
+    check(same_elements(restored.polygon_corners, geometry.polygon_corners, geometry.get_polygon_corner_count()), "polygon corners");
+    check(same_elements(restored.edge_polygons,   geometry.edge_polygons,   geometry.m_next_edge_polygon_id),     "edge polygons");
+
+    const std::size_t point_count   = geometry.get_point_count();
+    const std::size_t corner_count  = geometry.get_corner_count();
+    const std::size_t polygon_count = geometry.get_polygon_count();
+    check(restored.point_attributes  ().size() == geometry.point_attributes  ().size(), "point map count");
+    check(restored.corner_attributes ().size() == geometry.corner_attributes ().size(), "corner map count");
+    check(restored.polygon_attributes().size() == geometry.polygon_attributes().size(), "polygon map count");
+    check(same_property_map<glm::vec3 >(restored.point_attributes  (), geometry.point_attributes  (), c_point_locations,     point_count),   "point locations");
+    check(same_property_map<glm::vec3 >(restored.point_attributes  (), geometry.point_attributes  (), c_point_normals,       point_count),   "point normals");
+    check(same_property_map<glm::vec4 >(restored.point_attributes  (), geometry.point_attributes  (), c_point_colors,        point_count),   "sparse point colors");
+    check(same_property_map<glm::uvec4>(restored.point_attributes  (), geometry.point_attributes  (), c_point_joint_indices, point_count),   "sparse point joint indices");
+    check(same_property_map<glm::vec3 >(restored.corner_attributes (), geometry.corner_attributes (), c_corner_normals,      corner_count),  "corner normals");
+    check(same_property_map<glm::vec3 >(restored.polygon_attributes(), geometry.polygon_attributes(), c_polygon_normals,     polygon_count), "polygon normals");
+    check(same_property_map<glm::vec3 >(restored.polygon_attributes(), geometry.polygon_attributes(), c_polygon_centroids,   polygon_count), "polygon centroids");
+
+    check(restored.get_serial() == geometry.get_serial(),                   "serial");
+    check(restored.has_polygon_normals() == geometry.has_polygon_normals(), "polygon normals serial");
+    check(restored.has_edges(),                                             "edges serial");
+
+    bool edges_found = true;
+    for (Edge_id edge_id = 0; edge_id < geometry.get_edge_count(); ++edge_id) {
+        const Edge& edge = geometry.edges[edge_id];
+        const std::optional<Edge_id> found = restored.find_edge_id(edge.a, edge.b);
+        edges_found = edges_found && found.has_value() && (found.value() == edge_id);
+    }
+    check(edges_found, "find_edge_id() on decompressed geometry");
+
+    // Decompressed geometry can be compressed again to the same bytes
+    const Compressed_geometry compressed_again{restored};
+    check(compressed_again.get_byte_count() == compressed.get_byte_count(), "stable compressed size");
+
+    const std::size_t geometry_bytes   = geometry.get_memory_usage();
+    const std::size_t compressed_bytes = compressed.get_memory_usage();
+    fmt::print(
+        "{} polygons: geometry {} bytes, compressed {} bytes ({:.1f}%)\n",
+        polygon_count, geometry_bytes, compressed_bytes,
+        100.0 * static_cast<double>(compressed_bytes) / static_cast<double>(geometry_bytes)
+    );
+    check(2 * compressed_bytes < geometry_bytes, "compressed size below half of geometry memory usage");
+}
+
+void test_empty()
+{
+    Geometry geometry{"empty"};
+    const Compressed_geometry compressed{geometry};
+    Geometry restored = compressed.decompress();
+    check(restored.name == "empty",            "empty: name");
+    check(restored.get_point_count  () == 0,   "empty: no points");
+    check(restored.get_polygon_count() == 0,   "empty: no polygons");
+    check(restored.point_attributes().size() == 0, "empty: no attributes");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::geometry::initialize_logging();
+
+    test_round_trip();
+    test_empty();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("compressed geometry tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+// Tests for Edge_index and edge lookup in Geometry.
+//
+// Edge_index: inserts enough point pairs to rehash several times and
+// checks that every pair is found in either order, that missing pairs and
+// degenerate pairs are not found, that the first edge wins for duplicate
+// pairs, that reserve() avoids rehash and that clear() empties the index
+// while keeping it usable.
+//
+// Geometry: checks that find_edge() and find_edge_id() find every edge made
+// by build_edges(), and that the edge index is rebuilt lazily when edges
+// exist without it, as after decompress, including edges made with
+// make_edge() after that.
+
+#include "erhe_geometry/compressed_geometry.hpp"
+#include "erhe_geometry/edge_index.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_geometry/operation/catmull_clark_subdivision.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace erhe::geometry;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+// Distinct ordered pairs a < b, in random order
+auto make_point_pairs(const std::size_t count) -> std::vector<std::pair<Point_id, Point_id>>
+{
+    std::vector<std::pair<Point_id, Point_id>> pairs;
+    pairs.reserve(count);
+    for (Point_id a = 0; pairs.size() < count; ++a) {
+        for (Point_id b = a + 1; (b < a + 8) && (pairs.size() < count); ++b) {
+            pairs.emplace_back(a, b);
+        }
+    }
+    std::mt19937 random_engine{1234};
+    std::shuffle(pairs.begin(), pairs.end(), random_engine);
+    return pairs;
+}
+
+void test_edge_index()
+{
+    const std::vector<std::pair<Point_id, Point_id>> pairs = make_point_pairs(100'000);
+
+    Edge_index edge_index;
+    check(!edge_index.find(0, 1).has_value(), "edge index: empty index finds nothing");
+
+    // Starts from empty, so inserts rehash many times
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        edge_index.insert(pairs[i].first, pairs[i].second, static_cast<Edge_id>(i));
+    }
+    check(edge_index.size() == pairs.size(), "edge index: size matches inserted pair count");
+
+    bool all_found   = true;
+    bool all_swapped = true;
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        const std::optional<Edge_id> edge_id         = edge_index.find(pairs[i].first,  pairs[i].second);
+        const std::optional<Edge_id> swapped_edge_id = edge_index.find(pairs[i].second, pairs[i].first);
+        all_found   = all_found   && edge_id        .has_value() && (edge_id        .value() == i);
+        all_swapped = all_swapped && swapped_edge_id.has_value() && (swapped_edge_id.value() == i);
+    }
+    check(all_found,   "edge index: every inserted pair is found after rehash");
+    check(all_swapped, "edge index: pairs are found with points in either order");
+
+    bool none_missing = true;
+    for (Point_id a = 0; a < 1000; ++a) {
+        none_missing = none_missing && !edge_index.find(a, a + 100).has_value();
+    }
+    check(none_missing,                       "edge index: pairs not inserted are not found");
+    check(!edge_index.find(5, 5).has_value(), "edge index: degenerate pair is not found");
+
+    // Non-manifold input may insert the same pair again; first edge wins
+    edge_index.insert(pairs[0].first, pairs[0].second, 999'999);
+    check(edge_index.size() == pairs.size(), "edge index: duplicate pair does not grow index");
+    check(edge_index.find(pairs[0].first, pairs[0].second) == std::optional<Edge_id>{0}, "edge index: first edge wins for duplicate pair");
+
+    // clear() keeps capacity, index is usable afterwards
+    const std::size_t memory_usage = edge_index.memory_usage();
+    edge_index.clear();
+    check(edge_index.size() == 0,                                        "edge index: clear() empties index");
+    check(!edge_index.find(pairs[0].first, pairs[0].second).has_value(), "edge index: clear() removes pairs");
+    check(edge_index.memory_usage() == memory_usage,                     "edge index: clear() keeps capacity");
+    edge_index.insert(3, 7, 42);
+    check(edge_index.find(7, 3) == std::optional<Edge_id>{42},           "edge index: insert after clear()");
+
+    // reserve() sizes for load factor 1/2, so no rehash up to that count
+    Edge_index reserved;
+    reserved.reserve(pairs.size());
+    const std::size_t reserved_memory_usage = reserved.memory_usage();
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        reserved.insert(pairs[i].first, pairs[i].second, static_cast<Edge_id>(i));
+    }
+    check(reserved.memory_usage() == reserved_memory_usage, "edge index: no rehash up to reserved count");
+    check(reserved.find(pairs.back().first, pairs.back().second) == std::optional<Edge_id>{static_cast<Edge_id>(pairs.size() - 1)}, "edge index: find after reserve()");
+}
+
+auto make_test_geometry() -> Geometry
+{
+    Geometry sphere = shapes::make_sphere(1.0, 12, 8);
+    Geometry geometry = operation::catmull_clark_subdivision(sphere);
+    geometry.build_edges();
+    return geometry;
+}
+
+auto all_edges_found(Geometry& geometry) -> bool
+{
+    for (Edge_id edge_id = 0; edge_id < geometry.get_edge_count(); ++edge_id) {
+        const Edge edge = geometry.edges[edge_id];
+        const std::optional<Edge_id> found_id         = geometry.find_edge_id(edge.a, edge.b);
+        const std::optional<Edge_id> found_swapped_id = geometry.find_edge_id(edge.b, edge.a);
+        const std::optional<Edge>    found_edge       = geometry.find_edge(edge.a, edge.b);
+        if (
+            (found_id != std::optional<Edge_id>{edge_id}) ||
+            (found_swapped_id != std::optional<Edge_id>{edge_id}) ||
+            !found_edge.has_value() ||
+            (found_edge->a != edge.a) ||
+            (found_edge->b != edge.b)
+        ) {
+            fmt::print(stderr, "edge {} ({} - {}) not found\n", edge_id, edge.a, edge.b);
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_geometry_find_edge()
+{
+    Geometry geometry = make_test_geometry();
+    check(geometry.get_edge_count() > 0,         "find_edge: geometry has edges");
+    check(all_edges_found(geometry),             "find_edge: every edge from build_edges() is found");
+    check(!geometry.find_edge(0, 0).has_value(), "find_edge: degenerate pair is not found");
+
+    // Decompressed geometry has edges but no edge index; first lookup
+    // rebuilds it
+    const Compressed_geometry compressed{geometry};
+    Geometry decompressed = compressed.decompress();
+    check(decompressed.get_edge_count() == geometry.get_edge_count(), "find_edge: decompressed edge count");
+    check(all_edges_found(decompressed),                               "find_edge: lazy rebuild finds every edge");
+
+    // Edges made with make_edge() after lazy rebuild are indexed
+    const Point_id a = decompressed.make_point(0.0f, 0.0f, 0.0f);
+    const Point_id b = decompressed.make_point(1.0f, 0.0f, 0.0f);
+    const Edge_id new_edge_id = decompressed.make_edge(a, b);
+    check(decompressed.find_edge_id(b, a) == std::optional<Edge_id>{new_edge_id}, "find_edge: edge made after rebuild is found");
+
+    // Edges made with make_edge() when index is out of date are found
+    // after lazy rebuild
+    Geometry decompressed_again = compressed.decompress();
+    const Point_id c = decompressed_again.make_point(0.0f, 0.0f, 0.0f);
+    const Point_id d = decompressed_again.make_point(1.0f, 0.0f, 0.0f);
+    const Edge_id late_edge_id = decompressed_again.make_edge(c, d);
+    check(decompressed_again.find_edge_id(c, d) == std::optional<Edge_id>{late_edge_id}, "find_edge: edge made before rebuild is found");
+    check(all_edges_found(decompressed_again),                                           "find_edge: rebuild keeps earlier edges");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::geometry::initialize_logging();
+
+    test_edge_index();
+    test_geometry_find_edge();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("edge index tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+// Benchmark for erhe::geometry visitors on a subdivided sphere
+//
+// Each workload runs the same loop three ways:
+// - template visitor with a lambda (inlinable)
+// - template visitor with a std::function callback, the cost of the
+//   previous type erased visitor API
+// - direct iteration over the span accessor, where one exists
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_geometry/operation/catmull_clark_subdivision.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace erhe::geometry;
+
+constexpr int c_repeat_count = 10;
+
+template <typename Function>
+auto measure(const char* label, const std::size_t element_count, Function&& function) -> uint64_t
+{
+    uint64_t result = function(); // warm up
+    const auto start = Clock::now();
+    for (int i = 0; i < c_repeat_count; ++i) {
+        result += function();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count() / c_repeat_count;
+    fmt::print("    {:<16} {:>9.3f} ms {:>8.2f} ns/element\n", label, seconds * 1000.0, seconds * 1.0e9 / static_cast<double>(element_count));
+    return result;
+}
+
+// Point corners: sum of polygon ids, as in smooth normal accumulation
+void benchmark_point_corners(const Geometry& geometry)
+{
+    fmt::print("Point::for_each_corner_const, {} points\n", geometry.get_point_count());
+    const std::size_t element_count = geometry.point_corners.size();
+    uint64_t checksum[3]{};
+
+    checksum[0] = measure("lambda", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        for (const Point& point : geometry.points) {
+            point.for_each_corner_const(geometry, [&sum](const Point::Point_corner_context_const& i) {
+                sum += i.corner.polygon_id;
+            });
+        }
+        return sum;
+    });
+    checksum[1] = measure("std::function", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        const std::function<void(const Point::Point_corner_context_const&)> callback =
+            [&sum](const Point::Point_corner_context_const& i) {
+                sum += i.corner.polygon_id;
+            };
+        for (const Point& point : geometry.points) {
+            point.for_each_corner_const(geometry, callback);
+        }
+        return sum;
+    });
+    checksum[2] = measure("span", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        for (const Point& point : geometry.points) {
+            for (const Corner_id corner_id : point.corner_ids(geometry)) {
+                sum += geometry.corners[corner_id].polygon_id;
+            }
+        }
+        return sum;
+    });
+    if ((checksum[0] != checksum[1]) || (checksum[0] != checksum[2])) {
+        fmt::print(stderr, "Point corner checksums differ\n");
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Polygon corner neighborhoods: previous / next point pairs, as in normal and tangent computation
+void benchmark_polygon_corner_neighborhood(const Geometry& geometry)
+{
+    fmt::print("Polygon::for_each_corner_neighborhood_const, {} polygons\n", geometry.get_polygon_count());
+    const std::size_t element_count = geometry.polygon_corners.size();
+    uint64_t checksum[2]{};
+
+    checksum[0] = measure("lambda", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        for (const Polygon& polygon : geometry.polygons) {
+            polygon.for_each_corner_neighborhood_const(geometry, [&sum](const Polygon::Polygon_corner_neighborhood_context_const& i) {
+                sum += i.prev_corner.point_id ^ i.next_corner.point_id;
+            });
+        }
+        return sum;
+    });
+    checksum[1] = measure("std::function", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        const std::function<void(const Polygon::Polygon_corner_neighborhood_context_const&)> callback =
+            [&sum](const Polygon::Polygon_corner_neighborhood_context_const& i) {
+                sum += i.prev_corner.point_id ^ i.next_corner.point_id;
+            };
+        for (const Polygon& polygon : geometry.polygons) {
+            polygon.for_each_corner_neighborhood_const(geometry, callback);
+        }
+        return sum;
+    });
+    if (checksum[0] != checksum[1]) {
+        fmt::print(stderr, "Polygon corner neighborhood checksums differ\n");
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+// Edge polygons: adjacent polygon ids, as in edge based operations
+void benchmark_edge_polygons(const Geometry& geometry)
+{
+    fmt::print("Edge::for_each_polygon_const, {} edges\n", geometry.get_edge_count());
+    const std::size_t element_count = geometry.edge_polygons.size();
+    uint64_t checksum[3]{};
+
+    checksum[0] = measure("lambda", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        for (const Edge& edge : geometry.edges) {
+            edge.for_each_polygon_const(geometry, [&sum](const Edge::Edge_polygon_context_const& i) {
+                sum += i.polygon_id + i.polygon.corner_count;
+            });
+        }
+        return sum;
+    });
+    checksum[1] = measure("std::function", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        const std::function<void(const Edge::Edge_polygon_context_const&)> callback =
+            [&sum](const Edge::Edge_polygon_context_const& i) {
+                sum += i.polygon_id + i.polygon.corner_count;
+            };
+        for (const Edge& edge : geometry.edges) {
+            edge.for_each_polygon_const(geometry, callback);
+        }
+        return sum;
+    });
+    checksum[2] = measure("span", element_count, [&geometry]() -> uint64_t {
+        uint64_t sum = 0;
+        for (const Edge& edge : geometry.edges) {
+            for (const Polygon_id polygon_id : edge.polygon_ids(geometry)) {
+                sum += polygon_id + geometry.polygons[polygon_id].corner_count;
+            }
+        }
+        return sum;
+    });
+    if ((checksum[0] != checksum[1]) || (checksum[0] != checksum[2])) {
+        fmt::print(stderr, "Edge polygon checksums differ\n");
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const int subdivision_count = (argc > 1) ? std::stoi(argv[1]) : 4;
+
+    erhe::log::initialize_log_sinks();
+    erhe::geometry::initialize_logging();
+
+    // Geometry is not move assignable
+    auto sphere = std::make_unique<Geometry>(erhe::geometry::shapes::make_sphere(1.0, 32, 16));
+    for (int i = 0; i < subdivision_count; ++i) {
+        sphere = std::make_unique<Geometry>(erhe::geometry::operation::catmull_clark_subdivision(*sphere.get()));
+    }
+    const Geometry& geometry = *sphere.get();
+    fmt::print(
+        "Sphere with {} Catmull-Clark subdivisions: {} points, {} polygons, {} corners, {} edges\n",
+        subdivision_count,
+        geometry.get_point_count(), geometry.get_polygon_count(), geometry.get_corner_count(), geometry.get_edge_count()
+    );
+
+    benchmark_point_corners              (geometry);
+    benchmark_polygon_corner_neighborhood(geometry);
+    benchmark_edge_polygons              (geometry);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+#include "erhe_gltf/gltf_accessor.hpp"
+
+#include "erhe_graphics/vertex_attribute.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <fastgltf/tools.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <variant>
+
+namespace erhe::gltf {
+
+auto get_buffer_bytes(const fastgltf::Buffer& buffer) -> std::span<const std::byte>
+{
+    return std::visit(
+        fastgltf::visitor{
+            [](const auto&) {
+                return std::span<const std::byte>{};
+            },
+            [](const fastgltf::sources::Array& array) {
+                return std::span<const std::byte>{reinterpret_cast<const std::byte*>(array.bytes.data()), array.bytes.size()};
+            },
+            [](const fastgltf::sources::Vector& vector) {
+                return std::span<const std::byte>{reinterpret_cast<const std::byte*>(vector.bytes.data()), vector.bytes.size()};
+            },
+            [](const fastgltf::sources::ByteView& byte_view) {
+                return std::span<const std::byte>{reinterpret_cast<const std::byte*>(byte_view.bytes.data()), byte_view.bytes.size()};
+            }
+        },
+        buffer.data
+    );
+}
+
+auto get_buffer_view_bytes(const fastgltf::Asset& asset, const std::size_t buffer_view_index) -> std::span<const std::byte>
+{
+    if (buffer_view_index >= asset.bufferViews.size()) {
+        return {};
+    }
+    const fastgltf::BufferView& buffer_view = asset.bufferViews[buffer_view_index];
+    if (buffer_view.bufferIndex >= asset.buffers.size()) {
+        return {};
+    }
+    const std::span<const std::byte> bytes = get_buffer_bytes(asset.buffers[buffer_view.bufferIndex]);
+    if (buffer_view.byteOffset + buffer_view.byteLength > bytes.size()) {
+        return {};
+    }
+    return bytes.subspan(buffer_view.byteOffset, buffer_view.byteLength);
+}
+
+namespace {
+
+[[nodiscard]] auto is_range_in_view(
+    const fastgltf::Asset& asset,
+    const std::size_t      buffer_view_index,
+    const std::size_t      byte_offset,
+    const std::size_t      count,
+    const std::size_t      element_size,
+    const std::size_t      stride
+) -> bool
+{
+    if (count == 0) {
+        return true;
+    }
+    const std::span<const std::byte> view_bytes = get_buffer_view_bytes(asset, buffer_view_index);
+    return byte_offset + (count - 1) * stride + element_size <= view_bytes.size();
+}
+
+template <typename T>
+void widen_indices(const std::byte* source, const std::span<uint32_t> destination)
+{
+    // Simple loop; compilers vectorize this
+    for (std::size_t i = 0, end = destination.size(); i < end; ++i) {
+        T value;
+        std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+        destination[i] = static_cast<uint32_t>(value);
+    }
+}
+
+template <std::size_t element_size>
+void copy_elements(std::byte* destination, const std::size_t destination_stride, const std::byte* source, const std::size_t source_stride, const std::size_t count)
+{
+    // Constant size memcpy compiles to plain (SIMD) loads and stores
+    for (std::size_t i = 0; i < count; ++i) {
+        std::memcpy(destination + destination_stride * i, source + source_stride * i, element_size);
+    }
+}
+
+} // anonymous namespace
+
+auto is_accessor_in_range(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor) -> bool
+{
+    // Accessor without buffer view reads as zeros
+    const std::size_t element_size = getElementByteSize(accessor.type, accessor.componentType);
+    if (accessor.bufferViewIndex.has_value()) {
+        const std::size_t buffer_view_index = accessor.bufferViewIndex.value();
+        if (buffer_view_index >= asset.bufferViews.size()) {
+            return false;
+        }
+        const std::size_t stride = asset.bufferViews[buffer_view_index].byteStride.value_or(element_size);
+        if (!is_range_in_view(asset, buffer_view_index, accessor.byteOffset, accessor.count, element_size, stride)) {
+            return false;
+        }
+    }
+    if (accessor.sparse) {
+        const fastgltf::SparseAccessor& sparse     = accessor.sparse.value();
+        const std::size_t               index_size = getComponentByteSize(sparse.indexComponentType);
+        if (
+            !is_range_in_view(asset, sparse.indicesBufferView, sparse.indicesByteOffset, sparse.count, index_size,   index_size) ||
+            !is_range_in_view(asset, sparse.valuesBufferView,  sparse.valuesByteOffset,  sparse.count, element_size, element_size)
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto copy_indices(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, const std::span<uint32_t> destination) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!accessor.bufferViewIndex.has_value() || bool(accessor.sparse) || (accessor.bufferViewIndex.value() >= asset.bufferViews.size())) {
+        return false;
+    }
+    const fastgltf::BufferView&      view         = asset.bufferViews[accessor.bufferViewIndex.value()];
+    const std::span<const std::byte> view_bytes   = get_buffer_view_bytes(asset, accessor.bufferViewIndex.value());
+    const std::size_t                element_size = getElementByteSize(accessor.type, accessor.componentType);
+    if (view.byteStride.value_or(element_size) != element_size) {
+        return false;
+    }
+    if (accessor.byteOffset + destination.size() * element_size > view_bytes.size()) {
+        return false;
+    }
+    const std::byte* source = view_bytes.data() + accessor.byteOffset;
+    switch (accessor.componentType) {
+        case fastgltf::ComponentType::UnsignedInt: {
+            std::memcpy(destination.data(), source, destination.size_bytes());
+            return true;
+        }
+        case fastgltf::ComponentType::UnsignedShort: {
+            widen_indices<uint16_t>(source, destination);
+            return true;
+        }
+        case fastgltf::ComponentType::UnsignedByte: {
+            widen_indices<uint8_t>(source, destination);
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+auto copyComponentsFromAccessor(
+    const fastgltf::Asset&    asset,
+    const fastgltf::Accessor& accessor,
+    void*                     dest,
+    const std::size_t         destStride,
+    std::size_t               count
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    assert((!bool(accessor.sparse) || accessor.sparse->count == 0) && "copyComponentsFromAccessor currently does not support sparse accessors.");
+
+    // Accessor without buffer view reads as zeros, destination is zero filled
+    if (!accessor.bufferViewIndex.has_value()) {
+        return true;
+    }
+    if (accessor.bufferViewIndex.value() >= asset.bufferViews.size()) {
+        return false;
+    }
+
+    auto* dstBytes = static_cast<std::byte*>(dest);
+
+    auto elemSize = getElementByteSize(accessor.type, accessor.componentType);
+    //auto componentCount = getNumComponents(accessor.type);
+
+    auto& view = asset.bufferViews[*accessor.bufferViewIndex];
+    auto srcStride = view.byteStride.value_or(elemSize);
+
+    const std::span<const std::byte> viewBytes = get_buffer_view_bytes(asset, *accessor.bufferViewIndex);
+    count = std::min(count, accessor.count);
+    if (count == 0) {
+        return true;
+    }
+    if (accessor.byteOffset + (count - 1) * srcStride + elemSize > viewBytes.size()) {
+        return false;
+    }
+    const std::byte* srcBytes = viewBytes.data() + accessor.byteOffset;
+
+    if ((srcStride == elemSize) && (destStride == elemSize)) {
+        std::memcpy(dstBytes, srcBytes, count * elemSize);
+        return true;
+    }
+    switch (elemSize) {
+        case  4: copy_elements< 4>(dstBytes, destStride, srcBytes, srcStride, count); break;
+        case  8: copy_elements< 8>(dstBytes, destStride, srcBytes, srcStride, count); break;
+        case 12: copy_elements<12>(dstBytes, destStride, srcBytes, srcStride, count); break;
+        case 16: copy_elements<16>(dstBytes, destStride, srcBytes, srcStride, count); break;
+        default: {
+            for (std::size_t i = 0; i < count; ++i) {
+                std::memcpy(dstBytes + destStride * i, srcBytes + srcStride * i, elemSize);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+auto copy_interleaved_vertices(
+    const fastgltf::Asset&                                 asset,
+    const fastgltf::Primitive&                             primitive,
+    const std::vector<erhe::graphics::Vertex_attribute>&   erhe_attributes,
+    const std::size_t                                      vertex_stride,
+    const std::size_t                                      vertex_count,
+    std::vector<uint8_t>&                                  vertex_data
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (primitive.attributes.empty() || (vertex_count == 0) || (erhe_attributes.size() != primitive.attributes.size())) {
+        return false;
+    }
+
+    std::size_t buffer_view_index = std::numeric_limits<std::size_t>::max();
+    std::size_t base_offset       = 0;
+    std::size_t vertex_end        = 0;
+    for (std::size_t i = 0, end = primitive.attributes.size(); i < end; ++i) {
+        const fastgltf::Accessor&               accessor       = asset.accessors[primitive.attributes[i].accessorIndex];
+        const erhe::graphics::Vertex_attribute& erhe_attribute = erhe_attributes[i];
+        if (!accessor.bufferViewIndex.has_value() || bool(accessor.sparse)) {
+            return false;
+        }
+        if (i == 0) {
+            buffer_view_index = accessor.bufferViewIndex.value();
+            if (accessor.byteOffset < erhe_attribute.offset) {
+                return false;
+            }
+            base_offset = accessor.byteOffset - erhe_attribute.offset;
+        } else if (accessor.bufferViewIndex.value() != buffer_view_index) {
+            return false;
+        }
+        if (accessor.byteOffset != base_offset + erhe_attribute.offset) {
+            return false;
+        }
+        vertex_end = std::max(vertex_end, erhe_attribute.offset + getElementByteSize(accessor.type, accessor.componentType));
+    }
+
+    if (buffer_view_index >= asset.bufferViews.size()) {
+        return false;
+    }
+    const fastgltf::BufferView& view = asset.bufferViews[buffer_view_index];
+    if (view.byteStride.value_or(0) != vertex_stride) {
+        return false;
+    }
+    const std::span<const std::byte> view_bytes = get_buffer_view_bytes(asset, buffer_view_index);
+    const std::size_t byte_count = (vertex_count - 1) * vertex_stride + vertex_end;
+    if ((base_offset + byte_count > view_bytes.size()) || (byte_count > vertex_data.size())) {
+        return false;
+    }
+    std::memcpy(vertex_data.data(), view_bytes.data() + base_offset, byte_count);
+    return true;
+}
+
+} // namespace erhe::gltf
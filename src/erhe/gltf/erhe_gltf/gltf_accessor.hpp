@@ -0,0 +1,57 @@
+#pragma once
+
+#include <fastgltf/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace erhe::graphics {
+    class Vertex_attribute;
+}
+
+namespace erhe::gltf {
+
+// Bytes of loaded buffer. External buffers are memory mapped by
+// map_external_buffers() and appear as byte views. Buffers that are not
+// loaded (URI sources) return empty span.
+[[nodiscard]] auto get_buffer_bytes(const fastgltf::Buffer& buffer) -> std::span<const std::byte>;
+
+// Bytes of buffer view, empty if buffer view does not fit in its buffer.
+[[nodiscard]] auto get_buffer_view_bytes(const fastgltf::Asset& asset, std::size_t buffer_view_index) -> std::span<const std::byte>;
+
+// Returns true if every element of accessor, including sparse indices and
+// values, can be read from loaded buffer data. fastgltf accessor tools do
+// not check this, so accessors must pass before they are iterated.
+[[nodiscard]] auto is_accessor_in_range(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor) -> bool;
+
+// Bulk copy of index accessor. Returns false if accessor needs to be
+// read element by element (sparse, strided, or missing buffer view) or
+// does not fit in its buffer view.
+[[nodiscard]] auto copy_indices(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::span<uint32_t> destination) -> bool;
+
+// Derived from fastgltf::copyComponentsFromAccessor(). Copies count
+// elements to dest with destStride. Returns false, without writing
+// anything, if accessor does not fit in its buffer view.
+[[nodiscard]] auto copyComponentsFromAccessor(
+    const fastgltf::Asset&    asset,
+    const fastgltf::Accessor& accessor,
+    void*                     dest,
+    std::size_t               destStride,
+    std::size_t               count
+) -> bool;
+
+// Single copy of all vertex data, when all attributes are interleaved in one
+// buffer view with the same layout as the target vertex format. Returns false
+// if attributes must be copied one by one.
+[[nodiscard]] auto copy_interleaved_vertices(
+    const fastgltf::Asset&                                 asset,
+    const fastgltf::Primitive&                             primitive,
+    const std::vector<erhe::graphics::Vertex_attribute>&   erhe_attributes,
+    std::size_t                                            vertex_stride,
+    std::size_t                                            vertex_count,
+    std::vector<uint8_t>&                                  vertex_data
+) -> bool;
+
+} // namespace erhe::gltf
@@ -1,10 +1,13 @@
 // #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
 #include "gltf_fastgltf.hpp"
+#include "gltf_accessor.hpp"
 #include "gltf_log.hpp"
 #include "image_transfer.hpp"
 
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_file/file.hpp"
+#include "erhe_file/mapped_file.hpp"
 #include "erhe_gl/wrapper_functions.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_graphics/instance.hpp"
@@ -14,6 +17,7 @@
 #include "erhe_graphics/vertex_attribute.hpp"
 #include "erhe_graphics/vertex_format.hpp"
 #include "erhe_primitive/material.hpp"
+#include "erhe_primitive/primitive.hpp"
 #include "erhe_primitive/triangle_soup.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_scene/animation.hpp"
@@ -38,9 +42,16 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <limits>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <span>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <variant>
 #include <vector>
 
@@ -499,27 +510,64 @@ void accessor_read_u32s(
     }
 }
 
-// Derived from fastgltf::copyComponentsFromAccessor()
-void copyComponentsFromAccessor(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, void* dest, std::size_t destStride)
+// Replaces external buffer URIs with byte views of memory mapped files,
+// instead of letting fastgltf read them to heap (LoadExternalBuffers).
+// Mapped files must be kept open as long as asset buffers are accessed.
+// Returns false if any external buffer is missing, too short or cannot be
+// mapped; such buffers would be left unloaded.
+[[nodiscard]] auto map_external_buffers(
+    fastgltf::Asset&                       asset,
+    const std::filesystem::path&           base_path,
+    std::vector<erhe::file::Mapped_file>& mapped_files
+) -> bool
 {
     ERHE_PROFILE_FUNCTION();
 
-    assert((!bool(accessor.sparse) || accessor.sparse->count == 0) && "copyComponentsFromAccessor currently does not support sparse accessors.");
-
-    auto* dstBytes = static_cast<std::byte*>(dest);
-
-    auto elemSize = getElementByteSize(accessor.type, accessor.componentType);
-    //auto componentCount = getNumComponents(accessor.type);
-
-    auto& view = asset.bufferViews[*accessor.bufferViewIndex];
-    auto srcStride = view.byteStride.value_or(elemSize);
+    mapped_files.reserve(asset.buffers.size());
+    for (fastgltf::Buffer& buffer : asset.buffers) {
+        const fastgltf::sources::URI* uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+        if (uri == nullptr) {
+            continue;
+        }
+        if (!uri->uri.isLocalPath()) {
+            log_gltf->error("glTF buffer '{}' is not a local file", uri->uri.string());
+            return false;
+        }
+        const std::filesystem::path path = base_path / uri->uri.fspath();
+        erhe::file::Mapped_file mapped_file{path};
+        if (!mapped_file.is_open() || (uri->fileByteOffset + buffer.byteLength > mapped_file.size())) {
+            log_gltf->error("glTF buffer '{}' could not be mapped", erhe::file::to_string(path));
+            return false;
+        }
+        const std::span<const std::byte> bytes = mapped_file.span().subspan(uri->fileByteOffset, buffer.byteLength);
+        buffer.data = fastgltf::sources::ByteView{
+            .bytes    = fastgltf::span<const std::byte>{bytes.data(), bytes.size()},
+            .mimeType = fastgltf::MimeType::GltfBuffer
+        };
+        mapped_files.push_back(std::move(mapped_file));
+    }
+    return true;
+}
 
-    const fastgltf::DefaultBufferDataAdapter adapter{};
-    auto srcBytes = adapter(asset, *accessor.bufferViewIndex).subspan(accessor.byteOffset);
+// Opens glTF or GLB file for parsing. Uses memory mapping when available,
+// so that GLB binary chunk is not copied to heap.
+[[nodiscard]] auto open_gltf_file(const std::filesystem::path& path) -> std::unique_ptr<fastgltf::GltfDataGetter>
+{
+    ERHE_PROFILE_FUNCTION();
 
-    for (std::size_t i = 0; i < accessor.count; ++i) {
-        std::memcpy(dstBytes + destStride * i, &srcBytes[srcStride * i], elemSize);
+#if defined(FASTGLTF_HAS_MEMORY_MAPPED_FILE) && FASTGLTF_HAS_MEMORY_MAPPED_FILE
+    fastgltf::Expected<fastgltf::MappedGltfFile> mapped = fastgltf::MappedGltfFile::FromPath(path);
+    if (mapped.error() == fastgltf::Error::None) {
+        return std::make_unique<fastgltf::MappedGltfFile>(std::move(mapped.get()));
+    }
+    log_gltf->warn("glTF file could not be mapped, reading: {}", fastgltf::getErrorMessage(mapped.error()));
+#endif
+    fastgltf::Expected<fastgltf::GltfDataBuffer> data = fastgltf::GltfDataBuffer::FromPath(path);
+    if (data.error() != fastgltf::Error::None) {
+        log_gltf->error("glTF load error: {}", fastgltf::getErrorMessage(data.error()));
+        return {};
     }
+    return std::make_unique<fastgltf::GltfDataBuffer>(std::move(data.get()));
 }
 
 class Gltf_parser
@@ -563,12 +611,37 @@ public:
             return;
         }
 
-        log_gltf->trace("parsing images");
-        m_data_out.images.resize(m_asset->images.size());
-        for (std::size_t i = 0, end = m_asset->images.size(); i < end; ++i) {
-            parse_image(i);
+        // CPU heavy stages run as tasks on the thread pool: image decoding,
+        // primitive conversion and animation sampler decoding. Texture
+        // uploads and building of scene items stay on this thread.
+        erhe::concurrency::Thread_pool& thread_pool = (m_arguments.thread_pool != nullptr)
+            ? *m_arguments.thread_pool
+            : erhe::concurrency::Thread_pool::get_instance();
+        erhe::concurrency::Task_group   task_group{thread_pool};
+
+        log_gltf->trace("scheduling primitives");
+        collect_primitive_entries();
+        for (std::size_t i = 0, end = m_primitive_entries.size(); i < end; ++i) {
+            task_group.run(
+                [this, i]() {
+                    prepare_primitive_entry(m_primitive_entries[i]);
+                }
+            );
         }
 
+        log_gltf->trace("scheduling animations");
+        m_data_out.animations.resize(m_asset->animations.size());
+        for (std::size_t i = 0, end = m_asset->animations.size(); i < end; ++i) {
+            task_group.run(
+                [this, i]() {
+                    parse_animation_samplers(i);
+                }
+            );
+        }
+
+        log_gltf->trace("parsing images");
+        parse_images(task_group);
+
         log_gltf->trace("parsing samplers");
         m_data_out.samplers.resize(m_asset->samplers.size());
         for (std::size_t i = 0, end = m_asset->samplers.size(); i < end; ++i) {
@@ -593,6 +666,9 @@ public:
             parse_light(i);
         }
 
+        log_gltf->trace("waiting for primitives and animations");
+        task_group.wait();
+
         log_gltf->trace("parsing meshes");
         m_data_out.meshes.resize(m_asset->meshes.size());
         for (std::size_t i = 0, end = m_asset->meshes.size(); i < end; ++i) {
@@ -632,10 +708,9 @@ public:
             }
         }
 
-        log_gltf->trace("parsing animations");
-        m_data_out.animations.reserve(m_asset->animations.size());
+        log_gltf->trace("parsing animation channels");
         for (std::size_t i = 0, end = m_asset->animations.size(); i < end; ++i) {
-            parse_animation(i);
+            parse_animation_channels(i);
         }
     }
 
@@ -671,7 +746,9 @@ private:
             log_gltf->trace("Extension Required: {}", m_asset->extensionsRequired.at(i));
         }
     }
-    void parse_animation(const std::size_t animation_index)
+    // Decodes animation sampler data. Runs on worker threads; channels
+    // are bound to nodes later by parse_animation_channels().
+    void parse_animation_samplers(const std::size_t animation_index)
     {
         ERHE_PROFILE_FUNCTION();
 
@@ -682,7 +759,6 @@ private:
         auto erhe_animation = std::make_shared<erhe::scene::Animation>(animation_name);
         erhe_animation->set_source_path(m_arguments.path);
         erhe_animation->enable_flag_bits(Item_flags::content | Item_flags::show_in_ui);
-        m_data_out.animations.push_back(erhe_animation);
         erhe_animation->samplers.resize(animation.samplers.size());
         for (std::size_t sampler_index = 0, end = animation.samplers.size(); sampler_index < end; ++sampler_index) {
             const fastgltf::AnimationSampler& sampler = animation.samplers[sampler_index];
@@ -706,9 +782,13 @@ private:
             erhe_sampler.interpolation_mode = to_erhe(sampler.interpolation);
             const std::size_t output_component_count = getNumComponents(outputAccessor.type);
             const std::size_t output_float_count     = outputAccessor.count * output_component_count;
+            const fastgltf::Asset& asset = m_asset.get();
+            if (!is_accessor_in_range(asset, inputAccessor) || !is_accessor_in_range(asset, outputAccessor)) {
+                log_gltf->error("Animation `{}` sampler {} accessor is out of buffer range, sampler skipped", animation_name, sampler_index);
+                continue;
+            }
             std::vector<float> timestamps(inputAccessor.count);
             std::vector<float> values   (output_float_count);
-            const fastgltf::Asset& asset = m_asset.get();
             fastgltf::iterateAccessorWithIndex<float>(
                 asset, inputAccessor,
                 [&](float value, std::size_t idx) {
@@ -748,6 +828,15 @@ private:
 
             erhe_sampler.set(std::move(timestamps), std::move(values));
         }
+        m_data_out.animations[animation_index] = erhe_animation;
+    }
+    void parse_animation_channels(const std::size_t animation_index)
+    {
+        ERHE_PROFILE_FUNCTION();
+
+        const fastgltf::Animation& animation = m_asset->animations[animation_index];
+        const std::shared_ptr<erhe::scene::Animation>& erhe_animation = m_data_out.animations[animation_index];
+        const std::string& animation_name = erhe_animation->get_name();
         erhe_animation->channels.resize(animation.channels.size());
         for (std::size_t channel_index = 0, end = animation.channels.size(); channel_index < end; ++channel_index) {
             const fastgltf::AnimationChannel& channel = animation.channels.at(channel_index);
@@ -797,31 +886,114 @@ private:
                     : 0
             };
         }
-        m_data_out.animations[animation_index] = erhe_animation;
     }
-    auto load_image_file(
-        const std::filesystem::path& path,
-        std::string_view             image_name
-    ) -> std::shared_ptr<erhe::graphics::Texture>
+    static constexpr std::size_t c_max_images_in_flight = 16;
+
+    class Decoded_image
+    {
+    public:
+        std::string                name;
+        std::filesystem::path      source_path;
+        erhe::graphics::Image_info image_info;
+        std::vector<std::uint8_t>  pixels;
+        bool                       ok{false};
+        std::atomic<bool>          ready{false};
+    };
+
+    // Decodes image to CPU memory. Runs on worker threads; no GL calls.
+    void decode_image(const std::size_t image_index, Decoded_image& decoded_image)
     {
         ERHE_PROFILE_FUNCTION();
 
-        const bool file_is_ok = erhe::file::check_is_existing_non_empty_regular_file("Gltf_parser::load_image_file", path);
+        const fastgltf::Image& image = m_asset->images[image_index];
+        decoded_image.name = safe_resource_name(image.name, "image", image_index);
+        log_gltf->trace("Image: image index = {}, name = {}", image_index, decoded_image.name);
+
+        erhe::graphics::Image_loader loader;
+        bool open_ok = false;
+        std::visit(
+            fastgltf::visitor {
+                [](auto& arg) {
+                    static_cast<void>(arg);
+                    ERHE_FATAL("TODO Unsupported image source");
+                },
+                [&](const fastgltf::sources::BufferView& buffer_view_source) {
+                    open_ok = open_image_buffer(loader, buffer_view_source.bufferViewIndex, decoded_image);
+                },
+                [&](const fastgltf::sources::URI& uri) {
+                    std::filesystem::path path = m_arguments.path;
+                    path.replace_filename(uri.uri.fspath());
+                    open_ok = open_image_file(loader, path, decoded_image);
+                }
+            },
+            image.data
+        );
+
+        if (open_ok) {
+            const std::size_t row_stride = static_cast<std::size_t>(decoded_image.image_info.width) *
+                erhe::graphics::get_upload_pixel_byte_count(to_gl(decoded_image.image_info.format));
+            decoded_image.pixels.resize(row_stride * static_cast<std::size_t>(decoded_image.image_info.height));
+            decoded_image.ok = loader.load(decoded_image.pixels);
+            loader.close();
+            if (!decoded_image.ok) {
+                log_gltf->warn(
+                    "Image '{}' load failed: image index = {}, width = {}, height = {}",
+                    decoded_image.name, image_index, decoded_image.image_info.width, decoded_image.image_info.height
+                );
+                decoded_image.pixels = std::vector<std::uint8_t>{};
+            }
+        }
+        decoded_image.ready.store(true, std::memory_order_release);
+    }
+    auto open_image_file(
+        erhe::graphics::Image_loader& loader,
+        const std::filesystem::path&  path,
+        Decoded_image&                decoded_image
+    ) -> bool
+    {
+        const bool file_is_ok = erhe::file::check_is_existing_non_empty_regular_file("Gltf_parser::open_image_file", path);
         if (!file_is_ok) {
-            return {};
+            return false;
         }
+        decoded_image.source_path = path;
+        return loader.open(path, decoded_image.image_info);
+    }
+    auto open_image_buffer(
+        erhe::graphics::Image_loader& loader,
+        const std::size_t             buffer_view_index,
+        Decoded_image&                decoded_image
+    ) -> bool
+    {
+        decoded_image.source_path = m_arguments.path;
+        const std::span<const std::byte> bytes = get_buffer_view_bytes(m_asset.get(), buffer_view_index);
+        if (bytes.empty()) {
+            log_gltf->error("Image buffer view '{}' has no data", decoded_image.name);
+            return false;
+        }
+        const std::span<const std::uint8_t> image_encoded_buffer_view{
+            reinterpret_cast<const std::uint8_t*>(bytes.data()),
+            bytes.size()
+        };
+        const bool open_ok = loader.open(image_encoded_buffer_view, decoded_image.image_info);
+        if (!open_ok) {
+            log_gltf->error("Failed to parse image from buffer view '{}'", decoded_image.name);
+        }
+        return open_ok;
+    }
 
-        erhe::graphics::Image_info image_info;
-        erhe::graphics::Image_loader loader;
+    // Uploads decoded image through Image_transfer. Must be called on the
+    // thread which owns the graphics context. Headless parsing only decodes.
+    auto upload_image(const std::size_t image_index, Decoded_image& decoded_image) -> std::shared_ptr<erhe::graphics::Texture>
+    {
+        ERHE_PROFILE_FUNCTION();
 
-        if (!loader.open(path, image_info)) {
+        if (!decoded_image.ok || (m_arguments.graphics_instance == nullptr)) {
             return {};
         }
 
-        auto& slot = m_arguments.image_transfer.get_slot();
-
+        const erhe::graphics::Image_info& image_info = decoded_image.image_info;
         erhe::graphics::Texture_create_info texture_create_info{
-            .instance        = m_arguments.graphics_instance,
+            .instance        = *m_arguments.graphics_instance,
             .internal_format = to_gl(image_info.format),
             .use_mipmaps     = true, //(image_info.level_count > 1),
             .width           = image_info.width,
@@ -829,117 +1001,29 @@ private:
             .depth           = image_info.depth,
             .level_count     = image_info.level_count,
             .row_stride      = image_info.row_stride,
-            .debug_label     = std::string{image_name} // path.filename().string()
+            .debug_label     = decoded_image.name
         };
         const int  mipmap_count    = texture_create_info.calculate_level_count();
         const bool generate_mipmap = mipmap_count != image_info.level_count;
         if (generate_mipmap) {
             texture_create_info.level_count = mipmap_count;
         }
-        std::span<std::uint8_t> span = slot.begin_span_for(image_info.width, image_info.height, texture_create_info.internal_format);
-
-        const bool ok = loader.load(span);
-        loader.close();
-        slot.end(ok);
-        if (!ok) {
-            return {};
-        }
-
-        auto texture = std::make_shared<erhe::graphics::Texture>(texture_create_info);
-        texture->set_source_path(path);
-        texture->set_debug_label(image_name.empty() ? erhe::file::to_string(path) : image_name);
-
-        gl::pixel_store_i(gl::Pixel_store_parameter::unpack_alignment, 1);
-        gl::bind_buffer(gl::Buffer_target::pixel_unpack_buffer, slot.gl_name());
-        texture->upload(texture_create_info.internal_format, texture_create_info.width, texture_create_info.height);
-        gl::bind_buffer(gl::Buffer_target::pixel_unpack_buffer, 0);
-
-        if (generate_mipmap) {
-            gl::generate_texture_mipmap(texture->gl_name());
-        }
-        return texture;
-    }
-    auto load_image_buffer(
-        const std::size_t buffer_view_index,
-        const std::size_t image_index,
-        std::string_view  image_name
-    ) -> std::shared_ptr<erhe::graphics::Texture>
-    {
-        ERHE_PROFILE_FUNCTION();
-
-        const fastgltf::BufferView&  buffer_view      = m_asset->bufferViews[buffer_view_index];
-        const fastgltf::Buffer&      buffer           = m_asset->buffers.at(buffer_view.bufferIndex);
-        const std::string            buffer_view_name = safe_resource_name(buffer_view.name, "buffer_view", buffer_view_index);
-        const std::string            name             = !image_name.empty() 
-            ? std::string{image_name}
-            : fmt::format("{} image {} {}", m_arguments.path.filename().string(), image_index, buffer_view_name);
-        erhe::graphics::Image_info   image_info;
-        erhe::graphics::Image_loader loader;
-
-        bool load_ok = false;
-        auto& slot = m_arguments.image_transfer.get_slot();
-        erhe::graphics::Texture_create_info texture_create_info{
-            .instance    = m_arguments.graphics_instance,
-            .debug_label = name
-        };
-        int  mipmap_count    = 0;
-        bool generate_mipmap = false;
-
-        std::visit(
-            fastgltf::visitor{
-                [](auto& arg) {
-                    static_cast<void>(arg);
-                    ERHE_FATAL("TODO Unsupported image buffer view source");
-                },
-                [&](const fastgltf::sources::Array& data) {
-                    std::span<const std::uint8_t> image_encoded_buffer_view{
-                        reinterpret_cast<const std::uint8_t*>(data.bytes.data()) + buffer_view.byteOffset,
-                        buffer_view.byteLength
-                    };
-                    if (!loader.open(image_encoded_buffer_view, image_info)) {
-                        log_gltf->error("Failed to parse image from buffer view '{}'", name);
-                        return;
-                    }
-
-                    texture_create_info.internal_format = to_gl(image_info.format);
-                    texture_create_info.use_mipmaps     = true; //(image_info.level_count > 1),
-                    texture_create_info.width           = image_info.width;
-                    texture_create_info.height          = image_info.height;
-                    texture_create_info.depth           = image_info.depth;
-                    texture_create_info.level_count     = image_info.level_count;
-                    texture_create_info.row_stride      = image_info.row_stride;
-                    texture_create_info.debug_label     = name;
-
-                    mipmap_count    = texture_create_info.calculate_level_count();
-                    generate_mipmap = mipmap_count != image_info.level_count;
-                    if (generate_mipmap) {
-                        texture_create_info.level_count = mipmap_count;
-                    }
-                    std::span<std::uint8_t> span = slot.begin_span_for(image_info.width, image_info.height, texture_create_info.internal_format);
 
-                    load_ok = loader.load(span);
-                    loader.close();
-                }
-            },
-            buffer.data
-        );
-        slot.end(load_ok);
-        if (!load_ok) {
-            log_gltf->warn(
-                "Image '{}' load failed: image index = {}, width = {}, height = {}",
-                name, image_index, texture_create_info.width, texture_create_info.height
-            );
-            return {};
-        }
+        ERHE_VERIFY(m_arguments.image_transfer != nullptr);
+        auto& slot = m_arguments.image_transfer->get_slot();
+        std::span<std::uint8_t> span = slot.begin_span_for(image_info.width, image_info.height, texture_create_info.internal_format);
+        ERHE_VERIFY(span.size_bytes() == decoded_image.pixels.size());
+        std::memcpy(span.data(), decoded_image.pixels.data(), span.size_bytes());
+        slot.end(true);
 
         log_gltf->info(
             "Loaded image '{}': image index = {}, width = {}, height = {}",
-            name, image_index, texture_create_info.width, texture_create_info.height
+            decoded_image.name, image_index, texture_create_info.width, texture_create_info.height
         );
 
         auto texture = std::make_shared<erhe::graphics::Texture>(texture_create_info);
-        texture->set_source_path(m_arguments.path);
-        texture->set_debug_label(name);
+        texture->set_source_path(decoded_image.source_path);
+        texture->set_debug_label(decoded_image.name);
         gl::pixel_store_i(gl::Pixel_store_parameter::unpack_alignment, 1);
         gl::bind_buffer(gl::Buffer_target::pixel_unpack_buffer, slot.gl_name());
         texture->upload(texture_create_info.internal_format, texture_create_info.width, texture_create_info.height);
@@ -950,36 +1034,52 @@ private:
         }
         return texture;
     }
-    void parse_image(const std::size_t image_index)
+
+    // Images are decoded on worker threads, at most c_max_images_in_flight
+    // ahead of uploads, which bounds memory used by decoded pixels.
+    // Uploads are done in image order on the calling thread.
+    void parse_images(erhe::concurrency::Task_group& task_group)
     {
         ERHE_PROFILE_FUNCTION();
 
-        const fastgltf::Image& image      = m_asset->images[image_index];
-        const std::string      image_name = safe_resource_name(image.name, "image", image_index);
-        log_gltf->trace("Image: image index = {}, name = {}", image_index, image_name);
-        std::shared_ptr<erhe::graphics::Texture> erhe_texture;
-        std::visit(
-            fastgltf::visitor {
-                [](auto& arg) {
-                    static_cast<void>(arg);
-                    ERHE_FATAL("TODO Unsupported image source");
-                },
-                [&](const fastgltf::sources::BufferView& buffer_view_source){
-                    erhe_texture = load_image_buffer(buffer_view_source.bufferViewIndex, image_index, image_name);
-                },
-                [&](const fastgltf::sources::URI& uri){
-                    std::filesystem::path relative_path = uri.uri.fspath();
-                    erhe_texture = load_image_file(m_arguments.path.replace_filename(relative_path), image_name);
-                }
-            },
-            image.data
+        const std::size_t image_count = m_asset->images.size();
+        m_data_out.images.resize(image_count);
+        if (image_count == 0) {
+            return;
+        }
+
+        erhe::concurrency::Thread_pool& thread_pool = task_group.get_thread_pool();
+        const std::size_t max_in_flight = std::max(
+            std::size_t{2},
+            std::min(c_max_images_in_flight, 2 * thread_pool.get_thread_count())
         );
+        std::vector<Decoded_image> decoded_images(image_count);
+        std::size_t submit_index   = 0;
+        std::size_t uploaded_count = 0;
+        const auto submit = [&]() {
+            while ((submit_index < image_count) && (submit_index < uploaded_count + max_in_flight)) {
+                const std::size_t image_index = submit_index++;
+                task_group.run(
+                    [this, image_index, &decoded_images]() {
+                        decode_image(image_index, decoded_images[image_index]);
+                    }
+                );
+            }
+        };
 
-        if (erhe_texture) {
-            erhe_texture->set_debug_label(image_name);
-            m_data_out.images.push_back(erhe_texture);
+        submit();
+        for (std::size_t image_index = 0; image_index < image_count; ++image_index) {
+            Decoded_image& decoded_image = decoded_images[image_index];
+            while (!decoded_image.ready.load(std::memory_order_acquire)) {
+                if (!thread_pool.try_run_pending_task()) {
+                    std::this_thread::yield();
+                }
+            }
+            m_data_out.images[image_index] = upload_image(image_index, decoded_image);
+            decoded_image.pixels = std::vector<std::uint8_t>{};
+            ++uploaded_count;
+            submit();
         }
-        m_data_out.images[image_index] = erhe_texture;
     }
     void parse_sampler(const std::size_t sampler_index)
     {
@@ -988,13 +1088,16 @@ private:
         const fastgltf::Sampler& sampler = m_asset->samplers[sampler_index];
         const std::string sampler_name = safe_resource_name(sampler.name, "sampler", sampler_index);
         log_gltf->trace("Sampler: sampler index = {}, name = {}", sampler_index, sampler_name);
+        if (m_arguments.graphics_instance == nullptr) {
+            return;
+        }
 
         erhe::graphics::Sampler_create_info create_info;
         create_info.min_filter     = sampler.minFilter.has_value() ? static_cast<gl::Texture_min_filter>(sampler.minFilter.value()) : gl::Texture_min_filter::nearest_mipmap_nearest;
         create_info.mag_filter     = sampler.magFilter.has_value() ? static_cast<gl::Texture_mag_filter>(sampler.magFilter.value()) : gl::Texture_mag_filter::nearest;
         create_info.wrap_mode[0]   = static_cast<gl::Texture_wrap_mode>(sampler.wrapS);
         create_info.wrap_mode[1]   = static_cast<gl::Texture_wrap_mode>(sampler.wrapT);
-        create_info.max_anisotropy = m_arguments.graphics_instance.limits.max_texture_max_anisotropy;
+        create_info.max_anisotropy = m_arguments.graphics_instance->limits.max_texture_max_anisotropy;
         create_info.debug_label    = sampler_name;
 
         auto erhe_sampler = std::make_shared<erhe::graphics::Sampler>(create_info);
@@ -1160,14 +1263,31 @@ private:
         erhe_light->enable_flag_bits(Item_flags::content | Item_flags::visible | Item_flags::show_in_ui);
     }
 
+    // Primitives which use the same accessors share one entry, and
+    // thus one triangle soup and one render shape.
+    class Primitive_key
+    {
+    public:
+        std::size_t              index_accessor;
+        std::vector<std::size_t> attribute_accessors;
+
+        [[nodiscard]] auto operator<(const Primitive_key& rhs) const -> bool
+        {
+            return std::tie(index_accessor, attribute_accessors) < std::tie(rhs.index_accessor, rhs.attribute_accessors);
+        }
+    };
     class Primitive_entry
     {
     public:
-        std::size_t                                     index_accessor;
-        std::vector<std::size_t>                        attribute_accessors;
-        std::shared_ptr<erhe::primitive::Triangle_soup> triangle_soup;
+        const fastgltf::Primitive*                               primitive{nullptr};
+        std::shared_ptr<erhe::primitive::Triangle_soup>          triangle_soup;
+        std::shared_ptr<erhe::primitive::Primitive_render_shape> render_shape;
     };
-    std::vector<Primitive_entry> m_primitive_entries;
+    static constexpr std::size_t c_no_primitive_entry = std::numeric_limits<std::size_t>::max();
+
+    std::vector<Primitive_entry>              m_primitive_entries;
+    std::map<Primitive_key, std::size_t>      m_primitive_entry_lookup;
+    std::vector<std::vector<std::size_t>>     m_mesh_primitive_entries; // [mesh index][primitive index] -> entry index
 
     void load_new_primitive_geometry(const fastgltf::Primitive& primitive, Primitive_entry& primitive_entry)
     {
@@ -1185,14 +1305,21 @@ private:
         // Copy indices
         const fastgltf::Accessor& indices_accessor = m_asset->accessors[primitive.indicesAccessor.value()];
         log_gltf->trace("index count = {}", indices_accessor.count);
+        if (!is_accessor_in_range(m_asset.get(), indices_accessor)) {
+            log_gltf->error("glTF index accessor {} is out of buffer range, primitive skipped", primitive.indicesAccessor.value());
+            primitive_entry.triangle_soup.reset();
+            return;
+        }
         triangle_soup.index_data.resize(indices_accessor.count);
-        fastgltf::iterateAccessorWithIndex<uint32_t>(
-            m_asset.get(),
-            indices_accessor,
-            [&](uint32_t index_value, std::size_t index) {
-                triangle_soup.index_data[index] = index_value;
-            }
-        );
+        if (!copy_indices(m_asset.get(), indices_accessor, triangle_soup.index_data)) {
+            fastgltf::iterateAccessorWithIndex<uint32_t>(
+                m_asset.get(),
+                indices_accessor,
+                [&](uint32_t index_value, std::size_t index) {
+                    triangle_soup.index_data[index] = index_value;
+                }
+            );
+        }
 
         // Gather attributes
         std::size_t vertex_count = std::numeric_limits<std::size_t>::max();
@@ -1214,23 +1341,40 @@ private:
                 }
             );
         }
+        if (primitive.attributes.empty()) {
+            vertex_count = 0;
+        }
         std::size_t vertex_stride = triangle_soup.vertex_format.stride();
         triangle_soup.vertex_data.resize(vertex_count * vertex_stride);
         const std::vector<erhe::graphics::Vertex_attribute>& erhe_attributes = triangle_soup.vertex_format.get_attributes();
 
         // Gather vertex data
+        const bool interleaved = copy_interleaved_vertices(
+            m_asset.get(), primitive, erhe_attributes, vertex_stride, vertex_count, triangle_soup.vertex_data
+        );
         for (std::size_t i = 0, end = primitive.attributes.size(); i < end; ++i) {
             const fastgltf::Attribute& attribute = primitive.attributes[i];
             erhe::graphics::Vertex_attribute::Usage_type attribute_usage = to_erhe(attribute.name);
             std::size_t attribute_index = get_attribute_index(attribute.name);
             const fastgltf::Accessor& accessor = m_asset->accessors[attribute.accessorIndex];
             const erhe::graphics::Vertex_attribute& erhe_attribute = erhe_attributes[i];
-            copyComponentsFromAccessor(
-                m_asset.get(),
-                accessor,
-                triangle_soup.vertex_data.data() + erhe_attribute.offset,
-                triangle_soup.vertex_format.stride()
-            );
+            if (!interleaved) {
+                const bool copied = copyComponentsFromAccessor(
+                    m_asset.get(),
+                    accessor,
+                    triangle_soup.vertex_data.data() + erhe_attribute.offset,
+                    vertex_stride,
+                    vertex_count
+                );
+                if (!copied) {
+                    log_gltf->error(
+                        "glTF accessor {} for attribute {} is out of buffer range, primitive skipped",
+                        attribute.accessorIndex, attribute.name.c_str()
+                    );
+                    primitive_entry.triangle_soup.reset();
+                    return;
+                }
+            }
 
             log_gltf->trace(
                 "Primitive attribute[{}]: name = {}, attribute type = {}[{}], "
@@ -1248,46 +1392,84 @@ private:
             );
         }
     }
-    auto get_primitive_geometry(const fastgltf::Primitive& primitive, Primitive_entry& primitive_entry)
+    // Assigns each mesh primitive to a primitive entry. Cheap, runs
+    // before primitive entries are prepared on worker threads.
+    void collect_primitive_entries()
     {
         ERHE_PROFILE_FUNCTION();
 
-        primitive_entry.index_accessor = primitive.indicesAccessor.value();
-        primitive_entry.attribute_accessors.clear();
-        for (std::size_t i = 0, end = primitive.attributes.size(); i < end; ++i) {
-            const fastgltf::Attribute& attribute = primitive.attributes[i];
-            primitive_entry.attribute_accessors.push_back(attribute.accessorIndex);
+        m_primitive_entries.clear();
+        m_primitive_entry_lookup.clear();
+        m_mesh_primitive_entries.resize(m_asset->meshes.size());
+        for (std::size_t mesh_index = 0, mesh_end = m_asset->meshes.size(); mesh_index < mesh_end; ++mesh_index) {
+            const fastgltf::Mesh& mesh = m_asset->meshes[mesh_index];
+            std::vector<std::size_t>& entry_indices = m_mesh_primitive_entries[mesh_index];
+            entry_indices.resize(mesh.primitives.size(), c_no_primitive_entry);
+            for (std::size_t i = 0, end = mesh.primitives.size(); i < end; ++i) {
+                const fastgltf::Primitive& primitive = mesh.primitives[i];
+                if (!primitive.indicesAccessor.has_value()) {
+                    log_gltf->warn("Mesh {} primitive {} has no indices, skipped", mesh_index, i);
+                    continue;
+                }
+                Primitive_key key{
+                    .index_accessor = primitive.indicesAccessor.value()
+                };
+                for (const fastgltf::Attribute& attribute : primitive.attributes) {
+                    key.attribute_accessors.push_back(attribute.accessorIndex);
+                }
+                const auto [lookup, inserted] = m_primitive_entry_lookup.emplace(std::move(key), m_primitive_entries.size());
+                if (inserted) {
+                    m_primitive_entries.push_back(Primitive_entry{.primitive = &primitive});
+                }
+                entry_indices[i] = lookup->second;
+            }
         }
+    }
+
+    // Converts accessor data to triangle soup, and optionally builds
+    // geometry and raytrace BVH. Runs on worker threads; no GL calls.
+    void prepare_primitive_entry(Primitive_entry& primitive_entry)
+    {
+        ERHE_PROFILE_FUNCTION();
 
-        for (const auto& old_entry : m_primitive_entries) {
-            if (old_entry.index_accessor != primitive_entry.index_accessor) continue;
-            if (old_entry.attribute_accessors != primitive_entry.attribute_accessors) continue;
-            // Found existing entry
-            primitive_entry = old_entry;
+        load_new_primitive_geometry(*primitive_entry.primitive, primitive_entry);
+        if (!primitive_entry.triangle_soup) {
             return;
         }
-
-        load_new_primitive_geometry(primitive, primitive_entry);
+        erhe::primitive::optimize_triangle_soup(*primitive_entry.triangle_soup.get(), m_arguments.index_optimization);
+        primitive_entry.render_shape = std::make_shared<erhe::primitive::Primitive_render_shape>(primitive_entry.triangle_soup);
+        if (m_arguments.make_geometry || m_arguments.make_raytrace) {
+            primitive_entry.render_shape->make_geometry();
+        }
+        if (m_arguments.make_raytrace) {
+            primitive_entry.render_shape->make_raytrace();
+        }
     }
 
     void parse_primitive(
         const std::shared_ptr<erhe::scene::Mesh>& erhe_mesh,
-        const fastgltf::Mesh&                     mesh,
+        const std::size_t                         mesh_index,
         const std::size_t                         primitive_index
     )
     {
         ERHE_PROFILE_FUNCTION();
 
-        const fastgltf::Primitive& primitive = mesh.primitives[primitive_index];
-        std::string name = fmt::format("{}[{}]", mesh.name.c_str(), primitive_index);
+        const std::size_t entry_index = m_mesh_primitive_entries[mesh_index][primitive_index];
+        if (entry_index == c_no_primitive_entry) {
+            return;
+        }
+        const Primitive_entry& primitive_entry = m_primitive_entries[entry_index];
+        if (!primitive_entry.render_shape) {
+            return;
+        }
+
+        const fastgltf::Primitive& primitive = m_asset->meshes[mesh_index].primitives[primitive_index];
         std::shared_ptr<erhe::primitive::Material> erhe_material = primitive.materialIndex.has_value()
             ? m_data_out.materials.at(primitive.materialIndex.value())
             : std::shared_ptr<erhe::primitive::Material>{};
 
-        Primitive_entry primitive_entry;
-        get_primitive_geometry(primitive, primitive_entry);
-
-        erhe::primitive::Primitive new_primitive{primitive_entry.triangle_soup};
+        erhe::primitive::Primitive new_primitive{};
+        new_primitive.render_shape = primitive_entry.render_shape;
         erhe_mesh->add_primitive(new_primitive, erhe_material);
     }
     void parse_skin(const std::size_t skin_index)
@@ -1317,6 +1499,10 @@ private:
 
         if (skin.inverseBindMatrices.has_value()) {
             const fastgltf::Accessor& inverseBindMatrixAccessor = m_asset->accessors[skin.inverseBindMatrices.value()];
+            if (!is_accessor_in_range(m_asset.get(), inverseBindMatrixAccessor)) {
+                log_gltf->error("Skin `{}` inverse bind matrix accessor is out of buffer range", skin_name);
+                return;
+            }
             fastgltf::iterateAccessorWithIndex<fastgltf::math::fmat4x4>(
                 m_asset.get(), inverseBindMatrixAccessor,
                 [&](const fastgltf::math::fmat4x4 matrix, std::size_t index) {
@@ -1354,7 +1540,7 @@ private:
             Item_flags::id
         );
         for (std::size_t i = 0, end = mesh.primitives.size(); i < end; ++i) {
-            parse_primitive(erhe_mesh, mesh, i);
+            parse_primitive(erhe_mesh, mesh_index, i);
         }
     }
 
@@ -1446,22 +1632,28 @@ auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data
     erhe::time::Timer timer{"parse_gltf"};
     timer.begin();
 
-    fastgltf::Expected<fastgltf::GltfDataBuffer> data = fastgltf::GltfDataBuffer::FromPath(arguments.path);
-    if (data.error() != fastgltf::Error::None) {
-        log_gltf->error("glTF load error: {}", fastgltf::getErrorMessage(data.error()));
+    std::unique_ptr<fastgltf::GltfDataGetter> data = open_gltf_file(arguments.path);
+    if (!data) {
         return {};
     }
 
+    // External buffers are not loaded by fastgltf, they are memory mapped
+    // by map_external_buffers(). Mapped files are closed when parsing is
+    // done; triangle soups and images own copies of the data they need.
     fastgltf::Parser fastgltf_parser;
     fastgltf::Expected<fastgltf::Asset> asset = fastgltf_parser.loadGltf(
-        data.get(),
+        *data.get(),
         arguments.path.parent_path(),
-        fastgltf::Options::LoadExternalBuffers // TODO Consider | fastgltf::Options::DecomposeNodeMatrices
+        fastgltf::Options::None // TODO Consider fastgltf::Options::DecomposeNodeMatrices
     );
     if (auto error = asset.error(); error != fastgltf::Error::None) {
         log_gltf->error("glTF parse error: {}", fastgltf::getErrorMessage(error));
         return {};
     }
+    std::vector<erhe::file::Mapped_file> mapped_buffers;
+    if (!map_external_buffers(asset.get(), arguments.path.parent_path(), mapped_buffers)) {
+        return {};
+    }
 
     Gltf_data result;
     Gltf_parser erhe_parser{std::move(asset), result, arguments};
@@ -1482,15 +1674,14 @@ auto scan_gltf(std::filesystem::path path) -> Gltf_scan
     erhe::time::Timer timer{"scan_gltf"};
     timer.begin();
 
-    fastgltf::Expected<fastgltf::GltfDataBuffer> data = fastgltf::GltfDataBuffer::FromPath(path);
-    if (data.error() != fastgltf::Error::None) {
-        log_gltf->error("glTF load error: {}", fastgltf::getErrorMessage(data.error()));
+    std::unique_ptr<fastgltf::GltfDataGetter> data = open_gltf_file(path);
+    if (!data) {
         return {};
     }
 
     fastgltf::Parser fastgltf_parser;
     fastgltf::Expected<fastgltf::Asset> asset_expected = fastgltf_parser.loadGltf(
-        data.get(),
+        *data.get(),
         path.parent_path(),
         fastgltf::Options::None
     );
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "erhe_primitive/build_info.hpp"
+
 #include <memory>
 #include <filesystem>
 #include <vector>
 
+namespace erhe::concurrency {
+    class Thread_pool;
+}
 namespace erhe::geometry {
     class Geometry;
 }
@@ -64,11 +69,24 @@ public:
 
 struct Gltf_parse_arguments
 {
-    erhe::graphics::Instance&                 graphics_instance;
-    Image_transfer&                           image_transfer;
+    // Both nullptr for headless parsing: images are decoded but no
+    // textures or samplers are created
+    erhe::graphics::Instance*                 graphics_instance{nullptr};
+    Image_transfer*                           image_transfer{nullptr};
     const std::shared_ptr<erhe::scene::Node>& root_node;
     erhe::scene::Layer_id                     mesh_layer_id{};
     std::filesystem::path                     path;
+
+    // Build geometry and raytrace data for primitives on worker threads
+    // while parsing, instead of leaving it to the caller
+    bool                                      make_geometry{false};
+    bool                                      make_raytrace{false};
+
+    // Reorder triangle soup indices and vertices before anything is made from them
+    erhe::primitive::Index_optimization       index_optimization{};
+
+    // Pool for CPU heavy stages, nullptr uses Thread_pool::get_instance()
+    erhe::concurrency::Thread_pool*           thread_pool{nullptr};
 };
 
 [[nodiscard]] auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data;
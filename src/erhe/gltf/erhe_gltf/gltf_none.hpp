@@ -71,12 +71,14 @@ enum class Coordinate_system : unsigned int {
 
 struct Gltf_parse_arguments
 {
-    erhe::graphics::Instance&                 graphics_instance;
-    Image_transfer&                           image_transfer;
+    erhe::graphics::Instance*                 graphics_instance{nullptr};
+    Image_transfer*                           image_transfer{nullptr};
     const std::shared_ptr<erhe::scene::Node>& root_node;
     erhe::scene::Layer_id                     mesh_layer_id;
     std::filesystem::path                     path;
     Coordinate_system                         coordinate_system{Coordinate_system::Y_up};
+    bool                                      make_geometry{false};
+    bool                                      make_raytrace{false};
 };
 
 [[nodiscard]] auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data;
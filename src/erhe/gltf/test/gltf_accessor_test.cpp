@@ -0,0 +1,623 @@
+// Tests for glTF accessor bulk copies and buffer range checks.
+//
+// copy_indices(): tightly packed 8, 16 and 32 bit indices are copied in
+// bulk; strided index views are left to element by element reads, which
+// must then give the same indices; accessors that do not fit in their
+// buffer view, views that do not fit in their buffer, unloaded (URI)
+// buffers and bad buffer view indices are rejected.
+//
+// copyComponentsFromAccessor(): matching source and destination stride
+// (single memcpy) and mismatched strides for every element size give the
+// source elements and leave other destination bytes untouched; out of
+// range accessors are rejected without writing.
+//
+// copy_interleaved_vertices(): a buffer view with the target vertex layout
+// is copied in one go, also at an offset; other strides, attributes in
+// separate views and out of range views are rejected.
+//
+// parse_gltf(): missing or truncated external buffers fail the import, and
+// primitives with out of range index or attribute accessors are dropped
+// instead of being imported with zero filled data.
+
+#include "erhe_gltf/gltf.hpp"
+#include "erhe_gltf/gltf_accessor.hpp"
+#include "erhe_gltf/gltf_log.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_file/file_log.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_graphics/graphics_log.hpp"
+#include "erhe_graphics/vertex_attribute.hpp"
+#include "erhe_graphics/vertex_format.hpp"
+#include "erhe_log/log.hpp"
+#include "erhe_primitive/primitive.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_scene/mesh.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_log.hpp"
+
+#include <fastgltf/tools.hpp>
+#include <fastgltf/types.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace erhe::gltf;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+template <typename T>
+void append(std::vector<std::byte>& bytes, const T value)
+{
+    const std::size_t offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+auto read(const std::byte* bytes) -> T
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// In memory asset; buffers are byte views of storage owned here, like
+// memory mapped external buffers
+class Test_asset
+{
+public:
+    auto add_buffer(std::vector<std::byte>&& bytes) -> std::size_t
+    {
+        const std::vector<std::byte>& stored = m_storage.emplace_back(std::move(bytes));
+        fastgltf::Buffer buffer{};
+        buffer.byteLength = stored.size();
+        buffer.data = fastgltf::sources::ByteView{
+            .bytes    = fastgltf::span<const std::byte>{stored.data(), stored.size()},
+            .mimeType = fastgltf::MimeType::GltfBuffer
+        };
+        asset.buffers.push_back(std::move(buffer));
+        return asset.buffers.size() - 1;
+    }
+
+    auto add_unloaded_buffer(const std::size_t byte_length) -> std::size_t
+    {
+        fastgltf::Buffer buffer{};
+        buffer.byteLength = byte_length;
+        buffer.data = fastgltf::sources::URI{};
+        asset.buffers.push_back(std::move(buffer));
+        return asset.buffers.size() - 1;
+    }
+
+    auto add_buffer_view(
+        const std::size_t                buffer_index,
+        const std::size_t                byte_offset,
+        const std::size_t                byte_length,
+        const std::optional<std::size_t> byte_stride = {}
+    ) -> std::size_t
+    {
+        fastgltf::BufferView buffer_view{};
+        buffer_view.bufferIndex = buffer_index;
+        buffer_view.byteOffset  = byte_offset;
+        buffer_view.byteLength  = byte_length;
+        if (byte_stride.has_value()) {
+            buffer_view.byteStride = byte_stride.value();
+        }
+        asset.bufferViews.push_back(std::move(buffer_view));
+        return asset.bufferViews.size() - 1;
+    }
+
+    auto add_accessor(
+        const std::optional<std::size_t> buffer_view_index,
+        const std::size_t                byte_offset,
+        const std::size_t                count,
+        const fastgltf::AccessorType     type,
+        const fastgltf::ComponentType    component_type
+    ) -> std::size_t
+    {
+        fastgltf::Accessor accessor{};
+        if (buffer_view_index.has_value()) {
+            accessor.bufferViewIndex = buffer_view_index.value();
+        }
+        accessor.byteOffset    = byte_offset;
+        accessor.count         = count;
+        accessor.type          = type;
+        accessor.componentType = component_type;
+        asset.accessors.push_back(std::move(accessor));
+        return asset.accessors.size() - 1;
+    }
+
+    fastgltf::Asset asset;
+
+private:
+    std::list<std::vector<std::byte>> m_storage;
+};
+
+const uint32_t c_indices[] = { 0, 1, 2, 2, 1, 3, 250, 7, 65, 9, 4, 200 };
+constexpr std::size_t c_index_count = std::size(c_indices);
+
+auto read_indices_element_by_element(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor) -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> result(accessor.count);
+    fastgltf::iterateAccessorWithIndex<uint32_t>(
+        asset, accessor,
+        [&](const uint32_t value, const std::size_t index) {
+            result[index] = value;
+        }
+    );
+    return result;
+}
+
+auto matches_indices(const std::vector<uint32_t>& indices) -> bool
+{
+    return (indices.size() == c_index_count) && std::equal(indices.begin(), indices.end(), std::begin(c_indices));
+}
+
+void test_copy_indices()
+{
+    Test_asset test;
+
+    // Tightly packed 32, 16 and 8 bit indices, after 4 bytes of padding
+    std::vector<std::byte> bytes(4);
+    const std::size_t u32_offset = bytes.size();
+    for (const uint32_t index : c_indices) { append(bytes, index); }
+    const std::size_t u16_offset = bytes.size();
+    for (const uint32_t index : c_indices) { append(bytes, static_cast<uint16_t>(index)); }
+    const std::size_t u8_offset = bytes.size();
+    for (const uint32_t index : c_indices) { append(bytes, static_cast<uint8_t>(index)); }
+    // 32 bit indices with 8 byte stride
+    const std::size_t strided_offset = bytes.size();
+    for (const uint32_t index : c_indices) { append(bytes, index); append(bytes, uint32_t{0xdeadbeefu}); }
+    const std::size_t buffer_size = bytes.size();
+    const std::size_t buffer = test.add_buffer(std::move(bytes));
+
+    using fastgltf::AccessorType;
+    using fastgltf::ComponentType;
+    const std::size_t u32_view     = test.add_buffer_view(buffer, 0,              u32_offset + c_index_count * 4);
+    const std::size_t u16_view     = test.add_buffer_view(buffer, u16_offset,     c_index_count * 2);
+    const std::size_t u8_view      = test.add_buffer_view(buffer, u8_offset,      c_index_count);
+    const std::size_t strided_view = test.add_buffer_view(buffer, strided_offset, c_index_count * 8, 8);
+    const std::size_t u32          = test.add_accessor(u32_view,     u32_offset, c_index_count, AccessorType::Scalar, ComponentType::UnsignedInt);
+    const std::size_t u16          = test.add_accessor(u16_view,     0,          c_index_count, AccessorType::Scalar, ComponentType::UnsignedShort);
+    const std::size_t u8           = test.add_accessor(u8_view,      0,          c_index_count, AccessorType::Scalar, ComponentType::UnsignedByte);
+    const std::size_t strided      = test.add_accessor(strided_view, 0,          c_index_count, AccessorType::Scalar, ComponentType::UnsignedInt);
+
+    // Out of range cases
+    const std::size_t too_many       = test.add_accessor(u32_view, u32_offset,     c_index_count + 1, AccessorType::Scalar, ComponentType::UnsignedInt);
+    const std::size_t offset_past    = test.add_accessor(u32_view, u32_offset + 4, c_index_count,     AccessorType::Scalar, ComponentType::UnsignedInt);
+    const std::size_t view_past      = test.add_buffer_view(buffer, buffer_size - 8, 16);
+    const std::size_t in_view_past   = test.add_accessor(view_past, 0, 2, AccessorType::Scalar, ComponentType::UnsignedInt);
+    const std::size_t strided_past   = test.add_accessor(strided_view, 8, c_index_count, AccessorType::Scalar, ComponentType::UnsignedInt);
+    const std::size_t unloaded       = test.add_unloaded_buffer(64);
+    const std::size_t unloaded_view  = test.add_buffer_view(unloaded, 0, 64);
+    const std::size_t in_unloaded    = test.add_accessor(unloaded_view, 0, 4, AccessorType::Scalar, ComponentType::UnsignedInt);
+    const std::size_t bad_view_index = test.add_accessor(std::size_t{1000}, 0, 4, AccessorType::Scalar, ComponentType::UnsignedInt);
+
+    const fastgltf::Asset& asset = test.asset;
+    for (const std::size_t accessor_index : { u32, u16, u8 }) {
+        const fastgltf::Accessor& accessor = asset.accessors[accessor_index];
+        std::vector<uint32_t> indices(accessor.count, 0xffffffffu);
+        check(is_accessor_in_range(asset, accessor),                     "copy_indices: packed accessor is in range");
+        check(copy_indices(asset, accessor, indices),                    "copy_indices: packed indices are copied in bulk");
+        check(matches_indices(indices),                                  "copy_indices: packed indices match source");
+        check(matches_indices(read_indices_element_by_element(asset, accessor)), "copy_indices: element reads match source");
+    }
+
+    // Stride differs from index size; caller reads element by element
+    {
+        const fastgltf::Accessor& accessor = asset.accessors[strided];
+        std::vector<uint32_t> indices(accessor.count, 0xffffffffu);
+        check(is_accessor_in_range(asset, accessor),                              "copy_indices: strided accessor is in range");
+        check(!copy_indices(asset, accessor, indices),                            "copy_indices: strided indices are not copied in bulk");
+        check(matches_indices(read_indices_element_by_element(asset, accessor)), "copy_indices: strided element reads match source");
+    }
+
+    for (const std::size_t accessor_index : { too_many, offset_past, in_view_past, strided_past, in_unloaded, bad_view_index }) {
+        const fastgltf::Accessor& accessor = asset.accessors[accessor_index];
+        std::vector<uint32_t> indices(accessor.count, 0xffffffffu);
+        check(!is_accessor_in_range(asset, accessor),   "copy_indices: out of range accessor is detected");
+        check(!copy_indices(asset, accessor, indices),  "copy_indices: out of range accessor is not copied");
+        check(std::all_of(indices.begin(), indices.end(), [](const uint32_t i) { return i == 0xffffffffu; }), "copy_indices: out of range accessor writes nothing");
+    }
+    check(get_buffer_view_bytes(asset, view_past).empty(),     "get_buffer_view_bytes: view past end of buffer is empty");
+    check(get_buffer_view_bytes(asset, unloaded_view).empty(), "get_buffer_view_bytes: view of unloaded buffer is empty");
+    check(get_buffer_view_bytes(asset, 1000).empty(),          "get_buffer_view_bytes: bad view index is empty");
+}
+
+void test_copy_components()
+{
+    Test_asset test;
+    using fastgltf::AccessorType;
+    using fastgltf::ComponentType;
+
+    constexpr std::size_t count = 37;
+
+    // Interleaved source: float vec3 at 0, float vec2 at 12, float vec4 at
+    // 20, u16 vec3 at 36, float at 44, stride 48
+    constexpr std::size_t source_stride = 48;
+    std::vector<std::byte> bytes;
+    for (std::size_t i = 0; i < count; ++i) {
+        const float f = static_cast<float>(i);
+        for (const float v : { f, f + 0.25f, f + 0.5f, f + 1.0f, f + 1.25f, f + 2.0f, f + 2.25f, f + 2.5f, f + 2.75f }) {
+            append(bytes, v);
+        }
+        for (const uint16_t v : { static_cast<uint16_t>(i), static_cast<uint16_t>(i + 100), static_cast<uint16_t>(i + 200) }) {
+            append(bytes, v);
+        }
+        append(bytes, uint16_t{0});
+        append(bytes, f + 3.0f);
+    }
+    // Tightly packed float vec3
+    const std::size_t packed_offset = bytes.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        const float f = static_cast<float>(i);
+        append(bytes, f);
+        append(bytes, f + 0.25f);
+        append(bytes, f + 0.5f);
+    }
+    const std::size_t buffer = test.add_buffer(std::move(bytes));
+
+    const std::size_t interleaved_view = test.add_buffer_view(buffer, 0, packed_offset, source_stride);
+    const std::size_t packed_view      = test.add_buffer_view(buffer, packed_offset, count * 12);
+
+    class Case
+    {
+    public:
+        const char*             label;
+        std::size_t             view;
+        std::size_t             byte_offset;
+        AccessorType            type;
+        ComponentType           component_type;
+        std::size_t             element_size;
+        std::size_t             source_stride;
+        std::size_t             source_offset; // In buffer
+    };
+    const Case cases[] = {
+        { "packed vec3",        packed_view,      0,  AccessorType::Vec3,   ComponentType::Float,         12, 12,            packed_offset },
+        { "interleaved vec3",   interleaved_view, 0,  AccessorType::Vec3,   ComponentType::Float,         12, source_stride, 0  },
+        { "interleaved vec2",   interleaved_view, 12, AccessorType::Vec2,   ComponentType::Float,          8, source_stride, 12 },
+        { "interleaved vec4",   interleaved_view, 20, AccessorType::Vec4,   ComponentType::Float,         16, source_stride, 20 },
+        { "interleaved u16x3",  interleaved_view, 36, AccessorType::Vec3,   ComponentType::UnsignedShort,  6, source_stride, 36 },
+        { "interleaved scalar", interleaved_view, 44, AccessorType::Scalar, ComponentType::Float,          4, source_stride, 44 },
+    };
+
+    const std::span<const std::byte> buffer_bytes = get_buffer_bytes(test.asset.buffers[buffer]);
+    constexpr std::byte sentinel{0xab};
+    for (const Case& c : cases) {
+        const std::size_t accessor_index = test.add_accessor(c.view, c.byte_offset, count, c.type, c.component_type);
+        const fastgltf::Accessor& accessor = test.asset.accessors[accessor_index];
+
+        // Same destination stride as element size (memcpy when source is
+        // packed too), and wider destination stride with padding
+        for (const std::size_t destination_stride : { c.element_size, c.element_size + 6 }) {
+            std::vector<std::byte> destination(count * destination_stride, sentinel);
+            const bool copied = copyComponentsFromAccessor(test.asset, accessor, destination.data(), destination_stride, count);
+            bool elements_match = true;
+            bool padding_kept   = true;
+            for (std::size_t i = 0; i < count; ++i) {
+                const std::byte* expected = buffer_bytes.data() + c.source_offset + i * c.source_stride;
+                const std::byte* actual   = destination.data() + i * destination_stride;
+                elements_match = elements_match && (std::memcmp(expected, actual, c.element_size) == 0);
+                for (std::size_t j = c.element_size; j < destination_stride; ++j) {
+                    padding_kept = padding_kept && (actual[j] == sentinel);
+                }
+            }
+            if (!copied || !elements_match || !padding_kept) {
+                fmt::print(stderr, "{}, destination stride {}\n", c.label, destination_stride);
+            }
+            check(copied,         "copyComponentsFromAccessor: in range accessor is copied");
+            check(elements_match, "copyComponentsFromAccessor: elements match source");
+            check(padding_kept,   "copyComponentsFromAccessor: bytes between elements are not written");
+        }
+    }
+
+    // Count limited to accessor count
+    {
+        const std::size_t accessor_index = test.add_accessor(packed_view, 0, 5, AccessorType::Vec3, ComponentType::Float);
+        std::vector<std::byte> destination(count * 12, sentinel);
+        check(copyComponentsFromAccessor(test.asset, test.asset.accessors[accessor_index], destination.data(), 12, count), "copyComponentsFromAccessor: short accessor is copied");
+        check((destination[5 * 12 - 1] != sentinel) && (destination[5 * 12] == sentinel), "copyComponentsFromAccessor: copies at most accessor count elements");
+    }
+
+    // Without buffer view accessor reads as zeros; destination is left as is
+    {
+        const std::size_t accessor_index = test.add_accessor(std::nullopt, 0, count, AccessorType::Vec3, ComponentType::Float);
+        std::vector<std::byte> destination(count * 12, sentinel);
+        check(copyComponentsFromAccessor(test.asset, test.asset.accessors[accessor_index], destination.data(), 12, count), "copyComponentsFromAccessor: accessor without buffer view succeeds");
+        check(destination.front() == sentinel, "copyComponentsFromAccessor: accessor without buffer view writes nothing");
+    }
+
+    // Out of range: interleaved accessor one element too long, packed view
+    // read at an offset, bad buffer view index
+    const std::size_t too_many    = test.add_accessor(interleaved_view, 0,  count + 1, AccessorType::Vec3, ComponentType::Float);
+    const std::size_t offset_past = test.add_accessor(packed_view,      12, count,     AccessorType::Vec3, ComponentType::Float);
+    const std::size_t bad_view    = test.add_accessor(std::size_t{1000}, 0, count,     AccessorType::Vec3, ComponentType::Float);
+    for (const std::size_t accessor_index : { too_many, offset_past, bad_view }) {
+        const fastgltf::Accessor& accessor = test.asset.accessors[accessor_index];
+        std::vector<std::byte> destination((count + 1) * 12, sentinel);
+        check(!is_accessor_in_range(test.asset, accessor), "copyComponentsFromAccessor: out of range accessor is detected");
+        check(!copyComponentsFromAccessor(test.asset, accessor, destination.data(), 12, count + 1), "copyComponentsFromAccessor: out of range accessor fails");
+        check(std::all_of(destination.begin(), destination.end(), [](const std::byte b) { return b == sentinel; }), "copyComponentsFromAccessor: out of range accessor writes nothing");
+    }
+}
+
+auto make_vertex_format() -> erhe::graphics::Vertex_format
+{
+    using erhe::graphics::Vertex_attribute;
+    using erhe::graphics::Glsl_type;
+    using erhe::dataformat::Format;
+    return erhe::graphics::Vertex_format{
+        Vertex_attribute{ .name = "POSITION",   .usage = { Vertex_attribute::Usage_type::position  }, .shader_type = Glsl_type::float_vec3, .data_type = Format::format_32_vec3_float },
+        Vertex_attribute{ .name = "NORMAL",     .usage = { Vertex_attribute::Usage_type::normal    }, .shader_type = Glsl_type::float_vec3, .data_type = Format::format_32_vec3_float },
+        Vertex_attribute{ .name = "TEXCOORD_0", .usage = { Vertex_attribute::Usage_type::tex_coord }, .shader_type = Glsl_type::float_vec2, .data_type = Format::format_32_vec2_float }
+    };
+}
+
+// Builds buffer with vertices in target layout at base_offset, using
+// given stride, and primitive with one accessor per attribute
+auto make_interleaved(
+    Test_asset&                          test,
+    const erhe::graphics::Vertex_format& vertex_format,
+    const std::size_t                    vertex_count,
+    const std::size_t                    base_offset,
+    const std::size_t                    stride,
+    const std::size_t                    view_vertex_count
+) -> fastgltf::Primitive
+{
+    std::vector<std::byte> bytes(base_offset + stride * vertex_count, std::byte{0});
+    for (std::size_t i = 0; i < vertex_count; ++i) {
+        for (std::size_t j = 0; j < vertex_format.stride(); j += sizeof(float)) {
+            const float value = static_cast<float>(i) + 0.125f * static_cast<float>(j);
+            std::memcpy(bytes.data() + base_offset + i * stride + j, &value, sizeof(float));
+        }
+    }
+    const std::size_t view_length = std::min(bytes.size(), base_offset + stride * view_vertex_count);
+    const std::size_t buffer      = test.add_buffer(std::move(bytes));
+    const std::size_t view        = test.add_buffer_view(buffer, 0, view_length, stride);
+
+    fastgltf::Primitive primitive{};
+    for (const erhe::graphics::Vertex_attribute& attribute : vertex_format.get_attributes()) {
+        const bool is_vec2 = (attribute.data_type == erhe::dataformat::Format::format_32_vec2_float);
+        fastgltf::Attribute gltf_attribute{};
+        gltf_attribute.name          = attribute.name.c_str();
+        gltf_attribute.accessorIndex = test.add_accessor(
+            view, base_offset + attribute.offset, vertex_count,
+            is_vec2 ? fastgltf::AccessorType::Vec2 : fastgltf::AccessorType::Vec3,
+            fastgltf::ComponentType::Float
+        );
+        primitive.attributes.push_back(std::move(gltf_attribute));
+    }
+    return primitive;
+}
+
+// Copies attributes one by one, like import does when interleaved copy
+// is not possible
+auto copy_attributes(
+    const fastgltf::Asset&               asset,
+    const fastgltf::Primitive&           primitive,
+    const erhe::graphics::Vertex_format& vertex_format,
+    const std::size_t                    vertex_count,
+    std::vector<uint8_t>&                vertex_data
+) -> bool
+{
+    for (std::size_t i = 0, end = primitive.attributes.size(); i < end; ++i) {
+        const fastgltf::Accessor& accessor = asset.accessors[primitive.attributes[i].accessorIndex];
+        const std::size_t         offset   = vertex_format.get_attributes()[i].offset;
+        if (!copyComponentsFromAccessor(asset, accessor, vertex_data.data() + offset, vertex_format.stride(), vertex_count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto vertex_value(const std::vector<uint8_t>& vertex_data, const std::size_t stride, const std::size_t vertex, const std::size_t byte) -> float
+{
+    return read<float>(reinterpret_cast<const std::byte*>(vertex_data.data() + vertex * stride + byte));
+}
+
+auto vertices_match(const std::vector<uint8_t>& vertex_data, const std::size_t stride, const std::size_t vertex_count) -> bool
+{
+    for (std::size_t i = 0; i < vertex_count; ++i) {
+        for (std::size_t j = 0; j < stride; j += sizeof(float)) {
+            if (vertex_value(vertex_data, stride, i, j) != static_cast<float>(i) + 0.125f * static_cast<float>(j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_copy_interleaved_vertices()
+{
+    const erhe::graphics::Vertex_format vertex_format = make_vertex_format();
+    const std::size_t stride       = vertex_format.stride();
+    const std::size_t vertex_count = 53;
+    const std::vector<erhe::graphics::Vertex_attribute>& attributes = vertex_format.get_attributes();
+
+    // Same layout as target, at start of view and after other data
+    for (const std::size_t base_offset : { std::size_t{0}, std::size_t{24} }) {
+        Test_asset test;
+        const fastgltf::Primitive primitive = make_interleaved(test, vertex_format, vertex_count, base_offset, stride, vertex_count);
+        std::vector<uint8_t> vertex_data(vertex_count * stride, 0);
+        check(copy_interleaved_vertices(test.asset, primitive, attributes, stride, vertex_count, vertex_data), "copy_interleaved_vertices: matching layout is copied in one go");
+        check(vertices_match(vertex_data, stride, vertex_count),                                                "copy_interleaved_vertices: vertices match source");
+    }
+
+    // Wider source stride; attributes are copied one by one
+    {
+        Test_asset test;
+        const fastgltf::Primitive primitive = make_interleaved(test, vertex_format, vertex_count, 0, stride + 8, vertex_count);
+        std::vector<uint8_t> vertex_data(vertex_count * stride, 0);
+        check(!copy_interleaved_vertices(test.asset, primitive, attributes, stride, vertex_count, vertex_data), "copy_interleaved_vertices: other stride is not copied in one go");
+        check(copy_attributes(test.asset, primitive, vertex_format, vertex_count, vertex_data),                 "copy_interleaved_vertices: other stride is copied per attribute");
+        check(vertices_match(vertex_data, stride, vertex_count),                                                 "copy_interleaved_vertices: per attribute copy matches source");
+    }
+
+    // Attributes in separate views
+    {
+        Test_asset test;
+        fastgltf::Primitive primitive = make_interleaved(test, vertex_format, vertex_count, 0, stride, vertex_count);
+        const fastgltf::Accessor& normal = test.asset.accessors[primitive.attributes[1].accessorIndex];
+        const std::size_t separate_view = test.add_buffer_view(
+            test.asset.bufferViews[normal.bufferViewIndex.value()].bufferIndex, 0, vertex_count * stride, stride
+        );
+        primitive.attributes[1].accessorIndex = test.add_accessor(separate_view, normal.byteOffset, vertex_count, normal.type, normal.componentType);
+        std::vector<uint8_t> vertex_data(vertex_count * stride, 0);
+        check(!copy_interleaved_vertices(test.asset, primitive, attributes, stride, vertex_count, vertex_data), "copy_interleaved_vertices: separate views are not copied in one go");
+        check(copy_attributes(test.asset, primitive, vertex_format, vertex_count, vertex_data),                 "copy_interleaved_vertices: separate views are copied per attribute");
+        check(vertices_match(vertex_data, stride, vertex_count),                                                 "copy_interleaved_vertices: separate views match source");
+    }
+
+    // View one vertex short of accessor count
+    for (const std::size_t source_stride : { stride, stride + 8 }) {
+        Test_asset test;
+        const fastgltf::Primitive primitive = make_interleaved(test, vertex_format, vertex_count, 0, source_stride, vertex_count - 1);
+        std::vector<uint8_t> vertex_data(vertex_count * stride, 0);
+        check(!copy_interleaved_vertices(test.asset, primitive, attributes, stride, vertex_count, vertex_data), "copy_interleaved_vertices: out of range view is not copied");
+        check(!copy_attributes(test.asset, primitive, vertex_format, vertex_count, vertex_data),                "copy_interleaved_vertices: out of range view fails per attribute");
+        check(std::all_of(vertex_data.begin(), vertex_data.end(), [](const uint8_t b) { return b == 0; }),      "copy_interleaved_vertices: out of range view writes nothing");
+    }
+}
+
+// Writes single triangle glTF with external buffer. Index or position
+// accessor count can be made larger than its buffer view.
+auto write_triangle_gltf(
+    const std::filesystem::path& directory,
+    const std::string&           name,
+    const std::size_t            index_count_extra,
+    const std::size_t            position_count_extra,
+    const std::size_t            bin_bytes_written_short
+) -> std::filesystem::path
+{
+    std::vector<std::byte> bin;
+    for (const float v : { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }) {
+        append(bin, v);
+    }
+    for (const uint32_t i : { 0u, 1u, 2u }) {
+        append(bin, i);
+    }
+    const std::filesystem::path bin_path  = directory / (name + ".bin");
+    const std::filesystem::path gltf_path = directory / (name + ".gltf");
+    {
+        std::ofstream bin_file{bin_path, std::ios::binary};
+        bin_file.write(reinterpret_cast<const char*>(bin.data()), static_cast<std::streamsize>(bin.size() - bin_bytes_written_short));
+    }
+    {
+        std::ofstream gltf_file{gltf_path};
+        gltf_file << fmt::format(
+            "{{\"asset\":{{\"version\":\"2.0\"}},\"scene\":0,\"scenes\":[{{\"nodes\":[0]}}],"
+            "\"nodes\":[{{\"mesh\":0}}],"
+            "\"meshes\":[{{\"primitives\":[{{\"attributes\":{{\"POSITION\":0}},\"indices\":1}}]}}],"
+            "\"accessors\":["
+            "{{\"bufferView\":0,\"componentType\":5126,\"count\":{},\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[1,0,1]}},"
+            "{{\"bufferView\":1,\"componentType\":5125,\"count\":{},\"type\":\"SCALAR\"}}],"
+            "\"bufferViews\":["
+            "{{\"buffer\":0,\"byteOffset\":0,\"byteLength\":36}},"
+            "{{\"buffer\":0,\"byteOffset\":36,\"byteLength\":12}}],"
+            "\"buffers\":[{{\"uri\":\"{}\",\"byteLength\":{}}}]}}\n",
+            3 + position_count_extra, 3 + index_count_extra, bin_path.filename().string(), bin.size()
+        );
+    }
+    return gltf_path;
+}
+
+auto import_primitive_count(const std::filesystem::path& path, std::size_t& mesh_count) -> std::size_t
+{
+    auto root_node = std::make_shared<erhe::scene::Node>("root");
+    erhe::concurrency::Thread_pool thread_pool{2};
+    const Gltf_data gltf_data = parse_gltf(
+        Gltf_parse_arguments{
+            .root_node     = root_node,
+            .path          = path,
+            .make_geometry = true,
+            .thread_pool   = &thread_pool
+        }
+    );
+    mesh_count = 0;
+    std::size_t primitive_count = 0;
+    for (const std::shared_ptr<erhe::scene::Mesh>& mesh : gltf_data.meshes) {
+        if (mesh) {
+            ++mesh_count;
+            primitive_count += mesh->get_primitives().size();
+        }
+    }
+    return primitive_count;
+}
+
+void test_parse_gltf()
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::size_t mesh_count = 0;
+
+    const std::filesystem::path valid = write_triangle_gltf(directory, "erhe_gltf_accessor_test_valid", 0, 0, 0);
+    check(import_primitive_count(valid, mesh_count) == 1, "parse_gltf: valid file imports primitive");
+    check(mesh_count == 1,                                "parse_gltf: valid file imports mesh");
+
+    const std::filesystem::path missing = write_triangle_gltf(directory, "erhe_gltf_accessor_test_missing", 0, 0, 0);
+    std::error_code error_code;
+    std::filesystem::remove(directory / "erhe_gltf_accessor_test_missing.bin", error_code);
+    check(import_primitive_count(missing, mesh_count) == 0, "parse_gltf: missing buffer imports no primitives");
+    check(mesh_count == 0,                                  "parse_gltf: missing buffer fails import");
+
+    const std::filesystem::path truncated = write_triangle_gltf(directory, "erhe_gltf_accessor_test_truncated", 0, 0, 5);
+    check(import_primitive_count(truncated, mesh_count) == 0, "parse_gltf: truncated buffer imports no primitives");
+    check(mesh_count == 0,                                    "parse_gltf: truncated buffer fails import");
+
+    const std::filesystem::path bad_indices = write_triangle_gltf(directory, "erhe_gltf_accessor_test_bad_indices", 3, 0, 0);
+    check(import_primitive_count(bad_indices, mesh_count) == 0, "parse_gltf: out of range index accessor drops primitive");
+    check(mesh_count == 1,                                      "parse_gltf: out of range index accessor keeps mesh");
+
+    const std::filesystem::path bad_positions = write_triangle_gltf(directory, "erhe_gltf_accessor_test_bad_positions", 0, 1, 0);
+    check(import_primitive_count(bad_positions, mesh_count) == 0, "parse_gltf: out of range attribute accessor drops primitive");
+    check(mesh_count == 1,                                        "parse_gltf: out of range attribute accessor keeps mesh");
+
+    for (const char* name : { "valid", "missing", "truncated", "bad_indices", "bad_positions" }) {
+        std::filesystem::remove(directory / fmt::format("erhe_gltf_accessor_test_{}.gltf", name), error_code);
+        std::filesystem::remove(directory / fmt::format("erhe_gltf_accessor_test_{}.bin",  name), error_code);
+    }
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::file::initialize_logging();
+    erhe::geometry::initialize_logging();
+    erhe::gltf::initialize_logging();
+    erhe::graphics::initialize_logging();
+    erhe::primitive::initialize_logging();
+    erhe::scene::initialize_logging();
+
+    test_copy_indices();
+    test_copy_components();
+    test_copy_interleaved_vertices();
+    test_parse_gltf();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("glTF accessor tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,279 @@
+// Benchmark for headless glTF import: parse_gltf() CPU stages (primitive
+// conversion, index optimization, geometry and raytrace builds, image
+// decoding and animation samplers) with thread pools of increasing size.
+//
+// Without arguments a synthetic asset with grid meshes is written to a
+// temporary directory. A path to a .gltf or .glb file can be given
+// instead. No graphics context is created; textures and samplers are
+// skipped.
+
+#include "erhe_gltf/gltf.hpp"
+#include "erhe_gltf/gltf_log.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_file/file_log.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_graphics/graphics_log.hpp"
+#include "erhe_log/log.hpp"
+#include "erhe_primitive/primitive.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_scene/mesh.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_time/time_log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& bytes, const T value)
+{
+    const std::size_t offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+// Writes mesh_count separate grid meshes, each with its own accessors,
+// grid_size x grid_size quads, positions, normals and texture coordinates.
+auto write_synthetic_gltf(const std::filesystem::path& directory, const std::size_t mesh_count, const std::size_t grid_size) -> std::filesystem::path
+{
+    const std::size_t vertex_count = (grid_size + 1) * (grid_size + 1);
+    const std::size_t index_count  = grid_size * grid_size * 6;
+
+    std::vector<uint8_t> bin;
+    std::string buffer_views;
+    std::string accessors;
+    std::string meshes;
+    std::string nodes;
+    std::string scene_nodes;
+    for (std::size_t mesh_index = 0; mesh_index < mesh_count; ++mesh_index) {
+        const std::size_t accessor_base = mesh_index * 4;
+        const float       phase         = static_cast<float>(mesh_index) * 0.37f;
+
+        const std::size_t position_offset = bin.size();
+        for (std::size_t y = 0; y <= grid_size; ++y) {
+            for (std::size_t x = 0; x <= grid_size; ++x) {
+                const float u = static_cast<float>(x) / static_cast<float>(grid_size);
+                const float v = static_cast<float>(y) / static_cast<float>(grid_size);
+                append(bin, u - 0.5f);
+                append(bin, 0.1f * std::sin(8.0f * u + phase) * std::cos(8.0f * v));
+                append(bin, v - 0.5f);
+            }
+        }
+        const std::size_t normal_offset = bin.size();
+        for (std::size_t i = 0; i < vertex_count; ++i) {
+            append(bin, 0.0f);
+            append(bin, 1.0f);
+            append(bin, 0.0f);
+        }
+        const std::size_t texcoord_offset = bin.size();
+        for (std::size_t y = 0; y <= grid_size; ++y) {
+            for (std::size_t x = 0; x <= grid_size; ++x) {
+                append(bin, static_cast<float>(x) / static_cast<float>(grid_size));
+                append(bin, static_cast<float>(y) / static_cast<float>(grid_size));
+            }
+        }
+        const std::size_t index_offset = bin.size();
+        for (std::size_t y = 0; y < grid_size; ++y) {
+            for (std::size_t x = 0; x < grid_size; ++x) {
+                const uint32_t i0 = static_cast<uint32_t>(y * (grid_size + 1) + x);
+                const uint32_t i1 = i0 + 1;
+                const uint32_t i2 = i0 + static_cast<uint32_t>(grid_size + 1);
+                const uint32_t i3 = i2 + 1;
+                for (const uint32_t index : {i0, i2, i1, i1, i2, i3}) {
+                    append(bin, index);
+                }
+            }
+        }
+
+        const char* separator = (mesh_index == 0) ? "" : ",";
+        buffer_views += fmt::format(
+            "{}{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":34962}},"
+            "{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":34962}},"
+            "{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":34962}},"
+            "{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":34963}}",
+            separator,
+            position_offset, normal_offset   - position_offset,
+            normal_offset,   texcoord_offset - normal_offset,
+            texcoord_offset, index_offset    - texcoord_offset,
+            index_offset,    bin.size()      - index_offset
+        );
+        accessors += fmt::format(
+            "{}{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC3\",\"min\":[-0.5,-0.1,-0.5],\"max\":[0.5,0.1,0.5]}},"
+            "{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC3\"}},"
+            "{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC2\"}},"
+            "{{\"bufferView\":{},\"componentType\":5125,\"count\":{},\"type\":\"SCALAR\"}}",
+            separator,
+            accessor_base + 0, vertex_count,
+            accessor_base + 1, vertex_count,
+            accessor_base + 2, vertex_count,
+            accessor_base + 3, index_count
+        );
+        meshes += fmt::format(
+            "{}{{\"name\":\"grid {}\",\"primitives\":[{{\"attributes\":{{\"POSITION\":{},\"NORMAL\":{},\"TEXCOORD_0\":{}}},\"indices\":{}}}]}}",
+            separator, mesh_index, accessor_base + 0, accessor_base + 1, accessor_base + 2, accessor_base + 3
+        );
+        nodes += fmt::format(
+            "{}{{\"name\":\"grid {}\",\"mesh\":{},\"translation\":[{},0,{}]}}",
+            separator, mesh_index, mesh_index, static_cast<float>(mesh_index % 16), static_cast<float>(mesh_index / 16)
+        );
+        scene_nodes += fmt::format("{}{}", separator, mesh_index);
+    }
+
+    const std::filesystem::path bin_path  = directory / "erhe_gltf_import_benchmark.bin";
+    const std::filesystem::path gltf_path = directory / "erhe_gltf_import_benchmark.gltf";
+    {
+        std::ofstream bin_file{bin_path, std::ios::binary};
+        bin_file.write(reinterpret_cast<const char*>(bin.data()), static_cast<std::streamsize>(bin.size()));
+    }
+    {
+        std::ofstream gltf_file{gltf_path};
+        gltf_file << fmt::format(
+            "{{\"asset\":{{\"version\":\"2.0\"}},\"scene\":0,\"scenes\":[{{\"nodes\":[{}]}}],"
+            "\"nodes\":[{}],\"meshes\":[{}],\"accessors\":[{}],\"bufferViews\":[{}],"
+            "\"buffers\":[{{\"uri\":\"{}\",\"byteLength\":{}}}]}}\n",
+            scene_nodes, nodes, meshes, accessors, buffer_views,
+            bin_path.filename().string(), bin.size()
+        );
+    }
+    return gltf_path;
+}
+
+class Import_result
+{
+public:
+    double      seconds        {0.0};
+    std::size_t mesh_count     {0};
+    std::size_t primitive_count{0};
+    std::size_t polygon_count  {0};
+    std::size_t raytrace_count {0};
+};
+
+auto run_import(const std::filesystem::path& path, erhe::concurrency::Thread_pool& thread_pool) -> Import_result
+{
+    auto root_node = std::make_shared<erhe::scene::Node>("root");
+
+    const auto start = Clock::now();
+    erhe::gltf::Gltf_data gltf_data = erhe::gltf::parse_gltf(
+        erhe::gltf::Gltf_parse_arguments{
+            .root_node     = root_node,
+            .path          = path,
+            .make_geometry = true,
+            .make_raytrace = true,
+            .thread_pool   = &thread_pool
+        }
+    );
+    Import_result result{};
+    result.seconds    = seconds_since(start);
+    result.mesh_count = gltf_data.meshes.size();
+    for (const std::shared_ptr<erhe::scene::Mesh>& mesh : gltf_data.meshes) {
+        if (!mesh) {
+            continue;
+        }
+        for (const erhe::primitive::Primitive& primitive : mesh->get_primitives()) {
+            ++result.primitive_count;
+            if (!primitive.render_shape) {
+                continue;
+            }
+            const std::shared_ptr<erhe::geometry::Geometry>& geometry = primitive.render_shape->get_geometry_const();
+            if (geometry) {
+                result.polygon_count += geometry->get_polygon_count();
+            }
+            if (primitive.render_shape->has_raytrace_triangles()) {
+                ++result.raytrace_count;
+            }
+        }
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::file::initialize_logging();
+    erhe::geometry::initialize_logging();
+    erhe::gltf::initialize_logging();
+    erhe::graphics::initialize_logging();
+    erhe::primitive::initialize_logging();
+    erhe::raytrace::initialize_logging();
+    erhe::scene::initialize_logging();
+    erhe::time::initialize_logging();
+
+    const bool        synthetic  = (argc < 2);
+    const std::size_t mesh_count = 64;
+    const std::size_t grid_size  = 64;
+    const std::filesystem::path path = synthetic
+        ? write_synthetic_gltf(std::filesystem::temp_directory_path(), mesh_count, grid_size)
+        : std::filesystem::path{argv[1]};
+    const std::size_t repeat_count = (argc > 2) ? static_cast<std::size_t>(std::stoull(argv[2])) : 3;
+
+    if (synthetic) {
+        fmt::print("synthetic asset: {} meshes, {} triangles each\n", mesh_count, grid_size * grid_size * 2);
+    }
+
+    const std::size_t max_thread_count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t thread_count = 1; thread_count < max_thread_count; thread_count *= 2) {
+        thread_counts.push_back(thread_count);
+    }
+    thread_counts.push_back(max_thread_count);
+
+    bool        ok                     = true;
+    double      baseline_seconds       = 0.0;
+    std::size_t baseline_polygon_count = 0;
+    for (const std::size_t thread_count : thread_counts) {
+        erhe::concurrency::Thread_pool thread_pool{thread_count};
+        double        best_seconds = 0.0;
+        Import_result result{};
+        for (std::size_t repeat = 0; repeat < repeat_count; ++repeat) {
+            result = run_import(path, thread_pool);
+            if ((repeat == 0) || (result.seconds < best_seconds)) {
+                best_seconds = result.seconds;
+            }
+        }
+        if (baseline_seconds == 0.0) {
+            baseline_seconds       = best_seconds;
+            baseline_polygon_count = result.polygon_count;
+        }
+        fmt::print(
+            "{:>3} workers {:>10.3f} ms {:>6.2f}x  meshes {} primitives {} polygons {} raytrace {}\n",
+            thread_count, best_seconds * 1000.0, baseline_seconds / best_seconds,
+            result.mesh_count, result.primitive_count, result.polygon_count, result.raytrace_count
+        );
+        if ((result.primitive_count == 0) || (result.polygon_count != baseline_polygon_count) || (result.raytrace_count != result.primitive_count)) {
+            fmt::print(stderr, "import result mismatch with {} workers\n", thread_count);
+            ok = false;
+        }
+    }
+
+    if (synthetic) {
+        std::error_code error_code;
+        std::filesystem::remove(path, error_code);
+        std::filesystem::remove(path.parent_path() / "erhe_gltf_import_benchmark.bin", error_code);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
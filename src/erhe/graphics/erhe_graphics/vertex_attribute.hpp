@@ -97,6 +97,15 @@ public:
             .data_type   = erhe::dataformat::Format::format_32_vec3_float
         };
     }
+    // Relative to mesh bounding box, see erhe::primitive::Buffer_mesh position_scale and position_offset
+    [[nodiscard]] static auto position_unorm16_3() -> erhe::graphics::Vertex_attribute
+    {
+        return Vertex_attribute{
+            .usage       = { Usage_type::position },
+            .shader_type = Glsl_type::float_vec3,
+            .data_type   = erhe::dataformat::Format::format_16_vec3_unorm
+        };
+    }
     [[nodiscard]] static auto position0_float4() -> erhe::graphics::Vertex_attribute
     {
         return Vertex_attribute{
@@ -139,6 +148,25 @@ public:
             .default_value = glm::vec4{0.0f, 1.0f, 0.0f, 0.0f}
         };
     }
+    // Octahedral encoded unit vector, see erhe::dataformat::encode_octahedral()
+    [[nodiscard]] static auto normal0_octahedral_snorm16() -> Vertex_attribute
+    {
+        return Vertex_attribute{
+            .usage         = {Usage_type::normal },
+            .shader_type   = Glsl_type::float_vec3,
+            .data_type     = erhe::dataformat::Format::format_16_vec2_snorm,
+            .default_value = glm::vec4{0.0f, 1.0f, 0.0f, 0.0f}
+        };
+    }
+    [[nodiscard]] static auto normal1_octahedral_snorm16() -> Vertex_attribute
+    {
+        return Vertex_attribute{
+            .usage         = { Usage_type::normal, 1 },
+            .shader_type   = Glsl_type::float_vec3,
+            .data_type     = erhe::dataformat::Format::format_16_vec2_snorm,
+            .default_value = glm::vec4{0.0f, 1.0f, 0.0f, 0.0f}
+        };
+    }
     [[nodiscard]] static auto tangent_float3() -> Vertex_attribute
     {
         return Vertex_attribute{
@@ -157,6 +185,16 @@ public:
             .default_value = glm::vec4{1.0f, 0.0f, 0.0f, 1.0f}
         };
     }
+    // Octahedral encoded unit vector in xy, handedness sign in z
+    [[nodiscard]] static auto tangent_octahedral_snorm16() -> Vertex_attribute
+    {
+        return Vertex_attribute{
+            .usage         = { Usage_type::tangent },
+            .shader_type   = Glsl_type::float_vec4,
+            .data_type     = erhe::dataformat::Format::format_16_vec3_snorm,
+            .default_value = glm::vec4{1.0f, 0.0f, 1.0f, 0.0f}
+        };
+    }
     [[nodiscard]] static auto bitangent_float3() -> Vertex_attribute
     {
         return Vertex_attribute{
@@ -174,6 +212,14 @@ public:
             .data_type   = erhe::dataformat::Format::format_32_vec2_float
         };
     }
+    [[nodiscard]] static auto texcoord0_half2() -> Vertex_attribute
+    {
+        return Vertex_attribute{
+            .usage       = { Usage_type::tex_coord },
+            .shader_type = Glsl_type::float_vec2,
+            .data_type   = erhe::dataformat::Format::format_16_vec2_float
+        };
+    }
     [[nodiscard]] static auto texcoord1_float2() -> Vertex_attribute
     {
         return Vertex_attribute{
@@ -224,6 +270,14 @@ public:
             .data_type   = erhe::dataformat::Format::format_32_vec4_float
         };
     }
+    [[nodiscard]] static auto joint_weights0_ubyte4() -> Vertex_attribute
+    {
+        return Vertex_attribute{
+            .usage       = { Usage_type::joint_weights },
+            .shader_type = Glsl_type::float_vec4,
+            .data_type   = erhe::dataformat::Format::format_8_vec4_unorm
+        };
+    }
     [[nodiscard]] static auto vertex_valency() -> Vertex_attribute
     {
         return Vertex_attribute{
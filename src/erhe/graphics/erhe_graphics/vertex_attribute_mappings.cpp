@@ -87,6 +87,10 @@ void format_to_gl_attribute(erhe::dataformat::Format format, gl::Vertex_attrib_t
         case erhe::dataformat::Format::format_16_vec4_sscaled:          type = gl::Vertex_attrib_type::short_;         normalized = false; break;
         case erhe::dataformat::Format::format_16_vec4_uint:             type = gl::Vertex_attrib_type::unsigned_short; normalized = false; break;
         case erhe::dataformat::Format::format_16_vec4_sint:             type = gl::Vertex_attrib_type::short_;         normalized = false; break;
+        case erhe::dataformat::Format::format_16_scalar_float:          type = gl::Vertex_attrib_type::half_float;     normalized = false; break;
+        case erhe::dataformat::Format::format_16_vec2_float:            type = gl::Vertex_attrib_type::half_float;     normalized = false; break;
+        case erhe::dataformat::Format::format_16_vec3_float:            type = gl::Vertex_attrib_type::half_float;     normalized = false; break;
+        case erhe::dataformat::Format::format_16_vec4_float:            type = gl::Vertex_attrib_type::half_float;     normalized = false; break;
         case erhe::dataformat::Format::format_32_scalar_unorm:          type = gl::Vertex_attrib_type::unsigned_int;   normalized = true;  break;
         case erhe::dataformat::Format::format_32_scalar_snorm:          type = gl::Vertex_attrib_type::int_;           normalized = true;  break;
         case erhe::dataformat::Format::format_32_scalar_uscaled:        type = gl::Vertex_attrib_type::unsigned_int;   normalized = false; break;
@@ -1 +1,341 @@
 #include "erhe_hash/hash.hpp"
+
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#   include <intrin.h>
+#endif
+
+namespace erhe::hash {
+
+namespace {
+
+constexpr uint64_t c_prime32_1  = 0x9E3779B1U;
+constexpr uint64_t c_prime32_2  = 0x85EBCA77U;
+constexpr uint64_t c_prime32_3  = 0xC2B2AE3DU;
+constexpr uint64_t c_prime64_1  = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t c_prime64_2  = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t c_prime64_3  = 0x165667B19E3779F9ULL;
+constexpr uint64_t c_prime64_4  = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t c_prime64_5  = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t c_prime_mx1  = 0x165667919E3779F9ULL;
+
+constexpr std::size_t c_stripes_per_block  = 16;
+constexpr std::size_t c_key_scramble       = 16; // keys 16..23
+constexpr std::size_t c_key_last_stripe    = 9;  // keys 9..16
+constexpr std::size_t c_key_merge_low      = 24; // keys 24..31
+constexpr std::size_t c_key_merge_high     = 20; // keys 20..27
+constexpr std::size_t c_key_short_high     = 8;
+
+// Secret key material, generated with splitmix64
+constexpr auto make_secret() -> std::array<uint64_t, 32>
+{
+    std::array<uint64_t, 32> secret{};
+    uint64_t state = c_prime64_3;
+    for (uint64_t& value : secret) {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        value = z ^ (z >> 31);
+    }
+    return secret;
+}
+
+constexpr std::array<uint64_t, 32> c_secret = make_secret();
+
+[[nodiscard]] inline auto key(const std::size_t index, const uint64_t seed) -> uint64_t
+{
+    return ((index & 1) == 0) ? c_secret[index] + seed : c_secret[index] - seed;
+}
+
+// Little endian byte order is assumed; on big endian targets results
+// differ, but remain deterministic.
+[[nodiscard]] inline auto read64(const uint8_t* const p) -> uint64_t
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] inline auto read32(const uint8_t* const p) -> uint64_t
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] inline auto mul128_fold64(const uint64_t lhs, const uint64_t rhs) -> uint64_t
+{
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t product = static_cast<__uint128_t>(lhs) * rhs;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+    uint64_t high;
+    const uint64_t low = _umul128(lhs, rhs, &high);
+    return low ^ high;
+#else
+    const uint64_t lo_lo = (lhs & 0xFFFFFFFFULL) * (rhs & 0xFFFFFFFFULL);
+    const uint64_t hi_lo = (lhs >> 32)          * (rhs & 0xFFFFFFFFULL);
+    const uint64_t lo_hi = (lhs & 0xFFFFFFFFULL) * (rhs >> 32);
+    const uint64_t hi_hi = (lhs >> 32)          * (rhs >> 32);
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+    const uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFFULL);
+    return lower ^ upper;
+#endif
+}
+
+[[nodiscard]] inline auto avalanche(uint64_t h) -> uint64_t
+{
+    h ^= h >> 37;
+    h *= c_prime_mx1;
+    h ^= h >> 32;
+    return h;
+}
+
+[[nodiscard]] inline auto mix16(const uint8_t* const p, const std::size_t key_index, const uint64_t seed) -> uint64_t
+{
+    return mul128_fold64(
+        read64(p + 0) ^ key(key_index + 0, seed),
+        read64(p + 8) ^ key(key_index + 1, seed)
+    );
+}
+
+// Inputs up to 16 bytes
+[[nodiscard]] auto hash_0_16(
+    const uint8_t* const p,
+    const std::size_t    length,
+    const uint64_t       seed,
+    const std::size_t    key_index,
+    const uint64_t       start
+) -> uint64_t
+{
+    uint64_t lo;
+    uint64_t hi;
+    if (length >= 8) {
+        lo = read64(p);
+        hi = read64(p + length - 8);
+    } else if (length >= 4) {
+        lo = read32(p);
+        hi = read32(p + length - 4);
+    } else if (length > 0) {
+        lo = static_cast<uint64_t>(p[0]) | (static_cast<uint64_t>(p[length >> 1]) << 8) | (static_cast<uint64_t>(p[length - 1]) << 16);
+        hi = 0;
+    } else {
+        lo = 0;
+        hi = 0;
+    }
+    return avalanche(start + mul128_fold64(lo ^ key(key_index, seed), hi ^ key(key_index + 1, seed)));
+}
+
+// Inputs of 17..64 bytes; pairs of 16 byte chunks from both ends
+[[nodiscard]] auto hash_17_64(
+    const uint8_t* const p,
+    const std::size_t    length,
+    const uint64_t       seed,
+    const std::size_t    key_index,
+    const uint64_t       start
+) -> uint64_t
+{
+    uint64_t acc = start;
+    acc += mix16(p,               key_index + 0, seed);
+    acc += mix16(p + length - 16, key_index + 2, seed);
+    if (length > 32) {
+        acc += mix16(p + 16,          key_index + 4, seed);
+        acc += mix16(p + length - 32, key_index + 6, seed);
+    }
+    return avalanche(acc);
+}
+
+[[nodiscard]] auto hash_short(const uint8_t* const p, const std::size_t length, const uint64_t seed) -> uint64_t
+{
+    const uint64_t start = static_cast<uint64_t>(length) * c_prime64_1;
+    return (length <= 16)
+        ? hash_0_16 (p, length, seed, 0, start)
+        : hash_17_64(p, length, seed, 0, start);
+}
+
+[[nodiscard]] auto hash128_short(const uint8_t* const p, const std::size_t length, const uint64_t seed) -> Hash128
+{
+    const uint64_t start_low  = static_cast<uint64_t>(length) * c_prime64_1;
+    const uint64_t start_high = ~(static_cast<uint64_t>(length) * c_prime64_2);
+    if (length <= 16) {
+        return Hash128{
+            .low  = hash_0_16(p, length, seed, 0,                start_low),
+            .high = hash_0_16(p, length, seed, c_key_short_high, start_high)
+        };
+    }
+    return Hash128{
+        .low  = hash_17_64(p, length, seed, 0,                start_low),
+        .high = hash_17_64(p, length, seed, c_key_short_high, start_high)
+    };
+}
+
+// Lanes are independent, so this loop vectorizes
+inline void accumulate_stripe(
+    std::array<uint64_t, 8>& accumulators,
+    const uint8_t* const     p,
+    const std::size_t        key_index,
+    const uint64_t           seed
+)
+{
+    for (std::size_t i = 0; i < 8; ++i) {
+        const uint64_t data     = read64(p + 8 * i);
+        const uint64_t data_key = data ^ key(key_index + i, seed);
+        accumulators[i ^ 1] += data;
+        accumulators[i]     += (data_key & 0xFFFFFFFFULL) * (data_key >> 32);
+    }
+}
+
+inline void scramble(std::array<uint64_t, 8>& accumulators, const uint64_t seed)
+{
+    for (std::size_t i = 0; i < 8; ++i) {
+        uint64_t a = accumulators[i];
+        a ^= a >> 47;
+        a ^= key(c_key_scramble + i, seed);
+        a *= c_prime32_1;
+        accumulators[i] = a;
+    }
+}
+
+[[nodiscard]] auto merge(
+    const std::array<uint64_t, 8>& accumulators,
+    const std::size_t              key_index,
+    const uint64_t                 seed,
+    uint64_t                       start
+) -> uint64_t
+{
+    for (std::size_t i = 0; i < 4; ++i) {
+        start += mul128_fold64(
+            accumulators[2 * i + 0] ^ key(key_index + 2 * i + 0, seed),
+            accumulators[2 * i + 1] ^ key(key_index + 2 * i + 1, seed)
+        );
+    }
+    return avalanche(start);
+}
+
+} // anonymous namespace
+
+Hasher::Hasher(const uint64_t seed)
+{
+    reset(seed);
+}
+
+void Hasher::reset(const uint64_t seed)
+{
+    m_accumulators = {
+        c_prime32_3, c_prime64_1, c_prime64_2, c_prime64_3,
+        c_prime64_4, c_prime32_2, c_prime64_5, c_prime32_1
+    };
+    m_buffer_size  = 0;
+    m_stripe_count = 0;
+    m_total_length = 0;
+    m_seed         = seed;
+}
+
+void Hasher::update(const void* const data, std::size_t byte_count)
+{
+    if (byte_count == 0) {
+        return;
+    }
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    m_total_length += byte_count;
+
+    // Stripes are consumed only once more input follows them, so that
+    // digest() always has the final 1..64 bytes available.
+    if (m_buffer_size + byte_count <= c_stripe_size) {
+        std::memcpy(m_buffer.data() + m_buffer_size, p, byte_count);
+        m_buffer_size += byte_count;
+        return;
+    }
+
+    const auto consume = [this](const uint8_t* const stripe) {
+        accumulate_stripe(m_accumulators, stripe, m_stripe_count, m_seed);
+        if (++m_stripe_count == c_stripes_per_block) {
+            scramble(m_accumulators, m_seed);
+            m_stripe_count = 0;
+        }
+    };
+
+    if (m_buffer_size > 0) {
+        const std::size_t fill_count = c_stripe_size - m_buffer_size;
+        std::memcpy(m_buffer.data() + m_buffer_size, p, fill_count);
+        p          += fill_count;
+        byte_count -= fill_count;
+        consume(m_buffer.data());
+        m_last_stripe = m_buffer;
+        m_buffer_size = 0;
+    }
+
+    // Directly from input, without copying to buffer
+    if (byte_count > c_stripe_size) {
+        while (byte_count > c_stripe_size) {
+            consume(p);
+            p          += c_stripe_size;
+            byte_count -= c_stripe_size;
+        }
+        std::memcpy(m_last_stripe.data(), p - c_stripe_size, c_stripe_size);
+    }
+
+    std::memcpy(m_buffer.data(), p, byte_count);
+    m_buffer_size = byte_count;
+}
+
+auto Hasher::digest() const -> uint64_t
+{
+    if (m_total_length <= c_stripe_size) {
+        return hash_short(m_buffer.data(), static_cast<std::size_t>(m_total_length), m_seed);
+    }
+
+    // Last stripe is the final 64 bytes of input, overlapping consumed input
+    std::array<uint8_t, c_stripe_size> last_stripe;
+    const std::size_t from_previous = c_stripe_size - m_buffer_size;
+    std::memcpy(last_stripe.data(), m_last_stripe.data() + m_buffer_size, from_previous);
+    std::memcpy(last_stripe.data() + from_previous, m_buffer.data(), m_buffer_size);
+
+    std::array<uint64_t, 8> accumulators = m_accumulators;
+    accumulate_stripe(accumulators, last_stripe.data(), c_key_last_stripe, m_seed);
+    return merge(accumulators, c_key_merge_low, m_seed, m_total_length * c_prime64_1);
+}
+
+auto Hasher::digest128() const -> Hash128
+{
+    if (m_total_length <= c_stripe_size) {
+        return hash128_short(m_buffer.data(), static_cast<std::size_t>(m_total_length), m_seed);
+    }
+
+    std::array<uint8_t, c_stripe_size> last_stripe;
+    const std::size_t from_previous = c_stripe_size - m_buffer_size;
+    std::memcpy(last_stripe.data(), m_last_stripe.data() + m_buffer_size, from_previous);
+    std::memcpy(last_stripe.data() + from_previous, m_buffer.data(), m_buffer_size);
+
+    std::array<uint64_t, 8> accumulators = m_accumulators;
+    accumulate_stripe(accumulators, last_stripe.data(), c_key_last_stripe, m_seed);
+    return Hash128{
+        .low  = merge(accumulators, c_key_merge_low,  m_seed,   m_total_length * c_prime64_1),
+        .high = merge(accumulators, c_key_merge_high, m_seed, ~(m_total_length * c_prime64_2))
+    };
+}
+
+auto hash64(const void* const data, const std::size_t byte_count, const uint64_t seed) -> uint64_t
+{
+    if (byte_count <= Hasher::c_stripe_size) {
+        return hash_short(static_cast<const uint8_t*>(data), byte_count, seed);
+    }
+    Hasher hasher{seed};
+    hasher.update(data, byte_count);
+    return hasher.digest();
+}
+
+auto hash128(const void* const data, const std::size_t byte_count, const uint64_t seed) -> Hash128
+{
+    if (byte_count <= Hasher::c_stripe_size) {
+        return hash128_short(static_cast<const uint8_t*>(data), byte_count, seed);
+    }
+    Hasher hasher{seed};
+    hasher.update(data, byte_count);
+    return hasher.digest128();
+}
+
+}
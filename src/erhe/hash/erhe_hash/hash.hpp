@@ -1,12 +1,18 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cstddef>
+#include <span>
+#include <type_traits>
 
 #include <glm/glm.hpp>
 
 namespace erhe::hash {
 
+// FNV-1a, one byte at a time. Fine for a handful of values; use hash64()
+// or Hasher for bulk data.
+
 static const uint64_t c_prime = 0x100000001b3;
 static const uint64_t c_seed  = 0xcbf29ce484222325;
 
@@ -62,4 +68,75 @@ static const uint64_t c_seed  = 0xcbf29ce484222325;
     return seed;
 }
 
+// Fast non-cryptographic 64-bit and 128-bit hash, in the style of XXH3.
+// Input is consumed in 64 byte stripes by eight independent 64-bit lanes
+// with 32x32->64 bit multiply-accumulate, which compilers vectorize; short
+// inputs and the final merge use 64x64->128 bit multiply folding.
+// Results are not compatible with the reference XXH3, and may change
+// between versions; do not persist them without a format version.
+class Hash128
+{
+public:
+    uint64_t low {0};
+    uint64_t high{0};
+
+    [[nodiscard]] auto operator==(const Hash128& other) const -> bool = default;
+};
+
+// Streaming interface. Result is identical to hash64() / hash128() over
+// the concatenation of all updates, regardless of how input is split.
+class Hasher
+{
+public:
+    static constexpr std::size_t c_stripe_size = 64;
+
+    explicit Hasher(uint64_t seed = 0);
+
+    void reset (uint64_t seed = 0);
+    void update(const void* data, std::size_t byte_count);
+
+    template <typename T>
+    void update(const std::span<const T> values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be hashed as bytes");
+        update(values.data(), values.size_bytes());
+    }
+
+    template <typename T>
+    void update_value(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be hashed as bytes");
+        update(&value, sizeof(T));
+    }
+
+    [[nodiscard]] auto digest   () const -> uint64_t;
+    [[nodiscard]] auto digest128() const -> Hash128;
+
+private:
+    std::array<uint64_t, 8>              m_accumulators;
+    std::array<uint8_t, c_stripe_size>   m_buffer;      // Unconsumed input, 1..64 bytes after first update
+    std::array<uint8_t, c_stripe_size>   m_last_stripe; // Most recently consumed stripe
+    std::size_t                          m_buffer_size {0};
+    std::size_t                          m_stripe_count{0}; // Stripes consumed in current block
+    uint64_t                             m_total_length{0};
+    uint64_t                             m_seed        {0};
+};
+
+[[nodiscard]] auto hash64 (const void* data, std::size_t byte_count, uint64_t seed = 0) -> uint64_t;
+[[nodiscard]] auto hash128(const void* data, std::size_t byte_count, uint64_t seed = 0) -> Hash128;
+
+template <typename T>
+[[nodiscard]] auto hash64(const std::span<const T> values, const uint64_t seed = 0) -> uint64_t
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be hashed as bytes");
+    return hash64(values.data(), values.size_bytes(), seed);
+}
+
+template <typename T>
+[[nodiscard]] auto hash128(const std::span<const T> values, const uint64_t seed = 0) -> Hash128
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be hashed as bytes");
+    return hash128(values.data(), values.size_bytes(), seed);
+}
+
 }
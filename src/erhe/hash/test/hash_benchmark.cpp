@@ -0,0 +1,90 @@
+// Throughput benchmark for erhe::hash
+//
+// Hashes buffers from 16 bytes to 64 MB with byte at a time FNV-1a
+// (erhe::hash::hash()), which is what bulk data used before hash64()
+// existed, and with hash64(), hash128() and Hasher fed in 4 kB updates.
+// Reports GB/s for each.
+
+#include "erhe_hash/hash.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace erhe::hash;
+
+using Clock = std::chrono::steady_clock;
+
+// Repeats function until at least this many bytes are hashed
+constexpr std::size_t c_min_total_bytes = 256 * 1024 * 1024;
+
+template <typename Function>
+auto measure(const char* label, const std::size_t byte_count, Function&& function) -> uint64_t
+{
+    const std::size_t repeat_count = std::max(std::size_t{1}, c_min_total_bytes / std::max(std::size_t{1}, byte_count));
+    uint64_t result = function(); // warm up
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < repeat_count; ++i) {
+        result += function();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const double bytes   = static_cast<double>(byte_count) * static_cast<double>(repeat_count);
+    fmt::print(
+        "    {:<16} {:>10.3f} ns/call {:>9.3f} GB/s\n",
+        label, seconds * 1.0e9 / static_cast<double>(repeat_count), bytes / seconds / 1.0e9
+    );
+    return result;
+}
+
+void run(const std::vector<uint8_t>& data, const std::size_t byte_count)
+{
+    fmt::print("{} bytes\n", byte_count);
+    const uint8_t* const p = data.data();
+    uint64_t sink = 0;
+    sink += measure("FNV-1a", byte_count, [p, byte_count]() -> uint64_t {
+        return hash(p, byte_count);
+    });
+    sink += measure("hash64", byte_count, [p, byte_count]() -> uint64_t {
+        return hash64(p, byte_count);
+    });
+    sink += measure("hash128", byte_count, [p, byte_count]() -> uint64_t {
+        const Hash128 result = hash128(p, byte_count);
+        return result.low ^ result.high;
+    });
+    sink += measure("Hasher 4 kB", byte_count, [p, byte_count]() -> uint64_t {
+        Hasher hasher;
+        for (std::size_t offset = 0; offset < byte_count; offset += 4096) {
+            hasher.update(p + offset, std::min(std::size_t{4096}, byte_count - offset));
+        }
+        return hasher.digest();
+    });
+    fmt::print("    checksum {:016x}\n", sink);
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t max_byte_count = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 64 * 1024 * 1024;
+
+    std::vector<uint8_t> data(max_byte_count);
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (uint8_t& byte : data) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+
+    for (std::size_t byte_count = 16; byte_count <= max_byte_count; byte_count *= 16) {
+        run(data, byte_count);
+    }
+    return EXIT_SUCCESS;
+}
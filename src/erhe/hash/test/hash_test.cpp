@@ -0,0 +1,182 @@
+// Tests for erhe::hash::Hasher, hash64() and hash128()
+//
+// Checks that streaming gives the same result as one-shot hashing for
+// every split point, for lengths around the short input, stripe (64 byte)
+// and block (16 stripes) boundaries, also when input is fed in many small
+// or uneven updates and after reset(). Checks that span overloads match
+// the pointer and size overloads, and that seed and every input byte
+// affect the result.
+
+#include "erhe_hash/hash.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+namespace {
+
+using namespace erhe::hash;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description, const std::size_t length, const std::size_t detail = 0)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {} (length {}, {})\n", description, length, detail);
+        ++s_failure_count;
+    }
+}
+
+constexpr std::size_t c_block_size = 16 * Hasher::c_stripe_size;
+
+// Lengths on both sides of short input cases, stripe and block boundaries
+const std::size_t c_lengths[] = {
+    0, 1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65,
+    127, 128, 129, 191, 192, 193,
+    c_block_size - 65, c_block_size - 64, c_block_size - 63,
+    c_block_size - 1,  c_block_size,      c_block_size + 1,
+    c_block_size + 63, c_block_size + 64, c_block_size + 65,
+    2 * c_block_size - 1, 2 * c_block_size, 2 * c_block_size + 1,
+    3 * c_block_size + 100
+};
+
+const uint64_t c_seeds[] = { 0, 1, 0x9E3779B97F4A7C15ULL };
+
+auto make_data(const std::size_t byte_count) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> data(byte_count);
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (uint8_t& byte : data) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+    return data;
+}
+
+void test_split_points(const std::vector<uint8_t>& data)
+{
+    for (const uint64_t seed : c_seeds) {
+        for (const std::size_t length : c_lengths) {
+            const uint64_t expected    = hash64 (data.data(), length, seed);
+            const Hash128  expected128 = hash128(data.data(), length, seed);
+            for (std::size_t split = 0; split <= length; ++split) {
+                Hasher hasher{seed};
+                hasher.update(data.data(), split);
+                hasher.update(data.data() + split, length - split);
+                check(hasher.digest()    == expected,    "two part update matches hash64()",  length, split);
+                check(hasher.digest128() == expected128, "two part update matches hash128()", length, split);
+            }
+        }
+    }
+}
+
+void test_three_part_splits(const std::vector<uint8_t>& data)
+{
+    // Second split point walks across stripe boundaries after the first
+    for (const std::size_t length : { std::size_t{200}, c_block_size + 130 }) {
+        const uint64_t expected = hash64(data.data(), length);
+        for (std::size_t first = 0; first <= 130; ++first) {
+            for (std::size_t second = first; second <= std::min(first + 130, length); ++second) {
+                Hasher hasher;
+                hasher.update(data.data(), first);
+                hasher.update(data.data() + first, second - first);
+                hasher.update(data.data() + second, length - second);
+                check(hasher.digest() == expected, "three part update matches hash64()", length, first * 1000 + second);
+            }
+        }
+    }
+}
+
+void test_chunked_updates(const std::vector<uint8_t>& data)
+{
+    const std::size_t length      = 3 * c_block_size + 100;
+    const uint64_t    expected    = hash64 (data.data(), length);
+    const Hash128     expected128 = hash128(data.data(), length);
+    Hasher hasher;
+    for (std::size_t chunk_size = 1; chunk_size <= 2 * Hasher::c_stripe_size + 1; ++chunk_size) {
+        hasher.reset();
+        for (std::size_t offset = 0; offset < length; offset += chunk_size) {
+            hasher.update(data.data() + offset, std::min(chunk_size, length - offset));
+        }
+        check(hasher.digest()    == expected,    "chunked update after reset() matches hash64()",  length, chunk_size);
+        check(hasher.digest128() == expected128, "chunked update after reset() matches hash128()", length, chunk_size);
+    }
+
+    // Empty updates do not change state
+    hasher.reset();
+    hasher.update(data.data(), 0);
+    hasher.update(data.data(), length);
+    hasher.update(data.data(), 0);
+    check(hasher.digest() == expected, "empty updates are ignored", length);
+}
+
+void test_span_overloads()
+{
+    std::vector<uint32_t> values(1000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<uint32_t>(i * 2654435761U);
+    }
+    for (const std::size_t count : { std::size_t{0}, std::size_t{3}, std::size_t{16}, std::size_t{17}, std::size_t{300}, values.size() }) {
+        const std::span<const uint32_t> span{values.data(), count};
+        const std::size_t byte_count = count * sizeof(uint32_t);
+        check(hash64 (span)     == hash64 (values.data(), byte_count),     "hash64() span overload",         byte_count);
+        check(hash128(span)     == hash128(values.data(), byte_count),     "hash128() span overload",        byte_count);
+        check(hash64 (span, 42) == hash64 (values.data(), byte_count, 42), "hash64() span overload seed",    byte_count);
+        check(hash128(span, 42) == hash128(values.data(), byte_count, 42), "hash128() span overload seed",   byte_count);
+
+        Hasher span_hasher;
+        span_hasher.update(span);
+        check(span_hasher.digest() == hash64(span), "Hasher::update() span overload", byte_count);
+
+        Hasher value_hasher;
+        for (const uint32_t value : span) {
+            value_hasher.update_value(value);
+        }
+        check(value_hasher.digest() == hash64(span), "Hasher::update_value()", byte_count);
+    }
+}
+
+void test_sensitivity(std::vector<uint8_t> data)
+{
+    for (const std::size_t length : c_lengths) {
+        if (length == 0) {
+            continue;
+        }
+        const uint64_t original      = hash64 (data.data(), length);
+        const Hash128  original128   = hash128(data.data(), length);
+        const uint64_t original_seed = hash64 (data.data(), length, 1);
+        check(original != original_seed, "seed changes result", length);
+        for (const std::size_t position : { std::size_t{0}, length / 2, length - 1 }) {
+            data[position] ^= 0x01;
+            check(hash64 (data.data(), length) != original,      "flipped bit changes hash64()",  length, position);
+            check(!(hash128(data.data(), length) == original128), "flipped bit changes hash128()", length, position);
+            data[position] ^= 0x01;
+        }
+    }
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    const std::vector<uint8_t> data = make_data(4 * c_block_size);
+
+    test_split_points(data);
+    test_three_part_splits(data);
+    test_chunked_updates(data);
+    test_span_overloads();
+    test_sensitivity(data);
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("hash tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -86,7 +86,7 @@ auto get_log_level_color(const spdlog::level::level_enum level) -> uint32_t
     return ImGui::ColorConvertFloat4ToU32(get_log_level_color_vec4(level));
 }
 
-void Logs::log_entry(erhe::log::Entry& entry)
+void Logs::log_entry(const erhe::log::Entry& entry)
 {
     if (m_paused && (entry.serial > m_pause_serial)) {
         return;
@@ -105,8 +105,13 @@ void Logs::log_entry(erhe::log::Entry& entry)
     if (ImGui::TableSetColumnIndex(2)) {
         ImGui::PushStyleColor(ImGuiCol_Text, get_log_level_color(entry.level));
         ImGui::PushID(static_cast<int>(entry.serial));
-        if (ImGui::Selectable(entry.message.c_str(), entry.selected)) {
-            entry.selected = !entry.selected;
+        const bool selected = m_selected_serials.contains(entry.serial);
+        if (ImGui::Selectable(entry.message.c_str(), selected)) {
+            if (selected) {
+                m_selected_serials.erase(entry.serial);
+            } else {
+                m_selected_serials.insert(entry.serial);
+            }
         }
         //if (entry.repeat_count > 0)
         //{
@@ -282,12 +287,23 @@ void Logs::tail_log_imgui()
     const auto trim_size = static_cast<size_t>(m_tail_buffer_trim_size);
     tail.trim(trim_size);
 
-    auto& tail_entries = tail.get_log();
+    // Entries are copied in display order while holding the lock, so
+    // that the log worker thread is not blocked while rendering
+    {
+        const auto  tail_lock    = tail.lock();
+        const auto& tail_entries = tail.get_log();
+        const auto  visible_count = (std::min)(
+            static_cast<size_t>(m_tail_buffer_show_size),
+            tail_entries.size()
+        );
+        m_tail_snapshot.resize(visible_count);
+        for (size_t i = 0; i < visible_count; ++i) {
+            m_tail_snapshot[i] = m_last_on_top
+                ? tail_entries[tail_entries.size() - 1 - i]
+                : tail_entries[i];
+        }
+    }
 
-    const auto visible_count = (std::min)(
-        static_cast<size_t>(m_tail_buffer_show_size),
-        tail_entries.size()
-    );
     ImGui::TableNextRow();
     if (ImGui::TableSetColumnIndex(0)) {
         ImGui::PushFont(m_imgui_renderer.mono_font());
@@ -301,14 +317,8 @@ void Logs::tail_log_imgui()
             ImGui::TableSetupColumn("Logger",    ImGuiTableColumnFlags_WidthFixed, 140.0f);
             ImGui::TableSetupColumn("Message",   ImGuiTableColumnFlags_WidthFixed, 4000.0f - 140.0f - 170.0f);
             ImGui::TableHeadersRow();
-            if (m_last_on_top) {
-                for (auto i = tail_entries.rbegin(), end = tail_entries.rbegin() + visible_count; i != end; ++i) {
-                    log_entry(*i);
-                }
-            } else {
-                for (auto i = tail_entries.begin(), end = tail_entries.begin() + visible_count; i != end; ++i) {
-                    log_entry(*i);
-                }
+            for (const erhe::log::Entry& entry : m_tail_snapshot) {
+                log_entry(entry);
             }
             ImGui::EndTable();
         }
@@ -322,7 +332,16 @@ void Logs::frame_log_imgui()
 {
     auto& frame = erhe::log::get_frame_store_log();
 
-    auto& frame_entries = frame.get_log();
+    {
+        const auto frame_lock    = frame.lock();
+        auto&      frame_entries = frame.get_log();
+        m_frame_snapshot.resize(frame_entries.size());
+        for (size_t i = 0, end = frame_entries.size(); i < end; ++i) {
+            m_frame_snapshot[i] = frame_entries[i];
+        }
+        frame_entries.clear();
+    }
+
     ImGui::PushFont(m_imgui_renderer.mono_font());
     ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, ImVec2{0.0f, 0.0f});
     const ImVec2 outer_size{-FLT_MIN, 0.0f};
@@ -334,7 +353,7 @@ void Logs::frame_log_imgui()
         ImGui::TableSetupColumn("Logger",    ImGuiTableColumnFlags_WidthFixed, 140.0f);
         ImGui::TableSetupColumn("Message",   ImGuiTableColumnFlags_WidthFixed, 4000.0f - 140.0f - 170.0f);
         ImGui::TableHeadersRow();
-        for (auto& entry : frame_entries) {
+        for (const erhe::log::Entry& entry : m_frame_snapshot) {
             log_entry(entry);
         }
         ImGui::EndTable();
@@ -342,8 +361,6 @@ void Logs::frame_log_imgui()
     ImGui::PopStyleVar();
 
     ImGui::PopFont();
-
-    frame_entries.clear();
 }
 
 } // namespace erhe::imgui
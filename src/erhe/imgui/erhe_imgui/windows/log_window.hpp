@@ -9,7 +9,9 @@
 
 #include <spdlog/sinks/sink.h>
 
+#include <cstdint>
 #include <deque>
+#include <unordered_set>
 #include <vector>
 
 namespace spdlog::level {
@@ -47,7 +49,7 @@ public:
 
 private:
     void save_settings();
-    void log_entry(erhe::log::Entry& entry);
+    void log_entry(const erhe::log::Entry& entry);
 
     Imgui_renderer&           m_imgui_renderer;
     Logs_toggle_pause_command m_toggle_pause_command;
@@ -58,6 +60,11 @@ private:
     bool                      m_follow           {false};
     uint64_t                  m_pause_serial     {0};
     spdlog::level::level_enum m_min_level_to_show{spdlog::level::trace};
+
+    // Copies of store sink entries, rendered without holding sink lock
+    std::vector<erhe::log::Entry> m_tail_snapshot;
+    std::vector<erhe::log::Entry> m_frame_snapshot;
+    std::unordered_set<uint64_t>  m_selected_serials;
 };
 
 class Log_settings_window : public Imgui_window
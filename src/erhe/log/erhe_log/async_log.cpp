@@ -0,0 +1,452 @@
+#include "erhe_log/async_log.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/details/log_msg.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace erhe::log {
+
+namespace {
+
+[[nodiscard]] auto round_up_to_power_of_two(std::size_t value) -> std::size_t
+{
+    std::size_t result = 1;
+    while (result < value) {
+        result = result << 1;
+    }
+    return result;
+}
+
+class Thread_ring_handle
+{
+public:
+    ~Thread_ring_handle() noexcept
+    {
+        if (ring) {
+            ring->close();
+        }
+    }
+
+    uint64_t                  owner_id{0};
+    std::shared_ptr<Log_ring> ring;
+};
+
+thread_local Thread_ring_handle t_thread_ring;
+
+std::atomic<uint64_t> s_worker_id{0};
+
+} // anonymous namespace
+
+Log_ring::Log_ring(const std::size_t capacity)
+    : m_records(round_up_to_power_of_two(capacity))
+    , m_mask   {m_records.size() - 1}
+{
+}
+
+auto Log_ring::begin_push() -> Log_record*
+{
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    const uint64_t tail = m_tail.load(std::memory_order_acquire);
+    if (head - tail >= m_records.size()) {
+        return nullptr;
+    }
+    return &m_records[static_cast<std::size_t>(head) & m_mask];
+}
+
+void Log_ring::end_push()
+{
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+auto Log_ring::available() const -> std::size_t
+{
+    const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(head - tail);
+}
+
+auto Log_ring::peek(const std::size_t index) -> Log_record&
+{
+    const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    return m_records[static_cast<std::size_t>(tail + index) & m_mask];
+}
+
+void Log_ring::pop(const std::size_t count)
+{
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+void Log_ring::close()
+{
+    m_closed.store(true, std::memory_order_release);
+}
+
+auto Log_ring::is_closed() const -> bool
+{
+    return m_closed.load(std::memory_order_acquire);
+}
+
+auto Log_ring::is_empty() const -> bool
+{
+    return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+}
+
+Async_log_worker::Async_log_worker(const std::size_t ring_capacity, const bool drop_when_full)
+    : m_id            {++s_worker_id}
+    , m_ring_capacity {ring_capacity}
+    , m_drop_when_full{drop_when_full}
+{
+}
+
+Async_log_worker::~Async_log_worker() noexcept
+{
+    stop();
+}
+
+void Async_log_worker::start()
+{
+    if (m_running.load()) {
+        return;
+    }
+    m_stop_request.store(false);
+    m_running.store(true);
+    m_thread = std::thread{[this]() { run(); }};
+}
+
+void Async_log_worker::stop()
+{
+    if (!m_running.load()) {
+        return;
+    }
+
+    // New producers fall back to synchronous dispatch from here on
+    m_running.store(false);
+    m_stop_request.store(true);
+    wake();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    // Producers which entered before m_running was cleared may still be
+    // pushing; their records are dispatched by the final drain below.
+    while (m_producer_count.load() != 0) {
+        std::this_thread::yield();
+    }
+    const std::lock_guard<std::mutex> lock{m_dispatch_mutex};
+    while (drain()) {
+    }
+}
+
+auto Async_log_worker::is_running() const -> bool
+{
+    return m_running.load(std::memory_order_acquire);
+}
+
+auto Async_log_worker::get_id() const -> uint64_t
+{
+    return m_id;
+}
+
+auto Async_log_worker::drop_when_full() const -> bool
+{
+    return m_drop_when_full;
+}
+
+auto Async_log_worker::get_statistics() const -> Async_log_statistics
+{
+    return Async_log_statistics{
+        .record_count  = m_record_count .load(std::memory_order_relaxed),
+        .dropped_count = m_dropped_count.load(std::memory_order_relaxed),
+        .batch_count   = m_batch_count  .load(std::memory_order_relaxed)
+    };
+}
+
+auto Async_log_worker::enter_producer() -> bool
+{
+    // Sequentially consistent pair with stop(): either stop() observes
+    // this producer, or this producer observes m_running == false
+    m_producer_count.fetch_add(1);
+    if (!m_running.load()) {
+        m_producer_count.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+void Async_log_worker::leave_producer()
+{
+    m_producer_count.fetch_sub(1, std::memory_order_release);
+}
+
+auto Async_log_worker::get_thread_ring() -> Log_ring&
+{
+    Thread_ring_handle& handle = t_thread_ring;
+    if (handle.owner_id != m_id) {
+        if (handle.ring) {
+            handle.ring->close();
+        }
+        handle.owner_id = m_id;
+        handle.ring  = std::make_shared<Log_ring>(m_ring_capacity);
+        const std::lock_guard<std::mutex> lock{m_rings_mutex};
+        m_rings.push_back(handle.ring);
+    }
+    return *handle.ring.get();
+}
+
+auto Async_log_worker::next_sequence() -> uint64_t
+{
+    return m_sequence.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Async_log_worker::record_dropped()
+{
+    m_dropped_count.fetch_add(1, std::memory_order_relaxed);
+    wake();
+}
+
+void Async_log_worker::wake()
+{
+    // Only first producer after each drain pays for notify
+    if (!m_wake_pending.exchange(true, std::memory_order_acq_rel)) {
+        m_wake_condition.notify_one();
+    }
+}
+
+void Async_log_worker::run()
+{
+    while (!m_stop_request.load(std::memory_order_acquire)) {
+        bool any_records = false;
+        {
+            const std::lock_guard<std::mutex> lock{m_dispatch_mutex};
+            any_records = drain();
+        }
+        if (!any_records) {
+            std::unique_lock<std::mutex> lock{m_wake_mutex};
+            m_wake_condition.wait_for(
+                lock,
+                std::chrono::milliseconds{10},
+                [this]() {
+                    return m_wake_pending.load(std::memory_order_acquire) || m_stop_request.load(std::memory_order_acquire);
+                }
+            );
+        }
+    }
+    const std::lock_guard<std::mutex> lock{m_dispatch_mutex};
+    while (drain()) {
+    }
+}
+
+auto Async_log_worker::drain() -> bool
+{
+    m_wake_pending.store(false, std::memory_order_release);
+
+    // Records are referenced in place; producers cannot reuse the slots
+    // until they are popped after dispatch.
+    m_batch.clear();
+    m_drained_rings.clear();
+    {
+        const std::lock_guard<std::mutex> lock{m_rings_mutex};
+        for (const std::shared_ptr<Log_ring>& ring : m_rings) {
+            const std::size_t count = ring->available();
+            if (count == 0) {
+                continue;
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                m_batch.push_back(&ring->peek(i));
+            }
+            m_drained_rings.push_back(Drained_ring{ring, count});
+        }
+    }
+
+    std::sort(
+        m_batch.begin(),
+        m_batch.end(),
+        [](const Log_record* lhs, const Log_record* rhs) {
+            return lhs->sequence < rhs->sequence;
+        }
+    );
+
+    m_batch_sinks.clear();
+    for (Log_record* record : m_batch) {
+        dispatch(*record);
+        if (std::find(m_batch_sinks.begin(), m_batch_sinks.end(), record->sink) == m_batch_sinks.end()) {
+            m_batch_sinks.push_back(record->sink);
+        }
+    }
+
+    const uint64_t dropped_count = m_dropped_count.load(std::memory_order_relaxed);
+    if (dropped_count != m_reported_dropped_count) {
+        const std::string message = fmt::format("{} log messages dropped, log ring full", dropped_count - m_reported_dropped_count);
+        m_reported_dropped_count = dropped_count;
+        for (Async_log_sink* sink : m_batch_sinks) {
+            const spdlog::details::log_msg msg{std::string_view{"erhe.log"}, spdlog::level::warn, message};
+            for (const std::shared_ptr<spdlog::sinks::sink>& target : sink->get_targets()) {
+                target->log(msg);
+            }
+        }
+    }
+
+    // Flush once per batch instead of once per message
+    for (Async_log_sink* sink : m_batch_sinks) {
+        for (const std::shared_ptr<spdlog::sinks::sink>& target : sink->get_targets()) {
+            target->flush();
+        }
+    }
+
+    for (const Drained_ring& drained : m_drained_rings) {
+        drained.ring->pop(drained.count);
+    }
+    m_drained_rings.clear();
+
+    {
+        const std::lock_guard<std::mutex> lock{m_rings_mutex};
+        m_rings.erase(
+            std::remove_if(
+                m_rings.begin(),
+                m_rings.end(),
+                [](const std::shared_ptr<Log_ring>& ring) {
+                    return ring->is_closed() && ring->is_empty();
+                }
+            ),
+            m_rings.end()
+        );
+    }
+
+    m_batch_count .fetch_add(1,              std::memory_order_relaxed);
+    m_record_count.fetch_add(m_batch.size(), std::memory_order_relaxed);
+    return !m_batch.empty();
+}
+
+void Async_log_worker::dispatch(Log_record& record)
+{
+    const char* const message = (record.long_message != nullptr)
+        ? record.long_message
+        : record.message.data();
+    spdlog::details::log_msg msg{
+        record.time,
+        spdlog::source_loc{},
+        spdlog::string_view_t{record.logger_name.data(), record.logger_name_length},
+        record.level,
+        spdlog::string_view_t{message, record.message_length}
+    };
+    msg.thread_id = record.thread_id;
+    for (const std::shared_ptr<spdlog::sinks::sink>& target : record.sink->get_targets()) {
+        if (target->should_log(msg.level)) {
+            target->log(msg);
+        }
+    }
+    delete[] record.long_message;
+    record.long_message = nullptr;
+}
+
+void Async_log_worker::dispatch_synchronous(const spdlog::details::log_msg& msg, Async_log_sink& sink)
+{
+    const std::lock_guard<std::mutex> lock{m_dispatch_mutex};
+
+    // Records this thread pushed before worker began stopping go first
+    drain();
+
+    for (const std::shared_ptr<spdlog::sinks::sink>& target : sink.get_targets()) {
+        if (target->should_log(msg.level)) {
+            target->log(msg);
+        }
+    }
+    for (const std::shared_ptr<spdlog::sinks::sink>& target : sink.get_targets()) {
+        target->flush();
+    }
+}
+
+Async_log_sink::Async_log_sink(
+    const std::shared_ptr<Async_log_worker>&          worker,
+    std::vector<std::shared_ptr<spdlog::sinks::sink>> targets
+)
+    : m_worker {worker}
+    , m_targets{std::move(targets)}
+{
+}
+
+void Async_log_sink::log(const spdlog::details::log_msg& msg)
+{
+    if (!m_worker->enter_producer()) {
+        m_worker->dispatch_synchronous(msg, *this);
+        return;
+    }
+
+    Log_ring&   ring   = m_worker->get_thread_ring();
+    Log_record* record = ring.begin_push();
+    while (record == nullptr) {
+        if (m_worker->drop_when_full()) {
+            m_worker->record_dropped();
+            m_worker->leave_producer();
+            return;
+        }
+        if (!m_worker->is_running()) {
+            // Worker is stopping and will not make room in the ring
+            m_worker->leave_producer();
+            m_worker->dispatch_synchronous(msg, *this);
+            return;
+        }
+        m_worker->wake();
+        std::this_thread::yield();
+        record = ring.begin_push();
+    }
+
+    const std::size_t logger_name_length = std::min(msg.logger_name.size(), Log_record::c_logger_name_capacity);
+    const std::size_t message_length     = msg.payload.size();
+    record->sequence           = m_worker->next_sequence();
+    record->time               = msg.time;
+    record->thread_id          = msg.thread_id;
+    record->sink               = this;
+    record->level              = msg.level;
+    record->logger_name_length = static_cast<uint8_t>(logger_name_length);
+    record->message_length     = static_cast<uint32_t>(message_length);
+    std::memcpy(record->logger_name.data(), msg.logger_name.data(), logger_name_length);
+    if (message_length <= Log_record::c_message_capacity) {
+        record->long_message = nullptr;
+        std::memcpy(record->message.data(), msg.payload.data(), message_length);
+    } else {
+        record->long_message = new char[message_length];
+        std::memcpy(record->long_message, msg.payload.data(), message_length);
+    }
+    ring.end_push();
+    m_worker->wake();
+    m_worker->leave_producer();
+
+    // Errors are written out before returning, so that they are not lost
+    // if the process is about to terminate. If the worker is stopping,
+    // stop() drains the ring.
+    if (msg.level >= spdlog::level::err) {
+        while (!ring.is_empty() && m_worker->is_running()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Async_log_sink::flush()
+{
+    // Worker flushes targets after each batch
+}
+
+void Async_log_sink::set_pattern(const std::string& pattern)
+{
+    for (const std::shared_ptr<spdlog::sinks::sink>& target : m_targets) {
+        target->set_pattern(pattern);
+    }
+}
+
+void Async_log_sink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    for (const std::shared_ptr<spdlog::sinks::sink>& target : m_targets) {
+        target->set_formatter(sink_formatter->clone());
+    }
+}
+
+auto Async_log_sink::get_targets() const -> const std::vector<std::shared_ptr<spdlog::sinks::sink>>&
+{
+    return m_targets;
+}
+
+} // namespace erhe::log
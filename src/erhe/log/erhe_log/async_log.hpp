@@ -0,0 +1,171 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace erhe::log {
+
+class Async_log_sink;
+
+// Fixed size log record, copied into per thread ring by the logging thread.
+// Messages longer than inline capacity are moved to a heap allocation,
+// which is released by the worker thread.
+class Log_record
+{
+public:
+    static constexpr std::size_t c_logger_name_capacity = 48;
+    static constexpr std::size_t c_message_capacity     = 224;
+
+    uint64_t                                     sequence{0};
+    spdlog::log_clock::time_point                time;
+    std::size_t                                  thread_id{0};
+    Async_log_sink*                              sink{nullptr};
+    char*                                        long_message{nullptr};
+    uint32_t                                     message_length{0};
+    uint8_t                                      logger_name_length{0};
+    spdlog::level::level_enum                    level{spdlog::level::off};
+    std::array<char, c_logger_name_capacity>     logger_name;
+    std::array<char, c_message_capacity>         message;
+};
+
+// Single producer single consumer ring of log records. Each logging
+// thread owns one ring; the worker thread is the only consumer.
+class Log_ring
+{
+public:
+    explicit Log_ring(std::size_t capacity);
+
+    // Producer side; returns nullptr when ring is full
+    [[nodiscard]] auto begin_push() -> Log_record*;
+    void end_push();
+
+    // Consumer side. Records returned by peek() stay valid until pop().
+    [[nodiscard]] auto available() const -> std::size_t;
+    [[nodiscard]] auto peek     (std::size_t index) -> Log_record&;
+    void pop(std::size_t count);
+
+    void close();
+    [[nodiscard]] auto is_closed() const -> bool;
+    [[nodiscard]] auto is_empty () const -> bool;
+
+private:
+    std::vector<Log_record>              m_records;
+    std::size_t                          m_mask;
+    alignas(64) std::atomic<uint64_t>    m_head  {0}; // written by producer
+    alignas(64) std::atomic<uint64_t>    m_tail  {0}; // written by consumer
+    std::atomic<bool>                    m_closed{false};
+};
+
+class Async_log_statistics
+{
+public:
+    uint64_t record_count {0};
+    uint64_t dropped_count{0};
+    uint64_t batch_count  {0};
+};
+
+// Background thread which drains all log rings, restores submission
+// order using record sequence numbers, and fans out records to the
+// target sinks of each Async_log_sink. Order is exact within a thread,
+// and approximate across threads.
+class Async_log_worker
+{
+public:
+    static constexpr std::size_t c_default_ring_capacity = 512;
+
+    // When drop_when_full is set, records are discarded and counted when
+    // the ring of the logging thread is full; otherwise the logging thread
+    // waits for the worker.
+    explicit Async_log_worker(std::size_t ring_capacity = c_default_ring_capacity, bool drop_when_full = false);
+    ~Async_log_worker() noexcept;
+
+    void start();
+    void stop ();
+    [[nodiscard]] auto is_running    () const -> bool;
+    [[nodiscard]] auto get_id        () const -> uint64_t;
+    [[nodiscard]] auto drop_when_full() const -> bool;
+    [[nodiscard]] auto get_statistics() const -> Async_log_statistics;
+
+    // Called by Async_log_sink on logging thread. Records may be pushed
+    // only between successful enter_producer() and leave_producer();
+    // enter_producer() fails once stop() has begun, and stop() waits for
+    // entered producers before its final drain.
+    [[nodiscard]] auto enter_producer () -> bool;
+    void leave_producer();
+    [[nodiscard]] auto get_thread_ring() -> Log_ring&;
+    [[nodiscard]] auto next_sequence  () -> uint64_t;
+    void record_dropped();
+    void wake          ();
+
+    // Called when worker is not running; formats on calling thread
+    void dispatch_synchronous(const spdlog::details::log_msg& msg, Async_log_sink& sink);
+
+private:
+    class Drained_ring
+    {
+    public:
+        std::shared_ptr<Log_ring> ring;
+        std::size_t               count{0};
+    };
+
+    void run  ();
+    auto drain() -> bool;
+    void dispatch(Log_record& record);
+
+    uint64_t                               m_id;
+    std::size_t                            m_ring_capacity;
+    bool                                   m_drop_when_full;
+    std::mutex                             m_rings_mutex;
+    std::vector<std::shared_ptr<Log_ring>> m_rings;
+    std::vector<Log_record*>               m_batch;
+    std::vector<Drained_ring>              m_drained_rings;
+    std::vector<Async_log_sink*>           m_batch_sinks;
+    std::atomic<uint64_t>                  m_sequence     {0};
+    std::atomic<uint64_t>                  m_record_count {0};
+    std::atomic<uint64_t>                  m_dropped_count{0};
+    std::atomic<uint64_t>                  m_batch_count  {0};
+    uint64_t                               m_reported_dropped_count{0};
+    std::atomic<bool>                      m_wake_pending {false};
+    std::atomic<bool>                      m_running      {false};
+    std::atomic<int>                       m_producer_count{0};
+    std::atomic<bool>                      m_stop_request {false};
+    std::mutex                             m_wake_mutex;
+    std::condition_variable                m_wake_condition;
+    std::mutex                             m_dispatch_mutex;
+    std::thread                            m_thread;
+};
+
+// Front end sink attached to loggers in async mode. Calling thread only
+// copies the message into its ring; formatting and writing to target
+// sinks happens on worker thread. Messages at error level and above
+// wait until the worker has written them out.
+class Async_log_sink final : public spdlog::sinks::sink
+{
+public:
+    Async_log_sink(
+        const std::shared_ptr<Async_log_worker>&          worker,
+        std::vector<std::shared_ptr<spdlog::sinks::sink>> targets
+    );
+
+    void log          (const spdlog::details::log_msg& msg) override;
+    void flush        () override;
+    void set_pattern  (const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    [[nodiscard]] auto get_targets() const -> const std::vector<std::shared_ptr<spdlog::sinks::sink>>&;
+
+private:
+    std::shared_ptr<Async_log_worker>                 m_worker;
+    std::vector<std::shared_ptr<spdlog::sinks::sink>> m_targets;
+};
+
+} // namespace erhe::log
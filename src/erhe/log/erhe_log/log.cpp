@@ -1,5 +1,6 @@
 #include "erhe_log/log.hpp"
 #include "erhe_configuration/configuration.hpp"
+#include "erhe_log/async_log.hpp"
 #include "erhe_log/timestamp.hpp"
 #include "erhe_verify/verify.hpp"
 
@@ -17,6 +18,8 @@
 #   include <unistd.h>
 #endif
 
+#include <algorithm>
+#include <array>
 #include <vector>
 
 namespace erhe::log {
@@ -40,45 +43,123 @@ void console_init()
 #endif
 }
 
-Store_log_sink::Store_log_sink()
+Entry_ring::Entry_ring(const std::size_t capacity)
+    : m_entries(std::max(capacity, std::size_t{1}))
+{
+}
+
+auto Entry_ring::size() const -> std::size_t
+{
+    return m_size;
+}
+
+auto Entry_ring::capacity() const -> std::size_t
+{
+    return m_entries.size();
+}
+
+auto Entry_ring::empty() const -> bool
+{
+    return m_size == 0;
+}
+
+auto Entry_ring::operator[](const std::size_t index) -> Entry&
+{
+    assert(index < m_size);
+    return m_entries[(m_first + index) % m_entries.size()];
+}
+
+auto Entry_ring::operator[](const std::size_t index) const -> const Entry&
+{
+    assert(index < m_size);
+    return m_entries[(m_first + index) % m_entries.size()];
+}
+
+auto Entry_ring::push_back() -> Entry&
+{
+    if (m_size < m_entries.size()) {
+        ++m_size;
+    } else {
+        m_first = (m_first + 1) % m_entries.size();
+    }
+    return (*this)[m_size - 1];
+}
+
+void Entry_ring::trim(const std::size_t count)
+{
+    if (m_size > count) {
+        const std::size_t trim_count = m_size - count;
+        m_first = (m_first + trim_count) % m_entries.size();
+        m_size  = count;
+    }
+}
+
+void Entry_ring::clear()
+{
+    m_first = 0;
+    m_size  = 0;
+}
+
+void Entry_ring::set_capacity(const std::size_t capacity)
+{
+    const std::size_t new_capacity = std::max(capacity, std::size_t{1});
+    if (new_capacity == m_entries.size()) {
+        return;
+    }
+    trim(new_capacity);
+    std::vector<Entry> entries(new_capacity);
+    for (std::size_t i = 0; i < m_size; ++i) {
+        entries[i] = std::move((*this)[i]);
+    }
+    m_entries = std::move(entries);
+    m_first   = 0;
+}
+
+Store_log_sink::Store_log_sink(const std::size_t capacity)
+    : m_entries{capacity}
 {
 }
 
 auto Store_log_sink::get_serial() const -> uint64_t
 {
-    return m_serial;
+    return m_serial.load(std::memory_order_relaxed);
+}
+
+auto Store_log_sink::lock() -> std::unique_lock<std::mutex>
+{
+    return std::unique_lock<std::mutex>{mutex_};
 }
 
-auto Store_log_sink::get_log() -> std::deque<Entry>&
+auto Store_log_sink::get_log() -> Entry_ring&
 {
     return m_entries;
 }
 
 void Store_log_sink::trim(const std::size_t trim_size)
 {
-    if (m_entries.size() > trim_size) {
-        const auto trim_count = m_entries.size() - trim_size;
-        m_entries.erase(
-            m_entries.begin(),
-            m_entries.begin() + trim_count
-        );
-        assert(m_entries.size() == trim_size);
-    }
+    const std::lock_guard<std::mutex> lock{mutex_};
+    m_entries.trim(trim_size);
+}
+
+void Store_log_sink::set_capacity(const std::size_t capacity)
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    m_entries.set_capacity(capacity);
 }
 
 void Store_log_sink::sink_it_(const spdlog::details::log_msg& msg)
 {
-    ++m_serial;
-    m_entries.push_back(
-        Entry{
-            .serial       = m_serial,
-            .timestamp    = erhe::log::timestamp_short(),
-            .message      = std::string{msg.payload.begin(), msg.payload.end()},
-            .logger       = std::string{msg.logger_name.begin(), msg.logger_name.end()},
-            .repeat_count = 0,
-            .level        = msg.level,
-        }
-    );
+    // Called with mutex_ locked by base_sink. Strings are assigned in
+    // place to reuse buffers of overwritten entries.
+    const uint64_t serial = m_serial.fetch_add(1, std::memory_order_relaxed) + 1;
+    Entry& entry = m_entries.push_back();
+    entry.serial       = serial;
+    entry.selected     = false;
+    entry.timestamp    = erhe::log::timestamp_short(msg.time);
+    entry.message     .assign(msg.payload.begin(), msg.payload.end());
+    entry.logger      .assign(msg.logger_name.begin(), msg.logger_name.end());
+    entry.repeat_count = 0;
+    entry.level        = msg.level;
 }
 
 void Store_log_sink::flush_()
@@ -104,6 +185,35 @@ public:
     auto get_log_to_console  () const -> bool { return m_log_to_console; }
     void set_log_to_console  (bool value) { m_log_to_console = value; }
 
+    ~Log_sinks() noexcept
+    {
+        if (m_async_worker) {
+            m_async_worker->stop();
+        }
+    }
+
+    // Front end sink which forwards to the same targets as synchronous
+    // mode; created on first use for each target combination
+    auto get_async_sink(const bool tail, const bool console) -> std::shared_ptr<spdlog::sinks::sink>
+    {
+        const std::lock_guard<std::mutex> lock{m_async_sinks_mutex};
+        std::shared_ptr<spdlog::sinks::sink>& async_sink = m_async_sinks[(tail ? 1 : 0) + (console ? 2 : 0)];
+        if (!async_sink) {
+            std::vector<std::shared_ptr<spdlog::sinks::sink>> targets{
+#if defined _WIN32
+                m_sink_msvc,
+#endif
+                m_sink_log_file,
+                tail ? m_tail_store_log : m_frame_store_log
+            };
+            if (console) {
+                targets.push_back(m_sink_console);
+            }
+            async_sink = std::make_shared<Async_log_sink>(m_async_worker, std::move(targets));
+        }
+        return async_sink;
+    }
+
     auto make_logger(const std::string& name, const bool tail) -> std::shared_ptr<spdlog::logger>
     {
         ERHE_VERIFY(!name.empty());
@@ -115,19 +225,24 @@ public:
         ini.get(basename.c_str(), levelname);
         const spdlog::level::level_enum level_parsed = spdlog::level::from_str(levelname);
 
-        std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::logger>(
-            name,
-            spdlog::sinks_init_list{
+        std::shared_ptr<spdlog::logger> logger;
+        if (m_async_worker) {
+            logger = std::make_shared<spdlog::logger>(name, get_async_sink(tail, m_log_to_console));
+        } else {
+            logger = std::make_shared<spdlog::logger>(
+                name,
+                spdlog::sinks_init_list{
 #if defined _WIN32
-                m_sink_msvc,
+                    m_sink_msvc,
 #endif
-                //sink_console,
-                m_sink_log_file,
-                tail ? m_tail_store_log : m_frame_store_log
+                    //sink_console,
+                    m_sink_log_file,
+                    tail ? m_tail_store_log : m_frame_store_log
+                }
+            );
+            if (m_log_to_console) {
+                logger->sinks().push_back(m_sink_console);
             }
-        );
-        if (m_log_to_console) {
-            logger->sinks().push_back(m_sink_console);
         }
         std::shared_ptr<spdlog::logger> logger_copy = logger;
         spdlog::register_logger(logger_copy);
@@ -138,6 +253,20 @@ public:
 
     void create_sinks()
     {
+        bool        async               {false};
+        std::size_t store_capacity      {Store_log_sink::c_default_capacity};
+        std::size_t frame_store_capacity{Store_log_sink::c_default_capacity};
+        std::size_t async_ring_capacity {Async_log_worker::c_default_ring_capacity};
+        bool        async_drop_when_full{false};
+        {
+            const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "log");
+            ini.get("async",                async);
+            ini.get("store_capacity",       store_capacity);
+            ini.get("frame_store_capacity", frame_store_capacity);
+            ini.get("async_ring_capacity",  async_ring_capacity);
+            ini.get("async_drop_when_full", async_drop_when_full);
+        }
+
         m_sink_log_file = std::make_shared<spdlog::sinks::basic_file_sink_mt>("log.txt", true);
 
         // If you get a crash here:
@@ -150,15 +279,19 @@ public:
         m_sink_msvc = std::make_shared<spdlog::sinks::msvc_sink_mt>();
 #endif
         m_sink_console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-        m_tail_store_log = std::make_shared<Store_log_sink>();
-        m_frame_store_log = std::make_shared<Store_log_sink>();
+        m_tail_store_log = std::make_shared<Store_log_sink>(store_capacity);
+        m_frame_store_log = std::make_shared<Store_log_sink>(frame_store_capacity);
+
+        if (async) {
+            m_async_worker = std::make_shared<Async_log_worker>(async_ring_capacity, async_drop_when_full);
+            m_async_worker->start();
+        }
     }
 
 private:
     Log_sinks()
     {
     }
-    ~Log_sinks() {}
 
 #if defined _WIN32
     std::shared_ptr<spdlog::sinks::msvc_sink_mt>         m_sink_msvc      {};
@@ -168,6 +301,9 @@ private:
     std::shared_ptr<Store_log_sink>                      m_tail_store_log {};
     std::shared_ptr<Store_log_sink>                      m_frame_store_log{};
     bool                                                 m_log_to_console {false};
+    std::shared_ptr<Async_log_worker>                    m_async_worker   {};
+    std::mutex                                           m_async_sinks_mutex;
+    std::array<std::shared_ptr<spdlog::sinks::sink>, 4>  m_async_sinks    {};
 };
 
 auto get_tail_store_log() -> Store_log_sink&
@@ -4,9 +4,11 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/base_sink.h>
 
-#include <deque>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace erhe::log {
 
@@ -30,23 +32,56 @@ public:
     spdlog::level::level_enum level       {2/*spdlog::level::level_enum::SPDLOG_LEVEL_INFO*/};
 };
 
-// Sink that keeps log entries in deqeue
+// Bounded ring of log entries, index 0 is the oldest entry. When full,
+// the oldest entry is overwritten. Slots are reused, so string buffers
+// of entries do not need to be reallocated for each message.
+class Entry_ring
+{
+public:
+    explicit Entry_ring(std::size_t capacity);
+
+    [[nodiscard]] auto size      () const -> std::size_t;
+    [[nodiscard]] auto capacity  () const -> std::size_t;
+    [[nodiscard]] auto empty     () const -> bool;
+    [[nodiscard]] auto operator[](std::size_t index) -> Entry&;
+    [[nodiscard]] auto operator[](std::size_t index) const -> const Entry&;
+
+    // Returns slot for new entry, to be overwritten by caller
+    [[nodiscard]] auto push_back() -> Entry&;
+    void trim        (std::size_t count); // Keeps count newest entries
+    void clear       ();
+    void set_capacity(std::size_t capacity);
+
+private:
+    std::vector<Entry> m_entries;
+    std::size_t        m_first{0};
+    std::size_t        m_size {0};
+};
+
+// Sink that keeps log entries in bounded ring
 class Store_log_sink final : public spdlog::sinks::base_sink<std::mutex>
 {
 public:
-    Store_log_sink();
+    static constexpr std::size_t c_default_capacity = 10000;
+
+    explicit Store_log_sink(std::size_t capacity = c_default_capacity);
 
     [[nodiscard]] auto get_serial() const -> uint64_t;
-    [[nodiscard]] auto get_log   () -> std::deque<Entry>&;
-    void trim(std::size_t count);
+
+    // Entries may be written from log worker thread; hold lock() while
+    // accessing get_log()
+    [[nodiscard]] auto lock   () -> std::unique_lock<std::mutex>;
+    [[nodiscard]] auto get_log() -> Entry_ring&;
+    void trim        (std::size_t count);
+    void set_capacity(std::size_t capacity);
 
 protected:
     void sink_it_(const spdlog::details::log_msg& msg) override;
     void flush_  ()                                    override;
 
 private:
-    uint64_t          m_serial{0};
-    std::deque<Entry> m_entries;
+    std::atomic<uint64_t> m_serial{0};
+    Entry_ring            m_entries;
 };
 
 [[nodiscard]] auto get_tail_store_log () -> Store_log_sink&;
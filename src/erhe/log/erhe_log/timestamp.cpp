@@ -70,4 +70,26 @@ auto timestamp_short() -> std::string
     );
 }
 
+auto timestamp_short(const std::chrono::system_clock::time_point time_point) -> std::string
+{
+    const std::time_t seconds      = std::chrono::system_clock::to_time_t(time_point);
+    const long long   milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(time_point.time_since_epoch()).count() % 1000;
+
+    struct tm time;
+#if defined (_WIN32) // _MSC_VER
+    localtime_s(&time, &seconds);
+#else
+    localtime_r(&seconds, &time);
+#endif
+
+    // Write time
+    return fmt::format(
+        "{:02}:{:02}:{:02}.{:03d} ",
+        time.tm_hour,
+        time.tm_min,
+        time.tm_sec,
+        milliseconds
+    );
+}
+
 }
@@ -0,0 +1,122 @@
+// Benchmark for logging throughput, synchronous vs Async_log_worker.
+//
+// Producer threads log short info messages to a file sink and a
+// counting sink. Synchronous mode formats and writes on the calling
+// thread under the dispatch lock; async mode only copies records into
+// per thread rings. Calls/s is measured from the producer side, and the
+// total includes stop(), which drains remaining records.
+
+#include "erhe_log/async_log.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/basic_file_sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Targets are called under the worker dispatch lock, so no own lock
+class Counting_sink final : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    std::size_t count{0};
+
+protected:
+    void sink_it_(const spdlog::details::log_msg&) override
+    {
+        ++count;
+    }
+    void flush_() override
+    {
+    }
+};
+
+auto run(
+    const bool                  async,
+    const std::size_t           thread_count,
+    const std::size_t           message_count,
+    const std::filesystem::path path
+) -> bool
+{
+    auto file_sink     = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path.string(), true);
+    auto counting_sink = std::make_shared<Counting_sink>();
+    auto worker        = std::make_shared<erhe::log::Async_log_worker>();
+    erhe::log::Async_log_sink sink{worker, {file_sink, counting_sink}};
+    if (async) {
+        worker->start();
+    }
+
+    std::atomic<bool>        go{false};
+    std::vector<std::thread> threads;
+    for (std::size_t thread_index = 0; thread_index < thread_count; ++thread_index) {
+        threads.emplace_back(
+            [&sink, &go, thread_index, message_count]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < message_count; ++i) {
+                    const std::string payload = fmt::format("thread {} message {} value {}", thread_index, i, i * 3);
+                    const spdlog::details::log_msg msg{std::string_view{"benchmark"}, spdlog::level::info, payload};
+                    sink.log(msg);
+                }
+            }
+        );
+    }
+
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double producer_seconds = seconds_since(start);
+    worker->stop();
+    const double total_seconds = seconds_since(start);
+
+    const std::size_t call_count = thread_count * message_count;
+    fmt::print(
+        "{:<6} {} threads x {} calls: producers {:>8.3f} ms {:>6.2f} M calls/s, with drain {:>8.3f} ms {:>6.2f} M calls/s\n",
+        async ? "async" : "sync",
+        thread_count, message_count,
+        producer_seconds * 1000.0, static_cast<double>(call_count) / producer_seconds * 1.0e-6,
+        total_seconds    * 1000.0, static_cast<double>(call_count) / total_seconds    * 1.0e-6
+    );
+    if (counting_sink->count != call_count) {
+        fmt::print(stderr, "lost records: {} of {} written\n", counting_sink->count, call_count);
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t message_count = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 200'000;
+    const std::size_t thread_count  = (argc > 2) ? static_cast<std::size_t>(std::stoull(argv[2])) : 8;
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "erhe_async_log_benchmark.txt";
+    const bool ok =
+        run(false, thread_count, message_count, path) &&
+        run(true,  thread_count, message_count, path);
+    std::error_code error_code;
+    std::filesystem::remove(path, error_code);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+// Checks that Async_log_worker delivers every record exactly once and in
+// per thread order, including records logged while stop() runs, which
+// must be drained by stop() or dispatched synchronously after it.
+
+#include "erhe_log/async_log.hpp"
+
+#include <fmt/format.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+// Parses "<producer> <index>" payloads and checks per producer order
+class Verifying_sink final : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    explicit Verifying_sink(const std::size_t producer_count)
+        : m_next_index(producer_count, 0)
+    {
+    }
+
+    std::size_t received_count    {0};
+    std::size_t out_of_order_count{0};
+    std::size_t malformed_count   {0};
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        const std::string payload{msg.payload.data(), msg.payload.size()};
+        std::size_t producer = 0;
+        std::size_t index    = 0;
+        if ((std::sscanf(payload.c_str(), "%zu %zu", &producer, &index) != 2) || (producer >= m_next_index.size())) {
+            ++malformed_count;
+            return;
+        }
+        if (index != m_next_index[producer]) {
+            ++out_of_order_count;
+        }
+        m_next_index[producer] = index + 1;
+        ++received_count;
+    }
+
+    void flush_() override
+    {
+    }
+
+private:
+    std::vector<std::size_t> m_next_index;
+};
+
+void log_message(erhe::log::Async_log_sink& sink, const std::size_t producer, const std::size_t index)
+{
+    // Every 16th message exceeds inline record capacity
+    const std::string payload = ((index % 16) == 0)
+        ? fmt::format("{} {} {}", producer, index, std::string(erhe::log::Log_record::c_message_capacity, 'x'))
+        : fmt::format("{} {}", producer, index);
+    const spdlog::details::log_msg msg{std::string_view{"test"}, spdlog::level::info, payload};
+    sink.log(msg);
+}
+
+void test_stop_while_logging(const std::size_t ring_capacity, const std::size_t stop_after_count)
+{
+    constexpr std::size_t producer_count = 4;
+    constexpr std::size_t message_count  = 20'000;
+
+    auto verifying_sink = std::make_shared<Verifying_sink>(producer_count);
+    auto worker         = std::make_shared<erhe::log::Async_log_worker>(ring_capacity, false);
+    erhe::log::Async_log_sink sink{worker, {verifying_sink}};
+    worker->start();
+
+    std::atomic<std::size_t> logged_count{0};
+    std::vector<std::thread> producers;
+    for (std::size_t producer = 0; producer < producer_count; ++producer) {
+        producers.emplace_back(
+            [&sink, &logged_count, producer]() {
+                for (std::size_t index = 0; index < message_count; ++index) {
+                    log_message(sink, producer, index);
+                    logged_count.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        );
+    }
+
+    // Stop while producers are in the middle of logging
+    while (logged_count.load(std::memory_order_relaxed) < stop_after_count) {
+        std::this_thread::yield();
+    }
+    worker->stop();
+    check(!worker->is_running(), "worker stopped");
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    check(verifying_sink->malformed_count == 0, "no malformed records");
+    check(verifying_sink->received_count == producer_count * message_count, "every record delivered exactly once");
+    check(verifying_sink->out_of_order_count == 0, "per thread order preserved across stop()");
+    if (verifying_sink->received_count != producer_count * message_count) {
+        fmt::print(
+            stderr, "ring capacity {}, stop after {}: received {} of {}\n",
+            ring_capacity, stop_after_count, verifying_sink->received_count, producer_count * message_count
+        );
+    }
+}
+
+void test_restart()
+{
+    auto verifying_sink = std::make_shared<Verifying_sink>(1);
+    auto worker         = std::make_shared<erhe::log::Async_log_worker>(16, false);
+    erhe::log::Async_log_sink sink{worker, {verifying_sink}};
+
+    std::size_t index = 0;
+    for (std::size_t round = 0; round < 3; ++round) {
+        log_message(sink, 0, index++); // synchronous, worker not running
+        worker->start();
+        for (std::size_t i = 0; i < 100; ++i) {
+            log_message(sink, 0, index++);
+        }
+        worker->stop();
+    }
+    check(verifying_sink->received_count == index,   "restart: every record delivered");
+    check(verifying_sink->out_of_order_count == 0,   "restart: order preserved");
+    check(worker->get_statistics().dropped_count == 0, "restart: nothing dropped");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    test_restart();
+    for (std::size_t round = 0; round < 10; ++round) {
+        test_stop_while_logging(8,    1'000 * round);
+        test_stop_while_logging(512, 7'000 * round);
+    }
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("async log tests passed\n");
+    return EXIT_SUCCESS;
+}
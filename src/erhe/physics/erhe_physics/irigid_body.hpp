@@ -75,6 +75,11 @@ public:
     [[nodiscard]] virtual auto get_motion_mode             () const -> Motion_mode                       = 0;
     [[nodiscard]] virtual auto get_restitution             () const -> float                             = 0;
     [[nodiscard]] virtual auto get_world_transform         () const -> glm::mat4                         = 0;
+
+    // Blend between transforms before and after most recent simulation
+    // step; alpha 0 is the state before, 1 the state after the step.
+    // Returns get_world_transform() for bodies not moved by that step.
+    [[nodiscard]] virtual auto get_interpolated_world_transform(float alpha) const -> glm::mat4          = 0;
     [[nodiscard]] virtual auto is_active                   () const -> bool                              = 0;
     [[nodiscard]] virtual auto get_allow_sleeping          () const -> bool                              = 0;
     virtual void begin_move                  ()                                             = 0;
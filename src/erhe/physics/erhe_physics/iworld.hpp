@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -17,14 +18,23 @@ class IDebug_draw;
 class IRigid_body;
 class IRigid_body_create_info;
 
+class World_create_info
+{
+public:
+    int         job_thread_count   {-1};               // Max physics job concurrency on the engine thread pool, -1 for all pool threads
+    std::size_t temp_allocator_size{10 * 1024 * 1024}; // Per step scratch memory, in bytes
+    int         collision_steps    {1};                // Collision steps per sub step
+    int         sub_steps          {1};                // update_fixed_step() dt is split into this many updates
+};
+
 class IWorld
 {
 public:
     virtual ~IWorld() noexcept;
 
-    [[nodiscard]] static auto create       () -> IWorld*;
-    [[nodiscard]] static auto create_shared() -> std::shared_ptr<IWorld>;
-    [[nodiscard]] static auto create_unique() -> std::unique_ptr<IWorld>;
+    [[nodiscard]] static auto create       (const World_create_info& create_info = {}) -> IWorld*;
+    [[nodiscard]] static auto create_shared(const World_create_info& create_info = {}) -> std::shared_ptr<IWorld>;
+    [[nodiscard]] static auto create_unique(const World_create_info& create_info = {}) -> std::unique_ptr<IWorld>;
 
     [[nodiscard]] virtual auto create_rigid_body       (
         const IRigid_body_create_info& create_info,
@@ -45,6 +55,9 @@ public:
     virtual void update_fixed_step      (double dt)                                      = 0;
     virtual void add_rigid_body         (IRigid_body* rigid_body)                        = 0;
     virtual void remove_rigid_body      (IRigid_body* rigid_body)                        = 0;
+    virtual void add_rigid_bodies       (std::span<IRigid_body* const> rigid_bodies)     = 0;
+    virtual void remove_rigid_bodies    (std::span<IRigid_body* const> rigid_bodies)     = 0;
+    virtual void optimize_broad_phase   ()                                               = 0;
     virtual void add_constraint         (IConstraint* constraint)                        = 0;
     virtual void remove_constraint      (IConstraint* constraint)                        = 0;
     virtual void set_gravity            (const glm::vec3& gravity)                       = 0;
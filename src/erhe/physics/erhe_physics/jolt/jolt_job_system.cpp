@@ -0,0 +1,139 @@
+#include "erhe_physics/jolt/jolt_job_system.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace erhe::physics {
+
+Jolt_job_system::Jolt_job_system(
+    erhe::concurrency::Thread_pool& thread_pool,
+    const JPH::uint                 max_jobs,
+    const JPH::uint                 max_barriers,
+    const int                       max_concurrency
+)
+    : JPH::JobSystemWithBarrier{max_barriers}
+    , m_thread_pool{thread_pool}
+{
+    const int pool_concurrency = static_cast<int>(m_thread_pool.get_thread_count()) + 1;
+    m_max_concurrency = (max_concurrency > 0) ? std::min(max_concurrency, pool_concurrency) : pool_concurrency;
+    m_max_drain_tasks = std::max(1, m_max_concurrency - 1);
+    m_jobs.Init(max_jobs, max_jobs);
+}
+
+Jolt_job_system::~Jolt_job_system() noexcept
+{
+    // Queued pool tasks reference jobs owned by this job system
+    for (;;) {
+        {
+            const std::lock_guard<std::mutex> lock{m_job_queue_mutex};
+            if ((m_queued_count.load(std::memory_order_acquire) == 0) && (m_drain_task_count == 0)) {
+                break;
+            }
+        }
+        if (!m_thread_pool.try_run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+auto Jolt_job_system::GetMaxConcurrency() const -> int
+{
+    return m_max_concurrency;
+}
+
+auto Jolt_job_system::CreateJob(
+    const char*        inName,
+    JPH::ColorArg      inColor,
+    const JobFunction& inJobFunction,
+    JPH::uint32        inNumDependencies
+) -> JobHandle
+{
+    ERHE_PROFILE_FUNCTION();
+
+    JPH::uint32 index;
+    for (;;) {
+        index = m_jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+        if (index != Available_jobs::cInvalidObjectIndex) {
+            break;
+        }
+        // All jobs in use, wait for some to complete
+        if (!m_thread_pool.try_run_pending_task()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    Job* job = &m_jobs.Get(index);
+
+    // Handle keeps a reference; the job may complete as soon as it is queued
+    JobHandle handle{job};
+    if (inNumDependencies == 0) {
+        QueueJob(job);
+    }
+    return handle;
+}
+
+void Jolt_job_system::QueueJob(Job* inJob)
+{
+    QueueJobs(&inJob, 1);
+}
+
+void Jolt_job_system::QueueJobs(Job** inJobs, const JPH::uint inNumJobs)
+{
+    {
+        const std::lock_guard<std::mutex> lock{m_job_queue_mutex};
+        for (JPH::uint i = 0; i < inNumJobs; ++i) {
+            inJobs[i]->AddRef();
+            m_job_queue.push_back(inJobs[i]);
+        }
+        m_queued_count.fetch_add(static_cast<int>(inNumJobs), std::memory_order_acq_rel);
+    }
+    start_drain_tasks();
+}
+
+void Jolt_job_system::start_drain_tasks()
+{
+    int start_count = 0;
+    {
+        const std::lock_guard<std::mutex> lock{m_job_queue_mutex};
+        const int wanted = std::min(static_cast<int>(m_job_queue.size()), m_max_drain_tasks);
+        start_count = std::max(0, wanted - m_drain_task_count);
+        m_drain_task_count += start_count;
+    }
+    for (int i = 0; i < start_count; ++i) {
+        m_thread_pool.enqueue(
+            [this]() {
+                drain_jobs();
+            }
+        );
+    }
+}
+
+void Jolt_job_system::drain_jobs()
+{
+    for (;;) {
+        Job* job{nullptr};
+        {
+            const std::lock_guard<std::mutex> lock{m_job_queue_mutex};
+            if (m_job_queue.empty()) {
+                // Decided under same lock as QueueJobs() starts tasks, so no job is left behind
+                --m_drain_task_count;
+                return;
+            }
+            job = m_job_queue.front();
+            m_job_queue.pop_front();
+        }
+        // Barrier waiters may have executed the job already, Execute() is then a no-op
+        job->Execute();
+        job->Release();
+        m_queued_count.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void Jolt_job_system::FreeJob(Job* inJob)
+{
+    m_jobs.DestructObject(inJob);
+}
+
+} // namespace erhe::physics
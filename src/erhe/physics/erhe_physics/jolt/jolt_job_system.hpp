@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace erhe::concurrency { class Thread_pool; }
+
+namespace erhe::physics {
+
+// Jolt job system which runs physics jobs on the engine-wide
+// erhe::concurrency::Thread_pool instead of private worker threads.
+// Jobs are kept in a local queue, which is drained by at most
+// max_concurrency - 1 pool tasks at a time; the thread calling
+// Update() executes jobs while waiting on barriers.
+class Jolt_job_system : public JPH::JobSystemWithBarrier
+{
+public:
+    // max_concurrency 0 or negative uses pool thread count + 1 (the caller of Update())
+    Jolt_job_system(
+        erhe::concurrency::Thread_pool& thread_pool,
+        JPH::uint                       max_jobs,
+        JPH::uint                       max_barriers,
+        int                             max_concurrency
+    );
+    ~Jolt_job_system() noexcept override;
+
+    // Implements JPH::JobSystem
+    auto GetMaxConcurrency() const -> int override;
+    auto CreateJob        (const char* inName, JPH::ColorArg inColor, const JobFunction& inJobFunction, JPH::uint32 inNumDependencies = 0) -> JobHandle override;
+
+protected:
+    void QueueJob (Job* inJob) override;
+    void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override;
+    void FreeJob  (Job* inJob) override;
+
+private:
+    using Available_jobs = JPH::FixedSizeFreeList<Job>;
+
+    void start_drain_tasks();
+    void drain_jobs       ();
+
+    erhe::concurrency::Thread_pool& m_thread_pool;
+    Available_jobs                  m_jobs;
+    int                             m_max_concurrency;
+    int                             m_max_drain_tasks;
+    std::mutex                      m_job_queue_mutex;
+    std::deque<Job*>                m_job_queue;
+    int                             m_drain_task_count{0}; // protected by m_job_queue_mutex
+    std::atomic<int>                m_queued_count{0};     // jobs queued, not yet released
+};
+
+} // namespace erhe::physics
@@ -204,7 +204,10 @@ void Jolt_rigid_body::begin_move()
     }
     SPDLOG_LOGGER_TRACE(log_physics, "{} begin move", m_debug_label);
     set_allow_sleeping(false);
-    get_body_interface().ActivateBody(m_body->GetID());
+    // Body may not be in world yet when adding is batched
+    if (m_body->IsInBroadPhase()) {
+        get_body_interface().ActivateBody(m_body->GetID());
+    }
 }
 
 void Jolt_rigid_body::end_move()
@@ -273,6 +276,42 @@ auto Jolt_rigid_body::get_world_transform() const -> glm::mat4
     return transform;
 }
 
+auto Jolt_rigid_body::get_interpolated_world_transform(const float alpha) const -> glm::mat4
+{
+    if (
+        (m_body == nullptr) ||
+        (m_interpolation_step == 0) ||
+        (m_interpolation_step != m_world.get_step_count())
+    ) {
+        return get_world_transform();
+    }
+
+    const glm::vec3 position = glm::mix  (m_previous_position, m_current_position, alpha);
+    const glm::quat rotation = glm::slerp(m_previous_rotation, m_current_rotation, alpha);
+    glm::mat4 transform = glm::mat4_cast(rotation);
+    transform[3] = glm::vec4{position, 1.0f};
+    return transform;
+}
+
+void Jolt_rigid_body::store_previous_transform(const uint64_t step)
+{
+    m_previous_position = from_jolt(m_body->GetPosition());
+    m_previous_rotation = from_jolt(m_body->GetRotation());
+    m_previous_step     = step;
+}
+
+void Jolt_rigid_body::store_current_transform(const uint64_t step)
+{
+    m_current_position = from_jolt(m_body->GetPosition());
+    m_current_rotation = from_jolt(m_body->GetRotation());
+    if (m_previous_step != step) {
+        // Body was activated during the step
+        m_previous_position = m_current_position;
+        m_previous_rotation = m_current_rotation;
+    }
+    m_interpolation_step = step;
+}
+
 void Jolt_rigid_body::set_world_transform(const Transform& transform)
 {
     if (m_body == nullptr) {
@@ -280,6 +319,11 @@ void Jolt_rigid_body::set_world_transform(const Transform& transform)
         return;
     }
 
+    // Teleport; do not interpolate from state before it
+    if (m_motion_mode != Motion_mode::e_kinematic_physical) {
+        m_interpolation_step = 0;
+    }
+
     auto& body_interface = get_body_interface();
     switch (m_motion_mode) {
         case Motion_mode::e_kinematic_non_physical: {
@@ -496,6 +540,16 @@ auto Jolt_rigid_body::get_jolt_body() const -> JPH::Body*
         : &JPH::Body::sFixedToWorld;
 }
 
+auto Jolt_rigid_body::get_world_index() const -> std::size_t
+{
+    return m_world_index;
+}
+
+void Jolt_rigid_body::set_world_index(const std::size_t index)
+{
+    m_world_index = index;
+}
+
 void Jolt_rigid_body::set_owner(void* owner)
 {
     m_owner = owner;
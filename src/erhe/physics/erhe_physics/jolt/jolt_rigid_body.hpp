@@ -5,6 +5,8 @@
 #include <Jolt/Jolt.h>
 #include <Jolt/Physics/Body/Body.h>
 
+#include <limits>
+
 namespace JPH {
     class Body;
     class BodyInterface;
@@ -42,6 +44,7 @@ public:
     auto get_motion_mode             () const -> Motion_mode                       override;
     auto get_restitution             () const -> float                             override;
     auto get_world_transform         () const -> glm::mat4                         override;
+    auto get_interpolated_world_transform(float alpha) const -> glm::mat4          override;
     auto is_active                   () const -> bool                              override;
     auto get_allow_sleeping          () const -> bool                              override;
 
@@ -61,8 +64,18 @@ public:
     auto get_owner                   () const -> void*                             override;
 
     // Public API
+    static constexpr std::size_t c_not_in_world = std::numeric_limits<std::size_t>::max();
+
     auto get_jolt_body() const -> JPH::Body*;
 
+    // Position in Jolt_world rigid body list, c_not_in_world when not added
+    [[nodiscard]] auto get_world_index() const -> std::size_t;
+    void set_world_index(std::size_t index);
+
+    // Called by Jolt_world for active bodies before and after each step
+    void store_previous_transform(uint64_t step);
+    void store_current_transform (uint64_t step);
+
 private:
     [[nodiscard]] auto get_body_interface() const -> JPH::BodyInterface&;
 
@@ -73,6 +86,15 @@ private:
     std::shared_ptr<Jolt_collision_shape> m_collision_shape;
     Motion_mode                           m_motion_mode     {Motion_mode::e_kinematic_non_physical};
     std::string                           m_debug_label;
+    std::size_t                           m_world_index     {c_not_in_world};
+
+    // Interpolation state, valid when m_interpolation_step matches world step count
+    uint64_t                              m_previous_step     {0};
+    uint64_t                              m_interpolation_step{0};
+    glm::vec3                             m_previous_position {0.0f};
+    glm::quat                             m_previous_rotation {1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3                             m_current_position  {0.0f};
+    glm::quat                             m_current_rotation  {1.0f, 0.0f, 0.0f, 0.0f};
 };
 
 } // namespace erhe::physics
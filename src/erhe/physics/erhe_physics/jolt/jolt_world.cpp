@@ -1,16 +1,19 @@
 #include "erhe_physics/jolt/jolt_world.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_log/log_glm.hpp"
 #include "erhe_physics/jolt/jolt_constraint.hpp"
 #include "erhe_physics/jolt/jolt_rigid_body.hpp"
 #include "erhe_physics/jolt/glm_conversions.hpp"
 #include "erhe_physics/idebug_draw.hpp"
 #include "erhe_physics/physics_log.hpp"
+#include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <Jolt/RegisterTypes.h>
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Physics/Body/Body.h>
 
+#include <algorithm>
 #include <cstdarg>
 
 namespace erhe::physics {
@@ -132,19 +135,19 @@ IWorld::~IWorld() noexcept
 {
 }
 
-auto IWorld::create() -> IWorld*
+auto IWorld::create(const World_create_info& create_info) -> IWorld*
 {
-    return new Jolt_world();
+    return new Jolt_world(create_info);
 }
 
-auto IWorld::create_shared() -> std::shared_ptr<IWorld>
+auto IWorld::create_shared(const World_create_info& create_info) -> std::shared_ptr<IWorld>
 {
-    return std::make_shared<Jolt_world>();
+    return std::make_shared<Jolt_world>(create_info);
 }
 
-auto IWorld::create_unique() -> std::unique_ptr<IWorld>
+auto IWorld::create_unique(const World_create_info& create_info) -> std::unique_ptr<IWorld>
 {
-    return std::make_unique<Jolt_world>();
+    return std::make_unique<Jolt_world>(create_info);
 }
 
 void initialize_physics_system()
@@ -162,10 +165,20 @@ void initialize_physics_system()
     JPH::RegisterTypes();
 }
 
-Jolt_world::Jolt_world()
-    : m_temp_allocator{10 * 1024 * 1024}
-    , m_job_system    {JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, 10}
+Jolt_world::Jolt_world(const World_create_info& create_info)
+    : m_collision_steps{std::max(create_info.collision_steps, 1)}
+    , m_sub_steps      {std::max(create_info.sub_steps, 1)}
+    , m_temp_allocator {static_cast<JPH::uint>(create_info.temp_allocator_size)}
+    , m_job_system     {erhe::concurrency::Thread_pool::get_instance(), JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, create_info.job_thread_count}
 {
+    log_physics->info(
+        "Jolt world: {} job concurrency, {} byte temp allocator, {} collision steps, {} sub steps",
+        m_job_system.GetMaxConcurrency(),
+        create_info.temp_allocator_size,
+        m_collision_steps,
+        m_sub_steps
+    );
+
     //m_debug_renderer              = std::make_unique<Jolt_debug_renderer             >();
     m_broad_phase_layer_interface = std::make_unique<Broad_phase_layer_interface_impl>();
     m_physics_system.Init(
@@ -184,29 +197,60 @@ Jolt_world::Jolt_world()
 
 Jolt_world::~Jolt_world() noexcept = default;
 
+template <typename T>
+void Jolt_world::for_each_active_jolt_rigid_body(T callback)
+{
+    const JPH::BodyID*  active_rigid_bodies     = m_physics_system.GetActiveBodiesUnsafe(JPH::EBodyType::RigidBody);
+    const JPH::uint32   active_rigid_body_count = m_physics_system.GetNumActiveBodies(JPH::EBodyType::RigidBody);
+    JPH::BodyInterface& body_interface          = m_physics_system.GetBodyInterfaceNoLock();
+    for (JPH::uint32 i = 0; i < active_rigid_body_count; ++i) {
+        const JPH::uint64 user_data       = body_interface.GetUserData(active_rigid_bodies[i]);
+        Jolt_rigid_body*  jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(user_data);
+        if (jolt_rigid_body != nullptr) {
+            callback(*jolt_rigid_body);
+        }
+    }
+}
+
 void Jolt_world::update_fixed_step(const double dt)
 {
+    ERHE_PROFILE_FUNCTION();
+
     log_physics_frame->trace("update_fixed_step()");
-    // If you take larger steps than 1 / 60th of a second you need to do
-    // multiple collision steps in order to keep the simulation stable.
-    // Do 1 collision step per 1 / 60th of a second (round up).
-    const int cCollisionSteps = 1;
-
-    // If you want more accurate step results you can do multiple sub steps
-    // within a collision step. Usually you would set this to 1.
-    //const int cIntegrationSubSteps = 1;
-
-    //float inDeltaTime, 
-    // int inCollisionSteps, 
-    // TempAllocator *inTempAllocator, 
-    // JobSystem *inJobSystem
-    m_physics_system.Update(
-        static_cast<float>(dt),
-        cCollisionSteps,
-        //cIntegrationSubSteps,
-        &m_temp_allocator,
-        &m_job_system
+
+    // Incrementally added bodies leave broad phase trees unbalanced
+    if (m_added_since_optimize >= c_optimize_broad_phase_add_count) {
+        optimize_broad_phase();
+    }
+
+    // Transforms before and after the step are kept for rendering, which
+    // may interpolate between them when simulation runs on its own thread
+    const uint64_t step = m_step_count + 1;
+    for_each_active_jolt_rigid_body(
+        [step](Jolt_rigid_body& rigid_body) {
+            rigid_body.store_previous_transform(step);
+        }
+    );
+
+    // Each collision step runs collision detection and integration once.
+    // Sub steps split dt into multiple updates; both trade CPU time for
+    // stability of fast moving bodies and tall stacks.
+    const float sub_step_dt = static_cast<float>(dt) / static_cast<float>(m_sub_steps);
+    for (int i = 0; i < m_sub_steps; ++i) {
+        m_physics_system.Update(sub_step_dt, m_collision_steps, &m_temp_allocator, &m_job_system);
+    }
+
+    for_each_active_jolt_rigid_body(
+        [step](Jolt_rigid_body& rigid_body) {
+            rigid_body.store_current_transform(step);
+        }
     );
+    m_step_count = step;
+}
+
+auto Jolt_world::get_step_count() const -> uint64_t
+{
+    return m_step_count;
 }
 
 auto Jolt_world::describe() const -> std::vector<std::string>
@@ -228,68 +272,133 @@ auto Jolt_world::describe() const -> std::vector<std::string>
     return out;
 }
 
-void Jolt_world::add_rigid_body(IRigid_body* rigid_body)
+auto Jolt_world::get_jolt_rigid_body(IRigid_body* rigid_body) const -> Jolt_rigid_body*
 {
-    auto& body_interface  = m_physics_system.GetBodyInterface();
     auto* jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(rigid_body);
-
     ERHE_VERIFY(jolt_rigid_body != nullptr);
 
     auto* jolt_body = jolt_rigid_body->get_jolt_body();
     ERHE_VERIFY(jolt_body != nullptr);
     if (jolt_body == &JPH::Body::sFixedToWorld) {
-        return;
+        return nullptr;
     }
+    return jolt_rigid_body;
+}
 
+auto Jolt_world::insert_rigid_body(Jolt_rigid_body* jolt_rigid_body) -> bool
+{
+    if (jolt_rigid_body->get_world_index() != Jolt_rigid_body::c_not_in_world) {
+        log_physics->error("rigid body {} already in world", jolt_rigid_body->get_debug_label());
+        return false;
+    }
+    jolt_rigid_body->set_world_index(m_rigid_bodies.size());
+    m_rigid_bodies.push_back(jolt_rigid_body);
+    return true;
+}
 
-#ifndef NDEBUG
-    const auto i = std::find(m_rigid_bodies.begin(), m_rigid_bodies.end(), jolt_rigid_body);
-    if (i != m_rigid_bodies.end()) {
-        log_physics->error("rigid body {} already in world", rigid_body->get_debug_label());
-    } else
-#endif
-    {
-        body_interface.AddBody(
-            jolt_body->GetID(),
-            JPH::EActivation::DontActivate
-        );
-        m_rigid_bodies.push_back(jolt_rigid_body);
+auto Jolt_world::erase_rigid_body(Jolt_rigid_body* jolt_rigid_body) -> bool
+{
+    const std::size_t index = jolt_rigid_body->get_world_index();
+    if ((index >= m_rigid_bodies.size()) || (m_rigid_bodies[index] != jolt_rigid_body)) {
+        log_physics->error("rigid body {} not in world", jolt_rigid_body->get_debug_label());
+        return false;
     }
+    Jolt_rigid_body* last = m_rigid_bodies.back();
+    m_rigid_bodies[index] = last;
+    last->set_world_index(index);
+    m_rigid_bodies.pop_back();
+    jolt_rigid_body->set_world_index(Jolt_rigid_body::c_not_in_world);
+    return true;
+}
+
+void Jolt_world::add_rigid_body(IRigid_body* rigid_body)
+{
+    Jolt_rigid_body* jolt_rigid_body = get_jolt_rigid_body(rigid_body);
+    if (jolt_rigid_body == nullptr) {
+        return;
+    }
+    if (!insert_rigid_body(jolt_rigid_body)) {
+        return;
+    }
+
+    const JPH::BodyID body_id = jolt_rigid_body->get_jolt_body()->GetID();
+    m_physics_system.GetBodyInterface().AddBody(body_id, JPH::EActivation::DontActivate);
+    ++m_added_since_optimize;
 
     log_physics->trace(
         "added rigid body {} id = {} (total {})",
         rigid_body->get_debug_label(),
-        jolt_body->GetID().GetIndex(),
+        body_id.GetIndex(),
         m_physics_system.GetNumBodies()
     );
 }
 
 void Jolt_world::remove_rigid_body(IRigid_body* rigid_body)
 {
-    auto& body_interface  = m_physics_system.GetBodyInterface();
-    auto* jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(rigid_body);
+    Jolt_rigid_body* jolt_rigid_body = get_jolt_rigid_body(rigid_body);
+    if (jolt_rigid_body == nullptr) {
+        return;
+    }
 
-    ERHE_VERIFY(jolt_rigid_body != nullptr);
+    const JPH::BodyID body_id = jolt_rigid_body->get_jolt_body()->GetID();
+    log_physics->trace("remove rigid body {} id = {}", rigid_body->get_debug_label(), body_id.GetIndex());
 
-    auto* jolt_body = jolt_rigid_body->get_jolt_body();
-    ERHE_VERIFY(jolt_body != nullptr);
-    if (jolt_body == &JPH::Body::sFixedToWorld) {
+    if (erase_rigid_body(jolt_rigid_body)) {
+        m_physics_system.GetBodyInterface().RemoveBody(body_id);
+    }
+}
+
+void Jolt_world::add_rigid_bodies(const std::span<IRigid_body* const> rigid_bodies)
+{
+    m_body_id_batch.clear();
+    m_body_id_batch.reserve(rigid_bodies.size());
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        Jolt_rigid_body* jolt_rigid_body = get_jolt_rigid_body(rigid_body);
+        if ((jolt_rigid_body == nullptr) || !insert_rigid_body(jolt_rigid_body)) {
+            continue;
+        }
+        m_body_id_batch.push_back(jolt_rigid_body->get_jolt_body()->GetID());
+    }
+    if (m_body_id_batch.empty()) {
         return;
     }
 
-    log_physics->trace("remove rigid body {} id = {}", rigid_body->get_debug_label(), jolt_body->GetID().GetIndex());
+    // Prepare builds broad phase nodes for the whole batch, finalize
+    // inserts them with one tree update per layer
+    JPH::BodyInterface& body_interface = m_physics_system.GetBodyInterface();
+    const int body_count = static_cast<int>(m_body_id_batch.size());
+    JPH::BodyInterface::AddState add_state = body_interface.AddBodiesPrepare(m_body_id_batch.data(), body_count);
+    body_interface.AddBodiesFinalize(m_body_id_batch.data(), body_count, add_state, JPH::EActivation::DontActivate);
+    m_added_since_optimize += m_body_id_batch.size();
 
-    const auto i = std::remove(
-        m_rigid_bodies.begin(),
-        m_rigid_bodies.end(),
-        jolt_rigid_body
-    );
-    if (i == m_rigid_bodies.end()) {
-        log_physics->error("rigid body {} not in world", rigid_body->get_debug_label());
-    } else {
-        body_interface.RemoveBody(jolt_body->GetID());
-        m_rigid_bodies.erase(i, m_rigid_bodies.end());
+    log_physics->trace("added {} rigid bodies (total {})", m_body_id_batch.size(), m_physics_system.GetNumBodies());
+}
+
+void Jolt_world::remove_rigid_bodies(const std::span<IRigid_body* const> rigid_bodies)
+{
+    m_body_id_batch.clear();
+    m_body_id_batch.reserve(rigid_bodies.size());
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        Jolt_rigid_body* jolt_rigid_body = get_jolt_rigid_body(rigid_body);
+        if ((jolt_rigid_body == nullptr) || !erase_rigid_body(jolt_rigid_body)) {
+            continue;
+        }
+        m_body_id_batch.push_back(jolt_rigid_body->get_jolt_body()->GetID());
     }
+    if (m_body_id_batch.empty()) {
+        return;
+    }
+
+    m_physics_system.GetBodyInterface().RemoveBodies(m_body_id_batch.data(), static_cast<int>(m_body_id_batch.size()));
+
+    log_physics->trace("removed {} rigid bodies (total {})", m_body_id_batch.size(), m_physics_system.GetNumBodies());
+}
+
+void Jolt_world::optimize_broad_phase()
+{
+    log_physics->trace("optimize broad phase ({} bodies)", m_physics_system.GetNumBodies());
+    m_physics_system.OptimizeBroadPhase();
+    m_added_since_optimize = 0;
 }
 
 void Jolt_world::add_constraint(IConstraint* constraint)
@@ -376,18 +485,11 @@ void Jolt_world::set_on_body_deactivated(std::function<void(IRigid_body*)> callb
 
 void Jolt_world::for_each_active_body(std::function<void(IRigid_body*)> callback)
 {
-    const JPH::BodyID*  active_rigid_bodies     = m_physics_system.GetActiveBodiesUnsafe(JPH::EBodyType::RigidBody);
-    const JPH::uint32   active_rigid_body_count = m_physics_system.GetNumActiveBodies(JPH::EBodyType::RigidBody);
-    JPH::BodyInterface& body_interface    = m_physics_system.GetBodyInterfaceNoLock();
-    for (JPH::uint32 i = 0; i < active_rigid_body_count; ++i) {
-        JPH::BodyID      body_id         = active_rigid_bodies[i];
-        JPH::uint64      user_data       = body_interface.GetUserData(body_id);
-        Jolt_rigid_body* jolt_rigid_body = reinterpret_cast<Jolt_rigid_body*>(user_data);
-        if (jolt_rigid_body == nullptr) {
-            continue;
+    for_each_active_jolt_rigid_body(
+        [&callback](Jolt_rigid_body& rigid_body) {
+            callback(&rigid_body);
         }
-        callback(jolt_rigid_body);
-    }
+    );
 }
 
 void Jolt_world::OnBodyActivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData)
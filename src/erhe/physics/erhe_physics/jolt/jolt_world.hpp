@@ -1,16 +1,17 @@
 #pragma once
 
 #include "erhe_physics/iworld.hpp"
+#include "erhe_physics/jolt/jolt_job_system.hpp"
 
 #include <Jolt/Jolt.h>
 #include <Jolt/Core/TempAllocator.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
 #include <Jolt/Physics/Collision/ContactListener.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace erhe::physics {
@@ -54,7 +55,7 @@ class Jolt_world
     , public JPH::ContactListener
 {
 public:
-    Jolt_world();
+    explicit Jolt_world(const World_create_info& create_info = {});
     virtual ~Jolt_world() noexcept override;
 
     // Implements IWorld
@@ -77,6 +78,9 @@ public:
     void set_gravity         (const glm::vec3& gravity)           override;
     void add_rigid_body      (IRigid_body* rigid_body)            override;
     void remove_rigid_body   (IRigid_body* rigid_body)            override;
+    void add_rigid_bodies    (std::span<IRigid_body* const> rigid_bodies) override;
+    void remove_rigid_bodies (std::span<IRigid_body* const> rigid_bodies) override;
+    void optimize_broad_phase()                                   override;
     void add_constraint      (IConstraint* constraint)            override;
     void remove_constraint   (IConstraint* constraint)            override;
     void set_debug_drawer    (IDebug_draw* debug_draw)            override;
@@ -104,8 +108,23 @@ public:
     // Public API
     [[nodiscard]] auto get_physics_system() -> JPH::PhysicsSystem&;
 
+    // Incremented by each update_fixed_step()
+    [[nodiscard]] auto get_step_count() const -> uint64_t;
+
 private:
-    static constexpr unsigned int cMaxBodies             = 1024 * 32;
+    // Broad phase is rebuilt before next update once this many bodies
+    // have been added since previous rebuild
+    static constexpr std::size_t  c_optimize_broad_phase_add_count = 1024;
+
+    [[nodiscard]] auto get_jolt_rigid_body(IRigid_body* rigid_body) const -> Jolt_rigid_body*;
+    [[nodiscard]] auto insert_rigid_body  (Jolt_rigid_body* jolt_rigid_body) -> bool;
+    [[nodiscard]] auto erase_rigid_body   (Jolt_rigid_body* jolt_rigid_body) -> bool;
+
+    // Calls callback for each active rigid body, without taking body locks
+    template <typename T>
+    void for_each_active_jolt_rigid_body(T callback);
+
+    static constexpr unsigned int cMaxBodies             = 1024 * 64;
     static constexpr unsigned int cNumBodyMutexes        = 0;
     static constexpr unsigned int cMaxBodyPairs          = 1024 * 8;
     static constexpr unsigned int cMaxContactConstraints = 1024;
@@ -113,8 +132,11 @@ private:
     glm::vec3                                      m_gravity        {0.0f};
     const Jolt_collision_filter                    m_collision_filter;
 
+    int                                            m_collision_steps{1};
+    int                                            m_sub_steps      {1};
+    uint64_t                                       m_step_count     {0};
     JPH::TempAllocatorImpl                         m_temp_allocator;
-    JPH::JobSystemThreadPool                       m_job_system;
+    Jolt_job_system                                m_job_system;
     std::unique_ptr<JPH::BroadPhaseLayerInterface> m_broad_phase_layer_interface;
     JPH::PhysicsSystem                             m_physics_system;
     //std::unique_ptr<Jolt_debug_renderer>           m_debug_renderer;
@@ -122,8 +144,10 @@ private:
     std::function<void(Jolt_rigid_body*)>          m_on_body_activated_callback;
     std::function<void(Jolt_rigid_body*)>          m_on_body_deactivated_callback;
 
-    std::vector<Jolt_rigid_body*>                  m_rigid_bodies;
+    std::vector<Jolt_rigid_body*>                  m_rigid_bodies; // Jolt_rigid_body::get_world_index() is position in this
     std::vector<Jolt_constraint*>                  m_constraints;
+    std::vector<JPH::BodyID>                       m_body_id_batch;
+    std::size_t                                    m_added_since_optimize{0};
 
     std::vector<std::shared_ptr<ICollision_shape>> m_collision_shapes;
 
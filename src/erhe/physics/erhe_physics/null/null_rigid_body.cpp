@@ -88,6 +88,12 @@ auto Null_rigid_body::get_world_transform() const -> glm::mat4
     return m_transform;
 }
 
+auto Null_rigid_body::get_interpolated_world_transform(const float alpha) const -> glm::mat4
+{
+    static_cast<void>(alpha);
+    return m_transform;
+}
+
 void Null_rigid_body::set_restitution(float restitution)
 {
     m_restitution = restitution;
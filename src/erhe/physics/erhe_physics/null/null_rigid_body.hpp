@@ -32,6 +32,7 @@ public:
     auto get_motion_mode             () const -> Motion_mode                       override;
     auto get_restitution             () const -> float                             override;
     auto get_world_transform         () const -> Transform                         override;
+    auto get_interpolated_world_transform(float alpha) const -> glm::mat4          override;
 
     void begin_move                  ()                                             override; // Disables deactivation
     void end_move                    ()                                             override; // Sets active, clears disable deactivation
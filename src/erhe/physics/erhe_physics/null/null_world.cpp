@@ -10,18 +10,21 @@
 namespace erhe::physics
 {
 
-auto IWorld::create() -> IWorld*
+auto IWorld::create(const World_create_info& create_info) -> IWorld*
 {
+    static_cast<void>(create_info);
     return new Null_world();
 }
 
-auto IWorld::create_shared() -> std::shared_ptr<IWorld>
+auto IWorld::create_shared(const World_create_info& create_info) -> std::shared_ptr<IWorld>
 {
+    static_cast<void>(create_info);
     return std::make_shared<Null_world>();
 }
 
-auto IWorld::create_unique() -> std::unique_ptr<IWorld>
+auto IWorld::create_unique(const World_create_info& create_info) -> std::unique_ptr<IWorld>
 {
+    static_cast<void>(create_info);
     return std::make_unique<Null_world>();
 }
 
@@ -55,6 +58,22 @@ void Null_world::remove_rigid_body(IRigid_body* rigid_body)
     );
 }
 
+void Null_world::add_rigid_bodies(const std::span<IRigid_body* const> rigid_bodies)
+{
+    m_rigid_bodies.insert(m_rigid_bodies.end(), rigid_bodies.begin(), rigid_bodies.end());
+}
+
+void Null_world::remove_rigid_bodies(const std::span<IRigid_body* const> rigid_bodies)
+{
+    for (IRigid_body* rigid_body : rigid_bodies) {
+        remove_rigid_body(rigid_body);
+    }
+}
+
+void Null_world::optimize_broad_phase()
+{
+}
+
 void Null_world::add_constraint(IConstraint* constraint)
 {
     m_constraints.push_back(constraint);
@@ -22,6 +22,9 @@ public:
     auto get_gravity      () const -> glm::vec3      override;
     void add_rigid_body   (IRigid_body* rigid_body)  override;
     void remove_rigid_body(IRigid_body* rigid_body)  override;
+    void add_rigid_bodies    (std::span<IRigid_body* const> rigid_bodies) override;
+    void remove_rigid_bodies (std::span<IRigid_body* const> rigid_bodies) override;
+    void optimize_broad_phase()                                           override;
     void add_constraint   (IConstraint* constraint)  override;
     void remove_constraint(IConstraint* constraint)  override;
     void set_debug_drawer (IDebug_draw* debug_draw)  override;
@@ -0,0 +1,171 @@
+#include "erhe_physics/simulation_thread.hpp"
+#include "erhe_physics/iworld.hpp"
+#include "erhe_physics/physics_log.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+
+namespace erhe::physics {
+
+Simulation_thread::Simulation_thread(const double fixed_dt)
+    : m_fixed_dt     {fixed_dt}
+    , m_step_duration{std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{fixed_dt})}
+{
+    ERHE_VERIFY(fixed_dt > 0.0);
+}
+
+Simulation_thread::~Simulation_thread() noexcept
+{
+    stop();
+}
+
+void Simulation_thread::start()
+{
+    if (m_running.load()) {
+        return;
+    }
+    log_physics->info("Starting simulation thread, fixed step {} ms", m_fixed_dt * 1000.0);
+    m_stop_request.store(false);
+    m_running.store(true);
+    m_thread = std::thread{[this]() { run(); }};
+}
+
+void Simulation_thread::stop()
+{
+    if (!m_running.load()) {
+        return;
+    }
+    m_stop_request.store(true);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false);
+}
+
+auto Simulation_thread::is_running() const -> bool
+{
+    return m_running.load(std::memory_order_acquire);
+}
+
+void Simulation_thread::add_world(IWorld* const world)
+{
+    ERHE_VERIFY(world != nullptr);
+    const std::lock_guard<Simulation_thread> lock{*this};
+    if (std::find(m_worlds.begin(), m_worlds.end(), world) != m_worlds.end()) {
+        log_physics->error("world already in simulation thread");
+        return;
+    }
+    m_worlds.push_back(world);
+}
+
+void Simulation_thread::remove_world(IWorld* const world)
+{
+    const std::lock_guard<Simulation_thread> lock{*this};
+    const auto i = std::remove(m_worlds.begin(), m_worlds.end(), world);
+    if (i == m_worlds.end()) {
+        log_physics->error("world not in simulation thread");
+        return;
+    }
+    m_worlds.erase(i, m_worlds.end());
+}
+
+void Simulation_thread::set_paused(const bool paused)
+{
+    m_paused.store(paused, std::memory_order_release);
+}
+
+void Simulation_thread::lock()
+{
+    m_lock_requests.fetch_add(1, std::memory_order_acq_rel);
+    m_mutex.lock();
+    m_lock_requests.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void Simulation_thread::unlock()
+{
+    m_mutex.unlock();
+}
+
+auto Simulation_thread::get_interpolation_alpha() const -> float
+{
+    const auto step_end_time = Clock::time_point{Clock::duration{m_step_end_time.load(std::memory_order_acquire)}};
+    const auto elapsed       = Clock::now() - step_end_time;
+    const double alpha = std::chrono::duration<double>{elapsed}.count() / m_fixed_dt;
+    return static_cast<float>(std::clamp(alpha, 0.0, 1.0));
+}
+
+auto Simulation_thread::get_fixed_dt() const -> double
+{
+    return m_fixed_dt;
+}
+
+auto Simulation_thread::get_statistics() const -> Simulation_thread_statistics
+{
+    return Simulation_thread_statistics{
+        .step_count         = m_step_count        .load(std::memory_order_relaxed),
+        .dropped_step_count = m_dropped_step_count.load(std::memory_order_relaxed),
+        .last_step_time_ms  = m_last_step_time_ms .load(std::memory_order_relaxed),
+        .max_step_time_ms   = m_max_step_time_ms  .load(std::memory_order_relaxed)
+    };
+}
+
+void Simulation_thread::run()
+{
+    Clock::time_point next_step_time = Clock::now() + m_step_duration;
+    while (!m_stop_request.load(std::memory_order_acquire)) {
+        const Clock::time_point now = Clock::now();
+        if (now < next_step_time) {
+            std::this_thread::sleep_until(next_step_time);
+            continue;
+        }
+
+        int step_count = 0;
+        while ((next_step_time <= Clock::now()) && (step_count < c_max_steps_per_wake)) {
+            // Let pending lock() callers in before taking the next step
+            while (m_lock_requests.load(std::memory_order_acquire) > 0) {
+                std::this_thread::yield();
+            }
+            {
+                const std::lock_guard<std::recursive_mutex> lock{m_mutex};
+                if (!m_paused.load(std::memory_order_acquire)) {
+                    step();
+                }
+                m_step_end_time.store(next_step_time.time_since_epoch().count(), std::memory_order_release);
+            }
+            next_step_time += m_step_duration;
+            ++step_count;
+        }
+
+        // Still behind after c_max_steps_per_wake steps; drop whole steps
+        // instead of spiraling. A step which became due less than a step
+        // duration ago is kept and taken on the next wake.
+        if (step_count == c_max_steps_per_wake) {
+            const Clock::time_point after_steps = Clock::now();
+            if (next_step_time < after_steps) {
+                const auto behind = after_steps - next_step_time;
+                const uint64_t dropped_step_count = static_cast<uint64_t>(behind / m_step_duration);
+                m_dropped_step_count.fetch_add(dropped_step_count, std::memory_order_relaxed);
+                next_step_time += m_step_duration * static_cast<Clock::rep>(dropped_step_count);
+            }
+        }
+    }
+}
+
+void Simulation_thread::step()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const Clock::time_point start_time = Clock::now();
+    for (IWorld* world : m_worlds) {
+        world->update_fixed_step(m_fixed_dt);
+    }
+    const double step_time_ms = std::chrono::duration<double, std::milli>{Clock::now() - start_time}.count();
+    m_last_step_time_ms.store(step_time_ms, std::memory_order_relaxed);
+    if (step_time_ms > m_max_step_time_ms.load(std::memory_order_relaxed)) {
+        m_max_step_time_ms.store(step_time_ms, std::memory_order_relaxed);
+    }
+    m_step_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace erhe::physics
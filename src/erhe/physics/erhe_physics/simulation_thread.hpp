@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace erhe::physics {
+
+class IWorld;
+
+class Simulation_thread_statistics
+{
+public:
+    uint64_t step_count        {0};
+    uint64_t dropped_step_count{0};
+    double   last_step_time_ms {0.0};
+    double   max_step_time_ms  {0.0};
+};
+
+// Steps registered worlds at a fixed rate on a dedicated thread, so that
+// long simulation steps do not stretch frame time of the calling thread.
+//
+// Worlds, and rigid bodies and constraints in them, must only be accessed
+// from other threads between lock() and unlock(). A pending lock() takes
+// precedence over the next step, so callers wait for at most one step.
+// Body transforms for rendering should be read using
+// IRigid_body::get_interpolated_world_transform(get_interpolation_alpha()).
+class Simulation_thread
+{
+public:
+    // When the thread is still a whole step or more behind after this many
+    // catch up steps, whole steps are dropped
+    static constexpr int c_max_steps_per_wake = 4;
+
+    explicit Simulation_thread(double fixed_dt);
+    ~Simulation_thread() noexcept;
+
+    void start();
+    void stop ();
+    [[nodiscard]] auto is_running() const -> bool;
+
+    void add_world   (IWorld* world);
+    void remove_world(IWorld* world);
+
+    // Paused thread keeps time but does not step worlds
+    void set_paused(bool paused);
+
+    // Satisfies BasicLockable, recursive
+    void lock  ();
+    void unlock();
+
+    // Fraction of fixed step elapsed since most recent step, in [0, 1]
+    [[nodiscard]] auto get_interpolation_alpha() const -> float;
+    [[nodiscard]] auto get_fixed_dt           () const -> double;
+    [[nodiscard]] auto get_statistics         () const -> Simulation_thread_statistics;
+
+private:
+    void run ();
+    void step();
+
+    using Clock = std::chrono::steady_clock;
+
+    double                     m_fixed_dt;
+    Clock::duration            m_step_duration;
+    std::recursive_mutex       m_mutex;
+    std::vector<IWorld*>       m_worlds;
+    std::thread                m_thread;
+    std::atomic<int>           m_lock_requests     {0};
+    std::atomic<bool>          m_running           {false};
+    std::atomic<bool>          m_stop_request      {false};
+    std::atomic<bool>          m_paused            {false};
+    std::atomic<int64_t>       m_step_end_time     {0}; // Clock::duration ticks of simulated time of latest step
+    std::atomic<uint64_t>      m_step_count        {0};
+    std::atomic<uint64_t>      m_dropped_step_count{0};
+    std::atomic<double>        m_last_step_time_ms {0.0};
+    std::atomic<double>        m_max_step_time_ms  {0.0};
+};
+
+} // namespace erhe::physics
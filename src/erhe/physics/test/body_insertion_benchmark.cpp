@@ -0,0 +1,148 @@
+// Benchmark for inserting rigid bodies into a Jolt world
+//
+// Creates a grid of box bodies, 50000 by default, and inserts them once
+// with add_rigid_body() for each body, which is what scene loading did
+// before add_rigid_bodies() existed, and once with one add_rigid_bodies()
+// call. Reports insertion time and the time of the first update after
+// insertion, which includes the broad phase rebuild. Also checks that both
+// paths end up with every body in the world.
+
+#include "erhe_physics/icollision_shape.hpp"
+#include "erhe_physics/irigid_body.hpp"
+#include "erhe_physics/iworld.hpp"
+#include "erhe_physics/jolt/jolt_rigid_body.hpp"
+#include "erhe_physics/physics_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace erhe::physics;
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* label, const std::size_t body_count, const double seconds)
+{
+    fmt::print(
+        "{:<28} {:>8} bodies {:>10.3f} ms {:>14.0f} bodies/s\n",
+        label, body_count, seconds * 1000.0, static_cast<double>(body_count) / seconds
+    );
+}
+
+auto make_bodies(IWorld& world, const std::size_t body_count) -> std::vector<std::shared_ptr<IRigid_body>>
+{
+    const std::size_t side    = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(body_count))));
+    const float       spacing = 2.0f;
+
+    IRigid_body_create_info create_info{
+        .collision_shape = ICollision_shape::create_box_shape_shared(glm::vec3{0.5f}),
+        .density         = 1.0f
+    };
+
+    std::vector<std::shared_ptr<IRigid_body>> bodies;
+    bodies.reserve(body_count);
+    for (std::size_t i = 0; i < body_count; ++i) {
+        const glm::vec3 position{
+            spacing * static_cast<float>(i % side),
+            spacing * static_cast<float>((i / side) % side),
+            spacing * static_cast<float>(i / (side * side))
+        };
+        bodies.push_back(world.create_rigid_body_shared(create_info, position, glm::quat{1.0f, 0.0f, 0.0f, 0.0f}));
+    }
+    return bodies;
+}
+
+// get_rigid_body_count() includes bodies created but not added to world
+auto count_bodies_in_world(std::span<IRigid_body* const> bodies) -> std::size_t
+{
+    return static_cast<std::size_t>(
+        std::count_if(bodies.begin(), bodies.end(), [](IRigid_body* body) {
+            return static_cast<Jolt_rigid_body*>(body)->get_jolt_body()->IsInBroadPhase();
+        })
+    );
+}
+
+auto run(IWorld& world, std::span<IRigid_body* const> bodies, const bool batched) -> bool
+{
+    const char* const add_label    = batched ? "add_rigid_bodies()"    : "add_rigid_body() per body";
+    const char* const update_label = batched ? "first update, batched" : "first update, per body";
+
+    auto start = Clock::now();
+    if (batched) {
+        world.add_rigid_bodies(bodies);
+    } else {
+        for (IRigid_body* body : bodies) {
+            world.add_rigid_body(body);
+        }
+    }
+    report(add_label, bodies.size(), seconds_since(start));
+
+    const std::size_t added_count = count_bodies_in_world(bodies);
+    const bool ok = added_count == bodies.size();
+    if (!ok) {
+        fmt::print(stderr, "{}: {} bodies in world, expected {}\n", add_label, added_count, bodies.size());
+    }
+
+    start = Clock::now();
+    world.update_fixed_step(1.0 / 60.0);
+    report(update_label, bodies.size(), seconds_since(start));
+
+    world.remove_rigid_bodies(bodies);
+    const std::size_t remaining_count = count_bodies_in_world(bodies);
+    if (remaining_count != 0) {
+        fmt::print(stderr, "{}: {} bodies left in world after remove_rigid_bodies()\n", add_label, remaining_count);
+        return false;
+    }
+    return ok;
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t body_count = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 50'000;
+
+    erhe::log::initialize_log_sinks();
+    erhe::physics::initialize_logging();
+    erhe::physics::initialize_physics_system();
+
+    auto world = IWorld::create_unique(World_create_info{});
+
+    auto start = Clock::now();
+    std::vector<std::shared_ptr<IRigid_body>> bodies = make_bodies(*world.get(), body_count);
+    report("create bodies", body_count, seconds_since(start));
+
+    std::vector<IRigid_body*> body_pointers;
+    body_pointers.reserve(bodies.size());
+    for (const std::shared_ptr<IRigid_body>& body : bodies) {
+        body_pointers.push_back(body.get());
+    }
+
+    bool ok = true;
+    ok = run(*world.get(), body_pointers, false) && ok;
+    ok = run(*world.get(), body_pointers, true) && ok;
+
+    // Bodies have been removed from world by run(), and must be destroyed
+    // before world
+    body_pointers.clear();
+    bodies.clear();
+    world.reset();
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
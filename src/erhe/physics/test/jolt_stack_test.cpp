@@ -0,0 +1,299 @@
+// Headless stress test for a Jolt world stepped by Simulation_thread.
+//
+// Builds a grid of box stacks on a static floor and keeps every box awake.
+// Fixed step duration is derived from measured step time, so that the
+// thread can keep up on the machine running the test. Checks that:
+// - every thread step updates the Jolt world
+// - no steps are dropped when the thread keeps up, while the main thread
+//   reads interpolated transforms under lock() like rendering does
+// - steps delayed by lock() stalls of c_max_steps_per_wake steps are
+//   caught up, not dropped
+// - under overload only whole steps are dropped, so steps taken plus steps
+//   dropped matches elapsed time
+// - stacks are still standing and transforms are finite afterwards
+// Reports simulation throughput in body steps per second.
+
+#include "erhe_physics/icollision_shape.hpp"
+#include "erhe_physics/irigid_body.hpp"
+#include "erhe_physics/iworld.hpp"
+#include "erhe_physics/jolt/jolt_world.hpp"
+#include "erhe_physics/physics_log.hpp"
+#include "erhe_physics/simulation_thread.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace erhe::physics;
+
+using Clock = std::chrono::steady_clock;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+auto milliseconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+constexpr int   c_stack_grid_size = 6;
+constexpr int   c_stack_height    = 10;
+constexpr float c_stack_spacing   = 3.0f;
+constexpr float c_box_size        = 1.0f;
+
+// Steps taken plus steps dropped should follow elapsed time. The schedule
+// starts one step after start(), and may trail by the steps of one wake.
+auto accounted_steps_match(const Simulation_thread_statistics& statistics, const double elapsed_ms, const double fixed_dt_ms) -> bool
+{
+    const double expected = elapsed_ms / fixed_dt_ms;
+    const double accounted = static_cast<double>(statistics.step_count + statistics.dropped_step_count);
+    const double slack = static_cast<double>(Simulation_thread::c_max_steps_per_wake) + 2.0;
+    if ((accounted < expected - slack) || (accounted > expected + 1.0)) {
+        fmt::print(
+            stderr, "elapsed {:.1f} ms: {} steps + {} dropped, expected about {:.1f}\n",
+            elapsed_ms, statistics.step_count, statistics.dropped_step_count, expected
+        );
+        return false;
+    }
+    return true;
+}
+
+class Box_stacks
+{
+public:
+    explicit Box_stacks(const World_create_info& create_info)
+        : world{IWorld::create_unique(create_info)}
+    {
+        IRigid_body_create_info floor_create_info{
+            .collision_shape = ICollision_shape::create_box_shape_shared(glm::vec3{40.0f, 0.5f, 40.0f}),
+            .debug_label     = "floor",
+            .motion_mode     = Motion_mode::e_static
+        };
+        floor = world->create_rigid_body_shared(floor_create_info, glm::vec3{0.0f, -0.5f, 0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+
+        IRigid_body_create_info box_create_info{
+            .collision_shape = ICollision_shape::create_box_shape_shared(glm::vec3{0.5f * c_box_size}),
+            .density         = 1.0f,
+            .debug_label     = "box"
+        };
+        const float offset = 0.5f * c_stack_spacing * static_cast<float>(c_stack_grid_size - 1);
+        for (int z = 0; z < c_stack_grid_size; ++z) {
+            for (int x = 0; x < c_stack_grid_size; ++x) {
+                for (int y = 0; y < c_stack_height; ++y) {
+                    const glm::vec3 position{
+                        c_stack_spacing * static_cast<float>(x) - offset,
+                        c_box_size * (0.5f + static_cast<float>(y)),
+                        c_stack_spacing * static_cast<float>(z) - offset
+                    };
+                    boxes.push_back(world->create_rigid_body_shared(box_create_info, position, glm::quat{1.0f, 0.0f, 0.0f, 0.0f}));
+                }
+            }
+        }
+
+        for (const std::shared_ptr<IRigid_body>& body : boxes) {
+            bodies.push_back(body.get());
+        }
+        world->add_rigid_body(floor.get());
+        world->add_rigid_bodies(bodies);
+
+        // Bodies are added inactive. Nonzero velocity activates them, and
+        // keeping them awake keeps step cost constant for the test.
+        for (IRigid_body* body : bodies) {
+            body->set_allow_sleeping(false);
+            body->set_linear_velocity(glm::vec3{0.0f, -0.01f, 0.0f});
+        }
+    }
+
+    ~Box_stacks() noexcept
+    {
+        world->remove_rigid_bodies(bodies);
+        world->remove_rigid_body(floor.get());
+        bodies.clear();
+        boxes.clear();
+        floor.reset();
+        world.reset();
+    }
+
+    [[nodiscard]] auto get_step_count() const -> uint64_t
+    {
+        return static_cast<const Jolt_world*>(world.get())->get_step_count();
+    }
+
+    // Returns false if any interpolated transform is not finite
+    [[nodiscard]] auto read_interpolated_transforms(const float alpha) const -> bool
+    {
+        for (const IRigid_body* body : bodies) {
+            const glm::vec4 position = body->get_interpolated_world_transform(alpha)[3];
+            if (!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(position.z)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Top box of each stack should stay near its initial height
+    [[nodiscard]] auto stacks_standing() const -> bool
+    {
+        const float top_y = c_box_size * (0.5f + static_cast<float>(c_stack_height - 1));
+        for (std::size_t i = c_stack_height - 1; i < bodies.size(); i += c_stack_height) {
+            const float y = bodies[i]->get_world_transform()[3].y;
+            if (!std::isfinite(y) || (std::abs(y - top_y) > 0.5f * c_box_size)) {
+                fmt::print(stderr, "stack {} top box at y = {}, expected about {}\n", i / c_stack_height, y, top_y);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<IWorld>                   world;
+    std::shared_ptr<IRigid_body>              floor;
+    std::vector<std::shared_ptr<IRigid_body>> boxes;
+    std::vector<IRigid_body*>                 bodies;
+};
+
+// Steps world directly to let stacks settle, returns mean step time in ms
+auto settle(Box_stacks& stacks, const int step_count) -> double
+{
+    const auto start = Clock::now();
+    for (int i = 0; i < step_count; ++i) {
+        stacks.world->update_fixed_step(1.0 / 60.0);
+    }
+    return milliseconds_since(start) / static_cast<double>(step_count);
+}
+
+void test_keeps_up_and_catches_up(const double fixed_dt_ms)
+{
+    Box_stacks stacks{World_create_info{}};
+    settle(stacks, 30);
+    const uint64_t world_step_count_before = stacks.get_step_count();
+
+    Simulation_thread simulation_thread{fixed_dt_ms / 1000.0};
+    simulation_thread.add_world(stacks.world.get());
+
+    // Read transforms like rendering does, a few times per step
+    const auto render_period = std::chrono::microseconds{static_cast<int>(fixed_dt_ms * 1000.0 / 4.0)};
+    bool transforms_finite = true;
+    auto render_for = [&](const std::chrono::milliseconds duration) {
+        const auto end = Clock::now() + duration;
+        while (Clock::now() < end) {
+            {
+                const std::lock_guard<Simulation_thread> lock{simulation_thread};
+                transforms_finite = stacks.read_interpolated_transforms(simulation_thread.get_interpolation_alpha()) && transforms_finite;
+            }
+            std::this_thread::sleep_for(render_period);
+        }
+    };
+
+    auto start = Clock::now();
+    simulation_thread.start();
+    render_for(std::chrono::milliseconds{1000});
+    simulation_thread.stop();
+    double elapsed_ms = milliseconds_since(start);
+
+    auto statistics = simulation_thread.get_statistics();
+    const uint64_t world_step_count = stacks.get_step_count() - world_step_count_before;
+    fmt::print(
+        "{} bodies, {:.2f} ms fixed step: {} steps, max step {:.2f} ms, {:.0f} body steps/s\n",
+        stacks.bodies.size(), fixed_dt_ms, statistics.step_count, statistics.max_step_time_ms,
+        static_cast<double>(stacks.bodies.size() * statistics.step_count) / (elapsed_ms / 1000.0)
+    );
+    check(statistics.dropped_step_count == 0,                         "keeps up: no dropped steps");
+    check(world_step_count == statistics.step_count,                  "keeps up: every step updates Jolt world");
+    check(accounted_steps_match(statistics, elapsed_ms, fixed_dt_ms), "keeps up: steps follow elapsed time");
+    check(transforms_finite,                                          "keeps up: interpolated transforms are finite");
+    check(stacks.stacks_standing(),                                   "keeps up: stacks are standing");
+
+    // Holding the lock delays steps, which are then taken back to back
+    // when the lock is released. Steps are cheap compared to the fixed step,
+    // so all delayed steps must be caught up.
+    Simulation_thread catch_up_thread{fixed_dt_ms / 1000.0};
+    catch_up_thread.add_world(stacks.world.get());
+    const auto stall = std::chrono::microseconds{
+        static_cast<int>(fixed_dt_ms * 1000.0 * (Simulation_thread::c_max_steps_per_wake + 0.4))
+    };
+    start = Clock::now();
+    catch_up_thread.start();
+    for (int i = 0; i < 8; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds{static_cast<int>(fixed_dt_ms * 5300.0)});
+        const std::lock_guard<Simulation_thread> lock{catch_up_thread};
+        std::this_thread::sleep_for(stall);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds{static_cast<int>(fixed_dt_ms * 5000.0)});
+    catch_up_thread.stop();
+    elapsed_ms = milliseconds_since(start);
+
+    statistics = catch_up_thread.get_statistics();
+    check(statistics.dropped_step_count == 0,                         "stalls: delayed steps are caught up, not dropped");
+    check(accounted_steps_match(statistics, elapsed_ms, fixed_dt_ms), "stalls: steps follow elapsed time");
+    check(stacks.stacks_standing(),                                   "stalls: stacks are standing");
+}
+
+void test_overload_drops_whole_steps(const double fixed_dt_ms)
+{
+    Box_stacks stacks{World_create_info{}};
+    settle(stacks, 30);
+
+    // Fixed step shorter than the time a step takes
+    Simulation_thread simulation_thread{fixed_dt_ms / 1000.0};
+    simulation_thread.add_world(stacks.world.get());
+
+    const auto start = Clock::now();
+    simulation_thread.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds{800});
+    simulation_thread.stop();
+    const double elapsed_ms = milliseconds_since(start);
+
+    const auto statistics = simulation_thread.get_statistics();
+    check(statistics.dropped_step_count > 0,                          "overload: steps are dropped");
+    check(accounted_steps_match(statistics, elapsed_ms, fixed_dt_ms), "overload: steps follow elapsed time");
+    check(stacks.read_interpolated_transforms(1.0f),                  "overload: transforms are finite");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::physics::initialize_logging();
+    erhe::physics::initialize_physics_system();
+
+    // Measure step cost on this machine. Four catch up steps after a stall
+    // must fit well within a fixed step, so that stalls do not drop steps.
+    double step_time_ms = 0.0;
+    {
+        Box_stacks stacks{World_create_info{}};
+        settle(stacks, 10);
+        step_time_ms = settle(stacks, 20);
+    }
+    const double fixed_dt_ms    = std::max(1000.0 / 60.0, 16.0 * step_time_ms);
+    const double overload_dt_ms = std::max(0.05, step_time_ms / 3.0);
+
+    test_keeps_up_and_catches_up(fixed_dt_ms);
+    test_overload_drops_whole_steps(overload_dt_ms);
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("jolt stack tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+// Stress test for Simulation_thread step scheduling and lock().
+//
+// Worlds are stand ins whose update_fixed_step() sleeps for a given time.
+// Checks that steps are taken at the fixed rate without drops when the
+// thread keeps up, that a step due less than a step duration after
+// c_max_steps_per_wake catch up steps is taken instead of dropped, that
+// under sustained overload only whole steps are dropped, so steps taken
+// plus steps dropped matches elapsed time, and that lock() callers hammering
+// the thread wait for at most about one step.
+
+#include "erhe_physics/simulation_thread.hpp"
+#include "erhe_physics/iworld.hpp"
+#include "erhe_physics/physics_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+auto milliseconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+class Sleeping_world : public erhe::physics::IWorld
+{
+public:
+    std::atomic<int>         step_time_us{0};
+    std::atomic<std::size_t> update_count{0};
+
+    auto create_rigid_body(const erhe::physics::IRigid_body_create_info&, glm::vec3, glm::quat) -> erhe::physics::IRigid_body* override
+    {
+        return nullptr;
+    }
+    auto create_rigid_body_shared(const erhe::physics::IRigid_body_create_info&, glm::vec3, glm::quat) -> std::shared_ptr<erhe::physics::IRigid_body> override
+    {
+        return {};
+    }
+    auto get_gravity         () const -> glm::vec3                override { return glm::vec3{0.0f}; }
+    auto get_rigid_body_count() const -> std::size_t              override { return 0; }
+    auto get_constraint_count() const -> std::size_t              override { return 0; }
+    auto describe            () const -> std::vector<std::string> override { return {}; }
+    void update_fixed_step(double) override
+    {
+        const int time_us = step_time_us.load(std::memory_order_relaxed);
+        if (time_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds{time_us});
+        }
+        update_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    void add_rigid_body         (erhe::physics::IRigid_body*) override {}
+    void remove_rigid_body      (erhe::physics::IRigid_body*) override {}
+    void add_rigid_bodies       (std::span<erhe::physics::IRigid_body* const>) override {}
+    void remove_rigid_bodies    (std::span<erhe::physics::IRigid_body* const>) override {}
+    void optimize_broad_phase   () override {}
+    void add_constraint         (erhe::physics::IConstraint*) override {}
+    void remove_constraint      (erhe::physics::IConstraint*) override {}
+    void set_gravity            (const glm::vec3&) override {}
+    void set_debug_drawer       (erhe::physics::IDebug_draw*) override {}
+    void debug_draw             () override {}
+    void sanity_check           () override {}
+    void set_on_body_activated  (std::function<void(erhe::physics::IRigid_body*)>) override {}
+    void set_on_body_deactivated(std::function<void(erhe::physics::IRigid_body*)>) override {}
+    void for_each_active_body   (std::function<void(erhe::physics::IRigid_body*)>) override {}
+};
+
+constexpr double c_fixed_dt_ms = 10.0;
+
+// Steps taken plus steps dropped should follow elapsed time. The schedule
+// starts one step after start(), and may trail by the steps of one wake.
+auto accounted_steps_match(const erhe::physics::Simulation_thread_statistics& statistics, const double elapsed_ms) -> bool
+{
+    const double expected = elapsed_ms / c_fixed_dt_ms;
+    const double accounted = static_cast<double>(statistics.step_count + statistics.dropped_step_count);
+    const double slack = static_cast<double>(erhe::physics::Simulation_thread::c_max_steps_per_wake) + 2.0;
+    if ((accounted < expected - slack) || (accounted > expected + 1.0)) {
+        fmt::print(
+            stderr, "elapsed {:.1f} ms: {} steps + {} dropped, expected about {:.1f}\n",
+            elapsed_ms, statistics.step_count, statistics.dropped_step_count, expected
+        );
+        return false;
+    }
+    return true;
+}
+
+void test_keeps_up()
+{
+    Sleeping_world world;
+    world.step_time_us = 1'000;
+    erhe::physics::Simulation_thread simulation_thread{c_fixed_dt_ms / 1000.0};
+    simulation_thread.add_world(&world);
+
+    const auto start = Clock::now();
+    simulation_thread.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    simulation_thread.stop();
+    const double elapsed_ms = milliseconds_since(start);
+
+    const auto statistics = simulation_thread.get_statistics();
+    check(statistics.dropped_step_count == 0,            "keeps up: no dropped steps");
+    check(statistics.step_count == world.update_count,   "keeps up: every step updates world");
+    check(accounted_steps_match(statistics, elapsed_ms), "keeps up: steps follow elapsed time");
+}
+
+void test_short_stalls_caught_up()
+{
+    Sleeping_world world;
+    erhe::physics::Simulation_thread simulation_thread{c_fixed_dt_ms / 1000.0};
+    simulation_thread.add_world(&world);
+
+    // Holding the lock delays steps, which are then taken back to back when
+    // the lock is released. Depending on phase, one step more than
+    // c_max_steps_per_wake can become due during the stall. That step is
+    // less than one step duration late, and must be taken, not dropped.
+    const auto stall = std::chrono::microseconds{
+        static_cast<int>(c_fixed_dt_ms * 1000.0 * (erhe::physics::Simulation_thread::c_max_steps_per_wake + 0.4))
+    };
+    const auto start = Clock::now();
+    simulation_thread.start();
+    for (int i = 0; i < 8; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{53});
+        const std::lock_guard<erhe::physics::Simulation_thread> lock{simulation_thread};
+        std::this_thread::sleep_for(stall);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    simulation_thread.stop();
+    const double elapsed_ms = milliseconds_since(start);
+
+    const auto statistics = simulation_thread.get_statistics();
+    check(statistics.dropped_step_count == 0,            "short stalls: no dropped steps");
+    check(accounted_steps_match(statistics, elapsed_ms), "short stalls: steps follow elapsed time");
+}
+
+void test_overload_drops_whole_steps()
+{
+    // Each step takes one and a half fixed steps
+    Sleeping_world world;
+    world.step_time_us = static_cast<int>(c_fixed_dt_ms * 1500.0);
+    erhe::physics::Simulation_thread simulation_thread{c_fixed_dt_ms / 1000.0};
+    simulation_thread.add_world(&world);
+
+    const auto start = Clock::now();
+    simulation_thread.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds{800});
+    simulation_thread.stop();
+    const double elapsed_ms = milliseconds_since(start);
+
+    const auto statistics = simulation_thread.get_statistics();
+    check(statistics.dropped_step_count > 0,             "overload: steps are dropped");
+    check(accounted_steps_match(statistics, elapsed_ms), "overload: steps follow elapsed time");
+
+    // Thread never sleeps while overloaded, so it steps back to back
+    const double busy_step_count = elapsed_ms / (c_fixed_dt_ms * 1.5);
+    check(static_cast<double>(statistics.step_count) > 0.8 * busy_step_count, "overload: thread steps back to back");
+}
+
+void test_lock_stress()
+{
+    Sleeping_world world_a;
+    Sleeping_world world_b;
+    world_a.step_time_us = 3'000;
+    world_b.step_time_us = 2'000;
+    erhe::physics::Simulation_thread simulation_thread{c_fixed_dt_ms / 1000.0};
+    simulation_thread.add_world(&world_a);
+    simulation_thread.start();
+
+    std::atomic<bool>        stop_request{false};
+    std::atomic<int64_t>     max_wait_us {0};
+    std::atomic<std::size_t> lock_count  {0};
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < 4; ++thread_index) {
+        threads.emplace_back(
+            [&, thread_index]() {
+                while (!stop_request.load(std::memory_order_relaxed)) {
+                    const auto lock_start = Clock::now();
+                    simulation_thread.lock();
+                    const int64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - lock_start).count();
+                    if ((thread_index == 0) && ((lock_count.load(std::memory_order_relaxed) % 64) == 0)) {
+                        simulation_thread.add_world(&world_b); // recursive lock
+                        simulation_thread.remove_world(&world_b);
+                    }
+                    simulation_thread.unlock();
+                    lock_count.fetch_add(1, std::memory_order_relaxed);
+
+                    int64_t previous = max_wait_us.load(std::memory_order_relaxed);
+                    while ((wait_us > previous) && !max_wait_us.compare_exchange_weak(previous, wait_us)) {
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds{200 + 100 * thread_index});
+                }
+            }
+        );
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    stop_request.store(true);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    simulation_thread.stop();
+
+    const auto statistics = simulation_thread.get_statistics();
+    check(lock_count.load() > 100,          "lock stress: lockers make progress");
+    check(statistics.step_count > 10,       "lock stress: steps make progress");
+    check(!simulation_thread.is_running(),  "lock stress: thread stopped");
+
+    // Pending lock() goes before the next step; wait is at most about one
+    // step of both worlds plus other lockers, well below a fixed step count
+    const int64_t wait_limit_us = static_cast<int64_t>(c_fixed_dt_ms * 1000.0 * 4);
+    check(max_wait_us.load() < wait_limit_us, "lock stress: lock() waits for at most about one step");
+    if (max_wait_us.load() >= wait_limit_us) {
+        fmt::print(stderr, "max lock wait {} us\n", max_wait_us.load());
+    }
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::physics::initialize_logging();
+
+    test_keeps_up();
+    test_short_stalls_caught_up();
+    test_overload_drops_whole_steps();
+    test_lock_stress();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("simulation thread tests passed\n");
+    return EXIT_SUCCESS;
+}
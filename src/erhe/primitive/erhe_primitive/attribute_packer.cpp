@@ -0,0 +1,231 @@
+#include "erhe_primitive/attribute_packer.hpp"
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define ERHE_PRIMITIVE_USE_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+namespace erhe::primitive {
+
+namespace {
+
+// Normalized integer encodings. Conversion matches erhe::dataformat
+// float_to_unorm8() etc. bit for bit: scale, round half away from zero,
+// clamp, truncate.
+class Unorm8  { public: using Storage = uint8_t;  static constexpr bool is_signed = false; static constexpr float scale =   255.0f; static constexpr float min =      0.0f; static constexpr float max =   255.0f; };
+class Snorm8  { public: using Storage = int8_t;   static constexpr bool is_signed = true;  static constexpr float scale =   127.0f; static constexpr float min =   -128.0f; static constexpr float max =   127.0f; };
+class Unorm16 { public: using Storage = uint16_t; static constexpr bool is_signed = false; static constexpr float scale = 65535.0f; static constexpr float min =      0.0f; static constexpr float max = 65535.0f; };
+class Snorm16 { public: using Storage = int16_t;  static constexpr bool is_signed = true;  static constexpr float scale = 32767.0f; static constexpr float min = -32768.0f; static constexpr float max = 32767.0f; };
+
+// Converts four floats at once; unused lanes are ignored by the caller
+template <typename Encoding>
+[[nodiscard]] inline auto encode_normalized(const glm::vec4 value) -> std::array<int32_t, 4>
+{
+    std::array<int32_t, 4> result;
+#if defined(ERHE_PRIMITIVE_USE_SSE2)
+    const __m128 x = _mm_loadu_ps(&value.x);
+    __m128 bias;
+    if constexpr (Encoding::is_signed) {
+        const __m128 non_negative = _mm_cmpge_ps(x, _mm_setzero_ps());
+        bias = _mm_or_ps(
+            _mm_and_ps   (non_negative, _mm_set1_ps( 0.5f)),
+            _mm_andnot_ps(non_negative, _mm_set1_ps(-0.5f))
+        );
+    } else {
+        bias = _mm_set1_ps(0.5f);
+    }
+    __m128 a = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(Encoding::scale)), bias);
+    a = _mm_min_ps(_mm_max_ps(a, _mm_set1_ps(Encoding::min)), _mm_set1_ps(Encoding::max));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()), _mm_cvttps_epi32(a));
+#else
+    for (glm::length_t i = 0; i < 4; ++i) {
+        const float v    = value[i];
+        const float bias = (!Encoding::is_signed || (v >= 0.0f)) ? 0.5f : -0.5f;
+        float a = v * Encoding::scale + bias;
+        if (a < Encoding::min) {
+            a = Encoding::min;
+        }
+        if (a > Encoding::max) {
+            a = Encoding::max;
+        }
+        result[static_cast<std::size_t>(i)] = static_cast<int32_t>(a);
+    }
+#endif
+    return result;
+}
+
+template <glm::length_t N>
+[[nodiscard]] inline auto widen(const glm::vec<N, float> value) -> glm::vec4
+{
+    if constexpr (N == 2) {
+        return glm::vec4{value, 0.0f, 0.0f};
+    } else if constexpr (N == 3) {
+        return glm::vec4{value, 0.0f};
+    } else {
+        return value;
+    }
+}
+
+template <glm::length_t N>
+void pack_float(std::uint8_t* const destination, const glm::vec<N, float> value)
+{
+    std::memcpy(destination, &value.x, N * sizeof(float));
+}
+
+template <typename Encoding, glm::length_t N>
+void pack_normalized(std::uint8_t* const destination, const glm::vec<N, float> value)
+{
+    using Storage = typename Encoding::Storage;
+    const std::array<int32_t, 4> encoded = encode_normalized<Encoding>(widen<N>(value));
+    std::array<Storage, N> packed;
+    for (std::size_t i = 0; i < N; ++i) {
+        packed[i] = static_cast<Storage>(encoded[i]);
+    }
+    std::memcpy(destination, packed.data(), sizeof(packed));
+}
+
+template <glm::length_t N>
+void pack_half(std::uint8_t* const destination, const glm::vec<N, float> value)
+{
+    std::array<uint16_t, N> packed;
+    for (glm::length_t i = 0; i < N; ++i) {
+        packed[static_cast<std::size_t>(i)] = erhe::dataformat::float_to_half(value[i]);
+    }
+    std::memcpy(destination, packed.data(), sizeof(packed));
+}
+
+// Unit vector to two normalized components, see erhe::dataformat::encode_octahedral()
+template <typename Encoding>
+void pack_octahedral(std::uint8_t* const destination, const glm::vec3 value)
+{
+    glm::vec2 uv;
+    erhe::dataformat::encode_octahedral(value.x, value.y, value.z, uv.x, uv.y);
+    pack_normalized<Encoding, 2>(destination, uv);
+}
+
+// Tangent with handedness in w to two octahedral components and sign
+template <typename Encoding>
+void pack_octahedral_signed(std::uint8_t* const destination, const glm::vec4 value)
+{
+    glm::vec3 uvw;
+    erhe::dataformat::encode_octahedral(value.x, value.y, value.z, uvw.x, uvw.y);
+    uvw.z = (value.w < 0.0f) ? -1.0f : 1.0f;
+    pack_normalized<Encoding, 3>(destination, uvw);
+}
+
+template <typename Storage, bool checked>
+[[nodiscard]] inline auto narrow(const uint32_t value) -> Storage
+{
+    if constexpr (checked && (sizeof(Storage) < sizeof(uint32_t))) {
+        ERHE_VERIFY(value <= std::numeric_limits<Storage>::max());
+    }
+    return static_cast<Storage>(value);
+}
+
+template <typename Storage, bool checked>
+void pack_uint_scalar(std::uint8_t* const destination, const uint32_t value)
+{
+    const Storage packed = narrow<Storage, checked>(value);
+    std::memcpy(destination, &packed, sizeof(Storage));
+}
+
+template <typename Storage, glm::length_t N>
+void pack_uint_vector(std::uint8_t* const destination, const glm::vec<N, uint32_t> value)
+{
+    std::array<Storage, N> packed;
+    for (glm::length_t i = 0; i < N; ++i) {
+        packed[static_cast<std::size_t>(i)] = narrow<Storage, true>(value[i]);
+    }
+    std::memcpy(destination, packed.data(), sizeof(packed));
+}
+
+void unsupported_uint (std::uint8_t*, uint32_t  ) { ERHE_FATAL("unsupported attribute type"); }
+void unsupported_uvec2(std::uint8_t*, glm::uvec2) { ERHE_FATAL("unsupported attribute type"); }
+void unsupported_uvec4(std::uint8_t*, glm::uvec4) { ERHE_FATAL("unsupported attribute type"); }
+void unsupported_vec2 (std::uint8_t*, glm::vec2 ) { ERHE_FATAL("unsupported attribute type"); }
+void unsupported_vec3 (std::uint8_t*, glm::vec3 ) { ERHE_FATAL("unsupported attribute type"); }
+void unsupported_vec4 (std::uint8_t*, glm::vec4 ) { ERHE_FATAL("unsupported attribute type"); }
+void bad_index_type   (std::uint8_t*, uint32_t  ) { ERHE_FATAL("bad index type"); }
+
+} // namespace
+
+Attribute_packer::Attribute_packer()
+    : pack_uint {&unsupported_uint}
+    , pack_uvec2{&unsupported_uvec2}
+    , pack_uvec4{&unsupported_uvec4}
+    , pack_vec2 {&unsupported_vec2}
+    , pack_vec3 {&unsupported_vec3}
+    , pack_vec4 {&unsupported_vec4}
+{
+}
+
+auto Attribute_packer::make(const erhe::dataformat::Format format) -> Attribute_packer
+{
+    using erhe::dataformat::Format;
+
+    Attribute_packer packer;
+    switch (format) {
+        case Format::format_8_scalar_uint:  packer.pack_uint  = &pack_uint_scalar<uint8_t,  true>; break;
+        case Format::format_16_scalar_uint: packer.pack_uint  = &pack_uint_scalar<uint16_t, true>; break;
+        case Format::format_32_scalar_uint: packer.pack_uint  = &pack_uint_scalar<uint32_t, true>; break;
+
+        case Format::format_8_vec2_uint:    packer.pack_uvec2 = &pack_uint_vector<uint8_t,  2>; break;
+        case Format::format_16_vec2_uint:   packer.pack_uvec2 = &pack_uint_vector<uint16_t, 2>; break;
+        case Format::format_32_vec2_uint:   packer.pack_uvec2 = &pack_uint_vector<uint32_t, 2>; break;
+
+        case Format::format_8_vec4_uint:    packer.pack_uvec4 = &pack_uint_vector<uint8_t,  4>; break;
+        case Format::format_16_vec4_uint:   packer.pack_uvec4 = &pack_uint_vector<uint16_t, 4>; break;
+        case Format::format_32_vec4_uint:   packer.pack_uvec4 = &pack_uint_vector<uint32_t, 4>; break;
+
+        case Format::format_32_vec2_float:  packer.pack_vec2  = &pack_float<2>;                break;
+        case Format::format_8_vec2_unorm:   packer.pack_vec2  = &pack_normalized<Unorm8,  2>;  break;
+        case Format::format_8_vec2_snorm:   packer.pack_vec2  = &pack_normalized<Snorm8,  2>;  packer.pack_vec3 = &pack_octahedral<Snorm8>;  break;
+        case Format::format_16_vec2_unorm:  packer.pack_vec2  = &pack_normalized<Unorm16, 2>;  break;
+        case Format::format_16_vec2_snorm:  packer.pack_vec2  = &pack_normalized<Snorm16, 2>;  packer.pack_vec3 = &pack_octahedral<Snorm16>; break;
+        case Format::format_16_vec2_float:  packer.pack_vec2  = &pack_half<2>;                 break;
+
+        case Format::format_32_vec3_float:  packer.pack_vec3  = &pack_float<3>;                break;
+        case Format::format_8_vec3_unorm:   packer.pack_vec3  = &pack_normalized<Unorm8,  3>;  break;
+        case Format::format_8_vec3_snorm:   packer.pack_vec3  = &pack_normalized<Snorm8,  3>;  packer.pack_vec4 = &pack_octahedral_signed<Snorm8>;  break;
+        case Format::format_16_vec3_unorm:  packer.pack_vec3  = &pack_normalized<Unorm16, 3>;  break;
+        case Format::format_16_vec3_snorm:  packer.pack_vec3  = &pack_normalized<Snorm16, 3>;  packer.pack_vec4 = &pack_octahedral_signed<Snorm16>; break;
+        case Format::format_16_vec3_float:  packer.pack_vec3  = &pack_half<3>;                 break;
+
+        case Format::format_32_vec4_float:  packer.pack_vec4  = &pack_float<4>;                break;
+        case Format::format_8_vec4_unorm:   packer.pack_vec4  = &pack_normalized<Unorm8,  4>;  break;
+        case Format::format_8_vec4_snorm:   packer.pack_vec4  = &pack_normalized<Snorm8,  4>;  break;
+        case Format::format_16_vec4_unorm:  packer.pack_vec4  = &pack_normalized<Unorm16, 4>;  break;
+        case Format::format_16_vec4_snorm:  packer.pack_vec4  = &pack_normalized<Snorm16, 4>;  break;
+        case Format::format_16_vec4_float:  packer.pack_vec4  = &pack_half<4>;                 break;
+
+        default: {
+            break;
+        }
+    }
+    return packer;
+}
+
+auto Attribute_packer::make_index(const erhe::dataformat::Format format) -> Attribute_packer
+{
+    using erhe::dataformat::Format;
+
+    Attribute_packer packer;
+    switch (format) {
+        case Format::format_8_scalar_uint:  packer.pack_uint = &pack_uint_scalar<uint8_t,  false>; break;
+        case Format::format_16_scalar_uint: packer.pack_uint = &pack_uint_scalar<uint16_t, false>; break;
+        case Format::format_32_scalar_uint: packer.pack_uint = &pack_uint_scalar<uint32_t, false>; break;
+        default: {
+            packer.pack_uint = &bad_index_type;
+            break;
+        }
+    }
+    return packer;
+}
+
+} // namespace erhe::primitive
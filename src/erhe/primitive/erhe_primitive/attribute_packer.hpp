@@ -0,0 +1,50 @@
+#pragma once
+
+#include "erhe_dataformat/dataformat.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace erhe::primitive {
+
+/// Format specific attribute value packers.
+///
+/// Resolved once from erhe::dataformat::Format (per attribute per
+/// Build_context), so that writing a value is a single call to a
+/// specialised function with no per-value format switch. Entries for
+/// value types that do not match the format point to a function which
+/// reports an error.
+///
+/// Unit vectors packed into one component less than their length use
+/// octahedral encoding: pack_vec3() to a two component snorm format
+/// stores a normal, pack_vec4() to a three component snorm format stores
+/// a tangent as octahedral xy with handedness (w sign) in z.
+class Attribute_packer
+{
+public:
+    using Pack_uint  = void (*)(std::uint8_t* destination, uint32_t   value);
+    using Pack_uvec2 = void (*)(std::uint8_t* destination, glm::uvec2 value);
+    using Pack_uvec4 = void (*)(std::uint8_t* destination, glm::uvec4 value);
+    using Pack_vec2  = void (*)(std::uint8_t* destination, glm::vec2  value);
+    using Pack_vec3  = void (*)(std::uint8_t* destination, glm::vec3  value);
+    using Pack_vec4  = void (*)(std::uint8_t* destination, glm::vec4  value);
+
+    Attribute_packer();
+
+    /// Packers for vertex attributes. Narrowing integer formats verify range.
+    [[nodiscard]] static auto make(erhe::dataformat::Format format) -> Attribute_packer;
+
+    /// Packers for index buffers. Range is expected to have been verified
+    /// once for the whole buffer, so narrowing is not checked per index.
+    [[nodiscard]] static auto make_index(erhe::dataformat::Format format) -> Attribute_packer;
+
+    Pack_uint  pack_uint;
+    Pack_uvec2 pack_uvec2;
+    Pack_uvec4 pack_uvec4;
+    Pack_vec2  pack_vec2;
+    Pack_vec3  pack_vec3;
+    Pack_vec4  pack_vec4;
+};
+
+} // namespace erhe::primitive
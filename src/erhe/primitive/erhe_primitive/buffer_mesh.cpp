@@ -14,6 +14,40 @@ auto Buffer_mesh::base_index() const -> uint32_t
     return static_cast<uint32_t>(index_buffer_range.byte_offset / index_buffer_range.element_size);
 }
 
+void Buffer_mesh::set_position_quantization(const erhe::dataformat::Format position_format)
+{
+    using erhe::dataformat::Format;
+
+    position_scale  = glm::vec3{1.0f, 1.0f, 1.0f};
+    position_offset = glm::vec3{0.0f, 0.0f, 0.0f};
+
+    const bool is_unorm = (position_format == Format::format_8_vec3_unorm) || (position_format == Format::format_16_vec3_unorm);
+    const bool is_snorm = (position_format == Format::format_8_vec3_snorm) || (position_format == Format::format_16_vec3_snorm);
+    if ((!is_unorm && !is_snorm) || !bounding_box.is_valid()) {
+        return;
+    }
+
+    // Flat axes get unit extent, every position maps to zero there
+    glm::vec3 extent = bounding_box.diagonal();
+    for (glm::length_t i = 0; i < 3; ++i) {
+        if (!(extent[i] > 0.0f)) {
+            extent[i] = 1.0f;
+        }
+    }
+    if (is_unorm) { // stored 0 .. 1
+        position_scale  = extent;
+        position_offset = bounding_box.min;
+    } else {        // stored -1 .. 1
+        position_scale  = 0.5f * extent;
+        position_offset = bounding_box.center();
+    }
+}
+
+auto Buffer_mesh::quantize_position(const glm::vec3 position) const -> glm::vec3
+{
+    return (position - position_offset) / position_scale;
+}
+
 auto Buffer_mesh::index_range(const Primitive_mode primitive_mode) const -> Index_range
 {
     switch (primitive_mode) {
@@ -28,6 +62,24 @@ auto Buffer_mesh::index_range(const Primitive_mode primitive_mode) const -> Inde
     }
 }
 
+auto Buffer_mesh::get_lod_count() const -> std::size_t
+{
+    return 1 + triangle_fill_lods.size();
+}
+
+auto Buffer_mesh::get_lod_error(const std::size_t lod) const -> float
+{
+    return ((lod > 0) && (lod <= triangle_fill_lods.size())) ? triangle_fill_lods[lod - 1].error : 0.0f;
+}
+
+auto Buffer_mesh::index_range(const Primitive_mode primitive_mode, const std::size_t lod) const -> Index_range
+{
+    if ((primitive_mode == Primitive_mode::polygon_fill) && (lod > 0) && (lod <= triangle_fill_lods.size())) {
+        return triangle_fill_lods[lod - 1].triangle_fill_indices;
+    }
+    return index_range(primitive_mode);
+}
+
 auto primitive_type(const Primitive_mode primitive_mode) -> std::optional<gl::Primitive_type>
 {
     switch (primitive_mode) {
@@ -3,13 +3,25 @@
 #include "erhe_primitive/buffer_range.hpp"
 #include "erhe_primitive/index_range.hpp"
 #include "erhe_primitive/enums.hpp"
+#include "erhe_dataformat/dataformat.hpp"
 #include "erhe_math/math_util.hpp"
 
+#include <glm/glm.hpp>
+
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace erhe::primitive {
 
+// Reduced detail polygon fill, indexing same vertices as full detail
+class Buffer_mesh_lod
+{
+public:
+    Index_range triangle_fill_indices{};
+    float       error                {0.0f}; // Object space distance bound from full detail surface
+};
+
 class Buffer_mesh
 {
 public:
@@ -17,6 +29,18 @@ public:
     [[nodiscard]] auto base_index () const -> uint32_t;
     [[nodiscard]] auto index_range(const Primitive_mode primitive_mode) const -> Index_range;
 
+    // Level 0 is full detail, level n > 0 is triangle_fill_lods[n - 1].
+    // Only polygon fill has reduced levels, other modes use full detail.
+    [[nodiscard]] auto get_lod_count() const -> std::size_t;
+    [[nodiscard]] auto get_lod_error(std::size_t lod) const -> float;
+    [[nodiscard]] auto index_range  (Primitive_mode primitive_mode, std::size_t lod) const -> Index_range;
+
+    // Positions in normalized integer formats are stored relative to
+    // bounding box, which must be set before calling. Float formats keep
+    // identity scale and offset.
+    void set_position_quantization(erhe::dataformat::Format position_format);
+    [[nodiscard]] auto quantize_position(const glm::vec3 position) const -> glm::vec3;
+
     erhe::math::Bounding_box    bounding_box;
     erhe::math::Bounding_sphere bounding_sphere;
 
@@ -25,6 +49,12 @@ public:
     Index_range  corner_point_indices    {};
     Index_range  polygon_centroid_indices{};
 
+    std::vector<Buffer_mesh_lod> triangle_fill_lods; // Increasing error
+
+    // Object space position = position_offset + position_scale * stored position
+    glm::vec3 position_scale {1.0f, 1.0f, 1.0f};
+    glm::vec3 position_offset{0.0f, 0.0f, 0.0f};
+
     Buffer_range vertex_buffer_range     {};
     Buffer_range index_buffer_range      {};
 };
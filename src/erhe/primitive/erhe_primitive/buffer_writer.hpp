@@ -1,6 +1,8 @@
 #pragma once
 
+#include "erhe_primitive/attribute_packer.hpp"
 #include "erhe_primitive/buffer_range.hpp"
+#include "erhe_primitive/index_range.hpp"
 #include "erhe_primitive/vertex_attribute_info.hpp"
 #include "erhe_dataformat/dataformat.hpp"
 
@@ -29,13 +31,13 @@ public:
     Vertex_buffer_writer(Build_context& build_context, Buffer_sink& buffer_sink);
     virtual ~Vertex_buffer_writer() noexcept;
 
-    void write(const Vertex_attribute_info& attribute, const glm::vec2 value);
-    void write(const Vertex_attribute_info& attribute, const glm::vec3 value);
-    void write(const Vertex_attribute_info& attribute, const glm::vec4 value);
-    void write(const Vertex_attribute_info& attribute, const uint32_t value);
-    void write(const Vertex_attribute_info& attribute, const glm::uvec2 value);
-    void write(const Vertex_attribute_info& attribute, const glm::uvec4 value);
-    void move (const std::size_t relative_offset);
+    // Writes may be done concurrently from multiple threads to different vertices
+    void write(std::size_t vertex_byte_offset, const Vertex_attribute_info& attribute, const glm::vec2 value);
+    void write(std::size_t vertex_byte_offset, const Vertex_attribute_info& attribute, const glm::vec3 value);
+    void write(std::size_t vertex_byte_offset, const Vertex_attribute_info& attribute, const glm::vec4 value);
+    void write(std::size_t vertex_byte_offset, const Vertex_attribute_info& attribute, const uint32_t value);
+    void write(std::size_t vertex_byte_offset, const Vertex_attribute_info& attribute, const glm::uvec2 value);
+    void write(std::size_t vertex_byte_offset, const Vertex_attribute_info& attribute, const glm::uvec4 value);
 
     [[nodiscard]] auto start_offset() -> std::size_t;
 
@@ -44,7 +46,6 @@ public:
     Buffer_range              buffer_range;
     std::vector<std::uint8_t> vertex_data;
     std::span<std::uint8_t>   vertex_data_span;
-    std::size_t               vertex_write_offset{0};
 };
 
 /// Writes 8/16/32 -bit indices to byte buffer/memory
@@ -56,11 +57,15 @@ public:
     Index_buffer_writer(Build_context& build_context, Buffer_sink& buffer_sink);
     virtual ~Index_buffer_writer() noexcept;
 
-    void write_corner  (const uint32_t v0);
-    void write_triangle(const uint32_t v0, const uint32_t v1, const uint32_t v2);
-    void write_quad    (const uint32_t v0, const uint32_t v1, const uint32_t v2, const uint32_t v3);
-    void write_edge    (const uint32_t v0, const uint32_t v1);
-    void write_centroid(const uint32_t v0);
+    // Position is corner, triangle, edge or centroid number within its index range.
+    // Writes may be done concurrently from multiple threads to different positions.
+    void write_corner  (std::size_t position, const uint32_t v0);
+    void write_triangle(std::size_t position, const uint32_t v0, const uint32_t v1, const uint32_t v2);
+    void write_edge    (std::size_t position, const uint32_t v0, const uint32_t v1);
+    void write_centroid(std::size_t position, const uint32_t v0);
+
+    // Writes indices to an index range other than the ones above, such as level of detail
+    void write_indices (const Index_range& index_range, std::span<const uint32_t> indices);
 
     [[nodiscard]] auto start_offset() -> std::size_t;
 
@@ -69,17 +74,13 @@ public:
     Buffer_range                   buffer_range;
     const erhe::dataformat::Format index_type;
     const std::size_t              index_type_size{0};
+    Attribute_packer::Pack_uint    pack_index;
     std::vector<std::uint8_t>      index_data;
     std::span<std::uint8_t>        index_data_span;
     std::span<std::uint8_t>        corner_point_index_data_span;
     std::span<std::uint8_t>        triangle_fill_index_data_span;
     std::span<std::uint8_t>        edge_line_index_data_span;
     std::span<std::uint8_t>        polygon_centroid_index_data_span;
-
-    std::size_t corner_point_indices_written    {0};
-    std::size_t triangle_indices_written        {0};
-    std::size_t edge_line_indices_written       {0};
-    std::size_t polygon_centroid_indices_written{0};
 };
 
 } // namespace erhe::primitive
@@ -4,7 +4,9 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace erhe::graphics {
@@ -22,6 +24,31 @@ public:
     bool centroid_points{false};
 };
 
+// Opt-in reordering of triangle fill indices and fill vertices, applied
+// after polygon fill is built. Element_mappings are kept consistent.
+class Index_optimization
+{
+public:
+    bool  vertex_cache      {false}; // Reorder triangles for post-transform vertex cache
+    bool  overdraw          {false}; // Reorder triangle clusters outward facing first
+    bool  vertex_fetch      {false}; // Reorder vertices to order of first use
+    float overdraw_threshold{1.05f}; // Allowed cluster ACMR relative to vertex cache order
+    bool  log_statistics    {false}; // Log ACMR / ATVR before and after
+
+    [[nodiscard]] auto is_enabled() const -> bool { return vertex_cache || overdraw || vertex_fetch; }
+};
+
+// Opt-in reduced detail polygon fill levels, made with quadric error
+// simplification. Levels share the vertex buffer of full detail.
+class Lod_settings
+{
+public:
+    std::size_t level_count       {0};    // Levels in addition to full detail, 0 disables
+    float       reduction         {0.5f}; // Target triangle count relative to previous level
+    std::size_t min_triangle_count{256};  // Levels are not made at or below this triangle count
+    float       max_error         {std::numeric_limits<float>::max()}; // Object space error limit, accumulated over levels
+};
+
 class Build_info
 {
 public:
@@ -32,6 +59,9 @@ public:
     Normal_style                               normal_style             {Normal_style::corner_normals};
     erhe::graphics::Vertex_attribute_mappings* vertex_attribute_mappings{nullptr};
     bool                                       autocolor                {false};
+    std::size_t                                parallel_threshold       {16384}; // Minimum polygon count for multi-threaded build, 0 disables
+    Index_optimization                         index_optimization       {};
+    Lod_settings                               lod                      {};
 };
 
 class Element_mappings
@@ -0,0 +1,437 @@
+#include "erhe_primitive/index_optimizer.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace erhe::primitive {
+
+namespace {
+
+// FIFO cache simulation. A vertex is in cache if it was transformed less
+// than cache_size transforms ago. Bumping timestamp by cache_size + 1
+// flushes the cache.
+class Fifo_cache
+{
+public:
+    Fifo_cache(const std::size_t vertex_count, const unsigned int cache_size)
+        : m_timestamps{std::vector<uint32_t>(vertex_count, 0)}
+        , m_cache_size{cache_size}
+        , m_timestamp {cache_size + 1}
+    {
+    }
+
+    void flush()
+    {
+        m_timestamp += m_cache_size + 1;
+    }
+
+    auto access(const uint32_t vertex) -> unsigned int
+    {
+        if (m_timestamp - m_timestamps[vertex] > m_cache_size) {
+            m_timestamps[vertex] = m_timestamp++;
+            return 1;
+        }
+        return 0;
+    }
+
+    auto access_triangle(const uint32_t* triangle) -> unsigned int
+    {
+        return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+    }
+
+private:
+    std::vector<uint32_t> m_timestamps;
+    unsigned int          m_cache_size;
+    uint32_t              m_timestamp;
+};
+
+// Tuning from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+constexpr int   c_max_cache_size      = 32;
+constexpr float c_cache_decay_power   = 1.5f;
+constexpr float c_last_triangle_score = 0.75f;
+constexpr float c_valence_boost_scale = 2.0f;
+constexpr float c_valence_boost_power = 0.5f;
+constexpr int   c_max_valence_table   = 32;
+
+class Vertex_scores
+{
+public:
+    Vertex_scores()
+    {
+        for (int i = 0; i < c_max_cache_size; ++i) {
+            if (i < 3) {
+                cache[i] = c_last_triangle_score;
+            } else {
+                const float scaler = 1.0f / static_cast<float>(c_max_cache_size - 3);
+                cache[i] = std::pow(1.0f - static_cast<float>(i - 3) * scaler, c_cache_decay_power);
+            }
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i < c_max_valence_table; ++i) {
+            valence[i] = c_valence_boost_scale * std::pow(static_cast<float>(i), -c_valence_boost_power);
+        }
+    }
+
+    [[nodiscard]] auto get(const int cache_position, const uint32_t live_triangle_count) const -> float
+    {
+        if (live_triangle_count == 0) {
+            return -1.0f; // No triangles left, score does not matter
+        }
+        const float cache_score = (cache_position >= 0) ? cache[cache_position] : 0.0f;
+        const float valence_score = (live_triangle_count < c_max_valence_table)
+            ? valence[live_triangle_count]
+            : c_valence_boost_scale * std::pow(static_cast<float>(live_triangle_count), -c_valence_boost_power);
+        return cache_score + valence_score;
+    }
+
+    std::array<float, c_max_cache_size>    cache;
+    std::array<float, c_max_valence_table> valence;
+};
+
+constexpr uint32_t c_no_triangle = std::numeric_limits<uint32_t>::max();
+
+} // anonymous namespace
+
+auto analyze_vertex_cache(
+    const std::span<const uint32_t> indices,
+    const std::size_t               vertex_count,
+    const unsigned int              cache_size
+) -> Vertex_cache_statistics
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(indices.size() % 3 == 0);
+
+    Vertex_cache_statistics statistics{};
+    statistics.triangle_count = indices.size() / 3;
+    if (statistics.triangle_count == 0) {
+        return statistics;
+    }
+
+    Fifo_cache        cache{vertex_count, cache_size};
+    std::vector<bool> referenced(vertex_count, false);
+    for (const uint32_t vertex : indices) {
+        ERHE_VERIFY(vertex < vertex_count);
+        statistics.vertices_transformed += cache.access(vertex);
+        if (!referenced[vertex]) {
+            referenced[vertex] = true;
+            ++statistics.vertex_count;
+        }
+    }
+
+    statistics.acmr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(statistics.triangle_count);
+    statistics.atvr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(statistics.vertex_count);
+    return statistics;
+}
+
+auto optimize_vertex_cache(const std::span<const uint32_t> indices, const std::size_t vertex_count) -> std::vector<uint32_t>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(indices.size() % 3 == 0);
+    const std::size_t triangle_count = indices.size() / 3;
+
+    std::vector<uint32_t> triangle_order;
+    triangle_order.reserve(triangle_count);
+    if (triangle_count == 0) {
+        return triangle_order;
+    }
+
+    // Vertex to live triangle adjacency, in compressed rows. Emitted
+    // triangles are swap-removed from the live part of each row.
+    std::vector<uint32_t> live_triangle_count(vertex_count, 0);
+    for (const uint32_t vertex : indices) {
+        ERHE_VERIFY(vertex < vertex_count);
+        ++live_triangle_count[vertex];
+    }
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    std::partial_sum(live_triangle_count.begin(), live_triangle_count.end(), adjacency_offsets.begin() + 1);
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill_offsets{adjacency_offsets.begin(), adjacency_offsets.end() - 1};
+        for (std::size_t i = 0, end = indices.size(); i < end; ++i) {
+            adjacency[fill_offsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    static const Vertex_scores scores;
+
+    std::vector<float> vertex_score(vertex_count);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        vertex_score[vertex] = scores.get(-1, live_triangle_count[vertex]);
+    }
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool>  emitted       (triangle_count, false);
+    uint32_t best_triangle = 0;
+    for (std::size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        const uint32_t* v = &indices[3 * triangle];
+        triangle_score[triangle] = vertex_score[v[0]] + vertex_score[v[1]] + vertex_score[v[2]];
+        if (triangle_score[triangle] > triangle_score[best_triangle]) {
+            best_triangle = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    std::array<uint32_t, c_max_cache_size + 3> cache{};
+    std::array<uint32_t, c_max_cache_size + 3> new_cache{};
+    std::size_t cache_size = 0;
+    std::size_t input_cursor = 0; // Fallback when nothing in cache has live triangles
+
+    while (triangle_order.size() < triangle_count) {
+        if (best_triangle == c_no_triangle) {
+            while (emitted[input_cursor]) {
+                ++input_cursor;
+            }
+            best_triangle = static_cast<uint32_t>(input_cursor);
+        }
+
+        const uint32_t  triangle = best_triangle;
+        const uint32_t* v        = &indices[3 * triangle];
+        triangle_order.push_back(triangle);
+        emitted[triangle] = true;
+
+        // Remove triangle from live adjacency of its vertices
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t vertex = v[k];
+            uint32_t* const row   = &adjacency[adjacency_offsets[vertex]];
+            uint32_t&       count = live_triangle_count[vertex];
+            for (uint32_t i = 0; i < count; ++i) {
+                if (row[i] == triangle) {
+                    row[i] = row[count - 1];
+                    --count;
+                    break;
+                }
+            }
+        }
+
+        // Emitted triangle vertices move to front of LRU cache
+        std::size_t new_cache_size = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (std::find(new_cache.begin(), new_cache.begin() + new_cache_size, v[k]) == new_cache.begin() + new_cache_size) {
+                new_cache[new_cache_size++] = v[k];
+            }
+        }
+        for (std::size_t i = 0; i < cache_size; ++i) {
+            const uint32_t vertex = cache[i];
+            if ((vertex != v[0]) && (vertex != v[1]) && (vertex != v[2])) {
+                new_cache[new_cache_size++] = vertex;
+            }
+        }
+
+        // Update scores of vertices in cache and of vertices pushed out
+        for (std::size_t i = 0; i < new_cache_size; ++i) {
+            const uint32_t vertex   = new_cache[i];
+            const int      position = (i < c_max_cache_size) ? static_cast<int>(i) : -1;
+
+            const float score = scores.get(position, live_triangle_count[vertex]);
+            const float delta = score - vertex_score[vertex];
+            vertex_score[vertex] = score;
+
+            const uint32_t* row = &adjacency[adjacency_offsets[vertex]];
+            for (uint32_t j = 0, end = live_triangle_count[vertex]; j < end; ++j) {
+                triangle_score[row[j]] += delta;
+            }
+        }
+
+        cache_size = std::min(new_cache_size, static_cast<std::size_t>(c_max_cache_size));
+        std::copy(new_cache.begin(), new_cache.begin() + cache_size, cache.begin());
+
+        // Pick best live triangle touching the cache
+        best_triangle = c_no_triangle;
+        float best_score = -1.0f;
+        for (std::size_t i = 0; i < cache_size; ++i) {
+            const uint32_t  vertex = cache[i];
+            const uint32_t* row    = &adjacency[adjacency_offsets[vertex]];
+            for (uint32_t j = 0, end = live_triangle_count[vertex]; j < end; ++j) {
+                if (triangle_score[row[j]] > best_score) {
+                    best_score    = triangle_score[row[j]];
+                    best_triangle = row[j];
+                }
+            }
+        }
+    }
+
+    return triangle_order;
+}
+
+void optimize_overdraw(
+    const std::span<const uint32_t>  indices,
+    const std::span<const glm::vec3> vertex_positions,
+    std::vector<uint32_t>&           triangle_order,
+    const float                      threshold
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t triangle_count = triangle_order.size();
+    ERHE_VERIFY(indices.size() == 3 * triangle_count);
+    if (triangle_count == 0) {
+        return;
+    }
+
+    Fifo_cache cache{vertex_positions.size(), c_default_vertex_cache_size};
+    auto triangle_at = [&](const std::size_t i) -> const uint32_t* {
+        return &indices[3 * triangle_order[i]];
+    };
+
+    // Hard boundaries: cache misses all three vertices, vertex cache
+    // optimization started a new strip of triangles there
+    std::vector<std::size_t> hard_clusters;
+    for (std::size_t i = 0; i < triangle_count; ++i) {
+        if ((cache.access_triangle(triangle_at(i)) == 3) || (i == 0)) {
+            hard_clusters.push_back(i);
+        }
+    }
+    hard_clusters.push_back(triangle_count);
+
+    // Soft boundaries: split hard clusters where local ACMR reaches
+    // threshold times ACMR of the whole hard cluster
+    std::vector<std::size_t> clusters;
+    for (std::size_t c = 0, end = hard_clusters.size() - 1; c < end; ++c) {
+        const std::size_t start = hard_clusters[c];
+        const std::size_t stop  = hard_clusters[c + 1];
+
+        cache.flush();
+        std::size_t cluster_misses = 0;
+        for (std::size_t i = start; i < stop; ++i) {
+            cluster_misses += cache.access_triangle(triangle_at(i));
+        }
+        const float cluster_threshold = threshold * static_cast<float>(cluster_misses) / static_cast<float>(stop - start);
+
+        clusters.push_back(start);
+        cache.flush();
+        std::size_t running_misses    = 0;
+        std::size_t running_triangles = 0;
+        for (std::size_t i = start; i < stop; ++i) {
+            running_misses += cache.access_triangle(triangle_at(i));
+            ++running_triangles;
+            if (static_cast<float>(running_misses) / static_cast<float>(running_triangles) <= cluster_threshold) {
+                clusters.push_back(i + 1);
+                cache.flush();
+                running_misses    = 0;
+                running_triangles = 0;
+            }
+        }
+        if (clusters.back() == stop) {
+            clusters.pop_back();
+        }
+    }
+    const std::size_t cluster_count = clusters.size();
+    clusters.push_back(triangle_count);
+
+    // Sort key: how much cluster faces away from mesh center. Clusters
+    // on the outside facing out are likely to occlude the rest.
+    glm::vec3 mesh_centroid{0.0f};
+    for (const uint32_t vertex : indices) {
+        mesh_centroid += vertex_positions[vertex];
+    }
+    mesh_centroid /= static_cast<float>(indices.size());
+
+    std::vector<float> cluster_sort_key(cluster_count);
+    for (std::size_t c = 0; c < cluster_count; ++c) {
+        glm::vec3 centroid_sum{0.0f};
+        glm::vec3 normal_sum  {0.0f};
+        float     area_sum    {0.0f};
+        for (std::size_t i = clusters[c], end = clusters[c + 1]; i < end; ++i) {
+            const uint32_t* v  = triangle_at(i);
+            const glm::vec3 p0 = vertex_positions[v[0]];
+            const glm::vec3 p1 = vertex_positions[v[1]];
+            const glm::vec3 p2 = vertex_positions[v[2]];
+            const glm::vec3 n  = glm::cross(p1 - p0, p2 - p0);
+            const float     area = glm::length(n);
+            centroid_sum += (p0 + p1 + p2) * (area / 3.0f);
+            normal_sum   += n;
+            area_sum     += area;
+        }
+        const float     normal_length = glm::length(normal_sum);
+        const glm::vec3 centroid      = (area_sum > 0.0f) ? centroid_sum / area_sum : mesh_centroid;
+        const glm::vec3 normal        = (normal_length > 0.0f) ? normal_sum / normal_length : glm::vec3{0.0f};
+        cluster_sort_key[c] = glm::dot(centroid - mesh_centroid, normal);
+    }
+
+    std::vector<uint32_t> cluster_order(cluster_count);
+    std::iota(cluster_order.begin(), cluster_order.end(), 0);
+    std::stable_sort(
+        cluster_order.begin(),
+        cluster_order.end(),
+        [&cluster_sort_key](const uint32_t lhs, const uint32_t rhs) {
+            return cluster_sort_key[lhs] > cluster_sort_key[rhs];
+        }
+    );
+
+    std::vector<uint32_t> new_triangle_order;
+    new_triangle_order.reserve(triangle_count);
+    for (const uint32_t c : cluster_order) {
+        new_triangle_order.insert(
+            new_triangle_order.end(),
+            triangle_order.begin() + static_cast<std::ptrdiff_t>(clusters[c]),
+            triangle_order.begin() + static_cast<std::ptrdiff_t>(clusters[c + 1])
+        );
+    }
+    triangle_order = std::move(new_triangle_order);
+}
+
+auto optimize_vertex_fetch(const std::span<const uint32_t> indices, const std::size_t vertex_count) -> std::vector<uint32_t>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    constexpr uint32_t c_unassigned = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertex_count, c_unassigned);
+    uint32_t next_vertex = 0;
+    for (const uint32_t vertex : indices) {
+        ERHE_VERIFY(vertex < vertex_count);
+        if (remap[vertex] == c_unassigned) {
+            remap[vertex] = next_vertex++;
+        }
+    }
+    for (uint32_t& new_vertex : remap) {
+        if (new_vertex == c_unassigned) {
+            new_vertex = next_vertex++;
+        }
+    }
+    return remap;
+}
+
+void reorder_triangles(const std::span<uint32_t> indices, const std::span<const uint32_t> triangle_order)
+{
+    ERHE_VERIFY(indices.size() == 3 * triangle_order.size());
+    const std::vector<uint32_t> old_indices{indices.begin(), indices.end()};
+    for (std::size_t i = 0, end = triangle_order.size(); i < end; ++i) {
+        const uint32_t old_triangle = triangle_order[i];
+        indices[3 * i    ] = old_indices[3 * old_triangle    ];
+        indices[3 * i + 1] = old_indices[3 * old_triangle + 1];
+        indices[3 * i + 2] = old_indices[3 * old_triangle + 2];
+    }
+}
+
+void reorder_triangle_values(const std::span<uint32_t> values, const std::span<const uint32_t> triangle_order)
+{
+    ERHE_VERIFY(values.size() == triangle_order.size());
+    const std::vector<uint32_t> old_values{values.begin(), values.end()};
+    for (std::size_t i = 0, end = triangle_order.size(); i < end; ++i) {
+        values[i] = old_values[triangle_order[i]];
+    }
+}
+
+void remap_vertex_data(const std::span<uint8_t> vertex_data, const std::size_t vertex_stride, const std::span<const uint32_t> remap)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(vertex_data.size() == remap.size() * vertex_stride);
+    const std::vector<uint8_t> old_vertex_data{vertex_data.begin(), vertex_data.end()};
+    for (std::size_t old_vertex = 0, end = remap.size(); old_vertex < end; ++old_vertex) {
+        std::memcpy(
+            vertex_data.data() + static_cast<std::size_t>(remap[old_vertex]) * vertex_stride,
+            old_vertex_data.data() + old_vertex * vertex_stride,
+            vertex_stride
+        );
+    }
+}
+
+} // namespace erhe::primitive
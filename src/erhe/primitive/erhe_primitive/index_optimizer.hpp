@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace erhe::primitive {
+
+// Post-transform vertex cache efficiency of a triangle list, measured by
+// simulating a FIFO cache. Lets index reordering be evaluated without GPU.
+class Vertex_cache_statistics
+{
+public:
+    std::size_t triangle_count      {0};
+    std::size_t vertex_count        {0};    // Referenced vertices
+    std::size_t vertices_transformed{0};    // Cache misses
+    float       acmr                {0.0f}; // Average cache miss ratio, transformed vertices per triangle, 0.5 .. 3.0
+    float       atvr                {0.0f}; // Average transformed vertex ratio, transformed per referenced vertex, 1.0 is optimal
+};
+
+static constexpr unsigned int c_default_vertex_cache_size = 16;
+
+[[nodiscard]] auto analyze_vertex_cache(
+    std::span<const uint32_t> indices,
+    std::size_t               vertex_count,
+    unsigned int              cache_size = c_default_vertex_cache_size
+) -> Vertex_cache_statistics;
+
+// Triangle orders returned and updated by the functions below list old
+// triangle indices in new order: new triangle i is old triangle order[i].
+
+// Orders triangles for post-transform vertex cache locality. Uses vertex
+// and triangle scoring with a simulated LRU cache (Forsyth).
+[[nodiscard]] auto optimize_vertex_cache(std::span<const uint32_t> indices, std::size_t vertex_count) -> std::vector<uint32_t>;
+
+// Reorders triangle clusters of a cache optimized order so that clusters
+// facing outwards are drawn first, reducing overdraw (Sander et al.).
+// Clusters are split where the cache restarts, and further where cluster
+// ACMR stays within threshold times the ACMR of the enclosing cluster.
+// Larger threshold gives smaller clusters: less overdraw, worse ACMR.
+void optimize_overdraw(
+    std::span<const uint32_t>  indices,
+    std::span<const glm::vec3> vertex_positions,
+    std::vector<uint32_t>&     triangle_order,
+    float                      threshold
+);
+
+// Returns old to new vertex index remap so that vertices are in order of
+// first use by indices. Unreferenced vertices keep their relative order
+// after referenced vertices, so the vertex count does not change.
+[[nodiscard]] auto optimize_vertex_fetch(std::span<const uint32_t> indices, std::size_t vertex_count) -> std::vector<uint32_t>;
+
+// Applies triangle order to indices in place
+void reorder_triangles(std::span<uint32_t> indices, std::span<const uint32_t> triangle_order);
+
+// Applies triangle order to per triangle values in place
+void reorder_triangle_values(std::span<uint32_t> values, std::span<const uint32_t> triangle_order);
+
+// Permutes vertex data in place using old to new vertex index remap
+void remap_vertex_data(std::span<uint8_t> vertex_data, std::size_t vertex_stride, std::span<const uint32_t> remap);
+
+} // namespace erhe::primitive
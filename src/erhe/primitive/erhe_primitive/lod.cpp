@@ -0,0 +1,67 @@
+#include "erhe_primitive/lod.hpp"
+#include "erhe_primitive/buffer_mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace erhe::primitive {
+
+auto make_lod_selection(
+    const glm::mat4& clip_from_camera,
+    const glm::mat4& world_from_camera,
+    const float      viewport_height,
+    const float      max_pixel_error
+) -> Lod_selection
+{
+    // Perspective projection has -1 in w row for z, orthographic has 0
+    return Lod_selection{
+        .view_position    = glm::vec3{world_from_camera[3]},
+        .projection_scale = 0.5f * viewport_height * clip_from_camera[1][1],
+        .max_pixel_error  = max_pixel_error,
+        .orthographic     = (clip_from_camera[2][3] == 0.0f)
+    };
+}
+
+auto get_screen_space_error(const Lod_selection& selection, const float world_error, const float distance) -> float
+{
+    if (selection.orthographic) {
+        return world_error * selection.projection_scale;
+    }
+    // Inside bounding volume everything is considered to be right at near distance
+    constexpr float c_min_distance = 1.0e-4f;
+    return world_error * selection.projection_scale / std::max(distance, c_min_distance);
+}
+
+auto select_lod(
+    const Lod_selection& selection,
+    const Buffer_mesh&   buffer_mesh,
+    const glm::mat4&     world_from_node
+) -> std::size_t
+{
+    const std::size_t lod_count = buffer_mesh.get_lod_count();
+    if ((lod_count <= 1) || (selection.max_pixel_error <= 0.0f)) {
+        return 0;
+    }
+
+    const float scale = std::sqrt(
+        std::max(
+            std::max(
+                glm::dot(glm::vec3{world_from_node[0]}, glm::vec3{world_from_node[0]}),
+                glm::dot(glm::vec3{world_from_node[1]}, glm::vec3{world_from_node[1]})
+            ),
+            glm::dot(glm::vec3{world_from_node[2]}, glm::vec3{world_from_node[2]})
+        )
+    );
+    const glm::vec3 center   = glm::vec3{world_from_node * glm::vec4{buffer_mesh.bounding_sphere.center, 1.0f}};
+    const float     distance = glm::distance(center, selection.view_position) - scale * buffer_mesh.bounding_sphere.radius;
+
+    for (std::size_t lod = lod_count - 1; lod > 0; --lod) {
+        const float pixel_error = get_screen_space_error(selection, scale * buffer_mesh.get_lod_error(lod), distance);
+        if (pixel_error <= selection.max_pixel_error) {
+            return lod;
+        }
+    }
+    return 0;
+}
+
+} // namespace erhe::primitive
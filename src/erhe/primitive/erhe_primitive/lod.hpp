@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+namespace erhe::primitive {
+
+class Buffer_mesh;
+
+// Per view parameters for choosing level of detail by projected error
+class Lod_selection
+{
+public:
+    glm::vec3 view_position   {0.0f}; // World space
+    float     projection_scale{0.0f}; // Pixels per world unit, at unit distance unless orthographic
+    float     max_pixel_error {1.0f};
+    bool      orthographic    {false};
+};
+
+[[nodiscard]] auto make_lod_selection(
+    const glm::mat4& clip_from_camera,
+    const glm::mat4& world_from_camera,
+    float            viewport_height,
+    float            max_pixel_error
+) -> Lod_selection;
+
+// Projected size in pixels of world space error at view distance
+[[nodiscard]] auto get_screen_space_error(const Lod_selection& selection, float world_error, float distance) -> float;
+
+// Returns coarsest level of buffer mesh with projected error within
+// selection max pixel error. Distance is measured to bounding sphere,
+// error is scaled by largest axis scale of world_from_node.
+[[nodiscard]] auto select_lod(
+    const Lod_selection& selection,
+    const Buffer_mesh&   buffer_mesh,
+    const glm::mat4&     world_from_node
+) -> std::size_t;
+
+} // namespace erhe::primitive
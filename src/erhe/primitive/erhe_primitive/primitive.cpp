@@ -1,8 +1,10 @@
 #include "erhe_primitive/primitive.hpp"
+#include "erhe_primitive/attribute_packer.hpp"
 #include "erhe_primitive/buffer_sink.hpp"
 #include "erhe_primitive/primitive_builder.hpp"
 #include "erhe_primitive/build_info.hpp"
 #include "erhe_primitive/triangle_soup.hpp"
+#include "erhe_geometry/compressed_geometry.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_math/math_util.hpp"
 #include "erhe_raytrace/ibuffer.hpp"
@@ -98,6 +100,18 @@ auto Primitive_raytrace::get_raytrace_geometry() const -> const std::shared_ptr<
     return m_rt_geometry;
 }
 
+auto Primitive_raytrace::get_memory_usage() const -> std::size_t
+{
+    std::size_t result = 0;
+    if (m_rt_vertex_buffer) {
+        result += m_rt_vertex_buffer->capacity_byte_count();
+    }
+    if (m_rt_index_buffer) {
+        result += m_rt_index_buffer->capacity_byte_count();
+    }
+    return result;
+}
+
 auto Primitive_raytrace::has_raytrace_triangles() const -> bool
 {
     return
@@ -257,6 +271,11 @@ Primitive_shape::~Primitive_shape() noexcept
 
 auto Primitive_shape::make_geometry() -> bool
 {
+    if (m_compressed_geometry) {
+        m_geometry = std::make_shared<erhe::geometry::Geometry>(m_compressed_geometry->decompress());
+        m_compressed_geometry.reset();
+        return true;
+    }
     if (m_triangle_soup) {
         ERHE_VERIFY(m_element_mappings.primitive_id_to_polygon_id.empty());
         ERHE_VERIFY(m_element_mappings.corner_to_vertex_id.empty());
@@ -329,6 +348,33 @@ auto Primitive_shape::make_raytrace() -> bool
     // }
     return m_raytrace.has_raytrace_triangles();
 }
+
+void Primitive_shape::release_raytrace()
+{
+    m_raytrace = Primitive_raytrace{};
+}
+
+void Primitive_shape::compress_geometry()
+{
+    if (!m_geometry) {
+        return;
+    }
+    m_compressed_geometry = std::make_shared<const erhe::geometry::Compressed_geometry>(*m_geometry.get());
+    m_geometry.reset();
+    release_raytrace();
+}
+
+void Primitive_shape::share_geometry(const Primitive_shape& source)
+{
+    m_geometry            = source.m_geometry;
+    m_compressed_geometry = source.m_compressed_geometry;
+    release_raytrace();
+}
+
+auto Primitive_shape::get_compressed_geometry() const -> const std::shared_ptr<const erhe::geometry::Compressed_geometry>&
+{
+    return m_compressed_geometry;
+}
 #pragma endregion Primitive_shape
 
 #pragma region Primitive_render_shape
@@ -419,11 +465,29 @@ Buffer_mesh build_buffer_mesh_from_triangle_soup(const Triangle_soup& triangle_s
     memcpy(sink_index_data.data(), triangle_soup.index_data.data(), index_count * index_range.element_size);
     buffer_info.buffer_sink.enqueue_index_data(index_range.byte_offset, std::move(sink_index_data));
 
+    const uint8_t* src_vertex_data_base = triangle_soup.vertex_data.data();
+
+    // Bounding volume is needed before vertices for position quantization
+    const erhe::graphics::Vertex_attribute* position_attribute = triangle_soup.vertex_format.find_attribute_maybe(erhe::graphics::Vertex_attribute::Usage_type::position);
+    erhe::math::Point_vector_bounding_volume_source positions{vertex_count};
+    if (position_attribute != nullptr) {
+        for (std::size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+            const uint8_t* src = src_vertex_data_base + position_attribute->offset + vertex_index * source_vertex_stride;
+            float position[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            erhe::dataformat::convert(src, position_attribute->data_type, &position[0], erhe::dataformat::Format::format_32_vec4_float, 1.0f);
+            positions.add(position[0], position[1], position[2]);
+        }
+    }
+    erhe::math::calculate_bounding_volume(positions, buffer_mesh.bounding_box, buffer_mesh.bounding_sphere);
+    const erhe::graphics::Vertex_attribute* sink_position_attribute = buffer_info.vertex_format.find_attribute_maybe(erhe::graphics::Vertex_attribute::Usage_type::position);
+    if (sink_position_attribute != nullptr) {
+        buffer_mesh.set_position_quantization(sink_position_attribute->data_type);
+    }
+
     // Copy and convert vertices to buffer
     std::vector<uint8_t> sink_vertex_data(vertex_count * vertex_range.element_size);
     const std::vector<erhe::graphics::Vertex_attribute>& attributes = buffer_info.vertex_format.get_attributes();
     uint8_t* sink_vertex_data_base = sink_vertex_data.data();
-    const uint8_t* src_vertex_data_base = triangle_soup.vertex_data.data();
     for (std::size_t attribute_index = 0, end = attributes.size(); attribute_index < end; ++attribute_index) {
         const erhe::graphics::Vertex_attribute& sink_attribute = attributes[attribute_index];
         const erhe::graphics::Vertex_attribute* src_attribute = triangle_soup.vertex_format.find_attribute_maybe(
@@ -433,10 +497,44 @@ Buffer_mesh build_buffer_mesh_from_triangle_soup(const Triangle_soup& triangle_s
         uint8_t* sink_attribute_base = sink_vertex_data_base + sink_attribute.offset;
         if (src_attribute != nullptr) {
             const uint8_t* src_attribute_base = src_vertex_data_base + src_attribute->offset;
-            for (std::size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
-                uint8_t* sink = sink_attribute_base + vertex_index * sink_vertex_stride;
-                const uint8_t* src = src_attribute_base + vertex_index * source_vertex_stride;
-                erhe::dataformat::convert(src, src_attribute->data_type, sink, sink_attribute.data_type, 1.0f);
+
+            // Quantized positions and octahedral normals and tangents are
+            // encoded from float values, other attributes are converted
+            using Usage_type = erhe::graphics::Vertex_attribute::Usage_type;
+            const Usage_type usage_type = sink_attribute.usage.type;
+            const bool is_quantized_position =
+                (usage_type == Usage_type::position) &&
+                ((buffer_mesh.position_scale != glm::vec3{1.0f}) || (buffer_mesh.position_offset != glm::vec3{0.0f}));
+            const bool is_snorm_vec2         =
+                (sink_attribute.data_type == erhe::dataformat::Format::format_8_vec2_snorm) ||
+                (sink_attribute.data_type == erhe::dataformat::Format::format_16_vec2_snorm);
+            const bool is_snorm_vec3         =
+                (sink_attribute.data_type == erhe::dataformat::Format::format_8_vec3_snorm) ||
+                (sink_attribute.data_type == erhe::dataformat::Format::format_16_vec3_snorm);
+            const bool is_octahedral         =
+                ((usage_type == Usage_type::normal) && is_snorm_vec2) ||
+                (((usage_type == Usage_type::tangent) || (usage_type == Usage_type::bitangent)) && is_snorm_vec3);
+            if (is_quantized_position || is_octahedral) {
+                const Attribute_packer packer = Attribute_packer::make(sink_attribute.data_type);
+                for (std::size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+                    uint8_t* sink = sink_attribute_base + vertex_index * sink_vertex_stride;
+                    const uint8_t* src = src_attribute_base + vertex_index * source_vertex_stride;
+                    glm::vec4 value{0.0f, 0.0f, 0.0f, 0.0f};
+                    erhe::dataformat::convert(src, src_attribute->data_type, &value.x, erhe::dataformat::Format::format_32_vec4_float, 1.0f);
+                    if (is_quantized_position) {
+                        packer.pack_vec3(sink, buffer_mesh.quantize_position(glm::vec3{value}));
+                    } else if (is_snorm_vec2) {
+                        packer.pack_vec3(sink, glm::vec3{value});
+                    } else {
+                        packer.pack_vec4(sink, value);
+                    }
+                }
+            } else {
+                for (std::size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+                    uint8_t* sink = sink_attribute_base + vertex_index * sink_vertex_stride;
+                    const uint8_t* src = src_attribute_base + vertex_index * source_vertex_stride;
+                    erhe::dataformat::convert(src, src_attribute->data_type, sink, sink_attribute.data_type, 1.0f);
+                }
             }
         } else {
             const uint8_t* src = reinterpret_cast<const uint8_t*>(&sink_attribute.default_value[0]);
@@ -448,18 +546,6 @@ Buffer_mesh build_buffer_mesh_from_triangle_soup(const Triangle_soup& triangle_s
     }
 
     buffer_info.buffer_sink.enqueue_vertex_data(vertex_range.byte_offset, std::move(sink_vertex_data));
-
-    const erhe::graphics::Vertex_attribute* position_attribute = buffer_info.vertex_format.find_attribute_maybe(erhe::graphics::Vertex_attribute::Usage_type::position);
-    erhe::math::Point_vector_bounding_volume_source positions{vertex_count};
-    if (position_attribute != nullptr) {
-        for (std::size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
-            const uint8_t* src = src_vertex_data_base + position_attribute->offset + vertex_index * source_vertex_stride;
-            float position[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-            erhe::dataformat::convert(src, position_attribute->data_type, &position[0], erhe::dataformat::Format::format_32_vec4_float, 1.0f);
-            positions.add(position[0], position[1], position[2]);
-        }
-    }
-    erhe::math::calculate_bounding_volume(positions, buffer_mesh.bounding_box, buffer_mesh.bounding_sphere);
     return buffer_mesh;
 }
 
@@ -9,6 +9,7 @@
 #include <string_view>
 
 namespace erhe::geometry {
+    class Compressed_geometry;
     class Geometry;
 }
 namespace erhe::raytrace {
@@ -41,6 +42,9 @@ public:
     [[nodiscard]] auto get_raytrace_mesh    () const -> const Buffer_mesh&;
     [[nodiscard]] auto get_raytrace_geometry() const -> const std::shared_ptr<erhe::raytrace::IGeometry>&;
 
+    // Bytes in raytrace vertex and index buffers; acceleration structure is not included
+    [[nodiscard]] auto get_memory_usage() const -> std::size_t;
+
 private:
     Buffer_mesh                                m_rt_mesh;
     std::shared_ptr<erhe::raytrace::IBuffer>   m_rt_vertex_buffer{};
@@ -62,6 +66,17 @@ public:
 
     auto make_geometry() -> bool;
     auto make_raytrace() -> bool;
+    void release_raytrace(); // make_raytrace() can be used to restore
+
+    // Replaces geometry with a compressed copy and releases raytrace.
+    // make_geometry(), get_geometry() and make_raytrace() decompress.
+    // Geometry is not modified, and stays alive if shared elsewhere.
+    void compress_geometry();
+    // Uses geometry, or compressed geometry, of source shape, so that shapes
+    // made from the same geometry keep sharing it. Releases raytrace.
+    void share_geometry(const Primitive_shape& source);
+    [[nodiscard]] auto get_compressed_geometry() const -> const std::shared_ptr<const erhe::geometry::Compressed_geometry>&;
+
     [[nodiscard]] auto has_raytrace_triangles          () const -> bool;
     [[nodiscard]] auto get_geometry                    () -> const std::shared_ptr<erhe::geometry::Geometry>&;
     [[nodiscard]] auto get_geometry_const              () const -> const std::shared_ptr<erhe::geometry::Geometry>&;
@@ -75,10 +90,11 @@ public:
 protected:
     // Keep this before members - at least m_renderable_mesh - which initialization
     // in constructors uses m_element_mappings.
-    erhe::primitive::Element_mappings         m_element_mappings;
-    std::shared_ptr<erhe::geometry::Geometry> m_geometry       {};
-    std::shared_ptr<Triangle_soup>            m_triangle_soup  {};
-    Primitive_raytrace                        m_raytrace{};
+    erhe::primitive::Element_mappings                          m_element_mappings;
+    std::shared_ptr<erhe::geometry::Geometry>                  m_geometry           {};
+    std::shared_ptr<const erhe::geometry::Compressed_geometry> m_compressed_geometry{};
+    std::shared_ptr<Triangle_soup>                             m_triangle_soup      {};
+    Primitive_raytrace                                         m_raytrace           {};
 };
 
 /////////////////////////
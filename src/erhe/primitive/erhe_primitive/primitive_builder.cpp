@@ -4,9 +4,12 @@
 #include "erhe_primitive/primitive.hpp"
 #include "erhe_primitive/buffer_sink.hpp"
 #include "erhe_primitive/buffer_writer.hpp"
+#include "erhe_primitive/index_optimizer.hpp"
 #include "erhe_primitive/index_range.hpp"
 #include "erhe_primitive/primitive_log.hpp"
 #include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_primitive/simplify.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_geometry/property_map.hpp"
 #include "erhe_gl/enum_string_functions.hpp"
@@ -19,6 +22,9 @@
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <numeric>
+
 namespace erhe::primitive {
 
 using Corner_id         = erhe::geometry::Corner_id;
@@ -58,6 +64,7 @@ Build_context_root::Build_context_root(
     ERHE_PROFILE_FUNCTION();
 
     get_mesh_info         ();
+    make_lods             ();
     get_vertex_attributes ();
     allocate_vertex_buffer();
     allocate_index_buffer ();
@@ -110,6 +117,69 @@ void Build_context_root::get_mesh_info()
     SPDLOG_LOGGER_INFO(log_primitive_builder, "Total {} vertices", total_vertex_count);
 }
 
+void Build_context_root::make_lods()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    buffer_mesh->triangle_fill_lods.clear();
+    const Lod_settings& settings = build_info.lod;
+    if (!build_info.primitive_types.fill_triangles || (settings.level_count == 0)) {
+        return;
+    }
+    if (mesh_info.index_count_fill_triangles / 3 <= settings.min_triangle_count) {
+        return;
+    }
+    const auto* point_locations = geometry.point_attributes().find<vec3>(erhe::geometry::c_point_locations);
+    if (point_locations == nullptr) {
+        return;
+    }
+
+    // Same vertex numbering and fan triangulation as Build_context_range::build_polygon_fill()
+    std::vector<vec3>     vertex_positions;
+    std::vector<uint32_t> indices;
+    vertex_positions.reserve(mesh_info.vertex_count_corners);
+    indices.reserve(mesh_info.index_count_fill_triangles);
+    geometry.for_each_polygon_const([&](const auto& i) {
+        const uint32_t first_vertex = static_cast<uint32_t>(vertex_positions.size());
+        i.polygon.for_each_corner_const(geometry, [&](const auto& j) {
+            const Point_id point_id = j.corner.point_id;
+            vertex_positions.push_back(point_locations->has(point_id) ? point_locations->get(point_id) : vec3{0.0f});
+            const uint32_t vertex = static_cast<uint32_t>(vertex_positions.size() - 1);
+            if (vertex >= first_vertex + 2) {
+                indices.insert(indices.end(), {first_vertex, vertex - 1, vertex});
+            }
+        });
+    });
+
+    float error = 0.0f;
+    for (std::size_t level = 0; level < settings.level_count; ++level) {
+        const std::span<const uint32_t> source_indices = lod_indices.empty() ? std::span<const uint32_t>{indices} : std::span<const uint32_t>{lod_indices.back()};
+        const std::size_t source_triangle_count = source_indices.size() / 3;
+        if (source_triangle_count <= settings.min_triangle_count) {
+            break;
+        }
+        const std::size_t target_triangle_count = std::max(
+            settings.min_triangle_count,
+            static_cast<std::size_t>(static_cast<float>(source_triangle_count) * settings.reduction)
+        );
+        Simplify_result result = simplify(source_indices, vertex_positions, 3 * target_triangle_count, settings.max_error - error);
+
+        // Stop when simplification stalls, a level that barely differs is not worth its indices
+        const std::size_t triangle_count = result.indices.size() / 3;
+        if ((triangle_count == 0) || (10 * triangle_count > 9 * source_triangle_count)) {
+            break;
+        }
+        error += result.error;
+
+        Buffer_mesh_lod& lod = buffer_mesh->triangle_fill_lods.emplace_back();
+        lod.error = error;
+        total_index_count += result.indices.size();
+        allocate_index_range(gl::Primitive_type::triangles, result.indices.size(), lod.triangle_fill_indices);
+        SPDLOG_LOGGER_INFO(log_primitive_builder, "LOD {}: {} triangles, error {}", level + 1, triangle_count, error);
+        lod_indices.push_back(std::move(result.indices));
+    }
+}
+
 void Build_context_root::get_vertex_attributes()
 {
     ERHE_PROFILE_FUNCTION();
@@ -215,6 +285,7 @@ void Build_context_root::calculate_bounding_volume(erhe::geometry::Property_map<
     const Geometry_point_source point_source{geometry, point_locations};
 
     erhe::math::calculate_bounding_volume(point_source, buffer_mesh->bounding_box, buffer_mesh->bounding_sphere);
+    buffer_mesh->set_position_quantization(attributes.position.data_type);
 }
 
 Primitive_builder::Primitive_builder(
@@ -260,6 +331,23 @@ void Primitive_builder::build(Buffer_mesh* buffer_mesh)
     };
 
     const Primitive_types& primitive_types = m_build_info.primitive_types;
+
+    if (build_context.is_parallel()) {
+        // Centroid points do not depend on polygon fill, build them concurrently
+        erhe::concurrency::Task_group task_group{erhe::concurrency::Thread_pool::get_instance()};
+        if (primitive_types.centroid_points) {
+            task_group.run([&build_context]() { build_context.build_centroid_points(); });
+        }
+        if (primitive_types.fill_triangles) {
+            build_context.build_polygon_fill();
+        }
+        if (primitive_types.edge_lines) {
+            build_context.build_edge_lines();
+        }
+        task_group.wait();
+        return;
+    }
+
     if (primitive_types.fill_triangles) {
         build_context.build_polygon_fill();
     }
@@ -273,6 +361,14 @@ void Primitive_builder::build(Buffer_mesh* buffer_mesh)
     }
 }
 
+void Build_fallbacks::merge(const Build_fallbacks& other)
+{
+    smooth_normal = smooth_normal || other.smooth_normal;
+    tangent       = tangent       || other.tangent;
+    bitangent     = bitangent     || other.bitangent;
+    texcoord      = texcoord      || other.texcoord;
+}
+
 Build_context::Build_context(
     const erhe::geometry::Geometry& geometry,
     const Build_info&               build_info,
@@ -289,14 +385,101 @@ Build_context::Build_context(
     ERHE_VERIFY(property_maps.point_locations != nullptr);
 
     root.calculate_bounding_volume(property_maps.point_locations);
+
+    const std::size_t threshold = build_info.parallel_threshold;
+    parallel = (threshold > 0) && (geometry.get_polygon_count() >= threshold);
+    make_ranges();
+
+    if (build_info.primitive_types.fill_triangles && build_info.index_optimization.is_enabled()) {
+        fill_triangle_indices.resize(3 * static_cast<std::size_t>(fill_triangle_count));
+    }
 }
 
 Build_context::~Build_context() noexcept
 {
-    ERHE_VERIFY(vertex_index == root.total_vertex_count);
+    ERHE_VERIFY(fill_vertices_written + centroid_vertices_written == root.total_vertex_count);
+}
+
+auto Build_context::is_parallel() const -> bool
+{
+    return parallel;
+}
+
+auto Build_context::get_property_maps() const -> const Property_maps&
+{
+    return property_maps;
+}
+
+auto Build_context::get_fallbacks() const -> const Build_fallbacks&
+{
+    return fallbacks;
+}
+
+void Build_context::make_ranges()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Serial build uses a single range
+    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
+    Build_range_start start{};
+    for (Polygon_id polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id) {
+        if (parallel && (polygon_id % c_polygons_per_range == 0)) {
+            start.polygon_id = polygon_id;
+            ranges.push_back(start);
+        }
+        const uint32_t corner_count = root.geometry.polygons[polygon_id].corner_count;
+        start.vertex_index    += corner_count;
+        start.primitive_index += (corner_count > 2) ? corner_count - 2 : 0;
+    }
+    if (!parallel) {
+        ranges.push_back(Build_range_start{});
+    }
+    fill_vertex_count   = start.vertex_index;
+    fill_triangle_count = start.primitive_index;
+}
+
+void Build_context::log_fallbacks() const
+{
+    if (fallbacks.smooth_normal) {
+        log_primitive_builder->warn("Warning: Used fallback smooth normal");
+    }
+    if (fallbacks.tangent) {
+        log_primitive_builder->warn("Warning: Used fallback tangent");
+    }
+    if (fallbacks.bitangent) {
+        log_primitive_builder->warn("Warning: Used fallback bitangent");
+    }
+    if (fallbacks.texcoord) {
+        log_primitive_builder->warn("Warning: Used fallback texcoord");
+    }
+}
+
+Build_context_range::Build_context_range(Build_context& context, const Build_range_start& start, const bool update_property_maps)
+    : root                {context.root}
+    , vertex_writer       {context.vertex_writer}
+    , index_writer        {context.index_writer}
+    , property_maps       {context.property_maps}
+    , update_property_maps{update_property_maps}
+    , triangle_indices    {context.fill_triangle_indices.empty() ? nullptr : context.fill_triangle_indices.data()}
+    , polygon_id          {start.polygon_id}
+    , vertex_index        {start.vertex_index}
+    , polygon_index       {static_cast<uint32_t>(start.polygon_id)}
+    , primitive_index     {start.primitive_index}
+    , vertex_byte_offset  {start.vertex_index * root.vertex_stride}
+{
 }
 
-void Build_context::build_polygon_id()
+auto Build_context_range::get_vertex_index() const -> uint32_t
+{
+    return vertex_index;
+}
+
+auto Build_context_range::get_fallbacks() const -> const Build_fallbacks&
+{
+    return fallbacks;
+}
+
+void Build_context_range::build_polygon_id()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -305,17 +488,17 @@ void Build_context::build_polygon_id()
     ////     erhe::graphics::g_instance->info.use_integer_polygon_ids &&
     ////     root.attributes.attribute_id_uint.is_valid()
     //// ) {
-    ////     vertex_writer.write(root.attributes.attribute_id_uint, polygon_index);
+    ////     write(root.attributes.attribute_id_uint, polygon_index);
     //// }
 
     //// if (root.attributes.id_vec3.is_valid()) 
     {
         const vec3 v = erhe::math::vec3_from_uint(polygon_index);
-        vertex_writer.write(root.attributes.id_vec3, v);
+        write(root.attributes.id_vec3, v);
     }
 }
 
-auto Build_context::get_polygon_normal() -> vec3
+auto Build_context_range::get_polygon_normal() -> vec3
 {
     ERHE_PROFILE_FUNCTION();
     vec3 polygon_normal{0.0f, 1.0f, 0.0f};
@@ -326,7 +509,7 @@ auto Build_context::get_polygon_normal() -> vec3
     return polygon_normal;
 }
 
-void Build_context::build_vertex_position()
+void Build_context_range::build_vertex_position()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -336,7 +519,7 @@ void Build_context::build_vertex_position()
 
     //// ERHE_VERIFY(property_maps.point_locations != nullptr);
     const vec3 position = property_maps.point_locations->get(point_id);
-    vertex_writer.write(root.attributes.position, position);
+    write(root.attributes.position, root.buffer_mesh->quantize_position(position));
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -345,7 +528,7 @@ void Build_context::build_vertex_position()
     );
 }
 
-void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
+void Build_context_range::build_vertex_normal(bool do_normal, bool do_normal_smooth)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -381,7 +564,7 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
 
             case Normal_style::corner_normals: {
                 //// ERHE_VERIFY(glm::length(normal) > 0.9f);
-                vertex_writer.write(root.attributes.normal, normal);
+                write(root.attributes.normal, normal);
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} normal {}", point_id, corner_id, normal);
                 break;
             }
@@ -397,7 +580,7 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
                     found_point_normal = property_maps.point_normals_smooth->maybe_get(point_id, point_normal) && (glm::length(point_normal) > 0.9f);
                 }
 
-                vertex_writer.write(root.attributes.normal, point_normal);
+                write(root.attributes.normal, point_normal);
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} point normal {}", point_id, corner_id, point_normal);
                 break;
             }
@@ -405,7 +588,7 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
             case Normal_style::polygon_normals: {
                 const vec3 polygon_normal = get_polygon_normal();
                 //// ERHE_VERIFY(glm::length(polygon_normal) > 0.9f);
-                vertex_writer.write(root.attributes.normal, polygon_normal);
+                write(root.attributes.normal, polygon_normal);
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} polygon normal {}", point_id, corner_id, polygon_normal);
                 break;
             }
@@ -417,7 +600,7 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
     }
 
     // if (features.normal_flat && root.attributes.normal_flat.is_valid()) {
-    //     vertex_writer.write(root.attributes.normal_flat, polygon_normal);
+    //     write(root.attributes.normal_flat, polygon_normal);
     //     SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} flat polygon normal {}", point_id, corner_id, polygon_normal);
     // }
     // 
@@ -433,15 +616,15 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
             // If edge lines are not used, do not generate warning about missing smooth normals.
             if (root.build_info.primitive_types.edge_lines) {
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} smooth unit y normal", point_id, corner_id);
-                used_fallback_smooth_normal = true;
+                fallbacks.smooth_normal = true;
             }
         }
     
-        vertex_writer.write(root.attributes.normal_smooth, smooth_point_normal);
+        write(root.attributes.normal_smooth, smooth_point_normal);
     }
 }
 
-void Build_context::build_vertex_tangent()
+void Build_context_range::build_vertex_tangent()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -470,13 +653,13 @@ void Build_context::build_vertex_tangent()
     }
     if (!found) {
         SPDLOG_LOGGER_TRACE(log_primitive_builder, "point_id {} corner {} unit x tangent", point_id, corner_id);
-        used_fallback_tangent = true;
+        fallbacks.tangent = true;
     }
 
-    vertex_writer.write(root.attributes.tangent, tangent);
+    write(root.attributes.tangent, tangent);
 }
 
-void Build_context::build_vertex_bitangent()
+void Build_context_range::build_vertex_bitangent()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -504,13 +687,13 @@ void Build_context::build_vertex_bitangent()
     }
     if (!found) {
         SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} unit z bitangent", point_id, corner_id);
-        used_fallback_bitangent = true;
+        fallbacks.bitangent = true;
     }
 
-    vertex_writer.write(root.attributes.bitangent, bitangent);
+    write(root.attributes.bitangent, bitangent);
 }
 
-void Build_context::build_vertex_texcoord()
+void Build_context_range::build_vertex_texcoord()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -538,13 +721,13 @@ void Build_context::build_vertex_texcoord()
     }
     if (!found) {
         SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} default texcoord", point_id, corner_id);
-        used_fallback_texcoord = true;
+        fallbacks.texcoord = true;
     }
 
-    vertex_writer.write(root.attributes.texcoord, texcoord);
+    write(root.attributes.texcoord, texcoord);
 }
 
-void Build_context::build_vertex_joint_indices()
+void Build_context_range::build_vertex_joint_indices()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -555,7 +738,7 @@ void Build_context::build_vertex_joint_indices()
     const uvec4 joint_indices = (property_maps.point_joint_indices != nullptr)
         ? property_maps.point_joint_indices->get(point_id)
         : uvec4{0u, 0u, 0u, 0u};
-    vertex_writer.write(root.attributes.joint_indices, joint_indices);
+    write(root.attributes.joint_indices, joint_indices);
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -564,7 +747,7 @@ void Build_context::build_vertex_joint_indices()
     );
 }
 
-void Build_context::build_vertex_joint_weights()
+void Build_context_range::build_vertex_joint_weights()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -575,7 +758,7 @@ void Build_context::build_vertex_joint_weights()
     const vec4 joint_weights = (property_maps.point_joint_weights != nullptr)
         ? property_maps.point_joint_weights->get(point_id)
         : vec4{1.0f, 0.0f, 0.0f, 0.0f};
-    vertex_writer.write(root.attributes.joint_weights, joint_weights);
+    write(root.attributes.joint_weights, joint_weights);
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -604,7 +787,7 @@ void Build_context::build_vertex_joint_weights()
 //
 // }
 
-void Build_context::build_vertex_color(const uint32_t /*polygon_corner_count*/)
+void Build_context_range::build_vertex_color(const uint32_t /*polygon_corner_count*/)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -649,10 +832,10 @@ void Build_context::build_vertex_color(const uint32_t /*polygon_corner_count*/)
     //    //}
     //}
 
-    vertex_writer.write(root.attributes.color, color);
+    write(root.attributes.color, color);
 }
 
-void Build_context::build_vertex_aniso_control()
+void Build_context_range::build_vertex_aniso_control()
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -695,10 +878,10 @@ void Build_context::build_vertex_aniso_control()
 #endif
     }
 
-    vertex_writer.write(root.attributes.aniso_control, value);
+    write(root.attributes.aniso_control, value);
 }
 
-void Build_context::build_centroid_position()
+void Build_context_range::build_centroid_position()
 {
     if (!root.build_info.primitive_types.centroid_points || !root.attributes.position.is_valid()) {
         return;
@@ -709,10 +892,10 @@ void Build_context::build_centroid_position()
         position = property_maps.polygon_centroids->get(polygon_id);
     }
 
-    vertex_writer.write(root.attributes.position, position);
+    write(root.attributes.position, root.buffer_mesh->quantize_position(position));
 }
 
-void Build_context::build_centroid_normal()
+void Build_context_range::build_centroid_normal()
 {
     //const auto& features = root.build_info.format.features;
 
@@ -726,37 +909,44 @@ void Build_context::build_centroid_normal()
     }
 
     if (root.attributes.normal.is_valid()) {
-        vertex_writer.write(root.attributes.normal, normal);
+        write(root.attributes.normal, normal);
     }
 
     // if (root.attributes.normal_flat.is_valid()) {
-    //     vertex_writer.write(root.attributes.normal_flat, normal);
+    //     write(root.attributes.normal_flat, normal);
     // }
 }
 
-void Build_context::build_valency_edge_count()
+void Build_context_range::build_valency_edge_count()
 {
     //if (root.attributes.valency_edge_count.is_valid()) 
     //{
     const unsigned int vertex_valency      = static_cast<unsigned int>(root.geometry.points.at(point_id).corner_count);
     const unsigned int polygone_edge_count = static_cast<unsigned int>(root.geometry.polygons.at(polygon_id).corner_count);
     const glm::uvec2 valency_edge_count{vertex_valency, polygone_edge_count};
-    vertex_writer.write(root.attributes.valency_edge_count, valency_edge_count);
+    write(root.attributes.valency_edge_count, valency_edge_count);
     //}
 }
 
-void Build_context::build_corner_point_index()
+void Build_context_range::build_corner_point_index()
 {
     //if (root.build_info.primitive_types.corner_points) {
-    index_writer.write_corner(vertex_index);
+    index_writer.write_corner(vertex_index, vertex_index);
     //}
 }
 
-void Build_context::build_triangle_fill_index()
+void Build_context_range::build_triangle_fill_index()
 {
     if (root.build_info.primitive_types.fill_triangles) {
         if (previous_index != first_index) {
-            index_writer.write_triangle(first_index, previous_index, vertex_index);
+            if (triangle_indices != nullptr) {
+                uint32_t* const triangle = triangle_indices + 3 * static_cast<std::size_t>(primitive_index);
+                triangle[0] = first_index;
+                triangle[1] = previous_index;
+                triangle[2] = vertex_index;
+            } else {
+                index_writer.write_triangle(primitive_index, first_index, previous_index, vertex_index);
+            }
             root.element_mappings.primitive_id_to_polygon_id[primitive_index] = polygon_id;
             ++primitive_index;
         }
@@ -765,26 +955,10 @@ void Build_context::build_triangle_fill_index()
     previous_index = vertex_index;
 }
 
-void Build_context::build_polygon_fill()
+void Build_context_range::build_polygon_fill(const Polygon_id polygon_id_end)
 {
     ERHE_PROFILE_FUNCTION();
 
-    // TODO property_maps.corner_indices needs to be setup
-    //      also if edge lines are wanted.
-
-    property_maps.corner_indices->clear();
-
-    vertex_index  = 0;
-    polygon_index = 0;
-
-    //const bool any_normal_feature = root.build_info.format.features.normal =
-    //    root.build_info.format.features.normal      ||
-    //    root.build_info.format.features.normal_flat ||
-    //    root.build_info.format.features.normal_smooth;
-
-    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
-    root.element_mappings.corner_to_vertex_id.resize(root.geometry.get_corner_count());
-
     const bool do_polygon_id           = root.attributes.id_vec3           .is_valid();
     const bool do_vertex_position      = root.attributes.position          .is_valid();
     const bool do_vertex_normal        = root.attributes.normal            .is_valid();
@@ -800,17 +974,17 @@ void Build_context::build_polygon_fill()
     const bool do_vertex_valency       = root.attributes.valency_edge_count.is_valid();
     const bool do_corner_points        = root.build_info.primitive_types.corner_points;
 
-    for (polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id) {
+    for (; polygon_id < polygon_id_end; ++polygon_id) {
         ERHE_PROFILE_SCOPE("polygon");
         const Polygon& polygon = root.geometry.polygons[polygon_id];
         first_index    = vertex_index;
         previous_index = first_index;
 
-        if (property_maps.polygon_ids_uint32 != nullptr) {
+        if (update_property_maps && (property_maps.polygon_ids_uint32 != nullptr)) {
             property_maps.polygon_ids_uint32->put(polygon_id, polygon_index);
         }
 
-        if (property_maps.polygon_ids_vector3 != nullptr) {
+        if (update_property_maps && (property_maps.polygon_ids_vector3 != nullptr)) {
             property_maps.polygon_ids_vector3->put(polygon_id, erhe::math::vec3_from_uint(polygon_index));
         }
 
@@ -836,30 +1010,234 @@ void Build_context::build_polygon_fill()
             if (do_vertex_valency      ) build_valency_edge_count  ();
 
             // Indices
-            property_maps.corner_indices->put(corner_id, vertex_index);
+            if (update_property_maps) {
+                property_maps.corner_indices->put(corner_id, vertex_index);
+            }
 
             if (do_corner_points) build_corner_point_index();
             build_triangle_fill_index();
 
-            vertex_writer.move(root.vertex_stride);
+            vertex_byte_offset += root.vertex_stride;
             ++vertex_index;
         }
 
         ++polygon_index;
     }
+}
 
-    if (used_fallback_smooth_normal) {
-        log_primitive_builder->warn("Warning: Used fallback smooth normal");
+void Build_context_range::build_centroid_points(const Polygon_id polygon_id_end)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    for (; polygon_id < polygon_id_end; ++polygon_id) {
+        build_centroid_position();
+        build_centroid_normal();
+
+        index_writer.write_centroid(polygon_id, vertex_index);
+        vertex_byte_offset += root.vertex_stride;
+        ++vertex_index;
     }
-    if (used_fallback_tangent) {
-        log_primitive_builder->warn("Warning: Used fallback tangent");
+}
+
+void Build_context::update_property_maps()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Property_map::put() is not thread safe. After a parallel build, apply
+    // property map updates here, in the same order as the serial build does.
+    const auto& corner_to_vertex_id = root.element_mappings.corner_to_vertex_id;
+    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
+    for (Polygon_id polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id) {
+        const Polygon& polygon = root.geometry.polygons[polygon_id];
+        if (property_maps.polygon_ids_uint32 != nullptr) {
+            property_maps.polygon_ids_uint32->put(polygon_id, polygon_id);
+        }
+        if (property_maps.polygon_ids_vector3 != nullptr) {
+            property_maps.polygon_ids_vector3->put(polygon_id, erhe::math::vec3_from_uint(polygon_id));
+        }
+        const Polygon_corner_id polyon_corner_id_end = polygon.first_polygon_corner_id + polygon.corner_count;
+        for (Polygon_corner_id polygon_corner_id = polygon.first_polygon_corner_id; polygon_corner_id < polyon_corner_id_end; ++polygon_corner_id) {
+            const Corner_id corner_id = root.geometry.polygon_corners[polygon_corner_id];
+            property_maps.corner_indices->put(corner_id, corner_to_vertex_id[corner_id]);
+        }
     }
-    if (used_fallback_bitangent) {
-        log_primitive_builder->warn("Warning: Used fallback bitangent");
+}
+
+void Build_context::build_polygon_fill()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // TODO property_maps.corner_indices needs to be setup
+    //      also if edge lines are wanted.
+
+    property_maps.corner_indices->clear();
+
+    //const bool any_normal_feature = root.build_info.format.features.normal =
+    //    root.build_info.format.features.normal      ||
+    //    root.build_info.format.features.normal_flat ||
+    //    root.build_info.format.features.normal_smooth;
+
+    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
+    root.element_mappings.corner_to_vertex_id.resize(root.geometry.get_corner_count());
+
+    if (!parallel) {
+        Build_context_range range{*this, ranges.front(), true};
+        range.build_polygon_fill(polygon_id_end);
+        fallbacks.merge(range.get_fallbacks());
+    } else {
+        // Each range writes to its own, disjoint part of the vertex and index buffers
+        std::vector<Build_fallbacks> range_fallbacks(ranges.size());
+        erhe::concurrency::Thread_pool::get_instance().parallel_for(
+            0,
+            ranges.size(),
+            [this, &range_fallbacks, polygon_id_end](const std::size_t begin, const std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const Polygon_id range_end = (i + 1 < ranges.size()) ? ranges[i + 1].polygon_id : polygon_id_end;
+                    Build_context_range range{*this, ranges[i], false};
+                    range.build_polygon_fill(range_end);
+                    range_fallbacks[i] = range.get_fallbacks();
+                }
+            },
+            1
+        );
+        for (const Build_fallbacks& range_fallback : range_fallbacks) {
+            fallbacks.merge(range_fallback);
+        }
     }
-    if (used_fallback_texcoord) {
-        log_primitive_builder->warn("Warning: Used fallback texcoord");
+
+    const bool vertices_reordered = !fill_triangle_indices.empty() && optimize_fill_indices();
+    if (parallel || vertices_reordered) {
+        update_property_maps();
     }
+    write_lod_indices();
+    fill_vertices_written = fill_vertex_count;
+
+    log_fallbacks();
+}
+
+auto Build_context::optimize_fill_indices() -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const Index_optimization& optimization   = root.build_info.index_optimization;
+    const std::span<uint32_t> indices        = fill_triangle_indices;
+    const std::size_t         triangle_count = fill_triangle_count;
+    const std::size_t         vertex_count   = fill_vertex_count;
+
+    if (optimization.log_statistics) {
+        const Vertex_cache_statistics statistics = analyze_vertex_cache(indices, vertex_count);
+        log_primitive_builder->info(
+            "{} before index optimization: {} triangles, ACMR = {:.3f}, ATVR = {:.3f}",
+            root.geometry.name, statistics.triangle_count, statistics.acmr, statistics.atvr
+        );
+    }
+
+    // Triangle order, picking maps primitive id to polygon id so it moves with triangles
+    if (optimization.vertex_cache || optimization.overdraw) {
+        std::vector<uint32_t> triangle_order = optimization.vertex_cache
+            ? optimize_vertex_cache(indices, vertex_count)
+            : std::vector<uint32_t>(triangle_count);
+        if (!optimization.vertex_cache) {
+            std::iota(triangle_order.begin(), triangle_order.end(), 0);
+        }
+        if (optimization.overdraw) {
+            std::vector<vec3> vertex_positions(vertex_count);
+            const auto& corner_to_vertex_id = root.element_mappings.corner_to_vertex_id;
+            root.geometry.for_each_corner_const([&](const auto& i) {
+                vertex_positions[corner_to_vertex_id[i.corner_id]] = property_maps.point_locations->get(i.corner.point_id);
+            });
+            optimize_overdraw(indices, vertex_positions, triangle_order, optimization.overdraw_threshold);
+        }
+        reorder_triangles(indices, triangle_order);
+        reorder_triangle_values(
+            std::span<uint32_t>{root.element_mappings.primitive_id_to_polygon_id}.first(triangle_count),
+            triangle_order
+        );
+    }
+
+    // Vertex order; vertices for polygons without triangles stay after the rest
+    bool vertices_reordered = false;
+    if (optimization.vertex_fetch) {
+        fill_vertex_remap = optimize_vertex_fetch(indices, vertex_count);
+        const std::vector<uint32_t>& remap = fill_vertex_remap;
+        for (uint32_t& index : indices) {
+            index = remap[index];
+        }
+        for (uint32_t& vertex_id : root.element_mappings.corner_to_vertex_id) {
+            vertex_id = remap[vertex_id];
+        }
+        // Centroid vertices follow fill vertices and may be concurrently written
+        remap_vertex_data(
+            std::span<uint8_t>{vertex_writer.vertex_data}.first(vertex_count * root.vertex_stride),
+            root.vertex_stride,
+            remap
+        );
+        vertices_reordered = true;
+    }
+
+    for (std::size_t triangle = 0; triangle < triangle_count; ++triangle) {
+        const uint32_t* v = &indices[3 * triangle];
+        index_writer.write_triangle(triangle, v[0], v[1], v[2]);
+    }
+
+    if (optimization.log_statistics) {
+        const Vertex_cache_statistics statistics = analyze_vertex_cache(indices, vertex_count);
+        log_primitive_builder->info(
+            "{} after index optimization: {} triangles, ACMR = {:.3f}, ATVR = {:.3f}",
+            root.geometry.name, statistics.triangle_count, statistics.acmr, statistics.atvr
+        );
+    }
+
+    return vertices_reordered;
+}
+
+void Build_context::write_lod_indices()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::vector<Buffer_mesh_lod>& lods = root.buffer_mesh->triangle_fill_lods;
+    ERHE_VERIFY(lods.size() == root.lod_indices.size());
+    for (std::size_t i = 0, end = lods.size(); i < end; ++i) {
+        std::vector<uint32_t>& indices = root.lod_indices[i];
+        if (!fill_vertex_remap.empty()) {
+            for (uint32_t& index : indices) {
+                index = fill_vertex_remap[index];
+            }
+        }
+        if (root.build_info.index_optimization.vertex_cache) {
+            const std::vector<uint32_t> triangle_order = optimize_vertex_cache(indices, fill_vertex_count);
+            reorder_triangles(indices, triangle_order);
+        }
+        index_writer.write_indices(lods[i].triangle_fill_indices, indices);
+    }
+    root.lod_indices.clear();
+}
+
+auto Build_context::get_edge_vertices(const Edge_id edge_id, uint32_t& v0, uint32_t& v1) const -> bool
+{
+    const Edge&           edge              = root.geometry.edges[edge_id];
+    const Point&          point_a           = root.geometry.points[edge.a];
+    const Point&          point_b           = root.geometry.points[edge.b];
+    const Point_corner_id point_corner_id_a = point_a.first_point_corner_id;
+    const Point_corner_id point_corner_id_b = point_b.first_point_corner_id;
+    const Corner_id       corner_id_a       = root.geometry.point_corners[point_corner_id_a];
+    const Corner_id       corner_id_b       = root.geometry.point_corners[point_corner_id_b];
+
+    ERHE_VERIFY(edge.a != edge.b);
+
+    if (!property_maps.corner_indices->has(corner_id_a) || !property_maps.corner_indices->has(corner_id_b)) {
+        return false;
+    }
+    v0 = property_maps.corner_indices->get(corner_id_a);
+    v1 = property_maps.corner_indices->get(corner_id_b);
+    //SPDLOG_LOGGER_TRACE(
+    //    log_primitive_builder,
+    //    "edge {} point {} corner {} vertex {} - point {} corner {} vertex {}",
+    //    edge_id,
+    //    edge.a, corner_id_a, v0,
+    //    edge.b, corner_id_b, v1
+    //);
+    return true;
 }
 
 void Build_context::build_edge_lines()
@@ -870,30 +1248,65 @@ void Build_context::build_edge_lines()
         return;
     }
 
-    for (Edge_id edge_id = 0, end = root.geometry.get_edge_count(); edge_id < end; ++edge_id) {
-        const Edge&           edge              = root.geometry.edges[edge_id];
-        const Point&          point_a           = root.geometry.points[edge.a];
-        const Point&          point_b           = root.geometry.points[edge.b];
-        const Point_corner_id point_corner_id_a = point_a.first_point_corner_id;
-        const Point_corner_id point_corner_id_b = point_b.first_point_corner_id;
-        const Corner_id       corner_id_a       = root.geometry.point_corners[point_corner_id_a];
-        const Corner_id       corner_id_b       = root.geometry.point_corners[point_corner_id_b];
+    const Edge_id edge_id_end = root.geometry.get_edge_count();
 
-        ERHE_VERIFY(edge.a != edge.b);
-
-        if (property_maps.corner_indices->has(corner_id_a) && property_maps.corner_indices->has(corner_id_b)) {
-            const auto v0 = property_maps.corner_indices->get(corner_id_a);
-            const auto v1 = property_maps.corner_indices->get(corner_id_b);
-            //SPDLOG_LOGGER_TRACE(
-            //    log_primitive_builder,
-            //    "edge {} point {} corner {} vertex {} - point {} corner {} vertex {}",
-            //    edge_id,
-            //    edge.a, corner_id_a, v0,
-            //    edge.b, corner_id_b, v1
-            //);
-            index_writer.write_edge(v0, v1);
+    if (!parallel) {
+        uint32_t    v0{0};
+        uint32_t    v1{0};
+        std::size_t position = 0;
+        for (Edge_id edge_id = 0; edge_id < edge_id_end; ++edge_id) {
+            if (get_edge_vertices(edge_id, v0, v1)) {
+                index_writer.write_edge(position++, v0, v1);
+            }
         }
+        return;
+    }
+
+    // Edges without vertices are skipped, so first count written edges per
+    // range to find where each range starts in the index buffer.
+    const std::size_t range_count = (edge_id_end + c_edges_per_range - 1) / c_edges_per_range;
+    std::vector<std::size_t> range_positions(range_count + 1, 0);
+    erhe::concurrency::Thread_pool& thread_pool = erhe::concurrency::Thread_pool::get_instance();
+    thread_pool.parallel_for(
+        0,
+        range_count,
+        [this, &range_positions, edge_id_end](const std::size_t begin, const std::size_t end) {
+            uint32_t a{0};
+            uint32_t b{0};
+            for (std::size_t i = begin; i < end; ++i) {
+                const Edge_id range_edge_id_end = static_cast<Edge_id>(std::min<std::size_t>((i + 1) * c_edges_per_range, edge_id_end));
+                std::size_t count = 0;
+                for (Edge_id edge_id = static_cast<Edge_id>(i * c_edges_per_range); edge_id < range_edge_id_end; ++edge_id) {
+                    if (get_edge_vertices(edge_id, a, b)) {
+                        ++count;
+                    }
+                }
+                range_positions[i + 1] = count;
+            }
+        },
+        1
+    );
+    for (std::size_t i = 0; i < range_count; ++i) {
+        range_positions[i + 1] += range_positions[i];
     }
+    thread_pool.parallel_for(
+        0,
+        range_count,
+        [this, &range_positions, edge_id_end](const std::size_t begin, const std::size_t end) {
+            uint32_t a{0};
+            uint32_t b{0};
+            for (std::size_t i = begin; i < end; ++i) {
+                const Edge_id range_edge_id_end = static_cast<Edge_id>(std::min<std::size_t>((i + 1) * c_edges_per_range, edge_id_end));
+                std::size_t position = range_positions[i];
+                for (Edge_id edge_id = static_cast<Edge_id>(i * c_edges_per_range); edge_id < range_edge_id_end; ++edge_id) {
+                    if (get_edge_vertices(edge_id, a, b)) {
+                        index_writer.write_edge(position++, a, b);
+                    }
+                }
+            }
+        },
+        1
+    );
 }
 
 void Build_context::build_centroid_points()
@@ -904,15 +1317,29 @@ void Build_context::build_centroid_points()
         return;
     }
 
-    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
-    for (polygon_id = 0; polygon_id < polygon_id_end; ++polygon_id) {
-        build_centroid_position();
-        build_centroid_normal();
+    // Centroid vertices follow polygon fill vertices
+    const uint32_t first_vertex_index = root.build_info.primitive_types.fill_triangles ? fill_vertex_count : 0;
 
-        index_writer.write_centroid(vertex_index);
-        vertex_writer.move(root.vertex_stride);
-        ++vertex_index;
+    const Polygon_id polygon_id_end = root.geometry.get_polygon_count();
+    if (!parallel) {
+        Build_context_range range{*this, Build_range_start{.polygon_id = 0, .vertex_index = first_vertex_index}, false};
+        range.build_centroid_points(polygon_id_end);
+    } else {
+        erhe::concurrency::Thread_pool::get_instance().parallel_for(
+            0,
+            polygon_id_end,
+            [this, first_vertex_index](const std::size_t begin, const std::size_t end) {
+                const Build_range_start start{
+                    .polygon_id   = static_cast<Polygon_id>(begin),
+                    .vertex_index = first_vertex_index + static_cast<uint32_t>(begin)
+                };
+                Build_context_range range{*this, start, false};
+                range.build_centroid_points(static_cast<Polygon_id>(end));
+            },
+            c_polygons_per_range
+        );
     }
+    centroid_vertices_written = polygon_id_end;
 }
 
 void Build_context_root::allocate_index_range(const gl::Primitive_type primitive_type, const std::size_t index_count, Index_range& out_range)
@@ -14,6 +14,7 @@
 #include <glm/glm.hpp>
 
 #include <cstddef>
+#include <vector>
 
 namespace erhe::graphics {
     class Buffer;
@@ -57,6 +58,7 @@ public:
     );
 
     void get_mesh_info            ();
+    void make_lods                ();
     void get_vertex_attributes    ();
     void calculate_bounding_volume(erhe::geometry::Property_map<erhe::geometry::Point_id, glm::vec3>* point_locations);
     void allocate_vertex_buffer   ();
@@ -74,25 +76,45 @@ public:
     std::size_t                          vertex_stride     {0};
     std::size_t                          total_vertex_count{0};
     std::size_t                          total_index_count {0};
+    std::vector<std::vector<uint32_t>>   lod_indices;           // Reduced fill triangles, in fill vertex numbering
 };
 
-class Build_context
+// Flags for data missing from geometry, where a default value was used
+class Build_fallbacks
 {
 public:
-    Build_context(
-        const erhe::geometry::Geometry& geometry,
-        const Build_info&               build_info,
-        Element_mappings&               element_mappings,
-        const Normal_style              normal_style,
-        Buffer_mesh*                    buffer_mesh
-    );
-    ~Build_context() noexcept;
+    void merge(const Build_fallbacks& other);
 
-    void build_polygon_fill   ();
-    void build_edge_lines     ();
-    void build_centroid_points();
+    bool smooth_normal{false};
+    bool tangent      {false};
+    bool bitangent    {false};
+    bool texcoord     {false};
+};
 
-    Build_context_root root;
+// Position in the vertex and index streams where a range of polygons starts.
+// Offsets follow from polygon corner counts alone, so ranges can be built
+// independently into disjoint parts of the vertex and index buffers.
+class Build_range_start
+{
+public:
+    erhe::geometry::Polygon_id polygon_id     {0};
+    uint32_t                   vertex_index   {0};
+    uint32_t                   primitive_index{0}; // triangle index
+};
+
+class Build_context;
+
+// Builds vertices and indices for a range of polygons
+class Build_context_range
+{
+public:
+    Build_context_range(Build_context& context, const Build_range_start& start, bool update_property_maps);
+
+    void build_polygon_fill   (erhe::geometry::Polygon_id polygon_id_end);
+    void build_centroid_points(erhe::geometry::Polygon_id polygon_id_end);
+
+    [[nodiscard]] auto get_vertex_index() const -> uint32_t;
+    [[nodiscard]] auto get_fallbacks   () const -> const Build_fallbacks&;
 
 private:
     void build_polygon_id        ();
@@ -116,24 +138,81 @@ private:
     void build_corner_point_index  ();
     void build_triangle_fill_index ();
 
-    erhe::geometry::Polygon_id        polygon_id       {0};
-    erhe::geometry::Polygon_corner_id polygon_corner_id{0};
-    erhe::geometry::Point_id          point_id         {0};
-    erhe::geometry::Corner_id         corner_id        {0};
-    uint32_t                          vertex_index     {0}; // primitive vertex index    .
-    uint32_t                          first_index      {0}; // primitive first index      . These make triangle primitive
-    uint32_t                          previous_index   {0}; // primitive previous index  .
-    uint32_t                          polygon_index    {0};
-    uint32_t                          primitive_index  {0}; // triangle (TODO quad) index
-    Normal_style                      normal_style     {Normal_style::none};
-    Vertex_buffer_writer              vertex_writer;
-    Index_buffer_writer               index_writer;
-    Property_maps                     property_maps;
-
-    bool used_fallback_smooth_normal{false};
-    bool used_fallback_tangent      {false};
-    bool used_fallback_bitangent    {false};
-    bool used_fallback_texcoord     {false};
+    template <typename T>
+    void write(const Vertex_attribute_info& attribute, const T value)
+    {
+        vertex_writer.write(vertex_byte_offset, attribute, value);
+    }
+
+    Build_context_root&               root;
+    Vertex_buffer_writer&             vertex_writer;
+    Index_buffer_writer&              index_writer;
+    Property_maps&                    property_maps;
+    const bool                        update_property_maps;
+    uint32_t*                         triangle_indices  {nullptr}; // When set, fill indices go here for Index_optimization
+    erhe::geometry::Polygon_id        polygon_id        {0};
+    erhe::geometry::Polygon_corner_id polygon_corner_id {0};
+    erhe::geometry::Point_id          point_id          {0};
+    erhe::geometry::Corner_id         corner_id         {0};
+    uint32_t                          vertex_index      {0}; // primitive vertex index    .
+    uint32_t                          first_index       {0}; // primitive first index      . These make triangle primitive
+    uint32_t                          previous_index    {0}; // primitive previous index  .
+    uint32_t                          polygon_index     {0};
+    uint32_t                          primitive_index   {0}; // triangle (TODO quad) index
+    std::size_t                       vertex_byte_offset{0};
+    Build_fallbacks                   fallbacks;
+};
+
+class Build_context
+{
+public:
+    Build_context(
+        const erhe::geometry::Geometry& geometry,
+        const Build_info&               build_info,
+        Element_mappings&               element_mappings,
+        const Normal_style              normal_style,
+        Buffer_mesh*                    buffer_mesh
+    );
+    ~Build_context() noexcept;
+
+    void build_polygon_fill   ();
+    void build_edge_lines     ();
+    void build_centroid_points();
+
+    // True when streams are built using erhe::concurrency::Thread_pool
+    [[nodiscard]] auto is_parallel      () const -> bool;
+    [[nodiscard]] auto get_property_maps() const -> const Property_maps&;
+    [[nodiscard]] auto get_fallbacks    () const -> const Build_fallbacks&;
+
+    Build_context_root root;
+
+private:
+    friend class Build_context_range;
+
+    static constexpr std::size_t c_polygons_per_range = 4096;
+    static constexpr std::size_t c_edges_per_range    = 8192;
+
+    void make_ranges          ();
+    void update_property_maps ();
+    void log_fallbacks        () const;
+    auto optimize_fill_indices() -> bool; // Returns true if vertices were reordered
+    void write_lod_indices    ();
+
+    [[nodiscard]] auto get_edge_vertices(erhe::geometry::Edge_id edge_id, uint32_t& v0, uint32_t& v1) const -> bool;
+
+    Normal_style                   normal_style{Normal_style::none};
+    bool                           parallel    {false};
+    Vertex_buffer_writer           vertex_writer;
+    Index_buffer_writer            index_writer;
+    Property_maps                  property_maps;
+    std::vector<Build_range_start> ranges;                       // Polygon fill ranges
+    uint32_t                       fill_vertex_count        {0}; // Vertices used by polygon fill
+    uint32_t                       fill_triangle_count      {0};
+    std::vector<uint32_t>          fill_triangle_indices;        // Only used with Index_optimization
+    std::vector<uint32_t>          fill_vertex_remap;            // Old to new, when Index_optimization::vertex_fetch reordered vertices
+    std::size_t                    fill_vertices_written    {0};
+    std::size_t                    centroid_vertices_written{0};
+    Build_fallbacks                fallbacks;
 };
 
 class Primitive_builder final
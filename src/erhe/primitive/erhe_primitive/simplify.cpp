@@ -0,0 +1,439 @@
+#include "erhe_primitive/simplify.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace erhe::primitive {
+
+namespace {
+
+// Symmetric 4x4 matrix of plane equations, with accumulated weight
+class Quadric
+{
+public:
+    void add_plane(const glm::dvec3 normal, const double d, const double weight)
+    {
+        a00 += weight * normal.x * normal.x;
+        a01 += weight * normal.x * normal.y;
+        a02 += weight * normal.x * normal.z;
+        a11 += weight * normal.y * normal.y;
+        a12 += weight * normal.y * normal.z;
+        a22 += weight * normal.z * normal.z;
+        b0  += weight * normal.x * d;
+        b1  += weight * normal.y * d;
+        b2  += weight * normal.z * d;
+        c   += weight * d * d;
+        w   += weight;
+    }
+
+    void add(const Quadric& o)
+    {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02;
+        a11 += o.a11; a12 += o.a12; a22 += o.a22;
+        b0  += o.b0;  b1  += o.b1;  b2  += o.b2;
+        c   += o.c;
+        w   += o.w;
+    }
+
+    // Weighted sum of squared distances to planes
+    [[nodiscard]] auto evaluate(const glm::dvec3 p) const -> double
+    {
+        const double rx = a00 * p.x + a01 * p.y + a02 * p.z;
+        const double ry = a01 * p.x + a11 * p.y + a12 * p.z;
+        const double rz = a02 * p.x + a12 * p.y + a22 * p.z;
+        const double r  = p.x * rx + p.y * ry + p.z * rz + 2.0 * (p.x * b0 + p.y * b1 + p.z * b2) + c;
+        return std::max(r, 0.0);
+    }
+
+    double a00{0.0}, a01{0.0}, a02{0.0}, a11{0.0}, a12{0.0}, a22{0.0};
+    double b0 {0.0}, b1 {0.0}, b2 {0.0};
+    double c  {0.0};
+    double w  {0.0};
+};
+
+// Border planes are weighted relative to face planes so that borders
+// only move along themselves
+constexpr double c_border_weight = 10.0;
+
+class Position_key
+{
+public:
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+
+    [[nodiscard]] auto operator==(const Position_key& other) const -> bool = default;
+};
+
+class Position_key_hash
+{
+public:
+    [[nodiscard]] auto operator()(const Position_key& key) const -> std::size_t
+    {
+        uint64_t h = key.x;
+        h = (h * 0x9e3779b97f4a7c15ull) ^ key.y;
+        h = (h * 0x9e3779b97f4a7c15ull) ^ key.z;
+        return static_cast<std::size_t>(h ^ (h >> 29));
+    }
+};
+
+[[nodiscard]] auto make_position_key(const glm::vec3 p) -> Position_key
+{
+    // Treat -0.0 and 0.0 as same position
+    const glm::vec3 q = p + glm::vec3{0.0f};
+    Position_key key{};
+    std::memcpy(&key.x, &q.x, sizeof(float));
+    std::memcpy(&key.y, &q.y, sizeof(float));
+    std::memcpy(&key.z, &q.z, sizeof(float));
+    return key;
+}
+
+[[nodiscard]] auto make_edge_key(const uint32_t a, const uint32_t b) -> uint64_t
+{
+    return (a < b)
+        ? (static_cast<uint64_t>(a) << 32u) | b
+        : (static_cast<uint64_t>(b) << 32u) | a;
+}
+
+class Collapse
+{
+public:
+    double   cost;
+    uint32_t from;
+    uint32_t to;
+    uint32_t from_version;
+    uint32_t to_version;
+
+    [[nodiscard]] auto operator>(const Collapse& other) const -> bool { return cost > other.cost; }
+};
+
+class Simplifier
+{
+public:
+    Simplifier(const std::span<const uint32_t> indices, const std::span<const glm::vec3> vertex_positions)
+        : m_vertex_positions{vertex_positions}
+    {
+        weld(indices);
+        make_triangles(indices);
+        make_quadrics();
+        for (uint32_t t = 0, end = static_cast<uint32_t>(m_triangle_alive.size()); t < end; ++t) {
+            if (m_triangle_alive[t]) {
+                push_triangle_collapses(t);
+            }
+        }
+    }
+
+    void run(const std::size_t target_index_count, const double max_error)
+    {
+        while ((m_live_triangle_count * 3 > target_index_count) && !m_queue.empty()) {
+            const Collapse collapse = m_queue.top();
+            m_queue.pop();
+            if (
+                !m_wedge_alive[collapse.from] ||
+                !m_wedge_alive[collapse.to] ||
+                (m_wedge_version[collapse.from] != collapse.from_version) ||
+                (m_wedge_version[collapse.to] != collapse.to_version)
+            ) {
+                continue; // Stale
+            }
+            const double error = std::sqrt(collapse.cost);
+            if (error > max_error) {
+                break;
+            }
+            if (!is_valid_collapse(collapse.from, collapse.to)) {
+                continue;
+            }
+            apply_collapse(collapse.from, collapse.to);
+            m_max_error = std::max(m_max_error, error);
+        }
+    }
+
+    [[nodiscard]] auto get_result() const -> Simplify_result
+    {
+        Simplify_result result;
+        result.indices.reserve(3 * m_live_triangle_count);
+        for (std::size_t t = 0, end = m_triangle_alive.size(); t < end; ++t) {
+            if (m_triangle_alive[t]) {
+                result.indices.insert(result.indices.end(), &m_triangle_vertices[3 * t], &m_triangle_vertices[3 * t] + 3);
+            }
+        }
+        result.error = static_cast<float>(m_max_error);
+        return result;
+    }
+
+private:
+    void weld(const std::span<const uint32_t> indices)
+    {
+        ERHE_PROFILE_FUNCTION();
+
+        const std::size_t vertex_count = m_vertex_positions.size();
+        constexpr uint32_t c_unassigned = std::numeric_limits<uint32_t>::max();
+        m_wedge_of_vertex.assign(vertex_count, c_unassigned);
+
+        std::unordered_map<Position_key, uint32_t, Position_key_hash> wedge_lookup;
+        wedge_lookup.reserve(vertex_count);
+        for (const uint32_t vertex : indices) {
+            ERHE_VERIFY(vertex < vertex_count);
+            if (m_wedge_of_vertex[vertex] != c_unassigned) {
+                continue;
+            }
+            const glm::vec3 position = m_vertex_positions[vertex];
+            const auto [i, inserted] = wedge_lookup.emplace(make_position_key(position), static_cast<uint32_t>(m_wedge_positions.size()));
+            if (inserted) {
+                m_wedge_positions.push_back(glm::dvec3{position});
+                m_wedge_vertex.push_back(vertex);
+            }
+            m_wedge_of_vertex[vertex] = i->second;
+        }
+
+        const std::size_t wedge_count = m_wedge_positions.size();
+        m_wedge_alive   .assign(wedge_count, true);
+        m_wedge_version .assign(wedge_count, 0);
+        m_wedge_quadric .assign(wedge_count, Quadric{});
+        m_wedge_triangles.resize(wedge_count);
+    }
+
+    void make_triangles(const std::span<const uint32_t> indices)
+    {
+        const std::size_t triangle_count = indices.size() / 3;
+        m_triangle_vertices.assign(indices.begin(), indices.end());
+        m_triangle_wedges  .resize(indices.size());
+        m_triangle_alive   .assign(triangle_count, false);
+        for (std::size_t t = 0; t < triangle_count; ++t) {
+            uint32_t* w = &m_triangle_wedges[3 * t];
+            for (int k = 0; k < 3; ++k) {
+                w[k] = m_wedge_of_vertex[indices[3 * t + k]];
+            }
+            if ((w[0] == w[1]) || (w[1] == w[2]) || (w[2] == w[0])) {
+                continue; // Degenerate triangles are dropped
+            }
+            m_triangle_alive[t] = true;
+            ++m_live_triangle_count;
+            for (int k = 0; k < 3; ++k) {
+                m_wedge_triangles[w[k]].push_back(static_cast<uint32_t>(t));
+            }
+        }
+    }
+
+    void make_quadrics()
+    {
+        ERHE_PROFILE_FUNCTION();
+
+        std::unordered_map<uint64_t, uint32_t> edge_use_count;
+        edge_use_count.reserve(3 * m_live_triangle_count / 2);
+        for (std::size_t t = 0, end = m_triangle_alive.size(); t < end; ++t) {
+            if (!m_triangle_alive[t]) {
+                continue;
+            }
+            const uint32_t*  w  = &m_triangle_wedges[3 * t];
+            const glm::dvec3 p0 = m_wedge_positions[w[0]];
+            const glm::dvec3 p1 = m_wedge_positions[w[1]];
+            const glm::dvec3 p2 = m_wedge_positions[w[2]];
+            const glm::dvec3 n  = glm::cross(p1 - p0, p2 - p0);
+            const double     length = glm::length(n);
+            if (length > 0.0) {
+                const glm::dvec3 normal = n / length;
+                const double     area   = 0.5 * length;
+                for (int k = 0; k < 3; ++k) {
+                    m_wedge_quadric[w[k]].add_plane(normal, -glm::dot(normal, p0), area);
+                }
+            }
+            for (int k = 0; k < 3; ++k) {
+                ++edge_use_count[make_edge_key(w[k], w[(k + 1) % 3])];
+            }
+        }
+
+        // Border edges: plane through edge, perpendicular to triangle
+        for (std::size_t t = 0, end = m_triangle_alive.size(); t < end; ++t) {
+            if (!m_triangle_alive[t]) {
+                continue;
+            }
+            const uint32_t*  w  = &m_triangle_wedges[3 * t];
+            const glm::dvec3 p0 = m_wedge_positions[w[0]];
+            const glm::dvec3 p1 = m_wedge_positions[w[1]];
+            const glm::dvec3 p2 = m_wedge_positions[w[2]];
+            const glm::dvec3 face_normal = glm::cross(p1 - p0, p2 - p0);
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t a = w[k];
+                const uint32_t b = w[(k + 1) % 3];
+                if (edge_use_count[make_edge_key(a, b)] != 1) {
+                    continue;
+                }
+                const glm::dvec3 edge = m_wedge_positions[b] - m_wedge_positions[a];
+                const glm::dvec3 n    = glm::cross(edge, face_normal);
+                const double     length = glm::length(n);
+                if (length == 0.0) {
+                    continue;
+                }
+                const glm::dvec3 normal = n / length;
+                const double     weight = c_border_weight * glm::dot(edge, edge);
+                const double     d      = -glm::dot(normal, m_wedge_positions[a]);
+                m_wedge_quadric[a].add_plane(normal, d, weight);
+                m_wedge_quadric[b].add_plane(normal, d, weight);
+            }
+        }
+    }
+
+    [[nodiscard]] auto collapse_cost(const uint32_t from, const uint32_t to) const -> double
+    {
+        Quadric q = m_wedge_quadric[from];
+        q.add(m_wedge_quadric[to]);
+        return (q.w > 0.0) ? q.evaluate(m_wedge_positions[to]) / q.w : 0.0;
+    }
+
+    void push_collapse(const uint32_t a, const uint32_t b)
+    {
+        const double a_to_b = collapse_cost(a, b);
+        const double b_to_a = collapse_cost(b, a);
+        const uint32_t from = (a_to_b <= b_to_a) ? a : b;
+        const uint32_t to   = (a_to_b <= b_to_a) ? b : a;
+        m_queue.push(
+            Collapse{
+                .cost         = std::min(a_to_b, b_to_a),
+                .from         = from,
+                .to           = to,
+                .from_version = m_wedge_version[from],
+                .to_version   = m_wedge_version[to]
+            }
+        );
+    }
+
+    void push_triangle_collapses(const uint32_t t)
+    {
+        const uint32_t* w = &m_triangle_wedges[3 * t];
+        for (int k = 0; k < 3; ++k) {
+            push_collapse(w[k], w[(k + 1) % 3]);
+        }
+    }
+
+    [[nodiscard]] auto is_valid_collapse(const uint32_t from, const uint32_t to) const -> bool
+    {
+        const glm::dvec3 to_position = m_wedge_positions[to];
+        for (const uint32_t t : m_wedge_triangles[from]) {
+            if (!m_triangle_alive[t]) {
+                continue;
+            }
+            const uint32_t* w = &m_triangle_wedges[3 * t];
+            if ((w[0] == to) || (w[1] == to) || (w[2] == to)) {
+                continue; // Removed by collapse
+            }
+            glm::dvec3 p[3];
+            glm::dvec3 q[3];
+            for (int k = 0; k < 3; ++k) {
+                p[k] = m_wedge_positions[w[k]];
+                q[k] = (w[k] == from) ? to_position : p[k];
+            }
+            const glm::dvec3 n_before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const glm::dvec3 n_after  = glm::cross(q[1] - q[0], q[2] - q[0]);
+            if (glm::dot(n_before, n_after) <= 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void apply_collapse(const uint32_t from, const uint32_t to)
+    {
+        // Triangles on collapsed edge go away. Their corners tell which
+        // vertex at 'to' continues each vertex at 'from' across the edge.
+        m_partners.clear();
+        for (const uint32_t t : m_wedge_triangles[from]) {
+            if (!m_triangle_alive[t]) {
+                continue;
+            }
+            const uint32_t* w = &m_triangle_wedges[3 * t];
+            const uint32_t* v = &m_triangle_vertices[3 * t];
+            int from_k = -1;
+            int to_k   = -1;
+            for (int k = 0; k < 3; ++k) {
+                if (w[k] == from) { from_k = k; }
+                if (w[k] == to  ) { to_k   = k; }
+            }
+            if (to_k < 0) {
+                continue;
+            }
+            m_partners.emplace_back(v[from_k], v[to_k]);
+            m_triangle_alive[t] = false;
+            --m_live_triangle_count;
+        }
+
+        m_wedge_quadric[to].add(m_wedge_quadric[from]);
+        m_wedge_alive[from] = false;
+        ++m_wedge_version[to];
+
+        std::vector<uint32_t>& to_triangles = m_wedge_triangles[to];
+        for (const uint32_t t : m_wedge_triangles[from]) {
+            if (!m_triangle_alive[t]) {
+                continue;
+            }
+            uint32_t* w = &m_triangle_wedges[3 * t];
+            uint32_t* v = &m_triangle_vertices[3 * t];
+            for (int k = 0; k < 3; ++k) {
+                if (w[k] != from) {
+                    continue;
+                }
+                w[k] = to;
+                const auto partner = std::find_if(
+                    m_partners.begin(),
+                    m_partners.end(),
+                    [x = v[k]](const std::pair<uint32_t, uint32_t>& entry) { return entry.first == x; }
+                );
+                v[k] = (partner != m_partners.end()) ? partner->second : m_wedge_vertex[to];
+            }
+            to_triangles.push_back(t);
+        }
+        m_wedge_triangles[from] = std::vector<uint32_t>{};
+
+        // Drop dead triangles from adjacency and queue new candidates
+        std::erase_if(to_triangles, [this](const uint32_t t) { return !m_triangle_alive[t]; });
+        for (const uint32_t t : to_triangles) {
+            const uint32_t* w = &m_triangle_wedges[3 * t];
+            for (int k = 0; k < 3; ++k) {
+                if (w[k] != to) {
+                    push_collapse(to, w[k]);
+                }
+            }
+        }
+    }
+
+    std::span<const glm::vec3>                                                    m_vertex_positions;
+    std::vector<uint32_t>                                                         m_wedge_of_vertex;
+    std::vector<glm::dvec3>                                                       m_wedge_positions;
+    std::vector<uint32_t>                                                         m_wedge_vertex;    // First vertex at wedge position
+    std::vector<bool>                                                             m_wedge_alive;
+    std::vector<uint32_t>                                                         m_wedge_version;
+    std::vector<Quadric>                                                          m_wedge_quadric;
+    std::vector<std::vector<uint32_t>>                                            m_wedge_triangles;
+    std::vector<uint32_t>                                                         m_triangle_vertices;
+    std::vector<uint32_t>                                                         m_triangle_wedges;
+    std::vector<bool>                                                             m_triangle_alive;
+    std::size_t                                                                   m_live_triangle_count{0};
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_queue;
+    std::vector<std::pair<uint32_t, uint32_t>>                                    m_partners;
+    double                                                                        m_max_error{0.0};
+};
+
+} // anonymous namespace
+
+auto simplify(
+    const std::span<const uint32_t>  indices,
+    const std::span<const glm::vec3> vertex_positions,
+    const std::size_t                target_index_count,
+    const float                      max_error
+) -> Simplify_result
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(indices.size() % 3 == 0);
+
+    Simplifier simplifier{indices, vertex_positions};
+    simplifier.run(target_index_count, static_cast<double>(max_error));
+    return simplifier.get_result();
+}
+
+} // namespace erhe::primitive
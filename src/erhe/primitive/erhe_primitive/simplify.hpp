@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace erhe::primitive {
+
+class Simplify_result
+{
+public:
+    std::vector<uint32_t> indices;
+    float                 error{0.0f}; // Object space distance, area weighted RMS from original surface at worst collapse
+};
+
+// Quadric error metric edge collapse simplification (Garland & Heckbert)
+// of an indexed triangle list.
+//
+// Vertices are never moved or created; each collapse snaps one vertex
+// onto another, so the result indexes the same vertex buffer and can be
+// used as a level of detail index range. Vertices with equal positions
+// are welded for connectivity, so per corner vertices (flat normals,
+// texture coordinate seams) do not block simplification; a corner moved
+// across a seam picks the vertex on the far side of the collapsed edge
+// that shares its triangle. Open borders are kept with border plane
+// quadrics, and collapses that flip a triangle are rejected.
+//
+// Stops when index count is at or below target_index_count, when next
+// collapse would exceed max_error, or when no valid collapses remain.
+[[nodiscard]] auto simplify(
+    std::span<const uint32_t>  indices,
+    std::span<const glm::vec3> vertex_positions,
+    std::size_t                target_index_count,
+    float                      max_error = std::numeric_limits<float>::max()
+) -> Simplify_result;
+
+} // namespace erhe::primitive
@@ -1,16 +1,20 @@
 #include "erhe_primitive/triangle_soup.hpp"
 #include "erhe_primitive/primitive_log.hpp"
 #include "erhe_primitive/build_info.hpp"
+#include "erhe_primitive/index_optimizer.hpp"
+#include "erhe_dataformat/dataformat.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_log/log_glm.hpp"
 #include "erhe_graphics/vertex_attribute.hpp"
 #include "erhe_graphics/vertex_format.hpp"
 #include "erhe_math/math_util.hpp"
+#include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <glm/glm.hpp>
 
 #include <numeric>
+#include <span>
 #include <unordered_map>
 #include <set>
 
@@ -494,6 +498,71 @@ private:
     std::vector<erhe::geometry::Property_map<erhe::geometry::Point_id, glm::vec4>* > m_point_joint_weights;
 };
 
+void optimize_triangle_soup(Triangle_soup& triangle_soup, const Index_optimization& index_optimization)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t vertex_count = triangle_soup.get_vertex_count();
+    const std::span<uint32_t> indices{triangle_soup.index_data};
+    if (!index_optimization.is_enabled() || (indices.size() < 3) || (indices.size() % 3 != 0)) {
+        return;
+    }
+    for (const uint32_t index : indices) {
+        if (index >= vertex_count) {
+            log_primitive->warn("Triangle soup index {} out of range, vertex count = {}", index, vertex_count);
+            return;
+        }
+    }
+
+    if (index_optimization.log_statistics) {
+        const Vertex_cache_statistics statistics = analyze_vertex_cache(indices, vertex_count);
+        log_primitive->info(
+            "Triangle soup before index optimization: {} triangles, ACMR = {:.3f}, ATVR = {:.3f}",
+            statistics.triangle_count, statistics.acmr, statistics.atvr
+        );
+    }
+
+    if (index_optimization.vertex_cache || index_optimization.overdraw) {
+        std::vector<uint32_t> triangle_order = index_optimization.vertex_cache
+            ? optimize_vertex_cache(indices, vertex_count)
+            : std::vector<uint32_t>(indices.size() / 3);
+        if (!index_optimization.vertex_cache) {
+            std::iota(triangle_order.begin(), triangle_order.end(), 0);
+        }
+        const erhe::graphics::Vertex_attribute* position_attribute = triangle_soup.vertex_format.find_attribute_maybe(
+            erhe::graphics::Vertex_attribute::Usage_type::position
+        );
+        if (index_optimization.overdraw && (position_attribute != nullptr)) {
+            const std::size_t vertex_stride = triangle_soup.vertex_format.stride();
+            std::vector<glm::vec3> vertex_positions(vertex_count);
+            for (std::size_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+                const uint8_t* src = triangle_soup.vertex_data.data() + position_attribute->offset + vertex_index * vertex_stride;
+                float position[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                erhe::dataformat::convert(src, position_attribute->data_type, &position[0], erhe::dataformat::Format::format_32_vec4_float, 1.0f);
+                vertex_positions[vertex_index] = glm::vec3{position[0], position[1], position[2]};
+            }
+            optimize_overdraw(indices, vertex_positions, triangle_order, index_optimization.overdraw_threshold);
+        }
+        reorder_triangles(indices, triangle_order);
+    }
+
+    if (index_optimization.vertex_fetch) {
+        const std::vector<uint32_t> remap = optimize_vertex_fetch(indices, vertex_count);
+        for (uint32_t& index : indices) {
+            index = remap[index];
+        }
+        remap_vertex_data(triangle_soup.vertex_data, triangle_soup.vertex_format.stride(), remap);
+    }
+
+    if (index_optimization.log_statistics) {
+        const Vertex_cache_statistics statistics = analyze_vertex_cache(indices, vertex_count);
+        log_primitive->info(
+            "Triangle soup after index optimization: {} triangles, ACMR = {:.3f}, ATVR = {:.3f}",
+            statistics.triangle_count, statistics.acmr, statistics.atvr
+        );
+    }
+}
+
 auto geometry_from_triangle_soup(const Triangle_soup& triangle_soup, erhe::primitive::Element_mappings& element_mappings) -> erhe::geometry::Geometry
 {
     ERHE_PROFILE_FUNCTION();
@@ -9,6 +9,7 @@
 
 namespace erhe::primitive {
     class Element_mappings;
+    class Index_optimization;
 }
 namespace erhe::primitive {
 
@@ -24,6 +25,11 @@ public:
     std::vector<uint32_t>         index_data;
 };
 
+// Reorders triangles and vertices of triangle soup in place. Run before
+// geometry or buffer mesh is made from triangle soup, so that element
+// mappings made from it follow the new order.
+void optimize_triangle_soup(Triangle_soup& triangle_soup, const Index_optimization& index_optimization);
+
 [[nodiscard]] auto geometry_from_triangle_soup(const Triangle_soup& triangle_soup, erhe::primitive::Element_mappings& element_mappings) -> erhe::geometry::Geometry;
 
 } // namespace erhe::primitive
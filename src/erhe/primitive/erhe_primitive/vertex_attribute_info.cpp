@@ -19,6 +19,7 @@ Vertex_attribute_info::Vertex_attribute_info(
         data_type = attribute->data_type;
         offset    = attribute->offset;
         size      = attribute->size();
+        packer    = Attribute_packer::make(data_type);
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_primitive/attribute_packer.hpp"
 #include "erhe_graphics/vertex_attribute.hpp"
 
 #include <cstddef>
@@ -27,6 +28,7 @@ public:
     erhe::dataformat::Format                data_type{erhe::dataformat::Format::format_undefined};
     std::size_t                             offset   {std::numeric_limits<std::size_t>::max()};
     std::size_t                             size     {0};
+    Attribute_packer                        packer;
 };
 
 } // namespace erhe::primitive
@@ -0,0 +1,273 @@
+// Tests for triangle and vertex reordering in index_optimizer.
+//
+// Uses a grid of quads with shuffled triangle order. Checks that
+// optimize_vertex_cache() and optimize_overdraw() return permutations of
+// the triangles, that reordering keeps every triangle (including winding)
+// and moves per triangle values with it, and that ACMR measured with
+// analyze_vertex_cache() does not get worse than the shuffled input.
+// Checks that after optimize_vertex_fetch() vertices are first used in
+// increasing order, unreferenced vertices keep their relative order after
+// referenced vertices, and that remap_vertex_data() moves vertex data to
+// match remapped indices.
+
+#include "erhe_primitive/index_optimizer.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace erhe::primitive;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+class Test_mesh
+{
+public:
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t>  indices;
+};
+
+// Gently curved grid of quads, two triangles per quad, with triangle order
+// shuffled so that vertex cache locality of grid order is lost. Extra
+// vertices are not referenced by any triangle.
+auto make_shuffled_grid(const int grid_size, const int unreferenced_vertex_count) -> Test_mesh
+{
+    Test_mesh mesh;
+    const auto vertex_index = [grid_size](const int x, const int y) -> uint32_t {
+        return static_cast<uint32_t>(y * (grid_size + 1) + x);
+    };
+    for (int y = 0; y <= grid_size; ++y) {
+        for (int x = 0; x <= grid_size; ++x) {
+            const float fx = static_cast<float>(x);
+            const float fy = static_cast<float>(y);
+            mesh.positions.emplace_back(fx, fy, 0.5f * std::sin(0.2f * fx) * std::cos(0.3f * fy));
+        }
+    }
+    for (int i = 0; i < unreferenced_vertex_count; ++i) {
+        mesh.positions.emplace_back(-1.0f, static_cast<float>(i), 0.0f);
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (int y = 0; y < grid_size; ++y) {
+        for (int x = 0; x < grid_size; ++x) {
+            const uint32_t v00 = vertex_index(x,     y    );
+            const uint32_t v10 = vertex_index(x + 1, y    );
+            const uint32_t v11 = vertex_index(x + 1, y + 1);
+            const uint32_t v01 = vertex_index(x,     y + 1);
+            triangles.push_back({v00, v10, v11});
+            triangles.push_back({v00, v11, v01});
+        }
+    }
+    std::mt19937 random{12345u};
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    for (const std::array<uint32_t, 3>& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+auto is_permutation_of_iota(const std::vector<uint32_t>& values, const std::size_t count) -> bool
+{
+    if (values.size() != count) {
+        return false;
+    }
+    std::vector<uint32_t> sorted{values};
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t i = 0; i < count; ++i) {
+        if (sorted[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Triangles as sorted multiset; triangles are compared with their winding
+auto get_sorted_triangles(const std::vector<uint32_t>& indices) -> std::vector<std::array<uint32_t, 3>>
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (std::size_t i = 0, end = indices.size(); i + 2 < end; i += 3) {
+        triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+auto get_sorted(std::vector<uint32_t> values) -> std::vector<uint32_t>
+{
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+// Checks that triangle order is a permutation, that applying it keeps the
+// triangle and index multisets and moves per triangle values along, and
+// returns reordered indices
+auto check_triangle_order(
+    const std::vector<uint32_t>& indices,
+    const std::vector<uint32_t>& triangle_order,
+    const char*                  permutation_description,
+    const char*                  multiset_description,
+    const char*                  values_description
+) -> std::vector<uint32_t>
+{
+    const std::size_t triangle_count = indices.size() / 3;
+    check(is_permutation_of_iota(triangle_order, triangle_count), permutation_description);
+    if (triangle_order.size() != triangle_count) {
+        return indices;
+    }
+
+    std::vector<uint32_t> reordered{indices};
+    reorder_triangles(reordered, triangle_order);
+    check(get_sorted_triangles(reordered) == get_sorted_triangles(indices), multiset_description);
+    check(get_sorted(reordered) == get_sorted(indices), multiset_description);
+
+    // Per triangle values follow their triangle, as primitive id to polygon id does
+    std::vector<uint32_t> triangle_values(triangle_count);
+    std::iota(triangle_values.begin(), triangle_values.end(), 0);
+    reorder_triangle_values(triangle_values, triangle_order);
+    bool values_follow = true;
+    for (std::size_t i = 0; i < triangle_count; ++i) {
+        const uint32_t old_triangle = triangle_values[i];
+        values_follow = values_follow &&
+            (reordered[3 * i    ] == indices[3 * old_triangle    ]) &&
+            (reordered[3 * i + 1] == indices[3 * old_triangle + 1]) &&
+            (reordered[3 * i + 2] == indices[3 * old_triangle + 2]);
+    }
+    check(values_follow, values_description);
+    return reordered;
+}
+
+void test_triangle_order(const Test_mesh& mesh)
+{
+    const std::size_t vertex_count = mesh.positions.size();
+
+    const Vertex_cache_statistics shuffled = analyze_vertex_cache(mesh.indices, vertex_count);
+    check(shuffled.triangle_count == mesh.indices.size() / 3, "analyze_vertex_cache: triangle count");
+
+    const std::vector<uint32_t> cache_order = optimize_vertex_cache(mesh.indices, vertex_count);
+    const std::vector<uint32_t> cache_indices = check_triangle_order(
+        mesh.indices, cache_order,
+        "optimize_vertex_cache: triangle order is permutation",
+        "optimize_vertex_cache: triangles unchanged",
+        "optimize_vertex_cache: per triangle values follow triangles"
+    );
+    const Vertex_cache_statistics cache_optimized = analyze_vertex_cache(cache_indices, vertex_count);
+
+    std::vector<uint32_t> overdraw_order{cache_order};
+    optimize_overdraw(mesh.indices, mesh.positions, overdraw_order, 1.05f);
+    const std::vector<uint32_t> overdraw_indices = check_triangle_order(
+        mesh.indices, overdraw_order,
+        "optimize_overdraw: triangle order is permutation",
+        "optimize_overdraw: triangles unchanged",
+        "optimize_overdraw: per triangle values follow triangles"
+    );
+    const Vertex_cache_statistics overdraw_optimized = analyze_vertex_cache(overdraw_indices, vertex_count);
+
+    fmt::print(
+        "ACMR shuffled {:.3f}, vertex cache {:.3f}, overdraw {:.3f}\n",
+        shuffled.acmr, cache_optimized.acmr, overdraw_optimized.acmr
+    );
+    check(cache_optimized.vertex_count == shuffled.vertex_count,           "analyze_vertex_cache: referenced vertex count unchanged");
+    check(cache_optimized.acmr         <= shuffled.acmr,                   "optimize_vertex_cache: ACMR not worse than shuffled");
+    check(cache_optimized.acmr         <  1.0f,                            "optimize_vertex_cache: grid ACMR below one");
+    check(overdraw_optimized.acmr      <= shuffled.acmr,                   "optimize_overdraw: ACMR not worse than shuffled");
+
+    // Identity order stays valid for overdraw without vertex cache optimization
+    std::vector<uint32_t> identity_order(mesh.indices.size() / 3);
+    std::iota(identity_order.begin(), identity_order.end(), 0);
+    optimize_overdraw(mesh.indices, mesh.positions, identity_order, 1.05f);
+    check_triangle_order(
+        mesh.indices, identity_order,
+        "optimize_overdraw from identity: triangle order is permutation",
+        "optimize_overdraw from identity: triangles unchanged",
+        "optimize_overdraw from identity: per triangle values follow triangles"
+    );
+}
+
+void test_vertex_fetch(const Test_mesh& mesh, const std::size_t referenced_vertex_count)
+{
+    const std::size_t           vertex_count = mesh.positions.size();
+    const std::vector<uint32_t> remap        = optimize_vertex_fetch(mesh.indices, vertex_count);
+    check(is_permutation_of_iota(remap, vertex_count), "optimize_vertex_fetch: remap is permutation");
+    if (remap.size() != vertex_count) {
+        return;
+    }
+
+    std::vector<uint32_t> indices{mesh.indices};
+    for (uint32_t& index : indices) {
+        index = remap[index];
+    }
+
+    // First use of each vertex is the next unused vertex
+    bool     first_use_increasing = true;
+    uint32_t next_vertex          = 0;
+    for (const uint32_t index : indices) {
+        if (index == next_vertex) {
+            ++next_vertex;
+        } else {
+            first_use_increasing = first_use_increasing && (index < next_vertex);
+        }
+    }
+    check(first_use_increasing,                   "optimize_vertex_fetch: vertices first used in increasing order");
+    check(next_vertex == referenced_vertex_count, "optimize_vertex_fetch: referenced vertices come first");
+
+    bool unreferenced_in_order = true;
+    for (std::size_t old_vertex = referenced_vertex_count; old_vertex < vertex_count; ++old_vertex) {
+        unreferenced_in_order = unreferenced_in_order && (remap[old_vertex] == old_vertex);
+    }
+    check(unreferenced_in_order, "optimize_vertex_fetch: unreferenced vertices keep relative order at end");
+
+    // Vertex data moves with remapped indices
+    constexpr std::size_t vertex_stride = sizeof(glm::vec3);
+    std::vector<uint8_t> vertex_data(vertex_count * vertex_stride);
+    std::memcpy(vertex_data.data(), mesh.positions.data(), vertex_data.size());
+    remap_vertex_data(vertex_data, vertex_stride, remap);
+    bool data_follows = true;
+    for (std::size_t i = 0, end = indices.size(); i < end; ++i) {
+        glm::vec3 position;
+        std::memcpy(&position, vertex_data.data() + indices[i] * vertex_stride, vertex_stride);
+        data_follows = data_follows && (position == mesh.positions[mesh.indices[i]]);
+    }
+    check(data_follows, "remap_vertex_data: vertex data follows remapped indices");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::primitive::initialize_logging();
+
+    constexpr int grid_size                 = 40;
+    constexpr int unreferenced_vertex_count = 5;
+    const Test_mesh mesh = make_shuffled_grid(grid_size, unreferenced_vertex_count);
+
+    test_triangle_order(mesh);
+    test_vertex_fetch  (mesh, (grid_size + 1) * (grid_size + 1));
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("index optimizer tests passed\n");
+    return EXIT_SUCCESS;
+}
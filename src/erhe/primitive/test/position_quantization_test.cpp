@@ -0,0 +1,145 @@
+// Tests for Buffer_mesh position quantization.
+//
+// Positions inside the bounding box are quantized with
+// quantize_position(), stored as unorm16 or snorm16 and decoded with
+// position_offset + position_scale * stored. Checks that the decoded
+// error is within extent / 65535 on every axis, that decoded positions
+// stay inside the box, that flat (zero extent) axes decode exactly to the
+// flat coordinate, and that float formats keep identity scale and offset.
+
+#include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+using namespace erhe::primitive;
+using erhe::dataformat::Format;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+// Stores quantized position like vertex writer does and decodes it like
+// vertex shader does
+auto round_trip(const Buffer_mesh& buffer_mesh, const Format format, const glm::vec3 position) -> glm::vec3
+{
+    using namespace erhe::dataformat;
+    const glm::vec3 quantized = buffer_mesh.quantize_position(position);
+    glm::vec3 stored{};
+    for (glm::length_t i = 0; i < 3; ++i) {
+        stored[i] = (format == Format::format_16_vec3_unorm)
+            ? unorm16_to_float(float_to_unorm16(quantized[i]))
+            : snorm16_to_float(float_to_snorm16(quantized[i]));
+    }
+    return buffer_mesh.position_offset + buffer_mesh.position_scale * stored;
+}
+
+void test_quantization(const Format format, const glm::vec3 box_min, const glm::vec3 box_max, const char* label)
+{
+    Buffer_mesh buffer_mesh;
+    buffer_mesh.bounding_box.min = box_min;
+    buffer_mesh.bounding_box.max = box_max;
+    buffer_mesh.set_position_quantization(format);
+
+    const glm::vec3 extent = box_max - box_min;
+    // Half a step of 1 / 65535 (unorm16) or 2 / 65534 (snorm16) of extent,
+    // plus float rounding of decode relative to box coordinates
+    const glm::vec3 slack     = 4.0f * std::numeric_limits<float>::epsilon() * glm::max(glm::abs(box_min), glm::abs(box_max));
+    const glm::vec3 tolerance = extent / 65535.0f + slack;
+
+    bool      within_tolerance = true;
+    bool      inside_box       = true;
+    bool      flat_exact       = true;
+    glm::vec3 max_error{0.0f};
+    constexpr int steps = 40;
+    for (int i = 0; i <= steps; ++i) {
+        for (int j = 0; j <= steps; ++j) {
+            for (int k = 0; k <= steps; ++k) {
+                const glm::vec3 t{
+                    static_cast<float>(i) / steps,
+                    // Off grid in y and z so positions fall between quantization steps
+                    std::min(1.0f, (static_cast<float>(j) + 0.37f) / steps),
+                    std::min(1.0f, (static_cast<float>(k) + 0.71f) / steps)
+                };
+                const glm::vec3 position = box_min + t * extent;
+                const glm::vec3 decoded  = round_trip(buffer_mesh, format, position);
+                const glm::vec3 error    = glm::abs(decoded - position);
+                max_error = glm::max(max_error, error);
+                for (glm::length_t axis = 0; axis < 3; ++axis) {
+                    within_tolerance = within_tolerance && (error[axis] <= tolerance[axis]);
+                    inside_box       = inside_box && (decoded[axis] >= box_min[axis] - slack[axis]) && (decoded[axis] <= box_max[axis] + slack[axis]);
+                    if (extent[axis] == 0.0f) {
+                        flat_exact = flat_exact && (decoded[axis] == box_min[axis]);
+                    }
+                }
+            }
+        }
+    }
+    fmt::print(
+        "{}: max error ({:.3e}, {:.3e}, {:.3e}), tolerance ({:.3e}, {:.3e}, {:.3e})\n",
+        label, max_error.x, max_error.y, max_error.z, tolerance.x, tolerance.y, tolerance.z
+    );
+    check(within_tolerance, "quantization: error within extent / 65535 per axis");
+    check(inside_box,       "quantization: decoded positions stay inside bounding box");
+    check(flat_exact,       "quantization: flat axis decodes to flat coordinate");
+
+    // Box corners are exactly representable in unorm16
+    if (format == Format::format_16_vec3_unorm) {
+        check(round_trip(buffer_mesh, format, box_min) == box_min, "quantization: box min decodes exactly");
+    }
+}
+
+void test_float_format()
+{
+    Buffer_mesh buffer_mesh;
+    buffer_mesh.bounding_box.min = glm::vec3{-3.0f, 1.0f, 2.0f};
+    buffer_mesh.bounding_box.max = glm::vec3{ 5.0f, 4.0f, 2.5f};
+    buffer_mesh.set_position_quantization(Format::format_16_vec3_unorm);
+    buffer_mesh.set_position_quantization(Format::format_32_vec3_float);
+    check(buffer_mesh.position_scale  == glm::vec3{1.0f}, "quantization: float format resets scale to identity");
+    check(buffer_mesh.position_offset == glm::vec3{0.0f}, "quantization: float format resets offset to zero");
+    const glm::vec3 position{1.25f, -7.5f, 1.0e6f};
+    check(buffer_mesh.quantize_position(position) == position, "quantization: float format leaves positions unchanged");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::primitive::initialize_logging();
+
+    for (const Format format : { Format::format_16_vec3_unorm, Format::format_16_vec3_snorm }) {
+        const char* name = (format == Format::format_16_vec3_unorm) ? "unorm16" : "snorm16";
+        fmt::print("{}\n", name);
+        test_quantization(format, glm::vec3{-1.0f, -1.0f, -1.0f},        glm::vec3{1.0f, 1.0f, 1.0f},          "unit box");
+        test_quantization(format, glm::vec3{-1000.0f, 0.0f, 250.0f},     glm::vec3{3000.0f, 0.01f, 250.5f},    "uneven box");
+        test_quantization(format, glm::vec3{10000.0f, 20000.0f, 30000.0f}, glm::vec3{10010.0f, 20001.0f, 30000.1f}, "offset box");
+        test_quantization(format, glm::vec3{-2.0f, 3.0f, -5.0f},         glm::vec3{2.0f, 3.0f, 5.0f},          "flat y");
+        test_quantization(format, glm::vec3{0.0f, 7.0f, -4.0f},          glm::vec3{0.0f, 7.0f, -4.0f},         "single point");
+    }
+    test_float_format();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("position quantization tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,456 @@
+// Checks that multi-threaded primitive building produces output identical
+// to the serial build: vertex and index bytes, element mappings, property
+// maps written after parallel fill and merged fallback flags. Checks that
+// index optimization only reorders triangles and vertices: every corner
+// keeps its vertex data, every triangle keeps its polygon id, and edge
+// line indices follow the reordered vertices.
+
+#include "erhe_primitive/buffer_sink.hpp"
+#include "erhe_primitive/buffer_writer.hpp"
+#include "erhe_primitive/primitive_builder.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_graphics/vertex_attribute.hpp"
+#include "erhe_graphics/vertex_format.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+// Collects vertex and index data into memory
+class Memory_buffer_sink : public erhe::primitive::Buffer_sink
+{
+public:
+    auto allocate_vertex_buffer(const std::size_t vertex_count, const std::size_t vertex_element_size) -> erhe::primitive::Buffer_range override
+    {
+        vertex_bytes.resize(vertex_count * vertex_element_size);
+        return erhe::primitive::Buffer_range{.count = vertex_count, .element_size = vertex_element_size, .byte_offset = 0};
+    }
+    auto allocate_index_buffer(const std::size_t index_count, const std::size_t index_element_size) -> erhe::primitive::Buffer_range override
+    {
+        index_bytes.resize(index_count * index_element_size);
+        return erhe::primitive::Buffer_range{.count = index_count, .element_size = index_element_size, .byte_offset = 0};
+    }
+    void enqueue_index_data(const std::size_t offset, std::vector<uint8_t>&& data) const override
+    {
+        copy(index_bytes, offset, data);
+    }
+    void enqueue_vertex_data(const std::size_t offset, std::vector<uint8_t>&& data) const override
+    {
+        copy(vertex_bytes, offset, data);
+    }
+    void buffer_ready(erhe::primitive::Vertex_buffer_writer& writer) const override
+    {
+        copy(vertex_bytes, writer.start_offset(), writer.vertex_data);
+    }
+    void buffer_ready(erhe::primitive::Index_buffer_writer& writer) const override
+    {
+        copy(index_bytes, writer.start_offset(), writer.index_data);
+    }
+
+    mutable std::vector<uint8_t> vertex_bytes;
+    mutable std::vector<uint8_t> index_bytes;
+
+private:
+    static void copy(std::vector<uint8_t>& destination, const std::size_t offset, const std::vector<uint8_t>& data)
+    {
+        if (destination.size() < offset + data.size()) {
+            destination.resize(offset + data.size());
+        }
+        if (!data.empty()) {
+            std::memcpy(destination.data() + offset, data.data(), data.size());
+        }
+    }
+};
+
+// Grid of triangles, quads and pentagons, so that range start offsets
+// depend on varying corner counts. Only the first half of the polygons
+// get texture coordinates, so only some ranges use fallback texcoords.
+auto make_test_geometry(const int grid_size) -> erhe::geometry::Geometry
+{
+    using namespace erhe::geometry;
+    Geometry geometry{"parallel build test"};
+
+    const auto point_index = [grid_size](const int x, const int y) -> Point_id {
+        return static_cast<Point_id>(y * (grid_size + 1) + x);
+    };
+    for (int y = 0; y <= grid_size; ++y) {
+        for (int x = 0; x <= grid_size; ++x) {
+            const float fx = static_cast<float>(x);
+            const float fy = static_cast<float>(y);
+            geometry.make_point(fx, fy, 0.25f * std::sin(0.3f * fx) * std::cos(0.2f * fy));
+        }
+    }
+    for (int y = 0; y < grid_size; ++y) {
+        for (int x = 0; x < grid_size; ++x) {
+            const Point_id p00 = point_index(x,     y    );
+            const Point_id p10 = point_index(x + 1, y    );
+            const Point_id p11 = point_index(x + 1, y + 1);
+            const Point_id p01 = point_index(x,     y + 1);
+            switch ((x + 2 * y) % 3) {
+                case 0: {
+                    geometry.make_polygon({p00, p10, p11});
+                    geometry.make_polygon({p00, p11, p01});
+                    break;
+                }
+                case 1: {
+                    geometry.make_polygon({p00, p10, p11, p01});
+                    break;
+                }
+                default: {
+                    const Point_id mid = geometry.make_point(static_cast<float>(x) + 0.5f, static_cast<float>(y) - 0.1f, 0.0f);
+                    geometry.make_polygon({p00, mid, p10, p11, p01});
+                    break;
+                }
+            }
+        }
+    }
+
+    auto* corner_texcoords = geometry.corner_attributes().create<glm::vec2>(c_corner_texcoords);
+    const Polygon_id textured_polygon_count = geometry.get_polygon_count() / 2;
+    for (Polygon_id polygon_id = 0; polygon_id < textured_polygon_count; ++polygon_id) {
+        const Polygon& polygon = geometry.polygons[polygon_id];
+        for (uint32_t i = 0; i < polygon.corner_count; ++i) {
+            const Corner_id corner_id = geometry.polygon_corners[polygon.first_polygon_corner_id + i];
+            corner_texcoords->put(corner_id, glm::vec2{static_cast<float>(polygon_id), static_cast<float>(i)});
+        }
+    }
+
+    geometry.compute_polygon_normals();
+    geometry.compute_polygon_centroids();
+    geometry.build_edges();
+    return geometry;
+}
+
+auto make_vertex_format() -> erhe::graphics::Vertex_format
+{
+    using erhe::graphics::Vertex_attribute;
+    return erhe::graphics::Vertex_format{
+        Vertex_attribute::position_float3(),
+        Vertex_attribute::normal0_float3(),
+        Vertex_attribute::normal1_float3(),
+        Vertex_attribute::tangent_float4(),
+        Vertex_attribute::texcoord0_float2(),
+        Vertex_attribute::color_ubyte4(),
+        Vertex_attribute{
+            .usage       = { Vertex_attribute::Usage_type::id },
+            .shader_type = erhe::graphics::Glsl_type::float_vec3,
+            .data_type   = erhe::dataformat::Format::format_32_vec3_float
+        },
+        Vertex_attribute::vertex_valency()
+    };
+}
+
+auto make_build_info(const erhe::primitive::Buffer_info& buffer_info, const std::size_t parallel_threshold) -> erhe::primitive::Build_info
+{
+    return erhe::primitive::Build_info{
+        .primitive_types = {
+            .fill_triangles  = true,
+            .edge_lines      = true,
+            .corner_points   = true,
+            .centroid_points = true
+        },
+        .buffer_info        = buffer_info,
+        .parallel_threshold = parallel_threshold
+    };
+}
+
+class Build_result
+{
+public:
+    std::vector<uint8_t>              vertex_bytes;
+    std::vector<uint8_t>              index_bytes;
+    erhe::primitive::Element_mappings element_mappings;
+    erhe::primitive::Buffer_mesh      buffer_mesh;
+};
+
+auto build_mesh(
+    const erhe::geometry::Geometry&            geometry,
+    const std::size_t                          parallel_threshold,
+    const erhe::primitive::Index_optimization& index_optimization = {}
+) -> Build_result
+{
+    const erhe::graphics::Vertex_format vertex_format = make_vertex_format();
+    Memory_buffer_sink buffer_sink;
+    const erhe::primitive::Buffer_info buffer_info{
+        .index_type    = erhe::dataformat::Format::format_32_scalar_uint,
+        .vertex_format = vertex_format,
+        .buffer_sink   = buffer_sink
+    };
+    erhe::primitive::Build_info build_info = make_build_info(buffer_info, parallel_threshold);
+    build_info.index_optimization = index_optimization;
+
+    Build_result result;
+    result.buffer_mesh  = erhe::primitive::make_buffer_mesh(geometry, build_info, result.element_mappings);
+    result.vertex_bytes = std::move(buffer_sink.vertex_bytes);
+    result.index_bytes  = std::move(buffer_sink.index_bytes);
+    return result;
+}
+
+void test_buffer_mesh_identical(const erhe::geometry::Geometry& geometry)
+{
+    const Build_result serial   = build_mesh(geometry, 0);
+    const Build_result parallel = build_mesh(geometry, 1);
+
+    check(!serial.vertex_bytes.empty(),                         "Serial build wrote vertices");
+    check(serial.vertex_bytes == parallel.vertex_bytes,         "Parallel vertex bytes match serial");
+    check(serial.index_bytes  == parallel.index_bytes,          "Parallel index bytes match serial");
+    check(
+        serial.element_mappings.primitive_id_to_polygon_id == parallel.element_mappings.primitive_id_to_polygon_id,
+        "Parallel primitive id to polygon id mapping matches serial"
+    );
+    check(
+        serial.element_mappings.corner_to_vertex_id == parallel.element_mappings.corner_to_vertex_id,
+        "Parallel corner to vertex id mapping matches serial"
+    );
+    const auto same_range = [](const erhe::primitive::Index_range& lhs, const erhe::primitive::Index_range& rhs) {
+        return (lhs.first_index == rhs.first_index) && (lhs.index_count == rhs.index_count);
+    };
+    check(same_range(serial.buffer_mesh.triangle_fill_indices,    parallel.buffer_mesh.triangle_fill_indices),    "Fill index range matches");
+    check(same_range(serial.buffer_mesh.edge_line_indices,        parallel.buffer_mesh.edge_line_indices),        "Edge index range matches");
+    check(same_range(serial.buffer_mesh.corner_point_indices,     parallel.buffer_mesh.corner_point_indices),     "Corner point index range matches");
+    check(same_range(serial.buffer_mesh.polygon_centroid_indices, parallel.buffer_mesh.polygon_centroid_indices), "Centroid index range matches");
+}
+
+// Builds with Build_context directly, to inspect property maps and fallbacks
+void test_property_maps_and_fallbacks(const erhe::geometry::Geometry& geometry)
+{
+    using namespace erhe::geometry;
+
+    const erhe::graphics::Vertex_format vertex_format = make_vertex_format();
+    Memory_buffer_sink serial_sink;
+    Memory_buffer_sink parallel_sink;
+    const erhe::primitive::Buffer_info serial_buffer_info{
+        .index_type    = erhe::dataformat::Format::format_32_scalar_uint,
+        .vertex_format = vertex_format,
+        .buffer_sink   = serial_sink
+    };
+    const erhe::primitive::Buffer_info parallel_buffer_info{
+        .index_type    = erhe::dataformat::Format::format_32_scalar_uint,
+        .vertex_format = vertex_format,
+        .buffer_sink   = parallel_sink
+    };
+    const erhe::primitive::Build_info serial_build_info   = make_build_info(serial_buffer_info,   0);
+    const erhe::primitive::Build_info parallel_build_info = make_build_info(parallel_buffer_info, 1);
+
+    erhe::primitive::Element_mappings serial_mappings;
+    erhe::primitive::Element_mappings parallel_mappings;
+    erhe::primitive::Buffer_mesh      serial_mesh;
+    erhe::primitive::Buffer_mesh      parallel_mesh;
+    erhe::primitive::Build_context serial_context  {geometry, serial_build_info,   serial_mappings,   erhe::primitive::Normal_style::corner_normals, &serial_mesh};
+    erhe::primitive::Build_context parallel_context{geometry, parallel_build_info, parallel_mappings, erhe::primitive::Normal_style::corner_normals, &parallel_mesh};
+    check(!serial_context.is_parallel(),  "Threshold 0 selects serial build");
+    check( parallel_context.is_parallel(), "Threshold 1 selects parallel build");
+
+    serial_context  .build_polygon_fill();
+    parallel_context.build_polygon_fill();
+    serial_context  .build_edge_lines();
+    parallel_context.build_edge_lines();
+    serial_context  .build_centroid_points();
+    parallel_context.build_centroid_points();
+
+    const erhe::primitive::Build_fallbacks& serial_fallbacks   = serial_context  .get_fallbacks();
+    const erhe::primitive::Build_fallbacks& parallel_fallbacks = parallel_context.get_fallbacks();
+    check(serial_fallbacks.texcoord,                                       "Serial build used fallback texcoord for untextured polygons");
+    check(serial_fallbacks.texcoord      == parallel_fallbacks.texcoord,      "Merged texcoord fallback matches serial");
+    check(serial_fallbacks.smooth_normal == parallel_fallbacks.smooth_normal, "Merged smooth normal fallback matches serial");
+    check(serial_fallbacks.tangent       == parallel_fallbacks.tangent,       "Merged tangent fallback matches serial");
+    check(serial_fallbacks.bitangent     == parallel_fallbacks.bitangent,     "Merged bitangent fallback matches serial");
+
+    const erhe::primitive::Property_maps& serial_maps   = serial_context  .get_property_maps();
+    const erhe::primitive::Property_maps& parallel_maps = parallel_context.get_property_maps();
+
+    bool corner_indices_match = true;
+    for (Corner_id corner_id = 0, end = geometry.get_corner_count(); corner_id < end; ++corner_id) {
+        uint32_t serial_value  {0};
+        uint32_t parallel_value{0};
+        const bool serial_has   = serial_maps  .corner_indices->maybe_get(corner_id, serial_value);
+        const bool parallel_has = parallel_maps.corner_indices->maybe_get(corner_id, parallel_value);
+        corner_indices_match = corner_indices_match && (serial_has == parallel_has) && (serial_value == parallel_value);
+    }
+    check(corner_indices_match, "Parallel corner_indices property map matches serial");
+
+    check(
+        (serial_maps.polygon_ids_vector3 != nullptr) && (parallel_maps.polygon_ids_vector3 != nullptr),
+        "Polygon id property maps exist"
+    );
+    if ((serial_maps.polygon_ids_vector3 != nullptr) && (parallel_maps.polygon_ids_vector3 != nullptr)) {
+        bool polygon_ids_match = true;
+        for (Polygon_id polygon_id = 0, end = geometry.get_polygon_count(); polygon_id < end; ++polygon_id) {
+            glm::vec3 serial_value  {0.0f};
+            glm::vec3 parallel_value{0.0f};
+            const bool serial_has   = serial_maps  .polygon_ids_vector3->maybe_get(polygon_id, serial_value);
+            const bool parallel_has = parallel_maps.polygon_ids_vector3->maybe_get(polygon_id, parallel_value);
+            polygon_ids_match = polygon_ids_match && (serial_has == parallel_has) && (serial_value == parallel_value);
+        }
+        check(polygon_ids_match, "Parallel polygon id property map matches serial");
+    }
+}
+
+auto read_indices(const Build_result& result, const erhe::primitive::Index_range& index_range) -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> indices(index_range.index_count);
+    if (!indices.empty()) {
+        std::memcpy(indices.data(), result.index_bytes.data() + index_range.first_index * sizeof(uint32_t), indices.size() * sizeof(uint32_t));
+    }
+    return indices;
+}
+
+// Compares build with index optimization against build without it. The
+// optimized build may only reorder triangles and fill vertices, and must
+// keep Element_mappings consistent with the reordered data.
+void test_index_optimization(const erhe::geometry::Geometry& geometry)
+{
+    using namespace erhe::geometry;
+
+    const erhe::primitive::Index_optimization index_optimization{
+        .vertex_cache = true,
+        .overdraw     = true,
+        .vertex_fetch = true
+    };
+    const Build_result reference          = build_mesh(geometry, 0);
+    const Build_result optimized          = build_mesh(geometry, 0, index_optimization);
+    const Build_result optimized_parallel = build_mesh(geometry, 1, index_optimization);
+
+    check(optimized.vertex_bytes == optimized_parallel.vertex_bytes, "Optimized parallel vertex bytes match serial");
+    check(optimized.index_bytes  == optimized_parallel.index_bytes,  "Optimized parallel index bytes match serial");
+    check(
+        (optimized.element_mappings.primitive_id_to_polygon_id == optimized_parallel.element_mappings.primitive_id_to_polygon_id) &&
+        (optimized.element_mappings.corner_to_vertex_id        == optimized_parallel.element_mappings.corner_to_vertex_id),
+        "Optimized parallel element mappings match serial"
+    );
+
+    check(optimized.vertex_bytes.size() == reference.vertex_bytes.size(), "Index optimization keeps vertex count");
+    check(optimized.index_bytes .size() == reference.index_bytes .size(), "Index optimization keeps index count");
+    check(
+        optimized.element_mappings.corner_to_vertex_id.size() == reference.element_mappings.corner_to_vertex_id.size(),
+        "Index optimization keeps corner to vertex id size"
+    );
+    if (
+        (optimized.vertex_bytes.size() != reference.vertex_bytes.size()) ||
+        (optimized.index_bytes .size() != reference.index_bytes .size()) ||
+        (optimized.element_mappings.corner_to_vertex_id.size() != reference.element_mappings.corner_to_vertex_id.size())
+    ) {
+        return;
+    }
+
+    // Every corner keeps its vertex data; reference to optimized vertex map
+    // is one to one
+    const std::size_t     vertex_stride          = make_vertex_format().stride();
+    const std::size_t     vertex_count           = reference.vertex_bytes.size() / vertex_stride;
+    constexpr uint32_t    c_unmapped             = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> vertex_map(vertex_count, c_unmapped);
+    std::vector<bool>     optimized_vertex_used(vertex_count, false);
+    bool                  corner_data_matches    = true;
+    bool                  vertex_map_one_to_one  = true;
+    for (Corner_id corner_id = 0, end = geometry.get_corner_count(); corner_id < end; ++corner_id) {
+        const uint32_t reference_vertex = reference.element_mappings.corner_to_vertex_id[corner_id];
+        const uint32_t optimized_vertex = optimized.element_mappings.corner_to_vertex_id[corner_id];
+        if ((reference_vertex >= vertex_count) || (optimized_vertex >= vertex_count)) {
+            corner_data_matches = false;
+            continue;
+        }
+        corner_data_matches = corner_data_matches && (std::memcmp(
+            reference.vertex_bytes.data() + reference_vertex * vertex_stride,
+            optimized.vertex_bytes.data() + optimized_vertex * vertex_stride,
+            vertex_stride
+        ) == 0);
+        if (vertex_map[reference_vertex] == c_unmapped) {
+            vertex_map_one_to_one = vertex_map_one_to_one && !optimized_vertex_used[optimized_vertex];
+            vertex_map[reference_vertex]            = optimized_vertex;
+            optimized_vertex_used[optimized_vertex] = true;
+        } else {
+            vertex_map_one_to_one = vertex_map_one_to_one && (vertex_map[reference_vertex] == optimized_vertex);
+        }
+    }
+    check(corner_data_matches,   "Index optimization: corner_to_vertex_id points to same vertex data");
+    check(vertex_map_one_to_one, "Index optimization: vertex reorder is one to one");
+
+    // Every triangle keeps its polygon id, compared as multiset because
+    // triangle order changes
+    const std::vector<uint32_t> reference_fill = read_indices(reference, reference.buffer_mesh.triangle_fill_indices);
+    const std::vector<uint32_t> optimized_fill = read_indices(optimized, optimized.buffer_mesh.triangle_fill_indices);
+    check(optimized_fill.size() == reference_fill.size(), "Index optimization keeps fill index count");
+    check(optimized_fill != reference_fill,               "Index optimization reorders fill indices");
+    const std::size_t triangle_count = reference_fill.size() / 3;
+    check(
+        (reference.element_mappings.primitive_id_to_polygon_id.size() >= triangle_count) &&
+        (optimized.element_mappings.primitive_id_to_polygon_id.size() == reference.element_mappings.primitive_id_to_polygon_id.size()),
+        "Index optimization keeps primitive id to polygon id size"
+    );
+    if ((optimized_fill.size() != reference_fill.size()) || (reference.element_mappings.primitive_id_to_polygon_id.size() < triangle_count)) {
+        return;
+    }
+    const auto get_triangles = [triangle_count](
+        const std::vector<uint32_t>& indices,
+        const std::vector<uint32_t>& primitive_id_to_polygon_id,
+        const std::vector<uint32_t>* vertex_remap
+    ) {
+        std::vector<std::array<uint32_t, 4>> triangles(triangle_count);
+        for (std::size_t i = 0; i < triangle_count; ++i) {
+            const auto remap = [vertex_remap](const uint32_t vertex) {
+                return ((vertex_remap != nullptr) && (vertex < vertex_remap->size())) ? (*vertex_remap)[vertex] : vertex;
+            };
+            triangles[i] = {primitive_id_to_polygon_id[i], remap(indices[3 * i]), remap(indices[3 * i + 1]), remap(indices[3 * i + 2])};
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+    check(
+        get_triangles(reference_fill, reference.element_mappings.primitive_id_to_polygon_id, &vertex_map) ==
+        get_triangles(optimized_fill, optimized.element_mappings.primitive_id_to_polygon_id, nullptr),
+        "Index optimization: triangles keep polygon id and vertices"
+    );
+
+    // Edge lines are written from corner indices after vertex reorder
+    const std::vector<uint32_t> reference_edges = read_indices(reference, reference.buffer_mesh.edge_line_indices);
+    const std::vector<uint32_t> optimized_edges = read_indices(optimized, optimized.buffer_mesh.edge_line_indices);
+    bool edges_follow = (reference_edges.size() == optimized_edges.size());
+    for (std::size_t i = 0, end = std::min(reference_edges.size(), optimized_edges.size()); i < end; ++i) {
+        edges_follow = edges_follow && (reference_edges[i] < vertex_count) && (vertex_map[reference_edges[i]] == optimized_edges[i]);
+    }
+    check(edges_follow, "Index optimization: edge line indices follow reordered vertices");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::geometry::initialize_logging();
+    erhe::primitive::initialize_logging();
+
+    // About 30k polygons; several parallel fill and edge ranges
+    const erhe::geometry::Geometry geometry = make_test_geometry(150);
+
+    test_buffer_mesh_identical      (geometry);
+    test_property_maps_and_fallbacks(geometry);
+    test_index_optimization         (geometry);
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("Parallel primitive build matches serial build\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,326 @@
+// Tests for simplify() and level of detail selection.
+//
+// simplify(): on a UV sphere with duplicated seam vertices, checks that
+// the triangle count reaches the target index count without overshooting
+// it, that max_error stops simplification, and that no triangle is flipped
+// or degenerate. On a flat open grid with a small max_error, checks that
+// interior vertices are removed while the border outline is kept: every
+// border edge of the result lies on a side of the original square, all
+// four corners remain and total area is unchanged.
+//
+// select_lod(): checks that the coarsest level whose projected error is
+// within max pixel error is picked, for perspective and orthographic
+// selections, scaled nodes, views inside the bounding sphere, and that
+// make_lod_selection() derives view position, scale and projection type.
+
+#include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_primitive/lod.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_primitive/simplify.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace erhe::primitive;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+class Test_mesh
+{
+public:
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t>  indices;
+};
+
+// UV sphere with one vertex per pole and a duplicated seam column, like
+// meshes with texture coordinates have. Triangles wind outwards.
+auto make_uv_sphere(const uint32_t slice_count, const uint32_t stack_count) -> Test_mesh
+{
+    Test_mesh mesh;
+    const uint32_t north = 0;
+    mesh.positions.push_back(glm::vec3{0.0f, 1.0f, 0.0f});
+    for (uint32_t stack = 1; stack < stack_count; ++stack) {
+        const float theta = glm::pi<float>() * static_cast<float>(stack) / static_cast<float>(stack_count);
+        for (uint32_t slice = 0; slice <= slice_count; ++slice) {
+            // Last column repeats the first at the same position
+            const float phi = 2.0f * glm::pi<float>() * static_cast<float>(slice % slice_count) / static_cast<float>(slice_count);
+            mesh.positions.push_back(glm::vec3{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)});
+        }
+    }
+    const uint32_t south = static_cast<uint32_t>(mesh.positions.size());
+    mesh.positions.push_back(glm::vec3{0.0f, -1.0f, 0.0f});
+
+    const auto ring_vertex = [slice_count](const uint32_t stack, const uint32_t slice) -> uint32_t {
+        return 1 + (stack - 1) * (slice_count + 1) + slice;
+    };
+    const auto add_triangle = [&mesh](const uint32_t a, const uint32_t b, const uint32_t c) {
+        const glm::vec3 n        = glm::cross(mesh.positions[b] - mesh.positions[a], mesh.positions[c] - mesh.positions[a]);
+        const glm::vec3 centroid = mesh.positions[a] + mesh.positions[b] + mesh.positions[c];
+        if (glm::dot(n, centroid) >= 0.0f) {
+            mesh.indices.insert(mesh.indices.end(), {a, b, c});
+        } else {
+            mesh.indices.insert(mesh.indices.end(), {a, c, b});
+        }
+    };
+    for (uint32_t slice = 0; slice < slice_count; ++slice) {
+        add_triangle(north, ring_vertex(1, slice), ring_vertex(1, slice + 1));
+        for (uint32_t stack = 1; stack + 1 < stack_count; ++stack) {
+            const uint32_t a = ring_vertex(stack,     slice);
+            const uint32_t b = ring_vertex(stack,     slice + 1);
+            const uint32_t c = ring_vertex(stack + 1, slice);
+            const uint32_t d = ring_vertex(stack + 1, slice + 1);
+            add_triangle(a, c, d);
+            add_triangle(a, d, b);
+        }
+        add_triangle(south, ring_vertex(stack_count - 1, slice), ring_vertex(stack_count - 1, slice + 1));
+    }
+    return mesh;
+}
+
+// Flat grid in y = 0 plane from (0, 0) to (side, side), normals +y
+auto make_grid(const uint32_t side) -> Test_mesh
+{
+    Test_mesh mesh;
+    for (uint32_t z = 0; z <= side; ++z) {
+        for (uint32_t x = 0; x <= side; ++x) {
+            mesh.positions.push_back(glm::vec3{static_cast<float>(x), 0.0f, static_cast<float>(z)});
+        }
+    }
+    const uint32_t row = side + 1;
+    for (uint32_t z = 0; z < side; ++z) {
+        for (uint32_t x = 0; x < side; ++x) {
+            const uint32_t p00 = z * row + x;
+            const uint32_t p10 = p00 + 1;
+            const uint32_t p01 = p00 + row;
+            const uint32_t p11 = p01 + 1;
+            mesh.indices.insert(mesh.indices.end(), {p00, p01, p11, p00, p11, p10});
+        }
+    }
+    return mesh;
+}
+
+auto triangle_normal(const Test_mesh& mesh, const std::vector<uint32_t>& indices, const std::size_t triangle) -> glm::vec3
+{
+    const glm::vec3 a = mesh.positions[indices[3 * triangle + 0]];
+    const glm::vec3 b = mesh.positions[indices[3 * triangle + 1]];
+    const glm::vec3 c = mesh.positions[indices[3 * triangle + 2]];
+    return glm::cross(b - a, c - a);
+}
+
+auto indices_valid(const Test_mesh& mesh, const std::vector<uint32_t>& indices) -> bool
+{
+    if ((indices.size() % 3) != 0) {
+        return false;
+    }
+    for (const uint32_t index : indices) {
+        if (index >= mesh.positions.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_simplify_sphere()
+{
+    const Test_mesh sphere = make_uv_sphere(64, 32);
+    const std::size_t target_index_count = sphere.indices.size() / 4;
+
+    const Simplify_result result = simplify(sphere.indices, sphere.positions, target_index_count);
+    check(indices_valid(sphere, result.indices),          "simplify sphere: valid indices");
+    check(result.indices.size() <= target_index_count,    "simplify sphere: reaches target index count");
+    check(result.indices.size() > target_index_count / 2, "simplify sphere: does not overshoot target");
+    check(result.error > 0.0f,                            "simplify sphere: reports error");
+
+    // Closed sphere, all triangles face away from center
+    bool none_flipped = true;
+    for (std::size_t t = 0, end = result.indices.size() / 3; t < end; ++t) {
+        const glm::vec3 centroid =
+            sphere.positions[result.indices[3 * t + 0]] +
+            sphere.positions[result.indices[3 * t + 1]] +
+            sphere.positions[result.indices[3 * t + 2]];
+        none_flipped = none_flipped && (glm::dot(triangle_normal(sphere, result.indices, t), centroid) > 0.0f);
+    }
+    check(none_flipped, "simplify sphere: no flipped or degenerate triangles");
+
+    // Stops at max_error before reaching target
+    const float max_error = 0.5f * result.error;
+    const Simplify_result limited = simplify(sphere.indices, sphere.positions, target_index_count, max_error);
+    check(limited.error <= max_error,                          "simplify sphere: error within max_error");
+    check(limited.indices.size() > result.indices.size(),      "simplify sphere: max_error stops before target");
+    check(limited.indices.size() < sphere.indices.size(),      "simplify sphere: max_error still allows some collapses");
+}
+
+void test_simplify_grid_border()
+{
+    constexpr uint32_t side = 16;
+    const Test_mesh grid = make_grid(side);
+    const float extent = static_cast<float>(side);
+
+    // Interior collapses on a plane are free, border corners are not
+    const Simplify_result result = simplify(grid.indices, grid.positions, 0, 1.0e-3f);
+    check(indices_valid(grid, result.indices),                  "simplify grid: valid indices");
+    check(result.indices.size() <= grid.indices.size() / 4,     "simplify grid: interior is simplified");
+
+    bool   none_flipped = true;
+    double area         = 0.0;
+    std::map<std::pair<uint32_t, uint32_t>, int> edge_use;
+    for (std::size_t t = 0, end = result.indices.size() / 3; t < end; ++t) {
+        const glm::vec3 n = triangle_normal(grid, result.indices, t);
+        none_flipped = none_flipped && (n.y > 0.0f);
+        area += 0.5 * static_cast<double>(n.y);
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t a = result.indices[3 * t + k];
+            const uint32_t b = result.indices[3 * t + (k + 1) % 3];
+            ++edge_use[std::minmax(a, b)];
+        }
+    }
+    check(none_flipped,                                                  "simplify grid: no flipped or degenerate triangles");
+    check(std::abs(area - static_cast<double>(extent * extent)) < 1.0e-3, "simplify grid: area is unchanged");
+
+    // Border edges are used by one triangle; both ends on same side of square
+    const auto on_same_side = [extent](const glm::vec3 a, const glm::vec3 b) -> bool {
+        return
+            ((a.x == 0.0f)   && (b.x == 0.0f))   ||
+            ((a.x == extent) && (b.x == extent)) ||
+            ((a.z == 0.0f)   && (b.z == 0.0f))   ||
+            ((a.z == extent) && (b.z == extent));
+    };
+    bool   border_kept   = true;
+    double border_length = 0.0;
+    for (const auto& [edge, use_count] : edge_use) {
+        if (use_count != 1) {
+            continue;
+        }
+        const glm::vec3 a = grid.positions[edge.first];
+        const glm::vec3 b = grid.positions[edge.second];
+        border_kept = border_kept && on_same_side(a, b);
+        border_length += static_cast<double>(glm::distance(a, b));
+    }
+    check(border_kept,                                                   "simplify grid: border edges stay on original border");
+    check(std::abs(border_length - 4.0 * static_cast<double>(extent)) < 1.0e-3, "simplify grid: border length is unchanged");
+
+    bool corners_kept = true;
+    for (const glm::vec3 corner : { glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{extent, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, extent}, glm::vec3{extent, 0.0f, extent} }) {
+        bool found = false;
+        for (const uint32_t index : result.indices) {
+            found = found || (grid.positions[index] == corner);
+        }
+        corners_kept = corners_kept && found;
+    }
+    check(corners_kept, "simplify grid: corners are kept");
+}
+
+auto make_lod_mesh() -> Buffer_mesh
+{
+    Buffer_mesh buffer_mesh;
+    buffer_mesh.bounding_sphere.center = glm::vec3{0.0f};
+    buffer_mesh.bounding_sphere.radius = 1.0f;
+    buffer_mesh.triangle_fill_lods = {
+        Buffer_mesh_lod{.error = 0.01f},
+        Buffer_mesh_lod{.error = 0.05f},
+        Buffer_mesh_lod{.error = 0.2f}
+    };
+    return buffer_mesh;
+}
+
+void test_select_lod()
+{
+    const Buffer_mesh buffer_mesh = make_lod_mesh();
+    const glm::mat4   identity{1.0f};
+
+    // 1000 pixels per world unit at unit distance, 1 pixel threshold;
+    // distance is measured to bounding sphere, so view at x = d + 1
+    Lod_selection selection{
+        .view_position    = glm::vec3{0.0f},
+        .projection_scale = 1000.0f,
+        .max_pixel_error  = 1.0f,
+        .orthographic     = false
+    };
+    const auto select_at = [&](const float distance, const glm::mat4& world_from_node) -> std::size_t {
+        selection.view_position = glm::vec3{distance, 0.0f, 0.0f};
+        return select_lod(selection, buffer_mesh, world_from_node);
+    };
+
+    // Pixel errors per level at sphere distance d: 10/d, 50/d, 200/d
+    check(select_at(   6.0f, identity) == 0, "select_lod: full detail when every level is over threshold");
+    check(select_at(  12.0f, identity) == 1, "select_lod: level 1 just under threshold");
+    check(select_at(  31.0f, identity) == 1, "select_lod: level 1 when level 2 is over threshold");
+    check(select_at( 101.0f, identity) == 2, "select_lod: level 2 when level 3 is over threshold");
+    check(select_at(1001.0f, identity) == 3, "select_lod: coarsest level when all are under threshold");
+    check(select_at(   0.5f, identity) == 0, "select_lod: full detail inside bounding sphere");
+
+    // Scale grows both bounding sphere and error
+    const glm::mat4 scaled = glm::scale(glm::mat4{1.0f}, glm::vec3{1.0f, 10.0f, 2.0f});
+    check(select_at(1010.0f, scaled) == 2, "select_lod: error and radius scale with largest axis scale");
+
+    // Orthographic error does not depend on distance
+    selection.orthographic     = true;
+    selection.projection_scale = 10.0f;
+    check(select_at(   5.0f, identity) == 2, "select_lod: orthographic near");
+    check(select_at(5000.0f, identity) == 2, "select_lod: orthographic far");
+
+    selection.orthographic     = false;
+    selection.projection_scale = 1000.0f;
+    selection.max_pixel_error  = 0.0f;
+    check(select_at(5000.0f, identity) == 0, "select_lod: zero max pixel error selects full detail");
+
+    selection.max_pixel_error = 1.0f;
+    const Buffer_mesh single_level{};
+    selection.view_position = glm::vec3{5000.0f, 0.0f, 0.0f};
+    check(select_lod(selection, single_level, identity) == 0, "select_lod: mesh without levels");
+
+    // Perspective: projection scale is half viewport height over tan(fovy / 2)
+    const glm::mat4 world_from_camera = glm::translate(glm::mat4{1.0f}, glm::vec3{1.0f, 2.0f, 3.0f});
+    const Lod_selection perspective = make_lod_selection(
+        glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f), world_from_camera, 1000.0f, 2.0f
+    );
+    check(perspective.view_position == glm::vec3{1.0f, 2.0f, 3.0f},  "make_lod_selection: view position");
+    check(std::abs(perspective.projection_scale - 500.0f) < 1.0e-2f, "make_lod_selection: perspective scale");
+    check(!perspective.orthographic,                                 "make_lod_selection: perspective");
+    check(perspective.max_pixel_error == 2.0f,                       "make_lod_selection: max pixel error");
+
+    const Lod_selection orthographic = make_lod_selection(
+        glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 100.0f), world_from_camera, 1000.0f, 1.0f
+    );
+    check(orthographic.orthographic,                                  "make_lod_selection: orthographic");
+    check(std::abs(orthographic.projection_scale - 100.0f) < 1.0e-2f, "make_lod_selection: orthographic scale");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::primitive::initialize_logging();
+
+    test_simplify_sphere();
+    test_simplify_grid_border();
+    test_select_lod();
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("simplify and LOD tests passed\n");
+    return EXIT_SUCCESS;
+}
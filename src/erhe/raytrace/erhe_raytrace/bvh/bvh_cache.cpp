@@ -0,0 +1,433 @@
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable : 4702) // unreachable code
+#   pragma warning(disable : 4714) // marked as __forceinline not inlined
+#endif
+
+#include "erhe_raytrace/bvh/bvh_cache.hpp"
+#include "erhe_raytrace/raytrace_log.hpp"
+
+#include "erhe_file/file.hpp"
+#include "erhe_file/mapped_file.hpp"
+#include "erhe_hash/hash.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <process.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace erhe::raytrace {
+
+namespace {
+
+using Node = bvh::v2::Node<float, 3>;
+
+static_assert(std::is_trivially_copyable_v<Node>, "BVH nodes are stored as raw bytes");
+
+[[nodiscard]] auto hash_payload(
+    const void* const nodes,
+    const std::size_t node_byte_count,
+    const void* const prim_ids,
+    const std::size_t prim_id_byte_count
+) -> uint64_t
+{
+    erhe::hash::Hasher hasher;
+    hasher.update(nodes,    node_byte_count);
+    hasher.update(prim_ids, prim_id_byte_count);
+    return hasher.digest();
+}
+
+[[nodiscard]] auto get_process_id() -> uint64_t
+{
+#if defined(_WIN32)
+    return static_cast<uint64_t>(_getpid());
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+// Temporary file name unique across processes and threads sharing the cache directory
+[[nodiscard]] auto make_temp_path(const std::filesystem::path& path) -> std::filesystem::path
+{
+    static std::atomic<uint64_t> s_counter{0};
+    const uint64_t thread_hash = static_cast<uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    std::filesystem::path temp_path = path;
+    temp_path += fmt::format(".{}.{:x}.{}.tmp", get_process_id(), thread_hash, s_counter.fetch_add(1, std::memory_order_relaxed));
+    return temp_path;
+}
+
+[[nodiscard]] auto is_legacy_cache_file_name(const std::string& name) -> bool
+{
+    // Unversioned cache files were named by decimal hash only
+    return !name.empty() && std::all_of(name.begin(), name.end(), [](const char c) { return (c >= '0') && (c <= '9'); });
+}
+
+}
+
+auto Bvh_cache::get_instance() -> Bvh_cache&
+{
+    static Bvh_cache static_instance;
+    return static_instance;
+}
+
+Bvh_cache::Bvh_cache() = default;
+
+void Bvh_cache::set_directory(const std::filesystem::path& directory)
+{
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    m_directory = directory;
+    m_scanned   = false;
+    m_entries.clear();
+}
+
+void Bvh_cache::set_size_budget(const std::size_t byte_count)
+{
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    m_size_budget = byte_count;
+    if (m_scanned) {
+        evict();
+    }
+}
+
+auto Bvh_cache::get_statistics() const -> Bvh_cache_statistics
+{
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    return m_statistics;
+}
+
+auto Bvh_cache::get_path(const uint64_t source_hash, const uint64_t parameters_hash) const -> std::filesystem::path
+{
+    return m_directory / fmt::format("{:016x}_{:016x}.bvh", source_hash, parameters_hash);
+}
+
+void Bvh_cache::scan_directory()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    m_scanned = true;
+    m_entries.clear();
+
+    std::error_code error_code;
+    std::filesystem::directory_iterator iterator{m_directory, error_code};
+    if (error_code) {
+        return;
+    }
+    for (const auto& directory_entry : iterator) {
+        if (!directory_entry.is_regular_file(error_code)) {
+            continue;
+        }
+        const std::filesystem::path& path      = directory_entry.path();
+        const std::string            extension = erhe::file::to_string(path.extension());
+        if (extension == ".tmp") {
+            // Another process may be writing this right now; only remove leftovers from crashed writers
+            const auto last_write_time = directory_entry.last_write_time(error_code);
+            if (!error_code && (std::filesystem::file_time_type::clock::now() - last_write_time > c_stale_temp_age)) {
+                std::filesystem::remove(path, error_code);
+            }
+            continue;
+        }
+        if (extension.empty() && is_legacy_cache_file_name(erhe::file::to_string(path.filename()))) {
+            std::filesystem::remove(path, error_code);
+            continue;
+        }
+        if (extension != ".bvh") {
+            continue;
+        }
+        m_entries.push_back(
+            Entry{
+                .path        = path,
+                .byte_count  = static_cast<std::size_t>(directory_entry.file_size(error_code)),
+                .last_access = directory_entry.last_write_time(error_code)
+            }
+        );
+    }
+    evict();
+}
+
+void Bvh_cache::touch(const std::filesystem::path& path)
+{
+    const auto now = std::filesystem::file_time_type::clock::now();
+    std::error_code error_code;
+    std::filesystem::last_write_time(path, now, error_code);
+    for (Entry& entry : m_entries) {
+        if (entry.path == path) {
+            entry.last_access = now;
+            return;
+        }
+    }
+}
+
+void Bvh_cache::remove_entry(const std::filesystem::path& path)
+{
+    m_entries.erase(
+        std::remove_if(
+            m_entries.begin(),
+            m_entries.end(),
+            [&path](const Entry& entry) { return entry.path == path; }
+        ),
+        m_entries.end()
+    );
+    std::error_code error_code;
+    std::filesystem::remove(path, error_code);
+}
+
+void Bvh_cache::add_entry(const std::filesystem::path& path, const std::size_t byte_count)
+{
+    for (Entry& entry : m_entries) {
+        if (entry.path == path) {
+            entry.byte_count  = byte_count;
+            entry.last_access = std::filesystem::file_time_type::clock::now();
+            return;
+        }
+    }
+    m_entries.push_back(
+        Entry{
+            .path        = path,
+            .byte_count  = byte_count,
+            .last_access = std::filesystem::file_time_type::clock::now()
+        }
+    );
+}
+
+void Bvh_cache::evict()
+{
+    std::sort(
+        m_entries.begin(),
+        m_entries.end(),
+        [](const Entry& lhs, const Entry& rhs) { return lhs.last_access < rhs.last_access; }
+    );
+
+    std::size_t total_bytes = 0;
+    for (const Entry& entry : m_entries) {
+        total_bytes += entry.byte_count;
+    }
+
+    std::size_t evict_count = 0;
+    std::error_code error_code;
+    while ((total_bytes > m_size_budget) && (evict_count < m_entries.size())) {
+        const Entry& entry = m_entries[evict_count];
+        log_geometry->trace("BVH cache evicting {} ({} bytes)", erhe::file::to_string(entry.path), entry.byte_count);
+        std::filesystem::remove(entry.path, error_code);
+        total_bytes -= entry.byte_count;
+        ++evict_count;
+    }
+    m_entries.erase(m_entries.begin(), m_entries.begin() + evict_count);
+
+    m_statistics.evict_count += evict_count;
+    m_statistics.total_bytes  = total_bytes;
+}
+
+auto Bvh_cache::is_valid(const Bvh& bvh, const std::size_t triangle_count) -> bool
+{
+    // Each triangle is referenced exactly once by prim_ids
+    if (bvh.prim_ids.size() != triangle_count) {
+        return false;
+    }
+    for (const std::size_t prim_id : bvh.prim_ids) {
+        if (prim_id >= triangle_count) {
+            return false;
+        }
+    }
+    if (bvh.nodes.empty()) {
+        return triangle_count == 0;
+    }
+
+    // Walk from root; every node must be reached exactly once so that
+    // traversal terminates, and every child and primitive range must be in bounds
+    const std::size_t node_count = bvh.nodes.size();
+    std::vector<bool>        visited(node_count, false);
+    std::vector<std::size_t> node_stack{0};
+    std::size_t              visited_count = 0;
+    while (!node_stack.empty()) {
+        const std::size_t node_index = node_stack.back();
+        node_stack.pop_back();
+        if (visited[node_index]) {
+            return false;
+        }
+        visited[node_index] = true;
+        ++visited_count;
+
+        const Node&       node     = bvh.nodes[node_index];
+        const std::size_t first_id = static_cast<std::size_t>(node.index.first_id());
+        if (node.is_leaf()) {
+            const std::size_t prim_count = static_cast<std::size_t>(node.index.prim_count());
+            if ((first_id > triangle_count) || (prim_count > triangle_count - first_id)) {
+                return false;
+            }
+        } else {
+            if (first_id + 1 >= node_count) {
+                return false;
+            }
+            node_stack.push_back(first_id);
+            node_stack.push_back(first_id + 1);
+        }
+    }
+    return visited_count == node_count;
+}
+
+auto Bvh_cache::load(const uint64_t source_hash, const uint64_t parameters_hash, const std::size_t triangle_count, Bvh& bvh) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::filesystem::path path;
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        if (!m_scanned) {
+            scan_directory();
+        }
+        path = get_path(source_hash, parameters_hash);
+    }
+
+    erhe::file::Mapped_file file;
+    if (!file.open(path)) {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        ++m_statistics.miss_count;
+        return false;
+    }
+
+    const auto reject = [&](const char* reason) -> bool {
+        log_geometry->warn("BVH cache entry {} rejected: {}", erhe::file::to_string(path), reason);
+        file.close();
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        ++m_statistics.reject_count;
+        ++m_statistics.miss_count;
+        remove_entry(path);
+        return false;
+    };
+
+    const std::span<const std::byte> bytes = file.span();
+    if (bytes.size() < sizeof(Header)) {
+        return reject("truncated header");
+    }
+    Header header;
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if ((header.magic != c_magic) || (header.version != c_version)) {
+        return reject("format version mismatch");
+    }
+    if ((header.source_hash != source_hash) || (header.parameters_hash != parameters_hash)) {
+        return reject("key mismatch");
+    }
+    if (header.triangle_count != triangle_count) {
+        return reject("triangle count mismatch");
+    }
+    if ((header.node_size != sizeof(Node)) || (header.prim_id_size != sizeof(std::size_t))) {
+        return reject("element size mismatch");
+    }
+    const std::size_t payload_size = bytes.size() - sizeof(Header);
+    if (
+        (header.node_count    > payload_size / sizeof(Node)) ||
+        (header.prim_id_count > payload_size / sizeof(std::size_t))
+    ) {
+        return reject("element count out of range");
+    }
+    const std::size_t node_byte_count    = static_cast<std::size_t>(header.node_count)    * sizeof(Node);
+    const std::size_t prim_id_byte_count = static_cast<std::size_t>(header.prim_id_count) * sizeof(std::size_t);
+    if (payload_size != node_byte_count + prim_id_byte_count) {
+        return reject("size mismatch");
+    }
+    const std::byte* node_data    = bytes.data() + sizeof(Header);
+    const std::byte* prim_id_data = node_data + node_byte_count;
+    if (hash_payload(node_data, node_byte_count, prim_id_data, prim_id_byte_count) != header.payload_hash) {
+        return reject("payload hash mismatch");
+    }
+
+    // Single bulk copy from the mapping; no per-element deserialization
+    bvh.nodes   .resize(static_cast<std::size_t>(header.node_count));
+    bvh.prim_ids.resize(static_cast<std::size_t>(header.prim_id_count));
+    std::memcpy(bvh.nodes   .data(), node_data,    node_byte_count);
+    std::memcpy(bvh.prim_ids.data(), prim_id_data, prim_id_byte_count);
+    file.close();
+    if (!is_valid(bvh, triangle_count)) {
+        bvh = Bvh{};
+        return reject("node or primitive index out of range");
+    }
+
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    ++m_statistics.hit_count;
+    touch(path);
+    return true;
+}
+
+auto Bvh_cache::store(const uint64_t source_hash, const uint64_t parameters_hash, const std::size_t triangle_count, const Bvh& bvh) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!is_valid(bvh, triangle_count)) {
+        return false;
+    }
+
+    std::filesystem::path path;
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        if (!m_scanned) {
+            scan_directory();
+        }
+        path = get_path(source_hash, parameters_hash);
+    }
+
+    std::error_code error_code;
+    std::filesystem::create_directories(path.parent_path(), error_code);
+
+    const std::size_t node_byte_count    = bvh.nodes   .size() * sizeof(Node);
+    const std::size_t prim_id_byte_count = bvh.prim_ids.size() * sizeof(std::size_t);
+    const Header header{
+        .magic           = c_magic,
+        .version         = c_version,
+        .source_hash     = source_hash,
+        .parameters_hash = parameters_hash,
+        .triangle_count  = triangle_count,
+        .node_size       = static_cast<uint32_t>(sizeof(Node)),
+        .prim_id_size    = static_cast<uint32_t>(sizeof(std::size_t)),
+        .node_count      = bvh.nodes.size(),
+        .prim_id_count   = bvh.prim_ids.size(),
+        .payload_hash    = hash_payload(bvh.nodes.data(), node_byte_count, bvh.prim_ids.data(), prim_id_byte_count)
+    };
+
+    // Write to temporary file and rename, so readers never see partial entries
+    const std::filesystem::path temp_path = make_temp_path(path);
+    {
+        std::ofstream out{temp_path, std::ofstream::binary | std::ofstream::trunc};
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header),             sizeof(Header));
+        out.write(reinterpret_cast<const char*>(bvh.nodes.data()),    static_cast<std::streamsize>(node_byte_count));
+        out.write(reinterpret_cast<const char*>(bvh.prim_ids.data()), static_cast<std::streamsize>(prim_id_byte_count));
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temp_path, error_code);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, error_code);
+    if (error_code) {
+        std::filesystem::remove(temp_path, error_code);
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    ++m_statistics.store_count;
+    add_entry(path, sizeof(Header) + node_byte_count + prim_id_byte_count);
+    evict();
+    return true;
+}
+
+} // namespace erhe::raytrace
+
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif
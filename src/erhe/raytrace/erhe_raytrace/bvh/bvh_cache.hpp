@@ -0,0 +1,107 @@
+#pragma once
+
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable : 4702) // unreachable code
+#   pragma warning(disable : 4714) // marked as __forceinline not inlined
+#endif
+
+#include <bvh/v2/bvh.h>
+#include <bvh/v2/node.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace erhe::raytrace {
+
+class Bvh_cache_statistics
+{
+public:
+    uint64_t hit_count   {0};
+    uint64_t miss_count  {0};
+    uint64_t reject_count{0}; // Entries found but failed validation
+    uint64_t store_count {0};
+    uint64_t evict_count {0};
+    uint64_t total_bytes {0};
+};
+
+// On-disk cache of built BVHs.
+//
+// Each entry is a single file with a header recording format version,
+// source geometry hash, builder parameters hash and triangle count,
+// followed by raw node and primitive index arrays. Entries are memory
+// mapped and validated before use; every node and primitive index is
+// range checked, so a stale, colliding or corrupt entry is rejected
+// instead of causing out of bounds reads. Total cache size is kept under a byte budget by evicting
+// least recently used entries; file modification time is used as the
+// access time so that LRU order persists across sessions.
+class Bvh_cache
+{
+public:
+    using Bvh = bvh::v2::Bvh<bvh::v2::Node<float, 3>>;
+
+    static constexpr uint32_t    c_magic               = 0x48564245u; // "EBVH"
+    static constexpr uint32_t    c_version             = 3; // 2: erhe::hash::hash64 keys and payload hash, 3: triangle count
+    static constexpr std::size_t c_default_size_budget = std::size_t{512} * 1024 * 1024;
+    static constexpr auto        c_stale_temp_age      = std::chrono::hours{1}; // .tmp files older than this are removed on scan
+
+    [[nodiscard]] static auto get_instance() -> Bvh_cache&;
+
+    void set_directory  (const std::filesystem::path& directory);
+    void set_size_budget(std::size_t byte_count);
+
+    [[nodiscard]] auto load (uint64_t source_hash, uint64_t parameters_hash, std::size_t triangle_count, Bvh& bvh) -> bool;
+    auto               store(uint64_t source_hash, uint64_t parameters_hash, std::size_t triangle_count, const Bvh& bvh) -> bool;
+
+    [[nodiscard]] auto get_statistics() const -> Bvh_cache_statistics;
+
+private:
+    Bvh_cache();
+
+    class Header
+    {
+    public:
+        uint32_t magic          {0};
+        uint32_t version        {0};
+        uint64_t source_hash    {0};
+        uint64_t parameters_hash{0};
+        uint64_t triangle_count {0};
+        uint32_t node_size      {0};
+        uint32_t prim_id_size   {0};
+        uint64_t node_count     {0};
+        uint64_t prim_id_count  {0};
+        uint64_t payload_hash   {0};
+    };
+
+    class Entry
+    {
+    public:
+        std::filesystem::path           path;
+        std::size_t                     byte_count{0};
+        std::filesystem::file_time_type last_access;
+    };
+
+    [[nodiscard]] static auto is_valid(const Bvh& bvh, std::size_t triangle_count) -> bool;
+    [[nodiscard]] auto get_path(uint64_t source_hash, uint64_t parameters_hash) const -> std::filesystem::path;
+    void scan_directory();
+    void touch         (const std::filesystem::path& path);
+    void remove_entry  (const std::filesystem::path& path);
+    void add_entry     (const std::filesystem::path& path, std::size_t byte_count);
+    void evict         ();
+
+    mutable std::mutex    m_mutex;
+    std::filesystem::path m_directory  {"cache/bvh"};
+    std::size_t           m_size_budget{c_default_size_budget};
+    bool                  m_scanned    {false};
+    std::vector<Entry>    m_entries;
+    Bvh_cache_statistics  m_statistics;
+};
+
+} // namespace erhe::raytrace
+
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif
@@ -6,16 +6,21 @@
 
 #include <fmt/chrono.h>
 
+#include "erhe_raytrace/bvh/bvh_cache.hpp"
 #include "erhe_raytrace/bvh/bvh_geometry.hpp"
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
+#include "erhe_raytrace/bvh/bvh_ray_packet.hpp"
+#include "erhe_raytrace/bvh/bvh_scene.hpp"
 #include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/ibuffer.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
 
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_hash/hash.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_time/timer.hpp"
+#include "erhe_verify/verify.hpp"
 
 #include <bvh/v2/bvh.h>
 #include <bvh/v2/default_builder.h>
@@ -25,47 +30,10 @@
 #include <bvh/v2/stack.h>
 #include <bvh/v2/thread_pool.h>
 
-#include <fstream>
+#include <algorithm>
 
 namespace erhe::raytrace {
 
-using Bvh = bvh::v2::Bvh<bvh::v2::Node<float, 3>>;
-
-// TODO Add versioning
-auto save_bvh(const Bvh& bvh, const uint64_t hash_code) -> bool
-{
-    std::string file_name = fmt::format("cache/bvh/{}", hash_code);
-    std::ofstream out{file_name, std::ofstream::binary};
-    if (!out) {
-        return false;
-    }
-
-    try {
-        bvh::v2::StdOutputStream stream{out};
-        bvh.serialize(stream);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
-// TODO Add versioning
-auto load_bvh(Bvh& bvh, const uint64_t hash_code) -> bool
-{
-    std::string file_name = fmt::format("cache/bvh/{}", hash_code);
-    std::ifstream in{file_name, std::ofstream::binary};
-    if (!in) {
-        return false;
-    }
-    try {
-        bvh::v2::StdInputStream stream{in};
-        bvh = Bvh::deserialize(stream);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
 auto IGeometry::create(const std::string_view debug_label, const Geometry_type geometry_type) -> IGeometry*
 {
     return new Bvh_geometry(debug_label, geometry_type);
@@ -87,7 +55,29 @@ Bvh_geometry::Bvh_geometry(const std::string_view debug_label, const Geometry_ty
     static_cast<void>(geometry_type);
 }
 
-Bvh_geometry::~Bvh_geometry() noexcept = default;
+Bvh_geometry::~Bvh_geometry() noexcept
+{
+    // Detaching removes scene from m_owner_scenes
+    while (!m_owner_scenes.empty()) {
+        m_owner_scenes.back()->detach(this);
+    }
+}
+
+void Bvh_geometry::add_owner_scene(Bvh_scene* owner_scene)
+{
+    m_owner_scenes.push_back(owner_scene);
+}
+
+void Bvh_geometry::remove_owner_scene(Bvh_scene* owner_scene)
+{
+    // Shared geometry can have many owners; most recently added are
+    // typically removed first
+    const auto i = std::find(m_owner_scenes.rbegin(), m_owner_scenes.rend(), owner_scene);
+    if (i != m_owner_scenes.rend()) {
+        *i = m_owner_scenes.back();
+        m_owner_scenes.pop_back();
+    }
+}
 
 using Scalar         = float;
 using Vec3           = bvh::v2::Vec<Scalar, 3>;
@@ -99,6 +89,15 @@ using PrecomputedTri = bvh::v2::PrecomputedTri<Scalar>;
 
 static constexpr bool should_permute = true; // TODO
 
+// BVH builder settings. Every setting which affects the built tree is
+// included in the cache parameters hash.
+static constexpr auto        c_build_quality        = bvh::v2::DefaultBuilder<Node>::Quality::High; // TODO Low
+static constexpr std::size_t c_min_leaf_size        = 1;
+static constexpr std::size_t c_max_leaf_size        = 8;
+static constexpr std::size_t c_sah_log_cluster_size = 0;
+static constexpr Scalar      c_sah_cost_ratio       = 1.0f;
+static constexpr std::size_t c_parallel_threshold   = 1024;
+
 class Executor_resources
 {
 public:
@@ -107,21 +106,31 @@ public:
         return static_instance;
     }
 
-    auto get_thread_pool() -> bvh::v2::ThreadPool&       { return m_thread_pool; }
-    auto get_executor   () -> bvh::v2::ParallelExecutor& { return m_executor; }
+    auto get_thread_pool() -> bvh::v2::ThreadPool& { return m_thread_pool; }
 
 private:
-    Executor_resources() : m_thread_pool{}, m_executor{m_thread_pool} {}
+    Executor_resources()
+        : m_thread_pool{erhe::concurrency::Thread_pool::get_instance().get_thread_count()}
+    {
+    }
     ~Executor_resources(){};
 
-    bvh::v2::ThreadPool       m_thread_pool;
-    bvh::v2::ParallelExecutor m_executor;
+    // Only used by bvh::v2::DefaultBuilder, which requires the concrete
+    // bvh::v2::ThreadPool type. It is sized from the engine thread pool
+    // rather than hardware concurrency; other parallel work runs on
+    // erhe::concurrency::Thread_pool directly.
+    bvh::v2::ThreadPool m_thread_pool;
 };
 
 void Bvh_geometry::commit()
 {
     ERHE_PROFILE_FUNCTION();
 
+    // Bounds may change; owner scenes propagate this to scenes instancing them
+    for (Bvh_scene* owner_scene : m_owner_scenes) {
+        owner_scene->mark_bounds_dirty();
+    }
+
     {
         const Buffer_info* index_buffer_info{nullptr};
         const Buffer_info* vertex_buffer_info{nullptr};
@@ -164,8 +173,9 @@ void Bvh_geometry::commit()
         const std::size_t triangle_count = index_buffer_info->item_count;
 
         std::vector<Tri> tris;
+        tris.reserve(triangle_count);
 
-        uint64_t hash_code{0xcbf29ce484222325};
+        uint64_t hash_code{0};
         std::vector<BBox> bboxes(triangle_count);
         std::vector<Vec3> centers(triangle_count);
         {
@@ -176,21 +186,17 @@ void Bvh_geometry::commit()
                 const uint32_t i1 = *reinterpret_cast<const uint32_t*>(raw_index_ptr + i * index_buffer_info->byte_stride + 1 * sizeof(uint32_t));
                 const uint32_t i2 = *reinterpret_cast<const uint32_t*>(raw_index_ptr + i * index_buffer_info->byte_stride + 2 * sizeof(uint32_t));
 
-                const float p0_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * index_buffer_info->byte_stride + 0 * sizeof(float));
-                const float p0_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * index_buffer_info->byte_stride + 1 * sizeof(float));
-                const float p0_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * index_buffer_info->byte_stride + 2 * sizeof(float));
-
-                const float p1_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * index_buffer_info->byte_stride + 0 * sizeof(float));
-                const float p1_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * index_buffer_info->byte_stride + 1 * sizeof(float));
-                const float p1_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * index_buffer_info->byte_stride + 2 * sizeof(float));
+                const float p0_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * vertex_buffer_info->byte_stride + 0 * sizeof(float));
+                const float p0_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * vertex_buffer_info->byte_stride + 1 * sizeof(float));
+                const float p0_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i0 * vertex_buffer_info->byte_stride + 2 * sizeof(float));
 
-                const float p2_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * index_buffer_info->byte_stride + 0 * sizeof(float));
-                const float p2_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * index_buffer_info->byte_stride + 1 * sizeof(float));
-                const float p2_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * index_buffer_info->byte_stride + 2 * sizeof(float));
+                const float p1_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * vertex_buffer_info->byte_stride + 0 * sizeof(float));
+                const float p1_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * vertex_buffer_info->byte_stride + 1 * sizeof(float));
+                const float p1_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i1 * vertex_buffer_info->byte_stride + 2 * sizeof(float));
 
-                hash_code = erhe::hash::hash(p0_x, p0_y, p0_z, hash_code);
-                hash_code = erhe::hash::hash(p1_x, p1_y, p1_z, hash_code);
-                hash_code = erhe::hash::hash(p2_x, p2_y, p2_z, hash_code);
+                const float p2_x = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * vertex_buffer_info->byte_stride + 0 * sizeof(float));
+                const float p2_y = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * vertex_buffer_info->byte_stride + 1 * sizeof(float));
+                const float p2_z = *reinterpret_cast<const float*>(raw_vertex_ptr + i2 * vertex_buffer_info->byte_stride + 2 * sizeof(float));
 
                 const bvh::v2::Tri<float, 3> triangle{
                     Vec3{p2_x, p2_y, p2_z},
@@ -201,16 +207,38 @@ void Bvh_geometry::commit()
                 bboxes[i] = triangle.get_bbox();
                 centers[i] = triangle.get_center();
             }
+
+            // Single bulk hash over gathered triangle positions
+            static_assert(sizeof(Tri) == 9 * sizeof(Scalar), "Tri must be tightly packed to be hashed as bytes");
+            hash_code = erhe::hash::hash64(std::span<const Tri>{tris});
             log_geometry->trace("BVH hash for {} : {:x}", debug_label(), hash_code);
         }
 
         Executor_resources& executor_resources = Executor_resources::get_instance();
 
-        const bool load_ok = load_bvh(m_bvh, hash_code);
+        typename bvh::v2::DefaultBuilder<Node>::Config config;
+        config.quality            = c_build_quality;
+        config.min_leaf_size      = c_min_leaf_size;
+        config.max_leaf_size      = c_max_leaf_size;
+        config.sah                = bvh::v2::SplitHeuristic<Scalar>{c_sah_log_cluster_size, c_sah_cost_ratio};
+        config.parallel_threshold = c_parallel_threshold;
+
+        // Cache entries are keyed by both geometry and builder settings
+        erhe::hash::Hasher parameters_hasher;
+        parameters_hasher.update_value(c_build_quality);
+        parameters_hasher.update_value(c_min_leaf_size);
+        parameters_hasher.update_value(c_max_leaf_size);
+        parameters_hasher.update_value(c_sah_log_cluster_size);
+        parameters_hasher.update_value(c_sah_cost_ratio);
+        parameters_hasher.update_value(c_parallel_threshold);
+        parameters_hasher.update_value(should_permute);
+        parameters_hasher.update_value(sizeof(Node));
+        const uint64_t parameters_hash = parameters_hasher.digest();
+
+        Bvh_cache& bvh_cache = Bvh_cache::get_instance();
+        const bool load_ok = bvh_cache.load(hash_code, parameters_hash, tris.size(), m_bvh);
         if (!load_ok)
         {
-            typename bvh::v2::DefaultBuilder<Node>::Config config;
-            config.quality = bvh::v2::DefaultBuilder<Node>::Quality::High; // TODO Low
 
             {
                 ERHE_PROFILE_SCOPE("bvh build");
@@ -229,7 +257,7 @@ void Bvh_geometry::commit()
                 log_geometry->trace("BVH build {} in {} ms", debug_label(), time);
             }
 
-            const bool save_ok = save_bvh(m_bvh, hash_code);
+            const bool save_ok = bvh_cache.store(hash_code, parameters_hash, tris.size(), m_bvh);
             if (!save_ok) {
                 log_geometry->warn("BVH save failed, hash = {}", hash_code);
             }
@@ -241,7 +269,7 @@ void Bvh_geometry::commit()
             m_precomputed_triangles.clear();
             m_precomputed_triangles.resize(tris.size());
 
-            executor_resources.get_executor().for_each(
+            erhe::concurrency::Thread_pool::get_instance().parallel_for(
                 0,
                 tris.size(),
                 [&] (const size_t begin, const size_t end) {
@@ -361,6 +389,81 @@ auto Bvh_geometry::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* instance
     return false;
 }
 
+void Bvh_geometry::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    intersect_instance(rays, hits, nullptr);
+}
+
+void Bvh_geometry::intersect_instance(std::span<Ray> rays, std::span<Hit> hits, Bvh_instance* instance)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(rays.size() == hits.size());
+    if (!m_enabled || m_bvh.nodes.empty()) {
+        return;
+    }
+
+    const auto transform = (instance != nullptr) ? instance->get_transform() : glm::mat4{1.0};
+
+    for (std::size_t offset = 0, end = rays.size(); offset < end; offset += Ray_packet::c_size) {
+        const std::size_t count       = std::min(Ray_packet::c_size, end - offset);
+        std::span<Ray>    packet_rays = rays.subspan(offset, count);
+        std::span<Hit>    packet_hits = hits.subspan(offset, count);
+
+        Ray_packet packet;
+        packet.load(packet_rays);
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            if ((packet_rays[lane].mask & m_mask) == 0) {
+                packet.deactivate(lane);
+            }
+        }
+
+        traverse_packet(
+            m_bvh,
+            packet,
+            [&](const std::size_t i, const uint32_t lane_mask) -> uint32_t {
+                const std::size_t triangle_index = should_permute ? i : m_bvh.prim_ids[i];
+                const auto&       triangle       = m_precomputed_triangles[triangle_index];
+                uint32_t hit_mask = 0;
+                for (std::size_t lane = 0; lane < count; ++lane) {
+                    if ((lane_mask & (1u << lane)) == 0) {
+                        continue;
+                    }
+                    Ray& ray = packet_rays[lane];
+                    bvh::v2::Ray<Scalar, 3> bvh_ray{
+                        to_bvh(ray.origin),
+                        to_bvh(ray.direction),
+                        ray.t_near,
+                        ray.t_far
+                    };
+                    if (auto uv = triangle.intersect(bvh_ray)) {
+                        Hit& hit = packet_hits[lane];
+                        ray.t_far       = bvh_ray.tmax;
+                        hit.triangle_id = static_cast<unsigned int>(m_bvh.prim_ids[i]);
+                        hit.uv          = glm::vec2{uv->first, uv->second};
+                        hit.normal      = glm::vec3{transform * glm::vec4{from_bvh(triangle.n), 0.0f}};
+                        hit.instance    = instance;
+                        hit.geometry    = this;
+                        hit_mask |= (1u << lane);
+                    }
+                }
+                return hit_mask;
+            },
+            [&](const std::size_t lane) -> float {
+                return packet_rays[lane].t_far;
+            }
+        );
+    }
+}
+
+auto Bvh_geometry::get_bbox() const -> bvh::v2::BBox<float, 3>
+{
+    if (m_bvh.nodes.empty()) {
+        return bvh::v2::BBox<float, 3>::make_empty();
+    }
+    return m_bvh.get_root().get_bbox();
+}
+
 /// auto Bvh_geometry::get_sphere() const -> const erhe::math::Bounding_sphere&
 /// {
 ///     return m_bounding_sphere;
@@ -45,6 +45,7 @@ public:
         std::size_t  item_count
     ) override;
     void set_user_data(const void* ptr) override;
+    void intersect    (std::span<Ray> rays, std::span<Hit> hits) override;
     auto get_mask     () const -> uint32_t         override;
     auto get_user_data() const -> const void*      override;
     auto is_enabled   () const -> bool             override;
@@ -52,6 +53,10 @@ public:
 
     // Bvh_geometry public API
     auto intersect_instance(Ray& ray, Hit& hit, Bvh_instance* instance) -> bool;
+    void intersect_instance(std::span<Ray> rays, std::span<Hit> hits, Bvh_instance* instance);
+    [[nodiscard]] auto get_bbox() const -> bvh::v2::BBox<float, 3>;
+    void add_owner_scene   (Bvh_scene* owner_scene);
+    void remove_owner_scene(Bvh_scene* owner_scene);
 
 private:
     class Buffer_info
@@ -74,6 +79,7 @@ private:
     unsigned int m_vertex_attribute_count{0};
 
     std::vector<Buffer_info> m_buffer_infos;
+    std::vector<Bvh_scene*>  m_owner_scenes; // Scenes this geometry is attached to
 
     std::vector<bvh::v2::PrecomputedTri<float>> m_precomputed_triangles;
     bvh::v2::Bvh<bvh::v2::Node<float, 3>>       m_bvh;
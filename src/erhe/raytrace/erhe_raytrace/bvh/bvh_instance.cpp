@@ -1,12 +1,16 @@
  #include "erhe_raytrace/bvh/bvh_instance.hpp"
 #include "erhe_log/log_glm.hpp"
+#include "erhe_raytrace/bvh/bvh_ray_packet.hpp"
 #include "erhe_raytrace/bvh/bvh_scene.hpp"
+#include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/iscene.hpp"
 #include "erhe_raytrace/ray.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <array>
+
 namespace erhe::raytrace
 {
 
@@ -34,6 +38,12 @@ Bvh_instance::Bvh_instance(const std::string_view debug_label)
 Bvh_instance::~Bvh_instance() noexcept
 {
     log_instance->trace("Destroyed Bvh_instance {}", m_debug_label);
+    if (m_owner_scene != nullptr) {
+        m_owner_scene->detach(this);
+    }
+    if (m_scene != nullptr) {
+        reinterpret_cast<Bvh_scene*>(m_scene)->remove_referencing_instance(this);
+    }
 }
 
 void Bvh_instance::commit()
@@ -61,11 +71,60 @@ void Bvh_instance::set_transform(const glm::mat4 transform)
 {
     //log_frame->trace("Bvh_instance::set_transform {}", m_debug_label);
     m_transform = transform;
+    mark_owner_scene_bounds_dirty();
 }
 
 void Bvh_instance::set_scene(IScene* scene)
 {
+    if (m_scene == scene) {
+        return;
+    }
+    if (m_scene != nullptr) {
+        reinterpret_cast<Bvh_scene*>(m_scene)->remove_referencing_instance(this);
+    }
     m_scene = scene;
+    if (m_scene != nullptr) {
+        reinterpret_cast<Bvh_scene*>(m_scene)->add_referencing_instance(this);
+    }
+    mark_owner_scene_bounds_dirty();
+}
+
+void Bvh_instance::mark_owner_scene_bounds_dirty()
+{
+    if (m_owner_scene != nullptr) {
+        m_owner_scene->mark_bounds_dirty();
+    }
+}
+
+void Bvh_instance::set_owner_scene(Bvh_scene* owner_scene)
+{
+    m_owner_scene = owner_scene;
+}
+
+auto Bvh_instance::get_world_bbox() const -> bvh::v2::BBox<float, 3>
+{
+    using BBox = bvh::v2::BBox<float, 3>;
+    if (m_scene == nullptr) {
+        return BBox::make_empty();
+    }
+    const auto* bvh_scene  = reinterpret_cast<const Bvh_scene*>(m_scene);
+    const BBox  local_bbox = bvh_scene->get_local_bbox();
+    if (local_bbox.min[0] > local_bbox.max[0]) {
+        return BBox::make_empty();
+    }
+
+    BBox world_bbox = BBox::make_empty();
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec4 local_position{
+            ((corner & 1) != 0) ? local_bbox.max[0] : local_bbox.min[0],
+            ((corner & 2) != 0) ? local_bbox.max[1] : local_bbox.min[1],
+            ((corner & 4) != 0) ? local_bbox.max[2] : local_bbox.min[2],
+            1.0f
+        };
+        const glm::vec3 world_position{m_transform * local_position};
+        world_bbox.extend(to_bvh(world_position));
+    }
+    return world_bbox;
 }
 
 void Bvh_instance::set_mask(const uint32_t mask)
@@ -103,6 +162,50 @@ auto Bvh_instance::intersect(Ray& ray, Hit& hit) -> bool
     return is_hit;
 }
 
+void Bvh_instance::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(rays.size() == hits.size());
+    if (!m_enabled || (m_scene == nullptr)) {
+        return;
+    }
+
+    // Gather rays passing the mask test into instance local space,
+    // one packet at a time to avoid heap allocations
+    const auto inverse_transform = glm::inverse(get_transform());
+    auto*      bvh_scene         = reinterpret_cast<Bvh_scene*>(m_scene);
+    for (std::size_t offset = 0, end = rays.size(); offset < end; offset += Ray_packet::c_size) {
+        std::array<std::size_t, Ray_packet::c_size> ray_indices;
+        std::array<Ray,         Ray_packet::c_size> local_rays;
+        std::array<Hit,         Ray_packet::c_size> local_hits;
+        std::size_t count = 0;
+        for (std::size_t i = offset, packet_end = std::min(end, offset + Ray_packet::c_size); i < packet_end; ++i) {
+            if ((rays[i].mask & m_mask) == 0) {
+                continue;
+            }
+            ray_indices[count] = i;
+            local_rays [count] = rays[i].transform(inverse_transform);
+            local_hits [count] = hits[i];
+            ++count;
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        bvh_scene->intersect_instance(
+            std::span<Ray>{local_rays.data(), count},
+            std::span<Hit>{local_hits.data(), count},
+            this
+        );
+
+        for (std::size_t i = 0; i < count; ++i) {
+            rays[ray_indices[i]].t_far = local_rays[i].t_far;
+            hits[ray_indices[i]]       = local_hits[i];
+        }
+    }
+}
+
 #if 0
 void Bvh_instance::collect_spheres(
     std::vector<bvh::Sphere<float>>& spheres,
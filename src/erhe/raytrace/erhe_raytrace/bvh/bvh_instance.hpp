@@ -4,6 +4,8 @@
 
 #include <glm/glm.hpp>
 
+#include <bvh/v2/bbox.h>
+
 #include <string>
 
 namespace erhe::raytrace {
@@ -24,6 +26,7 @@ public:
     void set_scene    (IScene* scene)              override;
     void set_mask     (uint32_t mask)              override;
     void set_user_data(void* ptr)                  override;
+    void intersect    (std::span<Ray> rays, std::span<Hit> hits) override;
     auto get_transform() const -> glm::mat4        override;
     auto get_scene    () const -> IScene*          override;
     auto get_mask     () const -> uint32_t         override;
@@ -32,14 +35,18 @@ public:
     auto debug_label  () const -> std::string_view override;
 
     // Bvh_instance public API
-    auto intersect(Ray& ray, Hit& hit) -> bool;
+    auto intersect          (Ray& ray, Hit& hit) -> bool;
+    void set_owner_scene    (Bvh_scene* owner_scene);
+    void mark_owner_scene_bounds_dirty();
+    [[nodiscard]] auto get_world_bbox() const -> bvh::v2::BBox<float, 3>;
 
 private:
-    glm::mat4   m_transform{1.0f};
-    bool        m_enabled  {true};
-    IScene*     m_scene    {nullptr};
-    uint32_t    m_mask     {0xffffffffu};
-    void*       m_user_data{nullptr};
+    glm::mat4   m_transform  {1.0f};
+    bool        m_enabled    {true};
+    IScene*     m_scene      {nullptr};
+    Bvh_scene*  m_owner_scene{nullptr}; // Scene this instance is attached to
+    uint32_t    m_mask       {0xffffffffu};
+    void*       m_user_data  {nullptr};
     std::string m_debug_label;
 };
 
@@ -0,0 +1,217 @@
+#pragma once
+
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable : 4702) // unreachable code
+#   pragma warning(disable : 4714) // marked as __forceinline not inlined
+#endif
+
+#include "erhe_raytrace/ray.hpp"
+
+#include <bvh/v2/bvh.h>
+#include <bvh/v2/node.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace erhe::raytrace {
+
+// Structure-of-arrays ray packet. Slab tests loop over lanes with
+// no data dependencies, which compilers turn into SIMD code.
+class Ray_packet
+{
+public:
+    static constexpr std::size_t c_size = 8;
+
+    void load(std::span<const Ray> rays)
+    {
+        count = std::min(rays.size(), c_size);
+        for (std::size_t i = 0; i < count; ++i) {
+            const Ray& ray = rays[i];
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                origin       [axis][i] = ray.origin[static_cast<glm::length_t>(axis)];
+                inv_direction[axis][i] = 1.0f / ray.direction[static_cast<glm::length_t>(axis)];
+            }
+            t_min[i] = ray.t_near;
+            t_max[i] = ray.t_far;
+        }
+        // Inactive lanes never hit anything
+        for (std::size_t i = count; i < c_size; ++i) {
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                origin       [axis][i] = 0.0f;
+                inv_direction[axis][i] = 1.0f;
+            }
+            t_min[i] = 1.0f;
+            t_max[i] = 0.0f;
+        }
+    }
+
+    void deactivate(const std::size_t lane)
+    {
+        t_min[lane] = 1.0f;
+        t_max[lane] = 0.0f;
+    }
+
+    [[nodiscard]] auto get_active_mask() const -> uint32_t
+    {
+        uint32_t mask = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (t_min[i] <= t_max[i]) {
+                mask |= (1u << i);
+            }
+        }
+        return mask;
+    }
+
+    std::array<std::array<float, c_size>, 3> origin;
+    std::array<std::array<float, c_size>, 3> inv_direction;
+    std::array<float, c_size>                t_min;
+    std::array<float, c_size>                t_max;
+    std::size_t                              count{0};
+};
+
+// Node index stack for traverse_packet(). Typical depths fit in the inline
+// array; deeper (degenerate) trees spill to the heap instead of dropping nodes.
+class Packet_traversal_stack
+{
+public:
+    static constexpr std::size_t c_inline_size = 64;
+
+    void push(const std::size_t node_index)
+    {
+        if (m_size < c_inline_size) {
+            m_inline[m_size] = node_index;
+        } else {
+            m_overflow.push_back(node_index);
+        }
+        ++m_size;
+    }
+
+    [[nodiscard]] auto pop() -> std::size_t
+    {
+        --m_size;
+        if (m_size < c_inline_size) {
+            return m_inline[m_size];
+        }
+        const std::size_t node_index = m_overflow.back();
+        m_overflow.pop_back();
+        return node_index;
+    }
+
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return m_size == 0;
+    }
+
+private:
+    std::array<std::size_t, c_inline_size> m_inline;
+    std::vector<std::size_t>               m_overflow;
+    std::size_t                            m_size{0};
+};
+
+// Returns bitmask of packet lanes intersecting bbox, and nearest entry distance
+template <typename BBox>
+[[nodiscard]] inline auto intersect_packet_bbox(const Ray_packet& packet, const BBox& bbox, float& out_t_entry) -> uint32_t
+{
+    std::array<float, Ray_packet::c_size> t_entry = packet.t_min;
+    std::array<float, Ray_packet::c_size> t_exit  = packet.t_max;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        const float bbox_min = bbox.min[axis];
+        const float bbox_max = bbox.max[axis];
+        for (std::size_t i = 0; i < Ray_packet::c_size; ++i) {
+            const float t0 = (bbox_min - packet.origin[axis][i]) * packet.inv_direction[axis][i];
+            const float t1 = (bbox_max - packet.origin[axis][i]) * packet.inv_direction[axis][i];
+            t_entry[i] = std::max(t_entry[i], std::min(t0, t1));
+            t_exit [i] = std::min(t_exit [i], std::max(t0, t1));
+        }
+    }
+    uint32_t mask = 0;
+    float    nearest = std::numeric_limits<float>::max();
+    for (std::size_t i = 0; i < Ray_packet::c_size; ++i) {
+        if (t_entry[i] <= t_exit[i]) {
+            mask |= (1u << i);
+            nearest = std::min(nearest, t_entry[i]);
+        }
+    }
+    out_t_entry = nearest;
+    return mask;
+}
+
+// Traverses the BVH with all packet lanes at once. A subtree is visited
+// if any lane hits its bounds. leaf_function(prim_index, lane_mask) is
+// called for each primitive in a leaf, with the lanes hitting that leaf.
+// It returns the mask of lanes that hit the primitive; t_max of those
+// lanes is refreshed through get_t_far(lane) so that farther subtrees
+// get culled.
+template <typename Node, typename Leaf_function, typename T_far_function>
+void traverse_packet(
+    const bvh::v2::Bvh<Node>& bvh,
+    Ray_packet&               packet,
+    Leaf_function&&           leaf_function,
+    T_far_function&&          get_t_far
+)
+{
+    // Packets with no active lanes (empty, or all lanes deactivated, for
+    // example by ray mask) skip traversal
+    if (bvh.nodes.empty() || (packet.get_active_mask() == 0)) {
+        return;
+    }
+
+    Packet_traversal_stack stack;
+
+    float root_t{0.0f};
+    if (intersect_packet_bbox(packet, bvh.nodes[0].get_bbox(), root_t) == 0) {
+        return;
+    }
+    stack.push(0);
+
+    while (!stack.empty()) {
+        const Node& node = bvh.nodes[stack.pop()];
+        float node_t{0.0f};
+        const uint32_t node_mask = intersect_packet_bbox(packet, node.get_bbox(), node_t);
+        if (node_mask == 0) {
+            continue;
+        }
+
+        const std::size_t first_id = node.index.first_id();
+        if (node.is_leaf()) {
+            for (std::size_t i = first_id, end = first_id + node.index.prim_count(); i < end; ++i) {
+                const uint32_t hit_mask = leaf_function(i, node_mask);
+                for (std::size_t lane = 0; lane < packet.count; ++lane) {
+                    if ((hit_mask & (1u << lane)) != 0) {
+                        packet.t_max[lane] = get_t_far(lane);
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Push farther child first so that nearer child is visited first
+        float left_t {0.0f};
+        float right_t{0.0f};
+        const uint32_t left_mask  = intersect_packet_bbox(packet, bvh.nodes[first_id    ].get_bbox(), left_t);
+        const uint32_t right_mask = intersect_packet_bbox(packet, bvh.nodes[first_id + 1].get_bbox(), right_t);
+        const bool     left_first = left_t <= right_t;
+        const std::size_t near_id   = left_first ? first_id     : first_id + 1;
+        const std::size_t far_id    = left_first ? first_id + 1 : first_id;
+        const uint32_t    near_mask = left_first ? left_mask    : right_mask;
+        const uint32_t    far_mask  = left_first ? right_mask   : left_mask;
+        if (far_mask != 0) {
+            stack.push(far_id);
+        }
+        if (near_mask != 0) {
+            stack.push(near_id);
+        }
+    }
+}
+
+} // namespace erhe::raytrace
+
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#endif
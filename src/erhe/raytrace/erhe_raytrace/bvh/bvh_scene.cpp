@@ -8,14 +8,47 @@
 #include "erhe_log/log_glm.hpp"
 #include "erhe_raytrace/bvh/bvh_geometry.hpp"
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
+#include "erhe_raytrace/bvh/bvh_ray_packet.hpp"
+#include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/iinstance.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <bvh/v2/default_builder.h>
+#include <bvh/v2/ray.h>
+#include <bvh/v2/stack.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace erhe::raytrace {
 
+namespace {
+
+using BBox = bvh::v2::BBox<float, 3>;
+using Vec3 = bvh::v2::Vec<float, 3>;
+
+[[nodiscard]] auto is_empty(const BBox& bbox) -> bool
+{
+    return bbox.min[0] > bbox.max[0];
+}
+
+[[nodiscard]] auto is_same(const BBox& lhs, const BBox& rhs) -> bool
+{
+    for (std::size_t i = 0; i < 3; ++i) {
+        if ((lhs.min[i] != rhs.min[i]) || (lhs.max[i] != rhs.max[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
 auto IScene::create(const std::string_view debug_label) -> IScene*
 {
     return new Bvh_scene(debug_label);
@@ -40,6 +73,17 @@ Bvh_scene::Bvh_scene(const std::string_view debug_label)
 Bvh_scene::~Bvh_scene() noexcept
 {
     log_scene->trace("Destroyed Bvh_scene '{}'", m_debug_label);
+
+    for (Bvh_geometry* geometry : m_geometries) {
+        geometry->remove_owner_scene(this);
+    }
+    for (Bvh_instance* instance : m_instances) {
+        instance->set_owner_scene(nullptr);
+    }
+    // set_scene() removes instance from m_referencing_instances
+    while (!m_referencing_instances.empty()) {
+        m_referencing_instances.back()->set_scene(nullptr);
+    }
 }
 
 void Bvh_scene::attach(IGeometry* geometry)
@@ -58,6 +102,9 @@ void Bvh_scene::attach(IGeometry* geometry)
 #endif
     {
         m_geometries.push_back(bvh_geometry);
+        bvh_geometry->add_owner_scene(this);
+        m_structure_dirty = true;
+        mark_bounds_dirty();
     }
 }
 
@@ -77,6 +124,9 @@ void Bvh_scene::attach(IInstance* instance)
 #endif
     {
         m_instances.push_back(bvh_instance);
+        bvh_instance->set_owner_scene(this);
+        m_structure_dirty = true;
+        mark_bounds_dirty();
     }
 }
 
@@ -93,6 +143,9 @@ void Bvh_scene::detach(IGeometry* geometry)
         log_scene->error("raytrace geometry not in scene");
     } else {
         m_geometries.erase(i, m_geometries.end());
+        bvh_geometry->remove_owner_scene(this);
+        m_structure_dirty = true;
+        mark_bounds_dirty();
     }
 }
 
@@ -109,50 +162,231 @@ void Bvh_scene::detach(IInstance* instance)
         log_scene->error("raytrace instance not in scene");
     } else {
         m_instances.erase(i, m_instances.end());
+        bvh_instance->set_owner_scene(nullptr);
+        m_structure_dirty = true;
+        mark_bounds_dirty();
     }
 }
 
-void Bvh_scene::commit()
+void Bvh_scene::mark_bounds_dirty()
 {
-    // TODO
+    // No early out when already dirty; scenes instancing this scene
+    // may have committed since
+    m_bounds_dirty = true;
+    for (Bvh_instance* instance : m_referencing_instances) {
+        instance->mark_owner_scene_bounds_dirty();
+    }
 }
 
-auto Bvh_scene::intersect(Ray& ray, Hit& hit) -> bool
+void Bvh_scene::add_referencing_instance(Bvh_instance* instance)
 {
-    log_frame->trace(
-        "Bvh_scene {} intersect mask = {:04x} instances = {}, geometries = {}, ray origin = {}, direction = {}",
-        m_debug_label, ray.mask, m_instances.size(), m_geometries.size(), ray.origin, ray.direction
-    );
+    m_referencing_instances.push_back(instance);
+}
 
+void Bvh_scene::remove_referencing_instance(Bvh_instance* instance)
+{
+    const auto i = std::find(m_referencing_instances.begin(), m_referencing_instances.end(), instance);
+    if (i != m_referencing_instances.end()) {
+        m_referencing_instances.erase(i);
+    }
+}
+
+auto Bvh_scene::get_leaf_bbox(const std::size_t leaf_index) const -> BBox
+{
+    if (leaf_index < m_instances.size()) {
+        return m_instances[leaf_index]->get_world_bbox();
+    }
+    return m_geometries[leaf_index - m_instances.size()]->get_bbox();
+}
+
+auto Bvh_scene::get_local_bbox() const -> BBox
+{
+    BBox bbox = BBox::make_empty();
+    const std::size_t leaf_count = m_instances.size() + m_geometries.size();
+    for (std::size_t i = 0; i < leaf_count; ++i) {
+        const BBox leaf_bbox = get_leaf_bbox(i);
+        if (!is_empty(leaf_bbox)) {
+            bbox.extend(leaf_bbox);
+        }
+    }
+    return bbox;
+}
+
+auto Bvh_scene::is_tlas_up_to_date() const -> bool
+{
+    return !m_structure_dirty && !m_bounds_dirty;
+}
+
+void Bvh_scene::rebuild_tlas()
+{
     ERHE_PROFILE_FUNCTION();
 
-    bool is_hit = false;
-    for (const auto& instance : m_instances) {
-        const bool instance_is_hit = instance->intersect(ray, hit);
-        if (instance_is_hit) {
-            is_hit = true;
+    const std::size_t leaf_count = m_instances.size() + m_geometries.size();
+    m_leaf_bboxes.resize(leaf_count);
+    std::vector<Vec3> centers(leaf_count);
+    for (std::size_t i = 0; i < leaf_count; ++i) {
+        BBox bbox = get_leaf_bbox(i);
+        if (is_empty(bbox)) {
+            // Degenerate leaf; geometry without BVH never reports hits
+            bbox = BBox{Vec3{0.0f}, Vec3{0.0f}};
+        }
+        m_leaf_bboxes[i] = bbox;
+        centers[i] = bbox.get_center();
+    }
+
+    m_refit_count     = 0;
+    m_structure_dirty = false;
+    m_bounds_dirty    = false;
+
+    if (leaf_count == 0) {
+        m_tlas       = Tlas{};
+        m_tlas_depth = 0;
+        return;
+    }
+
+    using Builder = bvh::v2::DefaultBuilder<Tlas_node>;
+    typename Builder::Config config;
+    config.quality = Builder::Quality::Low;
+    m_tlas = Builder::build(m_leaf_bboxes, centers, config);
+
+    // Depth sizes traversal stack
+    m_tlas_depth = 0;
+    std::vector<std::pair<std::size_t, std::size_t>> nodes{{0, 0}}; // node index, depth
+    while (!nodes.empty()) {
+        const auto [node_index, depth] = nodes.back();
+        nodes.pop_back();
+        m_tlas_depth = std::max(m_tlas_depth, depth);
+        const Tlas_node& node = m_tlas.nodes[node_index];
+        if (!node.is_leaf()) {
+            nodes.emplace_back(node.index.first_id(),     depth + 1);
+            nodes.emplace_back(node.index.first_id() + 1, depth + 1);
+        }
+    }
+
+    log_scene->trace("Bvh_scene {} TLAS rebuilt, {} leaves, {} nodes", m_debug_label, leaf_count, m_tlas.nodes.size());
+}
+
+auto Bvh_scene::refit_tlas_node(const std::size_t node_index) -> BBox
+{
+    auto& node = m_tlas.nodes[node_index];
+    BBox bbox = BBox::make_empty();
+    const std::size_t first_id = node.index.first_id();
+    if (node.is_leaf()) {
+        for (std::size_t i = first_id, end = first_id + node.index.prim_count(); i < end; ++i) {
+            bbox.extend(m_leaf_bboxes[m_tlas.prim_ids[i]]);
         }
+    } else {
+        bbox.extend(refit_tlas_node(first_id));
+        bbox.extend(refit_tlas_node(first_id + 1));
     }
-    for (const auto& geometry : m_geometries) {
-        const bool geometry_is_hit = geometry->intersect_instance(ray, hit, nullptr);
-        if (geometry_is_hit) {
-            is_hit = true;
+    node.set_bbox(bbox);
+    return bbox;
+}
+
+void Bvh_scene::commit()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t leaf_count = m_instances.size() + m_geometries.size();
+    if (m_structure_dirty || (m_leaf_bboxes.size() != leaf_count)) {
+        rebuild_tlas();
+        return;
+    }
+
+    // Transforms may have changed - refit, or rebuild if refitted too many times
+    bool any_changed = false;
+    for (std::size_t i = 0; i < leaf_count; ++i) {
+        BBox bbox = get_leaf_bbox(i);
+        if (is_empty(bbox)) {
+            bbox = BBox{Vec3{0.0f}, Vec3{0.0f}};
+        }
+        if (!is_same(bbox, m_leaf_bboxes[i])) {
+            m_leaf_bboxes[i] = bbox;
+            any_changed = true;
         }
     }
+    m_bounds_dirty = false;
+    if (!any_changed || m_tlas.nodes.empty()) {
+        return;
+    }
+
+    ++m_refit_count;
+    if (m_refit_count > c_max_refit_count) {
+        rebuild_tlas();
+        return;
+    }
+    refit_tlas_node(0);
+}
+
+template <typename Leaf_function>
+auto Bvh_scene::traverse_tlas(Ray& ray, Leaf_function&& leaf_function) -> bool
+{
+    if (m_tlas.nodes.empty()) {
+        return false;
+    }
+
+    static constexpr std::size_t small_stack_size     = 64;
+    static constexpr bool        use_robust_traversal = false;
+
+    bvh::v2::Ray<float, 3> bvh_ray{
+        to_bvh(ray.origin),
+        to_bvh(ray.direction),
+        ray.t_near,
+        ray.t_far
+    };
+
+    bool is_hit = false;
+    const auto traverse = [&](auto& stack) {
+        m_tlas.intersect<false, use_robust_traversal>(
+            bvh_ray,
+            m_tlas.get_root().index,
+            stack,
+            [&] (const std::size_t begin, const std::size_t end) {
+                bool leaf_hit = false;
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (leaf_function(m_tlas.prim_ids[i])) {
+                        leaf_hit = true;
+                    }
+                }
+                if (leaf_hit) {
+                    // Shrink the ray so that farther subtrees get culled
+                    bvh_ray.tmax = ray.t_far;
+                    is_hit = true;
+                }
+                return leaf_hit;
+            }
+        );
+    };
+
+    // Traversal pushes at most one node per tree level
+    if (m_tlas_depth <= small_stack_size) {
+        bvh::v2::SmallStack<Tlas::Index, small_stack_size> stack;
+        traverse(stack);
+    } else {
+        bvh::v2::GrowingStack<Tlas::Index> stack;
+        traverse(stack);
+    }
     return is_hit;
 }
 
-auto Bvh_scene::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* in_instance) -> bool
+auto Bvh_scene::intersect_linear(
+    Ray&          ray,
+    Hit&          hit,
+    const bool    include_instances,
+    const bool    include_geometries,
+    Bvh_instance* in_instance
+) -> bool
 {
     bool is_hit = false;
-    if (in_instance == nullptr) {
+    if (include_instances) {
         for (const auto& instance : m_instances) {
             const bool instance_is_hit = instance->intersect(ray, hit);
             if (instance_is_hit) {
                 is_hit = true;
             }
         }
-    } else {
+    }
+    if (include_geometries) {
         for (const auto& geometry : m_geometries) {
             const bool geometry_is_hit = geometry->intersect_instance(ray, hit, in_instance);
             if (geometry_is_hit) {
@@ -163,6 +397,175 @@ auto Bvh_scene::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* in_instance
     return is_hit;
 }
 
+auto Bvh_scene::intersect(Ray& ray, Hit& hit) -> bool
+{
+    log_frame->trace(
+        "Bvh_scene {} intersect mask = {:04x} instances = {}, geometries = {}, ray origin = {}, direction = {}",
+        m_debug_label, ray.mask, m_instances.size(), m_geometries.size(), ray.origin, ray.direction
+    );
+
+    ERHE_PROFILE_FUNCTION();
+
+    // Scene modified since last commit() - fall back to scanning everything
+    if (!is_tlas_up_to_date()) {
+        return intersect_linear(ray, hit, true, true, nullptr);
+    }
+
+    const std::size_t instance_count = m_instances.size();
+    return traverse_tlas(
+        ray,
+        [&](const std::size_t leaf_index) -> bool {
+            if (leaf_index < instance_count) {
+                return m_instances[leaf_index]->intersect(ray, hit);
+            }
+            return m_geometries[leaf_index - instance_count]->intersect_instance(ray, hit, nullptr);
+        }
+    );
+}
+
+auto Bvh_scene::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* in_instance) -> bool
+{
+    const bool include_instances  = (in_instance == nullptr);
+    const bool include_geometries = (in_instance != nullptr);
+    if (!is_tlas_up_to_date()) {
+        return intersect_linear(ray, hit, include_instances, include_geometries, in_instance);
+    }
+
+    const std::size_t instance_count = m_instances.size();
+    return traverse_tlas(
+        ray,
+        [&](const std::size_t leaf_index) -> bool {
+            if (leaf_index < instance_count) {
+                return include_instances && m_instances[leaf_index]->intersect(ray, hit);
+            }
+            return include_geometries && m_geometries[leaf_index - instance_count]->intersect_instance(ray, hit, in_instance);
+        }
+    );
+}
+
+void Bvh_scene::intersect_packets(
+    std::span<Ray> rays,
+    std::span<Hit> hits,
+    const bool     include_instances,
+    const bool     include_geometries,
+    Bvh_instance*  in_instance
+)
+{
+    const std::size_t instance_count = m_instances.size();
+    for (std::size_t offset = 0, end = rays.size(); offset < end; offset += Ray_packet::c_size) {
+        const std::size_t count       = std::min(Ray_packet::c_size, end - offset);
+        std::span<Ray>    packet_rays = rays.subspan(offset, count);
+        std::span<Hit>    packet_hits = hits.subspan(offset, count);
+
+        Ray_packet packet;
+        packet.load(packet_rays);
+
+        traverse_packet(
+            m_tlas,
+            packet,
+            [&](const std::size_t i, const uint32_t lane_mask) -> uint32_t {
+                const std::size_t leaf_index  = m_tlas.prim_ids[i];
+                const bool        is_instance = leaf_index < instance_count;
+                if ((is_instance && !include_instances) || (!is_instance && !include_geometries)) {
+                    return 0;
+                }
+
+                // Gather lanes that reached this leaf into a dense sub-packet
+                std::array<std::size_t, Ray_packet::c_size> lanes;
+                std::array<Ray,         Ray_packet::c_size> lane_rays;
+                std::array<Hit,         Ray_packet::c_size> lane_hits;
+                std::size_t lane_count = 0;
+                for (std::size_t lane = 0; lane < count; ++lane) {
+                    if ((lane_mask & (1u << lane)) != 0) {
+                        lanes    [lane_count] = lane;
+                        lane_rays[lane_count] = packet_rays[lane];
+                        lane_hits[lane_count] = packet_hits[lane];
+                        ++lane_count;
+                    }
+                }
+                const std::span<Ray> sub_rays{lane_rays.data(), lane_count};
+                const std::span<Hit> sub_hits{lane_hits.data(), lane_count};
+                if (is_instance) {
+                    m_instances[leaf_index]->intersect(sub_rays, sub_hits);
+                } else {
+                    m_geometries[leaf_index - instance_count]->intersect_instance(sub_rays, sub_hits, in_instance);
+                }
+
+                uint32_t hit_mask = 0;
+                for (std::size_t k = 0; k < lane_count; ++k) {
+                    Ray& ray = packet_rays[lanes[k]];
+                    if (lane_rays[k].t_far < ray.t_far) {
+                        ray.t_far             = lane_rays[k].t_far;
+                        packet_hits[lanes[k]] = lane_hits[k];
+                        hit_mask |= (1u << lanes[k]);
+                    }
+                }
+                return hit_mask;
+            },
+            [&](const std::size_t lane) -> float {
+                return packet_rays[lane].t_far;
+            }
+        );
+    }
+}
+
+void Bvh_scene::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(rays.size() == hits.size());
+
+    if (!is_tlas_up_to_date()) {
+        for (std::size_t i = 0, end = rays.size(); i < end; ++i) {
+            intersect_linear(rays[i], hits[i], true, true, nullptr);
+        }
+        return;
+    }
+
+    if (rays.size() < c_parallel_ray_count) {
+        intersect_packets(rays, hits, true, true, nullptr);
+        return;
+    }
+
+    // Traversal only reads the scene, so packets can be traced concurrently
+    const std::size_t packet_count = (rays.size() + Ray_packet::c_size - 1) / Ray_packet::c_size;
+    erhe::concurrency::Thread_pool::get_instance().parallel_for(
+        0,
+        packet_count,
+        [&](const std::size_t begin, const std::size_t end) {
+            const std::size_t ray_begin = begin * Ray_packet::c_size;
+            const std::size_t ray_end   = std::min(rays.size(), end * Ray_packet::c_size);
+            intersect_packets(
+                rays.subspan(ray_begin, ray_end - ray_begin),
+                hits.subspan(ray_begin, ray_end - ray_begin),
+                true,
+                true,
+                nullptr
+            );
+        },
+        c_packets_per_task
+    );
+}
+
+void Bvh_scene::intersect_instance(std::span<Ray> rays, std::span<Hit> hits, Bvh_instance* in_instance)
+{
+    const bool include_instances  = (in_instance == nullptr);
+    const bool include_geometries = (in_instance != nullptr);
+    if (!is_tlas_up_to_date()) {
+        for (std::size_t i = 0, end = rays.size(); i < end; ++i) {
+            intersect_linear(rays[i], hits[i], include_instances, include_geometries, in_instance);
+        }
+        return;
+    }
+
+    // Instanced sub-scenes typically hold a single geometry; pass the whole batch to it
+    if (include_geometries && m_instances.empty() && (m_geometries.size() == 1)) {
+        m_geometries.front()->intersect_instance(rays, hits, in_instance);
+        return;
+    }
+    intersect_packets(rays, hits, include_instances, include_geometries, in_instance);
+}
+
 auto Bvh_scene::debug_label() const -> std::string_view
 {
     return m_debug_label;
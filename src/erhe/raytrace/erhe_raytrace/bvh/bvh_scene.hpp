@@ -8,7 +8,9 @@
 
 #include "erhe_raytrace/iscene.hpp"
 
+#include <bvh/v2/bbox.h>
 #include <bvh/v2/bvh.h>
+#include <bvh/v2/node.h>
 
 #include <string>
 #include <vector>
@@ -32,15 +34,56 @@ public:
     void detach     (IInstance* geometry)        override;
     void commit     ()                           override;
     auto intersect  (Ray& ray, Hit& hit) -> bool override;
+    void intersect  (std::span<Ray> rays, std::span<Hit> hits) override;
     auto debug_label() const -> std::string_view override;
 
     // Bvh_scene public API
     auto intersect_instance(Ray& ray, Hit& hit, Bvh_instance* instance) -> bool;
+    void intersect_instance(std::span<Ray> rays, std::span<Hit> hits, Bvh_instance* instance);
+    [[nodiscard]] auto get_local_bbox() const -> bvh::v2::BBox<float, 3>;
+
+    // Also marks scenes which instance this scene, as their instance
+    // bounds depend on the bounds of this scene
+    void mark_bounds_dirty();
+
+    // Instances which use this scene through IInstance::set_scene()
+    void add_referencing_instance   (Bvh_instance* instance);
+    void remove_referencing_instance(Bvh_instance* instance);
 
 private:
-    std::vector<Bvh_geometry*> m_geometries;
-    std::vector<Bvh_instance*> m_instances;
-    std::string                m_debug_label;
+    using Tlas_node = bvh::v2::Node<float, 3>;
+    using Tlas      = bvh::v2::Bvh<Tlas_node>;
+
+    // Rebuilding restores tree quality after objects have moved a lot
+    static constexpr std::size_t c_max_refit_count = 64;
+
+    // Smaller ray batches are traced on the calling thread
+    static constexpr std::size_t c_parallel_ray_count = 1024;
+    static constexpr std::size_t c_packets_per_task   = 16;
+
+    [[nodiscard]] auto get_leaf_bbox     (std::size_t leaf_index) const -> bvh::v2::BBox<float, 3>;
+    [[nodiscard]] auto is_tlas_up_to_date() const -> bool;
+    void rebuild_tlas();
+    auto refit_tlas_node(std::size_t node_index) -> bvh::v2::BBox<float, 3>;
+
+    template <typename Leaf_function>
+    auto traverse_tlas  (Ray& ray, Leaf_function&& leaf_function) -> bool;
+    auto intersect_linear(Ray& ray, Hit& hit, bool include_instances, bool include_geometries, Bvh_instance* instance) -> bool;
+    void intersect_packets(std::span<Ray> rays, std::span<Hit> hits, bool include_instances, bool include_geometries, Bvh_instance* instance);
+
+    std::vector<Bvh_geometry*>           m_geometries;
+    std::vector<Bvh_instance*>           m_instances;
+    std::vector<Bvh_instance*>           m_referencing_instances;
+    std::string                          m_debug_label;
+
+    // Top level acceleration structure. Leaf index i < m_instances.size()
+    // refers to m_instances[i], following leaves refer to m_geometries.
+    Tlas                                 m_tlas;
+    std::vector<bvh::v2::BBox<float, 3>> m_leaf_bboxes;
+    std::size_t                          m_tlas_depth     {0};
+    std::size_t                          m_refit_count    {0};
+    bool                                 m_structure_dirty{true};
+    bool                                 m_bounds_dirty   {true};
 };
 
 } // namespace erhe::raytrace
@@ -4,6 +4,7 @@
 #include "erhe_raytrace/embree/embree_scene.hpp"
 #include "erhe_raytrace/log.hpp"
 #include "erhe_log/log_glm.hpp"
+#include "erhe_verify/verify.hpp"
 
 namespace erhe::raytrace
 {
@@ -94,6 +95,14 @@ void Embree_geometry::set_mask(const uint32_t mask)
     m_mask = mask;
 }
 
+void Embree_geometry::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    // Embree only intersects RTCScene; geometry has no query of its own
+    static_cast<void>(rays);
+    static_cast<void>(hits);
+    ERHE_FATAL("Embree_geometry::intersect() is not supported, attach geometry to a scene and use IScene::intersect()");
+}
+
 auto Embree_geometry::get_mask() const -> uint32_t
 {
     return m_mask;
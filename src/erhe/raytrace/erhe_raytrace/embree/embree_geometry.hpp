@@ -26,6 +26,7 @@ public:
     void set_mask     (const uint32_t mask) override;
 
     void set_user_data(void* ptr) override;
+    void intersect    (std::span<Ray> rays, std::span<Hit> hits) override; // Not supported, use Embree_scene
     [[nodiscard]] auto get_mask     () const -> uint32_t         override;
     [[nodiscard]] auto get_user_data() const -> void*            override;
     [[nodiscard]] auto is_enabled   () const -> bool             override;
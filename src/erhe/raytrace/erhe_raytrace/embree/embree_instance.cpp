@@ -4,6 +4,10 @@
 #include "erhe_raytrace/log.hpp"
 #include "erhe_log/log_glm.hpp"
 #include "erhe_profile/profile.hpp"
+#include "erhe_raytrace/ray.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <glm/glm.hpp>
 
 namespace erhe::raytrace
 {
@@ -157,6 +161,37 @@ void Embree_instance::set_user_data(void* ptr)
     m_user_data = ptr;
 }
 
+void Embree_instance::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    ERHE_PROFILE_FUNCTION
+
+    ERHE_VERIFY(rays.size() == hits.size());
+    if (!m_enabled || (m_scene == nullptr))
+    {
+        return;
+    }
+
+    const glm::mat4 inverse_transform = glm::inverse(get_transform());
+    for (std::size_t i = 0, end = rays.size(); i < end; ++i)
+    {
+        if ((rays[i].mask & m_mask) == 0)
+        {
+            continue;
+        }
+
+        // Embree_scene::intersect() writes hit even on miss
+        Ray local_ray = rays[i].transform(inverse_transform);
+        Hit local_hit{};
+        m_scene->intersect(local_ray, local_hit);
+        if (local_ray.t_far < rays[i].t_far)
+        {
+            rays[i].t_far    = local_ray.t_far;
+            hits[i]          = local_hit;
+            hits[i].instance = this;
+        }
+    }
+}
+
 auto Embree_instance::get_transform() const -> glm::mat4
 {
     glm::mat4 transform{1.0f};
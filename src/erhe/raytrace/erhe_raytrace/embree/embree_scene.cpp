@@ -6,6 +6,8 @@
 #include "erhe_raytrace/ray.hpp"
 #include "erhe_profile/profile.hpp"
 
+#include <algorithm>
+
 namespace erhe::raytrace
 {
 
@@ -259,6 +261,16 @@ auto Embree_scene::get_rtc_scene() -> RTCScene
     return m_scene;
 }
 
+void Embree_scene::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    ERHE_PROFILE_FUNCTION
+
+    for (std::size_t i = 0, end = std::min(rays.size(), hits.size()); i < end; ++i)
+    {
+        intersect(rays[i], hits[i]);
+    }
+}
+
 auto Embree_scene::get_geometry_from_id(const unsigned int id) -> Embree_geometry*
 {
     if (id == RTC_INVALID_GEOMETRY_ID)
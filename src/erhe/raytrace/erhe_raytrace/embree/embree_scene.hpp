@@ -47,6 +47,7 @@ public:
     // rtcGetSceneLinearBounds()
 
     void intersect(Ray& ray, Hit& out_hit) override;
+    void intersect(std::span<Ray> rays, std::span<Hit> hits) override;
 
     //void set_dirty();
     auto get_rtc_scene() -> RTCScene;
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string_view>
 
 namespace erhe::raytrace {
@@ -153,6 +154,7 @@ public:
         std::size_t  item_count
     ) = 0;
     virtual void set_user_data(const void* ptr) = 0;
+    virtual void intersect    (std::span<Ray> rays, std::span<Hit> hits) = 0;
     [[nodiscard]] virtual auto get_mask     () const -> uint32_t         = 0;
     [[nodiscard]] virtual auto get_user_data() const -> const void*      = 0;
     [[nodiscard]] virtual auto is_enabled   () const -> bool             = 0;
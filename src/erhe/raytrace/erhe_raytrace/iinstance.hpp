@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <span>
 #include <string_view>
 
 namespace erhe::raytrace {
@@ -23,6 +24,7 @@ public:
     virtual void set_scene    (IScene* scene) = 0;
     virtual void set_mask     (uint32_t mask) = 0;
     virtual void set_user_data(void* ptr) = 0;
+    virtual void intersect    (std::span<Ray> rays, std::span<Hit> hits) = 0;
     [[nodiscard]] virtual auto get_transform() const -> glm::mat4        = 0;
     [[nodiscard]] virtual auto get_scene    () const -> IScene*          = 0;
     [[nodiscard]] virtual auto get_mask     () const -> uint32_t         = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <string_view>
 
 namespace erhe::raytrace {
@@ -21,6 +22,9 @@ public:
     virtual void detach   (IInstance* instance) = 0;
     virtual void commit   () = 0;
     virtual auto intersect(Ray& ray, Hit& hit) -> bool = 0;
+
+    // Batched query; hits[i] receives the result for rays[i]
+    virtual void intersect(std::span<Ray> rays, std::span<Hit> hits) = 0;
     [[nodiscard]] virtual auto debug_label() const -> std::string_view = 0;
 
     [[nodiscard]] static auto create       (const std::string_view debug_label) -> IScene*;
@@ -37,6 +37,7 @@ public:
         const std::size_t
     ) override {}
     void set_user_data(void* ptr) override { m_user_data = ptr; }
+    void intersect    (std::span<Ray>, std::span<Hit>) override {}
     [[nodiscard]] auto get_mask     () const -> uint32_t         override { return m_mask; }
     [[nodiscard]] auto get_user_data() const -> void*            override { return m_user_data; }
     [[nodiscard]] auto is_enabled   () const -> bool             override { return m_enabled; }
@@ -2,6 +2,9 @@
 #include "erhe_raytrace/null/null_geometry.hpp"
 #include "erhe_raytrace/iinstance.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
 
 namespace erhe::raytrace
 {
@@ -92,8 +95,18 @@ void Null_scene::commit()
 {
 }
 
-void Null_scene::intersect(Ray&, Hit&)
+auto Null_scene::intersect(Ray&, Hit&) -> bool
 {
+    // Null backend, nothing is ever hit and hit is left as initialized by caller
+    return false;
+}
+
+void Null_scene::intersect(std::span<Ray> rays, std::span<Hit> hits)
+{
+    ERHE_VERIFY(rays.size() == hits.size());
+    for (std::size_t i = 0, end = rays.size(); i < end; ++i) {
+        static_cast<void>(intersect(rays[i], hits[i]));
+    }
 }
 
 auto Null_scene::debug_label() const -> std::string_view
@@ -10,6 +10,9 @@ namespace erhe::raytrace
 
 class IGeometry;
 
+// Raytrace backend used when ERHE_RAYTRACE_LIBRARY is none. Queries never
+// report a hit; Hit arguments are left untouched, so callers see the
+// values they initialized them with.
 class Null_scene
     : public IScene
 {
@@ -23,7 +26,8 @@ public:
     void detach   (IGeometry* geometry) override;
     void detach   (IInstance* geometry) override;
     void commit   ()           override;
-    void intersect(Ray&, Hit&) override;
+    auto intersect(Ray&, Hit&) -> bool override;
+    void intersect(std::span<Ray> rays, std::span<Hit> hits) override;
     [[nodiscard]] auto debug_label() const -> std::string_view override;
 
 private:
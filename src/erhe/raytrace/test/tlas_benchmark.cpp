@@ -0,0 +1,207 @@
+// Benchmark for Bvh_scene top level acceleration structure
+//
+// Builds scenes of 16 to 65536 box instances, each instance referring to
+// its own sub-scene with one shared box geometry, like the editor does for
+// mesh primitives. Reports rays per second for single ray and batched
+// queries through the TLAS, and for the linear instance scan which is what
+// queries did before the TLAS existed. Also checks that TLAS and linear
+// scan report the same hits.
+
+#include "erhe_raytrace/ibuffer.hpp"
+#include "erhe_raytrace/igeometry.hpp"
+#include "erhe_raytrace/iinstance.hpp"
+#include "erhe_raytrace/iscene.hpp"
+#include "erhe_raytrace/ray.hpp"
+#include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace erhe::raytrace;
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* label, const std::size_t instance_count, const std::size_t ray_count, const double seconds)
+{
+    fmt::print(
+        "{:<24} {:>8} instances {:>8} rays {:>10.3f} ms {:>14.0f} rays/s\n",
+        label, instance_count, ray_count, seconds * 1000.0, static_cast<double>(ray_count) / seconds
+    );
+}
+
+// Unit box, 8 vertices and 12 triangles
+auto make_box_geometry(IBuffer& vertex_buffer, IBuffer& index_buffer) -> std::unique_ptr<IGeometry>
+{
+    static constexpr std::array<float, 8 * 3> positions{
+        -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,  -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f,  0.5f,  0.5f,  -0.5f,  0.5f,  0.5f
+    };
+    static constexpr std::array<uint32_t, 12 * 3> indices{
+        0, 2, 1,  0, 3, 2,  4, 5, 6,  4, 6, 7,
+        0, 1, 5,  0, 5, 4,  3, 6, 2,  3, 7, 6,
+        0, 4, 7,  0, 7, 3,  1, 2, 6,  1, 6, 5
+    };
+
+    const std::size_t vertex_offset = vertex_buffer.allocate_bytes(sizeof(positions));
+    const std::size_t index_offset  = index_buffer .allocate_bytes(sizeof(indices));
+    std::memcpy(vertex_buffer.span().data() + vertex_offset, positions.data(), sizeof(positions));
+    std::memcpy(index_buffer .span().data() + index_offset,  indices  .data(), sizeof(indices));
+
+    auto geometry = IGeometry::create_unique("box", Geometry_type::GEOMETRY_TYPE_TRIANGLE);
+    geometry->set_buffer(Buffer_type::BUFFER_TYPE_VERTEX, 0, Format::FORMAT_FLOAT3, &vertex_buffer, vertex_offset, 3 * sizeof(float),    8);
+    geometry->set_buffer(Buffer_type::BUFFER_TYPE_INDEX,  0, Format::FORMAT_UINT3,  &index_buffer,  index_offset,  3 * sizeof(uint32_t), 12);
+    geometry->commit();
+    return geometry;
+}
+
+class Instanced_box
+{
+public:
+    std::unique_ptr<IScene>    scene;
+    std::unique_ptr<IInstance> instance;
+};
+
+auto make_rays(const std::size_t ray_count, const float extent) -> std::vector<Ray>
+{
+    std::mt19937 random_engine{12345};
+    std::uniform_real_distribution<float> distribution{-extent, extent};
+    std::vector<Ray> rays(ray_count);
+    for (Ray& ray : rays) {
+        // From above the grid towards random points on it
+        ray.origin    = glm::vec3{0.0f, 4.0f * extent, 0.0f};
+        ray.direction = glm::normalize(glm::vec3{distribution(random_engine), 0.0f, distribution(random_engine)} - ray.origin);
+        ray.t_near    = 0.0f;
+        ray.t_far     = 1.0e6f;
+    }
+    return rays;
+}
+
+auto count_hits(const std::vector<Ray>& rays) -> std::size_t
+{
+    return static_cast<std::size_t>(
+        std::count_if(rays.begin(), rays.end(), [](const Ray& ray) { return ray.t_far < 1.0e6f; })
+    );
+}
+
+auto run(IGeometry& geometry, const std::size_t instance_count, const std::size_t ray_count) -> bool
+{
+    const std::size_t side    = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(instance_count))));
+    const float       spacing = 2.0f;
+    const float       extent  = 0.5f * spacing * static_cast<float>(side);
+
+    auto root_scene = IScene::create_unique("root");
+    std::vector<Instanced_box> boxes(instance_count);
+    for (std::size_t i = 0; i < instance_count; ++i) {
+        Instanced_box& box = boxes[i];
+        const std::string name = fmt::format("box {}", i);
+        box.scene    = IScene::create_unique(name);
+        box.instance = IInstance::create_unique(name);
+        box.scene->attach(&geometry);
+        box.scene->commit();
+        box.instance->set_scene(box.scene.get());
+        const float x = -extent + spacing * (0.5f + static_cast<float>(i % side));
+        const float z = -extent + spacing * (0.5f + static_cast<float>(i / side));
+        box.instance->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{x, 0.0f, z}));
+        box.instance->commit();
+        root_scene->attach(box.instance.get());
+    }
+
+    auto start = Clock::now();
+    root_scene->commit();
+    const double commit_seconds = seconds_since(start);
+    fmt::print("{:<24} {:>8} instances {:>10.3f} ms\n", "TLAS commit", instance_count, commit_seconds * 1000.0);
+
+    const std::vector<Ray> source_rays = make_rays(ray_count, extent);
+
+    std::vector<Ray> single_rays = source_rays;
+    std::vector<Hit> single_hits(ray_count);
+    start = Clock::now();
+    for (std::size_t i = 0; i < ray_count; ++i) {
+        root_scene->intersect(single_rays[i], single_hits[i]);
+    }
+    report("TLAS single ray", instance_count, ray_count, seconds_since(start));
+
+    std::vector<Ray> batch_rays = source_rays;
+    std::vector<Hit> batch_hits(ray_count);
+    start = Clock::now();
+    root_scene->intersect(std::span<Ray>{batch_rays}, std::span<Hit>{batch_hits});
+    report("TLAS batch", instance_count, ray_count, seconds_since(start));
+
+    // Changing a transform without commit() makes the scene fall back to
+    // the linear scan. Linear scans are slow, time fewer rays.
+    boxes.front().instance->set_transform(boxes.front().instance->get_transform());
+    const std::size_t linear_ray_count = std::max(std::size_t{1}, std::min(ray_count, (64 * ray_count) / instance_count));
+    std::vector<Ray> linear_rays{source_rays.begin(), source_rays.begin() + linear_ray_count};
+    std::vector<Hit> linear_hits(linear_ray_count);
+    start = Clock::now();
+    for (std::size_t i = 0; i < linear_ray_count; ++i) {
+        root_scene->intersect(linear_rays[i], linear_hits[i]);
+    }
+    report("linear scan (previous)", instance_count, linear_ray_count, seconds_since(start));
+
+    bool ok = true;
+    for (std::size_t i = 0; i < linear_ray_count; ++i) {
+        if (
+            (single_rays[i].t_far    != linear_rays[i].t_far) ||
+            (single_hits[i].instance != linear_hits[i].instance) ||
+            (std::abs(batch_rays[i].t_far - linear_rays[i].t_far) > 1.0e-4f * linear_rays[i].t_far)
+        ) {
+            fmt::print(stderr, "ray {}: TLAS and linear scan results differ\n", i);
+            ok = false;
+            break;
+        }
+    }
+    if (count_hits(single_rays) != count_hits(batch_rays)) {
+        fmt::print(stderr, "single ray and batch hit counts differ: {} vs {}\n", count_hits(single_rays), count_hits(batch_rays));
+        ok = false;
+    }
+
+    // Root scene first so that instances need not be detached one by one
+    root_scene.reset();
+    while (!boxes.empty()) {
+        boxes.pop_back();
+    }
+    return ok;
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t max_instance_count = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 65'536;
+    const std::size_t ray_count          = (argc > 2) ? static_cast<std::size_t>(std::stoull(argv[2])) : 100'000;
+
+    erhe::log::initialize_log_sinks();
+    erhe::raytrace::initialize_logging();
+
+    auto vertex_buffer = IBuffer::create_unique("vertex buffer", 1024);
+    auto index_buffer  = IBuffer::create_unique("index buffer",  1024);
+    auto geometry      = make_box_geometry(*vertex_buffer.get(), *index_buffer.get());
+
+    bool ok = true;
+    for (std::size_t instance_count = 16; instance_count <= max_instance_count; instance_count *= 16) {
+        ok = run(*geometry.get(), instance_count, ray_count) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -6,13 +6,16 @@
 #include "erhe_renderer/renderer_log.hpp"
 
 #include "erhe_gl/draw_indirect.hpp"
+#include "erhe_primitive/lod.hpp"
 #include "erhe_scene/mesh.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <algorithm>
+
 namespace erhe::renderer {
 
-Draw_indirect_buffer::Draw_indirect_buffer(erhe::graphics::Instance& graphics_instance)
+Draw_indirect_buffer::Draw_indirect_buffer(erhe::graphics::Instance& graphics_instance, const std::size_t max_update_count)
     : Multi_buffer{graphics_instance, "draw indirect"}
 {
     const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "renderer");
@@ -20,18 +23,23 @@ Draw_indirect_buffer::Draw_indirect_buffer(erhe::graphics::Instance& graphics_in
 
     Multi_buffer::allocate(
         gl::Buffer_target::draw_indirect_buffer,
-        sizeof(gl::Draw_elements_indirect_command) * m_max_draw_count
+        sizeof(gl::Draw_elements_indirect_command) * m_max_draw_count * std::max(max_update_count, std::size_t{1})
     );
 }
 
 auto Draw_indirect_buffer::update(
     const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
     erhe::primitive::Primitive_mode                            primitive_mode,
-    const erhe::Item_filter&                                   filter
+    const erhe::Item_filter&                                   filter,
+    const erhe::primitive::Lod_selection*                      lod_selection,
+    const std::span<const uint8_t>                             mesh_visibility
 ) -> Draw_indirect_buffer_range
 {
     ERHE_PROFILE_FUNCTION();
 
+    const bool use_visibility = !mesh_visibility.empty();
+    ERHE_VERIFY(!use_visibility || (mesh_visibility.size() == meshes.size()));
+
     SPDLOG_LOGGER_TRACE(
         log_render,
         "meshes.size() = {}, m_draw_indirect_writer.write_offset = {}",
@@ -41,10 +49,14 @@ auto Draw_indirect_buffer::update(
 
     // Conservative upper limit
     std::size_t primitive_count = 0;
-    for (const auto& mesh : meshes) {
+    for (std::size_t mesh_index = 0, end = meshes.size(); mesh_index < end; ++mesh_index) {
+        const auto& mesh = meshes[mesh_index];
         if (!filter(mesh->get_flag_bits())) {
             continue;
         }
+        if (use_visibility && (mesh_visibility[mesh_index] == 0)) {
+            continue;
+        }
         primitive_count += mesh->get_primitives().size();
     }
 
@@ -54,10 +66,12 @@ auto Draw_indirect_buffer::update(
     const std::size_t max_byte_count = primitive_count * entry_size;
     const auto        gpu_data       = writer.begin(gl::Buffer_target::draw_indirect_buffer, max_byte_count);
     uint32_t          instance_count     {1};
-    uint32_t          base_instance      {0};
+    uint32_t          primitive_index    {0};
     std::size_t       draw_indirect_count{0};
-    
-    for (const auto& mesh : meshes) {
+    const bool        use_lod = (lod_selection != nullptr) && (primitive_mode == erhe::primitive::Primitive_mode::polygon_fill);
+
+    for (std::size_t mesh_index = 0, end = meshes.size(); mesh_index < end; ++mesh_index) {
+        const auto& mesh = meshes[mesh_index];
         const auto* node = mesh->get_node();
 
         if (node == nullptr) {
@@ -68,6 +82,16 @@ auto Draw_indirect_buffer::update(
             continue;
         }
 
+        // Hidden meshes still advance primitive index, as their records are present
+        if (use_visibility && (mesh_visibility[mesh_index] == 0)) {
+            for (auto& primitive : mesh->get_primitives()) {
+                if (primitive.render_shape->get_renderable_mesh().index_range(primitive_mode).index_count > 0) {
+                    ++primitive_index;
+                }
+            }
+            continue;
+        }
+
         if ((writer.write_offset + entry_size) > writer.write_end) {
             log_render->critical("draw indirect buffer capacity {} exceeded", buffer.capacity_byte_count());
             ERHE_FATAL("draw indirect buffer capacity exceeded");
@@ -76,7 +100,12 @@ auto Draw_indirect_buffer::update(
 
         for (auto& primitive : mesh->get_primitives()) {
             const erhe::primitive::Buffer_mesh& buffer_mesh = primitive.render_shape->get_renderable_mesh();
-            const erhe::primitive::Index_range  index_range = buffer_mesh.index_range(primitive_mode);
+            const std::size_t                   lod         = use_lod ? erhe::primitive::select_lod(*lod_selection, buffer_mesh, node->world_from_node()) : 0;
+            const erhe::primitive::Index_range  index_range = buffer_mesh.index_range(primitive_mode, lod);
+            if (buffer_mesh.index_range(primitive_mode).index_count == 0) {
+                continue;
+            }
+            const uint32_t base_instance = primitive_index++;
             if (index_range.index_count == 0) {
                 continue;
             }
@@ -3,12 +3,16 @@
 #include "erhe_renderer/multi_buffer.hpp"
 #include "erhe_primitive/enums.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <span>
 
 namespace erhe {
     class Item_filter;
 }
+namespace erhe::primitive {
+    class Lod_selection;
+}
 namespace erhe::scene {
     class Mesh;
 }
@@ -25,13 +29,25 @@ public:
 class Draw_indirect_buffer : public Multi_buffer
 {
 public:
-    explicit Draw_indirect_buffer(erhe::graphics::Instance& graphics_instance);
-
-    // Can discard return value
+    // Capacity is max_draw_count commands per update, times
+    // max_update_count updates per frame
+    explicit Draw_indirect_buffer(erhe::graphics::Instance& graphics_instance, std::size_t max_update_count = 1);
+
+    // Can discard return value. With lod_selection, polygon fill uses
+    // reduced detail levels of buffer meshes where projected error allows.
+    //
+    // Base instance of each command is the index of the primitive among
+    // all primitives of meshes passing filter, matching the record order
+    // of Primitive_buffer::update() for the same meshes. When
+    // mesh_visibility is not empty, it has one entry per mesh and only
+    // meshes with nonzero entry are drawn; shaders then must index
+    // primitive records with gl_BaseInstance instead of gl_DrawID.
     auto update(
         const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
         erhe::primitive::Primitive_mode                            primitive_mode,
-        const erhe::Item_filter&                                   filter
+        const erhe::Item_filter&                                   filter,
+        const erhe::primitive::Lod_selection*                      lod_selection   = nullptr,
+        std::span<const uint8_t>                                   mesh_visibility = {}
     ) -> Draw_indirect_buffer_range;
 
     //// void debug_properties_window();
@@ -277,6 +277,9 @@ void Animation_sampler::apply(Animation_channel& channel, const float time_curre
             break;
         }
     }
+
+    // parent_from_node was modified directly; request update
+    channel.target->node_data.transforms.world_from_node_serial = 0;
 }
 
 //
@@ -12,7 +12,7 @@ namespace erhe::scene {
 
 using namespace erhe;
 
-uint64_t Node_transforms::s_global_update_serial = 0;
+std::atomic<uint64_t> Node_transforms::s_global_update_serial{0};
 
 auto Node_transforms::get_current_serial() -> uint64_t
 {
@@ -259,6 +259,12 @@ void Node::handle_parent_update(erhe::Hierarchy* const old_parent_item, erhe::Hi
     erhe::Item_host* const new_item_host = (new_parent != nullptr) ? new_parent->get_item_host() : nullptr;
     if (old_item_host != new_item_host) {
         handle_item_host_update(old_item_host, new_item_host);
+    } else if (node_data.host != nullptr) {
+        // Depth of this subtree may have changed within the same scene
+        Scene* scene = node_data.host->get_hosted_scene();
+        if (scene != nullptr) {
+            scene->update_node_depth(*this);
+        }
     }
 
     hierarchy_sanity_check();
@@ -310,11 +316,31 @@ void Node::handle_transform_update(const uint64_t serial) const
 
     node_data.transforms.parent_from_node_serial = effective_serial;
     node_data.transforms.world_from_node_serial  = effective_serial;
+    notify_transform_update();
+}
+
+void Node::notify_transform_update() const
+{
     for (const auto& attachment : node_data.attachments) {
         attachment->handle_node_transform_update();
     }
 }
 
+auto Node::is_transform_dirty() const -> bool
+{
+    const auto& current_parent = get_parent_node();
+    if (!current_parent) {
+        return false;
+    }
+
+    // Every transform change stamps the node with a new serial. A node
+    // with a serial older than its parent's has a stale world_from_node.
+    // Serial 0 marks a node whose parent_from_node was modified directly.
+    const uint64_t serial        = node_data.transforms.world_from_node_serial;
+    const uint64_t parent_serial = current_parent->node_data.transforms.world_from_node_serial;
+    return (serial == 0) || (serial < parent_serial);
+}
+
 void Node::update_transform(uint64_t serial)
 {
     ERHE_PROFILE_FUNCTION();
@@ -343,23 +369,38 @@ void Node::update_transform(uint64_t serial)
             return;
         }
 
-        serial = std::max(serial, current_parent->node_data.transforms.parent_from_node_serial);
-
-        // if (node_data.transforms.update_serial >= serial) {
-        //     return;
-        // }
         if (is_shown_in_ui()) {
             log_frame->trace("{} TX update parent {}", get_name(), current_parent->get_name());
         }
 
-        node_data.transforms.world_from_node.set(
-            current_parent->world_from_node() * parent_from_node(),
-            node_from_parent() * current_parent->node_from_world()
-        );
-        handle_transform_update(serial);
+        update_world_from_parent();
+        if (serial > node_data.transforms.world_from_node_serial) {
+            node_data.transforms.parent_from_node_serial = serial;
+            node_data.transforms.world_from_node_serial  = serial;
+        }
+        notify_transform_update();
     }
 }
 
+void Node::update_world_from_parent()
+{
+    const auto& current_parent = get_parent_node();
+    if (!current_parent) {
+        return;
+    }
+
+    node_data.transforms.world_from_node.set(
+        current_parent->world_from_node() * parent_from_node(),
+        node_from_parent() * current_parent->node_from_world()
+    );
+
+    // Fresh serial is newer than serials of all descendants, which
+    // makes them dirty in turn
+    const uint64_t serial = Node_transforms::get_next_serial();
+    node_data.transforms.parent_from_node_serial = serial;
+    node_data.transforms.world_from_node_serial  = serial;
+}
+
 void Node::update_world_from_node()
 {
     const auto& current_parent = get_parent_node();
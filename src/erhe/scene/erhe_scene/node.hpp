@@ -3,7 +3,9 @@
 #include "erhe_item/hierarchy.hpp"
 #include "erhe_scene/trs_transform.hpp"
 
+#include <atomic>
 #include <cstdint>
+#include <limits>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -34,7 +36,7 @@ public:
     static auto get_next_serial   () -> uint64_t;
 
 private:
-    static uint64_t s_global_update_serial;
+    static std::atomic<uint64_t> s_global_update_serial; // Nodes may be updated from worker threads
 };
 
 class Node_data
@@ -47,6 +49,11 @@ public:
     Scene_host*                                   host     {nullptr};
     std::vector<std::shared_ptr<Node_attachment>> attachments;
 
+    // Position in Scene depth buckets, maintained by Scene
+    static constexpr std::size_t c_no_depth_bucket = std::numeric_limits<std::size_t>::max();
+    std::size_t                                   depth_bucket     {c_no_depth_bucket};
+    std::size_t                                   depth_bucket_slot{0};
+
     static constexpr unsigned int bit_transform  {1u << 0};
     static constexpr unsigned int bit_attachments{1u << 1};
 
@@ -121,6 +128,14 @@ public:
     void node_sanity_check     () const;
     void update_world_from_node();
     void update_transform      (uint64_t serial);
+
+    // Split form of update_transform() used by Scene::update_node_transforms():
+    // update_world_from_parent() touches only this node, so nodes at the
+    // same depth can be updated concurrently; attachments are notified
+    // separately with notify_transform_update().
+    [[nodiscard]] auto is_transform_dirty    () const -> bool;
+    void               update_world_from_parent();
+    void               notify_transform_update () const;
     void set_parent_from_node  (const glm::mat4 parent_from_node);
     void set_parent_from_node  (const Transform& parent_from_node);
     void set_node_from_parent  (const glm::mat4 node_from_parent);
@@ -8,6 +8,7 @@
 #include "erhe_scene/scene_message_bus.hpp"
 #include "erhe_scene/skin.hpp"
 #include "erhe_bit/bit_helpers.hpp"
+#include "erhe_concurrency/thread_pool.hpp"
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
@@ -29,12 +30,11 @@ Mesh_layer::Mesh_layer(const std::string_view name, const uint64_t flags, const
 
 auto Mesh_layer::get_mesh_by_id(const erhe::Unique_id<Node>::id_type mesh_id) const -> std::shared_ptr<Mesh>
 {
-    for (const auto& mesh : meshes) {
-        if (mesh->get_id() == mesh_id) {
-            return mesh;
-        }
+    const auto i = m_mesh_index.find(mesh_id);
+    if (i == m_mesh_index.end()) {
+        return {};
     }
-    return {};
+    return meshes[i->second];
 }
 
 auto Mesh_layer::get_name() const -> const std::string&
@@ -46,27 +46,30 @@ void Mesh_layer::add(const std::shared_ptr<Mesh>& mesh)
 {
     ERHE_VERIFY(mesh);
 
-#ifndef NDEBUG
-    const auto i = std::find(meshes.begin(), meshes.end(), mesh);
-    if (i != meshes.end()) {
+    const auto [i, inserted] = m_mesh_index.try_emplace(mesh->get_id(), meshes.size());
+    if (!inserted) {
         log->error("mesh {} already in layer meshes", mesh->get_name());
-    } else
-#endif
-    {
-        meshes.push_back(mesh);
+        return;
     }
+    meshes.push_back(mesh);
 }
 
 void Mesh_layer::remove(const std::shared_ptr<Mesh>& mesh)
 {
     ERHE_VERIFY(mesh);
 
-    const auto i = std::remove(meshes.begin(), meshes.end(), mesh);
-    if (i == meshes.end()) {
+    const auto i = m_mesh_index.find(mesh->get_id());
+    if ((i == m_mesh_index.end()) || (meshes[i->second] != mesh)) {
         log->error("mesh {} not in layer meshes", mesh->get_name());
-    } else {
-        meshes.erase(i, meshes.end());
+        return;
+    }
+    const std::size_t index = i->second;
+    m_mesh_index.erase(i);
+    if (index + 1 != meshes.size()) {
+        meshes[index] = std::move(meshes.back());
+        m_mesh_index[meshes[index]->get_id()] = index;
     }
+    meshes.pop_back();
 }
 
 Light_layer::Light_layer(const std::string_view name, const Layer_id id)
@@ -77,12 +80,11 @@ Light_layer::Light_layer(const std::string_view name, const Layer_id id)
 
 auto Light_layer::get_light_by_id(const erhe::Unique_id<Node>::id_type light_id) const -> std::shared_ptr<Light>
 {
-    for (const auto& light : lights) {
-        if (light->get_id() == light_id) {
-            return light;
-        }
+    const auto i = m_light_index.find(light_id);
+    if (i == m_light_index.end()) {
+        return {};
     }
-    return {};
+    return lights[i->second];
 }
 
 auto Light_layer::get_name() const -> const std::string&
@@ -96,17 +98,12 @@ void Light_layer::add(const std::shared_ptr<Light>& light)
 
     log->trace("add_to_light_layer(light = {})", light->get_name());
 
-    {
-#ifndef NDEBUG
-        const auto i = std::find(lights.begin(), lights.end(), light);
-        if (i != lights.end()) {
-            log->error("light {} already in layer lights", light->get_name());
-        } else
-#endif
-        {
-            lights.push_back(light);
-        }
+    const auto [i, inserted] = m_light_index.try_emplace(light->get_id(), lights.size());
+    if (!inserted) {
+        log->error("light {} already in layer lights", light->get_name());
+        return;
     }
+    lights.push_back(light);
 }
 
 void Light_layer::remove(const std::shared_ptr<Light>& light)
@@ -115,12 +112,16 @@ void Light_layer::remove(const std::shared_ptr<Light>& light)
 
     log->trace("remove_from_scene_layer(light = {})`", light->get_name());
 
-    const auto i = std::remove(lights.begin(), lights.end(), light);
-
-    if (i == lights.end()) {
+    const auto i = m_light_index.find(light->get_id());
+    if ((i == m_light_index.end()) || (lights[i->second] != light)) {
         log->error("light {} not in layer lights", light->get_name());
-    } else {
-        lights.erase(i, lights.end());
+        return;
+    }
+    const std::size_t index = i->second;
+    m_light_index.erase(i);
+    lights.erase(lights.begin() + index);
+    for (std::size_t j = index, end = lights.size(); j < end; ++j) {
+        m_light_index[lights[j]->get_id()] = j;
     }
 }
 
@@ -128,12 +129,11 @@ void Light_layer::remove(const std::shared_ptr<Light>& light)
 
 auto Scene::get_camera_by_id(const erhe::Unique_id<Node>::id_type id) const -> std::shared_ptr<Camera>
 {
-    for (const auto& camera : m_cameras) {
-        if (camera->get_id() == id) {
-            return camera;
-        }
+    const auto i = m_camera_index.find(id);
+    if (i == m_camera_index.end()) {
+        return {};
     }
-    return {};
+    return i->second;
 }
 
 auto Scene::get_mesh_by_id(const erhe::Unique_id<Node>::id_type id) const -> std::shared_ptr<Mesh>
@@ -240,33 +240,108 @@ void Scene::sanity_check() const
 #endif
 }
 
-void Scene::sort_transform_nodes()
+void Scene::set_parallel_transform_update(const bool enable)
 {
-    log->trace("sorting {} nodes", m_flat_node_vector.size());
+    m_parallel_transform_update = enable;
+}
 
-    std::sort(
-        m_flat_node_vector.begin(),
-        m_flat_node_vector.end(),
-        [](const auto& lhs, const auto& rhs) {
-            return lhs->get_depth() < rhs->get_depth();
+void Scene::add_to_depth_bucket(Node& node)
+{
+    const std::size_t depth = node.get_depth();
+    if (m_depth_buckets.size() <= depth) {
+        m_depth_buckets.resize(depth + 1);
+    }
+    std::vector<Node*>& bucket = m_depth_buckets[depth];
+    node.node_data.depth_bucket      = depth;
+    node.node_data.depth_bucket_slot = bucket.size();
+    bucket.push_back(&node);
+}
+
+void Scene::remove_from_depth_bucket(Node& node)
+{
+    const std::size_t depth = node.node_data.depth_bucket;
+    if (depth == Node_data::c_no_depth_bucket) {
+        return;
+    }
+    ERHE_VERIFY(depth < m_depth_buckets.size());
+    std::vector<Node*>& bucket = m_depth_buckets[depth];
+    const std::size_t   slot   = node.node_data.depth_bucket_slot;
+    ERHE_VERIFY((slot < bucket.size()) && (bucket[slot] == &node));
+
+    // Swap with last; order within a bucket does not matter
+    Node* const last = bucket.back();
+    bucket[slot] = last;
+    last->node_data.depth_bucket_slot = slot;
+    bucket.pop_back();
+
+    node.node_data.depth_bucket      = Node_data::c_no_depth_bucket;
+    node.node_data.depth_bucket_slot = 0;
+}
+
+void Scene::update_node_depth(Node& node)
+{
+    if (node.node_data.depth_bucket == Node_data::c_no_depth_bucket) {
+        return; // Not registered to this scene
+    }
+    if (node.node_data.depth_bucket == node.get_depth()) {
+        return; // Children keep their relative depth
+    }
+    remove_from_depth_bucket(node);
+    add_to_depth_bucket(node);
+    for (const auto& child : node.get_children()) {
+        Node* child_node = dynamic_cast<Node*>(child.get());
+        if (child_node != nullptr) {
+            update_node_depth(*child_node);
+        }
+    }
+}
+
+void Scene::update_depth_bucket(const std::vector<Node*>& bucket)
+{
+    const auto update_node = [](Node* node) -> bool {
+        if (node->is_no_transform_update() || !node->is_transform_dirty()) {
+            return false;
+        }
+        node->update_world_from_parent();
+        return true;
+    };
+
+    if (!m_parallel_transform_update || (bucket.size() < c_parallel_bucket_min_size)) {
+        for (Node* node : bucket) {
+            if (update_node(node)) {
+                node->notify_transform_update();
+            }
         }
+        return;
+    }
+
+    // Transforms in parallel; attachments are notified serially afterwards
+    m_bucket_updated.resize(bucket.size());
+    erhe::concurrency::Thread_pool::get_instance().parallel_for(
+        0, bucket.size(),
+        [this, &bucket, &update_node](const std::size_t range_begin, const std::size_t range_end) {
+            for (std::size_t i = range_begin; i < range_end; ++i) {
+                m_bucket_updated[i] = update_node(bucket[i]) ? 1 : 0;
+            }
+        },
+        c_parallel_bucket_min_size / 4
     );
-    m_nodes_sorted = true;
+    for (std::size_t i = 0, end = bucket.size(); i < end; ++i) {
+        if (m_bucket_updated[i] != 0) {
+            bucket[i]->notify_transform_update();
+        }
+    }
 }
 
 void Scene::update_node_transforms()
 {
     ERHE_PROFILE_FUNCTION();
 
-    if (!m_nodes_sorted) {
-        sort_transform_nodes();
-    }
-
-    for (auto& node : m_flat_node_vector) {
-        if (node->is_no_transform_update()) {
-            continue;
-        }
-        node->update_transform(0);
+    // Buckets are visited in depth order, so parents are up to date
+    // before their children. Clean nodes (serial not older than parent
+    // serial) are skipped.
+    for (std::size_t depth = 0; depth < m_depth_buckets.size(); ++depth) {
+        update_depth_bucket(m_depth_buckets[depth]);
     }
 }
 
@@ -305,6 +380,7 @@ Scene::~Scene() noexcept
     m_mesh_layers.clear();
     m_light_layers.clear();
     m_cameras.clear();
+    m_camera_index.clear();
     m_root_node.reset();
 }
 
@@ -337,7 +413,7 @@ void Scene::register_node(const std::shared_ptr<erhe::scene::Node>& node)
         ERHE_VERIFY(node->node_data.host == nullptr);
         node->node_data.host = m_host;
         m_flat_node_vector.push_back(node);
-        m_nodes_sorted = false;
+        add_to_depth_bucket(*node);
     }
 
     ERHE_VERIFY(!node->get_parent().expired());
@@ -368,6 +444,7 @@ void Scene::unregister_node(const std::shared_ptr<erhe::scene::Node>& node)
     } else {
         node->node_data.host = nullptr;
         m_flat_node_vector.erase(i, m_flat_node_vector.end());
+        remove_from_depth_bucket(*node);
     }
 
 #if !defined(NDEBUG)
@@ -387,15 +464,13 @@ void Scene::unregister_node(const std::shared_ptr<erhe::scene::Node>& node)
 
 void Scene::register_camera(const std::shared_ptr<Camera>& camera)
 {
-#ifndef NDEBUG
-    const auto i = std::find(m_cameras.begin(), m_cameras.end(), camera);
-    if (i != m_cameras.end()) {
+    ERHE_VERIFY(camera);
+    const auto [i, inserted] = m_camera_index.try_emplace(camera->get_id(), camera);
+    if (!inserted) {
         log->error("camera {} already in scene cameras", camera->get_name());
-    } else
-#endif
-    {
-        m_cameras.push_back(camera);
+        return;
     }
+    m_cameras.push_back(camera);
 }
 
 void Scene::unregister_camera(const std::shared_ptr<Camera>& camera)
@@ -406,6 +481,7 @@ void Scene::unregister_camera(const std::shared_ptr<Camera>& camera)
         log->error("camera {} not in scene cameras", camera->get_name());
     } else {
         m_cameras.erase(i, m_cameras.end());
+        m_camera_index.erase(camera->get_id());
     }
 }
 
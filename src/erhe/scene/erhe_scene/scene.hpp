@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace erhe::scene {
@@ -32,6 +33,7 @@ public:
     [[nodiscard]] auto get_mesh_by_id(const erhe::Unique_id<Node>::id_type mesh_id) const -> std::shared_ptr<Mesh>;
     [[nodiscard]] auto get_name() const -> const std::string&;
 
+    // O(1); remove() swaps last mesh into the removed slot
     void add   (const std::shared_ptr<Mesh>& mesh);
     void remove(const std::shared_ptr<Mesh>& mesh);
 
@@ -39,6 +41,9 @@ public:
     std::string                        name;
     uint64_t                           flags{0};
     Layer_id                           id;
+
+private:
+    std::unordered_map<erhe::Unique_id<Node>::id_type, std::size_t> m_mesh_index; // id -> index in meshes
 };
 
 class Light_layer
@@ -56,6 +61,10 @@ public:
     glm::vec4                           ambient_light{0.0f, 0.0f, 0.0f, 0.0f};
     std::string                         name;
     Layer_id                            id;
+
+private:
+    // Light order is kept, as it is visible in light buffers and shadow maps
+    std::unordered_map<erhe::Unique_id<Node>::id_type, std::size_t> m_light_index; // id -> index in lights
 };
 
 class Scene : public erhe::Item<erhe::Item_base, erhe::Item_base, Scene>
@@ -76,9 +85,12 @@ public:
     auto get_item_host() const -> erhe::Item_host* override;
 
     // Public API
-    void sanity_check          () const;
-    void sort_transform_nodes  ();
-    void update_node_transforms();
+    void sanity_check                 () const;
+    void update_node_transforms       ();
+    void set_parallel_transform_update(bool enable);
+
+    // Called when parent change moves a subtree to different depth within this scene
+    void update_node_depth(Node& node);
 
     [[nodiscard]] auto get_mesh_by_id       (erhe::Unique_id<Node>::id_type id) const -> std::shared_ptr<Mesh>;
     [[nodiscard]] auto get_light_by_id      (erhe::Unique_id<Node>::id_type id) const -> std::shared_ptr<Light>;
@@ -120,7 +132,17 @@ private:
     std::vector<std::shared_ptr<Skin>>        m_skins;
     std::vector<std::shared_ptr<Light_layer>> m_light_layers;
     std::vector<std::shared_ptr<Camera>>      m_cameras;
-    bool                                      m_nodes_sorted{false};
+    std::unordered_map<erhe::Unique_id<Node>::id_type, std::shared_ptr<Camera>> m_camera_index;
+
+    // Nodes grouped by depth; nodes in one bucket only depend on nodes
+    // in earlier buckets, so each bucket can be updated in parallel.
+    static constexpr std::size_t              c_parallel_bucket_min_size{256};
+    void add_to_depth_bucket     (Node& node);
+    void remove_from_depth_bucket(Node& node);
+    void update_depth_bucket     (const std::vector<Node*>& bucket);
+    std::vector<std::vector<Node*>>           m_depth_buckets;
+    std::vector<uint8_t>                      m_bucket_updated;
+    bool                                      m_parallel_transform_update{true};
 };
 
 } // namespace erhe::scene
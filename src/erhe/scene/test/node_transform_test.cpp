@@ -0,0 +1,372 @@
+// Tests for Scene::update_node_transforms() with depth buckets.
+//
+// Builds trees with depth buckets large enough for the parallel update
+// path and compares every world_from_node against a reference computed by
+// multiplying parent_from_node up to the root. Checks that moving a deep
+// ancestor updates all its descendants, with parallel transform update
+// both enabled and disabled, that nodes outside the moved subtree keep
+// their transform serials, and that an update without changes touches no
+// node. Checks that reparenting a subtree within a scene (to a different
+// depth) and to another scene keeps world transforms, moves the subtree
+// to the right depth buckets, and that later ancestor moves reach it.
+
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_host.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_scene/scene_message_bus.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using erhe::scene::Node;
+using erhe::scene::Scene;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+// Minimal host; forwards registration to the hosted scene like editor
+// Scene_root does
+class Test_scene_host : public erhe::scene::Scene_host
+{
+public:
+    Test_scene_host(erhe::scene::Scene_message_bus& message_bus, const std::string_view name)
+        : scene{message_bus, name, this}
+    {
+    }
+
+    auto get_host_name   () const -> const char*                                       override { return "test scene host"; }
+    auto get_hosted_scene() -> Scene*                                                  override { return &scene; }
+    void register_node    (const std::shared_ptr<Node>& node)                          override { scene.register_node(node); }
+    void unregister_node  (const std::shared_ptr<Node>& node)                          override { scene.unregister_node(node); }
+    void register_camera  (const std::shared_ptr<erhe::scene::Camera>& camera)         override { scene.register_camera(camera); }
+    void unregister_camera(const std::shared_ptr<erhe::scene::Camera>& camera)         override { scene.unregister_camera(camera); }
+    void register_mesh    (const std::shared_ptr<erhe::scene::Mesh>& mesh)             override { scene.register_mesh(mesh); }
+    void unregister_mesh  (const std::shared_ptr<erhe::scene::Mesh>& mesh)             override { scene.unregister_mesh(mesh); }
+    void register_skin    (const std::shared_ptr<erhe::scene::Skin>& skin)             override { scene.register_skin(skin); }
+    void unregister_skin  (const std::shared_ptr<erhe::scene::Skin>& skin)             override { scene.unregister_skin(skin); }
+    void register_light   (const std::shared_ptr<erhe::scene::Light>& light)           override { scene.register_light(light); }
+    void unregister_light (const std::shared_ptr<erhe::scene::Light>& light)           override { scene.unregister_light(light); }
+
+    Scene scene;
+};
+
+// Rigid transform with uniform scale, varied by index
+auto make_parent_from_node(const std::size_t index) -> glm::mat4
+{
+    const float f = static_cast<float>(index);
+    glm::mat4 m = glm::translate(glm::mat4{1.0f}, glm::vec3{0.5f + 0.1f * std::sin(f), 0.25f * std::cos(0.7f * f), 0.3f * std::sin(0.3f * f)});
+    m = glm::rotate(m, 0.3f + 0.05f * f, glm::normalize(glm::vec3{1.0f, 0.5f * std::sin(f), 0.25f}));
+    m = glm::scale(m, glm::vec3{0.9f + 0.02f * std::cos(f)});
+    return m;
+}
+
+auto reference_world_from_node(const Node& node) -> glm::mat4
+{
+    glm::mat4 world_from_node = node.parent_from_node();
+    for (std::shared_ptr<Node> parent = node.get_parent_node(); parent; parent = parent->get_parent_node()) {
+        if (!parent->get_parent_node()) {
+            break; // Scene root has identity transform
+        }
+        world_from_node = parent->parent_from_node() * world_from_node;
+    }
+    return world_from_node;
+}
+
+// Tolerance is relative to largest element, as products of different
+// association differ by rounding
+auto is_near(const glm::mat4& lhs, const glm::mat4& rhs) -> bool
+{
+    float magnitude = 1.0f;
+    for (glm::length_t column = 0; column < 4; ++column) {
+        for (glm::length_t row = 0; row < 4; ++row) {
+            magnitude = std::max(magnitude, std::max(std::abs(lhs[column][row]), std::abs(rhs[column][row])));
+        }
+    }
+    for (glm::length_t column = 0; column < 4; ++column) {
+        for (glm::length_t row = 0; row < 4; ++row) {
+            if (std::abs(lhs[column][row] - rhs[column][row]) > 1.0e-4f * magnitude) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto all_match_reference(const std::vector<std::shared_ptr<Node>>& nodes) -> bool
+{
+    return std::all_of(nodes.begin(), nodes.end(), [](const std::shared_ptr<Node>& node) {
+        return is_near(node->world_from_node(), reference_world_from_node(*node));
+    });
+}
+
+auto all_in_depth_bucket(const std::vector<std::shared_ptr<Node>>& nodes) -> bool
+{
+    return std::all_of(nodes.begin(), nodes.end(), [](const std::shared_ptr<Node>& node) {
+        return node->node_data.depth_bucket == node->get_depth();
+    });
+}
+
+auto get_serials(const std::vector<std::shared_ptr<Node>>& nodes) -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> serials;
+    for (const std::shared_ptr<Node>& node : nodes) {
+        serials.push_back(node->node_data.transforms.world_from_node_serial);
+    }
+    return serials;
+}
+
+auto make_node(const std::shared_ptr<Node>& parent, const std::string& name, const std::size_t index) -> std::shared_ptr<Node>
+{
+    auto node = std::make_shared<Node>(name);
+    node->set_parent(parent);
+    node->set_parent_from_node(make_parent_from_node(index));
+    return node;
+}
+
+// Spine of chain_length nodes; every spine node gets leaf_count leaves so
+// that each depth bucket is above Scene parallel bucket size.
+class Test_tree
+{
+public:
+    std::vector<std::shared_ptr<Node>> spine;
+    std::vector<std::shared_ptr<Node>> nodes; // Spine and leaves
+};
+
+auto make_tree(const std::shared_ptr<Node>& parent, const std::string& name, const std::size_t chain_length, const std::size_t leaf_count) -> Test_tree
+{
+    Test_tree tree;
+    std::shared_ptr<Node> spine_parent = parent;
+    for (std::size_t i = 0; i < chain_length; ++i) {
+        auto spine_node = make_node(spine_parent, fmt::format("{} spine {}", name, i), i);
+        tree.spine.push_back(spine_node);
+        tree.nodes.push_back(spine_node);
+        for (std::size_t j = 0; j < leaf_count; ++j) {
+            tree.nodes.push_back(make_node(spine_node, fmt::format("{} leaf {}.{}", name, i, j), i * leaf_count + j));
+        }
+        spine_parent = spine_node;
+    }
+    return tree;
+}
+
+auto get_subtree(const std::shared_ptr<Node>& node) -> std::vector<std::shared_ptr<Node>>
+{
+    std::vector<std::shared_ptr<Node>> nodes{node};
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        for (const auto& child : nodes[i]->get_children()) {
+            auto child_node = std::dynamic_pointer_cast<Node>(child);
+            if (child_node) {
+                nodes.push_back(child_node);
+            }
+        }
+    }
+    return nodes;
+}
+
+void test_ancestor_move(const bool parallel)
+{
+    fmt::print("ancestor move, parallel transform update {}\n", parallel ? "enabled" : "disabled");
+
+    erhe::scene::Scene_message_bus message_bus;
+    Test_scene_host                host{message_bus, "ancestor move"};
+    host.scene.set_parallel_transform_update(parallel);
+
+    const std::shared_ptr<Node> root = host.scene.get_root_node();
+    const Test_tree moved     = make_tree(root, "moved",     8, 300);
+    const Test_tree bystander = make_tree(root, "bystander", 4, 300);
+    host.scene.update_node_transforms();
+    check(all_match_reference(moved.nodes),     "initial update: moved tree matches reference");
+    check(all_match_reference(bystander.nodes), "initial update: bystander tree matches reference");
+    check(all_in_depth_bucket(moved.nodes),     "initial update: nodes in depth buckets of their depth");
+
+    // Update without changes touches nothing
+    {
+        const std::vector<uint64_t> moved_serials     = get_serials(moved.nodes);
+        const std::vector<uint64_t> bystander_serials = get_serials(bystander.nodes);
+        host.scene.update_node_transforms();
+        check(get_serials(moved.nodes)     == moved_serials,     "clean update: moved tree serials unchanged");
+        check(get_serials(bystander.nodes) == bystander_serials, "clean update: bystander tree serials unchanged");
+    }
+
+    // Move ancestor near top of the spine, so its descendants span many buckets
+    const std::shared_ptr<Node>& ancestor = moved.spine[1];
+    const std::vector<std::shared_ptr<Node>> descendants = get_subtree(ancestor);
+    const std::vector<uint64_t> bystander_serials = get_serials(bystander.nodes);
+    const std::vector<uint64_t> above_serials     = get_serials(std::vector<std::shared_ptr<Node>>(moved.nodes.begin(), moved.nodes.begin() + 301));
+    ancestor->set_parent_from_node(glm::rotate(make_parent_from_node(100), 1.0f, glm::vec3{0.0f, 1.0f, 0.0f}));
+    check(moved.spine[2]->is_transform_dirty(), "ancestor move: child of moved ancestor dirty before update");
+
+    host.scene.update_node_transforms();
+    check(all_match_reference(descendants),                 "ancestor move: every descendant matches reference");
+    check(all_match_reference(moved.nodes),                 "ancestor move: moved tree matches reference");
+    check(all_match_reference(bystander.nodes),             "ancestor move: bystander tree matches reference");
+    check(get_serials(bystander.nodes) == bystander_serials, "ancestor move: bystander tree not touched");
+    check(
+        get_serials(std::vector<std::shared_ptr<Node>>(moved.nodes.begin(), moved.nodes.begin() + 301)) == above_serials,
+        "ancestor move: nodes above moved ancestor not touched"
+    );
+    check(
+        std::none_of(descendants.begin(), descendants.end(), [](const std::shared_ptr<Node>& node) { return node->is_transform_dirty(); }),
+        "ancestor move: no descendant left dirty"
+    );
+
+    // Leaf move only touches that leaf
+    const std::shared_ptr<Node>& leaf = moved.nodes[5];
+    const std::vector<uint64_t> serials_before_leaf_move = get_serials(moved.nodes);
+    leaf->set_parent_from_node(make_parent_from_node(7));
+    host.scene.update_node_transforms();
+    std::vector<uint64_t> serials_after_leaf_move = get_serials(moved.nodes);
+    check(serials_after_leaf_move[5] != serials_before_leaf_move[5], "leaf move: leaf serial updated");
+    serials_after_leaf_move[5] = serials_before_leaf_move[5];
+    check(serials_after_leaf_move == serials_before_leaf_move,        "leaf move: other nodes not touched");
+    check(all_match_reference(moved.nodes),                           "leaf move: moved tree matches reference");
+}
+
+void test_reparent_within_scene(const bool parallel)
+{
+    fmt::print("reparent within scene, parallel transform update {}\n", parallel ? "enabled" : "disabled");
+
+    erhe::scene::Scene_message_bus message_bus;
+    Test_scene_host                host{message_bus, "reparent"};
+    host.scene.set_parallel_transform_update(parallel);
+
+    const std::shared_ptr<Node> root  = host.scene.get_root_node();
+    const Test_tree deep    = make_tree(root, "deep",    10, 260);
+    const Test_tree shallow = make_tree(root, "shallow",  2, 260);
+    host.scene.update_node_transforms();
+
+    // Move subtree from depth 8 to depth 2
+    const std::shared_ptr<Node>&             subtree_root = deep.spine[7];
+    const std::vector<std::shared_ptr<Node>> subtree      = get_subtree(subtree_root);
+    std::vector<glm::mat4> world_before;
+    for (const std::shared_ptr<Node>& node : subtree) {
+        world_before.push_back(node->world_from_node());
+    }
+    subtree_root->set_parent(shallow.spine[0]);
+    check(subtree_root->get_depth() == 2,  "reparent within scene: subtree root moved to depth 2");
+    check(all_in_depth_bucket(subtree),    "reparent within scene: subtree moved to new depth buckets");
+    check(all_in_depth_bucket(deep.nodes), "reparent within scene: remaining nodes keep depth buckets");
+    host.scene.update_node_transforms();
+    bool world_kept = true;
+    for (std::size_t i = 0, end = subtree.size(); i < end; ++i) {
+        world_kept = world_kept && is_near(subtree[i]->world_from_node(), world_before[i]);
+    }
+    check(world_kept,                         "reparent within scene: world transforms kept");
+    check(all_match_reference(subtree),       "reparent within scene: subtree matches reference");
+    check(all_match_reference(deep.nodes),    "reparent within scene: old tree matches reference");
+    check(all_match_reference(shallow.nodes), "reparent within scene: new tree matches reference");
+
+    // Moving new ancestor reaches the moved subtree; moving old one does not
+    const std::vector<uint64_t> subtree_serials = get_serials(subtree);
+    deep.spine[0]->set_parent_from_node(make_parent_from_node(42));
+    host.scene.update_node_transforms();
+    check(get_serials(subtree) == subtree_serials, "reparent within scene: old ancestor move does not touch subtree");
+    check(all_match_reference(deep.nodes),         "reparent within scene: old tree matches reference after move");
+    shallow.spine[0]->set_parent_from_node(make_parent_from_node(43));
+    host.scene.update_node_transforms();
+    check(all_match_reference(subtree),            "reparent within scene: subtree follows new ancestor");
+    check(all_match_reference(shallow.nodes),      "reparent within scene: new tree matches reference after move");
+
+    // Move subtree back to depth 8
+    subtree_root->set_parent(deep.spine[6]);
+    check(all_in_depth_bucket(subtree),            "reparent deeper: subtree moved to new depth buckets");
+    deep.spine[3]->set_parent_from_node(make_parent_from_node(44));
+    host.scene.update_node_transforms();
+    check(all_match_reference(subtree),            "reparent deeper: subtree follows new ancestor");
+    check(all_match_reference(deep.nodes),         "reparent deeper: tree matches reference");
+}
+
+void test_reparent_across_scenes(const bool parallel)
+{
+    fmt::print("reparent across scenes, parallel transform update {}\n", parallel ? "enabled" : "disabled");
+
+    erhe::scene::Scene_message_bus message_bus;
+    Test_scene_host                source_host{message_bus, "source"};
+    Test_scene_host                target_host{message_bus, "target"};
+    source_host.scene.set_parallel_transform_update(parallel);
+    target_host.scene.set_parallel_transform_update(parallel);
+
+    const Test_tree source = make_tree(source_host.scene.get_root_node(), "source", 6, 260);
+    const Test_tree target = make_tree(target_host.scene.get_root_node(), "target", 3, 260);
+    source_host.scene.update_node_transforms();
+    target_host.scene.update_node_transforms();
+
+    const std::shared_ptr<Node>&             subtree_root = source.spine[2];
+    const std::vector<std::shared_ptr<Node>> subtree      = get_subtree(subtree_root);
+    std::vector<glm::mat4> world_before;
+    for (const std::shared_ptr<Node>& node : subtree) {
+        world_before.push_back(node->world_from_node());
+    }
+    subtree_root->set_parent(target.spine[2]);
+    check(
+        std::all_of(subtree.begin(), subtree.end(), [&](const std::shared_ptr<Node>& node) { return node->get_scene() == &target_host.scene; }),
+        "reparent across scenes: subtree hosted by target scene"
+    );
+    check(all_in_depth_bucket(subtree), "reparent across scenes: subtree in target depth buckets");
+    const auto& source_nodes = source_host.scene.get_flat_nodes();
+    check(
+        std::none_of(subtree.begin(), subtree.end(), [&](const std::shared_ptr<Node>& node) {
+            return std::find(source_nodes.begin(), source_nodes.end(), node) != source_nodes.end();
+        }),
+        "reparent across scenes: subtree removed from source scene"
+    );
+
+    source_host.scene.update_node_transforms();
+    target_host.scene.update_node_transforms();
+    bool world_kept = true;
+    for (std::size_t i = 0, end = subtree.size(); i < end; ++i) {
+        world_kept = world_kept && is_near(subtree[i]->world_from_node(), world_before[i]);
+    }
+    check(world_kept,                   "reparent across scenes: world transforms kept");
+    check(all_match_reference(subtree), "reparent across scenes: subtree matches reference");
+
+    // Source scene no longer updates the subtree; target scene does
+    const std::vector<uint64_t> subtree_serials = get_serials(subtree);
+    source.spine[0]->set_parent_from_node(make_parent_from_node(50));
+    source_host.scene.update_node_transforms();
+    check(get_serials(subtree) == subtree_serials, "reparent across scenes: source scene update does not touch subtree");
+    check(all_match_reference(std::vector<std::shared_ptr<Node>>(source.nodes.begin(), source.nodes.begin() + 2 * 261)), "reparent across scenes: source tree matches reference");
+    target.spine[0]->set_parent_from_node(make_parent_from_node(51));
+    target_host.scene.update_node_transforms();
+    check(all_match_reference(subtree),       "reparent across scenes: subtree follows target ancestor");
+    check(all_match_reference(target.nodes),  "reparent across scenes: target tree matches reference");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::scene::initialize_logging();
+
+    for (const bool parallel : { false, true }) {
+        test_ancestor_move         (parallel);
+        test_reparent_within_scene (parallel);
+        test_reparent_across_scenes(parallel);
+    }
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} check(s) failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("node transform tests passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+// Benchmark for Mesh_layer id lookups and add / remove with 100k meshes
+//
+// Compares the hashed id index against a linear scan over the mesh
+// vector, which is what lookups did before the index existed.
+
+#include "erhe_scene/mesh.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* label, const std::size_t operation_count, const double seconds)
+{
+    fmt::print(
+        "{:<28} {:>8} ops {:>10.3f} ms {:>10.1f} ns/op\n",
+        label, operation_count, seconds * 1000.0, seconds * 1.0e9 / static_cast<double>(operation_count)
+    );
+}
+
+auto linear_find(const erhe::scene::Mesh_layer& mesh_layer, const std::size_t id) -> std::shared_ptr<erhe::scene::Mesh>
+{
+    for (const auto& mesh : mesh_layer.meshes) {
+        if (mesh->get_id() == id) {
+            return mesh;
+        }
+    }
+    return {};
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t mesh_count   = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 100'000;
+    const std::size_t lookup_count = 100'000;
+    const std::size_t linear_count = 1'000; // linear scans are slow, time fewer of them
+
+    erhe::log::initialize_log_sinks();
+    erhe::scene::initialize_logging();
+
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> meshes;
+    meshes.reserve(mesh_count);
+    for (std::size_t i = 0; i < mesh_count; ++i) {
+        meshes.push_back(std::make_shared<erhe::scene::Mesh>(fmt::format("mesh {}", i)));
+    }
+
+    erhe::scene::Mesh_layer mesh_layer{"benchmark", 0, 0};
+
+    auto start = Clock::now();
+    for (const auto& mesh : meshes) {
+        mesh_layer.add(mesh);
+    }
+    report("Mesh_layer::add", mesh_count, seconds_since(start));
+
+    std::mt19937_64 random_engine{12345};
+    std::uniform_int_distribution<std::size_t> distribution{0, mesh_count - 1};
+    std::vector<std::size_t> lookup_ids(lookup_count);
+    for (std::size_t& id : lookup_ids) {
+        id = meshes[distribution(random_engine)]->get_id();
+    }
+
+    std::size_t found_count = 0;
+    start = Clock::now();
+    for (const std::size_t id : lookup_ids) {
+        found_count += mesh_layer.get_mesh_by_id(id) ? 1 : 0;
+    }
+    report("get_mesh_by_id (hashed)", lookup_count, seconds_since(start));
+
+    std::size_t linear_found_count = 0;
+    start = Clock::now();
+    for (std::size_t i = 0; i < linear_count; ++i) {
+        linear_found_count += linear_find(mesh_layer, lookup_ids[i]) ? 1 : 0;
+    }
+    report("linear scan (previous)", linear_count, seconds_since(start));
+
+    if ((found_count != lookup_count) || (linear_found_count != linear_count)) {
+        fmt::print(stderr, "lookup failed: {} / {} hashed, {} / {} linear\n", found_count, lookup_count, linear_found_count, linear_count);
+        return EXIT_FAILURE;
+    }
+
+    // Remove in random order, exercising swap-remove index updates
+    std::shuffle(meshes.begin(), meshes.end(), random_engine);
+    start = Clock::now();
+    for (const auto& mesh : meshes) {
+        mesh_layer.remove(mesh);
+    }
+    report("Mesh_layer::remove", mesh_count, seconds_since(start));
+
+    if (!mesh_layer.meshes.empty()) {
+        fmt::print(stderr, "{} meshes left in layer after removing all\n", mesh_layer.meshes.size());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -10,14 +10,17 @@
 #include "erhe_graphics/opengl_state_tracker.hpp"
 #include "erhe_graphics/shader_stages.hpp"
 #include "erhe_graphics/state/vertex_input_state.hpp"
+#include "erhe_primitive/lod.hpp"
 #include "erhe_scene/camera.hpp"
 #include "erhe_scene/light.hpp"
+#include "erhe_scene/node.hpp"
 #include "erhe_scene_renderer/scene_renderer_log.hpp"
 #include "erhe_scene_renderer/program_interface.hpp"
 #include "erhe_scene_renderer/shadow_renderer.hpp"
 #include "erhe_profile/profile.hpp"
 
 #include <functional>
+#include <optional>
 
 namespace erhe::scene_renderer {
 
@@ -73,6 +76,27 @@ const char* safe_str(const char* str)
 
 }
 
+auto Forward_renderer::cull_mesh_spans(const Render_parameters& parameters) -> const std::vector<std::span<const std::shared_ptr<erhe::scene::Mesh>>>&
+{
+    const auto* camera = parameters.camera;
+    if (!parameters.frustum_culling || (camera == nullptr) || (camera->get_node() == nullptr)) {
+        return parameters.mesh_spans;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    const glm::mat4 clip_from_world = camera->projection_transforms(parameters.viewport).clip_from_world.get_matrix();
+    const std::size_t span_count = parameters.mesh_spans.size();
+    if (m_frustum_cullers.size() < span_count) {
+        m_frustum_cullers.resize(span_count);
+    }
+    m_visible_mesh_spans.clear();
+    for (std::size_t i = 0; i < span_count; ++i) {
+        m_visible_mesh_spans.push_back(m_frustum_cullers[i].cull(clip_from_world, parameters.mesh_spans[i]));
+    }
+    return m_visible_mesh_spans;
+}
+
 void Forward_renderer::render(const Render_parameters& parameters)
 {
     ERHE_PROFILE_FUNCTION();
@@ -84,7 +108,7 @@ void Forward_renderer::render(const Render_parameters& parameters)
 
     const auto& viewport       = parameters.viewport;
     const auto* camera         = parameters.camera;
-    const auto& mesh_spans     = parameters.mesh_spans;
+    const auto& mesh_spans     = cull_mesh_spans(parameters);
     const auto& lights         = parameters.lights;
     const auto& skins          = parameters.skins;
     const auto& materials      = parameters.materials;
@@ -115,6 +139,16 @@ void Forward_renderer::render(const Render_parameters& parameters)
         m_camera_buffers.bind(range);
     }
 
+    std::optional<erhe::primitive::Lod_selection> lod_selection;
+    if ((parameters.lod_max_pixel_error > 0.0f) && (camera != nullptr) && (camera->get_node() != nullptr)) {
+        lod_selection = erhe::primitive::make_lod_selection(
+            camera->projection_transforms(viewport).clip_from_camera.get_matrix(),
+            camera->get_node()->world_from_node(),
+            static_cast<float>(viewport.height),
+            parameters.lod_max_pixel_error
+        );
+    }
+
     if (!m_graphics_instance.info.use_bindless_texture) {
         m_graphics_instance.texture_unit_cache_reset(m_base_texture_unit);
     }
@@ -186,7 +220,7 @@ void Forward_renderer::render(const Render_parameters& parameters)
 
             std::size_t primitive_count{0};
             const auto primitive_range            = m_primitive_buffers.update(meshes, primitive_mode, filter, parameters.primitive_settings, primitive_count);
-            const auto draw_indirect_buffer_range = m_draw_indirect_buffers.update(meshes, primitive_mode, filter);
+            const auto draw_indirect_buffer_range = m_draw_indirect_buffers.update(meshes, primitive_mode, filter, lod_selection.has_value() ? &lod_selection.value() : nullptr);
             if (draw_indirect_buffer_range.draw_indirect_count == 0) {
                 continue;
             }
@@ -6,6 +6,7 @@
 #include "erhe_renderer/draw_indirect_buffer.hpp"
 #include "erhe_renderer/pipeline_renderpass.hpp"
 #include "erhe_scene_renderer/camera_buffer.hpp"
+#include "erhe_scene_renderer/frustum_culler.hpp"
 #include "erhe_scene_renderer/joint_buffer.hpp"
 #include "erhe_scene_renderer/light_buffer.hpp"
 #include "erhe_scene_renderer/material_buffer.hpp"
@@ -59,6 +60,8 @@ public:
         const std::vector<erhe::renderer::Pipeline_renderpass*>            passes;
         erhe::primitive::Primitive_mode                                    primitive_mode{erhe::primitive::Primitive_mode::polygon_fill};
         Primitive_interface_settings                                       primitive_settings{};
+        bool                                                               frustum_culling{false}; // Skip meshes outside camera frustum, opt-in. Requires camera
+        float                                                              lod_max_pixel_error{0.0f}; // Projected error allowed for reduced detail polygon fill, 0 disables. Requires camera
         const erhe::graphics::Texture*                                     shadow_texture{nullptr};
         const erhe::math::Viewport&                                        viewport;
         const erhe::Item_filter                                            filter{};
@@ -74,6 +77,8 @@ public:
     void next_frame();
 
 private:
+    [[nodiscard]] auto cull_mesh_spans(const Render_parameters& parameters) -> const std::vector<std::span<const std::shared_ptr<erhe::scene::Mesh>>>&;
+
     erhe::graphics::Instance&                m_graphics_instance;
     Program_interface&                       m_program_interface;
     int                                      m_base_texture_unit{0};
@@ -85,6 +90,10 @@ private:
     Primitive_buffer                         m_primitive_buffers;
     erhe::graphics::Sampler                  m_nearest_sampler;
     std::shared_ptr<erhe::graphics::Texture> m_dummy_texture;
+
+    // One culler per mesh span, culled lists are reused by all passes
+    std::vector<Frustum_culler>                                      m_frustum_cullers;
+    std::vector<std::span<const std::shared_ptr<erhe::scene::Mesh>>> m_visible_mesh_spans;
 };
 
 } // namespace erhe::scene_renderer
@@ -0,0 +1,258 @@
+#include "erhe_scene_renderer/frustum_culler.hpp"
+
+#include "erhe_concurrency/thread_pool.hpp"
+#include "erhe_math/math_util.hpp"
+#include "erhe_primitive/primitive.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_scene/mesh.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define ERHE_SCENE_RENDERER_USE_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+namespace erhe::scene_renderer {
+
+void Frustum_cull_bounds::resize(const std::size_t count)
+{
+    const std::size_t padded_count = (count + 3) & ~std::size_t{3};
+    m_size = count;
+    center_x      .resize(padded_count);
+    center_y      .resize(padded_count);
+    center_z      .resize(padded_count);
+    extent_x      .resize(padded_count);
+    extent_y      .resize(padded_count);
+    extent_z      .resize(padded_count);
+    always_visible.resize(padded_count);
+}
+
+void Frustum_cull_bounds::set(const std::size_t index, const glm::vec3& center, const glm::vec3& extent)
+{
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+    extent_x[index] = extent.x;
+    extent_y[index] = extent.y;
+    extent_z[index] = extent.z;
+    always_visible[index] = 0;
+}
+
+void Frustum_cull_bounds::clear(const std::size_t index, const bool always_visible_)
+{
+    set(index, glm::vec3{0.0f}, glm::vec3{0.0f});
+    always_visible[index] = always_visible_ ? 1 : 0;
+}
+
+auto Frustum_cull_bounds::size() const -> std::size_t
+{
+    return m_size;
+}
+
+auto Frustum_cull_bounds::padded_size() const -> std::size_t
+{
+    return center_x.size();
+}
+
+void Frustum_culler::set_parallel(const bool enable)
+{
+    m_parallel = enable;
+}
+
+auto Frustum_culler::get_statistics() const -> const Frustum_culler_statistics&
+{
+    return m_statistics;
+}
+
+auto Frustum_culler::extract_planes(const glm::mat4& m) -> std::array<glm::vec4, 6>
+{
+    const glm::vec4 row_0{m[0][0], m[1][0], m[2][0], m[3][0]};
+    const glm::vec4 row_1{m[0][1], m[1][1], m[2][1], m[3][1]};
+    const glm::vec4 row_2{m[0][2], m[1][2], m[2][2], m[3][2]};
+    const glm::vec4 row_3{m[0][3], m[1][3], m[2][3], m[3][3]};
+    return {
+        row_3 + row_0, // left
+        row_3 - row_0, // right
+        row_3 + row_1, // bottom
+        row_3 - row_1, // top
+        row_3 + row_2, // near (-w <= z)
+        row_3 - row_2  // far  (z <= w)
+    };
+}
+
+void Frustum_culler::gather_bounds(
+    const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+    const std::size_t                                          begin,
+    const std::size_t                                          end
+)
+{
+    const std::size_t mesh_count = meshes.size();
+    for (std::size_t i = begin; i < end; ++i) {
+        if (i >= mesh_count) {
+            m_bounds.clear(i, false); // padding
+            continue;
+        }
+
+        const erhe::scene::Mesh* mesh = meshes[i].get();
+        const erhe::scene::Node* node = (mesh != nullptr) ? mesh->get_node() : nullptr;
+        if ((node == nullptr) || mesh->skin) {
+            m_bounds.clear(i, true);
+            continue;
+        }
+
+        erhe::math::Bounding_box bounding_box{};
+        for (const erhe::primitive::Primitive& primitive : mesh->get_primitives()) {
+            bounding_box.include(primitive.get_bounding_box());
+        }
+        if (!bounding_box.is_valid()) {
+            m_bounds.clear(i, true);
+            continue;
+        }
+
+        // World space AABB of transformed local AABB (Arvo)
+        const glm::mat4 world_from_node = node->world_from_node();
+        const glm::vec3 local_center    = bounding_box.center();
+        const glm::vec3 local_extent    = 0.5f * bounding_box.diagonal();
+        const glm::vec3 center          = glm::vec3{world_from_node * glm::vec4{local_center, 1.0f}};
+        const glm::vec3 extent =
+            glm::abs(glm::vec3{world_from_node[0]}) * local_extent.x +
+            glm::abs(glm::vec3{world_from_node[1]}) * local_extent.y +
+            glm::abs(glm::vec3{world_from_node[2]}) * local_extent.z;
+        m_bounds.set(i, center, extent);
+    }
+}
+
+void Frustum_culler::test_bounds(
+    const std::array<glm::vec4, 6>& planes,
+    const Frustum_cull_bounds&      bounds,
+    const std::size_t               begin,
+    const std::size_t               end,
+    const std::span<uint8_t>        visible
+)
+{
+    ERHE_VERIFY((begin % 4) == 0);
+    ERHE_VERIFY((end % 4) == 0);
+    ERHE_VERIFY(end <= bounds.padded_size());
+    ERHE_VERIFY(end <= visible.size());
+
+#if defined(ERHE_SCENE_RENDERER_USE_SSE2)
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (std::size_t i = begin; i < end; i += 4) {
+        const __m128 center_x = _mm_loadu_ps(&bounds.center_x[i]);
+        const __m128 center_y = _mm_loadu_ps(&bounds.center_y[i]);
+        const __m128 center_z = _mm_loadu_ps(&bounds.center_z[i]);
+        const __m128 extent_x = _mm_loadu_ps(&bounds.extent_x[i]);
+        const __m128 extent_y = _mm_loadu_ps(&bounds.extent_y[i]);
+        const __m128 extent_z = _mm_loadu_ps(&bounds.extent_z[i]);
+        __m128 outside = _mm_setzero_ps();
+        for (const glm::vec4& plane : planes) {
+            const __m128 plane_x = _mm_set1_ps(plane.x);
+            const __m128 plane_y = _mm_set1_ps(plane.y);
+            const __m128 plane_z = _mm_set1_ps(plane.z);
+            const __m128 plane_w = _mm_set1_ps(plane.w);
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane_x, center_x), _mm_mul_ps(plane_y, center_y)),
+                _mm_add_ps(_mm_mul_ps(plane_z, center_z), plane_w)
+            );
+            const __m128 radius = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_and_ps(plane_x, sign_mask), extent_x),
+                    _mm_mul_ps(_mm_and_ps(plane_y, sign_mask), extent_y)
+                ),
+                _mm_mul_ps(_mm_and_ps(plane_z, sign_mask), extent_z)
+            );
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+        const int outside_mask = _mm_movemask_ps(outside);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            visible[i + lane] = (((outside_mask >> lane) & 1) == 0) || (bounds.always_visible[i + lane] != 0) ? 1 : 0;
+        }
+    }
+#else
+    for (std::size_t i = begin; i < end; ++i) {
+        bool outside = false;
+        for (const glm::vec4& plane : planes) {
+            const float distance =
+                plane.x * bounds.center_x[i] +
+                plane.y * bounds.center_y[i] +
+                plane.z * bounds.center_z[i] +
+                plane.w;
+            const float radius =
+                std::abs(plane.x) * bounds.extent_x[i] +
+                std::abs(plane.y) * bounds.extent_y[i] +
+                std::abs(plane.z) * bounds.extent_z[i];
+            outside = outside || (distance + radius < 0.0f);
+        }
+        visible[i] = !outside || (bounds.always_visible[i] != 0) ? 1 : 0;
+    }
+#endif
+}
+
+void Frustum_culler::compact(
+    const std::span<const uint8_t>                             visible,
+    const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+    std::vector<std::shared_ptr<erhe::scene::Mesh>>&           out_meshes
+)
+{
+    ERHE_VERIFY(visible.size() >= meshes.size());
+    for (std::size_t i = 0, end = meshes.size(); i < end; ++i) {
+        if (visible[i] != 0) {
+            out_meshes.push_back(meshes[i]);
+        }
+    }
+}
+
+auto Frustum_culler::cull_mask(
+    const glm::mat4&                                           clip_from_world,
+    const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes
+) -> std::span<const uint8_t>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    m_planes = extract_planes(clip_from_world);
+
+    const std::size_t mesh_count = meshes.size();
+    m_bounds.resize(mesh_count);
+    const std::size_t padded_count = m_bounds.padded_size();
+    m_visible.resize(padded_count);
+
+    // Ranges are processed in groups of four so that SIMD lanes never straddle ranges
+    const std::size_t group_count = padded_count / 4;
+    const auto process_groups = [this, &meshes](const std::size_t group_begin, const std::size_t group_end) {
+        gather_bounds(meshes, group_begin * 4, group_end * 4);
+        test_bounds(m_planes, m_bounds, group_begin * 4, group_end * 4, m_visible);
+    };
+    if (m_parallel && (mesh_count >= c_parallel_min_mesh_count)) {
+        erhe::concurrency::Thread_pool::get_instance().parallel_for(
+            0, group_count, process_groups, c_parallel_min_mesh_count / 16
+        );
+    } else {
+        process_groups(0, group_count);
+    }
+
+    std::size_t visible_count = 0;
+    for (std::size_t i = 0; i < mesh_count; ++i) {
+        visible_count += (m_visible[i] != 0) ? 1 : 0;
+    }
+    m_statistics.tested_count  = mesh_count;
+    m_statistics.visible_count = visible_count;
+    return std::span<const uint8_t>{m_visible.data(), mesh_count};
+}
+
+auto Frustum_culler::cull(
+    const glm::mat4&                                           clip_from_world,
+    const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes
+) -> std::span<const std::shared_ptr<erhe::scene::Mesh>>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::span<const uint8_t> visible = cull_mask(clip_from_world, meshes);
+    m_visible_meshes.clear();
+    compact(visible, meshes, m_visible_meshes);
+    return std::span<const std::shared_ptr<erhe::scene::Mesh>>{m_visible_meshes};
+}
+
+} // namespace erhe::scene_renderer
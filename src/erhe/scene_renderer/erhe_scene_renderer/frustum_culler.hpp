@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace erhe::scene {
+    class Mesh;
+}
+
+namespace erhe::scene_renderer {
+
+class Frustum_culler_statistics
+{
+public:
+    std::size_t tested_count {0};
+    std::size_t visible_count{0};
+};
+
+// World space bounding boxes in structure of arrays form, as consumed by
+// Frustum_culler::test_bounds(). Storage is padded to a multiple of four;
+// padding entries are zero sized boxes at origin.
+class Frustum_cull_bounds
+{
+public:
+    void resize(std::size_t count);
+    void set   (std::size_t index, const glm::vec3& center, const glm::vec3& extent);
+    void clear (std::size_t index, bool always_visible);
+
+    [[nodiscard]] auto size       () const -> std::size_t;
+    [[nodiscard]] auto padded_size() const -> std::size_t;
+
+    std::vector<float>   center_x;
+    std::vector<float>   center_y;
+    std::vector<float>   center_z;
+    std::vector<float>   extent_x;
+    std::vector<float>   extent_y;
+    std::vector<float>   extent_z;
+    std::vector<uint8_t> always_visible;
+
+private:
+    std::size_t m_size{0};
+};
+
+// CPU view frustum culling for mesh spans.
+//
+// World space bounding boxes of meshes are gathered into structure of
+// arrays form and tested against frustum planes extracted from a
+// clip_from_world matrix, four boxes at a time. cull_mask() returns one
+// visibility entry per mesh, which Draw_indirect_buffer::update() uses
+// to emit draws for a subset of meshes whose primitive records have been
+// written once. cull() additionally compacts visible meshes into a list,
+// in the original order, which can be passed in place of the original
+// span. Large spans are processed using the thread pool.
+//
+// Test is conservative: boxes intersecting the frustum are kept, and
+// the depth planes accept the -w <= z <= w range so that results are
+// valid for both depth conventions. Skinned meshes and meshes without
+// bounds are never culled.
+class Frustum_culler
+{
+public:
+    static constexpr std::size_t c_parallel_min_mesh_count = 1024;
+
+    // Returned span has one entry per mesh, nonzero for visible meshes,
+    // and is valid until next cull_mask() or cull() call
+    [[nodiscard]] auto cull_mask(
+        const glm::mat4&                                           clip_from_world,
+        const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes
+    ) -> std::span<const uint8_t>;
+
+    // Returned span is valid until next cull_mask() or cull() call
+    [[nodiscard]] auto cull(
+        const glm::mat4&                                           clip_from_world,
+        const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes
+    ) -> std::span<const std::shared_ptr<erhe::scene::Mesh>>;
+
+    void set_parallel(bool enable);
+
+    [[nodiscard]] auto get_statistics() const -> const Frustum_culler_statistics&;
+
+    // Plane (x, y, z, w): point p is inside when dot(xyz, p) + w >= 0
+    [[nodiscard]] static auto extract_planes(const glm::mat4& clip_from_world) -> std::array<glm::vec4, 6>;
+
+    // Writes visible[i] for begin <= i < end; begin and end must be multiples of four
+    static void test_bounds(
+        const std::array<glm::vec4, 6>& planes,
+        const Frustum_cull_bounds&      bounds,
+        std::size_t                     begin,
+        std::size_t                     end,
+        std::span<uint8_t>              visible
+    );
+
+    // Appends meshes with nonzero visible entry to out_meshes, in order
+    static void compact(
+        std::span<const uint8_t>                                   visible,
+        const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes,
+        std::vector<std::shared_ptr<erhe::scene::Mesh>>&           out_meshes
+    );
+
+private:
+    void gather_bounds(const std::span<const std::shared_ptr<erhe::scene::Mesh>>& meshes, std::size_t begin, std::size_t end);
+
+    std::array<glm::vec4, 6>                        m_planes;
+    bool                                            m_parallel{true};
+    Frustum_cull_bounds                             m_bounds;
+    std::vector<uint8_t>                            m_visible;
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> m_visible_meshes;
+    Frustum_culler_statistics                       m_statistics;
+};
+
+} // namespace erhe::scene_renderer
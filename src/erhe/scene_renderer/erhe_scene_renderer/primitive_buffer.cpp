@@ -12,6 +12,8 @@
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <span>
+
 namespace erhe::scene_renderer {
 
 Primitive_interface::Primitive_interface(erhe::graphics::Instance& graphics_instance)
@@ -24,7 +26,9 @@ Primitive_interface::Primitive_interface(erhe::graphics::Instance& graphics_inst
         .material_index           = primitive_struct.add_uint ("material_index"          )->offset_in_parent(),
         .size                     = primitive_struct.add_float("size"                    )->offset_in_parent(),
         .skinning_factor          = primitive_struct.add_float("skinning_factor"         )->offset_in_parent(),
-        .base_joint_index         = primitive_struct.add_uint ("base_joint_index"        )->offset_in_parent()
+        .base_joint_index         = primitive_struct.add_uint ("base_joint_index"        )->offset_in_parent(),
+        .position_scale           = primitive_struct.add_vec4 ("position_scale"          )->offset_in_parent(),
+        .position_offset          = primitive_struct.add_vec4 ("position_offset"         )->offset_in_parent()
     }
 {
     const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "renderer");
@@ -45,6 +49,16 @@ Primitive_buffer::Primitive_buffer(erhe::graphics::Instance& graphics_instance,
     );
 }
 
+void Primitive_buffer::next_frame()
+{
+    Multi_buffer::next_frame();
+
+    ++m_frame_serial;
+    if ((m_frame_serial % c_cache_eviction_interval) == 0) {
+        evict_unused_mesh_record_caches();
+    }
+}
+
 void Primitive_buffer::reset_id_ranges()
 {
     m_id_offset = 0;
@@ -104,6 +118,8 @@ auto Primitive_buffer::update(
         primitive_count += mesh->get_primitives().size();
     }
 
+    m_rebuilt_mesh_count = 0;
+
     auto&             buffer             = get_current_buffer();
     auto&             writer             = get_writer();
     const auto        entry_size         = m_primitive_interface.primitive_struct.size_bytes();
@@ -132,13 +148,16 @@ auto Primitive_buffer::update(
             break;
         }
 
-        const glm::mat4 world_from_node = node->world_from_node();
+        Mesh_record_cache& cache = get_mesh_record_cache(*mesh.get(), *node);
 
-        // TODO Use compute shader
-        const glm::mat4 world_from_node_cofactor = erhe::math::compute_cofactor(world_from_node);
+        const auto&     skin             = mesh->skin;
+        const float     skinning_factor  = skin ? 1.0f : 0.0f;
+        const uint32_t  base_joint_index = skin ? skin->skin_data.joint_buffer_index : 0;
 
         std::size_t mesh_primitive_index{0};
-        for (const auto& primitive : mesh->get_primitives()) {
+        const auto& primitives = mesh->get_primitives();
+        for (std::size_t i = 0, end = primitives.size(); i < end; ++i) {
+            const auto& primitive = primitives[i];
             if ((writer.write_offset + entry_size) > writer.write_end) {
                 log_render->critical("primitive buffer capacity {} exceeded", buffer.capacity_byte_count());
                 ERHE_FATAL("primitive buffer capacity exceeded");
@@ -165,9 +184,8 @@ auto Primitive_buffer::update(
             const glm::vec3 id_offset_vec3   = erhe::math::vec3_from_uint(m_id_offset);
             const glm::vec4 id_offset_vec4   = glm::vec4{id_offset_vec3, 0.0f};
             const uint32_t  material_index   = (material != nullptr) ? material->material_buffer_index : 0u;
-            const auto&     skin             = mesh->skin;
-            const float     skinning_factor  = skin ? 1.0f : 0.0f;
-            const uint32_t  base_joint_index = skin ? skin->skin_data.joint_buffer_index : 0;
+            const glm::vec4 position_scale   = glm::vec4{buffer_mesh->position_scale,  0.0f};
+            const glm::vec4 position_offset  = glm::vec4{buffer_mesh->position_offset, 0.0f};
 
             SPDLOG_LOGGER_TRACE(
                 log_primitive_buffer, 
@@ -181,6 +199,23 @@ auto Primitive_buffer::update(
             );
 
             using erhe::graphics::as_span;
+            using erhe::graphics::write;
+
+            // Material buffer indices and joint buffer indices are assigned
+            // per frame, so these are compared rather than tracked
+            const std::span<std::byte> record{cache.record_data.data() + i * entry_size, entry_size};
+            Cached_primitive& cached = cache.primitives[i];
+            if (cached.material_index != material_index) {
+                cached.material_index = material_index;
+                write(record, offsets.material_index, as_span(material_index));
+            }
+            if ((cached.base_joint_index != base_joint_index) || (cached.skinning_factor != skinning_factor)) {
+                cached.base_joint_index = base_joint_index;
+                cached.skinning_factor  = skinning_factor;
+                write(record, offsets.skinning_factor,  as_span(skinning_factor ));
+                write(record, offsets.base_joint_index, as_span(base_joint_index));
+            }
+
             const auto color_span =
                 (settings.color_source == Primitive_color_source::id_offset           ) ? as_span(id_offset_vec4         ) :
                 (settings.color_source == Primitive_color_source::mesh_wireframe_color) ? as_span(wireframe_color        ) :
@@ -189,18 +224,13 @@ auto Primitive_buffer::update(
                 (settings.size_source == Primitive_size_source::mesh_point_size) ? as_span(mesh->point_size      ) :
                 (settings.size_source == Primitive_size_source::mesh_line_width) ? as_span(mesh->line_width      ) :
                                                                                    as_span(settings.constant_size);
-            //memset(reinterpret_cast<uint8_t*>(model_gpu_data.data()) + offset, 0, entry_size);
             {
                 //ZoneScopedN("write");
-                using erhe::graphics::write;
-                write(primitive_gpu_data, writer.write_offset + offsets.world_from_node,          as_span(world_from_node         ));
-                write(primitive_gpu_data, writer.write_offset + offsets.world_from_node_cofactor, as_span(world_from_node_cofactor));
-                write(primitive_gpu_data, writer.write_offset + offsets.color,                    color_span                       );
-                write(primitive_gpu_data, writer.write_offset + offsets.material_index,           as_span(material_index          ));
-                write(primitive_gpu_data, writer.write_offset + offsets.size,                     size_span                        );
-                write(primitive_gpu_data, writer.write_offset + offsets.skinning_factor,          as_span(skinning_factor         ));
-                write(primitive_gpu_data, writer.write_offset + offsets.base_joint_index,         as_span(base_joint_index        ));
-
+                write(primitive_gpu_data, writer.write_offset,                std::span<const std::byte>{record});
+                write(primitive_gpu_data, writer.write_offset + offsets.color, color_span                       );
+                write(primitive_gpu_data, writer.write_offset + offsets.size,  size_span                        );
+                write(primitive_gpu_data, writer.write_offset + offsets.position_scale,  as_span(position_scale ));
+                write(primitive_gpu_data, writer.write_offset + offsets.position_offset, as_span(position_offset));
             }
             writer.write_offset += entry_size;
             ERHE_VERIFY(writer.write_offset <= writer.write_end);
@@ -228,4 +258,68 @@ auto Primitive_buffer::update(
     return writer.range;
 }
 
+auto Primitive_buffer::get_mesh_record_cache(const erhe::scene::Mesh& mesh, const erhe::scene::Node& node) -> Mesh_record_cache&
+{
+    const uint64_t     world_from_node_serial = node.node_data.transforms.world_from_node_serial;
+    Mesh_record_cache& cache                  = m_mesh_record_caches[mesh.get_id()];
+    const auto&        primitives             = mesh.get_primitives();
+    const std::size_t  entry_size             = m_primitive_interface.primitive_struct.size_bytes();
+    const auto&        offsets                = m_primitive_interface.offsets;
+    cache.last_used_frame = m_frame_serial;
+
+    // Serial 0 means transform is pending update and is never cached
+    if (
+        (world_from_node_serial != 0) &&
+        (cache.world_from_node_serial == world_from_node_serial) &&
+        (cache.primitives.size() == primitives.size())
+    ) {
+        return cache;
+    }
+
+    ++m_rebuilt_mesh_count;
+    cache.world_from_node_serial = world_from_node_serial;
+    cache.primitives .assign(primitives.size(), Cached_primitive{});
+    cache.record_data.assign(primitives.size() * entry_size, std::byte{0});
+
+    const glm::mat4 world_from_node = node.world_from_node();
+
+    // TODO Use compute shader
+    const glm::mat4 world_from_node_cofactor = erhe::math::compute_cofactor(world_from_node);
+
+    // Material and skin fields start zeroed, matching Cached_primitive{}
+    using erhe::graphics::as_span;
+    using erhe::graphics::write;
+    for (std::size_t i = 0, end = primitives.size(); i < end; ++i) {
+        const std::span<std::byte> record{cache.record_data.data() + i * entry_size, entry_size};
+        write(record, offsets.world_from_node,          as_span(world_from_node         ));
+        write(record, offsets.world_from_node_cofactor, as_span(world_from_node_cofactor));
+    }
+    return cache;
+}
+
+void Primitive_buffer::evict_unused_mesh_record_caches()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const uint64_t oldest_kept = (m_frame_serial > c_cache_eviction_interval)
+        ? m_frame_serial - c_cache_eviction_interval
+        : 0;
+    std::erase_if(
+        m_mesh_record_caches,
+        [oldest_kept](const auto& entry) {
+            return entry.second.last_used_frame < oldest_kept;
+        }
+    );
+}
+
+auto Primitive_buffer::cached_mesh_count() const -> std::size_t
+{
+    return m_mesh_record_caches.size();
+}
+
+auto Primitive_buffer::rebuilt_mesh_count() const -> std::size_t
+{
+    return m_rebuilt_mesh_count;
+}
+
 } // namespace erhe::scene_renderer
@@ -5,6 +5,8 @@
 #include "erhe_primitive/enums.hpp"
 
 #include <array>
+#include <cstddef>
+#include <unordered_map>
 #include <vector>
 
 namespace erhe {
@@ -13,6 +15,7 @@ namespace erhe {
 namespace erhe::scene {
     class Mesh;
     class Mesh_layer;
+    class Node;
 }
 
 namespace erhe::scene_renderer
@@ -28,6 +31,8 @@ public:
     std::size_t size;                       // float 1 * 4 bytes - point size / line width
     std::size_t skinning_factor;            // float 1 * 4 bytes
     std::size_t base_joint_index;           // uint  1 * 4 bytes
+    std::size_t position_scale;             // vec4  4 * 4 bytes - quantized position dequantization, w unused
+    std::size_t position_offset;            // vec4  4 * 4 bytes
 };
 
 class Primitive_interface
@@ -122,14 +127,54 @@ public:
         std::size_t        primitive_index{0};
     };
 
+    // Advances frame resources and ages record cache entries by frame
+    void next_frame();
+
     void reset_id_ranges();
     [[nodiscard]] auto id_offset() const -> uint32_t;
     [[nodiscard]] auto id_ranges() const -> const std::vector<Id_range>&;
 
+    // Number of mesh entries in record cache and of entries rebuilt by
+    // the most recent update() call
+    [[nodiscard]] auto cached_mesh_count () const -> std::size_t;
+    [[nodiscard]] auto rebuilt_mesh_count() const -> std::size_t;
+
 private:
-    Primitive_interface&  m_primitive_interface;
-    uint32_t              m_id_offset{0};
-    std::vector<Id_range> m_id_ranges;
+    // CPU side copy of primitive records of one mesh, one entry_size
+    // record per mesh primitive. Transform dependent fields are rebuilt
+    // only when node world_from_node_serial changes; material and skin
+    // fields are compared and patched. Color and size depend on render
+    // settings, and position dequantization on the primitive buffer mesh,
+    // so these are written after the bulk copy.
+    class Cached_primitive
+    {
+    public:
+        uint32_t material_index  {0};
+        uint32_t base_joint_index{0};
+        float    skinning_factor {0.0f};
+    };
+
+    class Mesh_record_cache
+    {
+    public:
+        uint64_t                      world_from_node_serial{0};
+        uint64_t                      last_used_frame       {0};
+        std::vector<Cached_primitive> primitives;
+        std::vector<std::byte>        record_data;
+    };
+
+    // Entries not used for this many frames are evicted; checked once per interval
+    static constexpr uint64_t c_cache_eviction_interval = 256; // in frames
+
+    [[nodiscard]] auto get_mesh_record_cache(const erhe::scene::Mesh& mesh, const erhe::scene::Node& node) -> Mesh_record_cache&;
+    void evict_unused_mesh_record_caches();
+
+    Primitive_interface&                               m_primitive_interface;
+    uint32_t                                           m_id_offset{0};
+    std::vector<Id_range>                              m_id_ranges;
+    std::unordered_map<std::size_t, Mesh_record_cache> m_mesh_record_caches; // key is mesh id
+    uint64_t                                           m_frame_serial      {0};
+    std::size_t                                        m_rebuilt_mesh_count{0};
 };
 
 } // namespace erhe::scene_renderer
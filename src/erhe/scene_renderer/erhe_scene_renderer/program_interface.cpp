@@ -3,6 +3,7 @@
 #include "erhe_gl/command_info.hpp"
 #include "erhe_gl/wrapper_functions.hpp"
 #include "erhe_graphics/instance.hpp"
+#include "erhe_configuration/configuration.hpp"
 #include "erhe_scene_renderer/scene_renderer_log.hpp"
 #include "erhe_file/file.hpp"
 #include "erhe_profile/profile.hpp"
@@ -123,6 +124,8 @@ Program_interface::Program_interface(erhe::graphics::Instance& graphics_instance
     , material_interface {graphics_instance}
     , primitive_interface{graphics_instance}
 {
+    const auto& ini = erhe::configuration::get_ini_file_section("erhe.ini", "renderer");
+    ini.get("compact_vertex_format", compact_vertex_format);
 }
 
 auto Program_interface::make_prototype(
@@ -178,11 +181,16 @@ auto Program_interface::make_prototype(
         ERHE_VERIFY(gl::is_extension_supported(gl::Extension::Extension_GL_ARB_shader_draw_parameters));
         create_info.extensions.push_back({gl::Shader_type::vertex_shader,   "GL_ARB_shader_draw_parameters"});
         create_info.extensions.push_back({gl::Shader_type::geometry_shader, "GL_ARB_shader_draw_parameters"});
-        create_info.defines.push_back({"gl_DrawID", "gl_DrawIDARB"});
+        create_info.defines.push_back({"gl_DrawID",       "gl_DrawIDARB"});
+        create_info.defines.push_back({"gl_BaseInstance", "gl_BaseInstanceARB"}); // ERHE_PRIMITIVE_INDEX in depth_only.vert
     }
 
     create_info.defines.emplace_back("ERHE_SHADOW_MAPS", "1");
 
+    if (compact_vertex_format) {
+        create_info.defines.emplace_back("ERHE_OCTAHEDRAL_NORMALS", "1");
+    }
+
     if (graphics_instance.info.use_bindless_texture) {
         create_info.defines.emplace_back("ERHE_BINDLESS_TEXTURE", "1");
         create_info.extensions.push_back({gl::Shader_type::fragment_shader, "GL_ARB_bindless_texture"});
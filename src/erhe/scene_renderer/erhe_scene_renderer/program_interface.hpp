@@ -41,6 +41,10 @@ public:
 
     void apply_default_attribute_values() const;
 
+    // Vertex shaders decode octahedral normals and tangents (define
+    // ERHE_OCTAHEDRAL_NORMALS). Meshes drawn with these programs must use
+    // octahedral normal and tangent vertex attributes.
+    bool                                      compact_vertex_format{false};
     erhe::graphics::Fragment_outputs          fragment_outputs;
     erhe::graphics::Vertex_attribute_mappings attribute_mappings;
 
@@ -53,7 +53,7 @@ Shadow_renderer::Shadow_renderer(erhe::graphics::Instance& graphics_instance, Pr
             .debug_label = "Shadow_renderer"
         }
     }
-    , m_draw_indirect_buffers{graphics_instance}
+    , m_draw_indirect_buffers{graphics_instance, program_interface.light_interface.max_light_count}
     , m_joint_buffers        {graphics_instance, program_interface.joint_interface}
     , m_light_buffers        {graphics_instance, program_interface.light_interface}
     , m_primitive_buffers    {graphics_instance, program_interface.primitive_interface}
@@ -173,17 +173,14 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
 
     const erhe::primitive::Primitive_mode primitive_mode{erhe::primitive::Primitive_mode::polygon_fill};
     for (const auto& meshes : mesh_spans) {
+        // Primitive records are written once for all casters and shared by
+        // all lights; per light draw lists select records by base instance
         std::size_t primitive_count{0};
         const auto primitive_range = m_primitive_buffers.update(meshes, primitive_mode, shadow_filter, Primitive_interface_settings{}, primitive_count);
-        const auto draw_indirect_buffer_range = m_draw_indirect_buffers.update(meshes, primitive_mode, shadow_filter);
-        if (primitive_count != draw_indirect_buffer_range.draw_indirect_count) {
-            log_render->warn("primitive_range != draw_indirect_buffer_range.draw_indirect_count");
-        }
-
-        if (draw_indirect_buffer_range.draw_indirect_count > 0) {
-            m_primitive_buffers.bind(primitive_range);
-            m_draw_indirect_buffers.bind(draw_indirect_buffer_range.range);
+        if (primitive_count == 0) {
+            continue;
         }
+        m_primitive_buffers.bind(primitive_range);
 
         for (const auto& light : lights) {
             if (!light->cast_shadow) {
@@ -218,10 +215,21 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
                 );
             }
 
+            // With frustum culling, only casters inside light frustum are drawn
+            const std::span<const uint8_t> mesh_visibility = parameters.frustum_culling
+                ? m_frustum_culler.cull_mask(light_projection_transform->clip_from_world.get_matrix(), meshes)
+                : std::span<const uint8_t>{};
+            if (parameters.frustum_culling && (m_frustum_culler.get_statistics().visible_count == 0)) {
+                continue;
+            }
+
+            const auto draw_indirect_buffer_range = m_draw_indirect_buffers.update(meshes, primitive_mode, shadow_filter, nullptr, mesh_visibility);
             if (draw_indirect_buffer_range.draw_indirect_count == 0) {
                 continue;
             }
 
+            m_draw_indirect_buffers.bind(draw_indirect_buffer_range.range);
+
             const auto control_range = m_light_buffers.update_control(light_index);
             m_light_buffers.bind_control_buffer(control_range);
 
@@ -233,7 +241,7 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
                 gl::multi_draw_elements_indirect(
                     pipeline.data.input_assembly.primitive_topology,
                     erhe::graphics::to_gl_index_type(parameters.index_type),
-                    nullptr, //reinterpret_cast<const void *>(draw_indirect_buffer_range.range.first_byte_offset),
+                    reinterpret_cast<const void *>(draw_indirect_buffer_range.range.first_byte_offset),
                     static_cast<GLsizei>(draw_indirect_buffer_range.draw_indirect_count),
                     static_cast<GLsizei>(sizeof(gl::Draw_elements_indirect_command))
                 );
@@ -8,6 +8,7 @@
 #include "erhe_dataformat/dataformat.hpp"
 #include "erhe_renderer/draw_indirect_buffer.hpp"
 #include "erhe_math/viewport.hpp"
+#include "erhe_scene_renderer/frustum_culler.hpp"
 #include "erhe_scene_renderer/joint_buffer.hpp"
 #include "erhe_scene_renderer/light_buffer.hpp"
 #include "erhe_scene_renderer/primitive_buffer.hpp"
@@ -63,6 +64,7 @@ public:
         const std::span<const std::shared_ptr<erhe::scene::Light>> lights;
         const std::span<const std::shared_ptr<erhe::scene::Skin>>& skins{};
         Light_projections&                                         light_projections;
+        bool                                                       frustum_culling{false}; // Skip casters outside each light frustum
     };
 
     auto render    (const Render_parameters& parameters) -> bool;
@@ -88,6 +90,7 @@ private:
     Joint_buffer                             m_joint_buffers;
     Light_buffer                             m_light_buffers;
     Primitive_buffer                         m_primitive_buffers;
+    Frustum_culler                           m_frustum_culler;
     erhe::graphics::Gpu_timer                m_gpu_timer;
 };
 
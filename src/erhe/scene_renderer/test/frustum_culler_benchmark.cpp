@@ -0,0 +1,168 @@
+// Benchmark for Frustum_culler: the four wide bounds test kernel alone,
+// compaction of visible meshes, and whole span culling with bounds
+// gathering, serial and on the thread pool.
+
+#include "erhe_scene_renderer/frustum_culler.hpp"
+#include "erhe_scene_renderer/scene_renderer_log.hpp"
+#include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_primitive/primitive.hpp"
+#include "erhe_scene/mesh.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using erhe::scene_renderer::Frustum_cull_bounds;
+using erhe::scene_renderer::Frustum_culler;
+
+using Clock = std::chrono::steady_clock;
+
+auto seconds_since(const Clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* label, const std::size_t operation_count, const double seconds)
+{
+    fmt::print(
+        "{:<28} {:>8} ops {:>10.3f} ms {:>10.1f} ns/op\n",
+        label, operation_count, seconds * 1000.0, seconds * 1.0e9 / static_cast<double>(operation_count)
+    );
+}
+
+} // anonymous namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const std::size_t mesh_count  = (argc > 1) ? static_cast<std::size_t>(std::stoull(argv[1])) : 100'000;
+    const std::size_t repeat_count = 20;
+
+    erhe::log::initialize_log_sinks();
+    erhe::scene::initialize_logging();
+    erhe::scene_renderer::initialize_logging();
+
+    const glm::mat4 clip_from_view  = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 200.0f);
+    const glm::mat4 view_from_world = glm::lookAt(glm::vec3{0.0f, 10.0f, 0.0f}, glm::vec3{50.0f, 0.0f, 50.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+    const glm::mat4 clip_from_world = clip_from_view * view_from_world;
+
+    // Meshes scattered around the camera, roughly a quarter inside the frustum
+    std::mt19937                          random_engine{1234};
+    std::uniform_real_distribution<float> position_distribution{-150.0f, 150.0f};
+
+    std::vector<std::shared_ptr<erhe::scene::Node>> nodes;
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> meshes;
+    nodes .reserve(mesh_count);
+    meshes.reserve(mesh_count);
+    erhe::primitive::Buffer_mesh buffer_mesh{};
+    buffer_mesh.bounding_box.include(glm::vec3{-1.0f});
+    buffer_mesh.bounding_box.include(glm::vec3{ 1.0f});
+    for (std::size_t i = 0; i < mesh_count; ++i) {
+        auto mesh = std::make_shared<erhe::scene::Mesh>("mesh");
+        mesh->add_primitive(erhe::primitive::Primitive{buffer_mesh});
+        auto node = std::make_shared<erhe::scene::Node>("node");
+        node->set_parent_from_node(
+            glm::translate(
+                glm::mat4{1.0f},
+                glm::vec3{position_distribution(random_engine), 0.0f, position_distribution(random_engine)}
+            )
+        );
+        node->attach(mesh);
+        nodes .push_back(node);
+        meshes.push_back(mesh);
+    }
+
+    // Kernel only, bounds already in structure of arrays form
+    Frustum_cull_bounds bounds;
+    bounds.resize(mesh_count);
+    for (std::size_t i = 0; i < bounds.padded_size(); ++i) {
+        if (i < mesh_count) {
+            bounds.set(i, glm::vec3{nodes[i]->world_from_node()[3]}, glm::vec3{1.0f});
+        } else {
+            bounds.clear(i, false);
+        }
+    }
+    const std::array<glm::vec4, 6> planes = Frustum_culler::extract_planes(clip_from_world);
+    std::vector<uint8_t> visible(bounds.padded_size(), 0);
+    std::size_t kernel_visible_count = 0;
+    {
+        const auto start = Clock::now();
+        for (std::size_t repeat = 0; repeat < repeat_count; ++repeat) {
+            Frustum_culler::test_bounds(planes, bounds, 0, bounds.padded_size(), visible);
+            kernel_visible_count += visible[repeat % mesh_count];
+        }
+        report("test_bounds kernel", mesh_count * repeat_count, seconds_since(start));
+    }
+
+    // Compaction of kernel output
+    std::size_t compact_count = 0;
+    {
+        std::vector<std::shared_ptr<erhe::scene::Mesh>> out;
+        out.reserve(mesh_count);
+        const auto start = Clock::now();
+        for (std::size_t repeat = 0; repeat < repeat_count; ++repeat) {
+            out.clear();
+            Frustum_culler::compact(std::span<const uint8_t>{visible.data(), mesh_count}, meshes, out);
+            compact_count += out.size();
+        }
+        report("compact", mesh_count * repeat_count, seconds_since(start));
+    }
+
+    // Whole span, bounds gathered from meshes
+    Frustum_culler culler;
+    std::size_t serial_count   = 0;
+    std::size_t parallel_count = 0;
+    {
+        culler.set_parallel(false);
+        const auto start = Clock::now();
+        for (std::size_t repeat = 0; repeat < repeat_count; ++repeat) {
+            serial_count += culler.cull(clip_from_world, meshes).size();
+        }
+        report("cull serial", mesh_count * repeat_count, seconds_since(start));
+    }
+    {
+        culler.set_parallel(true);
+        const auto start = Clock::now();
+        for (std::size_t repeat = 0; repeat < repeat_count; ++repeat) {
+            parallel_count += culler.cull(clip_from_world, meshes).size();
+        }
+        report("cull parallel", mesh_count * repeat_count, seconds_since(start));
+    }
+    {
+        std::size_t mask_count = 0;
+        const auto start = Clock::now();
+        for (std::size_t repeat = 0; repeat < repeat_count; ++repeat) {
+            mask_count += culler.cull_mask(clip_from_world, meshes).size();
+        }
+        report("cull_mask parallel", mesh_count * repeat_count, seconds_since(start));
+        if (mask_count != mesh_count * repeat_count) {
+            fmt::print(stderr, "cull_mask size mismatch\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    fmt::print(
+        "visible {} of {} ({:.1f}%), kernel checksum {}\n",
+        serial_count / repeat_count, mesh_count,
+        100.0 * static_cast<double>(serial_count) / static_cast<double>(mesh_count * repeat_count),
+        kernel_visible_count
+    );
+    if ((serial_count != parallel_count) || (serial_count != compact_count)) {
+        fmt::print(stderr, "visible count mismatch: serial {} parallel {} compact {}\n", serial_count, parallel_count, compact_count);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
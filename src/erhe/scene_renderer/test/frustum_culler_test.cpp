@@ -0,0 +1,260 @@
+// Checks Frustum_culler plane extraction, the four wide bounds test
+// kernel against a scalar reference, compaction order, and whole mesh
+// span culling including always visible meshes and the parallel path.
+
+#include "erhe_scene_renderer/frustum_culler.hpp"
+#include "erhe_scene_renderer/scene_renderer_log.hpp"
+#include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_primitive/primitive.hpp"
+#include "erhe_scene/mesh.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_log.hpp"
+#include "erhe_log/log.hpp"
+
+#include <fmt/format.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+using erhe::scene_renderer::Frustum_cull_bounds;
+using erhe::scene_renderer::Frustum_culler;
+
+int s_failure_count{0};
+
+void check(const bool condition, const char* description)
+{
+    if (!condition) {
+        fmt::print(stderr, "FAILED: {}\n", description);
+        ++s_failure_count;
+    }
+}
+
+auto reference_visible(const std::array<glm::vec4, 6>& planes, const Frustum_cull_bounds& bounds, const std::size_t i) -> bool
+{
+    if (bounds.always_visible[i] != 0) {
+        return true;
+    }
+    for (const glm::vec4& plane : planes) {
+        const float distance =
+            plane.x * bounds.center_x[i] +
+            plane.y * bounds.center_y[i] +
+            plane.z * bounds.center_z[i] +
+            plane.w;
+        const float radius =
+            std::abs(plane.x) * bounds.extent_x[i] +
+            std::abs(plane.y) * bounds.extent_y[i] +
+            std::abs(plane.z) * bounds.extent_z[i];
+        if (distance + radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_extract_planes()
+{
+    // Identity clip_from_world: frustum is the -1..1 cube
+    const std::array<glm::vec4, 6> planes = Frustum_culler::extract_planes(glm::mat4{1.0f});
+    check(planes[0] == glm::vec4{ 1.0f,  0.0f,  0.0f, 1.0f}, "left plane");
+    check(planes[1] == glm::vec4{-1.0f,  0.0f,  0.0f, 1.0f}, "right plane");
+    check(planes[2] == glm::vec4{ 0.0f,  1.0f,  0.0f, 1.0f}, "bottom plane");
+    check(planes[3] == glm::vec4{ 0.0f, -1.0f,  0.0f, 1.0f}, "top plane");
+    check(planes[4] == glm::vec4{ 0.0f,  0.0f,  1.0f, 1.0f}, "near plane");
+    check(planes[5] == glm::vec4{ 0.0f,  0.0f, -1.0f, 1.0f}, "far plane");
+}
+
+void test_kernel_cases()
+{
+    const std::array<glm::vec4, 6> planes = Frustum_culler::extract_planes(glm::mat4{1.0f});
+
+    Frustum_cull_bounds bounds;
+    bounds.resize(7);
+    check(bounds.size() == 7,        "bounds size");
+    check(bounds.padded_size() == 8, "bounds padded to multiple of four");
+
+    bounds.set  (0, glm::vec3{ 0.0f,  0.0f, 0.0f}, glm::vec3{0.5f}); // inside
+    bounds.set  (1, glm::vec3{ 5.0f,  0.0f, 0.0f}, glm::vec3{1.0f}); // outside right
+    bounds.set  (2, glm::vec3{ 1.5f,  0.0f, 0.0f}, glm::vec3{1.0f}); // straddles right
+    bounds.set  (3, glm::vec3{ 2.01f, 0.0f, 0.0f}, glm::vec3{1.0f}); // just outside right
+    bounds.set  (4, glm::vec3{ 0.0f,  0.0f, 0.0f}, glm::vec3{9.0f}); // contains frustum
+    bounds.set  (5, glm::vec3{ 0.0f, -3.0f, 0.0f}, glm::vec3{0.5f}); // outside bottom
+    bounds.set  (6, glm::vec3{ 0.0f,  0.0f, 7.0f}, glm::vec3{0.5f}); // outside far, but
+    bounds.always_visible[6] = 1;                                    // always visible
+    bounds.clear(7, false);                                          // padding
+
+    std::vector<uint8_t> visible(bounds.padded_size(), 0xff);
+    Frustum_culler::test_bounds(planes, bounds, 0, bounds.padded_size(), visible);
+    check(visible[0] == 1, "box inside frustum is visible");
+    check(visible[1] == 0, "box outside frustum is culled");
+    check(visible[2] == 1, "box straddling plane is visible");
+    check(visible[3] == 0, "box just outside plane is culled");
+    check(visible[4] == 1, "box containing frustum is visible");
+    check(visible[5] == 0, "box below frustum is culled");
+    check(visible[6] == 1, "always visible box outside frustum is visible");
+    check(visible[7] == 1, "zero size padding box at origin is visible");
+
+    // Partial range leaves other entries untouched
+    std::vector<uint8_t> partial(bounds.padded_size(), 0xff);
+    Frustum_culler::test_bounds(planes, bounds, 4, 8, partial);
+    check(partial[0] == 0xff && partial[3] == 0xff, "range before begin untouched");
+    check(partial[4] == 1 && partial[5] == 0,       "range written");
+}
+
+void test_kernel_against_reference()
+{
+    const glm::mat4 clip_from_view  = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 100.0f);
+    const glm::mat4 view_from_world = glm::lookAt(glm::vec3{3.0f, 4.0f, 5.0f}, glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+    const std::array<glm::vec4, 6> planes = Frustum_culler::extract_planes(clip_from_view * view_from_world);
+
+    std::mt19937                          random_engine{1234};
+    std::uniform_real_distribution<float> position_distribution{-60.0f, 60.0f};
+    std::uniform_real_distribution<float> extent_distribution  {  0.0f,  4.0f};
+    std::uniform_int_distribution<int>    always_distribution  {  0,    15   };
+
+    const std::size_t   count = 10'001;
+    Frustum_cull_bounds bounds;
+    bounds.resize(count);
+    for (std::size_t i = 0; i < bounds.padded_size(); ++i) {
+        if (i >= count) {
+            bounds.clear(i, false);
+            continue;
+        }
+        bounds.set(
+            i,
+            glm::vec3{position_distribution(random_engine), position_distribution(random_engine), position_distribution(random_engine)},
+            glm::vec3{extent_distribution(random_engine), extent_distribution(random_engine), extent_distribution(random_engine)}
+        );
+        bounds.always_visible[i] = (always_distribution(random_engine) == 0) ? 1 : 0;
+    }
+
+    std::vector<uint8_t> visible(bounds.padded_size(), 0);
+    Frustum_culler::test_bounds(planes, bounds, 0, bounds.padded_size(), visible);
+
+    std::size_t mismatch_count = 0;
+    std::size_t visible_count  = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const bool expected = reference_visible(planes, bounds, i);
+        if ((visible[i] != 0) != expected) {
+            ++mismatch_count;
+        }
+        if (visible[i] != 0) {
+            ++visible_count;
+        }
+    }
+    check(mismatch_count == 0, "kernel matches scalar reference");
+    check((visible_count > 0) && (visible_count < count), "random boxes are partially visible");
+}
+
+void test_compact()
+{
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> meshes;
+    for (std::size_t i = 0; i < 9; ++i) {
+        meshes.push_back(std::make_shared<erhe::scene::Mesh>(fmt::format("mesh {}", i)));
+    }
+    const std::vector<uint8_t> visible{1, 0, 0, 1, 1, 0, 1, 0, 1};
+
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> out;
+    out.push_back(meshes[8]); // compact() appends
+    Frustum_culler::compact(visible, meshes, out);
+
+    check(out.size() == 6, "compact output count");
+    const std::array<std::size_t, 5> expected{0, 3, 4, 6, 8};
+    bool order_ok = (out.size() == 6) && (out[0] == meshes[8]);
+    for (std::size_t i = 0; order_ok && (i < expected.size()); ++i) {
+        order_ok = (out[i + 1] == meshes[expected[i]]);
+    }
+    check(order_ok, "compact keeps original order");
+
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> none;
+    Frustum_culler::compact(std::vector<uint8_t>(meshes.size(), 0), meshes, none);
+    check(none.empty(), "compact with nothing visible");
+}
+
+auto make_box_mesh(const glm::vec3& position, std::vector<std::shared_ptr<erhe::scene::Node>>& nodes) -> std::shared_ptr<erhe::scene::Mesh>
+{
+    erhe::primitive::Buffer_mesh buffer_mesh{};
+    buffer_mesh.bounding_box.include(glm::vec3{-0.5f});
+    buffer_mesh.bounding_box.include(glm::vec3{ 0.5f});
+
+    auto mesh = std::make_shared<erhe::scene::Mesh>("box");
+    mesh->add_primitive(erhe::primitive::Primitive{buffer_mesh});
+
+    auto node = std::make_shared<erhe::scene::Node>("box");
+    node->set_parent_from_node(glm::translate(glm::mat4{1.0f}, position));
+    node->attach(mesh);
+    nodes.push_back(node);
+    return mesh;
+}
+
+void test_cull_meshes(const std::size_t count)
+{
+    // Camera at origin looking down -z
+    const glm::mat4 clip_from_world = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+
+    std::vector<std::shared_ptr<erhe::scene::Node>> nodes;
+    std::vector<std::shared_ptr<erhe::scene::Mesh>> meshes;
+    std::vector<bool>                               expected;
+    for (std::size_t i = 0; i < count; ++i) {
+        switch (i % 4) {
+            case 0:  meshes.push_back(make_box_mesh(glm::vec3{0.0f, 0.0f, -10.0f}, nodes)); expected.push_back(true ); break; // in front
+            case 1:  meshes.push_back(make_box_mesh(glm::vec3{0.0f, 0.0f,  10.0f}, nodes)); expected.push_back(false); break; // behind
+            case 2:  meshes.push_back(make_box_mesh(glm::vec3{0.0f, 0.0f, -500.f}, nodes)); expected.push_back(false); break; // beyond far
+            default: meshes.push_back(std::make_shared<erhe::scene::Mesh>("no node"));      expected.push_back(true ); break; // never culled
+        }
+    }
+
+    Frustum_culler culler;
+    const std::span<const uint8_t> mask = culler.cull_mask(clip_from_world, meshes);
+    check(mask.size() == count, "cull_mask has one entry per mesh");
+    bool mask_ok = (mask.size() == count);
+    for (std::size_t i = 0; mask_ok && (i < count); ++i) {
+        mask_ok = ((mask[i] != 0) == expected[i]);
+    }
+    check(mask_ok, "cull_mask matches expected visibility");
+    check(culler.get_statistics().tested_count  == count,     "tested count");
+    check(culler.get_statistics().visible_count == count / 2, "visible count");
+
+    const auto visible_meshes = culler.cull(clip_from_world, meshes);
+    bool cull_ok = (visible_meshes.size() == count / 2);
+    for (std::size_t i = 0, j = 0; cull_ok && (i < count); ++i) {
+        if (expected[i]) {
+            cull_ok = (visible_meshes[j++] == meshes[i]);
+        }
+    }
+    check(cull_ok, "cull returns visible meshes in order");
+
+    culler.set_parallel(false);
+    const auto serial_meshes = culler.cull(clip_from_world, meshes);
+    check(serial_meshes.size() == count / 2, "serial cull matches");
+}
+
+} // anonymous namespace
+
+auto main() -> int
+{
+    erhe::log::initialize_log_sinks();
+    erhe::scene::initialize_logging();
+    erhe::scene_renderer::initialize_logging();
+
+    test_extract_planes();
+    test_kernel_cases();
+    test_kernel_against_reference();
+    test_compact();
+    test_cull_meshes(16);
+    test_cull_meshes(4 * Frustum_culler::c_parallel_min_mesh_count); // parallel path
+
+    if (s_failure_count > 0) {
+        fmt::print(stderr, "{} checks failed\n", s_failure_count);
+        return EXIT_FAILURE;
+    }
+    fmt::print("frustum culler tests passed\n");
+    return EXIT_SUCCESS;
+}
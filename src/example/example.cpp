@@ -375,8 +375,8 @@ void run_example()
 
     erhe::gltf::Gltf_data gltf_data = erhe::gltf::parse_gltf(
         erhe::gltf::Gltf_parse_arguments{
-            .graphics_instance = graphics_instance,
-            .image_transfer    = image_transfer,
+            .graphics_instance = &graphics_instance,
+            .image_transfer    = &image_transfer,
             .root_node         = scene.get_root_node(),
             //.path              = "res/models/Box.gltf"
             .path              = "res/models/SM_Deccer_Cubes_Textured.glb"